@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "../System/MemoryTracker.hpp"
 
 namespace GFX
 {
@@ -24,6 +25,7 @@ namespace GFX
         std::string filePath;
         std::string name;
         std::vector<uint8_t> data;
+        MemoryUsage memoryUsage = MemoryUsage(MemoryTag::Audio);
         size_t dataSize;
         void *handle;
         bool streamFromDisk;
@@ -6,6 +6,7 @@
 #include "DSP/AudioEffect.hpp"
 #include "DSP/AudioGenerator.hpp"
 #include "../Core/Component.hpp"
+#include "../Core/ArchetypeComponent.hpp"
 #include "../System/Collections/ConcurrentList.hpp"
 #include "../System/EventHandler.hpp"
 #include "../System/Numerics/Vector3.hpp"
@@ -24,6 +25,13 @@ namespace GFX
 {
     class AudioSource;
 
+    // The part of an AudioSource that Audio reads every frame, packed into the chunks of ArchetypeStorage::GetDefault()
+    struct AudioSourceState
+    {
+        ma_ex_audio_source *handle;
+        bool isSpatial; //Cached from SetSpatial, so the frame update doesn't have to ask the audio engine
+    };
+
     using AudioEndedCallback = std::function<void(AudioSource*)>;
     using AudioLoadedCallback = std::function<void(AudioSource*)>;
     using AudioProcessCallback = std::function<void(AudioSource*,AudioBuffer<float>, UInt64, UInt32)>;
@@ -42,9 +50,9 @@ namespace GFX
     friend class Audio;
     public:
         EventHandler<AudioEndedCallback> end;
-        EventHandler<AudioLoadedCallback> load;
-        EventHandler<AudioProcessCallback> process;
-        EventHandler<AudioReadCallback> read;
+        ConcurrentEventHandler<AudioLoadedCallback> load;       //Raised from the audio threads
+        ConcurrentEventHandler<AudioProcessCallback> process;
+        ConcurrentEventHandler<AudioReadCallback> read;
         AudioSource();
         ~AudioSource();
         void Update();
@@ -107,6 +115,7 @@ namespace GFX
         void OnDestroy() override;
     private:
         ma_ex_audio_source *handle;
+        ArchetypeState<AudioSourceState> state; //Only exists while the source is added to Audio
         Vector3 previousPosition;
         ConcurrentList<std::shared_ptr<AudioGenerator>> generators;
         ConcurrentList<std::shared_ptr<AudioEffect>> effects;
@@ -0,0 +1,112 @@
+#ifndef GFX_ARCHETYPECOMPONENT_HPP
+#define GFX_ARCHETYPECOMPONENT_HPP
+
+#include "Component.hpp"
+#include "ArchetypeStorage.hpp"
+
+namespace GFX
+{
+    // Stored with every entity created through an ArchetypeComponent so chunk queries can get back to the GameObject
+    struct ArchetypeOwner
+    {
+        Component *component;
+    };
+
+    // Keeps the hot data of an engine component in ArchetypeStorage::GetDefault(), as an entity of its own.
+    // The entity also carries an ArchetypeOwner, so systems that walk the chunks can get back to the component.
+    template <typename T>
+    class ArchetypeState
+    {
+    private:
+        EntityHandle entity;
+    public:
+        ArchetypeState() = default;
+        ArchetypeState(const ArchetypeState&) = delete;
+        ArchetypeState &operator=(const ArchetypeState&) = delete;
+
+        ~ArchetypeState()
+        {
+            Destroy();
+        }
+
+        void Create(Component *owner, const T &value)
+        {
+            ArchetypeStorage &storage = ArchetypeStorage::GetDefault();
+
+            if(storage.IsAlive(entity))
+                return;
+
+            entity = storage.CreateEntity(ArchetypeOwner{ owner }, value);
+        }
+
+        void Destroy()
+        {
+            if(entity == EntityHandle())
+                return;
+            ArchetypeStorage::GetDefault().DestroyEntity(entity);
+            entity = EntityHandle();
+        }
+
+        //Only valid between Create and Destroy
+        T *Get() const
+        {
+            return ArchetypeStorage::GetDefault().GetComponent<T>(entity);
+        }
+
+        EntityHandle GetEntity() const
+        {
+            return entity;
+        }
+    };
+
+    // Ties a GameObject to an entity in an ArchetypeStorage.
+    // The hot data lives in the storage while GetComponent<ArchetypeComponent>() keeps working as before.
+    class ArchetypeComponent : public Component
+    {
+    private:
+        ArchetypeStorage *storage;
+        EntityHandle entity;
+    protected:
+        void OnInitialize() override;
+        void OnDestroy() override;
+    public:
+        ArchetypeComponent();
+        ArchetypeComponent(ArchetypeStorage *storage);
+        ArchetypeStorage *GetStorage() const;
+        EntityHandle GetEntity() const;
+
+        template <typename T>
+        T *Add(const T &value = T())
+        {
+            if(!storage)
+                return nullptr;
+            return storage->AddComponent<T>(entity, value);
+        }
+
+        template <typename T>
+        bool Remove()
+        {
+            if(!storage)
+                return false;
+            return storage->RemoveComponent<T>(entity);
+        }
+
+        template <typename T>
+        T *Get() const
+        {
+            if(!storage)
+                return nullptr;
+            return storage->GetComponent<T>(entity);
+        }
+
+        template <typename T>
+        bool Has() const
+        {
+            if(!storage)
+                return false;
+            return storage->HasComponent<T>(entity);
+        }
+    };
+}
+
+#endif
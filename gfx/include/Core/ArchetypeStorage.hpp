@@ -0,0 +1,189 @@
+#ifndef GFX_ARCHETYPESTORAGE_HPP
+#define GFX_ARCHETYPESTORAGE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace GFX
+{
+    struct EntityHandle
+    {
+        uint32_t index;
+        uint32_t generation;
+        EntityHandle();
+        EntityHandle(uint32_t index, uint32_t generation);
+        bool operator==(const EntityHandle &other) const;
+        bool operator!=(const EntityHandle &other) const;
+    };
+
+    struct ArchetypeChunk
+    {
+        uint8_t *data;
+        uint32_t count;
+    };
+
+    // All entities with exactly the same set of data types.
+    // Entities are packed into fixed size chunks, and every chunk stores each type as its own array.
+    class Archetype
+    {
+    friend class ArchetypeStorage;
+    public:
+        static constexpr uint32_t MAX_TYPES = 64;
+        static constexpr size_t CHUNK_SIZE = 16 * 1024;
+        Archetype(uint64_t mask, const std::vector<uint32_t> &typeIds, const std::vector<uint32_t> &typeSizes, const std::vector<uint32_t> &typeAlignments);
+        ~Archetype();
+        Archetype(const Archetype&) = delete;
+        Archetype &operator=(const Archetype&) = delete;
+        uint64_t GetMask() const;
+        uint32_t GetChunkCapacity() const;
+        size_t GetChunkCount() const;
+        size_t GetEntityCount() const;
+    private:
+        uint64_t mask;
+        uint32_t capacity;
+        size_t chunkSize;
+        size_t chunkAlignment;
+        std::vector<uint32_t> typeIds;
+        std::vector<uint32_t> typeSizes;
+        uint32_t columnOffsets[MAX_TYPES];
+        std::vector<ArchetypeChunk> chunks;
+        EntityHandle *GetEntities(const ArchetypeChunk &chunk) const;
+        uint8_t *GetColumn(const ArchetypeChunk &chunk, uint32_t typeId) const;
+        void Allocate(EntityHandle entity, uint32_t &chunkIndex, uint32_t &row);
+        EntityHandle Remove(uint32_t chunkIndex, uint32_t row);
+    };
+
+    // Storage for hot, trivially copyable engine data.
+    // Entities are referred to by generation checked handles that stay valid while their data moves between archetypes.
+    // Structural changes (creating, destroying, adding and removing data) are not thread safe and must not happen inside ForEach.
+    class ArchetypeStorage
+    {
+    public:
+        ArchetypeStorage();
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage &operator=(const ArchetypeStorage&) = delete;
+        static ArchetypeStorage &GetDefault();
+        EntityHandle CreateEntity();
+
+        //Creates the entity straight in the archetype of T..., instead of moving it once per type
+        template <typename... T>
+        EntityHandle CreateEntity(const T &...values)
+        {
+            EntityHandle entity = CreateEntityWithMask(GetMask<T...>());
+            (memcpy(GetType(entity, GetTypeId<T>()), &values, sizeof(T)), ...);
+            return entity;
+        }
+
+        void DestroyEntity(EntityHandle entity);
+        bool IsAlive(EntityHandle entity) const;
+        size_t GetEntityCount() const;
+        size_t GetArchetypeCount() const;
+        void Clear();
+
+        template <typename T>
+        static uint32_t GetTypeId()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "ArchetypeStorage types must be trivially copyable");
+            static const uint32_t id = RegisterType(sizeof(T), alignof(T));
+            return id;
+        }
+
+        template <typename... T>
+        static uint64_t GetMask()
+        {
+            return (0ULL | ... | GetTypeMask(GetTypeId<T>()));
+        }
+
+        template <typename T>
+        T *AddComponent(EntityHandle entity, const T &value = T())
+        {
+            uint8_t *data = AddType(entity, GetTypeId<T>());
+            if(!data)
+                return nullptr;
+            memcpy(data, &value, sizeof(T));
+            return reinterpret_cast<T*>(data);
+        }
+
+        template <typename T>
+        bool RemoveComponent(EntityHandle entity)
+        {
+            return RemoveType(entity, GetTypeId<T>());
+        }
+
+        template <typename T>
+        T *GetComponent(EntityHandle entity) const
+        {
+            return reinterpret_cast<T*>(GetType(entity, GetTypeId<T>()));
+        }
+
+        template <typename T>
+        bool HasComponent(EntityHandle entity) const
+        {
+            return GetType(entity, GetTypeId<T>()) != nullptr;
+        }
+
+        // Calls func(uint32_t count, const EntityHandle *entities, T *...columns) once per chunk
+        template <typename... T, typename Func>
+        void ForEachChunk(Func &&func)
+        {
+            const uint64_t mask = GetMask<T...>();
+
+            if(!((GetTypeId<T>() < Archetype::MAX_TYPES) && ...))
+                return;
+
+            for(size_t i = 0; i < archetypes.size(); i++)
+            {
+                Archetype *archetype = archetypes[i].get();
+
+                if((archetype->mask & mask) != mask)
+                    continue;
+
+                for(size_t j = 0; j < archetype->chunks.size(); j++)
+                {
+                    const ArchetypeChunk &chunk = archetype->chunks[j];
+                    func(chunk.count, archetype->GetEntities(chunk), reinterpret_cast<T*>(archetype->GetColumn(chunk, GetTypeId<T>()))...);
+                }
+            }
+        }
+
+        // Calls func(T &...components) once per entity
+        template <typename... T, typename Func>
+        void ForEach(Func &&func)
+        {
+            ForEachChunk<T...>([&func] (uint32_t count, const EntityHandle *entities, T *...columns) {
+                for(uint32_t i = 0; i < count; i++)
+                    func(columns[i]...);
+            });
+        }
+    private:
+        struct EntityRecord
+        {
+            uint32_t archetype;
+            uint32_t chunk;
+            uint32_t row;
+            uint32_t generation;
+        };
+
+        std::vector<std::unique_ptr<Archetype>> archetypes;
+        std::unordered_map<uint64_t, uint32_t> archetypeMap;
+        std::vector<EntityRecord> records;
+        std::vector<uint32_t> freeRecords;
+        size_t entityCount;
+        static uint32_t RegisterType(size_t size, size_t alignment);
+        static uint64_t GetTypeMask(uint32_t typeId);
+        uint32_t GetArchetype(uint64_t mask);
+        EntityHandle CreateEntityWithMask(uint64_t mask);
+        void MoveEntity(EntityHandle entity, uint32_t archetypeIndex);
+        uint8_t *AddType(EntityHandle entity, uint32_t typeId);
+        bool RemoveType(EntityHandle entity, uint32_t typeId);
+        uint8_t *GetType(EntityHandle entity, uint32_t typeId) const;
+    };
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <map>
 #include <cstdint>
 #include <fstream>
+#include "../System/MemoryTracker.hpp"
 
 namespace GFX
 {
@@ -13,6 +14,7 @@ namespace GFX
     {
         FileBuffer(std::ifstream &ifs, uint32_t offset, uint32_t size);
         std::vector<uint8_t> vMemory;
+        MemoryUsage memoryUsage = MemoryUsage(MemoryTag::AssetPack);
     };
 
     struct AssetFile
@@ -2,6 +2,7 @@
 #define GFX_COMPONENT_HPP
 
 #include "Object.hpp"
+#include <cstdlib>
 
 namespace GFX
 {
@@ -11,9 +12,12 @@ namespace GFX
     class Component : public Object
     {
     friend class GameObject;
+    friend class ComponentType;
     public:
         Component();
         virtual ~Component();
+        static void *operator new(size_t size);
+        static void operator delete(void *pointer, size_t size);
         GameObject *GetGameObject() const;
         Transform *GetTransform() const;
     protected:
@@ -24,6 +28,7 @@ namespace GFX
     private:
         GameObject *gameObject;
         Transform *transform;
+        uint32_t typeId;
     };
 }
 
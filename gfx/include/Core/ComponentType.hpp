@@ -0,0 +1,74 @@
+#ifndef GFX_COMPONENTTYPE_HPP
+#define GFX_COMPONENTTYPE_HPP
+
+#include "Component.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+namespace GFX
+{
+    // Assigns every component type a small integer id and remembers which types a concrete component can be cast to.
+    // Each (concrete type, queried type) pair is resolved with a single dynamic_cast the first time it is asked for.
+    class ComponentType
+    {
+    private:
+        static constexpr uint8_t RELATION_UNKNOWN = 0;
+        static constexpr uint8_t RELATION_FALSE = 1;
+        static constexpr uint8_t RELATION_TRUE = 2;
+        static std::atomic<uint32_t> count;
+        static std::atomic<uint8_t> relations[];
+        static uint32_t Register();
+    public:
+        static constexpr uint32_t INVALID_ID = 0xFFFFFFFF;
+        static constexpr uint32_t MAX_TYPES = 256; //Types beyond this are still supported but fall back to dynamic_cast
+
+        template <typename T>
+        static uint32_t GetId()
+        {
+            static_assert(std::is_base_of<Component, T>::value, "GetId parameter must derive from Component");
+            static const uint32_t id = Register();
+            return id;
+        }
+
+        static uint32_t GetId(const Component *component)
+        {
+            return component->typeId;
+        }
+
+        static uint64_t GetMask(uint32_t id)
+        {
+            return 1ULL << (id & 63);
+        }
+
+        template <typename T>
+        static bool IsInstance(const Component *component)
+        {
+            const uint32_t id = GetId<T>();
+            const uint32_t concreteId = component->typeId;
+
+            if(id == concreteId)
+                return true;
+
+            if(id >= MAX_TYPES || concreteId >= MAX_TYPES)
+                return dynamic_cast<const T*>(component) != nullptr;
+
+            //Racing threads resolve the same pair to the same answer, so relaxed ordering is sufficient
+            std::atomic<uint8_t> &relation = relations[concreteId * MAX_TYPES + id];
+            uint8_t value = relation.load(std::memory_order_relaxed);
+
+            if(value == RELATION_UNKNOWN)
+            {
+                value = dynamic_cast<const T*>(component) != nullptr ? RELATION_TRUE : RELATION_FALSE;
+                relation.store(value, std::memory_order_relaxed);
+            }
+
+            return value == RELATION_TRUE;
+        }
+
+        static uint32_t GetCount();
+    };
+}
+
+#endif
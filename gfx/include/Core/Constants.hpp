@@ -26,6 +26,9 @@ namespace GFX
 		MeshSkybox,
 		ShaderHorizontalBlur,
 		ShaderVerticalBlur,
+		ShaderBlurCompute,
+		ShaderBloomThreshold,
+		ShaderBloomComposite,
 		ShaderDepth,
 		ShaderDiffuse,
 		ShaderDiffuseInstanced,
@@ -37,11 +40,13 @@ namespace GFX
 		ShaderProceduralSkybox2,
 		ShaderSkybox,
 		ShaderTerrain,
+		ShaderTonemap,
 		ShaderWater,
 		TextureDefault,
 		TextureDefaultCubeMap,
 		TextureDefaultGrass,
 		TextureDepth,
+		TextureDepthStatic,
 		UniformBufferCamera,
 		UniformBufferLights,
 		UniformBufferShadow,
@@ -4,6 +4,7 @@
 #include "../System/Numerics/Vector3.hpp"
 #include "../System/Numerics/Quaternion.hpp"
 #include "../Graphics/Color.hpp"
+#include <cstdio>
 #include <string>
 #include <functional>
 #include <iostream>
@@ -37,6 +38,8 @@ namespace GFX
     {
     private:
         static DebugLogCallback callback;
+        static void WriteText(const char *text, ConsoleColor color, bool newLine);
+        static void WriteMessage(const char *text, ConsoleMessageType type);
     public:
         static void WriteLine(const std::string &text, ConsoleColor color = ConsoleColor::White);
         static void Write(const std::string &text, ConsoleColor color = ConsoleColor::White);
@@ -48,50 +51,84 @@ namespace GFX
         static void DrawCube(const Vector3 &center, const Vector3 &size, const Quaternion &rotation, const Color &color);
         static void DrawBounds(const Vector3 &min, const Vector3 &max, const Vector3 &position, const Quaternion &rotation, const Color &color);
 
+        static bool IsLoggingEnabled();
+
+        static constexpr size_t FORMAT_STACK_BUFFER_SIZE = 1024;
+
+        //Messages are formatted on the stack, only those that don't fit allocate.
+        //The FrameArena is not used since logging has to work before, between and without frames.
         template<typename... Args>
         static void Write(const std::string &format, Args... args) 
         {
-            std::string buffer;
-            if(FormatArgs(format, buffer, args...))
-            {
-                Write(buffer);
-            }
+            Format(format.c_str(), [] (const char *text) {
+                WriteText(text, ConsoleColor::White, false);
+            }, args...);
         }
 
         template<typename... Args>
         static void WriteLine(const std::string &format, Args... args) 
         {
-            std::string buffer;
-            if(FormatArgs(format, buffer, args...))
-            {
-                WriteLine(buffer);
-            }
+            Format(format.c_str(), [] (const char *text) {
+                WriteText(text, ConsoleColor::White, true);
+            }, args...);
         }
         
         template<typename... Args>
         static void WriteLog(const std::string &format, Args... args) 
         {
-            std::string buffer;
-            if(FormatArgs(format, buffer, args...))
-            {
-                WriteLog(buffer);
-            }
+            if(!IsLoggingEnabled())
+                return;
+
+            Format(format.c_str(), [] (const char *text) {
+                WriteMessage(text, ConsoleMessageType::Log);
+            }, args...);
         }
 
         template<typename... Args>
         static void WriteError(const std::string &format, Args... args) 
         {
-            std::string buffer;
-            if(FormatArgs(format, buffer, args...))
+            if(!IsLoggingEnabled())
+                return;
+
+            Format(format.c_str(), [] (const char *text) {
+                WriteMessage(text, ConsoleMessageType::Error);
+            }, args...);
+        }
+
+        template<typename Callback, typename... Args>
+        static void Format(const char *format, const Callback &callback, Args... args)
+        {
+            char stackBuffer[FORMAT_STACK_BUFFER_SIZE];
+            int size = std::snprintf(stackBuffer, sizeof(stackBuffer), format, args...);
+
+            if(size < 0)
+            {
+                std::cerr << "Error: snprintf failed!" << std::endl;
+                return;
+            }
+
+            if(static_cast<size_t>(size) < sizeof(stackBuffer))
             {
-                WriteError(buffer);
+                callback(stackBuffer);
+                return;
             }
+
+            //The length is known now, so the large message only needs one more pass
+            std::string buffer(static_cast<size_t>(size), '\0');
+            std::snprintf(&buffer[0], buffer.size() + 1, format, args...);
+            callback(buffer.c_str());
         }
 
-        template<typename... Args>
-        static bool FormatArgs(const std::string &format, std::string &buffer, Args... args) 
+        template<typename String, typename... Args>
+        static bool FormatArgs(const std::string &format, String &buffer, Args... args) 
+        {
+            return FormatArgs(format.c_str(), buffer, args...);
+        }
+
+        template<typename String, typename... Args>
+        static bool FormatArgs(const char *format, String &buffer, Args... args) 
         {
-            int size = std::snprintf(nullptr, 0, format.c_str(), args...);
+            int size = std::snprintf(nullptr, 0, format, args...);
             if (size < 0) 
             {
                 std::cerr << "Error: snprintf failed!" << std::endl;
@@ -100,7 +137,7 @@ namespace GFX
 
             buffer.resize(size + 1);
             buffer[buffer.size() - 1] = '\0';
-            std::snprintf(&buffer[0], buffer.size(), format.c_str(), args...);
+            std::snprintf(&buffer[0], buffer.size(), format, args...);
             return true;
         }
     };
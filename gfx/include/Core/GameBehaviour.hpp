@@ -2,21 +2,77 @@
 #define GFX_GAMEBEHAVIOUR_HPP
 
 #include "Component.hpp"
+#include "ComponentType.hpp"
 #include "Resource.hpp"
 #include <cstdint>
 #include <string>
+#include <typeindex>
 #include <vector>
 
 namespace GFX
 {
+    class GameBehaviour;
+
+    // Declares which component types a GameBehaviour type touches in OnUpdate, OnLateUpdate and OnFixedUpdate.
+    // Types that declare nothing are exclusive: they run alone on the main thread, in the order they were created.
+    struct BehaviourAccess
+    {
+        bool isDeclared;
+        bool isParallel; //Instances are independent of each other and may be split across threads
+        uint64_t reads;
+        uint64_t writes;
+        BehaviourAccess();
+        static BehaviourAccess Exclusive();
+        static BehaviourAccess Declared();
+        static BehaviourAccess Parallel();
+        bool ConflictsWith(const BehaviourAccess &other) const;
+
+        template <typename... T>
+        BehaviourAccess &Read()
+        {
+            isDeclared = true;
+            reads |= (0ULL | ... | ComponentType::GetMask(ComponentType::GetId<T>()));
+            return *this;
+        }
+
+        template <typename... T>
+        BehaviourAccess &Write()
+        {
+            isDeclared = true;
+            writes |= (0ULL | ... | ComponentType::GetMask(ComponentType::GetId<T>()));
+            return *this;
+        }
+    };
+
+    struct BehaviourGroup
+    {
+        std::type_index type;
+        BehaviourAccess access;
+        uint32_t wave;
+        std::vector<GameBehaviour*> behaviours;
+        BehaviourGroup(std::type_index type, const BehaviourAccess &access);
+    };
+
     class GameBehaviour : public Component
     {
 	friend class Application;
+	friend class Testing;
 	friend class Graphics;
     friend class Resources;
     friend class PostProcessingRenderer;
 	private:
 		static std::vector<GameBehaviour*> behaviours;
+        static std::vector<GameBehaviour*> pendingBehaviours;
+        static std::vector<BehaviourGroup> groups;
+        static size_t removedCount;
+        static uint32_t waveCount;
+        static bool parallelUpdate;
+        uint32_t orderIndex;
+        uint32_t groupIndex;
+        uint32_t groupSlot;
+        static void ResolvePendingBehaviours();
+        static void CompactBehaviours();
+        static void RunPhase(void (GameBehaviour::*method)());
 		static void NewFrame();
 		static void EndFrame();
         static void OnBehaviourApplicationQuit();
@@ -38,11 +94,14 @@ namespace GFX
         virtual void OnEndFrame();
         virtual void OnResourceLoadedAsync(const Resource &resource);
         virtual void OnResourceBatchLoadedAsync(const ResourceBatch &resourceBatch);
+        virtual BehaviourAccess GetAccess() const;
         static void AddBehaviour(GameBehaviour *behaviour);
         static void RemoveBehaviour(GameBehaviour *behaviour);
     public:
         GameBehaviour();
         virtual ~GameBehaviour();
+        static void SetParallelUpdate(bool enabled);
+        static bool GetParallelUpdate();
     };
 }
 
@@ -3,9 +3,14 @@
 
 #include "Object.hpp"
 #include "Component.hpp"
+#include "ComponentType.hpp"
 #include "Transform.hpp"
+#include "../System/FrameArena.hpp"
+#include <cstdint>
+#include <cstdlib>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 namespace GFX
 {
@@ -36,29 +41,91 @@ namespace GFX
         Water
     };
 
+    struct ComponentSlot
+    {
+        uint32_t typeId;
+        uint32_t index; //First component of this exact type
+    };
+
+    // Refers to a GameObject created with GameObject::Create without owning it.
+    // The generation changes once the object is released, so a stale handle resolves to nullptr instead of whatever reused the slot.
+    struct GameObjectHandle
+    {
+        uint32_t index;
+        uint32_t generation;
+        GameObjectHandle();
+        GameObjectHandle(uint32_t index, uint32_t generation);
+        bool operator==(const GameObjectHandle &other) const;
+        bool operator!=(const GameObjectHandle &other) const;
+    };
+
+    struct GameObjectSlot
+    {
+        GameObject *object;
+        uint32_t generation;
+    };
+
+    class GameObject;
+
+    //Objects grouped by interned name or tag
+    using GameObjectLookup = std::unordered_map<uint64_t, std::vector<GameObject*>>;
+
     class GameObject : public Object
     {
     friend class GameBehaviour;
+    friend class SceneSerializer;
     private:
         Transform transform;
         bool isActive;
         Layer layer;
         std::vector<std::unique_ptr<Component>> components;
-        static std::vector<std::unique_ptr<GameObject>> objects;
-        static std::vector<GameObject*> destroyQueue;
-        static void DestroyImmediate(GameObject *object);
+        std::vector<ComponentSlot> componentSlots;
+        uint64_t componentMask;
+        uint32_t objectIndex;   //Into objects, only set for objects made with Create
+        GameObjectHandle handle;
+        bool isDestroyed;
+        StringId tag;
+        uint32_t nameLookupIndex;   //Positions in nameLookup and tagLookup, so leaving them does not have to search
+        uint32_t tagLookupIndex;
+        static std::vector<GameObject*> objects;
+        static std::vector<GameObjectSlot> slots;
+        static std::vector<uint32_t> freeSlots;
+        static std::vector<GameObjectHandle> destroyQueue;    //Handles, so objects released in the meantime are skipped
+        static GameObjectLookup nameLookup;
+        static GameObjectLookup tagLookup;
         static void OnEndFrame();
-        static void RemoveObject(GameObject *object);
+        static void Register(GameObject *object);
+        static void Unregister(GameObject *object);
         static void DestroyAll();
+        static void AddToLookup(GameObjectLookup &lookup, StringId key, GameObject *object, uint32_t GameObject::*lookupIndex);
+        static void RemoveFromLookup(GameObjectLookup &lookup, StringId key, GameObject *object, uint32_t GameObject::*lookupIndex);
+        static GameObject *FindInLookup(const GameObjectLookup &lookup, StringId key);
+        void AddComponentSlot(uint32_t typeId, size_t index);
+        size_t FindComponentSlot(uint32_t typeId) const;
+    protected:
+        void OnNameChanged(StringId previousName) override;
     public:
         GameObject();
         ~GameObject();
+        static void *operator new(size_t size);
+        static void operator delete(void *pointer, size_t size);
         Transform *GetTransform();
+        GameObjectHandle GetHandle() const;
         void SetIsActive(bool isActive);
         bool GetIsActive() const;
         void SetLayer(Layer layer, bool recursive = true);
         Layer GetLayer() const;
-        static void Destroy(GameObject *object);        
+        void SetTag(const std::string &tag);
+        void SetTag(StringId tag);
+        StringId GetTag() const;
+        bool CompareTag(StringId tag) const;
+        static void Destroy(GameObject *object);
+        static void Destroy(const GameObjectHandle &handle);
+        static GameObject *Get(const GameObjectHandle &handle);
+        static GameObject *Find(const std::string &name);
+        static GameObject *Find(StringId name);
+        static GameObject *FindWithTag(const std::string &tag);
+        static GameObject *FindWithTag(StringId tag);
         static GameObject *Create();
         static GameObject *CreatePrimitive(PrimitiveType type);
 
@@ -67,65 +134,72 @@ namespace GFX
         {
             static_assert(std::is_base_of<Component, T>::value, "GetComponent parameter must derive from Component");
 
-            T *ptr = nullptr;
+            const uint32_t typeId = ComponentType::GetId<T>();
+            size_t count = components.size();
 
-            for(size_t i = 0; i < components.size(); i++)
+            //When the exact type is attached only the components in front of it can still win through inheritance
+            if(componentMask & ComponentType::GetMask(typeId))
+                count = FindComponentSlot(typeId);
+
+            for(size_t i = 0; i < count; i++)
             {
-                ptr = dynamic_cast<T*>(components[i].get());
-                if(ptr)
-                    return ptr;
+                if(ComponentType::IsInstance<T>(components[i].get()))
+                    return static_cast<T*>(components[i].get());
             }
+
+            if(count < components.size())
+                return static_cast<T*>(components[count].get());
+
             return nullptr;
         }
 
-        template <typename T>
-        std::vector<T*> GetComponentsOfType() const
+        template <typename T, typename Visitor>
+        void ForEachComponentOfType(Visitor &&visitor) const
         {
-            static_assert(std::is_base_of<Component, T>::value, "GetComponentsOfType parameter must derive from Component");
-
-            std::vector<T*> targets;
+            static_assert(std::is_base_of<Component, T>::value, "ForEachComponentOfType parameter must derive from Component");
 
             for(size_t i = 0; i < components.size(); i++)
             {
-                T* ptr = dynamic_cast<T*>(components[i].get());
-                if(ptr)
-                {
-                    targets.push_back(ptr);
-                }
+                if(ComponentType::IsInstance<T>(components[i].get()))
+                    visitor(static_cast<T*>(components[i].get()));
             }
-            return targets;
         }
 
-        template <typename T>
-        std::vector<T*> GetComponentsOfTypeInChildren() const
+        template <typename T, typename Visitor>
+        void ForEachComponentOfTypeInChildren(Visitor &&visitor) const
         {
-            static_assert(std::is_base_of<Component, T>::value, "GetComponentsOfTypeInChildren parameter must derive from Component");
+            static_assert(std::is_base_of<Component, T>::value, "ForEachComponentOfTypeInChildren parameter must derive from Component");
 
-            std::vector<T*> allComponents;
-
-            // Get components of the current GameObject
-            for (size_t i = 0; i < components.size(); i++)
-            {
-                T* ptr = dynamic_cast<T*>(components[i].get());
-                if (ptr)
-                {
-                    allComponents.push_back(ptr);
-                }
-            }
-
-            // Recursively get components from children using the Transform's GetChildren
-            //auto &children = transform.GetChildren();
+            ForEachComponentOfType<T>(visitor);
 
             Transform *child = nullptr;
             size_t index = 0;
 
             while((child = transform.GetChild(index++)) != nullptr)
             {
-                auto childComponents = child->GetGameObject()->GetComponentsOfTypeInChildren<T>();
-                allComponents.insert(allComponents.end(), childComponents.begin(), childComponents.end());
+                child->GetGameObject()->ForEachComponentOfTypeInChildren<T>(visitor);
             }
+        }
+
+        //Pass FrameAllocator<T*> for a result that is only used this frame
+        template <typename T, typename Allocator = std::allocator<T*>>
+        std::vector<T*, Allocator> GetComponentsOfType() const
+        {
+            static_assert(std::is_base_of<Component, T>::value, "GetComponentsOfType parameter must derive from Component");
+
+            std::vector<T*, Allocator> targets;
+            ForEachComponentOfType<T>([&targets] (T *component) { targets.push_back(component); });
+            return targets;
+        }
 
-            return allComponents;
+        template <typename T, typename Allocator = std::allocator<T*>>
+        std::vector<T*, Allocator> GetComponentsOfTypeInChildren() const
+        {
+            static_assert(std::is_base_of<Component, T>::value, "GetComponentsOfTypeInChildren parameter must derive from Component");
+
+            std::vector<T*, Allocator> targets;
+            ForEachComponentOfTypeInChildren<T>([&targets] (T *component) { targets.push_back(component); });
+            return targets;
         }
 
         // template <typename T, typename... Param>
@@ -159,6 +233,8 @@ namespace GFX
             components.push_back(std::move(ptr));
             size_t last = components.size() - 1;
             Component* component = components[last].get();
+            component->typeId = ComponentType::GetId<T>();
+            AddComponentSlot(component->typeId, last);
             component->gameObject = this;
             component->transform = &this->transform;
             component->OnInitialize();
@@ -4,6 +4,7 @@
 #include "Keyboard.hpp"
 #include "Mouse.hpp"
 #include "../External/glm/glm.hpp"
+#include "../System/StringId.hpp"
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
@@ -23,7 +24,7 @@ namespace GFX
     class AxisInfo
     {
     public:
-        std::string name;
+        StringId name;
         std::vector<AxisKeys> keys;
         AxisInfo();
         AxisInfo(const std::string &name);
@@ -36,7 +37,7 @@ namespace GFX
 	private:
         static Keyboard keyboard;
         static Mouse mouse;
-        static std::unordered_map<std::string, AxisInfo> keyToAxisMap;
+        static std::unordered_map<StringId, AxisInfo, StringIdHash> keyToAxisMap;
         static void NewFrame();
         static void EndFrame();
         static void SetMousePosition(double x, double y);
@@ -49,6 +50,7 @@ namespace GFX
         static void Initialize();
         static void RegisterAxis(const AxisInfo &axisInfo);
         static float GetAxis(const std::string &axis);
+        static float GetAxis(StringId axis);
         static bool GetKey(KeyCode keycode);
         static bool GetKeyDown(KeyCode keycode);
         static bool GetKeyUp(KeyCode keycode);
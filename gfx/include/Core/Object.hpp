@@ -1,6 +1,7 @@
 #ifndef GFX_OBJECT_HPP
 #define GFX_OBJECT_HPP
 
+#include "../System/StringId.hpp"
 #include <cstdint>
 #include <string>
 
@@ -10,13 +11,17 @@ namespace GFX
     {
     private:
         uint64_t id;
-        std::string name;
+        StringId name;
+    protected:
+        virtual void OnNameChanged(StringId previousName);
     public:
         Object();
         virtual ~Object();
         uint64_t GetInstanceId() const;
         void SetName(const std::string name);
+        void SetName(StringId name);
         std::string GetName() const;
+        StringId GetNameId() const;
     };
 }
 
@@ -19,6 +19,7 @@ namespace GFX
 	class Resources
 	{
 	friend class Application;
+	friend class SceneSerializer;
 	private:
 		static ConcurrentQueue<Resource> resourceQueue;
 		static ConcurrentQueue<ResourceBatch> resourceBatchQueue;
@@ -0,0 +1,188 @@
+#ifndef GFX_SCENESERIALIZER_HPP
+#define GFX_SCENESERIALIZER_HPP
+
+#include "GameObject.hpp"
+#include "ComponentType.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace GFX
+{
+    class Mesh;
+    class Texture2D;
+
+    enum class SceneResourceType : uint32_t
+    {
+        Mesh,
+        Texture2D
+    };
+
+    // On disk layout, every section starts on a 16 byte boundary and is addressed by its offset from the start of the file.
+    // Nothing in the file holds a pointer, so it can be used straight from a memory mapping wherever it ends up.
+    struct SceneFileHeader
+    {
+        uint8_t identifier[8];
+        uint32_t endianness;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t objectCount;
+        uint32_t resourceCount;
+        uint32_t componentTableCount;
+        uint64_t objectsOffset;
+        uint64_t resourcesOffset;
+        uint64_t componentTablesOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+        uint64_t fileSize;
+    };
+
+    struct SceneObjectRecord
+    {
+        int32_t parent;             //Parents always come before their children, -1 for a root
+        uint32_t nameOffset;        //Into the string section
+        uint32_t nameLength;
+        uint32_t isActive;
+        int32_t layer;
+        float position[3];          //Local space
+        float rotation[4];          //x, y, z, w
+        float scale[3];
+    };
+
+    struct SceneResourceRecord
+    {
+        uint32_t type;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t padding;
+        uint64_t contentHash;
+    };
+
+    struct SceneComponentTable
+    {
+        uint64_t typeHash;          //Hash of the name the component type was registered with
+        uint32_t count;
+        uint32_t padding;
+        uint64_t entriesOffset;     //SceneComponentEntry array
+    };
+
+    struct SceneComponentEntry
+    {
+        uint32_t objectIndex;
+        uint32_t dataSize;
+        uint64_t dataOffset;        //Into the data section
+    };
+
+    // Collects the data of a single component while a scene is written
+    class SceneWriter
+    {
+    friend class SceneSerializer;
+    private:
+        std::vector<uint8_t> *data;
+        std::vector<SceneResourceRecord> *resources;
+        std::unordered_map<uint64_t,uint32_t> *resourceMap;
+        std::string *strings;
+        SceneWriter();
+    public:
+        void Write(const void *bytes, size_t size);
+        uint32_t AddResource(SceneResourceType type, const std::string &name, uint64_t contentHash);
+        uint32_t AddMesh(Mesh *mesh);
+        uint32_t AddTexture2D(Texture2D *texture);
+
+        template <typename T>
+        void Write(const T &value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Write parameter must be trivially copyable");
+            Write(&value, sizeof(T));
+        }
+    };
+
+    // Reads back the data of a single component, the bytes point straight into the scene file
+    class SceneReader
+    {
+    friend class SceneSerializer;
+    private:
+        const uint8_t *data;
+        size_t size;
+        size_t offset;
+        const std::vector<void*> *resources;
+        const SceneResourceRecord *resourceRecords;
+        uint32_t resourceCount;
+        SceneReader();
+    public:
+        bool Read(void *bytes, size_t size);
+        const uint8_t *GetData() const;
+        size_t GetSize() const;
+        Mesh *GetMesh(uint32_t resourceIndex) const;
+        Texture2D *GetTexture2D(uint32_t resourceIndex) const;
+
+        template <typename T>
+        bool Read(T &value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Read parameter must be trivially copyable");
+            return Read(&value, sizeof(T));
+        }
+    };
+
+    using SceneResourceResolver = std::function<void*(SceneResourceType type, const std::string &name, uint64_t contentHash)>;
+
+    // Versioned binary scene format.
+    // Objects, resources and components are stored in flat tables so a scene is validated once and then instantiated in bulk.
+    // Transforms are always stored, other components only when their type was registered with RegisterComponent.
+    // Resources are referenced by content hash, the name is only a hint for finding them.
+    class SceneSerializer
+    {
+    friend class SceneWriter;
+    private:
+        struct ComponentSerializer
+        {
+            std::string name;
+            uint64_t typeHash;
+            std::function<bool(const Component*,SceneWriter&)> save;
+            std::function<void(GameObject*,SceneReader&)> load;
+        };
+        static std::vector<ComponentSerializer> serializers;
+        static std::vector<uint32_t> serializerIndices;    //Component type id to serializer
+        static std::unordered_map<uint64_t,uint32_t> serializerMap;
+        static SceneResourceResolver resourceResolver;
+        static void RegisterBuiltInComponents();
+        static void AddSerializer(uint32_t typeId, ComponentSerializer &&serializer);
+        static void *ResolveResource(SceneResourceType type, const std::string &name, uint64_t contentHash);
+        static bool FindResourceName(Texture2D *texture, std::string &name);
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        template <typename T>
+        static void RegisterComponent(const std::string &name, const std::function<bool(const T*,SceneWriter&)> &save, const std::function<void(T*,SceneReader&)> &load)
+        {
+            static_assert(std::is_base_of<Component, T>::value, "RegisterComponent parameter must derive from Component");
+
+            ComponentSerializer serializer;
+            serializer.name = name;
+            serializer.save = [save] (const Component *component, SceneWriter &writer) {
+                return save(static_cast<const T*>(component), writer);
+            };
+            serializer.load = [load] (GameObject *gameObject, SceneReader &reader) {
+                load(gameObject->AddComponent<T>(), reader);
+            };
+            AddSerializer(ComponentType::GetId<T>(), std::move(serializer));
+        }
+
+        static void SetResourceResolver(const SceneResourceResolver &resolver);
+        static uint64_t GetContentHash(Mesh *mesh);
+        static uint64_t GetContentHash(Texture2D *texture, const std::string &name);
+        static void Write(const std::vector<GameObject*> &roots, std::vector<uint8_t> &data);
+        static bool Read(const uint8_t *data, size_t size, std::vector<GameObject*> &objects);
+        static bool Save(const std::string &filepath, const std::vector<GameObject*> &roots);
+        static bool Load(const std::string &filepath, std::vector<GameObject*> &objects);
+    };
+}
+
+#endif
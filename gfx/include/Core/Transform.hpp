@@ -2,6 +2,7 @@
 #define GFX_TRANSFORM_HPP
 
 #include "Component.hpp"
+#include "ArchetypeComponent.hpp"
 #include "../System/Numerics/Vector3.hpp"
 #include "../System/Numerics/Quaternion.hpp"
 #include "../System/Numerics/Matrix3.hpp"
@@ -17,6 +18,16 @@ namespace GFX
         Vector3 scale;
     };
 
+    // The part of a Transform that is read every frame, packed into the chunks of ArchetypeStorage::GetDefault()
+    struct TransformState
+    {
+        Vector3 localPosition;
+        Quaternion localRotation;
+        Vector3 localScale;
+        Matrix4 worldMatrix;
+        bool isDirty;   //worldMatrix has to be recalculated
+    };
+
     // class Transform : public Component
     // {
     // private:
@@ -85,21 +96,19 @@ namespace GFX
     class Transform : public Component
     {
         private:
-        Vector3 localPosition;
-        Quaternion localRotation;
-        Vector3 localScale;
+        ArchetypeState<TransformState> state;
         Vector3 velocity;
         Vector3 previousPosition;
         Vector3 newRotation;
         Transform* parent;
         Transform* root;
         std::vector<Transform*> children;
-        mutable Matrix4 cachedWorldMatrix;
-        mutable bool isDirty;
-        void RecalculateModelMatrix() const;
+        void RecalculateModelMatrix(TransformState &data) const;
         void MarkDirty();
     public:
         Transform();
+        TransformState *GetState() const;
+        EntityHandle GetEntity() const;
         std::vector<Transform*> &GetChildren();
         std::vector<Transform*> GetChildrenRecursive() const;
         Transform *GetChild(size_t index) const;
@@ -131,6 +140,7 @@ namespace GFX
         void Rotate(const Quaternion &rotation);
         void Rotate(const Vector3 &rotation);
         Transform *FindChild(const std::string &name);
+        Transform *FindChild(StringId name);
         Vector3 WorldToLocal(const Vector3 &v);
         Vector3 WorldToLocalVector(const Vector3 &v);
         Vector3 LocalToWorld(const Vector3 &v);
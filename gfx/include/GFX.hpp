@@ -9,14 +9,21 @@
 #include "System/Numerics/Quaternion.hpp"
 #include "System/Numerics/Vector3.hpp"
 #include "System/String.hpp"
+#include "System/StringId.hpp"
+#include "System/Hash.hpp"
 #include "System/Mathf.hpp"
 #include "System/BitConverter.hpp"
 #include "System/Collections/ConcurrentList.hpp"
 #include "System/Collections/ConcurrentQueue.hpp"
 #include "System/EventHandler.hpp"
+#include "System/JobSystem.hpp"
 #include "System/Random.hpp"
+#include "System/SlabAllocator.hpp"
+#include "System/FrameArena.hpp"
+#include "System/MemoryTracker.hpp"
 #include "System/IO/BinaryStream.hpp"
 #include "System/IO/File.hpp"
+#include "System/IO/MemoryMappedFile.hpp"
 #include "External/imgui/imgui.h"
 #include "External/imgui/imgui_internal.h"
 #include "External/imgui/imgui_stdlib.h"
@@ -31,7 +38,14 @@
 #include "Graphics/Graphics2D.hpp"
 #include "Graphics/World.hpp"
 #include "Graphics/Font.hpp"
+#include "Graphics/GlyphAtlas.hpp"
+#include "Graphics/TextLayoutCache.hpp"
 #include "Graphics/Mesh.hpp"
+#include "Graphics/LODGroup.hpp"
+#include "Graphics/MeshOptimizer.hpp"
+#include "Graphics/MeshSimplifier.hpp"
+#include "Graphics/ModelCache.hpp"
+#include "Graphics/ModelProcessor.hpp"
 #include "Graphics/Image.hpp"
 #include "Graphics/CascadedShadowMapper.hpp"
 #include "Graphics/Materials/ProceduralSkybox2Material.hpp"
@@ -45,6 +59,7 @@
 #include "Graphics/Materials/TerrainMaterial.hpp"
 #include "Graphics/Graphics.hpp"
 #include "Graphics/Vertex.hpp"
+#include "Graphics/VertexLayout.hpp"
 #include "Graphics/GUITextBuffer.hpp"
 #include "Graphics/Renderers/Terrain.hpp"
 #include "Graphics/Renderers/MeshRenderer.hpp"
@@ -52,6 +67,7 @@
 #include "Graphics/Renderers/LineRenderer.hpp"
 #include "Graphics/Renderers/ParticleSystem.hpp"
 #include "Graphics/Renderers/PostProcessingRenderer.hpp"
+#include "Graphics/PostProcessingGraph.hpp"
 #include "Graphics/Frustum.hpp"
 #include "Graphics/GUILayout.hpp"
 #include "Graphics/ModelImporter.hpp"
@@ -62,6 +78,10 @@
 #include "Graphics/Shaders/PostProcessing/HorizontalBlurShader.hpp"
 #include "Graphics/Shaders/PostProcessing/GrayscaleShader.hpp"
 #include "Graphics/Shaders/PostProcessing/VerticalBlurShader.hpp"
+#include "Graphics/Shaders/PostProcessing/TonemapShader.hpp"
+#include "Graphics/Shaders/PostProcessing/BlurComputeShader.hpp"
+#include "Graphics/Shaders/PostProcessing/BloomThresholdShader.hpp"
+#include "Graphics/Shaders/PostProcessing/BloomCompositeShader.hpp"
 #include "Graphics/Shaders/SkyboxShader.hpp"
 #include "Graphics/Shaders/CoreShaderInclude.hpp"
 #include "Graphics/Shaders/TerrainShader.hpp"
@@ -76,8 +96,11 @@
 #include "Graphics/GUI.hpp"
 #include "Graphics/Graphics3D.hpp"
 #include "Graphics/Texture2D.hpp"
+#include "Graphics/TextureCompressor.hpp"
+#include "Graphics/TextureStreamer.hpp"
 #include "Graphics/Texture.hpp"
 #include "Graphics/Buffers/UniformBufferObject.hpp"
+#include "Graphics/Buffers/RenderTexturePool.hpp"
 #include "Graphics/Buffers/FrameBufferObject.hpp"
 #include "Graphics/Buffers/VertexBufferObject.hpp"
 #include "Graphics/Buffers/ElementBufferObject.hpp"
@@ -95,6 +118,7 @@
 #include "Physics/Collision/Collider.hpp"
 #include "Physics/Collision/WheelCollider.hpp"
 #include "Physics/Collision/CylinderCollider.hpp"
+#include "Physics/Collision/ShapeCache.hpp"
 #include "Physics/Rigidbody.hpp"
 #include "Physics/Physics.hpp"
 #include "Audio/Audio.hpp"
@@ -117,12 +141,16 @@
 #include "Core/GameBehaviour.hpp"
 #include "Core/Camera.hpp"
 #include "Core/Component.hpp"
+#include "Core/ComponentType.hpp"
+#include "Core/ArchetypeStorage.hpp"
+#include "Core/ArchetypeComponent.hpp"
 #include "Core/AssetPack.hpp"
 #include "Core/Keyboard.hpp"
 #include "Core/Resources.hpp"
 #include "Core/Time.hpp"
 #include "Core/Application.hpp"
 #include "Core/Transform.hpp"
+#include "Core/SceneSerializer.hpp"
 #include "Core/Constants.hpp"
 #include "Core/Light.hpp"
 #include "Core/Input.hpp"
@@ -14,8 +14,11 @@ private:
     GLuint depthAttachmentId;
     uint32_t width;
     uint32_t height;
+    uint32_t allocatedWidth;
+    uint32_t allocatedHeight;
     bool multiSample;
     bool hdr;
+    void Allocate();
 public:
     FrameBufferObject();
     FrameBufferObject(uint32_t width, uint32_t height, bool multiSample, bool hdr);
@@ -35,6 +38,9 @@ public:
     GLuint GetDepthId() const;
     uint32_t GetWidth() const;
     uint32_t GetHeight() const;
+    uint32_t GetAllocatedWidth() const;
+    uint32_t GetAllocatedHeight() const;
+    static uint32_t GetSizeClass(uint32_t size);
 };
 
 	// class FrameBufferObject
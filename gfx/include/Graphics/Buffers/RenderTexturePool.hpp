@@ -0,0 +1,49 @@
+#ifndef GFX_RENDERTEXTUREPOOL_HPP
+#define GFX_RENDERTEXTUREPOOL_HPP
+
+#include "../../External/glad/glad.h"
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+namespace GFX
+{
+    struct RenderTexture
+    {
+        GLuint fbo;
+        GLuint textureId;
+        GLenum format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t allocatedWidth;
+        uint32_t allocatedHeight;
+        uint64_t lastUsedFrame;
+        bool inUse;
+        RenderTexture();
+        float GetUVScaleX() const;
+        float GetUVScaleY() const;
+    };
+
+    // Color-only render targets for intermediate passes. Targets are allocated in size classes
+    // so they survive window resizes, and are released after not being used for a number of frames.
+    class RenderTexturePool
+    {
+    private:
+        std::vector<std::unique_ptr<RenderTexture>> textures;
+        uint64_t frame;
+        uint32_t maxUnusedFrames;
+        void Allocate(RenderTexture *texture);
+        void Destroy(RenderTexture *texture);
+    public:
+        RenderTexturePool();
+        RenderTexture *Acquire(uint32_t width, uint32_t height, GLenum format = GL_RGBA16F);
+        void Release(RenderTexture *texture);
+        void NewFrame();
+        void Delete();
+        void SetMaxUnusedFrames(uint32_t frames);
+        uint32_t GetMaxUnusedFrames() const;
+        size_t GetCount() const;
+    };
+}
+
+#endif
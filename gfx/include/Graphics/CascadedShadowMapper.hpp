@@ -9,8 +9,7 @@ namespace GFX
 	class CascadedShadowMapper
 	{
 	private:
-		void CalculateFrustumCorners(const glm::mat4 &inverseViewProj,
-									 std::vector<glm::vec3> &outCorners) const;
+		static void CalculateFrustumCorners(const glm::mat4 &inverseViewProj, glm::vec3 *outCorners);
 		void CalculateOrthoProjs(const glm::mat4 &cameraView, float fov, float aspect,
 								 float cameraNear, float cameraFar, const glm::vec3 &lightDir);
 
@@ -33,6 +32,11 @@ namespace GFX
 		void BeginRenderCascade(int cascadeIndex);
 		const glm::mat4 &GetLightVP(int cascadeIndex) const;
 
+		// Fits an orthographic projection around the bounding sphere of a frustum slice and snaps it to the shadow map texel grid,
+		// so the projection only changes when the camera has moved a whole texel. lightDir is the direction the shadow camera looks along.
+		static glm::mat4 CalculateStableLightMatrix(const glm::mat4 &inverseViewProj, const glm::vec3 &lightDir, int shadowMapSize,
+													float depthPadding, glm::vec3 &center, float &radius);
+
 		// Getters for shader uniforms
 		unsigned int GetShadowMapArray() const { return shadowMapArray; }
 		const std::vector<float> &GetSplitDepths() const { return cascadeSplits; }
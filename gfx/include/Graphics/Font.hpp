@@ -2,36 +2,30 @@
 #define GFX_FONT_HPP
 
 #include "Image.hpp"
+#include "GlyphAtlas.hpp"
 #include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
 
 typedef struct FT_FaceRec_* FT_Face;
+typedef struct FT_LibraryRec_* FT_Library;
 
 namespace GFX 
 {
-    struct Glyph 
-	{
-        int32_t sizeX, sizeY;
-        int32_t advanceX, advanceY;
-        int32_t bearingX, bearingY;
-        int64_t height;
-        int32_t bottomBearing;
-        int32_t leftBearing;
-        float u0, v0;
-        float u1, v1;
-    };
-
     enum class FontRenderMethod
     {
         Normal,
         SDF
     };
 
+    struct FontData;
+
     class Font 
 	{
+	friend class Graphics2D;
     public:
         Font();
         Font(const Font &other);
@@ -45,7 +39,13 @@ namespace GFX
         uint32_t GetPixelSize() const;
         uint32_t GetMaxHeight() const;
         uint32_t GetTexture() const;
+        uint32_t GetTexture(uint32_t page) const;
         Glyph *GetGlyph(char c);
+        Glyph *FindGlyph(uint32_t codepoint);
+        void UpdateTextures();
+        void MarkPageUsed(uint32_t page);
+        GlyphAtlas *GetAtlas() const;
+        uint64_t GetId() const;
         uint32_t GetCodePointOfFirstChar() const;
         void CalculateBounds(const char *text, size_t size, float fontSize, float &width, float &height);
         void CalculateCharacterPosition(const char *text, size_t size, size_t characterIndex, float fontSize, float &x, float &y);
@@ -56,14 +56,16 @@ namespace GFX
         FontRenderMethod GetRenderMethod() const;
     private:
         uint32_t pixelSize;
-        uint32_t textureId;
         uint32_t maxHeight;
         uint32_t lineHeight;
         uint32_t codePointOfFirstChar;
-        std::vector<Glyph> glyphs;
-        std::vector<uint8_t> textureData;
+        float baseYOffset;
         FontRenderMethod renderMethod;
-        bool Load(FT_Face fontFace);
+        std::shared_ptr<FontData> data; //Shared between copies
+        static uint64_t frameIndex;
+        static void NewFrame();
+        Glyph *RasterizeGlyph(uint32_t codepoint);
+        bool Load(FT_Library library, FT_Face fontFace);
     };
 }
 
@@ -0,0 +1,107 @@
+#ifndef GFX_GLYPHATLAS_HPP
+#define GFX_GLYPHATLAS_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <unordered_map>
+
+namespace GFX
+{
+    struct Glyph
+	{
+        int32_t sizeX, sizeY;
+        int32_t advanceX, advanceY;
+        int32_t bearingX, bearingY;
+        int64_t height;
+        int32_t bottomBearing;
+        int32_t leftBearing;
+        float u0, v0;
+        float u1, v1;
+        uint32_t page;
+    };
+
+    struct GlyphAtlasRect
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+        GlyphAtlasRect();
+        GlyphAtlasRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+        bool IsEmpty() const;
+        void Merge(const GlyphAtlasRect &other);
+    };
+
+    // Skyline bottom-left rectangle packer
+    class SkylinePacker
+    {
+    public:
+        SkylinePacker();
+        SkylinePacker(uint32_t width, uint32_t height);
+        void Reset(uint32_t width, uint32_t height);
+        bool Pack(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y);
+        uint32_t GetWidth() const;
+        uint32_t GetHeight() const;
+        uint64_t GetUsedArea() const;
+    private:
+        struct SkylineNode
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+        std::vector<SkylineNode> nodes;
+        uint32_t width;
+        uint32_t height;
+        uint64_t usedArea;
+        bool Fit(size_t index, uint32_t width, uint32_t height, uint32_t &y) const;
+    };
+
+    struct GlyphAtlasPage
+    {
+        SkylinePacker packer;
+        std::vector<uint8_t> pixels;
+        GlyphAtlasRect dirtyRect;
+        uint64_t lastUsedFrame;
+        uint32_t glyphCount;
+    };
+
+    // Single channel glyph atlas spread over a bounded number of pages.
+    // When all pages are full, the least recently used page is cleared and reused.
+    // Does not touch OpenGL; the owner uploads the dirty rectangle of each page.
+    class GlyphAtlas
+    {
+    public:
+        GlyphAtlas();
+        void Initialize(uint32_t pageWidth, uint32_t pageHeight, uint32_t maxPages, uint32_t padding = 2);
+        void Clear();
+        Glyph *Find(uint32_t codepoint, uint64_t frame);
+        Glyph *Insert(uint32_t codepoint, const Glyph &metrics, const uint8_t *bitmap, uint32_t bitmapWidth, uint32_t bitmapHeight, uint64_t frame);
+        bool Contains(uint32_t codepoint) const;
+        void MarkPageUsed(uint32_t page, uint64_t frame);
+        GlyphAtlasPage *GetPage(size_t index);
+        size_t GetPageCount() const;
+        uint32_t GetPageWidth() const;
+        uint32_t GetPageHeight() const;
+        uint32_t GetMaxPages() const;
+        size_t GetGlyphCount() const;
+        uint64_t GetEvictionCount() const;
+    private:
+        static constexpr uint32_t NO_PAGE = UINT32_MAX;
+        static constexpr uint32_t DIRECT_LOOKUP_SIZE = 256;
+        std::unordered_map<uint32_t,Glyph> glyphs;
+        std::vector<Glyph*> directLookup; //Fast path for Latin-1 codepoints
+        std::vector<GlyphAtlasPage> pages;
+        uint32_t pageWidth;
+        uint32_t pageHeight;
+        uint32_t maxPages;
+        uint32_t padding;
+        uint64_t evictionCount;
+        bool Allocate(uint32_t width, uint32_t height, uint64_t frame, uint32_t &page, uint32_t &x, uint32_t &y);
+        void AddPage();
+        void EvictPage(uint32_t page);
+    };
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "../System/EventHandler.hpp"
 #include "Renderers/Renderer.hpp"
 #include "Renderers/PostProcessingRenderer.hpp"
+#include "PostProcessingGraph.hpp"
 #include "Buffers/FrameBufferObject.hpp"
 #include "Shader.hpp"
 #include "Shadow.hpp"
@@ -20,25 +21,35 @@ namespace GFX
 	using WindowResizeEvent = std::function<void(uint32_t width, uint32_t height)>;
 
 	class DepthMaterial;
+	class DiffuseMaterial;
+	class Material;
 
 	class Graphics
 	{
 	friend class Application;
+	friend class PostProcessingGraph;
+	friend class Renderer;
+	friend class Shader;
 	private:
 		static Rectangle viewport;
 		static Vector2 resolution;
 		static ImGuiManager imgui;
 		static Shadow shadow;
 		static std::unique_ptr<DepthMaterial> depthMaterial;
+		static std::unique_ptr<DiffuseMaterial> fallbackMaterial;
+		static std::vector<Shader*> compilingShaders;
 		static std::vector<Renderer*> renderers;
-		static std::priority_queue<Renderer*, std::vector<Renderer*>, CompareRenderer> renderQueue;
+		static std::vector<Renderer*> renderQueue;
+		static bool renderQueueDirty;
 		static std::vector<FrameBufferObject> framebuffers;
-		static std::vector<Shader*> postProcessingShaders;
 		static PostProcessingRenderer postProcessingRenderer;
+		static PostProcessingGraph postProcessingGraph;
 		static void Initialize(uint32_t width, uint32_t height, uint32_t displayWidth, uint32_t displayHeight);
 		static void Deinitialize();
 		static void NewFrame();
+		static void UpdateShaders();
 		static void UpdateUniformBuffers();
+		static void UpdateRenderQueue();
 		static void RenderShadowPass();
 		static void Render2DPass();
 		static void Render3DPass();
@@ -46,6 +57,7 @@ namespace GFX
 		static void Clear();
 		static void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 		static void BindShaderToUniformBuffers(Shader *shader);
+		static void RemoveCompilingShader(Shader *shader);
 		static void CreateUniformBuffers();
 		static void CreateShaders();
 		static void CreateTextures();
@@ -54,10 +66,13 @@ namespace GFX
 	public:
 		static EventHandler<WindowResizeEvent> windowResize;
 		static Rectangle GetViewport();
+		static Material *GetFallbackMaterial();
 		static void Add(Renderer *renderer);
 		static void Remove(Renderer *renderer);
 		static void AddPostProcessingShader(Shader *shader);
 		static void RemovePostProcessingShader(Shader *shader);
+		static void AddPostProcessingPass(const PostProcessingPass &pass);
+		static PostProcessingGraph *GetPostProcessingGraph();
 		static Renderer *GetRendererByIndex(size_t index);
 		static FrameBufferObject *GetFrameBufferByIndex(size_t index);
 	};
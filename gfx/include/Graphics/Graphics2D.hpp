@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <unordered_map>
 
 namespace GFX
 {
@@ -19,12 +20,30 @@ namespace GFX
         uint32_t vertexCount;
         uint32_t indiceCount;
         uint32_t indiceOffset;
+        uint32_t textureSlot; //Assigned by BuildDrawBatches
         bool textureIsFont;
         bool fontHasSDF;
         Rectangle clippingRect;
         void *userData;
     };
 
+    static constexpr uint32_t GRAPHICS2D_MAX_TEXTURE_SLOTS = 8;
+
+    // A run of consecutive draw list items that can be issued with a single draw call
+    struct DrawBatch
+    {
+        uint32_t shaderId;
+        uint32_t textures[GRAPHICS2D_MAX_TEXTURE_SLOTS];
+        uint32_t textureCount;
+        uint32_t indiceOffset;
+        uint32_t indiceCount;
+        uint32_t firstItem;
+        uint32_t itemCount;
+        bool textureIsFont;
+        Rectangle clippingRect;
+        void *userData;
+    };
+
     struct DrawCommand 
     {
         Vertex2D *vertices;
@@ -45,6 +64,7 @@ namespace GFX
             this->indices = nullptr;
             this->numIndices = 0; 
             this->textureId = 0; 
+            this->shaderId = 0;
             this->textureIsFont = false;
             this->fontHasSDF = false;
             this->clippingRect = Rectangle(0, 0, 0, 0);
@@ -68,8 +88,6 @@ namespace GFX
         Uniform_Resolution,
         Uniform_Texture,
         Uniform_Time,
-        Uniform_IsFont,
-        Uniform_FontHasSDF,
         Uniform_COUNT
     };
 
@@ -92,19 +110,34 @@ namespace GFX
 
 	using UniformUpdateCallback = std::function<void(uint32_t shaderId, void * userData)>;
 
+	struct Graphics2DShaderUniforms
+	{
+		int32_t texture;
+		int32_t projection;
+		int32_t time;
+		int32_t resolution;
+	};
+
 	class Graphics2D
 	{
 	friend class Graphics;
+	friend class TextLayoutCache;
+	friend class Testing;
 	private:
         static uint32_t VAO;
         static uint32_t VBO;
         static uint32_t EBO;
+        static uint32_t flagsVBO; //Per vertex texture slot and font flags for the default shader
         static uint32_t shaderId;
         static uint32_t textureId;
         static std::vector<uint32_t> uniforms;
         static std::vector<DrawListItem> items;
         static std::vector<Vertex2D> vertices;
         static std::vector<uint32_t> indices;
+        static std::vector<uint32_t> vertexFlags;
+        static std::vector<DrawBatch> batches;
+        static std::unordered_map<uint32_t,Graphics2DShaderUniforms> shaderUniforms;
+        static uint32_t maxTextureSlots;
         static uint32_t itemCount;
         static uint32_t vertexCount;
         static uint32_t indiceCount;
@@ -113,12 +146,15 @@ namespace GFX
         static std::vector<TextColorInfo> textColorInfoTemp;
         static GLStateInfo glState;
         static uint32_t numDrawCalls;
+        static uint32_t numItemsSubmitted;
 		static void Initialize();
 		static void Deinitialize();
 		static void NewFrame();
 		static void CheckVertexBuffer(size_t numRequiredVertices);
 		static void CheckIndexBuffer(size_t numRequiredIndices);
 		static void CheckItemBuffer(size_t numRequiredItems);
+		static void UpdateVertexFlags(size_t numBatches);
+		static const Graphics2DShaderUniforms &GetShaderUniforms(uint32_t shaderId);
 		static void CheckTemporaryVertexBuffer(size_t numRequiredVertices);
 		static void CheckTemporaryIndexBuffer(size_t numRequiredIndices);
 		template <typename T>
@@ -150,6 +186,10 @@ namespace GFX
 		static void ParseColorsFromText(std::string &text, std::vector<TextColorInfo> &colors, size_t &count);
 	public:
 		static UniformUpdateCallback onUniformUpdate;
+		static size_t BuildDrawBatches(DrawListItem *items, size_t itemCount, uint32_t defaultShaderId, uint32_t maxTextureSlots, std::vector<DrawBatch> &batches);
+		static uint32_t GetNumItemsSubmitted();
+		static uint32_t GetNumDrawCalls();
+		static void ClearShaderUniforms(uint32_t shaderId);
 		static void AddRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
 		static void AddRectangleRounded(const Vector2 &position, const Vector2 &size, float rotationDegrees, float radius, const Color &color, const Rectangle clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
 		static void AddRectangleRoundedEx(const Vector2 &position, const Vector2 &size, float rotationDegrees, float radius, float topLeftRadius, float topRightRadius, float bottomLeftRadius, float bottomRightRadius, const Color &color, const Rectangle clippingRect = Rectangle(0, 0, 0, 0), uint32_t shaderId = 0, void *userData = nullptr);
@@ -4,6 +4,7 @@
 #include <string>
 #include <cstdint>
 #include "Color.hpp"
+#include "../System/MemoryTracker.hpp"
 
 namespace GFX 
 {
@@ -34,6 +35,8 @@ namespace GFX
         uint32_t height;
         uint32_t channels;
         bool hasLoaded;
+        MemoryUsage memoryUsage = MemoryUsage(MemoryTag::Image);
+        void UpdateMemoryUsage();
         bool LoadFromFile(const std::string &filepath);
         bool LoadFromMemory(const uint8_t *data, size_t size);
         bool Load(uint32_t width, uint32_t height, uint32_t channels, float r, float g, float b, float a);
@@ -0,0 +1,27 @@
+#ifndef GFX_LODGROUP_HPP
+#define GFX_LODGROUP_HPP
+
+#include "BoundingBox.hpp"
+#include "../System/Numerics/Vector3.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace GFX
+{
+    // Picks a mesh LOD from the fraction of the screen height covered by the bounds.
+    // Level N is used while the coverage is below screenSizes[N-1], hysteresis widens each
+    // boundary so objects near a threshold don't switch back and forth every frame.
+    class LODGroup
+    {
+    public:
+        std::vector<float> screenSizes;
+        float hysteresis;
+        float crossfadeDuration; //Seconds, 0 switches levels instantly
+        bool enabled;
+        LODGroup();
+        uint32_t SelectLevel(float screenCoverage, uint32_t currentLevel, uint32_t levelCount) const;
+        static float CalculateScreenCoverage(const BoundingBox &worldBounds, const Vector3 &cameraPosition, float fieldOfView);
+    };
+}
+
+#endif
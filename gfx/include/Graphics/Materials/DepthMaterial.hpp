@@ -10,12 +10,16 @@ namespace GFX
 	private:
         int uModel;
         int uHasInstanceData;
+        int uCascadeMask;
 
 		bool hasInstanceData;
+		int32_t cascadeMask;
 	public:
 		DepthMaterial();
 		bool HasInstanceData() const;
 		void SetHasInstanceData(bool hasInstanceData);
+		uint32_t GetCascadeMask() const;
+		void SetCascadeMask(uint32_t mask);
 		void Use(Transform *transform, Camera *camera) override;
 	};
 }
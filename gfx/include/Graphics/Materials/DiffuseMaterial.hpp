@@ -31,6 +31,7 @@ namespace GFX
 	public:
 		DiffuseMaterial();
 		void Use(Transform *transform, Camera *camera) override;
+		Texture2D *GetMainTexture() const override;
 		Texture2D *GetDiffuseTexture() const;
 		void SetDiffuseTexture(Texture2D *value);
 		Color GetDiffuseColor() const;
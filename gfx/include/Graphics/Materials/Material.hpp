@@ -23,6 +23,7 @@ namespace GFX
 		Material();
 		virtual void Use(Transform *transform, Camera *camera);
 		Shader *GetShader() const;
+		virtual Texture2D *GetMainTexture() const;
 		void SetName(const std::string &name);
 		std::string GetName() const;
 	protected:
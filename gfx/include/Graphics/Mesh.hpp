@@ -2,12 +2,14 @@
 #define GFX_MESH_HPP
 
 #include "Vertex.hpp"
+#include "VertexLayout.hpp"
 #include "BoundingBox.hpp"
 #include "Buffers/ElementBufferObject.hpp"
 #include "Buffers/VertexArrayObject.hpp"
 #include "Buffers/VertexBufferObject.hpp"
 #include "../System/Numerics/Vector3.hpp"
 #include "../System/Numerics/Vector4.hpp"
+#include "../System/MemoryTracker.hpp"
 #include "../Core/Object.hpp"
 #include <vector>
 #include <cstdint>
@@ -16,6 +18,38 @@
 
 namespace GFX
 {
+    class Shader;
+
+    struct MeshShaderUniforms
+    {
+        int32_t positionScale;
+        int32_t positionOffset;
+        int32_t flags;
+        Vector3 positionScaleValue;
+        Vector3 positionOffsetValue;
+        int32_t flagsValue;
+        int32_t lodFade;
+        float lodFadeValue;
+    };
+
+    struct MeshLOD
+    {
+        std::vector<uint32_t> indices;
+        size_t indexOffset; //Offset into the element buffer, set by Generate
+        float error; //Geometric error relative to the size of the mesh
+    };
+
+    // Range of vertices or indices that changed since the last upload
+    struct MeshDirtyRange
+    {
+        size_t offset;
+        size_t count;
+        MeshDirtyRange();
+        MeshDirtyRange(size_t offset, size_t count);
+        bool IsEmpty() const;
+        void Merge(const MeshDirtyRange &other);
+    };
+
     class Mesh
     {
     public:
@@ -32,12 +66,37 @@ namespace GFX
         VertexArrayObject *GetVAO();
         VertexBufferObject *GetVBO();
         ElementBufferObject *GetEBO();
+        uint32_t GetIndexType() const;
         BoundingBox GetBounds() const;
+        uint64_t GetContentHash();
         void SetName(const std::string &name);
         std::string GetName() const;
         void Generate();
         void Delete();
         void RecalculateNormals();
+        void RecalculateNormals(size_t vertexOffset, size_t vertexCount);
+        void SetDynamic(bool dynamic);
+        bool IsDynamic() const;
+        void MarkVerticesDirty(size_t offset, size_t count);
+        void MarkIndicesDirty(size_t offset, size_t count);
+        void Update(bool recalculateNormals = false);
+        void SetVertexLayout(const VertexLayout &layout);
+        VertexLayout GetVertexLayout() const;
+        VertexPositionTransform GetPositionTransform() const;
+        void AddVertexStream(const VertexStream &stream);
+        void ClearVertexStreams();
+        std::vector<VertexStream> &GetVertexStreams();
+        void SetVertexUniforms(Shader *shader);
+        void GenerateLODs(uint32_t maxLevels = 3, float reduction = 0.5f, float maxError = 0.05f);
+        void ClearLODs();
+        void SetLODs(const std::vector<MeshLOD> &lods);
+        const std::vector<MeshLOD> &GetLODs() const;
+        size_t GetLODCount() const;
+        size_t GetLODIndexOffset(size_t level) const;
+        size_t GetLODIndicesCount(size_t level) const;
+        float GetLODError(size_t level) const;
+        static void SetLODFadeUniform(Shader *shader, float fade);
+        static void ClearShaderUniforms(uint32_t shaderId);
     private:
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
@@ -48,7 +107,37 @@ namespace GFX
         ElementBufferObject EBO;
         BoundingBox bounds;
         std::string name;
+        VertexLayout layout;
+        VertexPositionTransform positionTransform;
+        std::vector<VertexStream> streams;
+        std::vector<VertexBufferObject> streamBuffers;
+        bool layoutChanged;
+        uint32_t indexType;
+        std::vector<MeshLOD> lods;
+        bool isDynamic;
+        size_t vertexBufferCapacity;
+        size_t indexBufferCapacity;
+        MeshDirtyRange dirtyVertices;
+        MeshDirtyRange dirtyIndices;
+        std::vector<BoundingBox> boundsChunks;
+        std::vector<uint32_t> adjacencyOffsets;
+        std::vector<uint32_t> adjacencyTriangles;
+        bool adjacencyChanged;
+        uint64_t contentHash;
+        bool contentHashChanged;
+        MemoryUsage memoryUsage = MemoryUsage(MemoryTag::Mesh);
+        static std::unordered_map<uint32_t,MeshShaderUniforms> shaderUniforms;
         Vector3 SurfaceNormalFromIndices(int32_t indexA, int32_t indexB, int32_t indexC);
+        void SetVertexAttributes();
+        void UploadVertexStreams();
+        void UploadIndices();
+        void UploadVertexData(const void *data, size_t size);
+        void UploadIndexData(const void *data, size_t size);
+        void UpdateBounds(size_t offset, size_t count);
+        void UpdateAdjacency();
+        bool CalculateVertexNormal(uint32_t index, Vector3 &normal);
+        void UpdateMemoryUsage();
+        static MeshShaderUniforms &GetShaderUniforms(uint32_t shaderId);
     };
 
     class MeshGenerator
@@ -0,0 +1,56 @@
+#ifndef GFX_MESHOPTIMIZER_HPP
+#define GFX_MESHOPTIMIZER_HPP
+
+#include "Vertex.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace GFX
+{
+    class Mesh;
+
+    struct VertexCacheStatistics
+    {
+        uint32_t verticesTransformed;
+        float acmr; //Average cache miss ratio, transformed vertices per triangle (0.5 is ideal for large grids, 3 is worst)
+        float atvr; //Average transformed vertex ratio, transformed vertices per vertex (1 is ideal)
+    };
+
+    struct VertexFetchStatistics
+    {
+        size_t bytesFetched;
+        float overfetch; //Fetched bytes per byte of vertex data (1 is ideal)
+    };
+
+    enum MeshOptimizeFlags_ : uint32_t
+    {
+        MeshOptimizeFlags_None = 0,
+        MeshOptimizeFlags_WeldVertices = 1 << 0,
+        MeshOptimizeFlags_VertexCache = 1 << 1,
+        MeshOptimizeFlags_Overdraw = 1 << 2,
+        MeshOptimizeFlags_VertexFetch = 1 << 3,
+        MeshOptimizeFlags_All = MeshOptimizeFlags_WeldVertices | MeshOptimizeFlags_VertexCache | MeshOptimizeFlags_Overdraw | MeshOptimizeFlags_VertexFetch
+    };
+
+    typedef uint32_t MeshOptimizeFlags;
+
+    // Reorders triangle lists for the post-transform vertex cache (Forsyth), for overdraw
+    // (clusters sorted front to back from the mesh center) and vertices for fetch locality.
+    // Works on plain vectors and does not touch OpenGL, so it can run at import time or on a worker thread.
+    class MeshOptimizer
+    {
+    public:
+        static void Optimize(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, MeshOptimizeFlags flags = MeshOptimizeFlags_All);
+        static void Optimize(Mesh &mesh, MeshOptimizeFlags flags = MeshOptimizeFlags_All);
+        static size_t WeldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+        static void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+        static void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold = 1.05f);
+        static void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+        static VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = 16);
+        static VertexFetchStatistics AnalyzeVertexFetch(const std::vector<uint32_t> &indices, size_t vertexCount, size_t vertexSize);
+        static bool CanUseShortIndices(size_t vertexCount);
+    };
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef GFX_MESHSIMPLIFIER_HPP
+#define GFX_MESHSIMPLIFIER_HPP
+
+#include "Vertex.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace GFX
+{
+    // Quadric error metric edge collapse simplifier.
+    // Vertices are collapsed onto one of their neighbours, so the output indexes the original vertex buffer.
+    // Open borders, attribute seams (vertices sharing a position) and non-manifold edges are kept in place.
+    // Does not touch OpenGL and gives the same result for the same input.
+    class MeshSimplifier
+    {
+    public:
+        // targetError is relative to the largest extent of the mesh; returns the error that was reached in the same unit
+        static float Simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, size_t targetIndexCount, float targetError, std::vector<uint32_t> &result);
+    };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef GFX_MODELCACHE_HPP
+#define GFX_MODELCACHE_HPP
+
+#include "Vertex.hpp"
+#include "Mesh.hpp"
+#include "../System/Numerics/Vector3.hpp"
+#include "../System/Numerics/Quaternion.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace GFX
+{
+    struct CookedTexture
+    {
+        std::string name;           //File path for external textures
+        bool isEmbedded;
+        std::vector<uint8_t> data;  //Encoded image for embedded textures
+    };
+
+    struct CookedMesh
+    {
+        std::string name;
+        int32_t textureIndex;       //-1 uses the default texture
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<MeshLOD> lods;
+    };
+
+    struct CookedNode
+    {
+        std::string name;
+        int32_t parent;             //Parents always come before their children, -1 for the root
+        Vector3 position;
+        Quaternion rotation;
+        Vector3 scale;
+        std::vector<uint32_t> meshes;
+    };
+
+    // A model after import processing, nodes and meshes are ready to be instantiated without assimp
+    struct CookedModel
+    {
+        uint64_t sourceHash;
+        std::vector<CookedNode> nodes;
+        std::vector<CookedMesh> meshes;
+        std::vector<CookedTexture> textures;
+    };
+
+    // Versioned binary cache for imported models, stored next to the source file.
+    // The source hash covers the file contents and the import settings, a mismatch means the cache is stale.
+    class ModelCache
+    {
+    public:
+        static constexpr uint32_t VERSION = 1;
+        static std::string GetCachePath(const std::string &filepath);
+        static uint64_t CalculateSourceHash(const void *data, size_t size, uint32_t modelFlags, const Vector3 &scale, bool flipYZ);
+        static bool CalculateSourceHash(const std::string &filepath, uint32_t modelFlags, const Vector3 &scale, bool flipYZ, uint64_t &hash);
+        static bool Read(const uint8_t *data, size_t size, uint64_t sourceHash, CookedModel &model);
+        static void Write(const CookedModel &model, std::vector<uint8_t> &data);
+        static bool Load(const std::string &filepath, uint64_t sourceHash, CookedModel &model);
+        static bool Save(const std::string &filepath, const CookedModel &model);
+    };
+}
+
+#endif
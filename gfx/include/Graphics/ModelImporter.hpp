@@ -2,6 +2,8 @@
 #define GFX_MODELIMPORTER_HPP
 
 #include "Mesh.hpp"
+#include "ModelCache.hpp"
+#include "ModelProcessor.hpp"
 #include "../Core/GameObject.hpp"
 #include "../System/Numerics/Vector2.hpp"
 #include "../System/Numerics/Vector3.hpp"
@@ -9,12 +11,15 @@
 #include "../System/Numerics/Quaternion.hpp"
 #include "../System/Numerics/Matrix3.hpp"
 #include "../System/Numerics/Matrix4.hpp"
+#include "../System/Collections/ConcurrentQueue.hpp"
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 struct aiNode;
 struct aiScene;
-struct aiTexture;
 struct aiMaterial;
 
 namespace GFX
@@ -59,15 +64,80 @@ namespace GFX
 
     class Texture2D;
 
+    enum class ModelImportState
+    {
+        Loading,    //CPU stage on worker threads
+        Uploading,  //Waiting for GPU uploads on the main thread
+        Done,
+        Failed
+    };
+
+    typedef std::function<void(GameObject*)> ModelImportCallback;
+
+    // Tracks a model loaded with LoadAsyncFromFile, the result is valid once the state is Done
+    class ModelImportHandle
+    {
+    friend class ModelImporter;
+    private:
+        std::atomic<ModelImportState> state;
+        GameObject *result;
+        ModelImportCallback callback;
+        std::string directoryPath;
+        CookedModel model;
+        std::vector<ModelTextureData> textures;
+        std::vector<Texture2D*> uploadedTextures;
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        size_t uploadIndex;
+    public:
+        ModelImportHandle();
+        ModelImportState GetState() const;
+        bool IsDone() const;
+        GameObject *GetResult() const;
+        float GetUploadProgress() const;
+    };
+
+    // Models loaded from a file are cooked into a binary cache on first import (see ModelCache.hpp),
+    // later loads map the cache and skip assimp until the source file or the import settings change.
+    // Mesh processing and texture decoding run on worker threads, GPU uploads happen on the main thread.
+    // SetCompressTextures(true) block compresses textures next to a model on first import and saves them beside the source image (x.png.ktx).
+    // Meshes use the full precision vertex layout unless SetVertexLayout selects a compact one, e.g. VertexLayout::Compact().
     class ModelImporter
     {
+    friend class Graphics;
     private:
-        static void ProcessNode(GameObject *parent, const aiNode* node, const aiScene* scene, const Vector3 &scale, bool flipYZ, const std::string directoryPath);
-        static Texture2D *LoadEmbeddedTexture(const aiMaterial *pMaterial, const aiTexture *pTexture);
+        static bool useCache;
+        static bool compressTextures;
+        static VertexLayout vertexLayout;
+        static uint32_t workerCount;
+        static float uploadTimeBudget;
+        static size_t uploadByteBudget;
+        static ConcurrentQueue<std::shared_ptr<ModelImportHandle>> loadedModels;
+        static std::vector<std::shared_ptr<ModelImportHandle>> uploadingModels;
+        static void NewFrame();
+        static bool LoadModel(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ, CookedModel &model);
+        static void CookMeshes(CookedModel &model, const aiScene *scene, const Vector3 &scale, bool flipYZ, const std::string &directoryPath);
+        static void CookNode(CookedModel &model, const aiNode *node, int32_t parent, const Vector3 &scale);
+        static int32_t CookTexture(CookedModel &model, const aiMaterial *pMaterial, const aiScene *scene, const std::string &directoryPath);
+        static bool UploadNext(ModelImportHandle &handle, size_t &uploadedBytes);
+        static void UploadAll(ModelImportHandle &handle);
+        static GameObject *Instantiate(ModelImportHandle &handle);
     public:
         static GameObject *LoadFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ = false);
         static GameObject *LoadFromMemory(const void *memory, size_t size, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ = false);
+        static std::shared_ptr<ModelImportHandle> LoadAsyncFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ = false, const ModelImportCallback &callback = nullptr);
         static std::vector<std::shared_ptr<Mesh>> LoadMeshesFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ = false);
+        static void SetUseCache(bool use);
+        static bool GetUseCache();
+        static void SetCompressTextures(bool compress);
+        static bool GetCompressTextures();
+        static void SetVertexLayout(const VertexLayout &layout);
+        static VertexLayout GetVertexLayout();
+        static void SetWorkerCount(uint32_t count);
+        static uint32_t GetWorkerCount();
+        static void SetUploadTimeBudget(float milliseconds);
+        static float GetUploadTimeBudget();
+        static void SetUploadByteBudget(size_t bytes);
+        static size_t GetUploadByteBudget();
     };
 }
 
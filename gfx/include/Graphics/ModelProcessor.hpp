@@ -0,0 +1,40 @@
+#ifndef GFX_MODELPROCESSOR_HPP
+#define GFX_MODELPROCESSOR_HPP
+
+#include "ModelCache.hpp"
+#include "Image.hpp"
+#include "TextureCompressor.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace GFX
+{
+    // A texture decoded on a worker thread, waiting to be uploaded on the main thread
+    struct ModelTextureData
+    {
+        std::string name;               //Resource name the texture is registered under
+        bool isLoaded;
+        bool isCompressed;              //Block compressed, otherwise the levels are RGBA8
+        CompressedTexture compressed;   //Full mip chain, built on the worker so the upload only copies it
+    };
+
+    // CPU stage of the model import. Nothing in here touches OpenGL or Resources, so it is safe to run on worker threads.
+    // Every item writes only to its own slot, the result is the same for any number of workers.
+    class ModelProcessor
+    {
+    public:
+        static void ProcessMesh(CookedMesh &mesh);
+        static void ProcessMeshes(std::vector<CookedMesh> &meshes, uint32_t workerCount);
+        static void DecodeTexture(const CookedTexture &texture, const std::string &directoryPath, bool compress, ModelTextureData &result);
+        static void DecodeTextures(const CookedModel &model, const std::string &directoryPath, bool compress, std::vector<ModelTextureData> &textures, uint32_t workerCount);
+        static bool CompressTexture(const Image &image, ModelTextureData &texture, const std::string &filepath);
+        static bool GenerateMipChain(const Image &image, ModelTextureData &texture);
+        static void ParallelFor(size_t count, uint32_t workerCount, const std::function<void(size_t)> &job);
+        static uint32_t GetDefaultWorkerCount();
+    };
+}
+
+#endif
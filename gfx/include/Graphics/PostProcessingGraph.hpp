@@ -0,0 +1,83 @@
+#ifndef GFX_POSTPROCESSINGGRAPH_HPP
+#define GFX_POSTPROCESSINGGRAPH_HPP
+
+#include "Shader.hpp"
+#include "Buffers/RenderTexturePool.hpp"
+#include "Renderers/PostProcessingRenderer.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace GFX
+{
+	enum class PostProcessingPassType
+	{
+		Shader,     // Full screen pass with a user shader
+		PerPixel,   // GLSL function 'vec4 Name(vec4 color)', adjacent passes are fused into one shader
+		Blur,       // Separable gaussian blur in a compute shader, optionally at reduced resolution
+		Bloom       // Bright pass at half resolution, blurred at quarter resolution and added back
+	};
+
+	struct PostProcessingPass
+	{
+		PostProcessingPassType type;
+		Shader *shader;
+		std::string functionName;
+		std::string functionSource;
+		uint32_t downsample;
+		uint32_t iterations;
+		float threshold;
+		float intensity;
+		bool enabled;
+		PostProcessingPass();
+		static PostProcessingPass CreateShader(Shader *shader);
+		static PostProcessingPass CreatePerPixel(const std::string &functionName, const std::string &functionSource);
+		static PostProcessingPass CreateBlur(uint32_t downsample = 2, uint32_t iterations = 1);
+		static PostProcessingPass CreateBloom(float threshold = 1.0f, float intensity = 0.5f);
+		static PostProcessingPass CreateGrayscale();
+		static PostProcessingPass CreateTonemap();
+	};
+
+	class PostProcessingGraph
+	{
+	private:
+		std::vector<PostProcessingPass> passes;
+		std::unordered_map<uint64_t, Shader> fusedShaders;
+		std::unordered_map<uint32_t, std::unordered_map<uint64_t, int32_t>> uniformLocations;
+		RenderTexturePool pool;
+		PostProcessingRenderer *renderer;
+		Shader *copyShader;
+		Shader *blurShader;
+		Shader *bloomThresholdShader;
+		Shader *bloomCompositeShader;
+		RenderTexture current;
+		RenderTexture *currentTarget;
+		uint32_t width;
+		uint32_t height;
+		void SetCurrent(RenderTexture *target);
+		void DrawToTarget(RenderTexture *target, Shader *shader, const RenderTexture &source);
+		void Downsample(RenderTexture *target, Shader *shader, const RenderTexture &source);
+		void Blur(RenderTexture *texture, uint32_t iterations);
+		void Dispatch(const RenderTexture &source, RenderTexture *target, bool horizontal);
+		void RenderShaderPass(const PostProcessingPass &pass);
+		void RenderBlurPass(const PostProcessingPass &pass);
+		void RenderBloomPass(const PostProcessingPass &pass);
+		Shader *GetFusedShader(size_t first, size_t last);
+		int32_t GetUniformLocation(uint32_t program, const char *name);
+	public:
+		PostProcessingGraph();
+		void Initialize(PostProcessingRenderer *renderer);
+		void Deinitialize();
+		void Render(const RenderTexture &source, uint32_t targetFbo, uint32_t targetWidth, uint32_t targetHeight);
+		void Add(const PostProcessingPass &pass);
+		void Remove(Shader *shader);
+		void Clear();
+		PostProcessingPass *GetPass(size_t index);
+		size_t GetPassCount() const;
+		RenderTexturePool *GetPool();
+		void ClearShaderUniforms(uint32_t program);
+	};
+}
+
+#endif
@@ -3,6 +3,9 @@
 
 #include "Renderer.hpp"
 #include "../Mesh.hpp"
+#include "../LODGroup.hpp"
+#include "../BoundingBox.hpp"
+#include "../../Core/ArchetypeComponent.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -14,14 +17,28 @@ namespace GFX
         Mesh *pMesh;
         std::shared_ptr<Material> pMaterial;
         RenderSettings settings;
+        uint32_t lodLevel;
+        uint32_t previousLodLevel;
+        float lodFade; //Crossfade progress from previousLodLevel to lodLevel, 1 when done
         MeshRendererData(Mesh *mesh, const std::shared_ptr<Material> &material);
         MeshRendererData(const std::shared_ptr<Mesh> &mesh, const std::shared_ptr<Material> &material);
     };
 
+    // The part of a MeshRenderer that is written by every main pass, packed into the chunks of ArchetypeStorage::GetDefault()
+    struct MeshRendererState
+    {
+        BoundingBox bounds; //World bounds of all meshes
+        bool isVisible;     //At least one mesh passed frustum culling
+    };
+
     class MeshRenderer : public Renderer
     {
     private:
         std::vector<MeshRendererData> data;
+        ArchetypeState<MeshRendererState> state;
+        LODGroup lodGroup;
+        void UpdateLOD(MeshRendererData &entry, const BoundingBox &worldBounds, Camera *camera);
+        static void Draw(Mesh *mesh, uint32_t lodLevel);
     protected:
         void OnInitialize() override;
         void OnDestroy() override;
@@ -34,11 +51,16 @@ namespace GFX
         void Add(Mesh *mesh, const std::shared_ptr<Material> &material);
         void Add(const std::shared_ptr<Mesh> &mesh, const std::shared_ptr<Material> &material);
         void Remove(size_t index);
+        size_t GetCount() const;
         void SetMesh(Mesh *mesh, size_t index);
         void SetMesh(const std::shared_ptr<Mesh> &mesh, size_t index);
         Mesh *GetMesh(size_t index) const override;
         RenderSettings *GetSettings(size_t index);
         void SetMaterial(const std::shared_ptr<Material> &material, size_t index);
+        LODGroup *GetLODGroup();
+        uint32_t GetLODLevel(size_t index) const;
+        BoundingBox GetBounds() const;
+        bool GetIsVisible() const;
 
         template<typename T>
         T *GetMaterial(size_t index) const
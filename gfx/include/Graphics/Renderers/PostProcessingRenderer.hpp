@@ -2,8 +2,10 @@
 #define GFX_POSTPROCESSINGRENDERER_HPP
 
 #include <cstdint>
+#include <unordered_map>
 #include "../Buffers/VertexArrayObject.hpp"
 #include "../Buffers/VertexBufferObject.hpp"
+#include "../../External/glm/glm.hpp"
 
 namespace GFX
 {
@@ -12,11 +14,16 @@ namespace GFX
 	private:
 		VertexArrayObject vao;
 		VertexBufferObject vbo;
+		std::unordered_map<uint32_t, int32_t> uvScaleLocations;
+		int32_t GetUVScaleLocation(uint32_t shaderId);
 	public:
 		void Generate();
 		void Delete();
 		void Render(uint32_t fbo, uint32_t shaderId, uint32_t textureId);
+		void Render(uint32_t fbo, uint32_t shaderId, uint32_t textureId, const Vector2 &uvScale);
+		void Draw(uint32_t shaderId, uint32_t textureId, const Vector2 &uvScale);
+		void ClearShaderUniforms(uint32_t shaderId);
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -33,12 +33,17 @@ namespace GFX
 
     class Renderer : public Component
     {
+    friend class Graphics;
+    private:
+        uint32_t rendererIndex; //Position in the list of Graphics, so removing it does not have to search
     protected:
         bool castShadows;
         bool receiveShadows;
+        bool isStatic;
         uint32_t renderOrder;
         RendererType type;
     public:
+        static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
         Renderer();
         virtual void OnRender() = 0;
         virtual void OnRender(Material *material, Camera *camera) = 0;
@@ -47,6 +52,8 @@ namespace GFX
         bool GetCastShadows() const;
         void SetReceiveShadows(bool receiveShadows);
         bool GetReceiveShadows() const;
+        void SetStatic(bool isStatic);
+        bool GetStatic() const;
         void SetRenderOrder(uint32_t order);
         uint32_t GetRenderOrder() const;
         RendererType GetType() const;
@@ -38,6 +38,7 @@ namespace GFX
         uint32_t depth;
         float scale;
         float maxHeight;
+        VertexLayout vertexLayout;
         void Initialize();
     protected:
         void OnInitialize() override;
@@ -63,6 +64,8 @@ namespace GFX
         Vector2 GetSize() const;
         void SetMaxHeight(float height);
         float GetMaxHeight() const;
+        void SetVertexLayout(const VertexLayout &layout);
+        VertexLayout GetVertexLayout() const;
         TerrainMaterial *GetMaterial() const;
         Mesh *GetMesh(size_t index) const override;
     };
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace GFX
 {
@@ -12,23 +14,56 @@ namespace GFX
         Vertex,
         Geometry,
         Fragment,
+        Compute,
         Program
     };
 
+    struct ShaderStage
+    {
+        ShaderType type;
+        std::string source;
+    };
+
+    // Programs that have been submitted for linking but whose compile/link status has not been checked yet
+    struct PendingProgram
+    {
+        std::vector<uint32_t> shaders;
+        std::vector<ShaderType> types;
+        std::vector<std::string> sources;
+        uint64_t cacheKey;
+    };
+
     class Shader
     {
     friend class Graphics;
     private:
         uint32_t id;
         static std::unordered_map<std::string, std::string> includesMap;
+        static std::unordered_map<uint32_t, PendingProgram> pendingPrograms;
+        static std::unordered_set<uint32_t> failedPrograms;
+        static std::string cacheDirectory;
+        static std::string driverInfo;
+        static bool compilerInitialized;
+        static bool binaryCacheSupported;
+        static bool parallelCompileSupported;
+        void Create(const std::vector<ShaderStage> &stages);
         static bool CheckShader(uint32_t shader, ShaderType type, const std::string &source);
         static std::string AddIncludes(const std::string &shaderSource);
         static void InitializeIncludes();
+        static void InitializeCompiler();
+        static uint64_t GetCacheKey(const std::vector<ShaderStage> &stages);
+        static std::string GetCacheFilePath(uint64_t cacheKey);
+        static bool LoadProgramBinary(uint32_t program, uint64_t cacheKey);
+        static void SaveProgramBinary(uint32_t program, uint64_t cacheKey);
+        static bool FinalizeProgram(uint32_t program);
     public:
         Shader();
+        explicit Shader(const std::string &computeSource);
         Shader(const std::string &vertexSource, const std::string &fragmentSource);
         Shader(const std::string &vertexSource, const std::string &fragmentSource, const std::string &geometrySource);
         uint32_t GetId() const;
+        bool IsReady() const;
+        bool IsCompiling() const;
         void Use();
         void Delete();
         void SetMat2(const std::string &name, const float *value, bool transpose = false);
@@ -50,6 +85,10 @@ namespace GFX
         void SetInt(int32_t location, int32_t value);
         void SetBool(int32_t location, bool value);
         static void AddIncludeFile(const std::string &name, const std::string &code);
+        static void SetCacheDirectory(const std::string &directory);
+        static std::string GetCacheDirectory();
+        static bool IsParallelCompileSupported();
+        static void UpdatePendingPrograms();
     };
 }
 
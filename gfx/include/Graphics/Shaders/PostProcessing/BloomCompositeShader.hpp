@@ -0,0 +1,18 @@
+#ifndef GFX_BLOOMCOMPOSITESHADER_HPP
+#define GFX_BLOOMCOMPOSITESHADER_HPP
+
+#include "../../Shader.hpp"
+#include <string>
+
+namespace GFX
+{
+	class BloomCompositeShader
+	{
+	public:
+		static Shader Create();
+		static std::string GetVertexSource();
+		static std::string GetFragmentSource();
+	};
+}
+
+#endif
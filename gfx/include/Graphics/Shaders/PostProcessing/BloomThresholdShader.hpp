@@ -0,0 +1,18 @@
+#ifndef GFX_BLOOMTHRESHOLDSHADER_HPP
+#define GFX_BLOOMTHRESHOLDSHADER_HPP
+
+#include "../../Shader.hpp"
+#include <string>
+
+namespace GFX
+{
+	class BloomThresholdShader
+	{
+	public:
+		static Shader Create();
+		static std::string GetVertexSource();
+		static std::string GetFragmentSource();
+	};
+}
+
+#endif
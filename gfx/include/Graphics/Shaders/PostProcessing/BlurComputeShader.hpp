@@ -0,0 +1,18 @@
+#ifndef GFX_BLURCOMPUTESHADER_HPP
+#define GFX_BLURCOMPUTESHADER_HPP
+
+#include "../../Shader.hpp"
+#include <string>
+
+namespace GFX
+{
+	class BlurComputeShader
+	{
+	public:
+		static constexpr uint32_t GROUP_SIZE = 128;
+		static Shader Create();
+		static std::string GetComputeSource();
+	};
+}
+
+#endif
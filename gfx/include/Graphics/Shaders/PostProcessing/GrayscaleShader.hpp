@@ -12,6 +12,8 @@ namespace GFX
 		static Shader Create();
 		static std::string GetVertexSource();
 		static std::string GetFragmentSource();
+		static std::string GetFunctionName();
+		static std::string GetFunctionSource();
 	};
 }
 
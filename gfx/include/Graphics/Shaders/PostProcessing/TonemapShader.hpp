@@ -0,0 +1,20 @@
+#ifndef GFX_TONEMAPSHADER_HPP
+#define GFX_TONEMAPSHADER_HPP
+
+#include "../../Shader.hpp"
+#include <string>
+
+namespace GFX
+{
+	class TonemapShader
+	{
+	public:
+		static Shader Create();
+		static std::string GetVertexSource();
+		static std::string GetFragmentSource();
+		static std::string GetFunctionName();
+		static std::string GetFunctionSource();
+	};
+}
+
+#endif
@@ -14,6 +14,7 @@ namespace GFX
 	class UniformBufferObject;
 	class Camera;
 	class Light;
+	class DepthMaterial;
 
     struct UniformShadowInfo
     {
@@ -25,32 +26,60 @@ namespace GFX
         Vector4 cascadePlaneDistances[16];
     };
 
+	struct ShadowCascade
+	{
+		Matrix4 lightSpaceMatrix; //Matrix the cascade was last rendered with
+		Matrix4 staticLightSpaceMatrix; //Matrix the cached static casters were rendered with
+		Vector3 center;
+		Vector3 lightDirection;
+		float radius;
+		uint32_t framesSinceUpdate;
+		uint32_t staticVersion;
+		bool hasRendered;
+		bool hasStaticCache;
+	};
+
 	class Shadow
 	{
 	private:
         uint32_t lightFBO;
+        uint32_t staticFBO;
         Texture3D *depthMap;
+        Texture3D *staticDepthMap;
         UniformBufferObject *ubo;
         UniformShadowInfo shadowData;
         std::vector<float> shadowCascadeLevels;
+        std::vector<ShadowCascade> cascades;
+        uint32_t updateMask;
+        uint32_t staticUpdateMask;
 		Camera *camera;
 		Light *light;
         static bool enabled;
-		std::vector<Vector4> GetFrustumCornersWorldSpace(const Matrix4 &projview);
-		std::vector<Vector4> GetFrustumCornersWorldSpace(const Matrix4 &proj, const Matrix4 &view);
-		Matrix4 GetLightSpaceMatrix(const float nearPlane, const float farPlane);
-		std::vector<std::vector<Vector4>> GetClipPointByNDC();
-		std::vector<Matrix4> GetLightSpaceMatrices();
-		std::vector<Matrix4> GetLightSpaceMatrices2();
+        static bool cacheStaticCasters;
+        static uint32_t staticCasterVersion;
+        static uint32_t updateIntervals[16];
+        static float movementThreshold;
+        static float rotationThreshold;
+		void UpdateCascades();
+		void ClearLayers(Texture3D *texture, uint32_t mask);
+		void BeginPass(uint32_t fbo, Texture3D *texture, DepthMaterial *material, uint32_t mask);
 	public:
 		Shadow();
 		void Generate();
-		void Bind();
+		bool BindStatic(DepthMaterial *material);
+		bool Bind(DepthMaterial *material);
 		void Unbind();
 		void UpdateUniformBuffer();
+		uint32_t GetUpdateMask() const;
 		static bool IsEnabled();
 		static void SetEnabled(bool enabled);
+		static void SetCacheStaticCasters(bool cache);
+		static bool GetCacheStaticCasters();
+		static void InvalidateStaticCasters();
+		static void SetCascadeUpdateInterval(uint32_t cascade, uint32_t frames);
+		static uint32_t GetCascadeUpdateInterval(uint32_t cascade);
+		static void SetUpdateThresholds(float movement, float rotation);
 	};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,77 @@
+#ifndef GFX_TEXTLAYOUTCACHE_HPP
+#define GFX_TEXTLAYOUTCACHE_HPP
+
+#include "Font.hpp"
+#include "Vertex2D.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace GFX
+{
+    // A single glyph of a layout, expanded to 4 vertices when drawn
+    struct TextQuad
+    {
+        Vector2 min;
+        Vector2 max;
+        Vector2 uvMin;
+        Vector2 uvMax;
+        uint32_t page; //Atlas page of the glyph
+        int32_t colorIndex; //Index into markupColors, -1 uses the color passed at draw time
+    };
+
+    // Measured bounds and glyph quads of a string, positioned relative to the text origin
+    struct TextLayout
+    {
+        std::string text;
+        uint64_t fontId;
+        float fontSize;
+        bool richText;
+        Vector2 bounds;
+        std::vector<TextQuad> quads;
+        std::vector<uint32_t> usedPages; //Distinct atlas pages referenced by quads
+        std::vector<Color> markupColors;
+        uint64_t atlasEvictionCount;
+        uint64_t lastUsedFrame;
+        size_t GetQuadCount() const;
+        size_t GetMemorySize() const;
+    };
+
+    class TextLayoutCache
+    {
+    friend class Graphics2D;
+    friend class Font;
+    friend class Testing;
+    private:
+        static std::unordered_map<uint64_t,TextLayout> layouts;
+        static uint64_t frame;
+        static uint32_t maxUnusedFrames;
+        static size_t maxMemorySize;
+        static size_t memorySize;
+        static uint64_t numHits;
+        static uint64_t numMisses;
+        static uint64_t GetKey(Font *font, const char *text, size_t textLength, float fontSize, bool richText);
+        static TextLayout *Find(uint64_t key, Font *font, const char *text, size_t textLength, float fontSize, bool richText);
+        static TextLayout *Add(uint64_t key, Font *font, const char *text, size_t textLength, float fontSize, bool richText);
+        static void Build(TextLayout &layout, Font *font);
+        static void NewFrame();
+        static void Evict(size_t targetMemorySize);
+        static void Remove(uint64_t fontId);
+    public:
+        static const TextLayout *GetLayout(Font *font, const char *text, size_t textLength, float fontSize, bool richText);
+        static Vector2 GetBounds(Font *font, const std::string &text, float fontSize, bool richText = false);
+        static void Clear();
+        static void SetMaxUnusedFrames(uint32_t frames);
+        static uint32_t GetMaxUnusedFrames();
+        static void SetMaxMemorySize(size_t bytes);
+        static size_t GetMaxMemorySize();
+        static size_t GetMemorySize();
+        static size_t GetCount();
+        static uint64_t GetNumHits();
+        static uint64_t GetNumMisses();
+    };
+}
+
+#endif
@@ -4,17 +4,20 @@
 #include "Texture.hpp"
 #include "Image.hpp"
 #include "Color.hpp"
+#include "TextureCompressor.hpp"
 
 namespace GFX
 {
 	class Texture2D : public Texture
 	{
+		friend class TextureStreamer;
 	private:
 		uint32_t width;
 		uint32_t height;
 	public:
 		Texture2D();
 		Texture2D(const Image *image);
+		Texture2D(const CompressedTexture *texture, uint32_t baseLevel = 0);
 		Texture2D(const uint8_t *data, size_t size, uint32_t width, uint32_t height, uint32_t channels);
 		Texture2D(uint32_t id, uint32_t width, uint32_t height);
 		Texture2D(uint32_t width, uint32_t height, const Color &color);
@@ -27,6 +30,7 @@ namespace GFX
 		void Delete() override;
 		uint32_t GetWidth() const;
 		uint32_t GetHeight() const;
+		static bool IsCompressionFormatSupported(TextureCompressionFormat format);
 	};
 }
 
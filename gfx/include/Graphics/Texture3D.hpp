@@ -27,6 +27,7 @@ namespace GFX
 		uint32_t GetHeight() const;
         uint32_t GetDepth() const;
 		void CopyToTexture2D(uint32_t layerIndex, const Texture2D *texture);
+		void CopyToTexture3D(uint32_t layerIndex, const Texture3D *texture);
 	};
 }
 
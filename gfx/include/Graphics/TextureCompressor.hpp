@@ -0,0 +1,78 @@
+#ifndef GFX_TEXTURECOMPRESSOR_HPP
+#define GFX_TEXTURECOMPRESSOR_HPP
+
+#include "Image.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace GFX
+{
+    enum class TextureCompressionFormat : uint32_t
+    {
+        None, //Uncompressed RGBA8
+        BC1,  //RGB, 4 bits per pixel
+        BC3,  //RGBA, 8 bits per pixel
+        BC4,  //R, 4 bits per pixel
+        BC5,  //RG, 8 bits per pixel
+        BC7   //RGBA, 8 bits per pixel
+    };
+
+    enum class TextureUsage : uint32_t
+    {
+        Unknown,
+        Color,  //Albedo or other RGB(A) data that is looked at directly
+        Normal  //Tangent space normal map, only X and Y are stored
+    };
+
+    struct CompressedTextureLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> data;
+    };
+
+    struct CompressedTexture
+    {
+        TextureCompressionFormat format;
+        uint32_t width;
+        uint32_t height;
+        std::vector<CompressedTextureLevel> levels;
+        CompressedTexture();
+        bool IsValid() const;
+        size_t GetDataSize() const;
+    };
+
+    // CPU side block compression, mip generation and KTX (1.1) reading/writing.
+    // Nothing in here touches OpenGL, so it can be used by offline tools and tested without a context.
+    class TextureCompressor
+    {
+    public:
+        static bool Compress(const Image &image, TextureCompressionFormat format, bool generateMipmaps, CompressedTexture &texture);
+        static bool Compress(const uint8_t *data, uint32_t width, uint32_t height, uint32_t channels, TextureCompressionFormat format, bool generateMipmaps, CompressedTexture &texture);
+        static bool Decompress(const CompressedTextureLevel &level, TextureCompressionFormat format, std::vector<uint8_t> &rgba);
+        static void GenerateMipChain(const uint8_t *rgba, uint32_t width, uint32_t height, std::vector<CompressedTextureLevel> &levels);
+        static TextureCompressionFormat GetDefaultFormat(const Image &image, TextureUsage usage);
+        static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+        static uint32_t GetBlockSize(TextureCompressionFormat format);
+        static size_t GetLevelSize(TextureCompressionFormat format, uint32_t width, uint32_t height);
+        static uint32_t GetGLInternalFormat(TextureCompressionFormat format);
+        static void EncodeBC1Block(const uint8_t *rgba, uint8_t *block);
+        static void EncodeBC3Block(const uint8_t *rgba, uint8_t *block);
+        static void EncodeBC4Block(const uint8_t *rgba, uint32_t channel, uint8_t *block);
+        static void EncodeBC5Block(const uint8_t *rgba, uint8_t *block);
+        static void EncodeBC7Block(const uint8_t *rgba, uint8_t *block);
+        static void DecodeBC1Block(const uint8_t *block, uint8_t *rgba);
+        static void DecodeBC3Block(const uint8_t *block, uint8_t *rgba);
+        static void DecodeBC4Block(const uint8_t *block, uint32_t channel, uint8_t *rgba);
+        static void DecodeBC5Block(const uint8_t *block, uint8_t *rgba);
+        static bool DecodeBC7Block(const uint8_t *block, uint8_t *rgba);
+        static bool ReadKTX(const uint8_t *data, size_t size, CompressedTexture &texture);
+        static bool WriteKTX(const CompressedTexture &texture, std::vector<uint8_t> &data);
+        static bool LoadKTX(const std::string &filepath, CompressedTexture &texture);
+        static bool SaveKTX(const std::string &filepath, const CompressedTexture &texture);
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef GFX_TEXTURESTREAMER_HPP
+#define GFX_TEXTURESTREAMER_HPP
+
+#include "Texture2D.hpp"
+#include "TextureCompressor.hpp"
+#include "BoundingBox.hpp"
+#include "../System/Numerics/Vector3.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace GFX
+{
+    class Camera;
+
+    // Input for the residency solver, one per streamed texture
+    struct TextureStreamingState
+    {
+        uint32_t id;                    //Breaks ties between equal priorities, must be stable across frames
+        std::vector<size_t> levelSizes; //Bytes per mip level, finest first
+        uint32_t coarseLevel;           //Levels from here on are always resident
+        uint32_t requestedLevel;        //Finest level the renderer asked for
+        float priority;                 //Usually the projected size in pixels
+    };
+
+    struct StreamedTexture
+    {
+        uint32_t id;                    //Assigned by the streamer, unlike the GL id it doesn't change when levels are uploaded
+        Texture2D *texture;
+        CompressedTexture data;
+        uint32_t coarseLevel;
+        uint32_t residentLevel;
+        uint32_t requestedLevel;
+        float priority;
+        uint64_t lastRequestFrame;
+    };
+
+    // Keeps the full mip chain of registered textures in system memory and only uploads the levels
+    // that are needed for the size at which they appear on screen, within a video memory budget.
+    // Images are streamed as an uncompressed mip chain, which is built by the caller. Prefer building it on a worker, see ModelProcessor::DecodeTexture.
+    // Textures start out with their coarse levels only. The solver and the screen size estimate do not touch OpenGL.
+    class TextureStreamer
+    {
+        friend class Graphics;
+    public:
+        static Texture2D *Add(const std::string &name, CompressedTexture &&texture);
+        static Texture2D *Add(const std::string &name, const Image &image);
+        static void Remove(Texture2D *texture);
+        static bool IsStreamed(const Texture2D *texture);
+        static void RequestMip(Texture2D *texture, const BoundingBox &worldBounds, Camera *camera);
+        static void RequestLevel(Texture2D *texture, uint32_t level, float priority);
+        static void SetBudget(size_t bytes);
+        static size_t GetBudget();
+        static size_t GetResidentSize();
+        static void SetCoarseSize(uint32_t size);
+        static uint32_t GetCoarseSize();
+        static void SetMaxUploadsPerFrame(uint32_t count);
+        static uint32_t GetMaxUploadsPerFrame();
+        static void SetRequestTimeout(uint32_t frames);
+        static uint32_t GetRequestTimeout();
+        static size_t GetCount();
+        static uint32_t GetResidentLevel(const Texture2D *texture);
+        static float CalculateScreenSize(const BoundingBox &worldBounds, const Vector3 &cameraPosition, float fieldOfView, float viewportHeight);
+        static uint32_t CalculateRequestedLevel(float screenSize, uint32_t width, uint32_t height, uint32_t levelCount);
+        static uint32_t CalculateCoarseLevel(const CompressedTexture &texture, uint32_t coarseSize);
+        static size_t CalculateResidency(const std::vector<TextureStreamingState> &states, size_t budget, std::vector<uint32_t> &residentLevels);
+    private:
+        static std::unordered_map<const Texture2D*,StreamedTexture> textures;
+        static std::vector<TextureStreamingState> states;
+        static std::vector<uint32_t> residentLevels;
+        static size_t budget;
+        static size_t residentSize;
+        static uint32_t coarseSize;
+        static uint32_t maxUploadsPerFrame;
+        static uint32_t requestTimeout;
+        static uint64_t frame;
+        static uint32_t nextId;
+        static void NewFrame();
+        static size_t GetResidentSize(const CompressedTexture &texture, uint32_t level);
+        static bool Upload(StreamedTexture &streamedTexture, uint32_t level);
+    };
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef GFX_VERTEXLAYOUT_HPP
+#define GFX_VERTEXLAYOUT_HPP
+
+#include "Vertex.hpp"
+#include "Color.hpp"
+#include "BoundingBox.hpp"
+#include "../System/Numerics/Vector2.hpp"
+#include "../System/Numerics/Vector3.hpp"
+#include "../System/Numerics/Vector4.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace GFX
+{
+    // Attribute locations used by the built-in shaders
+    static constexpr uint32_t VERTEX_POSITION_LOCATION = 0;
+    static constexpr uint32_t VERTEX_NORMAL_LOCATION = 1;
+    static constexpr uint32_t VERTEX_UV_LOCATION = 2;
+    static constexpr uint32_t VERTEX_TANGENT_LOCATION = 8;
+    static constexpr uint32_t VERTEX_COLOR_LOCATION = 9;
+    static constexpr uint32_t VERTEX_JOINTS_LOCATION = 10;
+    static constexpr uint32_t VERTEX_WEIGHTS_LOCATION = 11;
+
+    // Bits of the uVertexFlags shader uniform
+    static constexpr int32_t VERTEX_FLAG_OCTAHEDRAL_NORMALS = 1;
+
+    // Maximum round trip error of each format, as measured with VertexQuantization::Decode:
+    // Float32      exact
+    // Float16      relative error <= 2^-11 (positions are stored relative to the center of the mesh)
+    // UNorm16      absolute error <= size of the bounds / 130000 per axis (half a step plus float rounding, positions only)
+    // Octahedral16 angular error <= 0.01 degrees (normals only)
+    // Octahedral8  angular error <= 0.7 degrees (normals only)
+    enum class VertexAttributeFormat : uint8_t
+    {
+        Float32,
+        Float16,
+        UNorm16,
+        Octahedral16,
+        Octahedral8
+    };
+
+    struct VertexLayout
+    {
+        VertexAttributeFormat position;
+        VertexAttributeFormat normal;
+        VertexAttributeFormat uv;
+        VertexLayout();
+        VertexLayout(VertexAttributeFormat position, VertexAttributeFormat normal, VertexAttributeFormat uv);
+        bool IsDefault() const;
+        bool IsValid() const;
+        uint32_t GetStride() const;
+        uint32_t GetNormalOffset() const;
+        uint32_t GetUVOffset() const;
+        static VertexLayout Compact(); //16 bytes per vertex instead of 32
+    };
+
+    // Additional non-interleaved vertex data, such as tangents, colors or skinning weights
+    struct VertexStream
+    {
+        uint32_t location;
+        uint32_t components;
+        uint32_t type; //GL type of each component
+        bool normalized;
+        uint32_t stride;
+        std::vector<uint8_t> data;
+        VertexStream();
+        size_t GetCount() const;
+    };
+
+    // Maps stored positions back to object space: position * scale + offset
+    struct VertexPositionTransform
+    {
+        Vector3 scale;
+        Vector3 offset;
+        VertexPositionTransform();
+        bool IsIdentity() const;
+    };
+
+    class VertexQuantization
+    {
+    public:
+        static uint16_t FloatToHalf(float value);
+        static float HalfToFloat(uint16_t value);
+        static uint16_t QuantizeUNorm16(float value);
+        static float DequantizeUNorm16(uint16_t value);
+        static int16_t QuantizeSNorm16(float value);
+        static float DequantizeSNorm16(int16_t value);
+        static int8_t QuantizeSNorm8(float value);
+        static float DequantizeSNorm8(int8_t value);
+        static Vector2 EncodeOctahedral(const Vector3 &normal);
+        static Vector3 DecodeOctahedral(const Vector2 &value);
+        static void EncodeOctahedral16(const Vector3 &normal, int16_t *value);
+        static void EncodeOctahedral8(const Vector3 &normal, int8_t *value);
+        static VertexPositionTransform CalculatePositionTransform(const BoundingBox &bounds, VertexAttributeFormat format);
+        static bool Encode(const std::vector<Vertex> &vertices, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<uint8_t> &data);
+        static bool Encode(const Vertex *vertices, size_t count, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<uint8_t> &data);
+        static bool Decode(const uint8_t *data, size_t count, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<Vertex> &vertices);
+        static VertexStream CreateTangentStream(const std::vector<Vector4> &tangents);
+        static VertexStream CreateColorStream(const std::vector<Color> &colors);
+        static VertexStream CreateWeightStream(const std::vector<Vector4> &weights);
+        static VertexStream CreateJointStream(const std::vector<uint8_t> &joints); //4 joint indices per vertex
+    };
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef GFX_SHAPECACHE_HPP
+#define GFX_SHAPECACHE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace JPH
+{
+    class Shape;
+    template <class T> class RefConst;
+};
+
+namespace GFX
+{
+    class Collider;
+
+    // Shares collision shapes between rigidbodies with identical colliders.
+    // Shapes are released once no body references them anymore, and cooked mesh shapes can optionally be stored on disk.
+    class ShapeCache
+    {
+    friend class Physics;
+    friend class Rigidbody;
+    friend class ShapeHelper;
+    private:
+        static std::string cacheDirectory;
+        static bool purgeRequested;
+        static bool GetShape(Collider *collider, JPH::RefConst<JPH::Shape> &outShape);
+        static void RequestPurge();
+        static void NewFrame();
+    public:
+        static void SetCacheDirectory(const std::string &directory);
+        static std::string GetCacheDirectory();
+        static size_t GetCount();
+        static size_t Purge();
+        static void Clear();
+    };
+}
+
+#endif
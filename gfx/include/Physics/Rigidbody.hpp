@@ -2,6 +2,7 @@
 #define GFX_RIGIDBODY_HPP
 
 #include "../Core/Component.hpp"
+#include "../Core/ArchetypeComponent.hpp"
 #include "../System/Numerics/Quaternion.hpp"
 #include "../System/Numerics/Vector3.hpp"
 #include <memory>
@@ -44,6 +45,12 @@ namespace GFX
 		RigidbodyConstraints constraints;
 	};
 
+	// The part of a Rigidbody that Physics reads every frame, packed into the chunks of ArchetypeStorage::GetDefault()
+	struct RigidbodyState
+	{
+		uint32_t bodyId; //JPH::BodyID of the simulated body
+	};
+
 	struct PhysicsBody;
 
 	class Rigidbody : public Component
@@ -54,6 +61,7 @@ namespace GFX
 		float mass;
 		bool isActive;
 		RigidbodyConstraints constraints;
+		ArchetypeState<RigidbodyState> state; //Only exists while the body is added to Physics
 		bool CreateShape();
 		bool Initialize();
 		bool IsInitialized() const;
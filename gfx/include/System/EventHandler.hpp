@@ -1,34 +1,474 @@
 #ifndef GFX_EVENTHANDLER_HPP
 #define GFX_EVENTHANDLER_HPP
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace GFX
 {
+    // Returned when subscribing to an event, pass it back to remove the callback again
+    struct EventToken
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        EventToken() : index(0xFFFFFFFF), generation(0) {}
+        EventToken(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+        bool IsValid() const
+        {
+            return index != 0xFFFFFFFF;
+        }
+    };
+
     template<typename T>
-    class EventHandler
+    struct IsStdFunction : std::false_type {};
+
+    template<typename T>
+    struct IsStdFunction<std::function<T>> : std::true_type {};
+
+    template<typename T>
+    class Delegate;
+
+    // Type erased callable that lives inside the delegate when it fits the buffer, so typical lambdas and function pointers never allocate.
+    // Larger callables are moved to the heap.
+    template<typename R, typename ... Args>
+    class Delegate<R(Args...)>
     {
     public:
-        std::vector<T> callbacks;
+        static constexpr size_t BUFFER_SIZE = 4 * sizeof(void*);
+    private:
+        using Invoker = R (*)(void *storage, std::add_lvalue_reference_t<Args>... args);
+
+        struct Operations
+        {
+            Invoker invoke;
+            void (*copy)(void *destination, const void *source);
+            void (*move)(void *destination, void *source);
+            void (*destroy)(void *storage);
+        };
+
+        template<typename F>
+        static R Call(F &function, std::add_lvalue_reference_t<Args>... args)
+        {
+            if constexpr (std::is_void<R>::value)
+                std::invoke(function, args...);
+            else
+                return std::invoke(function, args...);
+        }
+
+        template<typename F>
+        struct Inline
+        {
+            static F *Get(void *storage) { return std::launder(reinterpret_cast<F*>(storage)); }
+            static R Invoke(void *storage, std::add_lvalue_reference_t<Args>... args) { return Call(*Get(storage), args...); }
+            static void Copy(void *destination, const void *source) { new (destination) F(*std::launder(reinterpret_cast<const F*>(source))); }
+            static void Move(void *destination, void *source) { new (destination) F(std::move(*Get(source))); Get(source)->~F(); }
+            static void Destroy(void *storage) { Get(storage)->~F(); }
+            static constexpr Operations table = { &Invoke, &Copy, &Move, &Destroy };
+        };
+
+        template<typename F>
+        struct Heap
+        {
+            static F *Get(const void *storage) { return *std::launder(reinterpret_cast<F* const*>(storage)); }
+            static R Invoke(void *storage, std::add_lvalue_reference_t<Args>... args) { return Call(*Get(storage), args...); }
+            static void Copy(void *destination, const void *source) { new (destination) F*(new F(*Get(source))); }
+            static void Move(void *destination, void *source) { new (destination) F*(Get(source)); }
+            static void Destroy(void *storage) { delete Get(storage); }
+            static constexpr Operations table = { &Invoke, &Copy, &Move, &Destroy };
+        };
+
+        template<typename F>
+        static constexpr bool FitsInline = sizeof(F) <= BUFFER_SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+
+        alignas(std::max_align_t) unsigned char buffer[BUFFER_SIZE];
+        const Operations *operations;
+        Invoker invoker;    //Copied out of operations to save an indirection per call
+    public:
+        Delegate() : operations(nullptr), invoker(nullptr) {}
+
+        template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value>>
+        Delegate(F &&function) : operations(nullptr), invoker(nullptr)
+        {
+            using Type = std::decay_t<F>;
+            static_assert(std::is_invocable<Type&, std::add_lvalue_reference_t<Args>...>::value, "Delegate parameter must be callable with the event arguments");
+
+            //Empty std::function objects and null function pointers are not stored, functions and lambdas are never empty
+            if constexpr (std::is_pointer<std::remove_reference_t<F>>::value || std::is_member_pointer<std::remove_reference_t<F>>::value || IsStdFunction<Type>::value)
+            {
+                if(!static_cast<bool>(function))
+                    return;
+            }
+
+            if constexpr (FitsInline<Type>)
+            {
+                new (buffer) Type(std::forward<F>(function));
+                operations = &Inline<Type>::table;
+            }
+            else
+            {
+                new (buffer) Type*(new Type(std::forward<F>(function)));
+                operations = &Heap<Type>::table;
+            }
+
+            invoker = operations->invoke;
+        }
+
+        Delegate(const Delegate &other) : operations(other.operations), invoker(other.invoker)
+        {
+            if(operations)
+                operations->copy(buffer, other.buffer);
+        }
+
+        Delegate(Delegate &&other) noexcept : operations(other.operations), invoker(other.invoker)
+        {
+            if(operations)
+            {
+                operations->move(buffer, other.buffer);
+                other.operations = nullptr;
+                other.invoker = nullptr;
+            }
+        }
+
+        ~Delegate()
+        {
+            Reset();
+        }
+
+        Delegate &operator=(const Delegate &other)
+        {
+            if(this != &other)
+            {
+                Delegate copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
 
-        template<typename ... Param>
-        void operator () (Param ... param)
+        Delegate &operator=(Delegate &&other) noexcept
         {
-            for(size_t i = 0; i < callbacks.size(); i++)
+            if(this != &other)
             {
-                if(callbacks[i])
+                Reset();
+                operations = other.operations;
+                invoker = other.invoker;
+
+                if(operations)
                 {
-                    callbacks[i](param...);
+                    operations->move(buffer, other.buffer);
+                    other.operations = nullptr;
+                    other.invoker = nullptr;
                 }
             }
+            return *this;
         }
 
-        void operator += (T callback)
+        void Reset()
         {
-            callbacks.push_back(callback);
+            if(operations)
+            {
+                operations->destroy(buffer);
+                operations = nullptr;
+                invoker = nullptr;
+            }
         }
+
+        R Invoke(std::add_lvalue_reference_t<Args>... args)
+        {
+            return invoker(buffer, args...);
+        }
+
+        R operator () (Args... args)
+        {
+            return Invoke(args...);
+        }
+
+        explicit operator bool () const
+        {
+            return operations != nullptr;
+        }
+    };
+
+    template<typename T>
+    class EventHandler;
+
+    // Multicast event. Arguments are copied once per raise and handed to every callback by reference.
+    // Raising takes them by value like std::function does, since callbacks may take non-const references to them.
+    // Callbacks may subscribe or unsubscribe while the event is raised, new callbacks run from the next raise and removed ones are released once it returns.
+    template<typename R, typename ... Args>
+    class EventHandler<R(Args...)>
+    {
+    private:
+        struct Slot
+        {
+            Delegate<R(Args...)> callback;
+            uint32_t generation;
+            bool isActive;
+        };
+        std::vector<Slot> slots;
+        std::vector<Slot> addedSlots;   //Subscribed during a raise, slots can not grow while it is being walked
+        std::vector<uint32_t> freeSlots;
+        std::vector<uint32_t> pendingRemovals;
+        uint32_t invokeDepth = 0;
+        size_t count = 0;
+
+        Slot *GetSlot(uint32_t index)
+        {
+            if(index < slots.size())
+                return &slots[index];
+            if(index - slots.size() < addedSlots.size())
+                return &addedSlots[index - slots.size()];
+            return nullptr;
+        }
+
+        void EndInvoke()
+        {
+            for(size_t i = 0; i < addedSlots.size(); i++)
+                slots.push_back(std::move(addedSlots[i]));
+            addedSlots.clear();
+
+            for(size_t i = 0; i < pendingRemovals.size(); i++)
+            {
+                slots[pendingRemovals[i]].callback.Reset();
+                freeSlots.push_back(pendingRemovals[i]);
+            }
+            pendingRemovals.clear();
+        }
+    public:
+        template<typename F>
+        EventToken Add(F &&callback)
+        {
+            Delegate<R(Args...)> delegate(std::forward<F>(callback));
+
+            if(!delegate)
+                return EventToken();
+
+            count++;
+
+            if(invokeDepth > 0)
+            {
+                uint32_t index = static_cast<uint32_t>(slots.size() + addedSlots.size());
+                addedSlots.push_back({ std::move(delegate), 0, true });
+                return EventToken(index, 0);
+            }
+
+            if(freeSlots.size() > 0)
+            {
+                uint32_t index = freeSlots.back();
+                freeSlots.pop_back();
+                Slot &slot = slots[index];
+                slot.callback = std::move(delegate);
+                slot.isActive = true;
+                return EventToken(index, slot.generation);
+            }
+
+            slots.push_back({ std::move(delegate), 0, true });
+            return EventToken(static_cast<uint32_t>(slots.size() - 1), 0);
+        }
+
+        bool Remove(const EventToken &token)
+        {
+            Slot *slot = GetSlot(token.index);
+
+            if(!slot || !slot->isActive || slot->generation != token.generation)
+                return false;
+
+            slot->isActive = false;
+            slot->generation++;
+            count--;
+
+            //The callback may be the one that is running right now
+            if(invokeDepth > 0)
+            {
+                pendingRemovals.push_back(token.index);
+            }
+            else
+            {
+                slot->callback.Reset();
+                freeSlots.push_back(token.index);
+            }
+
+            return true;
+        }
+
+        void Clear()
+        {
+            const uint32_t total = static_cast<uint32_t>(slots.size() + addedSlots.size());
+
+            for(uint32_t i = 0; i < total; i++)
+            {
+                Slot *slot = GetSlot(i);
+                if(slot->isActive)
+                    Remove(EventToken(i, slot->generation));
+            }
+        }
+
+        size_t GetCount() const
+        {
+            return count;
+        }
+
+        void operator () (Args... args)
+        {
+            Slot *data = slots.data();
+            const size_t size = slots.size();
+
+            invokeDepth++;
+
+            for(size_t i = 0; i < size; i++)
+            {
+                if(data[i].isActive)
+                    data[i].callback.Invoke(args...);
+            }
+
+            if(--invokeDepth == 0 && (addedSlots.size() > 0 || pendingRemovals.size() > 0))
+                EndInvoke();
+        }
+
+        template<typename F>
+        EventToken operator += (F &&callback)
+        {
+            return Add(std::forward<F>(callback));
+        }
+
+        void operator -= (const EventToken &token)
+        {
+            Remove(token);
+        }
+    };
+
+    //Events are usually declared with their std::function type
+    template<typename R, typename ... Args>
+    class EventHandler<std::function<R(Args...)>> : public EventHandler<R(Args...)>
+    {
+    };
+
+    template<typename T, size_t Capacity = 8>
+    class ConcurrentEventHandler;
+
+    // Fixed capacity event for realtime threads such as the audio thread.
+    // Raising it never locks or allocates, callbacks that are being added or removed at that moment are skipped.
+    // It is raised from one thread and subscribed to from one other thread. Remove waits until the callback is no longer running.
+    template<typename R, typename ... Args, size_t Capacity>
+    class ConcurrentEventHandler<R(Args...), Capacity>
+    {
+    private:
+        static constexpr uint32_t SLOT_FREE = 0;
+        static constexpr uint32_t SLOT_WRITING = 1;
+        static constexpr uint32_t SLOT_READY = 2;
+        static constexpr uint32_t SLOT_INVOKING = 3;
+
+        struct Slot
+        {
+            Delegate<R(Args...)> callback;
+            std::atomic<uint32_t> state{SLOT_FREE};
+            uint32_t generation = 0;
+        };
+        Slot slots[Capacity];
+    public:
+        ConcurrentEventHandler() = default;
+        ConcurrentEventHandler(const ConcurrentEventHandler&) = delete;
+        ConcurrentEventHandler &operator=(const ConcurrentEventHandler&) = delete;
+
+        //Returns an invalid token when all slots are taken
+        template<typename F>
+        EventToken Add(F &&callback)
+        {
+            Delegate<R(Args...)> delegate(std::forward<F>(callback));
+
+            if(!delegate)
+                return EventToken();
+
+            for(uint32_t i = 0; i < Capacity; i++)
+            {
+                uint32_t expected = SLOT_FREE;
+
+                if(slots[i].state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire))
+                {
+                    slots[i].callback = std::move(delegate);
+                    slots[i].generation++;
+                    slots[i].state.store(SLOT_READY, std::memory_order_release);
+                    return EventToken(i, slots[i].generation);
+                }
+            }
+
+            return EventToken();
+        }
+
+        bool Remove(const EventToken &token)
+        {
+            if(token.index >= Capacity)
+                return false;
+
+            Slot &slot = slots[token.index];
+
+            if(slot.generation != token.generation)
+                return false;
+
+            while(true)
+            {
+                uint32_t expected = SLOT_READY;
+
+                if(slot.state.compare_exchange_weak(expected, SLOT_WRITING, std::memory_order_acquire))
+                    break;
+
+                if(expected != SLOT_INVOKING && expected != SLOT_READY)
+                    return false;
+
+                std::this_thread::yield();
+            }
+
+            slot.callback.Reset();
+            slot.generation++;
+            slot.state.store(SLOT_FREE, std::memory_order_release);
+            return true;
+        }
+
+        void Clear()
+        {
+            for(uint32_t i = 0; i < Capacity; i++)
+                Remove(EventToken(i, slots[i].generation));
+        }
+
+        void operator () (Args... args)
+        {
+            for(uint32_t i = 0; i < Capacity; i++)
+            {
+                Slot &slot = slots[i];
+                uint32_t expected = SLOT_READY;
+
+                if(!slot.state.compare_exchange_strong(expected, SLOT_INVOKING, std::memory_order_acquire))
+                    continue;
+
+                slot.callback.Invoke(args...);
+                slot.state.store(SLOT_READY, std::memory_order_release);
+            }
+        }
+
+        template<typename F>
+        EventToken operator += (F &&callback)
+        {
+            return Add(std::forward<F>(callback));
+        }
+
+        void operator -= (const EventToken &token)
+        {
+            Remove(token);
+        }
+    };
+
+    template<typename R, typename ... Args, size_t Capacity>
+    class ConcurrentEventHandler<std::function<R(Args...)>, Capacity> : public ConcurrentEventHandler<R(Args...), Capacity>
+    {
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,104 @@
+#ifndef GFX_FRAMEARENA_HPP
+#define GFX_FRAMEARENA_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace GFX
+{
+    // Linear allocator for data that only lives for the current frame.
+    // Allocating is a pointer bump in a page owned by the calling thread, there is nothing to free.
+    // The arena is double buffered, memory handed out in frame N stays valid until the start of frame N + 2.
+    // Jobs that allocate from the arena have to finish within the frame that scheduled them.
+    class FrameArena
+    {
+    friend class Application;
+    friend class Testing;
+    private:
+        static void NewFrame();
+    public:
+        static constexpr size_t PAGE_SIZE = 64 * 1024;
+        static void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        static uint64_t GetFrame();
+        static bool IsValid(uint64_t frame);
+        static size_t GetLastFrameUsedBytes();
+        static size_t GetCapacity();
+        static uint64_t GetHeapAllocationCount();
+        static uint64_t GetLastFrameHeapAllocationCount();
+
+        template<typename T>
+        static T *Allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "FrameArena memory is never destructed");
+            return reinterpret_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+        }
+    };
+
+    // STL allocator on top of the FrameArena. Containers using it must not outlive the frame after the one they were created in.
+    // Debug builds assert when such a container is used or destroyed later than that.
+    template<typename T>
+    class FrameAllocator
+    {
+    template<typename U> friend class FrameAllocator;
+    private:
+        uint64_t frame;
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        FrameAllocator() noexcept
+        {
+            frame = FrameArena::GetFrame();
+        }
+
+        template<typename U>
+        FrameAllocator(const FrameAllocator<U> &other) noexcept
+        {
+            frame = other.frame;
+        }
+
+        T *allocate(size_t count)
+        {
+            assert(FrameArena::IsValid(frame) && "FrameAllocator used after its frame ended");
+            return reinterpret_cast<T*>(FrameArena::Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *pointer, size_t count) noexcept
+        {
+            assert(FrameArena::IsValid(frame) && "FrameAllocator memory released after its frame ended");
+            (void)pointer;
+            (void)count;
+        }
+
+        //Copies of a container belong to the frame they are made in
+        FrameAllocator select_on_container_copy_construction() const noexcept
+        {
+            return FrameAllocator();
+        }
+
+        template<typename U>
+        bool operator==(const FrameAllocator<U> &other) const noexcept
+        {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const FrameAllocator<U> &other) const noexcept
+        {
+            return false;
+        }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+    using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef GFX_HASH_HPP
+#define GFX_HASH_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace GFX
+{
+    class Hash
+    {
+    public:
+        static constexpr uint32_t FNV_OFFSET_BASIS_32 = 2166136261u;
+        static constexpr uint64_t FNV_OFFSET_BASIS_64 = 14695981039346656037ull;
+        static uint32_t FNV1a32(const void *data, size_t size, uint32_t seed = FNV_OFFSET_BASIS_32);
+        static uint32_t FNV1a32(const std::string &str, uint32_t seed = FNV_OFFSET_BASIS_32);
+        static uint64_t FNV1a64(const void *data, size_t size, uint64_t seed = FNV_OFFSET_BASIS_64);
+        static uint64_t FNV1a64(const std::string &str, uint64_t seed = FNV_OFFSET_BASIS_64);
+        static uint64_t Combine(uint64_t seed, uint64_t value);
+        static std::string ToHexString(uint64_t hash);
+    };
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef GFX_MEMORYMAPPEDFILE_HPP
+#define GFX_MEMORYMAPPEDFILE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace GFX
+{
+    // Read only view of a whole file, the mapping is released on Close or destruction
+    class MemoryMappedFile
+    {
+    private:
+        const uint8_t *data;
+        size_t size;
+#ifdef _WIN32
+        void *fileHandle;
+        void *mappingHandle;
+#else
+        int fileDescriptor;
+#endif
+    public:
+        MemoryMappedFile();
+        MemoryMappedFile(const std::string &filepath);
+        MemoryMappedFile(const MemoryMappedFile &other) = delete;
+        MemoryMappedFile(MemoryMappedFile &&other) noexcept;
+        ~MemoryMappedFile();
+        MemoryMappedFile& operator=(const MemoryMappedFile &other) = delete;
+        MemoryMappedFile& operator=(MemoryMappedFile &&other) noexcept;
+        bool Open(const std::string &filepath);
+        void Close();
+        bool IsOpen() const;
+        const uint8_t *GetData() const;
+        size_t GetSize() const;
+    };
+}
+
+#endif
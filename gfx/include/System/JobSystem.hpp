@@ -0,0 +1,81 @@
+#ifndef GFX_JOBSYSTEM_HPP
+#define GFX_JOBSYSTEM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace GFX
+{
+    class JobCounter;
+
+    using JobFunction = std::function<void(void)>;
+
+    enum class JobPriority
+    {
+        High = 0,
+        Normal = 1,
+        Low = 2,
+        Count = 3
+    };
+
+    struct JobEntry
+    {
+        JobFunction function;
+        JobCounter *counter;
+        JobPriority priority;
+        bool mainThreadOnly;
+    };
+
+    // Counts the unfinished jobs that were scheduled with it. Jobs scheduled with JobSystem::ScheduleAfter run once it reaches zero.
+    // A counter must outlive its jobs, only destroy it after JobSystem::Wait has returned.
+    class JobCounter
+    {
+    friend class JobSystem;
+    private:
+        std::atomic<int32_t> count;
+        std::mutex mutex;
+        std::vector<JobEntry> continuations;
+    public:
+        JobCounter();
+        JobCounter(const JobCounter&) = delete;
+        JobCounter &operator=(const JobCounter&) = delete;
+        int32_t GetCount() const;
+        bool IsDone() const;
+    };
+
+    // Engine wide work stealing job system.
+    // Every worker owns a deque per priority, it pops its own jobs from the back and steals from the front of the others.
+    // With zero workers nothing runs in the background: jobs run on the main thread in a fixed order when it waits or calls NewFrame, which makes runs reproducible.
+    class JobSystem
+    {
+    friend class Application;
+    friend class Testing;
+    private:
+        static void NewFrame();
+        static bool TryExecute(int32_t workerIndex, JobPriority lowestPriority = JobPriority::Low);
+        static bool TryExecuteMainThread();
+        static void Execute(JobEntry &job);
+        static void Enqueue(JobEntry &&job);
+        static void Finish(JobCounter *counter);
+        static void WorkerLoop(int32_t workerIndex);
+    public:
+        static constexpr uint32_t DEFAULT_WORKER_COUNT = 0xFFFFFFFF;
+        static void Initialize(uint32_t workerCount = DEFAULT_WORKER_COUNT);
+        static void Deinitialize();
+        static bool IsInitialized();
+        static uint32_t GetWorkerCount();
+        static bool IsMainThread();
+        static void Schedule(const JobFunction &job, JobCounter *counter = nullptr, JobPriority priority = JobPriority::Normal);
+        static void ScheduleAfter(JobCounter &dependency, const JobFunction &job, JobCounter *counter = nullptr, JobPriority priority = JobPriority::Normal);
+        static void ScheduleOnMainThread(const JobFunction &job, JobCounter *counter = nullptr);
+        static void Wait(JobCounter &counter);
+        static void ParallelFor(size_t count, const std::function<void(size_t)> &job, JobPriority priority = JobPriority::High);
+        static void ParallelForRange(size_t count, size_t batchSize, const std::function<void(size_t,size_t)> &job, JobPriority priority = JobPriority::High);
+    };
+}
+
+#endif
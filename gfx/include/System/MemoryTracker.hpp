@@ -0,0 +1,89 @@
+#ifndef GFX_MEMORYTRACKER_HPP
+#define GFX_MEMORYTRACKER_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <functional>
+
+namespace GFX
+{
+    enum class MemoryTag : uint32_t
+    {
+        General,
+        Resources,
+        Mesh,
+        Image,
+        Audio,
+        Physics,
+        AssetPack,
+        Frame,
+        Count
+    };
+
+    struct MemoryTagStats
+    {
+        size_t currentBytes;
+        size_t peakBytes;
+        size_t budget;
+        uint64_t allocationCount;
+        uint64_t freeCount;
+    };
+
+    struct MemorySnapshot
+    {
+        MemoryTagStats tags[static_cast<size_t>(MemoryTag::Count)];
+        size_t trackedBytes;
+        size_t heapBytes;
+        size_t heapPeakBytes;
+        uint64_t heapAllocationCount;
+        const MemoryTagStats &Get(MemoryTag tag) const;
+    };
+
+    using MemoryBudgetCallback = std::function<void(MemoryTag tag, size_t currentBytes, size_t budget)>;
+
+    // Keeps count of the memory owned by each subsystem, with high water marks and an optional budget per tag.
+    // Subsystems report what they hold with Add/Remove or a MemoryUsage member, Allocate/Free track the blocks they hand out.
+    // Budget callbacks run on the main thread from CheckBudgets, once per frame for as long as a tag stays over its budget.
+    // The heap totals in a snapshot are only filled in when the engine is built with GFX_COUNT_HEAP_ALLOCATIONS.
+    class MemoryTracker
+    {
+    public:
+        static void Add(MemoryTag tag, size_t bytes);
+        static void Remove(MemoryTag tag, size_t bytes);
+        static void *Allocate(MemoryTag tag, size_t size, size_t alignment = alignof(std::max_align_t));
+        static void *Reallocate(MemoryTag tag, void *pointer, size_t size);
+        static void Free(void *pointer);
+        static void SetBudget(MemoryTag tag, size_t bytes);
+        static size_t GetBudget(MemoryTag tag);
+        static void SetBudgetCallback(MemoryTag tag, const MemoryBudgetCallback &callback);
+        static void CheckBudgets();
+        static size_t GetCurrentBytes(MemoryTag tag);
+        static size_t GetPeakBytes(MemoryTag tag);
+        static uint64_t GetHeapAllocationCount();
+        static void ResetPeaks();
+        static MemorySnapshot GetSnapshot();
+        static const char *GetTagName(MemoryTag tag);
+    };
+
+    // Reports the size of a payload that is owned by the object it is a member of.
+    // Copies report the same size again and moves hand it over, so it follows the value semantics of its owner.
+    class MemoryUsage
+    {
+    private:
+        MemoryTag tag;
+        size_t bytes;
+    public:
+        MemoryUsage(MemoryTag tag);
+        MemoryUsage(const MemoryUsage &other);
+        MemoryUsage(MemoryUsage &&other) noexcept;
+        MemoryUsage &operator=(const MemoryUsage &other);
+        MemoryUsage &operator=(MemoryUsage &&other) noexcept;
+        ~MemoryUsage();
+        void Set(size_t bytes);
+        size_t Get() const;
+        MemoryTag GetTag() const;
+    };
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef GFX_SLABALLOCATOR_HPP
+#define GFX_SLABALLOCATOR_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace GFX
+{
+    // Hands out fixed size blocks carved from larger slabs.
+    // Released blocks go on a free list and are reused before a new slab is allocated, slabs are only given back in the destructor.
+    class SlabAllocator
+    {
+    private:
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+        size_t blockSize;
+        size_t blocksPerSlab;
+        size_t allocatedCount;
+        FreeBlock *freeList;
+        std::vector<void*> slabs;
+        std::mutex mutex;
+        void AddSlab();
+    public:
+        SlabAllocator(size_t blockSize, size_t blocksPerSlab = 256);
+        SlabAllocator(const SlabAllocator&) = delete;
+        SlabAllocator &operator=(const SlabAllocator&) = delete;
+        ~SlabAllocator();
+        void *Allocate();
+        void Deallocate(void *block);
+        size_t GetBlockSize() const;
+        size_t GetAllocatedCount() const;
+        size_t GetCapacity() const;
+    };
+}
+
+#endif
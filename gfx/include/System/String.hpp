@@ -23,6 +23,7 @@ namespace GFX
         static std::string SubString(const std::string &str, size_t startIndex);
         static std::string SubString(const std::string &str, size_t startIndex, size_t length);
         static int64_t IndexOf(const std::string &str, const std::string &subStr);
+        static uint32_t DecodeUTF8(const char *text, size_t length, size_t &index);
 
         static bool TryParseInt8(const std::string &str, int8_t &value);
         static bool TryParseUInt8(const std::string &str, uint8_t &value);
@@ -0,0 +1,42 @@
+#ifndef GFX_STRINGID_HPP
+#define GFX_STRINGID_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace GFX
+{
+    // Interned string that compares and hashes as a single integer.
+    // The id is the 64 bit FNV-1a hash of the text, so it is the same in every run and can be stored or sent over the network.
+    // The text is kept in a global table and lives until the program exits.
+    class StringId
+    {
+    private:
+        uint64_t id;
+        static uint64_t Intern(const char *text, size_t length);
+    public:
+        StringId();
+        explicit StringId(const std::string &text);
+        StringId(const char *text, size_t length);
+        uint64_t GetId() const;
+        const std::string &GetString() const;
+        bool IsEmpty() const;
+        bool operator==(const StringId &other) const;
+        bool operator!=(const StringId &other) const;
+        bool operator<(const StringId &other) const;
+        static bool TryGet(const std::string &text, StringId &value);
+        static size_t GetCount();
+    };
+
+    // For std::unordered_map and friends, the id already is a hash
+    struct StringIdHash
+    {
+        size_t operator()(const StringId &value) const
+        {
+            return static_cast<size_t>(value.GetId());
+        }
+    };
+}
+
+#endif
@@ -24,7 +24,10 @@ namespace GFX
         if(context != nullptr)
         {
             for(size_t i = 0; i < sources.size(); i++)
+            {
                 sources[i]->Destroy();
+                sources[i]->state.Destroy();
+            }
 
             sources.clear();
 
@@ -56,22 +59,23 @@ namespace GFX
             ma_ex_audio_listener_set_velocity(handle, velocity.x, velocity.y, velocity.z);
         }
 
+        //End callbacks may add or destroy components, so they are raised before walking the packed sources
         for(size_t i = 0; i < sources.size(); i++)
-        {
             sources[i]->Update();
 
-            if(!sources[i]->GetSpatial())
-                continue;
-            
-            auto handle = sources[i]->GetHandle();
-            auto position = sources[i]->GetTransform()->GetPosition();
-            auto direction = sources[i]->GetTransform()->GetForward();
-            auto velocity = sources[i]->GetTransform()->GetVelocity();
-
-            ma_ex_audio_source_set_position(handle, position.x, position.y, position.z);
-            ma_ex_audio_source_set_direction(handle, direction.x, direction.y, direction.z);
-            ma_ex_audio_source_set_velocity(handle, velocity.x, velocity.y, velocity.z);
-        }
+        ArchetypeStorage::GetDefault().ForEach<ArchetypeOwner, AudioSourceState>([] (ArchetypeOwner &owner, AudioSourceState &state) {
+            if(!state.isSpatial)
+                return;
+
+            Transform *transform = owner.component->GetTransform();
+            auto position = transform->GetPosition();
+            auto direction = transform->GetForward();
+            auto velocity = transform->GetVelocity();
+
+            ma_ex_audio_source_set_position(state.handle, position.x, position.y, position.z);
+            ma_ex_audio_source_set_direction(state.handle, direction.x, direction.y, direction.z);
+            ma_ex_audio_source_set_velocity(state.handle, velocity.x, velocity.y, velocity.z);
+        });
     }
 
     ma_ex_context *Audio::GetContext()
@@ -88,6 +92,11 @@ namespace GFX
         }
 
         sources.push_back(source);
+
+        AudioSourceState state;
+        state.handle = source->handle;
+        state.isSpatial = ma_ex_audio_source_get_spatialization(source->handle) > 0;
+        source->state.Create(source, state);
     }
 
     void Audio::Add(AudioListener *listener)
@@ -119,6 +128,7 @@ namespace GFX
         if(found)
         {
             sources[index]->Destroy();
+            sources[index]->state.Destroy();
             sources.erase(sources.begin() + index);
         }
     }
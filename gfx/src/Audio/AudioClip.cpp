@@ -23,6 +23,7 @@ namespace GFX
         this->handle = reinterpret_cast<void*>(const_cast<uint8_t*>(this->data.data()));
         this->dataSize = this->data.size();
         this->streamFromDisk = false;
+        this->memoryUsage.Set(this->data.capacity());
     }
 
     AudioClip::AudioClip(void *data, size_t size)
@@ -147,6 +147,9 @@ namespace GFX
     void AudioSource::SetSpatial(bool spatial)
     {
         ma_ex_audio_source_set_spatialization(handle, spatial ? MA_TRUE : MA_FALSE);
+
+        if(AudioSourceState *data = state.Get())
+            data->isSpatial = spatial;
     }
 
     bool AudioSource::GetSpatial() const
@@ -5,6 +5,9 @@
 #include "../Graphics/Image.hpp"
 #include "../Audio/Audio.hpp"
 #include "../Physics/Physics.hpp"
+#include "../System/JobSystem.hpp"
+#include "../System/FrameArena.hpp"
+#include "../System/MemoryTracker.hpp"
 #include "Input.hpp"
 #include "Time.hpp"
 #include "GameBehaviour.hpp"
@@ -231,6 +234,7 @@ namespace GFX
         GLFWmonitor* monitor =  glfwGetPrimaryMonitor();
         const GLFWvidmode* mode = glfwGetVideoMode(monitor);
 
+        JobSystem::Initialize();
 		Graphics::Initialize(config.width, config.height, mode->width, mode->height);
         Audio::Initialize(44100, 2);
         Input::Initialize();
@@ -241,14 +245,18 @@ namespace GFX
 	{
         GameBehaviour::OnBehaviourApplicationQuit();
 		Graphics::Deinitialize();
-        Physics::Initialize();
+        Physics::Deinitialize();
         Audio::Deinitialize();
+        JobSystem::Deinitialize();
 	}
 
 	void Application::NewFrame()
 	{
+        FrameArena::NewFrame();
+        MemoryTracker::CheckBudgets();
         Time::NewFrame();
         Input::NewFrame();
+        JobSystem::NewFrame();
         Resources::NewFrame();
         GameBehaviour::NewFrame();
         Audio::NewFrame();
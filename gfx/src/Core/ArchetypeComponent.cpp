@@ -0,0 +1,44 @@
+#include "ArchetypeComponent.hpp"
+
+namespace GFX
+{
+    ArchetypeComponent::ArchetypeComponent() : Component()
+    {
+        this->storage = &ArchetypeStorage::GetDefault();
+    }
+
+    ArchetypeComponent::ArchetypeComponent(ArchetypeStorage *storage) : Component()
+    {
+        this->storage = storage;
+    }
+
+    void ArchetypeComponent::OnInitialize()
+    {
+        if(!storage)
+            return;
+
+        entity = storage->CreateEntity();
+
+        ArchetypeOwner owner;
+        owner.component = this;
+        storage->AddComponent<ArchetypeOwner>(entity, owner);
+    }
+
+    void ArchetypeComponent::OnDestroy()
+    {
+        //Can be called more than once while the GameObject is torn down
+        if(storage)
+            storage->DestroyEntity(entity);
+        entity = EntityHandle();
+    }
+
+    ArchetypeStorage *ArchetypeComponent::GetStorage() const
+    {
+        return storage;
+    }
+
+    EntityHandle ArchetypeComponent::GetEntity() const
+    {
+        return entity;
+    }
+}
@@ -0,0 +1,402 @@
+#include "ArchetypeStorage.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace GFX
+{
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    struct ArchetypeTypeInfo
+    {
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    static std::vector<ArchetypeTypeInfo> registeredTypes;
+    static std::mutex registeredTypesMutex;
+
+    static size_t AlignOffset(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    EntityHandle::EntityHandle()
+    {
+        index = INVALID_INDEX;
+        generation = 0;
+    }
+
+    EntityHandle::EntityHandle(uint32_t index, uint32_t generation)
+    {
+        this->index = index;
+        this->generation = generation;
+    }
+
+    bool EntityHandle::operator==(const EntityHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool EntityHandle::operator!=(const EntityHandle &other) const
+    {
+        return !(*this == other);
+    }
+
+    Archetype::Archetype(uint64_t mask, const std::vector<uint32_t> &typeIds, const std::vector<uint32_t> &typeSizes, const std::vector<uint32_t> &typeAlignments)
+    {
+        this->mask = mask;
+        this->typeIds = typeIds;
+        this->typeSizes.assign(MAX_TYPES, 0);
+        memset(columnOffsets, 0, sizeof(columnOffsets));
+
+        size_t bytesPerEntity = sizeof(EntityHandle);
+        chunkAlignment = 64;
+
+        for(size_t i = 0; i < typeIds.size(); i++)
+        {
+            this->typeSizes[typeIds[i]] = typeSizes[i];
+            bytesPerEntity += typeSizes[i];
+            chunkAlignment = std::max<size_t>(chunkAlignment, typeAlignments[i]);
+        }
+
+        auto layout = [&] (uint32_t count) -> size_t {
+            size_t offset = sizeof(EntityHandle) * count;
+            for(size_t i = 0; i < typeIds.size(); i++)
+            {
+                offset = AlignOffset(offset, typeAlignments[i]);
+                columnOffsets[typeIds[i]] = static_cast<uint32_t>(offset);
+                offset += static_cast<size_t>(typeSizes[i]) * count;
+            }
+            return offset;
+        };
+
+        //Start from the unpadded estimate and shrink until the aligned columns fit
+        capacity = static_cast<uint32_t>(std::max<size_t>(1, CHUNK_SIZE / bytesPerEntity));
+
+        while(capacity > 1 && layout(capacity) > CHUNK_SIZE)
+            capacity--;
+
+        chunkSize = std::max(CHUNK_SIZE, AlignOffset(layout(capacity), chunkAlignment));
+    }
+
+    Archetype::~Archetype()
+    {
+        for(size_t i = 0; i < chunks.size(); i++)
+            operator delete(chunks[i].data, std::align_val_t(chunkAlignment));
+        chunks.clear();
+    }
+
+    uint64_t Archetype::GetMask() const
+    {
+        return mask;
+    }
+
+    uint32_t Archetype::GetChunkCapacity() const
+    {
+        return capacity;
+    }
+
+    size_t Archetype::GetChunkCount() const
+    {
+        return chunks.size();
+    }
+
+    size_t Archetype::GetEntityCount() const
+    {
+        if(chunks.size() == 0)
+            return 0;
+        return (chunks.size() - 1) * capacity + chunks.back().count;
+    }
+
+    EntityHandle *Archetype::GetEntities(const ArchetypeChunk &chunk) const
+    {
+        return reinterpret_cast<EntityHandle*>(chunk.data);
+    }
+
+    uint8_t *Archetype::GetColumn(const ArchetypeChunk &chunk, uint32_t typeId) const
+    {
+        if(typeId >= MAX_TYPES || !(mask & (1ULL << typeId)))
+            return nullptr;
+        return chunk.data + columnOffsets[typeId];
+    }
+
+    void Archetype::Allocate(EntityHandle entity, uint32_t &chunkIndex, uint32_t &row)
+    {
+        if(chunks.size() == 0 || chunks.back().count == capacity)
+        {
+            ArchetypeChunk chunk;
+            chunk.data = static_cast<uint8_t*>(operator new(chunkSize, std::align_val_t(chunkAlignment)));
+            chunk.count = 0;
+            chunks.push_back(chunk);
+        }
+
+        chunkIndex = static_cast<uint32_t>(chunks.size() - 1);
+        ArchetypeChunk &chunk = chunks.back();
+        row = chunk.count++;
+        GetEntities(chunk)[row] = entity;
+    }
+
+    EntityHandle Archetype::Remove(uint32_t chunkIndex, uint32_t row)
+    {
+        //Fill the hole with the very last entity so every chunk but the last one stays full
+        ArchetypeChunk &last = chunks.back();
+        uint32_t lastChunkIndex = static_cast<uint32_t>(chunks.size() - 1);
+        uint32_t lastRow = last.count - 1;
+        EntityHandle moved;
+
+        if(chunkIndex != lastChunkIndex || row != lastRow)
+        {
+            ArchetypeChunk &chunk = chunks[chunkIndex];
+
+            for(size_t i = 0; i < typeIds.size(); i++)
+            {
+                uint32_t typeId = typeIds[i];
+                uint32_t size = typeSizes[typeId];
+                memcpy(GetColumn(chunk, typeId) + static_cast<size_t>(row) * size, GetColumn(last, typeId) + static_cast<size_t>(lastRow) * size, size);
+            }
+
+            moved = GetEntities(last)[lastRow];
+            GetEntities(chunk)[row] = moved;
+        }
+
+        last.count--;
+
+        if(last.count == 0)
+        {
+            operator delete(last.data, std::align_val_t(chunkAlignment));
+            chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+    ArchetypeStorage::ArchetypeStorage()
+    {
+        entityCount = 0;
+    }
+
+    ArchetypeStorage &ArchetypeStorage::GetDefault()
+    {
+        //Holds Transform and the other engine components, never destroyed because objects can still be released during static destruction
+        static ArchetypeStorage *storage = new ArchetypeStorage();
+        return *storage;
+    }
+
+    uint32_t ArchetypeStorage::RegisterType(size_t size, size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock(registeredTypesMutex);
+
+        uint32_t id = static_cast<uint32_t>(registeredTypes.size());
+
+        if(id >= Archetype::MAX_TYPES)
+            Debug::WriteError("ArchetypeStorage: no more than 64 data types can be registered");
+
+        ArchetypeTypeInfo info;
+        info.size = static_cast<uint32_t>(size);
+        info.alignment = static_cast<uint32_t>(alignment);
+        registeredTypes.push_back(info);
+        return id;
+    }
+
+    uint64_t ArchetypeStorage::GetTypeMask(uint32_t typeId)
+    {
+        return typeId < Archetype::MAX_TYPES ? (1ULL << typeId) : 0;
+    }
+
+    uint32_t ArchetypeStorage::GetArchetype(uint64_t mask)
+    {
+        auto it = archetypeMap.find(mask);
+
+        if(it != archetypeMap.end())
+            return it->second;
+
+        std::vector<uint32_t> typeIds;
+        std::vector<uint32_t> typeSizes;
+        std::vector<uint32_t> typeAlignments;
+
+        {
+            std::lock_guard<std::mutex> lock(registeredTypesMutex);
+
+            for(uint32_t i = 0; i < Archetype::MAX_TYPES; i++)
+            {
+                if(!(mask & (1ULL << i)))
+                    continue;
+                typeIds.push_back(i);
+                typeSizes.push_back(registeredTypes[i].size);
+                typeAlignments.push_back(registeredTypes[i].alignment);
+            }
+        }
+
+        uint32_t index = static_cast<uint32_t>(archetypes.size());
+        archetypes.push_back(std::make_unique<Archetype>(mask, typeIds, typeSizes, typeAlignments));
+        archetypeMap[mask] = index;
+        return index;
+    }
+
+    EntityHandle ArchetypeStorage::CreateEntity()
+    {
+        return CreateEntityWithMask(0);
+    }
+
+    EntityHandle ArchetypeStorage::CreateEntityWithMask(uint64_t mask)
+    {
+        uint32_t index;
+
+        if(freeRecords.size() > 0)
+        {
+            index = freeRecords.back();
+            freeRecords.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(records.size());
+            EntityRecord record;
+            record.archetype = INVALID_INDEX;
+            record.chunk = 0;
+            record.row = 0;
+            record.generation = 1;
+            records.push_back(record);
+        }
+
+        EntityRecord &record = records[index];
+        EntityHandle entity(index, record.generation);
+        record.archetype = GetArchetype(mask);
+        archetypes[record.archetype]->Allocate(entity, record.chunk, record.row);
+        entityCount++;
+        return entity;
+    }
+
+    void ArchetypeStorage::DestroyEntity(EntityHandle entity)
+    {
+        if(!IsAlive(entity))
+            return;
+
+        EntityRecord &record = records[entity.index];
+        EntityHandle moved = archetypes[record.archetype]->Remove(record.chunk, record.row);
+
+        if(moved.index != INVALID_INDEX)
+        {
+            records[moved.index].chunk = record.chunk;
+            records[moved.index].row = record.row;
+        }
+
+        record.archetype = INVALID_INDEX;
+        record.generation++;
+        freeRecords.push_back(entity.index);
+        entityCount--;
+    }
+
+    bool ArchetypeStorage::IsAlive(EntityHandle entity) const
+    {
+        if(entity.index >= records.size())
+            return false;
+        const EntityRecord &record = records[entity.index];
+        return record.generation == entity.generation && record.archetype != INVALID_INDEX;
+    }
+
+    size_t ArchetypeStorage::GetEntityCount() const
+    {
+        return entityCount;
+    }
+
+    size_t ArchetypeStorage::GetArchetypeCount() const
+    {
+        return archetypes.size();
+    }
+
+    void ArchetypeStorage::Clear()
+    {
+        for(size_t i = 0; i < records.size(); i++)
+        {
+            if(records[i].archetype == INVALID_INDEX)
+                continue;
+            records[i].archetype = INVALID_INDEX;
+            records[i].generation++;
+            freeRecords.push_back(static_cast<uint32_t>(i));
+        }
+
+        archetypes.clear();
+        archetypeMap.clear();
+        entityCount = 0;
+    }
+
+    void ArchetypeStorage::MoveEntity(EntityHandle entity, uint32_t archetypeIndex)
+    {
+        EntityRecord &record = records[entity.index];
+        Archetype *source = archetypes[record.archetype].get();
+        Archetype *destination = archetypes[archetypeIndex].get();
+
+        uint32_t chunkIndex;
+        uint32_t row;
+        destination->Allocate(entity, chunkIndex, row);
+
+        const ArchetypeChunk &sourceChunk = source->chunks[record.chunk];
+        const ArchetypeChunk &destinationChunk = destination->chunks[chunkIndex];
+
+        for(size_t i = 0; i < destination->typeIds.size(); i++)
+        {
+            uint32_t typeId = destination->typeIds[i];
+
+            if(!(source->mask & (1ULL << typeId)))
+                continue;
+
+            uint32_t size = destination->typeSizes[typeId];
+            memcpy(destination->GetColumn(destinationChunk, typeId) + static_cast<size_t>(row) * size, source->GetColumn(sourceChunk, typeId) + static_cast<size_t>(record.row) * size, size);
+        }
+
+        EntityHandle moved = source->Remove(record.chunk, record.row);
+
+        if(moved.index != INVALID_INDEX)
+        {
+            records[moved.index].chunk = record.chunk;
+            records[moved.index].row = record.row;
+        }
+
+        record.archetype = archetypeIndex;
+        record.chunk = chunkIndex;
+        record.row = row;
+    }
+
+    uint8_t *ArchetypeStorage::AddType(EntityHandle entity, uint32_t typeId)
+    {
+        if(!IsAlive(entity) || typeId >= Archetype::MAX_TYPES)
+            return nullptr;
+
+        uint64_t mask = archetypes[records[entity.index].archetype]->mask;
+
+        if(!(mask & (1ULL << typeId)))
+            MoveEntity(entity, GetArchetype(mask | (1ULL << typeId)));
+
+        return GetType(entity, typeId);
+    }
+
+    bool ArchetypeStorage::RemoveType(EntityHandle entity, uint32_t typeId)
+    {
+        if(!IsAlive(entity) || typeId >= Archetype::MAX_TYPES)
+            return false;
+
+        uint64_t mask = archetypes[records[entity.index].archetype]->mask;
+
+        if(!(mask & (1ULL << typeId)))
+            return false;
+
+        MoveEntity(entity, GetArchetype(mask & ~(1ULL << typeId)));
+        return true;
+    }
+
+    uint8_t *ArchetypeStorage::GetType(EntityHandle entity, uint32_t typeId) const
+    {
+        if(!IsAlive(entity))
+            return nullptr;
+
+        const EntityRecord &record = records[entity.index];
+        const Archetype *archetype = archetypes[record.archetype].get();
+        uint8_t *column = archetype->GetColumn(archetype->chunks[record.chunk], typeId);
+
+        if(!column)
+            return nullptr;
+
+        return column + static_cast<size_t>(record.row) * archetype->typeSizes[typeId];
+    }
+}
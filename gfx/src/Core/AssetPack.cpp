@@ -14,6 +14,7 @@ namespace GFX
         char *pData = reinterpret_cast<char*>(vMemory.data());
         ifs.read(pData, vMemory.size());
         setg(pData, pData, pData + size);
+        memoryUsage.Set(vMemory.capacity());
     }
 
     AssetPack::AssetPack() 
@@ -155,6 +156,8 @@ namespace GFX
 
             // Load the file to be added
             std::vector<uint8_t> vBuffer(e.second.nSize);
+            MemoryUsage usage(MemoryTag::AssetPack);
+            usage.Set(vBuffer.capacity());
             std::ifstream i(e.first, std::ifstream::binary);
             i.read((char *)vBuffer.data(), e.second.nSize);
             i.close();
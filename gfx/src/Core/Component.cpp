@@ -1,14 +1,40 @@
 #include "Component.hpp"
+#include "ComponentType.hpp"
 #include "GameObject.hpp"
 #include "Transform.hpp"
+#include "../System/SlabAllocator.hpp"
+#include <new>
 #include <utility>
 
 namespace GFX
 {
+    //Components are small and come and go in bursts, so each 64 byte size class gets its own slabs
+    static constexpr size_t COMPONENT_SIZE_CLASS = 64;
+    static constexpr size_t COMPONENT_SIZE_CLASS_COUNT = 16;
+
+    static SlabAllocator *GetComponentAllocator(size_t size)
+    {
+        //Never destroyed, components can still be released during static destruction
+        static SlabAllocator **allocators = [] () {
+            SlabAllocator **result = new SlabAllocator*[COMPONENT_SIZE_CLASS_COUNT];
+            for(size_t i = 0; i < COMPONENT_SIZE_CLASS_COUNT; i++)
+                result[i] = new SlabAllocator((i + 1) * COMPONENT_SIZE_CLASS);
+            return result;
+        }();
+
+        size_t index = (size + COMPONENT_SIZE_CLASS - 1) / COMPONENT_SIZE_CLASS;
+
+        if(index == 0 || index > COMPONENT_SIZE_CLASS_COUNT)
+            return nullptr;
+
+        return allocators[index - 1];
+    }
+
     Component::Component() : Object()
     {
         gameObject = nullptr;
         transform = nullptr;
+        typeId = ComponentType::INVALID_ID;
     }
 
     Component::~Component()
@@ -16,6 +42,23 @@ namespace GFX
         
     }
 
+    void *Component::operator new(size_t size)
+    {
+        SlabAllocator *allocator = GetComponentAllocator(size);
+        if(!allocator)
+            return ::operator new(size);
+        return allocator->Allocate();
+    }
+
+    void Component::operator delete(void *pointer, size_t size)
+    {
+        SlabAllocator *allocator = GetComponentAllocator(size);
+        if(!allocator)
+            ::operator delete(pointer);
+        else
+            allocator->Deallocate(pointer);
+    }
+
     void Component::OnInitialize()
     {
 
@@ -0,0 +1,17 @@
+#include "ComponentType.hpp"
+
+namespace GFX
+{
+    std::atomic<uint32_t> ComponentType::count = 0;
+    std::atomic<uint8_t> ComponentType::relations[ComponentType::MAX_TYPES * ComponentType::MAX_TYPES] = {};
+
+    uint32_t ComponentType::Register()
+    {
+        return count.fetch_add(1);
+    }
+
+    uint32_t ComponentType::GetCount()
+    {
+        return count.load();
+    }
+}
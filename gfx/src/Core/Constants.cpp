@@ -34,6 +34,12 @@ namespace GFX
 				return "HorizontalBlur";
 			case ConstantString::ShaderVerticalBlur:
 				return "VerticalBlur";
+			case ConstantString::ShaderBlurCompute:
+				return "BlurCompute";
+			case ConstantString::ShaderBloomThreshold:
+				return "BloomThreshold";
+			case ConstantString::ShaderBloomComposite:
+				return "BloomComposite";
 			case ConstantString::ShaderDepth:
 				return "Depth";
 			case ConstantString::ShaderDiffuse:
@@ -58,6 +64,8 @@ namespace GFX
 				return "Water";
 			case ConstantString::ShaderTerrain:
 				return "Terrain";
+			case ConstantString::ShaderTonemap:
+				return "Tonemap";
 			case ConstantString::TextureDefault:
 				return "Default";
 			case ConstantString::TextureDefaultCubeMap:
@@ -66,6 +74,8 @@ namespace GFX
 				return "DefaultGrass";
 			case ConstantString::TextureDepth:
 				return "Depth";
+			case ConstantString::TextureDepthStatic:
+				return "DepthStatic";
 			default:
 				return "Unknown";
 		}
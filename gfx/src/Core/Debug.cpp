@@ -21,47 +21,58 @@ namespace GFX
 
     void Debug::WriteLine(const std::string &text, ConsoleColor color)
     {
-#ifdef _WIN32
-        std::cout << text << '\n';
-#else
-        std::cout << consoleColorMap[color] << text << consoleColorMap[ConsoleColor::Reset] << '\n';
-#endif
+        WriteText(text.c_str(), color, true);
     }
 
     void Debug::Write(const std::string &text, ConsoleColor color)
     {
-#ifdef _WIN32
-        std::cout << text;
-#else
-        std::cout << consoleColorMap[color] << text << consoleColorMap[ConsoleColor::Reset];
-#endif
+        WriteText(text.c_str(), color, false);
     }
 
     void Debug::WriteLog(const std::string &text)
+    {
+        WriteMessage(text.c_str(), ConsoleMessageType::Log);
+    }
+
+    void Debug::WriteError(const std::string &text)
+    {
+        WriteMessage(text.c_str(), ConsoleMessageType::Error);
+    }
+
+    bool Debug::IsLoggingEnabled()
     {
 #ifdef GFX_DEBUG_LOGGING
-#ifdef _WIN32
-        std::cout << text << '\n';
+        return true;
 #else
-        std::cout << text << '\n';
+        return false;
 #endif
+    }
 
-        if (callback)
-            callback(text, ConsoleMessageType::Log);
+    void Debug::WriteText(const char *text, ConsoleColor color, bool newLine)
+    {
+#ifdef _WIN32
+        std::cout << text;
+#else
+        std::cout << consoleColorMap[color] << text << consoleColorMap[ConsoleColor::Reset];
 #endif
+        if(newLine)
+            std::cout << '\n';
     }
 
-    void Debug::WriteError(const std::string &text)
+    void Debug::WriteMessage(const char *text, ConsoleMessageType type)
     {
 #ifdef GFX_DEBUG_LOGGING
 #ifdef _WIN32
         std::cout << text << '\n';
 #else
-        std::cout << text << consoleColorMap[ConsoleColor::Reset] << '\n';
+        if(type == ConsoleMessageType::Error)
+            std::cout << text << consoleColorMap[ConsoleColor::Reset] << '\n';
+        else
+            std::cout << text << '\n';
 #endif
 
         if (callback)
-            callback(text, ConsoleMessageType::Error);
+            callback(text, type);
 #endif
     }
 
@@ -28,9 +28,13 @@ namespace GFX
         if(!isControllable)
             return;
 
-        inputVertical = Input::GetAxis("Vertical");
-        inputHorizontal = Input::GetAxis("Horizontal");
-        inputPanning = Input::GetAxis("Panning");
+        static const StringId axisVertical("Vertical");
+        static const StringId axisHorizontal("Horizontal");
+        static const StringId axisPanning("Panning");
+
+        inputVertical = Input::GetAxis(axisVertical);
+        inputHorizontal = Input::GetAxis(axisHorizontal);
+        inputPanning = Input::GetAxis(axisPanning);
         inputZoom = Input::GetScrollDirection().y;
     }
 
@@ -3,11 +3,20 @@
 #include "Application.hpp"
 #include "Time.hpp"
 #include "../Physics/Physics.hpp"
+#include "../System/JobSystem.hpp"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 
 namespace GFX
 {
+    static constexpr uint32_t INVALID_BEHAVIOUR_INDEX = 0xFFFFFFFF;
+
     GameBehaviour::GameBehaviour() : Component()
     {
+        orderIndex = INVALID_BEHAVIOUR_INDEX;
+        groupIndex = INVALID_BEHAVIOUR_INDEX;
+        groupSlot = INVALID_BEHAVIOUR_INDEX;
         GameBehaviour::AddBehaviour(this);
     }
 
@@ -61,40 +70,252 @@ namespace GFX
 
     }
 
+    struct BehaviourTask
+    {
+        BehaviourGroup *group;
+        size_t first;
+        size_t last;
+    };
+
+    static std::unordered_map<std::type_index, uint32_t> groupMap;
+    static std::vector<BehaviourTask> tasks;
+    static std::mutex behaviourMutex;
+
+    BehaviourAccess::BehaviourAccess()
+    {
+        isDeclared = false;
+        isParallel = false;
+        reads = 0;
+        writes = 0;
+    }
+
+    BehaviourAccess BehaviourAccess::Exclusive()
+    {
+        return BehaviourAccess();
+    }
+
+    BehaviourAccess BehaviourAccess::Declared()
+    {
+        BehaviourAccess access;
+        access.isDeclared = true;
+        return access;
+    }
+
+    BehaviourAccess BehaviourAccess::Parallel()
+    {
+        BehaviourAccess access;
+        access.isDeclared = true;
+        access.isParallel = true;
+        return access;
+    }
+
+    bool BehaviourAccess::ConflictsWith(const BehaviourAccess &other) const
+    {
+        if(!isDeclared || !other.isDeclared)
+            return true;
+        return (writes & (other.reads | other.writes)) != 0 || (other.writes & reads) != 0;
+    }
+
+    BehaviourGroup::BehaviourGroup(std::type_index type, const BehaviourAccess &access) : type(type), access(access)
+    {
+        wave = 0;
+    }
+
     std::vector<GameBehaviour*> GameBehaviour::behaviours;
+    std::vector<GameBehaviour*> GameBehaviour::pendingBehaviours;
+    std::vector<BehaviourGroup> GameBehaviour::groups;
+    size_t GameBehaviour::removedCount = 0;
+    uint32_t GameBehaviour::waveCount = 0;
+    bool GameBehaviour::parallelUpdate = false;
+
+    BehaviourAccess GameBehaviour::GetAccess() const
+    {
+        return BehaviourAccess::Exclusive();
+    }
 
     void GameBehaviour::AddBehaviour(GameBehaviour *behaviour)
     {
-        for(size_t i = 0; i < behaviours.size(); i++)
-        {
-            if(behaviours[i] == behaviour)
-                return;
-        }
+        std::lock_guard<std::mutex> lock(behaviourMutex);
 
+        if(behaviour->orderIndex != INVALID_BEHAVIOUR_INDEX)
+            return;
+
+        //The concrete type is not known until construction has finished, grouping happens at the start of the next phase
+        behaviour->orderIndex = static_cast<uint32_t>(behaviours.size());
+        behaviour->groupIndex = INVALID_BEHAVIOUR_INDEX;
+        behaviour->groupSlot = static_cast<uint32_t>(pendingBehaviours.size());
         behaviours.push_back(behaviour);
+        pendingBehaviours.push_back(behaviour);
     }
 
     void GameBehaviour::RemoveBehaviour(GameBehaviour *behaviour)
     {
-        bool found = false;
-        size_t index = 0;
+        std::lock_guard<std::mutex> lock(behaviourMutex);
+
+        if(behaviour->orderIndex == INVALID_BEHAVIOUR_INDEX)
+            return;
+
+        //Leave a hole so loops that are running keep their position, holes are compacted before the next phase
+        behaviours[behaviour->orderIndex] = nullptr;
+        removedCount++;
+
+        std::vector<GameBehaviour*> &list = behaviour->groupIndex == INVALID_BEHAVIOUR_INDEX ? pendingBehaviours : groups[behaviour->groupIndex].behaviours;
+        GameBehaviour *last = list.back();
+        list[behaviour->groupSlot] = last;
+        last->groupSlot = behaviour->groupSlot;
+        list.pop_back();
+
+        behaviour->orderIndex = INVALID_BEHAVIOUR_INDEX;
+        behaviour->groupIndex = INVALID_BEHAVIOUR_INDEX;
+        behaviour->groupSlot = INVALID_BEHAVIOUR_INDEX;
+    }
+
+    void GameBehaviour::ResolvePendingBehaviours()
+    {
+        std::lock_guard<std::mutex> lock(behaviourMutex);
+
+        for(size_t i = 0; i < pendingBehaviours.size(); i++)
+        {
+            GameBehaviour *behaviour = pendingBehaviours[i];
+            std::type_index type(typeid(*behaviour));
+            auto it = groupMap.find(type);
+            uint32_t index;
+
+            if(it != groupMap.end())
+            {
+                index = it->second;
+            }
+            else
+            {
+                index = static_cast<uint32_t>(groups.size());
+                groups.emplace_back(type, behaviour->GetAccess());
+                groupMap[type] = index;
+
+                //Conflicting groups keep their creation order by running in a later wave
+                BehaviourGroup &group = groups.back();
+
+                for(size_t j = 0; j < index; j++)
+                {
+                    if(group.access.ConflictsWith(groups[j].access))
+                        group.wave = std::max(group.wave, groups[j].wave + 1);
+                }
+
+                waveCount = std::max(waveCount, group.wave + 1);
+            }
+
+            behaviour->groupIndex = index;
+            behaviour->groupSlot = static_cast<uint32_t>(groups[index].behaviours.size());
+            groups[index].behaviours.push_back(behaviour);
+        }
+
+        pendingBehaviours.clear();
+    }
+
+    void GameBehaviour::CompactBehaviours()
+    {
+        std::lock_guard<std::mutex> lock(behaviourMutex);
+
+        if(removedCount == 0)
+            return;
+
+        size_t count = 0;
 
         for(size_t i = 0; i < behaviours.size(); i++)
         {
-            if(behaviours[i] == behaviour)
+            if(!behaviours[i])
+                continue;
+            behaviours[i]->orderIndex = static_cast<uint32_t>(count);
+            behaviours[count++] = behaviours[i];
+        }
+
+        behaviours.resize(count);
+        removedCount = 0;
+    }
+
+    void GameBehaviour::RunPhase(void (GameBehaviour::*method)())
+    {
+        ResolvePendingBehaviours();
+        CompactBehaviours();
+
+        if(!parallelUpdate)
+        {
+            size_t count = behaviours.size();
+
+            for(size_t i = 0; i < count; i++)
             {
-                index = i;
-                found = true;
-                break;
+                GameBehaviour *behaviour = behaviours[i];
+                if(behaviour && behaviour->GetGameObject()->GetIsActive())
+                    (behaviour->*method)();
             }
+            return;
         }
 
-        if(found)
+        uint32_t threadCount = JobSystem::GetWorkerCount() + 1;
+
+        auto runTask = [method] (size_t index) {
+            const BehaviourTask &task = tasks[index];
+            for(size_t i = task.first; i < task.last; i++)
+            {
+                GameBehaviour *behaviour = task.group->behaviours[i];
+                if(behaviour->GetGameObject()->GetIsActive())
+                    (behaviour->*method)();
+            }
+        };
+
+        for(uint32_t wave = 0; wave < waveCount; wave++)
         {
-            behaviours.erase(behaviours.begin() + index);
+            tasks.clear();
+
+            for(size_t i = 0; i < groups.size(); i++)
+            {
+                BehaviourGroup &group = groups[i];
+                size_t count = group.behaviours.size();
+
+                if(group.wave != wave || count == 0)
+                    continue;
+
+                //Exclusive groups are alone in their wave and stay on the calling thread
+                if(!group.access.isDeclared)
+                {
+                    BehaviourTask task = { &group, 0, count };
+                    tasks.push_back(task);
+                    break;
+                }
+
+                size_t taskSize = group.access.isParallel ? std::max<size_t>(1, count / (threadCount * 4)) : count;
+
+                for(size_t first = 0; first < count; first += taskSize)
+                {
+                    BehaviourTask task = { &group, first, std::min(first + taskSize, count) };
+                    tasks.push_back(task);
+                }
+            }
+
+            if(tasks.size() == 1 || threadCount == 1)
+            {
+                for(size_t i = 0; i < tasks.size(); i++)
+                    runTask(i);
+            }
+            else
+            {
+                JobSystem::ParallelForRange(tasks.size(), 1, [&runTask] (size_t first, size_t last) {
+                    for(size_t i = first; i < last; i++)
+                        runTask(i);
+                });
+            }
         }
     }
 
+    void GameBehaviour::SetParallelUpdate(bool enabled)
+    {
+        parallelUpdate = enabled;
+    }
+
+    bool GameBehaviour::GetParallelUpdate()
+    {
+        return parallelUpdate;
+    }
+
 	void GameBehaviour::NewFrame()
 	{
 		OnBehaviourUpdate();
@@ -109,49 +330,69 @@ namespace GFX
 
     void GameBehaviour::OnBehaviourResourceLoadedAsync(const Resource &info)
     {
-        for(size_t i = 0; i < behaviours.size(); i++)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            behaviours[i]->OnResourceLoadedAsync(info);
+            if(behaviours[i])
+                behaviours[i]->OnResourceLoadedAsync(info);
         }
     }
 
     void GameBehaviour::OnBehaviourResourceBatchLoadedAsync(const ResourceBatch &resourceBatch)
     {
-        for(size_t i = 0; i < behaviours.size(); i++)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            behaviours[i]->OnResourceBatchLoadedAsync(resourceBatch);
+            if(behaviours[i])
+                behaviours[i]->OnResourceBatchLoadedAsync(resourceBatch);
         }
     }
 
     void GameBehaviour::OnBehaviourApplicationQuit()
     {
-        for(auto behaviour : behaviours)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            if(behaviour->GetGameObject()->GetIsActive())
+            GameBehaviour *behaviour = behaviours[i];
+            if(behaviour && behaviour->GetGameObject()->GetIsActive())
                 behaviour->OnApplicationQuit();
         }
 
-        behaviours.clear();
+        {
+            std::lock_guard<std::mutex> lock(behaviourMutex);
+
+            //Forget the registrations so the destructors below don't have to unregister one by one
+            for(size_t i = 0; i < behaviours.size(); i++)
+            {
+                if(!behaviours[i])
+                    continue;
+                behaviours[i]->orderIndex = INVALID_BEHAVIOUR_INDEX;
+                behaviours[i]->groupIndex = INVALID_BEHAVIOUR_INDEX;
+                behaviours[i]->groupSlot = INVALID_BEHAVIOUR_INDEX;
+            }
+
+            behaviours.clear();
+            pendingBehaviours.clear();
+            groups.clear();
+            groupMap.clear();
+            removedCount = 0;
+            waveCount = 0;
+        }
 
         GameObject::DestroyAll();
     }
 
     void GameBehaviour::OnBehaviourUpdate()
     {
-        for(auto behaviour : behaviours)
-        {
-            if(behaviour->GetGameObject()->GetIsActive())
-                behaviour->OnUpdate();
-        }
+        RunPhase(&GameBehaviour::OnUpdate);
     }
 
     void GameBehaviour::OnBehaviourLateUpdate()
     {
-        for(auto behaviour : behaviours)
-        {
-            if(behaviour->GetGameObject()->GetIsActive())
-                behaviour->OnLateUpdate();
-        }
+        RunPhase(&GameBehaviour::OnLateUpdate);
     }
 
     static float accumulator = 0.0f;
@@ -164,11 +405,7 @@ namespace GFX
 
         //while(accumulator >= fixedTimeStep)
         {
-            for(auto behaviour : behaviours)
-            {
-                if(behaviour->GetGameObject()->GetIsActive())
-                    behaviour->OnFixedUpdate();
-            }
+            RunPhase(&GameBehaviour::OnFixedUpdate);
             
             accumulator -= fixedTimeStep;
 
@@ -178,27 +415,36 @@ namespace GFX
 
     void GameBehaviour::OnBehaviourGUI()
     {
-        for(auto behaviour : behaviours)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            if(behaviour->GetGameObject()->GetIsActive())
+            GameBehaviour *behaviour = behaviours[i];
+            if(behaviour && behaviour->GetGameObject()->GetIsActive())
                 behaviour->OnGUI();
         }
     }
 
     void GameBehaviour::OnBehaviourPostProcess(uint32_t shaderId)
     {
-        for(auto behaviour : behaviours)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            if(behaviour->GetGameObject()->GetIsActive())
+            GameBehaviour *behaviour = behaviours[i];
+            if(behaviour && behaviour->GetGameObject()->GetIsActive())
                 behaviour->OnPostProcess(shaderId);
         }
     }
 
     void GameBehaviour::OnBehaviourEndFrame()
     {
-        for(auto behaviour : behaviours)
+        size_t count = behaviours.size();
+
+        for(size_t i = 0; i < count; i++)
         {
-            if(behaviour->GetGameObject()->GetIsActive())
+            GameBehaviour *behaviour = behaviours[i];
+            if(behaviour && behaviour->GetGameObject()->GetIsActive())
                 behaviour->OnEndFrame();
         }
 
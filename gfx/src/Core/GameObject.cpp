@@ -1,6 +1,7 @@
 #include "GameObject.hpp"
 #include "Resources.hpp"
 #include "Constants.hpp"
+#include "Debug.hpp"
 #include "../Graphics/Mesh.hpp"
 #include "../Graphics/Texture2D.hpp"
 #include "../Graphics/Materials/DiffuseMaterial.hpp"
@@ -11,26 +12,91 @@
 #include "../Graphics/Renderers/MeshRenderer.hpp"
 #include "../Graphics/Renderers/ParticleSystem.hpp"
 #include "../Graphics/Renderers/Terrain.hpp"
+#include "../System/FrameArena.hpp"
+#include "../System/SlabAllocator.hpp"
+#include <new>
 
 namespace GFX
 {
-    std::vector<std::unique_ptr<GameObject>> GameObject::objects;
-    std::vector<GameObject*> GameObject::destroyQueue;
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    std::vector<GameObject*> GameObject::objects;
+    std::vector<GameObjectSlot> GameObject::slots;
+    std::vector<uint32_t> GameObject::freeSlots;
+    std::vector<GameObjectHandle> GameObject::destroyQueue;
+    GameObjectLookup GameObject::nameLookup;
+    GameObjectLookup GameObject::tagLookup;
+
+    static SlabAllocator *GetGameObjectAllocator()
+    {
+        //Never destroyed, objects can still be released during static destruction
+        static SlabAllocator *allocator = new SlabAllocator(sizeof(GameObject), 1024);
+        return allocator;
+    }
+
+    GameObjectHandle::GameObjectHandle()
+    {
+        index = INVALID_INDEX;
+        generation = 0;
+    }
+
+    GameObjectHandle::GameObjectHandle(uint32_t index, uint32_t generation)
+    {
+        this->index = index;
+        this->generation = generation;
+    }
+
+    bool GameObjectHandle::operator==(const GameObjectHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool GameObjectHandle::operator!=(const GameObjectHandle &other) const
+    {
+        return !(*this == other);
+    }
 
     GameObject::GameObject() : Object()
     {
         transform.gameObject = this;
         isActive = true;
         layer = Layer_Default;
+        componentMask = 0;
+        objectIndex = INVALID_INDEX;
+        isDestroyed = false;
+        nameLookupIndex = INVALID_INDEX;
+        tagLookupIndex = INVALID_INDEX;
     }
 
     GameObject::~GameObject()
     {
-        for(size_t i = 0; i < components.size(); i++)
+        //Objects released by OnEndFrame already had their components destroyed
+        if(!isDestroyed)
         {
-            components[i]->OnDestroy();
+            for(size_t i = 0; i < components.size(); i++)
+            {
+                components[i]->OnDestroy();
+            }
         }
         components.clear();
+        componentSlots.clear();
+        componentMask = 0;
+        Unregister(this);
+    }
+
+    void *GameObject::operator new(size_t size)
+    {
+        if(size != sizeof(GameObject))
+            return ::operator new(size);
+        return GetGameObjectAllocator()->Allocate();
+    }
+
+    void GameObject::operator delete(void *pointer, size_t size)
+    {
+        if(size != sizeof(GameObject))
+            ::operator delete(pointer);
+        else
+            GetGameObjectAllocator()->Deallocate(pointer);
     }
 
     Transform *GameObject::GetTransform()
@@ -65,6 +131,28 @@ namespace GFX
         }
     }
 
+    void GameObject::AddComponentSlot(uint32_t typeId, size_t index)
+    {
+        if((componentMask & ComponentType::GetMask(typeId)) && FindComponentSlot(typeId) < components.size())
+            return;
+
+        ComponentSlot slot;
+        slot.typeId = typeId;
+        slot.index = static_cast<uint32_t>(index);
+        componentSlots.push_back(slot);
+        componentMask |= ComponentType::GetMask(typeId);
+    }
+
+    size_t GameObject::FindComponentSlot(uint32_t typeId) const
+    {
+        for(size_t i = 0; i < componentSlots.size(); i++)
+        {
+            if(componentSlots[i].typeId == typeId)
+                return componentSlots[i].index;
+        }
+        return components.size();
+    }
+
     bool GameObject::GetIsActive() const
     {
         return isActive;
@@ -90,10 +178,89 @@ namespace GFX
         return layer;
     }
 
+    void GameObject::SetTag(const std::string &tag)
+    {
+        SetTag(StringId(tag));
+    }
+
+    void GameObject::SetTag(StringId tag)
+    {
+        if(this->tag == tag)
+            return;
+
+        if(objectIndex != INVALID_INDEX)
+        {
+            RemoveFromLookup(tagLookup, this->tag, this, &GameObject::tagLookupIndex);
+            AddToLookup(tagLookup, tag, this, &GameObject::tagLookupIndex);
+        }
+
+        this->tag = tag;
+    }
+
+    StringId GameObject::GetTag() const
+    {
+        return tag;
+    }
+
+    bool GameObject::CompareTag(StringId tag) const
+    {
+        return this->tag == tag;
+    }
+
+    void GameObject::OnNameChanged(StringId previousName)
+    {
+        if(objectIndex == INVALID_INDEX)
+            return;
+
+        RemoveFromLookup(nameLookup, previousName, this, &GameObject::nameLookupIndex);
+        AddToLookup(nameLookup, GetNameId(), this, &GameObject::nameLookupIndex);
+    }
+
+    GameObjectHandle GameObject::GetHandle() const
+    {
+        return handle;
+    }
+
+    GameObject *GameObject::Get(const GameObjectHandle &handle)
+    {
+        if(handle.index >= slots.size())
+            return nullptr;
+        const GameObjectSlot &slot = slots[handle.index];
+        if(slot.generation != handle.generation)
+            return nullptr;
+        return slot.object;
+    }
+
+    GameObject *GameObject::Find(const std::string &name)
+    {
+        StringId id;
+        if(!StringId::TryGet(name, id))
+            return nullptr;
+        return Find(id);
+    }
+
+    GameObject *GameObject::Find(StringId name)
+    {
+        return FindInLookup(nameLookup, name);
+    }
+
+    GameObject *GameObject::FindWithTag(const std::string &tag)
+    {
+        StringId id;
+        if(!StringId::TryGet(tag, id))
+            return nullptr;
+        return FindWithTag(id);
+    }
+
+    GameObject *GameObject::FindWithTag(StringId tag)
+    {
+        return FindInLookup(tagLookup, tag);
+    }
+
     GameObject *GameObject::Create()
     {
-        objects.push_back(std::make_unique<GameObject>());
-        GameObject *g = objects.back().get();
+        GameObject *g = new GameObject();
+        Register(g);
         g->SetLayer(Layer_Default);
         return g;
     }
@@ -235,62 +402,130 @@ namespace GFX
         if(!object)
             return;
 
-        destroyQueue.push_back(object);
+        //Only objects made with Create have a handle, others are released by whoever owns them
+        if(object->objectIndex == INVALID_INDEX)
+        {
+            Debug::WriteError("[GAMEOBJECT] can not destroy '%s', it was not made with GameObject::Create", object->GetName().c_str());
+            return;
+        }
+
+        Destroy(object->handle);
     }
 
-    void GameObject::DestroyImmediate(GameObject *object)
+    void GameObject::Destroy(const GameObjectHandle &handle)
     {
-        for(size_t i = 0; i < object->components.size(); i++)
-        {
-            object->components[i]->OnDestroy();
-        }
+        if(!Get(handle))
+            return;
 
-        auto children = object->GetTransform()->GetChildrenRecursive();
+        destroyQueue.push_back(handle);
+    }
 
-        for(size_t i = 0; i < children.size(); i++)
+    void GameObject::Register(GameObject *object)
+    {
+        uint32_t slotIndex;
+
+        if(freeSlots.size() > 0)
         {
-            GameObject *currentObject = children[i]->GetGameObject();
-            for(size_t j = 0; j < currentObject->components.size(); j++)
-            {
-                currentObject->components[j]->OnDestroy();
-            }
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
         }
-
-        for(size_t i = 0; i < children.size(); i++)
+        else
         {
-            RemoveObject(children[i]->GetGameObject());
+            slotIndex = static_cast<uint32_t>(slots.size());
+            GameObjectSlot slot;
+            slot.object = nullptr;
+            slot.generation = 1;
+            slots.push_back(slot);
         }
 
-        RemoveObject(object);
+        slots[slotIndex].object = object;
+        object->handle = GameObjectHandle(slotIndex, slots[slotIndex].generation);
+        object->objectIndex = static_cast<uint32_t>(objects.size());
+        objects.push_back(object);
+
+        AddToLookup(nameLookup, object->GetNameId(), object, &GameObject::nameLookupIndex);
+        AddToLookup(tagLookup, object->tag, object, &GameObject::tagLookupIndex);
     }
 
-    void GameObject::RemoveObject(GameObject *object)
+    void GameObject::Unregister(GameObject *object)
     {
-        if(!object)
+        if(object->objectIndex == INVALID_INDEX)
             return;
-        size_t index = 0;
-        bool found = false;
 
-        for(size_t i = 0; i < objects.size(); i++)
-        {
-            if(object->GetInstanceId() == objects[i]->GetInstanceId())
-            {
-                index = i;
-                found = true;
-                break;
-            }
-        }
+        RemoveFromLookup(nameLookup, object->GetNameId(), object, &GameObject::nameLookupIndex);
+        RemoveFromLookup(tagLookup, object->tag, object, &GameObject::tagLookupIndex);
+
+        //Swap with the last object so removal does not have to search or shift
+        GameObject *last = objects.back();
+        objects[object->objectIndex] = last;
+        last->objectIndex = object->objectIndex;
+        objects.pop_back();
+
+        GameObjectSlot &slot = slots[object->handle.index];
+        slot.object = nullptr;
+        slot.generation++;
+        freeSlots.push_back(object->handle.index);
+
+        object->objectIndex = INVALID_INDEX;
+        object->handle = GameObjectHandle();
+    }
+
+    void GameObject::AddToLookup(GameObjectLookup &lookup, StringId key, GameObject *object, uint32_t GameObject::*lookupIndex)
+    {
+        if(key.IsEmpty())
+            return;
+
+        auto &list = lookup[key.GetId()];
+        object->*lookupIndex = static_cast<uint32_t>(list.size());
+        list.push_back(object);
+    }
+
+    void GameObject::RemoveFromLookup(GameObjectLookup &lookup, StringId key, GameObject *object, uint32_t GameObject::*lookupIndex)
+    {
+        if(key.IsEmpty() || object->*lookupIndex == INVALID_INDEX)
+            return;
 
-        if(found)
+        auto it = lookup.find(key.GetId());
+
+        if(it == lookup.end())
+            return;
+
+        auto &list = it->second;
+        GameObject *last = list.back();
+        list[object->*lookupIndex] = last;
+        last->*lookupIndex = object->*lookupIndex;
+        list.pop_back();
+        object->*lookupIndex = INVALID_INDEX;
+
+        if(list.size() == 0)
+            lookup.erase(it);
+    }
+
+    GameObject *GameObject::FindInLookup(const GameObjectLookup &lookup, StringId key)
+    {
+        auto it = lookup.find(key.GetId());
+
+        if(it == lookup.end())
+            return nullptr;
+
+        //Objects waiting for the end of the frame to be released no longer count
+        for(size_t i = 0; i < it->second.size(); i++)
         {
-            object->GetTransform()->SetParent(nullptr);
-            objects.erase(objects.begin() + index);
+            if(!it->second[i]->isDestroyed)
+                return it->second[i];
         }
+
+        return nullptr;
     }
 
     void GameObject::DestroyAll()
     {
-        objects.clear();
+        destroyQueue.clear();
+
+        while(objects.size() > 0)
+        {
+            delete objects.back();
+        }
     }
 
     void GameObject::OnEndFrame()
@@ -298,16 +533,78 @@ namespace GFX
         if(destroyQueue.size() == 0)
             return;
 
-        for(size_t i = 0; i < destroyQueue.size(); i++)
+        //Objects destroyed from within OnDestroy are handled next frame
+        FrameVector<GameObjectHandle> queue(destroyQueue.begin(), destroyQueue.end());
+        destroyQueue.clear();
+
+        //Every object is collected once, also when both a parent and its child were queued
+        FrameVector<GameObject*> batch;
+        FrameVector<GameObject*> stack;
+        FrameVector<GameObject*> unregistered; //Children that are owned elsewhere, they are only cut loose
+
+        for(size_t i = 0; i < queue.size(); i++)
         {
-            GameObject *object = destroyQueue[i];
+            //Objects queued again while they were being destroyed are already gone
+            GameObject *queued = Get(queue[i]);
 
-            if(!object)
+            if(!queued || queued->isDestroyed)
                 continue;
 
-            DestroyImmediate(object);
+            queued->isDestroyed = true;
+            stack.push_back(queued);
+
+            while(stack.size() > 0)
+            {
+                GameObject *object = stack.back();
+                stack.pop_back();
+                batch.push_back(object);
+
+                auto &children = object->transform.GetChildren();
+
+                for(size_t j = 0; j < children.size(); j++)
+                {
+                    GameObject *child = children[j]->GetGameObject();
+
+                    if(child->isDestroyed)
+                        continue;
+
+                    if(child->objectIndex == INVALID_INDEX)
+                    {
+                        unregistered.push_back(child);
+                        continue;
+                    }
+
+                    child->isDestroyed = true;
+                    stack.push_back(child);
+                }
+            }
         }
 
-        destroyQueue.clear();
+        //Components remove themselves from their subsystems before anything is released
+        for(size_t i = 0; i < batch.size(); i++)
+        {
+            GameObject *object = batch[i];
+
+            for(size_t j = 0; j < object->components.size(); j++)
+            {
+                object->components[j]->OnDestroy();
+            }
+        }
+
+        //Links between two released objects go away with them, everything else has to be cut first
+        for(size_t i = 0; i < unregistered.size(); i++)
+            unregistered[i]->transform.SetParent(nullptr);
+
+        for(size_t i = 0; i < batch.size(); i++)
+        {
+            GameObject *object = batch[i];
+            Transform *parent = object->transform.GetParent();
+
+            if(parent && !parent->GetGameObject()->isDestroyed)
+                object->transform.SetParent(nullptr);
+        }
+
+        for(size_t i = 0; i < batch.size(); i++)
+            delete batch[i];
     }
 }
\ No newline at end of file
@@ -22,7 +22,7 @@ namespace GFX
 
     AxisInfo::AxisInfo(const std::string &name)
     {
-        this->name = name;
+        this->name = StringId(name);
     }
 
     void AxisInfo::AddKeys(KeyCode positive, KeyCode negative)
@@ -32,7 +32,7 @@ namespace GFX
 
 	Keyboard Input::keyboard;
 	Mouse Input::mouse;
-	std::unordered_map<std::string, AxisInfo> Input::keyToAxisMap;
+	std::unordered_map<StringId, AxisInfo, StringIdHash> Input::keyToAxisMap;
 
 	void Input::Initialize()
 	{
@@ -104,13 +104,25 @@ namespace GFX
 
     float Input::GetAxis(const std::string &axis)
     {
-        if (keyToAxisMap.count(axis) > 0)
+        StringId id;
+        if(!StringId::TryGet(axis, id))
+            return 0.0f;
+        return GetAxis(id);
+    }
+
+    float Input::GetAxis(StringId axis)
+    {
+        auto it = keyToAxisMap.find(axis);
+
+        if (it != keyToAxisMap.end())
         {
-            for (size_t i = 0; i < keyToAxisMap[axis].keys.size(); i++)
+            const auto &keys = it->second.keys;
+
+            for (size_t i = 0; i < keys.size(); i++)
             {
-                if (GetKey(keyToAxisMap[axis].keys[i].positive))
+                if (GetKey(keys[i].positive))
                     return 1.0f;
-                else if (GetKey(keyToAxisMap[axis].keys[i].negative))
+                else if (GetKey(keys[i].negative))
                     return -1.0f;
             }
         }
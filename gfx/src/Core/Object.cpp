@@ -20,11 +20,30 @@ namespace GFX
 
     void Object::SetName(const std::string name)
     {
+        SetName(StringId(name));
+    }
+
+    void Object::SetName(StringId name)
+    {
+        if(this->name == name)
+            return;
+        StringId previousName = this->name;
         this->name = name;
+        OnNameChanged(previousName);
     }
 
     std::string Object::GetName() const
+    {
+        return name.GetString();
+    }
+
+    StringId Object::GetNameId() const
     {
         return name;
     }
+
+    void Object::OnNameChanged([[maybe_unused]] StringId previousName)
+    {
+
+    }
 }
\ No newline at end of file
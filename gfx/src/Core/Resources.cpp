@@ -4,7 +4,8 @@
 #include "GameBehaviour.hpp"
 #include "../System/IO/File.hpp"
 #include "../Graphics/Image.hpp"
-#include <future>
+#include "../System/JobSystem.hpp"
+#include "../System/MemoryTracker.hpp"
 
 namespace GFX
 {
@@ -18,6 +19,15 @@ namespace GFX
 	std::unordered_map<std::string,TextureCubeMap> Resources::texturesCubemap;
 	std::unordered_map<std::string,Mesh> Resources::meshes;
 
+	//Loaded data counts as resource memory while it waits in a queue for the main thread
+	static size_t GetPayloadSize(const ResourceBatch &batch)
+	{
+		size_t size = 0;
+		for(size_t i = 0; i < batch.resources.size(); i++)
+			size += batch.resources[i].data.size();
+		return size;
+	}
+
 	static void LogAdd(const std::string &type, const std::string &name)
 	{
 		Debug::WriteLine("[" + type + "] " + name + " successfully added");
@@ -163,25 +173,30 @@ namespace GFX
 
 	void Resources::LoadAsyncFromFile(ResourceType type, const std::string &resource)
 	{
-		auto result = std::async(std::launch::async, &GetFromFileAsync, type, resource);
+		JobSystem::Schedule([=] () {
+			GetFromFileAsync(type, resource);
+		}, nullptr, JobPriority::Low);
 	}
 
 	void Resources::LoadAsyncBatchFromFile(ResourceType type, const std::vector<std::string> &resources)
 	{
-		//auto result = std::async(std::launch::async, &GetBatchFromFileAsync, type, resources);
-		std::thread([=]() {
+		JobSystem::Schedule([=] () {
 			GetBatchFromFileAsync(type, resources);
-		}).detach();
+		}, nullptr, JobPriority::Low);
 	}
 
 	void Resources::LoadAsyncFromAssetPack(ResourceType type, const std::string &resource, const std::string &pathToAssetPack, const std::string &assetPackKey)
 	{
-		auto result = std::async(std::launch::async, &GetFromPackAsync, type, resource, pathToAssetPack, assetPackKey);
+		JobSystem::Schedule([=] () {
+			GetFromPackAsync(type, resource, pathToAssetPack, assetPackKey);
+		}, nullptr, JobPriority::Low);
 	}
 
 	void Resources::LoadAsyncBatchFromAssetPack(ResourceType type, const std::vector<std::string> &resources, const std::string &pathToAssetPack, const std::string &assetPackKey)
 	{
-		auto result = std::async(std::launch::async, &GetBatchFromPackAsync, type, resources, pathToAssetPack, assetPackKey);
+		JobSystem::Schedule([=] () {
+			GetBatchFromPackAsync(type, resources, pathToAssetPack, assetPackKey);
+		}, nullptr, JobPriority::Low);
 	}
 
 	void Resources::GetFromFileAsync(ResourceType type, const std::string &resource)
@@ -200,6 +215,7 @@ namespace GFX
 			info.result = ResourceLoadResult::Error;
 		}
 
+		MemoryTracker::Add(MemoryTag::Resources, info.data.size());
 		resourceQueue.Enqueue(info);
 	}
 
@@ -248,6 +264,7 @@ namespace GFX
 			batch.resources.push_back(info);
 		}
 		
+		MemoryTracker::Add(MemoryTag::Resources, GetPayloadSize(batch));
 		resourceBatchQueue.Enqueue(batch);
 	}
 
@@ -277,6 +294,7 @@ namespace GFX
 				info.result = ResourceLoadResult::Error;
 			}
 
+			MemoryTracker::Add(MemoryTag::Resources, info.data.size());
 			resourceQueue.Enqueue(info);
 		}
 	}
@@ -315,6 +333,7 @@ namespace GFX
 				batch.resources.push_back(info);
 			}
 			
+			MemoryTracker::Add(MemoryTag::Resources, GetPayloadSize(batch));
 			resourceBatchQueue.Enqueue(batch);
 		}
 		else
@@ -331,6 +350,7 @@ namespace GFX
             //Do only 1 asset per frame or this might block the main thread for a while
             if(resourceQueue.TryDequeue(resource))
             {
+                MemoryTracker::Remove(MemoryTag::Resources, resource.data.size());
                 GameBehaviour::OnBehaviourResourceLoadedAsync(resource);
             }
         }
@@ -341,6 +361,7 @@ namespace GFX
             //Do only 1 batch per frame or this might block the main thread for a while
             if(resourceBatchQueue.TryDequeue(batch))
             {
+                MemoryTracker::Remove(MemoryTag::Resources, GetPayloadSize(batch));
                 GameBehaviour::OnBehaviourResourceBatchLoadedAsync(batch);
             }
         }
@@ -0,0 +1,808 @@
+#include "SceneSerializer.hpp"
+#include "Debug.hpp"
+#include "Resources.hpp"
+#include "Light.hpp"
+#include "Camera.hpp"
+#include "../Graphics/Mesh.hpp"
+#include "../Graphics/Texture2D.hpp"
+#include "../Graphics/Materials/DiffuseMaterial.hpp"
+#include "../Graphics/Renderers/MeshRenderer.hpp"
+#include "../System/Hash.hpp"
+#include "../System/IO/File.hpp"
+#include "../System/IO/MemoryMappedFile.hpp"
+#include <filesystem>
+
+namespace GFX
+{
+    static constexpr uint8_t SCENE_IDENTIFIER[8] = { 'G', 'F', 'X', 'S', 'C', 'E', 'N', 'E' };
+    static constexpr uint32_t SCENE_ENDIANNESS = 0x04030201;
+    static constexpr size_t SCENE_ALIGNMENT = 16;
+    static constexpr uint32_t INVALID_RESOURCE_INDEX = 0xFFFFFFFF;
+    static constexpr uint32_t INVALID_SERIALIZER_INDEX = 0xFFFFFFFF;
+
+    struct SceneLightData
+    {
+        int32_t type;
+        float color[4];
+        float ambient[4];
+        float diffuse[4];
+        float specular[4];
+        float strength;
+        float constant;
+        float linear;
+        float quadratic;
+        float cutoff;
+    };
+
+    struct SceneCameraData
+    {
+        float fieldOfView;
+        float nearClippingPlane;
+        float farClippingPlane;
+        float clearColor[4];
+    };
+
+    struct SceneMeshRendererData
+    {
+        uint32_t count;
+        uint32_t castShadows;
+        uint32_t receiveShadows;
+        uint32_t isStatic;
+        uint32_t renderOrder;
+    };
+
+    struct SceneMeshRendererEntry
+    {
+        uint32_t mesh;
+        uint32_t diffuseTexture;
+        uint8_t wireframe;
+        uint8_t depthTest;
+        uint8_t cullFace;
+        uint8_t alphaBlend;
+        uint32_t depthFunc;
+        float diffuseColor[4];
+        float ambientStrength;
+        float shininess;
+        float uvScale[2];
+        float uvOffset[2];
+        uint32_t receiveShadows;
+    };
+
+    std::vector<SceneSerializer::ComponentSerializer> SceneSerializer::serializers;
+    std::vector<uint32_t> SceneSerializer::serializerIndices;
+    std::unordered_map<uint64_t,uint32_t> SceneSerializer::serializerMap;
+    SceneResourceResolver SceneSerializer::resourceResolver;
+
+    static bool builtInComponentsRegistered = false;
+
+    static void CopyColor(const Color &color, float *destination)
+    {
+        destination[0] = color.r;
+        destination[1] = color.g;
+        destination[2] = color.b;
+        destination[3] = color.a;
+    }
+
+    static Color ToColor(const float *source)
+    {
+        return Color(source[0], source[1], source[2], source[3]);
+    }
+
+    static size_t AlignOffset(size_t offset)
+    {
+        return (offset + SCENE_ALIGNMENT - 1) & ~(SCENE_ALIGNMENT - 1);
+    }
+
+    static void WriteAlignment(std::vector<uint8_t> &data)
+    {
+        data.resize(AlignOffset(data.size()), 0);
+    }
+
+    static size_t WriteSection(std::vector<uint8_t> &data, const void *bytes, size_t size)
+    {
+        WriteAlignment(data);
+        size_t offset = data.size();
+        const uint8_t *pBytes = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), pBytes, pBytes + size);
+        return offset;
+    }
+
+    //Checks that count elements at offset lie inside the file without overflowing
+    static bool IsValidRange(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t size)
+    {
+        if(offset > size || (offset % SCENE_ALIGNMENT) != 0)
+            return false;
+        if(elementSize > 0 && count > (size - offset) / elementSize)
+            return false;
+        return true;
+    }
+
+    SceneWriter::SceneWriter()
+    {
+        data = nullptr;
+        resources = nullptr;
+        resourceMap = nullptr;
+        strings = nullptr;
+    }
+
+    void SceneWriter::Write(const void *bytes, size_t size)
+    {
+        const uint8_t *pBytes = static_cast<const uint8_t*>(bytes);
+        data->insert(data->end(), pBytes, pBytes + size);
+    }
+
+    uint32_t SceneWriter::AddResource(SceneResourceType type, const std::string &name, uint64_t contentHash)
+    {
+        uint64_t key = Hash::Combine(contentHash, static_cast<uint64_t>(type));
+        auto it = resourceMap->find(key);
+
+        if(it != resourceMap->end())
+            return it->second;
+
+        SceneResourceRecord record;
+        record.type = static_cast<uint32_t>(type);
+        record.nameOffset = static_cast<uint32_t>(strings->size());
+        record.nameLength = static_cast<uint32_t>(name.size());
+        record.padding = 0;
+        record.contentHash = contentHash;
+        strings->append(name);
+
+        uint32_t index = static_cast<uint32_t>(resources->size());
+        resources->push_back(record);
+        (*resourceMap)[key] = index;
+        return index;
+    }
+
+    uint32_t SceneWriter::AddMesh(Mesh *mesh)
+    {
+        if(!mesh)
+            return INVALID_RESOURCE_INDEX;
+        return AddResource(SceneResourceType::Mesh, mesh->GetName(), SceneSerializer::GetContentHash(mesh));
+    }
+
+    uint32_t SceneWriter::AddTexture2D(Texture2D *texture)
+    {
+        if(!texture)
+            return INVALID_RESOURCE_INDEX;
+
+        std::string name;
+
+        if(!SceneSerializer::FindResourceName(texture, name))
+            return INVALID_RESOURCE_INDEX;
+
+        return AddResource(SceneResourceType::Texture2D, name, SceneSerializer::GetContentHash(texture, name));
+    }
+
+    SceneReader::SceneReader()
+    {
+        data = nullptr;
+        size = 0;
+        offset = 0;
+        resources = nullptr;
+        resourceRecords = nullptr;
+        resourceCount = 0;
+    }
+
+    bool SceneReader::Read(void *bytes, size_t size)
+    {
+        if(size > this->size - offset)
+            return false;
+
+        memcpy(bytes, data + offset, size);
+        offset += size;
+        return true;
+    }
+
+    const uint8_t *SceneReader::GetData() const
+    {
+        return data;
+    }
+
+    size_t SceneReader::GetSize() const
+    {
+        return size;
+    }
+
+    Mesh *SceneReader::GetMesh(uint32_t resourceIndex) const
+    {
+        if(resourceIndex >= resourceCount || resourceRecords[resourceIndex].type != static_cast<uint32_t>(SceneResourceType::Mesh))
+            return nullptr;
+        return static_cast<Mesh*>((*resources)[resourceIndex]);
+    }
+
+    Texture2D *SceneReader::GetTexture2D(uint32_t resourceIndex) const
+    {
+        if(resourceIndex >= resourceCount || resourceRecords[resourceIndex].type != static_cast<uint32_t>(SceneResourceType::Texture2D))
+            return nullptr;
+        return static_cast<Texture2D*>((*resources)[resourceIndex]);
+    }
+
+    void SceneSerializer::AddSerializer(uint32_t typeId, ComponentSerializer &&serializer)
+    {
+        if(!builtInComponentsRegistered)
+            RegisterBuiltInComponents();
+
+        serializer.typeHash = Hash::FNV1a64(serializer.name);
+
+        if(typeId >= serializerIndices.size())
+            serializerIndices.resize(typeId + 1, INVALID_SERIALIZER_INDEX);
+
+        //Registering a type again replaces the previous functions
+        uint32_t index = serializerIndices[typeId];
+
+        if(index == INVALID_SERIALIZER_INDEX)
+        {
+            index = static_cast<uint32_t>(serializers.size());
+            serializers.push_back(std::move(serializer));
+        }
+        else
+        {
+            serializerMap.erase(serializers[index].typeHash);
+            serializers[index] = std::move(serializer);
+        }
+
+        serializerIndices[typeId] = index;
+        serializerMap[serializers[index].typeHash] = index;
+    }
+
+    void SceneSerializer::RegisterBuiltInComponents()
+    {
+        builtInComponentsRegistered = true;
+
+        RegisterComponent<Light>("Light", [] (const Light *light, SceneWriter &writer) {
+            SceneLightData data;
+            data.type = static_cast<int32_t>(light->GetType());
+            CopyColor(light->GetColor(), data.color);
+            CopyColor(light->GetAmbient(), data.ambient);
+            CopyColor(light->GetDiffuse(), data.diffuse);
+            CopyColor(light->GetSpecular(), data.specular);
+            data.strength = light->GetStrength();
+            data.constant = light->GetConstant();
+            data.linear = light->GetLinear();
+            data.quadratic = light->GetQuadratic();
+            data.cutoff = light->GetCutoff();
+            writer.Write(data);
+            return true;
+        }, [] (Light *light, SceneReader &reader) {
+            SceneLightData data;
+            if(!reader.Read(data))
+                return;
+            light->SetType(static_cast<LightType>(data.type));
+            light->SetColor(ToColor(data.color));
+            light->SetAmbient(ToColor(data.ambient));
+            light->SetDiffuse(ToColor(data.diffuse));
+            light->SetSpecular(ToColor(data.specular));
+            light->SetStrength(data.strength);
+            light->SetConstant(data.constant);
+            light->SetLinear(data.linear);
+            light->SetQuadratic(data.quadratic);
+            light->SetCutoff(data.cutoff);
+        });
+
+        RegisterComponent<Camera>("Camera", [] (const Camera *camera, SceneWriter &writer) {
+            SceneCameraData data;
+            data.fieldOfView = camera->GetFieldOfView();
+            data.nearClippingPlane = camera->GetNearClippingPlane();
+            data.farClippingPlane = camera->GetFarClippingPlane();
+            CopyColor(camera->GetClearColor(), data.clearColor);
+            writer.Write(data);
+            return true;
+        }, [] (Camera *camera, SceneReader &reader) {
+            SceneCameraData data;
+            if(!reader.Read(data))
+                return;
+            camera->SetFieldOfView(data.fieldOfView);
+            camera->SetNearClippingPlane(data.nearClippingPlane);
+            camera->SetFarClippingPlane(data.farClippingPlane);
+            camera->SetClearColor(ToColor(data.clearColor));
+        });
+
+        //Only diffuse materials are stored, other materials come back as a default DiffuseMaterial
+        RegisterComponent<MeshRenderer>("MeshRenderer", [] (const MeshRenderer *renderer, SceneWriter &writer) {
+            MeshRenderer *target = const_cast<MeshRenderer*>(renderer);
+
+            SceneMeshRendererData data;
+            data.count = static_cast<uint32_t>(renderer->GetCount());
+            data.castShadows = renderer->GetCastShadows() ? 1 : 0;
+            data.receiveShadows = renderer->GetReceiveShadows() ? 1 : 0;
+            data.isStatic = renderer->GetStatic() ? 1 : 0;
+            data.renderOrder = renderer->GetRenderOrder();
+            writer.Write(data);
+
+            std::unique_ptr<DiffuseMaterial> defaults;
+
+            for(size_t i = 0; i < renderer->GetCount(); i++)
+            {
+                const RenderSettings *settings = target->GetSettings(i);
+                DiffuseMaterial *material = renderer->GetMaterial<DiffuseMaterial>(i);
+
+                if(!material)
+                {
+                    if(!defaults)
+                        defaults = std::make_unique<DiffuseMaterial>();
+                    material = defaults.get();
+                }
+
+                SceneMeshRendererEntry entry;
+                entry.mesh = writer.AddMesh(renderer->GetMesh(i));
+                entry.diffuseTexture = writer.AddTexture2D(material->GetDiffuseTexture());
+                entry.wireframe = settings->wireframe ? 1 : 0;
+                entry.depthTest = settings->depthTest ? 1 : 0;
+                entry.cullFace = settings->cullFace ? 1 : 0;
+                entry.alphaBlend = settings->alphaBlend ? 1 : 0;
+                entry.depthFunc = settings->depthFunc;
+                CopyColor(material->GetDiffuseColor(), entry.diffuseColor);
+                entry.ambientStrength = material->GetAmbientStrength();
+                entry.shininess = material->GetShininess();
+                entry.uvScale[0] = material->GetUVScale().x;
+                entry.uvScale[1] = material->GetUVScale().y;
+                entry.uvOffset[0] = material->GetUVOffset().x;
+                entry.uvOffset[1] = material->GetUVOffset().y;
+                entry.receiveShadows = material->GetReceiveShadows() ? 1 : 0;
+                writer.Write(entry);
+            }
+
+            return true;
+        }, [] (MeshRenderer *renderer, SceneReader &reader) {
+            SceneMeshRendererData data;
+            if(!reader.Read(data))
+                return;
+
+            renderer->SetCastShadows(data.castShadows != 0);
+            renderer->SetReceiveShadows(data.receiveShadows != 0);
+            renderer->SetStatic(data.isStatic != 0);
+            renderer->SetRenderOrder(data.renderOrder);
+
+            for(uint32_t i = 0; i < data.count; i++)
+            {
+                SceneMeshRendererEntry entry;
+                if(!reader.Read(entry))
+                    return;
+
+                auto material = std::make_shared<DiffuseMaterial>();
+                Texture2D *texture = reader.GetTexture2D(entry.diffuseTexture);
+
+                if(texture)
+                    material->SetDiffuseTexture(texture);
+
+                material->SetDiffuseColor(ToColor(entry.diffuseColor));
+                material->SetAmbientStrength(entry.ambientStrength);
+                material->SetShininess(entry.shininess);
+                material->SetUVScale(Vector2(entry.uvScale[0], entry.uvScale[1]));
+                material->SetUVOffset(Vector2(entry.uvOffset[0], entry.uvOffset[1]));
+                material->SetReceiveShadows(entry.receiveShadows != 0);
+
+                renderer->Add(reader.GetMesh(entry.mesh), material);
+
+                RenderSettings *settings = renderer->GetSettings(renderer->GetCount() - 1);
+                settings->wireframe = entry.wireframe != 0;
+                settings->depthTest = entry.depthTest != 0;
+                settings->cullFace = entry.cullFace != 0;
+                settings->alphaBlend = entry.alphaBlend != 0;
+                settings->depthFunc = entry.depthFunc;
+            }
+        });
+    }
+
+    void SceneSerializer::SetResourceResolver(const SceneResourceResolver &resolver)
+    {
+        resourceResolver = resolver;
+    }
+
+    uint64_t SceneSerializer::GetContentHash(Mesh *mesh)
+    {
+        if(!mesh)
+            return 0;
+
+        auto &vertices = mesh->GetVertices();
+        auto &indices = mesh->GetIndices();
+        uint64_t hash = Hash::FNV1a64(vertices.data(), vertices.size() * sizeof(Vertex));
+        return Hash::FNV1a64(indices.data(), indices.size() * sizeof(uint32_t), hash);
+    }
+
+    uint64_t SceneSerializer::GetContentHash(Texture2D *texture, const std::string &name)
+    {
+        if(!texture)
+            return 0;
+
+        //The pixels only live on the GPU, so the name and dimensions stand in for the contents
+        uint64_t hash = Hash::FNV1a64(name);
+        hash = Hash::Combine(hash, texture->GetWidth());
+        return Hash::Combine(hash, texture->GetHeight());
+    }
+
+    bool SceneSerializer::FindResourceName(Texture2D *texture, std::string &name)
+    {
+        //Textures don't know their own name, only Resources does
+        for(auto &item : Resources::textures2D)
+        {
+            if(&item.second == texture)
+            {
+                name = item.first;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void *SceneSerializer::ResolveResource(SceneResourceType type, const std::string &name, uint64_t contentHash)
+    {
+        if(resourceResolver)
+            return resourceResolver(type, name, contentHash);
+
+        switch(type)
+        {
+            case SceneResourceType::Mesh:
+            {
+                Mesh *mesh = Resources::FindMesh(name);
+
+                if(mesh && GetContentHash(mesh) == contentHash)
+                    return mesh;
+
+                //The mesh may have been renamed, the contents still identify it
+                for(auto &item : Resources::meshes)
+                {
+                    if(GetContentHash(&item.second) == contentHash)
+                        return &item.second;
+                }
+
+                return nullptr;
+            }
+            case SceneResourceType::Texture2D:
+            {
+                Texture2D *texture = Resources::FindTexture2D(name);
+
+                if(texture && GetContentHash(texture, name) == contentHash)
+                    return texture;
+
+                return nullptr;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    void SceneSerializer::Write(const std::vector<GameObject*> &roots, std::vector<uint8_t> &data)
+    {
+        if(!builtInComponentsRegistered)
+            RegisterBuiltInComponents();
+
+        struct TableBuilder
+        {
+            uint64_t typeHash;
+            std::vector<SceneComponentEntry> entries;
+        };
+
+        std::vector<SceneObjectRecord> objects;
+        std::vector<SceneResourceRecord> resources;
+        std::unordered_map<uint64_t,uint32_t> resourceMap;
+        std::vector<TableBuilder> tables;
+        std::vector<uint32_t> tableIndices(serializers.size(), INVALID_SERIALIZER_INDEX);
+        std::vector<uint8_t> componentData;
+        std::string strings;
+
+        SceneWriter writer;
+        writer.data = &componentData;
+        writer.resources = &resources;
+        writer.resourceMap = &resourceMap;
+        writer.strings = &strings;
+
+        //Depth first so every parent is written before its children
+        std::vector<std::pair<GameObject*,int32_t>> stack;
+
+        for(size_t i = roots.size(); i > 0; i--)
+        {
+            if(roots[i - 1])
+                stack.push_back(std::make_pair(roots[i - 1], -1));
+        }
+
+        while(stack.size() > 0)
+        {
+            GameObject *gameObject = stack.back().first;
+            int32_t parent = stack.back().second;
+            stack.pop_back();
+
+            uint32_t objectIndex = static_cast<uint32_t>(objects.size());
+            Transform *transform = gameObject->GetTransform();
+            const std::string &name = gameObject->GetNameId().GetString();
+            Vector3 position = transform->GetLocalPosition();
+            Quaternion rotation = transform->GetLocalRotation();
+            Vector3 scale = transform->GetLocalScale();
+
+            SceneObjectRecord record;
+            record.parent = parent;
+            record.nameOffset = static_cast<uint32_t>(strings.size());
+            record.nameLength = static_cast<uint32_t>(name.size());
+            record.isActive = gameObject->GetIsActive() ? 1 : 0;
+            record.layer = gameObject->GetLayer();
+            record.position[0] = position.x;
+            record.position[1] = position.y;
+            record.position[2] = position.z;
+            record.rotation[0] = rotation.x;
+            record.rotation[1] = rotation.y;
+            record.rotation[2] = rotation.z;
+            record.rotation[3] = rotation.w;
+            record.scale[0] = scale.x;
+            record.scale[1] = scale.y;
+            record.scale[2] = scale.z;
+            strings.append(name);
+            objects.push_back(record);
+
+            for(size_t i = 0; i < gameObject->components.size(); i++)
+            {
+                const Component *component = gameObject->components[i].get();
+                uint32_t typeId = ComponentType::GetId(component);
+
+                if(typeId >= serializerIndices.size() || serializerIndices[typeId] == INVALID_SERIALIZER_INDEX)
+                    continue;
+
+                uint32_t serializerIndex = serializerIndices[typeId];
+
+                //Every component starts aligned so its data can be read in place
+                componentData.resize(AlignOffset(componentData.size()), 0);
+                size_t dataOffset = componentData.size();
+
+                if(!serializers[serializerIndex].save(component, writer))
+                {
+                    componentData.resize(dataOffset);
+                    continue;
+                }
+
+                if(tableIndices[serializerIndex] == INVALID_SERIALIZER_INDEX)
+                {
+                    tableIndices[serializerIndex] = static_cast<uint32_t>(tables.size());
+                    TableBuilder table;
+                    table.typeHash = serializers[serializerIndex].typeHash;
+                    tables.push_back(table);
+                }
+
+                SceneComponentEntry entry;
+                entry.objectIndex = objectIndex;
+                entry.dataSize = static_cast<uint32_t>(componentData.size() - dataOffset);
+                entry.dataOffset = dataOffset;
+                tables[tableIndices[serializerIndex]].entries.push_back(entry);
+            }
+
+            auto &children = transform->GetChildren();
+
+            for(size_t i = children.size(); i > 0; i--)
+                stack.push_back(std::make_pair(children[i - 1]->GetGameObject(), static_cast<int32_t>(objectIndex)));
+        }
+
+        SceneFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.identifier, SCENE_IDENTIFIER, sizeof(SCENE_IDENTIFIER));
+        header.endianness = SCENE_ENDIANNESS;
+        header.version = VERSION;
+        header.headerSize = sizeof(SceneFileHeader);
+        header.objectCount = static_cast<uint32_t>(objects.size());
+        header.resourceCount = static_cast<uint32_t>(resources.size());
+        header.componentTableCount = static_cast<uint32_t>(tables.size());
+
+        data.clear();
+        data.resize(sizeof(SceneFileHeader), 0);
+
+        header.objectsOffset = WriteSection(data, objects.data(), objects.size() * sizeof(SceneObjectRecord));
+        header.resourcesOffset = WriteSection(data, resources.data(), resources.size() * sizeof(SceneResourceRecord));
+
+        std::vector<SceneComponentTable> tableRecords(tables.size());
+        header.componentTablesOffset = WriteSection(data, tableRecords.data(), tableRecords.size() * sizeof(SceneComponentTable));
+
+        for(size_t i = 0; i < tables.size(); i++)
+        {
+            tableRecords[i].typeHash = tables[i].typeHash;
+            tableRecords[i].count = static_cast<uint32_t>(tables[i].entries.size());
+            tableRecords[i].padding = 0;
+            tableRecords[i].entriesOffset = WriteSection(data, tables[i].entries.data(), tables[i].entries.size() * sizeof(SceneComponentEntry));
+        }
+
+        if(tableRecords.size() > 0)
+            memcpy(data.data() + header.componentTablesOffset, tableRecords.data(), tableRecords.size() * sizeof(SceneComponentTable));
+
+        header.stringsOffset = WriteSection(data, strings.data(), strings.size());
+        header.stringsSize = strings.size();
+        header.dataOffset = WriteSection(data, componentData.data(), componentData.size());
+        header.dataSize = componentData.size();
+        WriteAlignment(data);
+        header.fileSize = data.size();
+
+        memcpy(data.data(), &header, sizeof(header));
+    }
+
+    bool SceneSerializer::Read(const uint8_t *data, size_t size, std::vector<GameObject*> &objects)
+    {
+        if(data == nullptr || size < sizeof(SceneFileHeader))
+            return false;
+
+        //Sections are read in place, a buffer that isn't aligned gets copied once
+        if(reinterpret_cast<uintptr_t>(data) % SCENE_ALIGNMENT != 0)
+        {
+            std::vector<uint64_t> copy((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            memcpy(copy.data(), data, size);
+            return Read(reinterpret_cast<const uint8_t*>(copy.data()), size, objects);
+        }
+
+        if(!builtInComponentsRegistered)
+            RegisterBuiltInComponents();
+
+        const SceneFileHeader *header = reinterpret_cast<const SceneFileHeader*>(data);
+
+        if(memcmp(header->identifier, SCENE_IDENTIFIER, sizeof(SCENE_IDENTIFIER)) != 0)
+            return false;
+        if(header->endianness != SCENE_ENDIANNESS || header->version != VERSION)
+            return false;
+        if(header->headerSize != sizeof(SceneFileHeader) || header->fileSize != size)
+            return false;
+
+        if(!IsValidRange(header->objectsOffset, header->objectCount, sizeof(SceneObjectRecord), size))
+            return false;
+        if(!IsValidRange(header->resourcesOffset, header->resourceCount, sizeof(SceneResourceRecord), size))
+            return false;
+        if(!IsValidRange(header->componentTablesOffset, header->componentTableCount, sizeof(SceneComponentTable), size))
+            return false;
+        if(!IsValidRange(header->stringsOffset, header->stringsSize, 1, size))
+            return false;
+        if(!IsValidRange(header->dataOffset, header->dataSize, 1, size))
+            return false;
+
+        //The offsets become pointers into the buffer, everything is validated before the first object is created
+        const SceneObjectRecord *objectRecords = reinterpret_cast<const SceneObjectRecord*>(data + header->objectsOffset);
+        const SceneResourceRecord *resourceRecords = reinterpret_cast<const SceneResourceRecord*>(data + header->resourcesOffset);
+        const SceneComponentTable *tables = reinterpret_cast<const SceneComponentTable*>(data + header->componentTablesOffset);
+        const char *strings = reinterpret_cast<const char*>(data + header->stringsOffset);
+        const uint8_t *componentData = data + header->dataOffset;
+
+        for(uint32_t i = 0; i < header->objectCount; i++)
+        {
+            const SceneObjectRecord &record = objectRecords[i];
+
+            if(record.parent < -1 || record.parent >= static_cast<int32_t>(i))
+                return false;
+            if(record.nameOffset > header->stringsSize || record.nameLength > header->stringsSize - record.nameOffset)
+                return false;
+        }
+
+        for(uint32_t i = 0; i < header->resourceCount; i++)
+        {
+            const SceneResourceRecord &record = resourceRecords[i];
+
+            if(record.type > static_cast<uint32_t>(SceneResourceType::Texture2D))
+                return false;
+            if(record.nameOffset > header->stringsSize || record.nameLength > header->stringsSize - record.nameOffset)
+                return false;
+        }
+
+        std::vector<uint32_t> tableSerializers(header->componentTableCount, INVALID_SERIALIZER_INDEX);
+
+        for(uint32_t i = 0; i < header->componentTableCount; i++)
+        {
+            const SceneComponentTable &table = tables[i];
+
+            if(!IsValidRange(table.entriesOffset, table.count, sizeof(SceneComponentEntry), size))
+                return false;
+
+            const SceneComponentEntry *entries = reinterpret_cast<const SceneComponentEntry*>(data + table.entriesOffset);
+
+            for(uint32_t j = 0; j < table.count; j++)
+            {
+                if(entries[j].objectIndex >= header->objectCount)
+                    return false;
+                if(entries[j].dataOffset > header->dataSize || entries[j].dataSize > header->dataSize - entries[j].dataOffset)
+                    return false;
+            }
+
+            auto it = serializerMap.find(table.typeHash);
+
+            if(it != serializerMap.end())
+                tableSerializers[i] = it->second;
+            else
+                Debug::WriteLog("[SCENE] Skipping " + std::to_string(table.count) + " components of an unregistered type");
+        }
+
+        std::vector<void*> resources(header->resourceCount, nullptr);
+
+        for(uint32_t i = 0; i < header->resourceCount; i++)
+        {
+            const SceneResourceRecord &record = resourceRecords[i];
+            std::string name(strings + record.nameOffset, record.nameLength);
+            resources[i] = ResolveResource(static_cast<SceneResourceType>(record.type), name, record.contentHash);
+
+            if(!resources[i])
+                Debug::WriteLog("[SCENE] Could not find resource " + name);
+        }
+
+        size_t firstObject = objects.size();
+        objects.reserve(firstObject + header->objectCount);
+        GameObject::objects.reserve(GameObject::objects.size() + header->objectCount);
+
+        for(uint32_t i = 0; i < header->objectCount; i++)
+        {
+            const SceneObjectRecord &record = objectRecords[i];
+            GameObject *gameObject = GameObject::Create();
+            gameObject->SetName(StringId(strings + record.nameOffset, record.nameLength));
+            gameObject->SetLayer(record.layer, false);
+
+            Transform *transform = gameObject->GetTransform();
+            transform->SetLocalPosition(Vector3(record.position[0], record.position[1], record.position[2]));
+            Quaternion rotation;
+            rotation.x = record.rotation[0];
+            rotation.y = record.rotation[1];
+            rotation.z = record.rotation[2];
+            rotation.w = record.rotation[3];
+            transform->SetLocalRotation(rotation);
+            transform->SetScale(Vector3(record.scale[0], record.scale[1], record.scale[2]));
+
+            if(record.parent >= 0)
+                transform->SetParent(objects[firstObject + record.parent]->GetTransform());
+
+            objects.push_back(gameObject);
+        }
+
+        //Components are instantiated one type at a time, each one reading its data in place
+        SceneReader reader;
+        reader.resources = &resources;
+        reader.resourceRecords = resourceRecords;
+        reader.resourceCount = header->resourceCount;
+
+        for(uint32_t i = 0; i < header->componentTableCount; i++)
+        {
+            if(tableSerializers[i] == INVALID_SERIALIZER_INDEX)
+                continue;
+
+            const auto &load = serializers[tableSerializers[i]].load;
+            const SceneComponentEntry *entries = reinterpret_cast<const SceneComponentEntry*>(data + tables[i].entriesOffset);
+
+            for(uint32_t j = 0; j < tables[i].count; j++)
+            {
+                reader.data = componentData + entries[j].dataOffset;
+                reader.size = entries[j].dataSize;
+                reader.offset = 0;
+                load(objects[firstObject + entries[j].objectIndex], reader);
+            }
+        }
+
+        //Parents come first, so a child that was active under an inactive parent gets switched back on
+        for(uint32_t i = 0; i < header->objectCount; i++)
+        {
+            bool isActive = objectRecords[i].isActive != 0;
+            GameObject *gameObject = objects[firstObject + i];
+
+            if(gameObject->GetIsActive() != isActive)
+                gameObject->SetIsActive(isActive);
+        }
+
+        return true;
+    }
+
+    bool SceneSerializer::Save(const std::string &filepath, const std::vector<GameObject*> &roots)
+    {
+        std::vector<uint8_t> data;
+        Write(roots, data);
+
+        //Write to a temporary file first so a crash never leaves a truncated scene behind
+        std::string temporaryPath = filepath + ".tmp";
+        File::WriteAllBytes(temporaryPath, data.data(), data.size());
+
+        std::error_code error;
+
+        if(std::filesystem::file_size(temporaryPath, error) != data.size() || error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        std::filesystem::rename(temporaryPath, filepath, error);
+        return !error;
+    }
+
+    bool SceneSerializer::Load(const std::string &filepath, std::vector<GameObject*> &objects)
+    {
+        MemoryMappedFile file;
+
+        if(!file.Open(filepath))
+            return false;
+
+        return Read(file.GetData(), file.GetSize(), objects);
+    }
+}
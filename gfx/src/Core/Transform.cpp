@@ -1,6 +1,7 @@
 #include "Transform.hpp"
 #include "GameObject.hpp"
 #include "Time.hpp"
+#include "../System/FrameArena.hpp"
 #include <algorithm>
 
 namespace GFX
@@ -446,16 +447,30 @@ namespace GFX
 
     Transform::Transform() : Component()
     {
-        localPosition = Vector3(0, 0, 0);
-        localRotation = glm::quat_identity<float, glm::defaultp>();
-        localScale = Vector3(1, 1, 1);
+        TransformState data;
+        data.localPosition = Vector3(0, 0, 0);
+        data.localRotation = glm::quat_identity<float, glm::defaultp>();
+        data.localScale = Vector3(1, 1, 1);
+        data.worldMatrix = Matrix4(1.0f);
+        data.isDirty = true;
+        state.Create(this, data);
+
         parent = nullptr;
         root = this;
-        isDirty = true;
 
         SetName("Transform");
     }
 
+    TransformState *Transform::GetState() const
+    {
+        return state.Get();
+    }
+
+    EntityHandle Transform::GetEntity() const
+    {
+        return state.GetEntity();
+    }
+
     std::vector<Transform*> &Transform::GetChildren()
     {
         return children;
@@ -463,13 +478,30 @@ namespace GFX
 
     std::vector<Transform*> Transform::GetChildrenRecursive() const
     {
+        //Depth first in the same order as before, without a temporary vector per level
         std::vector<Transform*> allChildren;
+        FrameVector<const Transform*> stack;
+        FrameVector<size_t> indices;
 
-        for (const auto& child : children)
+        stack.push_back(this);
+        indices.push_back(0);
+
+        while(stack.size() > 0)
         {
+            const Transform *current = stack.back();
+            size_t &index = indices.back();
+
+            if(index >= current->children.size())
+            {
+                stack.pop_back();
+                indices.pop_back();
+                continue;
+            }
+
+            Transform *child = current->children[index++];
             allChildren.push_back(child);
-            std::vector<Transform*> childChildren = child->GetChildrenRecursive();
-            allChildren.insert(allChildren.end(), childChildren.begin(), childChildren.end());
+            stack.push_back(child);
+            indices.push_back(0);
         }
 
         return allChildren;
@@ -484,49 +516,52 @@ namespace GFX
 
     Matrix4 Transform::GetModelMatrix() const
     {
-        if (isDirty)
+        TransformState &data = *state.Get();
+
+        if (data.isDirty)
         {
-            RecalculateModelMatrix();
+            RecalculateModelMatrix(data);
         }
-        return cachedWorldMatrix;
+        return data.worldMatrix;
     }
 
-    void Transform::RecalculateModelMatrix() const
+    void Transform::RecalculateModelMatrix(TransformState &data) const
     {
-        Matrix4 localMatrix = glm::translate(glm::mat4(1.0f), localPosition) * glm::toMat4(localRotation) * glm::scale(glm::mat4(1.0f), localScale);
+        Matrix4 localMatrix = glm::translate(glm::mat4(1.0f), data.localPosition) * glm::toMat4(data.localRotation) * glm::scale(glm::mat4(1.0f), data.localScale);
 
         if (parent)
         {
-            cachedWorldMatrix = parent->GetModelMatrix() * localMatrix;
+            data.worldMatrix = parent->GetModelMatrix() * localMatrix;
         }
         else
         {
-            cachedWorldMatrix = localMatrix;
+            data.worldMatrix = localMatrix;
         }
 
-        isDirty = false;
+        data.isDirty = false;
     }
 
     void Transform::SetPosition(const Vector3 &value)
     {
-        previousPosition = localPosition;
+        TransformState &data = *state.Get();
+        previousPosition = data.localPosition;
 
         if (parent)
         {
             Matrix4 parentMatrix = parent->GetModelMatrix();
             Matrix4 invParentMatrix = glm::inverse(parentMatrix);
-            localPosition = glm::vec3(invParentMatrix * glm::vec4(value, 1.0f));
+            data.localPosition = glm::vec3(invParentMatrix * glm::vec4(value, 1.0f));
         }
         else
         {
-            localPosition = value;
+            data.localPosition = value;
         }
 
         float deltaTime = Time::GetDeltaTime();
 
-        float dx = localPosition.x - previousPosition.x;
-        float dy = localPosition.y - previousPosition.y;
-        float dz = localPosition.z - previousPosition.z;
+        float dx = data.localPosition.x - previousPosition.x;
+        float dy = data.localPosition.y - previousPosition.y;
+        float dz = data.localPosition.z - previousPosition.z;
         velocity = Vector3(dx / deltaTime, dy / deltaTime, dz / deltaTime);
 
         MarkDirty();
@@ -539,24 +574,24 @@ namespace GFX
 
     void Transform::SetLocalPosition(const Vector3 &value)
     {
-        localPosition = value;
+        state.Get()->localPosition = value;
         MarkDirty();
     }
 
     Vector3 Transform::GetLocalPosition() const
     {
-        return localPosition;
+        return state.Get()->localPosition;
     }
 
     void Transform::SetRotation(const Quaternion &value)
     {
         if (parent)
         {
-            localRotation = glm::inverse(parent->GetRotation()) * value;
+            state.Get()->localRotation = glm::inverse(parent->GetRotation()) * value;
         }
         else
         {
-            localRotation = value;
+            state.Get()->localRotation = value;
         }
         MarkDirty();
     }
@@ -565,39 +600,39 @@ namespace GFX
     {
         if (parent)
         {
-            return parent->GetRotation() * localRotation;
+            return parent->GetRotation() * state.Get()->localRotation;
         }
         else
         {
-            return localRotation;
+            return state.Get()->localRotation;
         }
     }
 
     void Transform::SetLocalRotation(const Quaternion &value)
     {
-        localRotation = value;
+        state.Get()->localRotation = value;
         MarkDirty();
     }
 
     Quaternion Transform::GetLocalRotation() const
     {
-        return localRotation;
+        return state.Get()->localRotation;
     }
 
     void Transform::SetScale(const Vector3 &value)
     {
-        localScale = value;
+        state.Get()->localScale = value;
         MarkDirty();
     }
 
     Vector3 Transform::GetScale() const
     {
-        return localScale;
+        return state.Get()->localScale;
     }
 
     Vector3 Transform::GetLocalScale() const
     {
-        return localScale;
+        return state.Get()->localScale;
     }
 
     Vector3 Transform::GetVelocity()
@@ -752,10 +787,18 @@ namespace GFX
     }
 
     Transform *Transform::FindChild(const std::string &name)
+    {
+        StringId id;
+        if(!StringId::TryGet(name, id))
+            return nullptr;
+        return FindChild(id);
+    }
+
+    Transform *Transform::FindChild(StringId name)
     {
         for(const auto& child : children)
         {
-            if(child->GetGameObject()->GetName() == name)
+            if(child->GetGameObject()->GetNameId() == name)
             {
                 return child;
             }
@@ -818,9 +861,11 @@ namespace GFX
 
     void Transform::MarkDirty()
     {
-        if (!isDirty)
+        TransformState &data = *state.Get();
+
+        if (!data.isDirty)
         {
-            isDirty = true;
+            data.isDirty = true;
             for (Transform *child : children)
             {
                 child->MarkDirty();
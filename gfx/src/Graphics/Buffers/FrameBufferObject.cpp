@@ -11,6 +11,8 @@ namespace GFX
 		this->depthAttachmentId = 0;
 		this->width = 0;
 		this->height = 0;
+		this->allocatedWidth = 0;
+		this->allocatedHeight = 0;
 		this->multiSample = false;
 		this->hdr = false;
 	}
@@ -22,6 +24,8 @@ namespace GFX
 		this->depthAttachmentId = 0;
 		this->width = width;
 		this->height = height;
+		this->allocatedWidth = 0;
+		this->allocatedHeight = 0;
 		this->multiSample = multiSample;
 		this->hdr = hdr;
 	}
@@ -33,6 +37,8 @@ namespace GFX
 		depthAttachmentId = other.depthAttachmentId;
 		width = other.width;
 		height = other.height;
+		allocatedWidth = other.allocatedWidth;
+		allocatedHeight = other.allocatedHeight;
 		multiSample = other.multiSample;
 		hdr = other.hdr;
 	}
@@ -44,6 +50,8 @@ namespace GFX
 		depthAttachmentId = std::exchange(other.depthAttachmentId, 0);
 		width = std::exchange(other.width, 0);
 		height = std::exchange(other.height, 0);
+		allocatedWidth = std::exchange(other.allocatedWidth, 0);
+		allocatedHeight = std::exchange(other.allocatedHeight, 0);
 		multiSample = other.multiSample;
 		hdr = other.hdr;
 	}
@@ -57,6 +65,8 @@ namespace GFX
 			depthAttachmentId = other.depthAttachmentId;
 			width = other.width;
 			height = other.height;
+			allocatedWidth = other.allocatedWidth;
+			allocatedHeight = other.allocatedHeight;
 			multiSample = other.multiSample;
 			hdr = other.hdr;
 		}
@@ -72,6 +82,8 @@ namespace GFX
 			depthAttachmentId = std::exchange(other.depthAttachmentId, 0);
 			width = std::exchange(other.width, 0);
 			height = std::exchange(other.height, 0);
+			allocatedWidth = std::exchange(other.allocatedWidth, 0);
+			allocatedHeight = std::exchange(other.allocatedHeight, 0);
 			multiSample = other.multiSample;
 			hdr = other.hdr;
 		}
@@ -103,6 +115,8 @@ namespace GFX
 			glDeleteRenderbuffers(1, &depthAttachmentId);
 			depthAttachmentId = 0;
 		}
+		allocatedWidth = 0;
+		allocatedHeight = 0;
 	}
 
 	void FrameBufferObject::Bind()
@@ -117,11 +131,28 @@ namespace GFX
 
 	void FrameBufferObject::Resize(uint32_t width, uint32_t height)
 	{
-		Delete();
-
 		this->width = width;
 		this->height = height;
 
+		// Attachments are allocated in size classes and only the used region is rendered to,
+		// so resizing the window within the same class doesn't recreate anything
+		if(id > 0 && GetSizeClass(width) == allocatedWidth && GetSizeClass(height) == allocatedHeight)
+			return;
+
+		Delete();
+		Allocate();
+
+		glViewport(0, 0, width, height);
+	}
+
+	void FrameBufferObject::Allocate()
+	{
+		allocatedWidth = GetSizeClass(width);
+		allocatedHeight = GetSizeClass(height);
+
+		uint32_t width = allocatedWidth;
+		uint32_t height = allocatedHeight;
+
 		glGenFramebuffers(1, &id);
 		glBindFramebuffer(GL_FRAMEBUFFER, id);
 
@@ -181,8 +212,6 @@ namespace GFX
 			// Handle error (e.g., cleanup)
 		}
 
-		glViewport(0, 0, width, height);
-
 		// Unbind framebuffer and other resources
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glBindTexture(GL_TEXTURE_2D, 0);
@@ -231,6 +260,24 @@ namespace GFX
 		return height;
 	}
 
+	uint32_t FrameBufferObject::GetAllocatedWidth() const
+	{
+		return allocatedWidth;
+	}
+
+	uint32_t FrameBufferObject::GetAllocatedHeight() const
+	{
+		return allocatedHeight;
+	}
+
+	uint32_t FrameBufferObject::GetSizeClass(uint32_t size)
+	{
+		const uint32_t granularity = 256;
+		if(size == 0)
+			return granularity;
+		return ((size + granularity - 1) / granularity) * granularity;
+	}
+
     // FrameBufferObject::FrameBufferObject()
     // {
     //     this->id = 0;
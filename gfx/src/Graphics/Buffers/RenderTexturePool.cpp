@@ -0,0 +1,171 @@
+#include "RenderTexturePool.hpp"
+#include "FrameBufferObject.hpp"
+#include "../../Core/Debug.hpp"
+
+namespace GFX
+{
+    RenderTexture::RenderTexture()
+    {
+        fbo = 0;
+        textureId = 0;
+        format = GL_RGBA16F;
+        width = 0;
+        height = 0;
+        allocatedWidth = 0;
+        allocatedHeight = 0;
+        lastUsedFrame = 0;
+        inUse = false;
+    }
+
+    float RenderTexture::GetUVScaleX() const
+    {
+        if(allocatedWidth == 0)
+            return 1.0f;
+        return static_cast<float>(width) / static_cast<float>(allocatedWidth);
+    }
+
+    float RenderTexture::GetUVScaleY() const
+    {
+        if(allocatedHeight == 0)
+            return 1.0f;
+        return static_cast<float>(height) / static_cast<float>(allocatedHeight);
+    }
+
+    RenderTexturePool::RenderTexturePool()
+    {
+        frame = 0;
+        maxUnusedFrames = 120;
+    }
+
+    RenderTexture *RenderTexturePool::Acquire(uint32_t width, uint32_t height, GLenum format)
+    {
+        if(width == 0)
+            width = 1;
+        if(height == 0)
+            height = 1;
+
+        uint32_t allocatedWidth = FrameBufferObject::GetSizeClass(width);
+        uint32_t allocatedHeight = FrameBufferObject::GetSizeClass(height);
+
+        for(size_t i = 0; i < textures.size(); i++)
+        {
+            RenderTexture *texture = textures[i].get();
+
+            if(texture->inUse || texture->format != format)
+                continue;
+
+            if(texture->allocatedWidth != allocatedWidth || texture->allocatedHeight != allocatedHeight)
+                continue;
+
+            texture->width = width;
+            texture->height = height;
+            texture->inUse = true;
+            texture->lastUsedFrame = frame;
+            return texture;
+        }
+
+        auto texture = std::make_unique<RenderTexture>();
+        texture->format = format;
+        texture->width = width;
+        texture->height = height;
+        texture->allocatedWidth = allocatedWidth;
+        texture->allocatedHeight = allocatedHeight;
+        texture->inUse = true;
+        texture->lastUsedFrame = frame;
+
+        Allocate(texture.get());
+
+        textures.push_back(std::move(texture));
+        return textures.back().get();
+    }
+
+    void RenderTexturePool::Release(RenderTexture *texture)
+    {
+        if(texture == nullptr)
+            return;
+        texture->inUse = false;
+        texture->lastUsedFrame = frame;
+    }
+
+    void RenderTexturePool::NewFrame()
+    {
+        frame++;
+
+        for(size_t i = 0; i < textures.size(); i++)
+        {
+            RenderTexture *texture = textures[i].get();
+
+            if(texture->inUse)
+                continue;
+
+            if((frame - texture->lastUsedFrame) <= maxUnusedFrames)
+                continue;
+
+            Destroy(texture);
+            textures.erase(textures.begin() + i);
+            i--;
+        }
+    }
+
+    void RenderTexturePool::Delete()
+    {
+        for(size_t i = 0; i < textures.size(); i++)
+            Destroy(textures[i].get());
+        textures.clear();
+    }
+
+    void RenderTexturePool::SetMaxUnusedFrames(uint32_t frames)
+    {
+        maxUnusedFrames = frames;
+    }
+
+    uint32_t RenderTexturePool::GetMaxUnusedFrames() const
+    {
+        return maxUnusedFrames;
+    }
+
+    size_t RenderTexturePool::GetCount() const
+    {
+        return textures.size();
+    }
+
+    void RenderTexturePool::Allocate(RenderTexture *texture)
+    {
+        // Immutable storage so the texture can also be bound as an image in compute passes
+        glGenTextures(1, &texture->textureId);
+        glBindTexture(GL_TEXTURE_2D, texture->textureId);
+        glTexStorage2D(GL_TEXTURE_2D, 1, texture->format, texture->allocatedWidth, texture->allocatedHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &texture->fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, texture->fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureId, 0);
+
+        uint32_t status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        
+        if(status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            Debug::WriteError("Failed to initialize render texture, status: %u", status);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void RenderTexturePool::Destroy(RenderTexture *texture)
+    {
+        if(texture->fbo > 0)
+        {
+            glDeleteFramebuffers(1, &texture->fbo);
+            texture->fbo = 0;
+        }
+        if(texture->textureId > 0)
+        {
+            glDeleteTextures(1, &texture->textureId);
+            texture->textureId = 0;
+        }
+    }
+}
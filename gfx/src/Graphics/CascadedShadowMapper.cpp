@@ -74,47 +74,58 @@ namespace GFX
 		{
 			float split = cascadeSplits[i];
 
-			// Calculate frustum corners in world space
-			glm::mat4 invViewProj = glm::inverse(cameraView *
-												 glm::perspective(fov, aspect, lastSplit, split));
-
-			std::vector<glm::vec3> frustumCorners;
-			CalculateFrustumCorners(invViewProj, frustumCorners);
-
-			// Calculate light space AABB
-			glm::vec3 minAABB(FLT_MAX);
-			glm::vec3 maxAABB(-FLT_MAX);
-			glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, glm::vec3(0, 1, 0));
-
-			for (const auto &corner : frustumCorners)
-			{
-				glm::vec4 lightSpaceCorner = lightView * glm::vec4(corner, 1.0f);
-				minAABB = glm::min(minAABB, glm::vec3(lightSpaceCorner));
-				maxAABB = glm::max(maxAABB, glm::vec3(lightSpaceCorner));
-			}
-
-			// Snap to texel grid to prevent flickering
-			float worldUnitsPerTexel = (maxAABB.x - minAABB.x) / shadowMapSize;
-			minAABB.x = floor(minAABB.x / worldUnitsPerTexel) * worldUnitsPerTexel;
-			minAABB.y = floor(minAABB.y / worldUnitsPerTexel) * worldUnitsPerTexel;
-			maxAABB.x = floor(maxAABB.x / worldUnitsPerTexel) * worldUnitsPerTexel;
-			maxAABB.y = floor(maxAABB.y / worldUnitsPerTexel) * worldUnitsPerTexel;
-
-			glm::mat4 lightProj = glm::ortho(
-				minAABB.x, maxAABB.x,
-				minAABB.y, maxAABB.y,
-				minAABB.z - 1000.0f, // Expand Z bounds slightly
-				maxAABB.z + 1000.0f);
-
-			lightVPs[i] = lightProj * lightView;
+			glm::mat4 invViewProj = glm::inverse(glm::perspective(fov, aspect, lastSplit, split) * cameraView);
+
+			glm::vec3 center;
+			float radius;
+			lightVPs[i] = CalculateStableLightMatrix(invViewProj, lightDir, shadowMapSize, 1000.0f, center, radius);
 			lastSplit = split;
 		}
 	}
 
-	void CascadedShadowMapper::CalculateFrustumCorners(const glm::mat4 &inverseViewProj,
-													   std::vector<glm::vec3> &outCorners) const
+	glm::mat4 CascadedShadowMapper::CalculateStableLightMatrix(const glm::mat4 &inverseViewProj, const glm::vec3 &lightDir, int shadowMapSize,
+															   float depthPadding, glm::vec3 &center, float &radius)
+	{
+		glm::vec3 corners[8];
+		CalculateFrustumCorners(inverseViewProj, corners);
+
+		center = glm::vec3(0.0f);
+
+		for (int i = 0; i < 8; ++i)
+			center += corners[i];
+
+		center /= 8.0f;
+		radius = 0.0f;
+
+		for (int i = 0; i < 8; ++i)
+			radius = glm::max(radius, glm::length(corners[i] - center));
+
+		// A sphere does not change size when the camera rotates, rounding hides the remaining float noise
+		radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+		// Snapping moves the center by up to a texel, so the box gets exactly one texel of margin
+		radius *= static_cast<float>(shadowMapSize) / static_cast<float>(glm::max(shadowMapSize - 2, 1));
+
+		glm::vec3 direction = glm::normalize(lightDir);
+		glm::vec3 up = glm::abs(direction.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+		glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+
+		// Snap the center to whole texels in light space
+		float worldUnitsPerTexel = (2.0f * radius) / static_cast<float>(shadowMapSize);
+		glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+		lightCenter.x = glm::floor(lightCenter.x / worldUnitsPerTexel) * worldUnitsPerTexel;
+		lightCenter.y = glm::floor(lightCenter.y / worldUnitsPerTexel) * worldUnitsPerTexel;
+
+		float depth = radius + depthPadding;
+		lightView[3] = glm::vec4(-lightCenter.x, -lightCenter.y, -lightCenter.z - depth, 1.0f);
+		center = glm::transpose(glm::mat3(lightView)) * lightCenter;
+
+		glm::mat4 lightProj = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * depth);
+		return lightProj * lightView;
+	}
+
+	void CascadedShadowMapper::CalculateFrustumCorners(const glm::mat4 &inverseViewProj, glm::vec3 *outCorners)
 	{
-		outCorners.resize(8);
 		const glm::vec3 frustumCorners[8] = {
 			{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
 
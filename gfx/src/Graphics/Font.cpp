@@ -1,43 +1,79 @@
 #include "Font.hpp"
+#include "TextLayoutCache.hpp"
+#include "../System/String.hpp"
 #include "../External/glad/glad.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <iostream>
 #include <utility>
+#include <unordered_set>
+#include <cstring>
 
 namespace GFX
 {
+    static constexpr uint32_t ATLAS_PAGE_SIZE = 1024;
+    static constexpr uint32_t ATLAS_MAX_PAGES = 4;
+    static constexpr uint32_t ATLAS_PADDING = 2;
+
+    struct FontData
+    {
+        FT_Library library;
+        FT_Face face;
+        uint64_t id;
+        std::vector<uint8_t> fileData; //FreeType reads from this for as long as the face is alive
+        GlyphAtlas atlas;
+        std::vector<uint32_t> textures;
+        std::unordered_set<uint32_t> missingGlyphs;
+        std::vector<uint8_t> bitmap;
+
+        FontData()
+        {
+            library = nullptr;
+            face = nullptr;
+            id = 0;
+        }
+
+        ~FontData()
+        {
+            if(face)
+                FT_Done_Face(face);
+            if(library)
+                FT_Done_FreeType(library);
+        }
+    };
+
+    uint64_t Font::frameIndex = 1;
+    static uint64_t nextFontId = 1;
+
     Font::Font()
 	{
-        textureId = 0;
         pixelSize = 0;
         maxHeight = 0;
         lineHeight = 0;
         codePointOfFirstChar = 0;
+        baseYOffset = 0.0f;
         renderMethod = FontRenderMethod::Normal;
     }
 
     Font::Font(const Font &other)
 	{
         this->pixelSize = other.pixelSize;
-        this->textureId = other.textureId;
         this->maxHeight = other.maxHeight;
         this->lineHeight = other.lineHeight;
         this->codePointOfFirstChar = other.codePointOfFirstChar;
-        this->glyphs = other.glyphs;
-        this->textureData = other.textureData;
+        this->baseYOffset = other.baseYOffset;
+        this->data = other.data;
         renderMethod = other.renderMethod;
     }
 
 	Font::Font(Font &&other) noexcept
 	{
 		this->pixelSize = std::exchange(other.pixelSize, 0);
-		this->textureId = std::exchange(other.textureId, 0);
 		this->maxHeight = std::exchange(other.maxHeight, 0);
 		this->lineHeight = std::exchange(other.lineHeight, 0);
 		this->codePointOfFirstChar = std::exchange(other.codePointOfFirstChar, 0);
-		this->glyphs = std::move(other.glyphs);
-		this->textureData = std::move(other.textureData);
+		this->baseYOffset = std::exchange(other.baseYOffset, 0.0f);
+		this->data = std::move(other.data);
         this->renderMethod = other.renderMethod;
 	}
 
@@ -46,12 +82,11 @@ namespace GFX
 		if(this != &other)
 		{
 			this->pixelSize = other.pixelSize;
-			this->textureId = other.textureId;
 			this->maxHeight = other.maxHeight;
 			this->lineHeight = other.lineHeight;
 			this->codePointOfFirstChar = other.codePointOfFirstChar;
-			this->glyphs = other.glyphs;
-			this->textureData = other.textureData;
+			this->baseYOffset = other.baseYOffset;
+			this->data = other.data;
             this->renderMethod = other.renderMethod;
 		}
 		return *this;
@@ -62,12 +97,11 @@ namespace GFX
 		if(this != &other)
 		{
 			this->pixelSize = std::exchange(other.pixelSize, 0);
-			this->textureId = std::exchange(other.textureId, 0);
 			this->maxHeight = std::exchange(other.maxHeight, 0);
 			this->lineHeight = std::exchange(other.lineHeight, 0);
 			this->codePointOfFirstChar = std::exchange(other.codePointOfFirstChar, 0);
-			this->glyphs = std::move(other.glyphs);
-			this->textureData = std::move(other.textureData);
+			this->baseYOffset = std::exchange(other.baseYOffset, 0.0f);
+			this->data = std::move(other.data);
             this->renderMethod = other.renderMethod;
 		}
 		return *this;
@@ -75,9 +109,9 @@ namespace GFX
 
     bool Font::LoadFromFile(const std::string &filepath, uint32_t pixelSize, FontRenderMethod renderMethod) 
 	{
-        if(textureData.size() > 0) 
+        if(data) 
 		{
-            std::cerr << "Could not load font because texture is already generated\n";
+            std::cerr << "Could not load font because it is already loaded\n";
             return false;
         }
 
@@ -99,19 +133,14 @@ namespace GFX
             return false;
         }
 
-        bool result = Load(fontFace);
-
-        FT_Done_Face(fontFace);
-        FT_Done_FreeType(library);
-
-        return result;
+        return Load(library, fontFace);
     }
 
     bool Font::LoadFromMemory(const void *data, size_t dataSize, uint32_t pixelSize, FontRenderMethod renderMethod) 
 	{
-        if(textureData.size() > 0) 
+        if(this->data) 
 		{
-            std::cerr << "Could not load font because texture is already generated\n";
+            std::cerr << "Could not load font because it is already loaded\n";
             return false;
         }
 
@@ -125,145 +154,215 @@ namespace GFX
             return false;
         }
 
+        //The face is kept open for lazy rasterization, so it needs its own copy of the data
+        std::vector<uint8_t> fileData(dataSize);
+        memcpy(fileData.data(), data, dataSize);
+
         FT_Face fontFace;
-        const unsigned char *pData = reinterpret_cast<const FT_Byte*>(data);
-        if (FT_New_Memory_Face(library, pData, dataSize, 0, &fontFace)) 
+        if (FT_New_Memory_Face(library, fileData.data(), dataSize, 0, &fontFace)) 
 		{
             FT_Done_FreeType(library);
             std::cerr << "Could not load font\n";
             return false;
         }
 
-        bool result = Load(fontFace);
-
-        FT_Done_Face(fontFace);
-        FT_Done_FreeType(library);
+        if(!Load(library, fontFace))
+            return false;
 
-        return result;
+        this->data->fileData = std::move(fileData);
+        return true;
     }
 
-    bool Font::Load(FT_Face fontFace) 
+    bool Font::Load(FT_Library library, FT_Face fontFace) 
 	{
-        FT_Set_Pixel_Sizes(fontFace, 0, pixelSize);
-        
-        const uint32_t textureWidth = 1024;
-        const uint32_t textureHeight = 1024;
-        const uint32_t padding = 2;
-        int row = 0;
-        int col = 0;
-        int64_t height = 0;
+        data = std::make_shared<FontData>();
+        data->library = library;
+        data->face = fontFace;
+        data->id = nextFontId++;
+        data->atlas.Initialize(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, ATLAS_MAX_PAGES, ATLAS_PADDING);
 
-        //FT_Int32 loadFlags = FT_LOAD_RENDER | FT_LOAD_TARGET_(FT_RENDER_MODE_SDF);
-        FT_Int32 loadFlags = FT_LOAD_RENDER;
+        FT_Set_Pixel_Sizes(fontFace, 0, pixelSize);
 
-        textureData.resize(textureWidth * textureHeight);
+        maxHeight = (uint32_t)((int64_t)(fontFace->size->metrics.ascender - fontFace->size->metrics.descender) >> 6);
 
+        //Printable ASCII is rasterized up front, everything else on first use
         codePointOfFirstChar = 32;
-        const uint32_t charsToIncludeInFontAtlas = 95;
-        const FT_ULong start = static_cast<FT_ULong>(codePointOfFirstChar);
-        const FT_ULong end = start + static_cast<FT_ULong>(charsToIncludeInFontAtlas);
-        glyphs.resize(charsToIncludeInFontAtlas);
-        size_t index = 0;
+        const uint32_t charsToPreload = 95;
         int64_t lineHeight = 0;
-        size_t maxRowHeight = 0;
+        float height = 0.0f;
 
-        //for(FT_ULong glyphIdx = 0; glyphIdx < numGlyphs; glyphIdx++) {
-        for(FT_ULong glyphIdx = start; glyphIdx < end; glyphIdx++) 
+        for(uint32_t codepoint = codePointOfFirstChar; codepoint < codePointOfFirstChar + charsToPreload; codepoint++) 
 		{
-            if(FT_Load_Char(fontFace, glyphIdx, loadFlags))
-                continue;
+            Glyph *glyph = FindGlyph(codepoint);
 
-            if(FT_Render_Glyph(fontFace->glyph, renderMethod == FontRenderMethod::Normal ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_SDF))
+            if(glyph == nullptr)
                 continue;
 
-            if(fontFace->glyph->bitmap.rows > maxRowHeight)
-                maxRowHeight = fontFace->glyph->bitmap.rows;
+            lineHeight = std::max(glyph->height, lineHeight);
 
-            if(col + fontFace->glyph->bitmap.width + padding >= textureWidth) 
+            if(glyph->bearingY > height) 
 			{
-                col = padding;
-                row += maxRowHeight + padding;
-                maxRowHeight = 0;
+                height = glyph->bearingY;
+                baseYOffset = static_cast<float>(glyph->bearingY - glyph->bottomBearing);
             }
+        }
 
-            maxHeight = (uint32_t)std::max((int64_t)(fontFace->size->metrics.ascender - fontFace->size->metrics.descender) >> 6, height);
+        this->lineHeight = static_cast<uint32_t>(lineHeight);
 
-            for(FT_UInt y = 0; y < fontFace->glyph->bitmap.rows; y++) 
-			{
-                for(FT_UInt x = 0; x < fontFace->glyph->bitmap.width; x++) 
-				{
-                    FT_UInt indexA = (row + y) * textureWidth + col + x;
-                    FT_UInt indexB = y * fontFace->glyph->bitmap.width + x;
-                    textureData[indexA] = fontFace->glyph->bitmap.buffer[indexB];
-                }
-            }
+        return true;
+    }
 
-            Glyph* glyph = &glyphs[index++];
-            glyph->sizeX = fontFace->glyph->bitmap.width;
-            glyph->sizeY = fontFace->glyph->bitmap.rows;
-            glyph->advanceX = fontFace->glyph->advance.x >> 6;
-            glyph->advanceY = fontFace->glyph->advance.y >> 6;
-            glyph->bearingX = fontFace->glyph->bitmap_left;
-            glyph->bearingY = fontFace->glyph->bitmap_top;
-            glyph->height = fontFace->glyph->metrics.height >> 6;
-            glyph->bottomBearing = (fontFace->glyph->bitmap.rows - fontFace->glyph->bitmap_top);
-            glyph->leftBearing = (fontFace->glyph->bitmap.width - fontFace->glyph->bitmap_left);
+    Glyph *Font::RasterizeGlyph(uint32_t codepoint)
+    {
+        FT_Face fontFace = data->face;
 
-            lineHeight = std::max(glyph->height, lineHeight);
+        if(FT_Get_Char_Index(fontFace, codepoint) == 0)
+            return nullptr;
 
-            glyph->u0 = static_cast<float>(col) / textureWidth;
-            glyph->v0 = static_cast<float>(row) / textureHeight;
-            glyph->u1 = static_cast<float>(col + fontFace->glyph->bitmap.width) / textureWidth;
-            glyph->v1 = static_cast<float>(row + fontFace->glyph->bitmap.rows) / textureHeight;
+        if(FT_Load_Char(fontFace, codepoint, FT_LOAD_RENDER))
+            return nullptr;
 
-            col += fontFace->glyph->bitmap.width + padding;
-        }
+        if(FT_Render_Glyph(fontFace->glyph, renderMethod == FontRenderMethod::Normal ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_SDF))
+            return nullptr;
 
-        this->lineHeight = static_cast<uint32_t>(lineHeight);
+        const FT_Bitmap &bitmap = fontFace->glyph->bitmap;
+
+        Glyph glyph;
+        glyph.sizeX = bitmap.width;
+        glyph.sizeY = bitmap.rows;
+        glyph.advanceX = fontFace->glyph->advance.x >> 6;
+        glyph.advanceY = fontFace->glyph->advance.y >> 6;
+        glyph.bearingX = fontFace->glyph->bitmap_left;
+        glyph.bearingY = fontFace->glyph->bitmap_top;
+        glyph.height = fontFace->glyph->metrics.height >> 6;
+        glyph.bottomBearing = (bitmap.rows - fontFace->glyph->bitmap_top);
+        glyph.leftBearing = (bitmap.width - fontFace->glyph->bitmap_left);
+
+        //Bitmap rows may be padded by FreeType
+        data->bitmap.resize(bitmap.width * bitmap.rows);
+
+        for(FT_UInt y = 0; y < bitmap.rows; y++) 
+        {
+            const uint8_t *pSrc = bitmap.buffer + y * bitmap.pitch;
+            memcpy(&data->bitmap[y * bitmap.width], pSrc, bitmap.width);
+        }
 
-        return true;
+        return data->atlas.Insert(codepoint, glyph, data->bitmap.data(), bitmap.width, bitmap.rows, frameIndex);
     }
 
     bool Font::GenerateTexture() 
 	{
-        if(textureId > 0) {
+        if(!data)
+        {
+            std::cerr << "Could not generate texture because font is not loaded\n";
+            return false;
+        }
+
+        if(data->textures.size() > 0) {
             std::cerr << "Could not generate texture because it is already generated\n";
             return false;
         }
 
-        const uint32_t textureWidth = 1024;
-        const uint32_t textureHeight = 1024;
+        UpdateTextures();
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        return data->textures.size() > 0 && data->textures[0] > 0;
+    }
 
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, textureWidth, textureHeight, 0, GL_RED, GL_UNSIGNED_BYTE, textureData.data());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, 0);
+    void Font::UpdateTextures()
+    {
+        if(!data)
+            return;
 
-        //Image::saveAsPNG("test.png", textureData.data(), textureData.size(), textureWidth, textureHeight, 1);
+        GlyphAtlas &atlas = data->atlas;
+        const uint32_t textureWidth = atlas.GetPageWidth();
+        const uint32_t textureHeight = atlas.GetPageHeight();
+        bool unpackStateChanged = false;
 
-        return textureId > 0;
+        for(size_t i = 0; i < atlas.GetPageCount(); i++)
+        {
+            GlyphAtlasPage *page = atlas.GetPage(i);
+
+            if(i < data->textures.size() && page->dirtyRect.IsEmpty())
+                continue;
+
+            if(!unpackStateChanged)
+            {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, textureWidth);
+                unpackStateChanged = true;
+            }
+
+            if(i >= data->textures.size())
+            {
+                uint32_t textureId = 0;
+                glGenTextures(1, &textureId);
+                glBindTexture(GL_TEXTURE_2D, textureId);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, textureWidth, textureHeight, 0, GL_RED, GL_UNSIGNED_BYTE, page->pixels.data());
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                data->textures.push_back(textureId);
+            }
+            else
+            {
+                //Only the region touched since the last upload is sent
+                const GlyphAtlasRect &rect = page->dirtyRect;
+                glBindTexture(GL_TEXTURE_2D, data->textures[i]);
+                glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x);
+                glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, GL_RED, GL_UNSIGNED_BYTE, page->pixels.data());
+            }
+
+            page->dirtyRect = GlyphAtlasRect();
+        }
+
+        if(unpackStateChanged)
+        {
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
     }
 
     void Font::Destroy() 
 	{
-        if(textureId > 0) 
-		{
-            glDeleteTextures(1, &textureId);
-            textureId = 0;
-        }
-        if(textureData.size() > 0) 
+        if(data) 
 		{
-            textureData.clear();
+            if(data->textures.size() > 0)
+            {
+                glDeleteTextures(static_cast<GLsizei>(data->textures.size()), data->textures.data());
+                data->textures.clear();
+            }
+            TextLayoutCache::Remove(data->id);
+            data.reset();
         }
     }
 
+    void Font::NewFrame()
+    {
+        frameIndex++;
+    }
+
+    void Font::MarkPageUsed(uint32_t page)
+    {
+        if(data)
+            data->atlas.MarkPageUsed(page, frameIndex);
+    }
+
+    GlyphAtlas *Font::GetAtlas() const
+    {
+        return data ? &data->atlas : nullptr;
+    }
+
+    //Unique for every loaded font and never reused, copies of a font share it
+    uint64_t Font::GetId() const
+    {
+        return data ? data->id : 0;
+    }
+
     uint32_t Font::GetPixelSize() const 
 	{
         return pixelSize;
@@ -276,15 +375,41 @@ namespace GFX
 
     uint32_t Font::GetTexture() const 
 	{
-        return textureId;
+        return GetTexture(0);
+    }
+
+    uint32_t Font::GetTexture(uint32_t page) const 
+	{
+        if(!data || page >= data->textures.size())
+            return 0;
+        return data->textures[page];
     }
 
     Glyph *Font::GetGlyph(char c) 
 	{
-        uint32_t index = (c - codePointOfFirstChar);
-        if(index >= glyphs.size())
+        return FindGlyph(static_cast<uint8_t>(c));
+    }
+
+    Glyph *Font::FindGlyph(uint32_t codepoint) 
+	{
+        if(!data)
+            return nullptr;
+
+        Glyph *glyph = data->atlas.Find(codepoint, frameIndex);
+
+        if(glyph != nullptr)
+            return glyph;
+
+        if(data->missingGlyphs.contains(codepoint))
             return nullptr;
-        return &glyphs[index];
+
+        glyph = RasterizeGlyph(codepoint);
+
+        //Glyphs that can't be rasterized or packed are only skipped when the face doesn't have them
+        if(glyph == nullptr && FT_Get_Char_Index(data->face, codepoint) == 0)
+            data->missingGlyphs.insert(codepoint);
+
+        return glyph;
     }
 
     uint32_t Font::GetCodePointOfFirstChar() const 
@@ -302,9 +427,9 @@ namespace GFX
         int32_t currentHeight = 0;
         int32_t lineCount = 1; // Count of lines
 
-        for(size_t i = 0; i < size; i++) 
+        for(size_t i = 0; i < size;) 
 		{
-            char c = text[i];
+            uint32_t c = String::DecodeUTF8(text, size, i);
 
             if (c == '\n') 
 			{
@@ -320,7 +445,7 @@ namespace GFX
                 continue;
             }
 
-            Glyph *glyph = GetGlyph(c);
+            Glyph *glyph = FindGlyph(c);
 
             if (!glyph)
                 continue;
@@ -366,9 +491,9 @@ namespace GFX
         float characterPosY = y;
 
         // Calculate the character position based on the character index
-        for (int i = 0; i < characterIndex; ++i) 
+        for (size_t i = 0; i < characterIndex && i < size;) 
 		{
-            char ch = text[i];
+            uint32_t ch = String::DecodeUTF8(text, size, i);
 
             // Handle line breaks
             if (ch == '\n') 
@@ -378,7 +503,7 @@ namespace GFX
                 continue;
             }
 
-            Glyph *glyph = GetGlyph(ch);
+            Glyph *glyph = FindGlyph(ch);
             if(!glyph)
                 continue;
 
@@ -395,11 +520,13 @@ namespace GFX
         float height = 0.0f;
         float yOffset = 0.0f;
         
-        for(size_t i = 0; i < size; i++) {
-            if(text[i] == '\n')
+        for(size_t i = 0; i < size;) {
+            uint32_t codepoint = String::DecodeUTF8(text, size, i);
+
+            if(codepoint == '\n')
                 break;
 
-            Glyph *glyph = GetGlyph(text[i]);
+            Glyph *glyph = FindGlyph(codepoint);
             
             if(!glyph)
                 continue;            
@@ -417,28 +544,7 @@ namespace GFX
 
 	float Font::CalculateYOffset(float fontSize) const
 	{
-		float height = 0.0f;
-		float yOffset = 0.0f;
-
-		char nl = '\n';
-		uint32_t newLine = static_cast<uint32_t>(nl);
-		uint32_t newLineIndex = (newLine - codePointOfFirstChar);
-		
-		for(size_t i = 0; i < glyphs.size(); i++) 
-		{
-			if(i == newLineIndex)
-				continue;
-
-			float h = glyphs[i].bearingY;
-
-			if(h > height) 
-			{
-				height = h;
-				yOffset = (glyphs[i].bearingY - glyphs[i].bottomBearing) * GetPixelScale(fontSize);
-			}
-		}
-
-		return yOffset;
+		return baseYOffset * GetPixelScale(fontSize);
 	}
 
     float Font::GetPixelScale(float fontSize) const 
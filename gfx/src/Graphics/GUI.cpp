@@ -2,6 +2,7 @@
 #include "../Core/Constants.hpp"
 #include "../Core/Resources.hpp"
 #include "Graphics2D.hpp"
+#include "TextLayoutCache.hpp"
 #include <cstring>
 
 namespace GFX
@@ -159,9 +160,7 @@ namespace GFX
 
 	Vector2 GUI::CalculateTextSize(const std::string &text, float fontSize)
 	{
-		Vector2 bounds;
-		font->CalculateBounds(text.c_str(), text.size(), fontSize, bounds.x, bounds.y);
-		return bounds;
+		return TextLayoutCache::GetBounds(font, text, fontSize);
 	}
 
 	Vector2 GUI::CalculateCenteredPosition(const Rectangle &rect, const Vector2 &size)
@@ -809,9 +808,7 @@ namespace GFX
 	Vector2 GUI::CalculateTextSize(const std::string &text)
 	{
 		Initialize();
-		Vector2 size;
-		font->CalculateBounds(text.c_str(), text.size(), style.fontSize, size.x, size.y);
-		return size;
+		return TextLayoutCache::GetBounds(font, text, style.fontSize);
 	}
 
 	float GUI::CalculateTextWidth(const std::string &text)
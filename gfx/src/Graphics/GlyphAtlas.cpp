@@ -0,0 +1,401 @@
+#include "GlyphAtlas.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace GFX
+{
+    GlyphAtlasRect::GlyphAtlasRect()
+    {
+        x = 0;
+        y = 0;
+        width = 0;
+        height = 0;
+    }
+
+    GlyphAtlasRect::GlyphAtlasRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+    {
+        this->x = x;
+        this->y = y;
+        this->width = width;
+        this->height = height;
+    }
+
+    bool GlyphAtlasRect::IsEmpty() const
+    {
+        return width == 0 || height == 0;
+    }
+
+    void GlyphAtlasRect::Merge(const GlyphAtlasRect &other)
+    {
+        if(other.IsEmpty())
+            return;
+
+        if(IsEmpty())
+        {
+            *this = other;
+            return;
+        }
+
+        uint32_t minX = std::min(x, other.x);
+        uint32_t minY = std::min(y, other.y);
+        uint32_t maxX = std::max(x + width, other.x + other.width);
+        uint32_t maxY = std::max(y + height, other.y + other.height);
+        x = minX;
+        y = minY;
+        width = maxX - minX;
+        height = maxY - minY;
+    }
+
+    SkylinePacker::SkylinePacker()
+    {
+        width = 0;
+        height = 0;
+        usedArea = 0;
+    }
+
+    SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+    {
+        Reset(width, height);
+    }
+
+    void SkylinePacker::Reset(uint32_t width, uint32_t height)
+    {
+        this->width = width;
+        this->height = height;
+        this->usedArea = 0;
+        nodes.clear();
+        nodes.push_back({0, 0, width});
+    }
+
+    bool SkylinePacker::Fit(size_t index, uint32_t width, uint32_t height, uint32_t &y) const
+    {
+        uint32_t x = nodes[index].x;
+
+        if(x + width > this->width)
+            return false;
+
+        int64_t widthLeft = width;
+        y = nodes[index].y;
+
+        while(widthLeft > 0)
+        {
+            if(index >= nodes.size())
+                return false;
+
+            y = std::max(y, nodes[index].y);
+
+            if(y + height > this->height)
+                return false;
+
+            widthLeft -= nodes[index].width;
+            index++;
+        }
+
+        return true;
+    }
+
+    bool SkylinePacker::Pack(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y)
+    {
+        if(width == 0 || height == 0)
+            return false;
+
+        size_t bestIndex = SIZE_MAX;
+        uint32_t bestBottom = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+        uint32_t bestX = 0;
+        uint32_t bestY = 0;
+
+        for(size_t i = 0; i < nodes.size(); i++)
+        {
+            uint32_t nodeY = 0;
+
+            if(!Fit(i, width, height, nodeY))
+                continue;
+
+            uint32_t bottom = nodeY + height;
+
+            if(bottom < bestBottom || (bottom == bestBottom && nodes[i].width < bestWidth))
+            {
+                bestIndex = i;
+                bestBottom = bottom;
+                bestWidth = nodes[i].width;
+                bestX = nodes[i].x;
+                bestY = nodeY;
+            }
+        }
+
+        if(bestIndex == SIZE_MAX)
+            return false;
+
+        nodes.insert(nodes.begin() + bestIndex, {bestX, bestY + height, width});
+
+        //Shrink or remove the nodes now covered by the new one
+        for(size_t i = bestIndex + 1; i < nodes.size(); i++)
+        {
+            uint32_t previousRight = nodes[i-1].x + nodes[i-1].width;
+
+            if(nodes[i].x >= previousRight)
+                break;
+
+            uint32_t shrink = previousRight - nodes[i].x;
+
+            if(nodes[i].width > shrink)
+            {
+                nodes[i].x += shrink;
+                nodes[i].width -= shrink;
+                break;
+            }
+
+            nodes.erase(nodes.begin() + i);
+            i--;
+        }
+
+        //Merge neighbours at the same height
+        for(size_t i = 0; i + 1 < nodes.size(); i++)
+        {
+            if(nodes[i].y == nodes[i+1].y)
+            {
+                nodes[i].width += nodes[i+1].width;
+                nodes.erase(nodes.begin() + i + 1);
+                i--;
+            }
+        }
+
+        x = bestX;
+        y = bestY;
+        usedArea += static_cast<uint64_t>(width) * height;
+        return true;
+    }
+
+    uint32_t SkylinePacker::GetWidth() const
+    {
+        return width;
+    }
+
+    uint32_t SkylinePacker::GetHeight() const
+    {
+        return height;
+    }
+
+    uint64_t SkylinePacker::GetUsedArea() const
+    {
+        return usedArea;
+    }
+
+    GlyphAtlas::GlyphAtlas()
+    {
+        pageWidth = 0;
+        pageHeight = 0;
+        maxPages = 0;
+        padding = 0;
+        evictionCount = 0;
+    }
+
+    void GlyphAtlas::Initialize(uint32_t pageWidth, uint32_t pageHeight, uint32_t maxPages, uint32_t padding)
+    {
+        this->pageWidth = pageWidth;
+        this->pageHeight = pageHeight;
+        this->maxPages = std::max(maxPages, 1U);
+        this->padding = padding;
+        Clear();
+    }
+
+    void GlyphAtlas::Clear()
+    {
+        glyphs.clear();
+        pages.clear();
+        directLookup.assign(DIRECT_LOOKUP_SIZE, nullptr);
+        evictionCount = 0;
+    }
+
+    Glyph *GlyphAtlas::Find(uint32_t codepoint, uint64_t frame)
+    {
+        Glyph *glyph = nullptr;
+
+        if(codepoint < directLookup.size())
+        {
+            glyph = directLookup[codepoint];
+        }
+        else
+        {
+            auto it = glyphs.find(codepoint);
+            if(it != glyphs.end())
+                glyph = &it->second;
+        }
+
+        if(glyph != nullptr && glyph->page < pages.size())
+            pages[glyph->page].lastUsedFrame = frame;
+
+        return glyph;
+    }
+
+    Glyph *GlyphAtlas::Insert(uint32_t codepoint, const Glyph &metrics, const uint8_t *bitmap, uint32_t bitmapWidth, uint32_t bitmapHeight, uint64_t frame)
+    {
+        if(Contains(codepoint))
+            return Find(codepoint, frame);
+
+        Glyph glyph = metrics;
+        glyph.page = NO_PAGE;
+        glyph.u0 = glyph.v0 = glyph.u1 = glyph.v1 = 0.0f;
+
+        //Glyphs without a bitmap (e.g. spaces) only need their metrics
+        if(bitmapWidth > 0 && bitmapHeight > 0 && bitmap != nullptr)
+        {
+            uint32_t page = 0;
+            uint32_t x = 0;
+            uint32_t y = 0;
+
+            if(!Allocate(bitmapWidth + padding, bitmapHeight + padding, frame, page, x, y))
+                return nullptr;
+
+            GlyphAtlasPage &atlasPage = pages[page];
+
+            for(uint32_t row = 0; row < bitmapHeight; row++)
+            {
+                uint8_t *pDst = &atlasPage.pixels[(y + row) * pageWidth + x];
+                const uint8_t *pSrc = &bitmap[row * bitmapWidth];
+                memcpy(pDst, pSrc, bitmapWidth);
+            }
+
+            atlasPage.dirtyRect.Merge(GlyphAtlasRect(x, y, bitmapWidth, bitmapHeight));
+            atlasPage.lastUsedFrame = frame;
+            atlasPage.glyphCount++;
+
+            glyph.page = page;
+            glyph.u0 = static_cast<float>(x) / pageWidth;
+            glyph.v0 = static_cast<float>(y) / pageHeight;
+            glyph.u1 = static_cast<float>(x + bitmapWidth) / pageWidth;
+            glyph.v1 = static_cast<float>(y + bitmapHeight) / pageHeight;
+        }
+
+        Glyph *pGlyph = &glyphs.emplace(codepoint, glyph).first->second;
+
+        if(codepoint < directLookup.size())
+            directLookup[codepoint] = pGlyph;
+
+        return pGlyph;
+    }
+
+    bool GlyphAtlas::Contains(uint32_t codepoint) const
+    {
+        return glyphs.contains(codepoint);
+    }
+
+    bool GlyphAtlas::Allocate(uint32_t width, uint32_t height, uint64_t frame, uint32_t &page, uint32_t &x, uint32_t &y)
+    {
+        if(width > pageWidth || height > pageHeight)
+            return false;
+
+        for(size_t i = 0; i < pages.size(); i++)
+        {
+            if(pages[i].packer.Pack(width, height, x, y))
+            {
+                page = static_cast<uint32_t>(i);
+                return true;
+            }
+        }
+
+        if(pages.size() < maxPages)
+        {
+            AddPage();
+            page = static_cast<uint32_t>(pages.size() - 1);
+            return pages[page].packer.Pack(width, height, x, y);
+        }
+
+        //Glyphs referenced in the current frame may already be in a vertex buffer, so their page is kept
+        uint32_t leastRecentlyUsed = NO_PAGE;
+
+        for(size_t i = 0; i < pages.size(); i++)
+        {
+            if(pages[i].lastUsedFrame >= frame)
+                continue;
+            if(leastRecentlyUsed == NO_PAGE || pages[i].lastUsedFrame < pages[leastRecentlyUsed].lastUsedFrame)
+                leastRecentlyUsed = static_cast<uint32_t>(i);
+        }
+
+        if(leastRecentlyUsed == NO_PAGE)
+            return false;
+
+        EvictPage(leastRecentlyUsed);
+        page = leastRecentlyUsed;
+        return pages[page].packer.Pack(width, height, x, y);
+    }
+
+    void GlyphAtlas::AddPage()
+    {
+        GlyphAtlasPage page;
+        page.packer.Reset(pageWidth, pageHeight);
+        page.pixels.resize(static_cast<size_t>(pageWidth) * pageHeight, 0);
+        page.dirtyRect = GlyphAtlasRect(0, 0, pageWidth, pageHeight);
+        page.lastUsedFrame = 0;
+        page.glyphCount = 0;
+        pages.push_back(std::move(page));
+    }
+
+    void GlyphAtlas::EvictPage(uint32_t page)
+    {
+        for(auto it = glyphs.begin(); it != glyphs.end();)
+        {
+            if(it->second.page == page)
+            {
+                if(it->first < directLookup.size())
+                    directLookup[it->first] = nullptr;
+                it = glyphs.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        GlyphAtlasPage &atlasPage = pages[page];
+        atlasPage.packer.Reset(pageWidth, pageHeight);
+        std::fill(atlasPage.pixels.begin(), atlasPage.pixels.end(), 0);
+        atlasPage.dirtyRect = GlyphAtlasRect(0, 0, pageWidth, pageHeight);
+        atlasPage.glyphCount = 0;
+        evictionCount++;
+    }
+
+    void GlyphAtlas::MarkPageUsed(uint32_t page, uint64_t frame)
+    {
+        if(page < pages.size())
+            pages[page].lastUsedFrame = frame;
+    }
+
+    GlyphAtlasPage *GlyphAtlas::GetPage(size_t index)
+    {
+        if(index >= pages.size())
+            return nullptr;
+        return &pages[index];
+    }
+
+    size_t GlyphAtlas::GetPageCount() const
+    {
+        return pages.size();
+    }
+
+    uint32_t GlyphAtlas::GetPageWidth() const
+    {
+        return pageWidth;
+    }
+
+    uint32_t GlyphAtlas::GetPageHeight() const
+    {
+        return pageHeight;
+    }
+
+    uint32_t GlyphAtlas::GetMaxPages() const
+    {
+        return maxPages;
+    }
+
+    size_t GlyphAtlas::GetGlyphCount() const
+    {
+        return glyphs.size();
+    }
+
+    uint64_t GlyphAtlas::GetEvictionCount() const
+    {
+        return evictionCount;
+    }
+}
@@ -1,6 +1,8 @@
 #include "Graphics.hpp"
 #include "Texture2D.hpp"
 #include "Texture3D.hpp"
+#include "TextureStreamer.hpp"
+#include "ModelImporter.hpp"
 #include "Shader.hpp"
 #include "Font.hpp"
 #include "Mesh.hpp"
@@ -14,6 +16,10 @@
 #include "Shaders/PostProcessing/HorizontalBlurShader.hpp"
 #include "Shaders/PostProcessing/VerticalBlurShader.hpp"
 #include "Shaders/PostProcessing/GrayscaleShader.hpp"
+#include "Shaders/PostProcessing/TonemapShader.hpp"
+#include "Shaders/PostProcessing/BlurComputeShader.hpp"
+#include "Shaders/PostProcessing/BloomThresholdShader.hpp"
+#include "Shaders/PostProcessing/BloomCompositeShader.hpp"
 #include "Shaders/ParticleShader.hpp"
 #include "Shaders/ProceduralSkyboxShader.hpp"
 #include "Shaders/ProceduralSkybox2Shader.hpp"
@@ -37,6 +43,8 @@
 #include "Renderers/LineRenderer.hpp"
 #include "Renderers/PostProcessingRenderer.hpp"
 #include "Materials/DepthMaterial.hpp"
+#include "Materials/DiffuseMaterial.hpp"
+#include <algorithm>
 
 namespace GFX
 {
@@ -45,11 +53,14 @@ namespace GFX
 	ImGuiManager Graphics::imgui;
 	Shadow Graphics::shadow;
 	std::unique_ptr<DepthMaterial> Graphics::depthMaterial = nullptr;
+	std::unique_ptr<DiffuseMaterial> Graphics::fallbackMaterial = nullptr;
+	std::vector<Shader*> Graphics::compilingShaders;
 	std::vector<Renderer*> Graphics::renderers;
-	std::priority_queue<Renderer*, std::vector<Renderer*>, CompareRenderer> Graphics::renderQueue;
+	std::vector<Renderer*> Graphics::renderQueue;
+	bool Graphics::renderQueueDirty = false;
 	std::vector<FrameBufferObject> Graphics::framebuffers;
-	std::vector<Shader*> Graphics::postProcessingShaders;
 	PostProcessingRenderer Graphics::postProcessingRenderer;
+	PostProcessingGraph Graphics::postProcessingGraph;
 
 	void Graphics::Initialize(uint32_t width, uint32_t height, uint32_t displayWidth, uint32_t displayHeight)
 	{
@@ -82,16 +93,17 @@ namespace GFX
 
 		framebuffers.push_back(FrameBufferObject(width, height, true, true));
 		framebuffers.push_back(FrameBufferObject(width, height, false, true));
-		framebuffers.push_back(FrameBufferObject(width, height, false, true));
 
 		for(size_t i = 0; i < framebuffers.size(); i++)
 			framebuffers[i].Generate();
 
 		postProcessingRenderer.Generate();
+		postProcessingGraph.Initialize(&postProcessingRenderer);
 	}
 
 	void Graphics::Deinitialize()
 	{
+		postProcessingGraph.Deinitialize();
 		imgui.Deinitialize();
 		Graphics2D::Deinitialize();
 		LineRenderer::Deinitialize();
@@ -99,6 +111,9 @@ namespace GFX
 
 	void Graphics::NewFrame()
 	{
+		TextureStreamer::NewFrame();
+		ModelImporter::NewFrame();
+		UpdateShaders();
 		UpdateUniformBuffers();
 		RenderShadowPass();
 		Render3DPass();
@@ -106,6 +121,33 @@ namespace GFX
 		Render2DPass();
 	}
 
+	void Graphics::UpdateShaders()
+	{
+		Shader::UpdatePendingPrograms();
+
+		for(size_t i = 0; i < compilingShaders.size(); i++)
+		{
+			if(compilingShaders[i]->IsCompiling())
+				continue;
+
+			BindShaderToUniformBuffers(compilingShaders[i]);
+			compilingShaders.erase(compilingShaders.begin() + i);
+			i--;
+		}
+	}
+
+	void Graphics::RemoveCompilingShader(Shader *shader)
+	{
+		for(size_t i = 0; i < compilingShaders.size(); i++)
+		{
+			if(compilingShaders[i] == shader)
+			{
+				compilingShaders.erase(compilingShaders.begin() + i);
+				i--;
+			}
+		}
+	}
+
 	void Graphics::UpdateUniformBuffers()
 	{
 		Camera::UpdateUniformBuffer();
@@ -121,21 +163,39 @@ namespace GFX
 
 		auto camera = Camera::GetMain();
 
+		if(!depthMaterial->GetShader() || !depthMaterial->GetShader()->IsReady())
+			return;
+
         if(renderers.size() > 0 && camera != nullptr)
         {
-			auto queue = renderQueue;
+			bool cacheStaticCasters = Shadow::GetCacheStaticCasters();
+
+			UpdateRenderQueue();
 
-			shadow.Bind();
+			//Static casters are only drawn into cascades whose cached depth is out of date
+			if(cacheStaticCasters && shadow.BindStatic(depthMaterial.get()))
+			{
+				for(size_t i = 0; i < renderQueue.size(); i++)
+				{
+					Renderer* renderer = renderQueue[i];
+					if(renderer->GetCastShadows() && renderer->GetStatic())
+					{
+						renderer->OnRender(depthMaterial.get(), camera);
+					}
+				}
+			}
 
-            while (!queue.empty()) 
-            {
-                Renderer* renderer = queue.top();
-				if(renderer->GetCastShadows())
+			if(shadow.Bind(depthMaterial.get()))
+			{
+				for(size_t i = 0; i < renderQueue.size(); i++)
 				{
-                	renderer->OnRender(depthMaterial.get(), camera);
+					Renderer* renderer = renderQueue[i];
+					if(renderer->GetCastShadows() && !(cacheStaticCasters && renderer->GetStatic()))
+					{
+						renderer->OnRender(depthMaterial.get(), camera);
+					}
 				}
-                queue.pop();
-            }
+			}
 
 			shadow.Unbind();
         }
@@ -148,13 +208,11 @@ namespace GFX
 
 		if(renderers.size() > 0 && Camera::GetMain() != nullptr)
 		{
-			auto queue = renderQueue;
+			UpdateRenderQueue();
 
-			while (!queue.empty()) 
+			for(size_t i = 0; i < renderQueue.size(); i++)
 			{
-				Renderer* currentRenderer = queue.top();
-				currentRenderer->OnRender();
-				queue.pop();
+				renderQueue[i]->OnRender();
 			}
 		}
 
@@ -170,40 +228,17 @@ namespace GFX
 
 	void Graphics::RenderPostProcessingPass()
 	{
-		static Shader *shader = nullptr;
-
-		if(shader == nullptr)
-			shader = Resources::FindShader(Constants::GetString(ConstantString::ShaderPostProcessing));
-
-		uint32_t fbo = framebuffers[1].GetId();
-		uint32_t texture = framebuffers[1].GetTextureId();
+		auto &fbo = framebuffers[1];
 
-		if(postProcessingShaders.size() > 0)
-		{
-			uint32_t fbo1 = framebuffers[2].GetId();
-			uint32_t texture1 = framebuffers[1].GetTextureId();
-			
-			uint32_t fbo2 = framebuffers[1].GetId();
-			uint32_t texture2 = framebuffers[2].GetTextureId();
+		RenderTexture source;
+		source.fbo = fbo.GetId();
+		source.textureId = fbo.GetTextureId();
+		source.width = fbo.GetWidth();
+		source.height = fbo.GetHeight();
+		source.allocatedWidth = fbo.GetAllocatedWidth();
+		source.allocatedHeight = fbo.GetAllocatedHeight();
 
-			for(size_t i = 0; i < postProcessingShaders.size(); i++)
-			{
-				postProcessingRenderer.Render(fbo, postProcessingShaders[i]->GetId(), texture);
-				
-				if(i % 2 == 1)
-				{
-					fbo = fbo2;
-					texture = texture2;
-				}
-				else
-				{
-					fbo = fbo1;
-					texture = texture1;
-				}
-			}
-		}
-
-		postProcessingRenderer.Render(0, shader->GetId(), texture);
+		postProcessingGraph.Render(source, 0, viewport.width, viewport.height);
 	}
 
 	void Graphics::Render2DPass()
@@ -248,6 +283,11 @@ namespace GFX
 		return viewport;
 	}
 
+	Material *Graphics::GetFallbackMaterial()
+	{
+		return fallbackMaterial.get();
+	}
+
 	void Graphics::CreateUniformBuffers()
 	{
 		auto sCamera = Constants::GetString(ConstantString::UniformBufferCamera);
@@ -288,6 +328,10 @@ namespace GFX
 		auto horizontalBlurShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderHorizontalBlur), HorizontalBlurShader::Create());
 		auto verticalBlurShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderVerticalBlur), VerticalBlurShader::Create());
 		auto grayscaleShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderGrayscale), GrayscaleShader::Create());
+		auto tonemapShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderTonemap), TonemapShader::Create());
+		auto bloomThresholdShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderBloomThreshold), BloomThresholdShader::Create());
+		auto bloomCompositeShader = Resources::AddShader(Constants::GetString(ConstantString::ShaderBloomComposite), BloomCompositeShader::Create());
+		Resources::AddShader(Constants::GetString(ConstantString::ShaderBlurCompute), BlurComputeShader::Create());
 
 		BindShaderToUniformBuffers(diffuseShader);
 		BindShaderToUniformBuffers(depthShader);
@@ -302,8 +346,12 @@ namespace GFX
 		BindShaderToUniformBuffers(horizontalBlurShader);
 		BindShaderToUniformBuffers(verticalBlurShader);
 		BindShaderToUniformBuffers(grayscaleShader);
+		BindShaderToUniformBuffers(tonemapShader);
+		BindShaderToUniformBuffers(bloomThresholdShader);
+		BindShaderToUniformBuffers(bloomCompositeShader);
 
 		depthMaterial = std::make_unique<DepthMaterial>();
+		fallbackMaterial = std::make_unique<DiffuseMaterial>();
 
 		shadow.Generate();
 	}
@@ -357,6 +405,13 @@ namespace GFX
 			return;
 		}
 
+		// Querying uniform blocks would block on the driver, so binding is deferred until the program has linked
+		if(shader->IsCompiling())
+		{
+			compilingShaders.push_back(shader);
+			return;
+		}
+
 		auto sCamera = Constants::GetString(ConstantString::UniformBufferCamera);
 		auto sLights = Constants::GetString(ConstantString::UniformBufferLights);
 		auto sShadow = Constants::GetString(ConstantString::UniformBufferShadow);
@@ -378,56 +433,52 @@ namespace GFX
         if(!renderer)
             return;
 
-        for(size_t i = 0; i < renderers.size(); i++)
+        if(renderer->rendererIndex != Renderer::INVALID_INDEX)
         {
-            if(renderers[i] == renderer)
-            {
-                Debug::WriteError("[RENDERER] can't add with ID: %llu because it already exists", renderer->GetInstanceId());
-                return;
-            }
+            Debug::WriteError("[RENDERER] can't add with ID: %llu because it already exists", renderer->GetInstanceId());
+            return;
         }
 
         Debug::WriteLog("[RENDERER] added with ID: %llu", renderer->GetInstanceId());
 
+        renderer->rendererIndex = static_cast<uint32_t>(renderers.size());
         renderers.push_back(renderer);
+        renderQueueDirty = true;
 
-        renderQueue.push(renderer);
+        if(renderer->GetStatic() && renderer->GetCastShadows())
+            Shadow::InvalidateStaticCasters();
 	}
 	
 	void Graphics::Remove(Renderer *renderer)
 	{
-        if(!renderer)
+        if(!renderer || renderer->rendererIndex == Renderer::INVALID_INDEX)
             return;
 
-        size_t index = 0;
-        bool found = false;
+        Debug::WriteLog("[RENDERER] removed with ID: %llu", renderer->GetInstanceId());
 
-        for(size_t i = 0; i < renderers.size(); i++)
-        {
-            if(renderers[i] == renderer)
-            {
-                index = i;
-                found = true;
-                break;
-            }
-        }
+        //Swap with the last renderer, the render queue is sorted again before it is used
+        Renderer *last = renderers.back();
+        renderers[renderer->rendererIndex] = last;
+        last->rendererIndex = renderer->rendererIndex;
+        renderers.pop_back();
+        renderer->rendererIndex = Renderer::INVALID_INDEX;
+        renderQueueDirty = true;
 
-        if(found)
-        {
-            Debug::WriteLog("[RENDERER] removed with ID: %llu", renderer->GetInstanceId());
-            renderers.erase(renderers.begin() + index);
-
-            //Clear render queue and recreate
-            while(!renderQueue.empty())
-            {
-                renderQueue.pop();
-            }
-
-            for(size_t i = 0; i < renderers.size(); i++)
-            {
-                renderQueue.push(renderers[i]);
-            }
-        }
+        if(renderer->GetStatic() && renderer->GetCastShadows())
+            Shadow::InvalidateStaticCasters();
+	}
+
+	void Graphics::UpdateRenderQueue()
+	{
+		if(!renderQueueDirty)
+			return;
+
+		//Lower render order draws first, equal orders keep the order they were added in
+		renderQueue = renderers;
+		std::stable_sort(renderQueue.begin(), renderQueue.end(), [] (const Renderer *a, const Renderer *b) {
+			return a->GetRenderOrder() < b->GetRenderOrder();
+		});
+		renderQueueDirty = false;
 	}
 
 	void Graphics::AddPostProcessingShader(Shader *shader)
@@ -435,7 +486,7 @@ namespace GFX
         if(!shader)
             return;
 
-        postProcessingShaders.push_back(shader);
+        postProcessingGraph.Add(PostProcessingPass::CreateShader(shader));
 	}
 
 	void Graphics::RemovePostProcessingShader(Shader *shader)
@@ -443,23 +494,17 @@ namespace GFX
         if(!shader)
             return;
 
-        size_t index = 0;
-        bool found = false;
+        postProcessingGraph.Remove(shader);
+	}
 
-        for(size_t i = postProcessingShaders.size() -1; i >= 0; i--)
-        {
-            if(postProcessingShaders[i] == shader)
-            {
-                index = i;
-                found = true;
-                break;
-            }
-        }
+	void Graphics::AddPostProcessingPass(const PostProcessingPass &pass)
+	{
+		postProcessingGraph.Add(pass);
+	}
 
-        if(found)
-        {
-            postProcessingShaders.erase(postProcessingShaders.begin() + index);
-        }
+	PostProcessingGraph *Graphics::GetPostProcessingGraph()
+	{
+		return &postProcessingGraph;
 	}
 
     Renderer *Graphics::GetRendererByIndex(size_t index)
@@ -2,19 +2,26 @@
 #include "../External/glad/glad.h"
 #include "Graphics.hpp"
 #include "../Core/Time.hpp"
+#include "TextLayoutCache.hpp"
 #include <cstdlib>
+#include <algorithm>
 
 namespace GFX
 {
 	uint32_t Graphics2D::VAO = 0;
 	uint32_t Graphics2D::VBO = 0;
 	uint32_t Graphics2D::EBO = 0;
+	uint32_t Graphics2D::flagsVBO = 0;
 	uint32_t Graphics2D::shaderId = 0;
 	uint32_t Graphics2D::textureId = 0;
 	std::vector<uint32_t> Graphics2D::uniforms;
 	std::vector<DrawListItem> Graphics2D::items;
 	std::vector<Vertex2D> Graphics2D::vertices;
 	std::vector<uint32_t> Graphics2D::indices;
+	std::vector<uint32_t> Graphics2D::vertexFlags;
+	std::vector<DrawBatch> Graphics2D::batches;
+	std::unordered_map<uint32_t,Graphics2DShaderUniforms> Graphics2D::shaderUniforms;
+	uint32_t Graphics2D::maxTextureSlots = GRAPHICS2D_MAX_TEXTURE_SLOTS;
 	uint32_t Graphics2D::itemCount = 0;
 	uint32_t Graphics2D::vertexCount = 0;
 	uint32_t Graphics2D::indiceCount = 0;
@@ -23,13 +30,18 @@ namespace GFX
 	std::vector<TextColorInfo> Graphics2D::textColorInfoTemp;
 	GLStateInfo Graphics2D::glState;
 	uint32_t Graphics2D::numDrawCalls = 0;
+	uint32_t Graphics2D::numItemsSubmitted = 0;
 	UniformUpdateCallback Graphics2D::onUniformUpdate = nullptr;
 
+	static constexpr uint32_t VERTEX_FLAG_FONT = 1 << 8;
+	static constexpr uint32_t VERTEX_FLAG_SDF = 1 << 9;
+
     void Graphics2D::Initialize() 
 	{        
 		VAO = 0;
 		VBO = 0;
 		EBO = 0;
+		flagsVBO = 0;
 		shaderId = 0;
 		textureId = 0;
 		uniforms.resize(Uniform_COUNT);
@@ -37,8 +49,13 @@ namespace GFX
 		vertexCount = 0;
 		indiceCount = 0;
 		numDrawCalls = 0;
+		numItemsSubmitted = 0;
 		onUniformUpdate = nullptr;
 
+		int32_t maxTextureUnits = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+		maxTextureSlots = maxTextureUnits > 0 ? std::min((uint32_t)maxTextureUnits, GRAPHICS2D_MAX_TEXTURE_SLOTS) : 1;
+
 		CreateBuffers();
 		CreateShader();
 		CreateTexture();
@@ -64,9 +81,15 @@ namespace GFX
             EBO = 0;
         }
 
+        if(flagsVBO > 0) 
+		{
+            glDeleteBuffers(1, &flagsVBO);
+            flagsVBO = 0;
+        }
+
         if(shaderId > 0) 
 		{
-            glDeleteShader(shaderId);
+            glDeleteProgram(shaderId);
             shaderId = 0;
         }
 
@@ -75,15 +98,26 @@ namespace GFX
             glDeleteTextures(1, &textureId);
             textureId = 0;
         }
+
+		shaderUniforms.clear();
     }
 
 	void Graphics2D::NewFrame()
 	{
-		numDrawCalls = itemCount;
+		numItemsSubmitted = itemCount;
+		numDrawCalls = 0;
+
+		Font::NewFrame();
+		TextLayoutCache::NewFrame();
 
 		if(itemCount == 0) 
 			return;
 
+		size_t numBatches = BuildDrawBatches(items.data(), itemCount, shaderId, maxTextureSlots, batches);
+		numDrawCalls = static_cast<uint32_t>(numBatches);
+
+		UpdateVertexFlags(numBatches);
+
 		auto viewport = Graphics::GetViewport();
 		float L = viewport.x;
 		float R = viewport.x + viewport.width;
@@ -99,6 +133,8 @@ namespace GFX
             { -(R + L) / (R - L), -(T + B) / (T - B), (far + near) / (far - near), 1.0f }
         };
 
+		float time = Time::GetTime();
+
 		StoreState();
 
         glDisable(GL_DEPTH_TEST);
@@ -110,21 +146,22 @@ namespace GFX
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(Vertex2D), vertices.data());
 
+        glBindBuffer(GL_ARRAY_BUFFER, flagsVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(uint32_t), vertexFlags.data());
+
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indiceCount * sizeof(uint32_t), indices.data());
 
-        uint32_t lastShaderId = items[0].shaderId;
-        glUseProgram(lastShaderId);
-        glActiveTexture(GL_TEXTURE0);
-
-        uint32_t lastTextureId = items[0].textureId;
-        glBindTexture(GL_TEXTURE_2D, lastTextureId);
+        uint32_t lastShaderId = 0;
+        bool defaultUniformsSet = false;
 
-		size_t drawOffset = 0; // Offset for the draw call
+        uint32_t boundTextures[GRAPHICS2D_MAX_TEXTURE_SLOTS];
+        std::fill(boundTextures, boundTextures + GRAPHICS2D_MAX_TEXTURE_SLOTS, UINT32_MAX);
 
-		for(size_t i = 0; i < itemCount; i++) 
+		for(size_t i = 0; i < numBatches; i++) 
 		{
-			Rectangle rect = items[i].clippingRect;
+			const DrawBatch &batch = batches[i];
+			Rectangle rect = batch.clippingRect;
 			bool scissorEnabled = false;
 
 			if(!rect.IsZero()) 
@@ -134,27 +171,32 @@ namespace GFX
                 scissorEnabled = true;
 			}
 
-			if(items[i].shaderId != lastShaderId) 
+			if(batch.shaderId != lastShaderId) 
 			{
-                glUseProgram(items[i].shaderId);
-                lastShaderId = items[i].shaderId;
+                glUseProgram(batch.shaderId);
+                lastShaderId = batch.shaderId;
 			}
 
-			if(items[i].textureId != lastTextureId) 
+			for(uint32_t j = 0; j < batch.textureCount; j++)
 			{
-                glBindTexture(GL_TEXTURE_2D, items[i].textureId);
-                lastTextureId = items[i].textureId;
+				if(boundTextures[j] != batch.textures[j])
+				{
+					glActiveTexture(GL_TEXTURE0 + j);
+					glBindTexture(GL_TEXTURE_2D, batch.textures[j]);
+					boundTextures[j] = batch.textures[j];
+				}
 			}
 
 			if(lastShaderId == shaderId) 
 			{
-				glUniform1i(uniforms[Uniform_Texture], 0);
-				glUniformMatrix4fv(uniforms[Uniform_Projection], 1, GL_FALSE, &projectionMatrix[0][0]);
-				glUniform1f(uniforms[Uniform_Time], Time::GetTime());
-				glUniform2f(uniforms[Uniform_Resolution], viewport.width, viewport.height);
-				// //These uniforms are only mandatory on default shader
-				glUniform1i(uniforms[Uniform_IsFont], items[i].textureIsFont ? 1 : 0);
-				glUniform1i(uniforms[Uniform_FontHasSDF], items[i].fontHasSDF ? 1 : 0);
+				//Sampler slots are assigned once in CreateShader
+				if(!defaultUniformsSet)
+				{
+					glUniformMatrix4fv(uniforms[Uniform_Projection], 1, GL_FALSE, &projectionMatrix[0][0]);
+					glUniform1f(uniforms[Uniform_Time], time);
+					glUniform2f(uniforms[Uniform_Resolution], viewport.width, viewport.height);
+					defaultUniformsSet = true;
+				}
 			}
 			else 
 			{
@@ -165,31 +207,31 @@ namespace GFX
 				//uTime
 				//uResolution
 
-				glUniform1i(glGetUniformLocation(lastShaderId, "uTexture"), 0);
-				glUniformMatrix4fv(glGetUniformLocation(lastShaderId, "uProjection"), 1, false, &projectionMatrix[0][0]);
-				glUniform1f(glGetUniformLocation(lastShaderId, "uTime"), Time::GetTime());
-				glUniform2f(glGetUniformLocation(lastShaderId, "uResolution"), viewport.width, viewport.height);
+				const Graphics2DShaderUniforms &locations = GetShaderUniforms(lastShaderId);
+				glUniform1i(locations.texture, 0);
+				glUniformMatrix4fv(locations.projection, 1, GL_FALSE, &projectionMatrix[0][0]);
+				glUniform1f(locations.time, time);
+				glUniform2f(locations.resolution, viewport.width, viewport.height);
 				
 				if(onUniformUpdate)
-					onUniformUpdate(lastShaderId, items[i].userData);
+					onUniformUpdate(lastShaderId, batch.userData);
 			}
 
-			if(items[i].textureIsFont)
+			if(batch.textureIsFont)
 				glDepthMask(false);
 			
-			glDrawElements(GL_TRIANGLES, items[i].indiceCount, GL_UNSIGNED_INT, (void*)(drawOffset * sizeof(uint32_t)));
+			glDrawElements(GL_TRIANGLES, batch.indiceCount, GL_UNSIGNED_INT, (void*)(batch.indiceOffset * sizeof(uint32_t)));
 			
-			if(items[i].textureIsFont)
+			if(batch.textureIsFont)
 				glDepthMask(true);
 
-			drawOffset += items[i].indiceCount;
-
 			if(scissorEnabled) 
 			{
 				glDisable(GL_SCISSOR_TEST);
 			}
 		}
 
+        glActiveTexture(GL_TEXTURE0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
@@ -204,6 +246,143 @@ namespace GFX
 		indiceCount = 0;
 	}
 
+	static bool IsSameClippingRect(const Rectangle &a, const Rectangle &b)
+	{
+		return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+	}
+
+	static bool CanMergeIntoBatch(const DrawBatch &batch, const DrawListItem &item, bool isDefaultShader, uint32_t maxTextureSlots, uint32_t &textureSlot)
+	{
+		if(batch.shaderId != item.shaderId)
+			return false;
+		if(batch.indiceOffset + batch.indiceCount != item.indiceOffset)
+			return false;
+		if(!IsSameClippingRect(batch.clippingRect, item.clippingRect))
+			return false;
+
+		for(uint32_t i = 0; i < batch.textureCount; i++)
+		{
+			if(batch.textures[i] == item.textureId)
+			{
+				textureSlot = i;
+				break;
+			}
+		}
+
+		if(isDefaultShader)
+		{
+			//Font flags and texture slot are per vertex, so only the number of distinct textures limits the batch
+			if(textureSlot == UINT32_MAX)
+			{
+				if(batch.textureCount >= maxTextureSlots)
+					return false;
+				textureSlot = batch.textureCount;
+			}
+			return true;
+		}
+
+		//Custom shaders sample a single uTexture and receive userData through the uniform callback
+		textureSlot = 0;
+		return batch.textures[0] == item.textureId && batch.userData == item.userData && batch.textureIsFont == item.textureIsFont;
+	}
+
+	size_t Graphics2D::BuildDrawBatches(DrawListItem *items, size_t itemCount, uint32_t defaultShaderId, uint32_t maxTextureSlots, std::vector<DrawBatch> &batches)
+	{
+		maxTextureSlots = std::clamp(maxTextureSlots, 1U, GRAPHICS2D_MAX_TEXTURE_SLOTS);
+		batches.clear();
+
+		for(size_t i = 0; i < itemCount; i++)
+		{
+			DrawListItem &item = items[i];
+			bool isDefaultShader = item.shaderId == defaultShaderId;
+
+			if(batches.size() > 0)
+			{
+				DrawBatch &batch = batches.back();
+				uint32_t textureSlot = UINT32_MAX;
+
+				if(CanMergeIntoBatch(batch, item, isDefaultShader, maxTextureSlots, textureSlot))
+				{
+					if(textureSlot == batch.textureCount)
+						batch.textures[batch.textureCount++] = item.textureId;
+					batch.indiceCount += item.indiceCount;
+					batch.itemCount++;
+					batch.textureIsFont = batch.textureIsFont || item.textureIsFont;
+					item.textureSlot = textureSlot;
+					continue;
+				}
+			}
+
+			DrawBatch batch;
+			batch.shaderId = item.shaderId;
+			batch.textures[0] = item.textureId;
+			batch.textureCount = 1;
+			batch.indiceOffset = item.indiceOffset;
+			batch.indiceCount = item.indiceCount;
+			batch.firstItem = static_cast<uint32_t>(i);
+			batch.itemCount = 1;
+			batch.textureIsFont = item.textureIsFont;
+			batch.clippingRect = item.clippingRect;
+			batch.userData = item.userData;
+			batches.push_back(batch);
+			item.textureSlot = 0;
+		}
+
+		return batches.size();
+	}
+
+	void Graphics2D::UpdateVertexFlags(size_t numBatches)
+	{
+		for(size_t i = 0; i < numBatches; i++)
+		{
+			const DrawBatch &batch = batches[i];
+
+			if(batch.shaderId != shaderId)
+				continue;
+
+			for(uint32_t j = batch.firstItem; j < batch.firstItem + batch.itemCount; j++)
+			{
+				const DrawListItem &item = items[j];
+				uint32_t flags = item.textureSlot;
+				if(item.textureIsFont)
+					flags |= VERTEX_FLAG_FONT;
+				if(item.fontHasSDF)
+					flags |= VERTEX_FLAG_SDF;
+				std::fill(vertexFlags.begin() + item.vertexOffset, vertexFlags.begin() + item.vertexOffset + item.vertexCount, flags);
+			}
+		}
+	}
+
+	const Graphics2DShaderUniforms &Graphics2D::GetShaderUniforms(uint32_t shaderId)
+	{
+		auto it = shaderUniforms.find(shaderId);
+
+		if(it != shaderUniforms.end())
+			return it->second;
+
+		Graphics2DShaderUniforms locations;
+		locations.texture = glGetUniformLocation(shaderId, "uTexture");
+		locations.projection = glGetUniformLocation(shaderId, "uProjection");
+		locations.time = glGetUniformLocation(shaderId, "uTime");
+		locations.resolution = glGetUniformLocation(shaderId, "uResolution");
+		return shaderUniforms.emplace(shaderId, locations).first->second;
+	}
+
+	void Graphics2D::ClearShaderUniforms(uint32_t shaderId)
+	{
+		shaderUniforms.erase(shaderId);
+	}
+
+	uint32_t Graphics2D::GetNumItemsSubmitted()
+	{
+		return numItemsSubmitted;
+	}
+
+	uint32_t Graphics2D::GetNumDrawCalls()
+	{
+		return numDrawCalls;
+	}
+
 	void Graphics2D::AddRectangle(const Vector2 &position, const Vector2 &size, float rotationDegrees, const Color &color, const Rectangle clippingRect, uint32_t shaderId, void *userData)
 	{
         Vertex2D vertices[4] = {
@@ -831,119 +1010,73 @@ namespace GFX
 		if(font == nullptr || text == nullptr || textLength == 0)
 			return;
 
-		size_t colorCount = 0;
-
-		std::string currentText = std::string(text, textLength);
+		const TextLayout *layout = TextLayoutCache::GetLayout(font, text, textLength, fontSize, richText);
 
-        auto containsBraces = [] (const std::string& text) -> bool {
-            return (text.find('{') != std::string::npos) && (text.find('}') != std::string::npos);
-        };
+		if(layout == nullptr)
+			return;
 
-		if(richText) 
-        {
-			if(containsBraces(currentText))
-			{
-				ParseColorsFromText(currentText, textColorInfoTemp, colorCount);
-			}
-		}
+		size_t glyphCount = layout->GetQuadCount();
 
-		size_t requiredVertices = currentText.size() * 4; // 4 vertices per character
-		size_t requiredIndices = currentText.size() * 6; // 6 indices per character
+		CheckTemporaryVertexBuffer(glyphCount * 4);
+		CheckTemporaryIndexBuffer(glyphCount * 6);
 
-		//Actual vertex count may be less if new line characters are present
-		CheckTemporaryVertexBuffer(requiredVertices);
+		for(size_t i = 0; i < glyphCount; i++)
+		{
+			const TextQuad &quad = layout->quads[i];
+			const Color &currentColor = quad.colorIndex >= 0 ? layout->markupColors[quad.colorIndex] : color;
+			Vector2 min = quad.min + position;
+			Vector2 max = quad.max + position;
 
-		//Actual indice count may be less if new line characters are present
-		CheckTemporaryIndexBuffer(requiredIndices);
-		
-		int vertexIndex = 0;
-		int indiceIndex = 0;
-		int colorIndex = 0;
-		Color currentColor = color;
-		
-		Vector2 pos(position.x, position.y);
-		pos.y += font->CalculateYOffset(fontSize);
-		
-		float originX = pos.x;
-		float originY = pos.y;
-		float scale = font->GetPixelScale(fontSize);
+			// top-right, top-left, bottom-left, bottom-right
+			vertexBufferTemp[i * 4 + 0] = Vertex2D(Vector2(max.x, max.y), Vector2(quad.uvMax.x, quad.uvMax.y), currentColor);
+			vertexBufferTemp[i * 4 + 1] = Vertex2D(Vector2(min.x, max.y), Vector2(quad.uvMin.x, quad.uvMax.y), currentColor);
+			vertexBufferTemp[i * 4 + 2] = Vertex2D(Vector2(min.x, min.y), Vector2(quad.uvMin.x, quad.uvMin.y), currentColor);
+			vertexBufferTemp[i * 4 + 3] = Vertex2D(Vector2(max.x, min.y), Vector2(quad.uvMax.x, quad.uvMin.y), currentColor);
+		}
 
-		for(size_t i = 0; i < currentText.size(); i++) {
-			char ch = currentText[i];
+		//Upload glyphs that were rasterized while laying out this text
+		font->UpdateTextures();
 
-			if(ch == '\n') 
-			{
-				pos.x = originX;
-				pos.y += font->GetMaxHeight() * scale;
-				continue;
-			}
+		//Glyphs can live on different atlas pages, so emit one command per run of glyphs sharing a page
+		size_t runStart = 0;
 
-			const Glyph *glyph = font->GetGlyph(ch);
+		while(runStart < glyphCount)
+		{
+			size_t runEnd = runStart + 1;
 
-			if(glyph == nullptr)
-				continue;
+			while(runEnd < glyphCount && layout->quads[runEnd].page == layout->quads[runStart].page)
+				runEnd++;
 
-			float xpos = pos.x + glyph->bearingX * scale;
-			float ypos = pos.y - glyph->bearingY * scale;
-			float w = glyph->sizeX * scale;
-			float h = glyph->sizeY * scale;
+			uint32_t runGlyphCount = static_cast<uint32_t>(runEnd - runStart);
 
-			// top-right, top-left, bottom-left, bottom-right
-			Vector2 glyphVertices[4] = 
-			{
-				Vector2(xpos + w, ypos + h),
-				Vector2(xpos,     ypos + h),
-				Vector2(xpos,     ypos),
-				Vector2(xpos + w, ypos)
-			};
-
-			Vector2 glyphTextureCoords[4] = {
-				Vector2(glyph->u1,  glyph->v1),
-				Vector2(glyph->u0,  glyph->v1),
-				Vector2(glyph->u0,  glyph->v0),
-				Vector2(glyph->u1,  glyph->v0)
-			};
-
-			if(colorCount > 0) 
+			for(uint32_t j = 0; j < runGlyphCount; j++)
 			{
-				if (colorIndex < colorCount && textColorInfoTemp[colorIndex].index == i) 
-				{
-					currentColor = textColorInfoTemp[colorIndex].color; // Update to the new color
-					colorIndex++; // Move to the next color
-				}
+				uint32_t vertexOffset = j * 4;
+				uint32_t *pIndices = &indexBufferTemp[(runStart + j) * 6];
+				pIndices[0] = 0 + vertexOffset; // Bottom-right
+				pIndices[1] = 2 + vertexOffset; // Top-left
+				pIndices[2] = 1 + vertexOffset; // Top-right
+				pIndices[3] = 0 + vertexOffset; // Bottom-right
+				pIndices[4] = 3 + vertexOffset; // Bottom-left
+				pIndices[5] = 2 + vertexOffset; // Top-left
 			}
 
-			vertexBufferTemp[vertexIndex+0] = Vertex2D(Vector2(glyphVertices[0].x, glyphVertices[0].y), glyphTextureCoords[0], currentColor);
-			vertexBufferTemp[vertexIndex+1] = Vertex2D(Vector2(glyphVertices[1].x, glyphVertices[1].y), glyphTextureCoords[1], currentColor);
-			vertexBufferTemp[vertexIndex+2] = Vertex2D(Vector2(glyphVertices[2].x, glyphVertices[2].y), glyphTextureCoords[2], currentColor);
-			vertexBufferTemp[vertexIndex+3] = Vertex2D(Vector2(glyphVertices[3].x, glyphVertices[3].y), glyphTextureCoords[3], currentColor);
-
-			indexBufferTemp[indiceIndex+0] = (uint32_t)(0 + vertexIndex); // Bottom-right
-			indexBufferTemp[indiceIndex+1] = (uint32_t)(2 + vertexIndex); // Top-left
-			indexBufferTemp[indiceIndex+2] = (uint32_t)(1 + vertexIndex); // Top-right
-			indexBufferTemp[indiceIndex+3] = (uint32_t)(0 + vertexIndex); // Bottom-right
-			indexBufferTemp[indiceIndex+4] = (uint32_t)(3 + vertexIndex); // Bottom-left
-			indexBufferTemp[indiceIndex+5] = (uint32_t)(2 + vertexIndex); // Top-left
-
-			vertexIndex += 4;
-			indiceIndex += 6;
-
-			pos.x += glyph->advanceX * scale;
+			DrawCommand command;
+			command.vertices = &vertexBufferTemp[runStart * 4];
+			command.indices = &indexBufferTemp[runStart * 6];
+			command.numVertices = runGlyphCount * 4;
+			command.numIndices = runGlyphCount * 6;
+			command.textureId = font->GetTexture(layout->quads[runStart].page);
+			command.textureIsFont = true;
+			command.fontHasSDF = (font->GetRenderMethod() == FontRenderMethod::SDF);
+			command.shaderId = shaderId;
+			command.clippingRect = clippingRect;
+			command.userData = nullptr;
+
+			AddVertices(&command);
+
+			runStart = runEnd;
 		}
-
-		DrawCommand command;
-		command.vertices = vertexBufferTemp.data();
-		command.indices = indexBufferTemp.data();
-		command.numVertices = vertexIndex;
-		command.numIndices = indiceIndex;
-		command.textureId = font->GetTexture();
-		command.textureIsFont = true;
-		command.fontHasSDF = (font->GetRenderMethod() == FontRenderMethod::SDF);
-		command.shaderId = shaderId;
-		command.clippingRect = clippingRect;
-		command.userData = nullptr;
-
-		AddVertices(&command);
 	}
 
 	void Graphics2D::AddVertices(const DrawCommand *command) 
@@ -966,6 +1099,7 @@ namespace GFX
 		drawListItem.indiceOffset = indiceCount;
 		drawListItem.shaderId = command->shaderId == 0 ? shaderId : command->shaderId;
 		drawListItem.textureId = command->textureId;
+		drawListItem.textureSlot = 0;
 		drawListItem.textureIsFont = command->textureIsFont;
 		drawListItem.fontHasSDF = command->fontHasSDF;
 		drawListItem.clippingRect = command->clippingRect;
@@ -999,8 +1133,11 @@ namespace GFX
                 newSize *= 2;
             }
             vertices.resize(newSize);
+            vertexFlags.resize(newSize);
             glBindBuffer(GL_ARRAY_BUFFER, VBO);
             glBufferData(GL_ARRAY_BUFFER, newSize * sizeof(Vertex2D), nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, flagsVBO);
+            glBufferData(GL_ARRAY_BUFFER, newSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
             glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
     }
@@ -1131,6 +1268,7 @@ namespace GFX
 
         items.resize(sizeItems);
         vertices.resize(sizeVertices);
+        vertexFlags.resize(sizeVertices);
         indices.resize(sizeIndices);
         vertexBufferTemp.resize(sizeVertices);
         indexBufferTemp.resize(sizeIndices);
@@ -1139,6 +1277,7 @@ namespace GFX
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
+        glGenBuffers(1, &flagsVBO);
 
         glBindVertexArray(VAO);
 
@@ -1153,6 +1292,13 @@ namespace GFX
         glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (GLvoid*)offsetof(Vertex2D, color));
         glEnableVertexAttribArray(2);
 
+        glBindBuffer(GL_ARRAY_BUFFER, flagsVBO);
+
+        glBufferData(GL_ARRAY_BUFFER, vertexFlags.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (GLvoid*)0);
+        glEnableVertexAttribArray(3);
+
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
@@ -1231,12 +1377,18 @@ namespace GFX
         glDeleteShader(vert_handle);
         glDeleteShader(frag_handle);
 
-		uniforms[Uniform_Texture] = glGetUniformLocation(shaderId, "uTexture");
+		uniforms[Uniform_Texture] = glGetUniformLocation(shaderId, "uTextures");
 		uniforms[Uniform_Resolution] = glGetUniformLocation(shaderId, "uResolution");
 		uniforms[Uniform_Projection] = glGetUniformLocation(shaderId, "uProjection");
-		uniforms[Uniform_IsFont] = glGetUniformLocation(shaderId, "uIsFont");
-		uniforms[Uniform_FontHasSDF] = glGetUniformLocation(shaderId, "uFontHasSDF");
 		uniforms[Uniform_Time] = glGetUniformLocation(shaderId, "uTime");
+
+		int32_t textureSlots[GRAPHICS2D_MAX_TEXTURE_SLOTS];
+		for(uint32_t i = 0; i < GRAPHICS2D_MAX_TEXTURE_SLOTS; i++)
+			textureSlots[i] = static_cast<int32_t>(i);
+
+		glUseProgram(shaderId);
+		glUniform1iv(uniforms[Uniform_Texture], GRAPHICS2D_MAX_TEXTURE_SLOTS, textureSlots);
+		glUseProgram(0);
     }
 
     void Graphics2D::CreateTexture()
@@ -1261,50 +1413,67 @@ namespace GFX
 layout(location = 0) in vec2 aPosition;
 layout(location = 1) in vec2 aTexCoord;
 layout(location = 2) in vec4 aColor;
+layout(location = 3) in uint aFlags;
 
 uniform mat4 uProjection;
 out vec2 oTexCoord;
 out vec4 oColor;
+flat out uint oFlags;
 
 void main() {
     gl_Position = uProjection * vec4(aPosition.x, aPosition.y, 0.0, 1.0);
     oTexCoord = aTexCoord;
     oColor = aColor;
+    oFlags = aFlags;
 })";
         return vertexSource;
     }
 
     std::string Graphics2D::GetFragmentSource()
     {
+        //The number of samplers must match GRAPHICS2D_MAX_TEXTURE_SLOTS
         std::string fragmentSource = R"(#version 330 core
-uniform sampler2D uTexture;
+uniform sampler2D uTextures[8];
 uniform float uTime;
 uniform vec2 uResolution;
-uniform int uIsFont;
-uniform int uFontHasSDF;
 
 in vec2 oTexCoord;
 in vec4 oColor;
+flat in uint oFlags;
 out vec4 FragColor;
 
+vec4 SampleTexture(uint slot, vec2 uv) {
+    switch(slot) {
+        case 1u: return texture(uTextures[1], uv);
+        case 2u: return texture(uTextures[2], uv);
+        case 3u: return texture(uTextures[3], uv);
+        case 4u: return texture(uTextures[4], uv);
+        case 5u: return texture(uTextures[5], uv);
+        case 6u: return texture(uTextures[6], uv);
+        case 7u: return texture(uTextures[7], uv);
+        default: return texture(uTextures[0], uv);
+    }
+}
+
 void main() {
-    if(uIsFont > 0) {
-        if(uFontHasSDF > 0) {
-            vec4 sample = texture(uTexture, oTexCoord);
+    vec4 sample = SampleTexture(oFlags & 0xFFu, oTexCoord);
+    bool isFont = (oFlags & 0x100u) != 0u;
+    bool fontHasSDF = (oFlags & 0x200u) != 0u;
+    float aaf = fwidth(sample.r);
+
+    if(isFont) {
+        if(fontHasSDF) {
             float d = sample.r;
-            float aaf = fwidth(d);
             float alpha = smoothstep(0.5 - aaf, 0.5 + aaf, d);
             FragColor = vec4(oColor.rgb, alpha) * oColor;
         } else {
-            vec4 sample = texture(uTexture, oTexCoord);
-
             if(sample.r == 0.0)
                 discard;
 
             FragColor = vec4(oColor.rgb, 1.0) * sample.r;
         }
     } else {
-        FragColor = texture(uTexture, oTexCoord) * oColor;
+        FragColor = sample * oColor;
     }
 })";
         return fragmentSource;
@@ -4,6 +4,7 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../External/stb/stb_image_write.h"
 #include <cstring>
+#include <utility>
 #include <vector>
 
 namespace GFX 
@@ -28,6 +29,7 @@ namespace GFX
 		{
             this->hasLoaded = true;
         }
+        UpdateMemoryUsage();
     }
 
     Image::Image(const uint8_t *compressedData, size_t size) 
@@ -41,6 +43,7 @@ namespace GFX
 		{
             this->hasLoaded = true;
         }
+        UpdateMemoryUsage();
     }
 
     Image::Image(const uint8_t *uncompressedData, size_t size, uint32_t width, uint32_t height, uint32_t channels) 
@@ -51,6 +54,7 @@ namespace GFX
         this->data = new uint8_t[size];
         memcpy(data, uncompressedData, size);
         this->hasLoaded = true;
+        UpdateMemoryUsage();
     }
 
     Image::Image(uint32_t width, uint32_t height, uint32_t channels, float r, float g, float b, float a) 
@@ -64,15 +68,22 @@ namespace GFX
 		{
             this->hasLoaded = true;
         }
+        UpdateMemoryUsage();
     }
 
     Image::Image(const Image &other) 
 	{
-        data = other.data;
+        data = nullptr;
         width = other.width;
         height = other.height;
         channels = other.channels;
         hasLoaded = other.hasLoaded;
+        if(other.data != nullptr) 
+		{
+            data = new uint8_t[other.GetDataSize()];
+            std::memcpy(data, other.data, other.GetDataSize());
+        }
+        UpdateMemoryUsage();
     }
 
     Image::Image(Image &&other) noexcept 
@@ -82,17 +93,18 @@ namespace GFX
         height = other.height;
         channels = other.channels;
         hasLoaded = other.hasLoaded;
+        other.data = nullptr;
+        other.hasLoaded = false;
+        UpdateMemoryUsage();
+        other.UpdateMemoryUsage();
     }
 
     Image &Image::operator=(const Image &other) 
 	{
         if(this != &other) 
 		{
-            data = other.data;
-            width = other.width;
-            height = other.height;
-            channels = other.channels;
-            hasLoaded = other.hasLoaded;
+            Image copy(other);
+            *this = std::move(copy);
         }
         return *this;
     }
@@ -101,11 +113,17 @@ namespace GFX
 	{
         if(this != &other) 
 		{
+            if(data != nullptr)
+                delete[] data;
             data = other.data;
             width = other.width;
             height = other.height;
             channels = other.channels;
             hasLoaded = other.hasLoaded;
+            other.data = nullptr;
+            other.hasLoaded = false;
+            UpdateMemoryUsage();
+            other.UpdateMemoryUsage();
         }
         return *this;
     }
@@ -148,6 +166,11 @@ namespace GFX
         return hasLoaded;
     }
 
+    void Image::UpdateMemoryUsage()
+    {
+        memoryUsage.Set(data != nullptr ? GetDataSize() : 0);
+    }
+
     bool Image::LoadFromFile(const std::string &filepath) 
 	{
         int width, height, channels;
@@ -0,0 +1,51 @@
+#include "LODGroup.hpp"
+#include "../External/glm/glm.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace GFX
+{
+    LODGroup::LODGroup()
+    {
+        screenSizes = { 0.25f, 0.12f, 0.06f };
+        hysteresis = 0.1f;
+        crossfadeDuration = 0.0f;
+        enabled = true;
+    }
+
+    uint32_t LODGroup::SelectLevel(float screenCoverage, uint32_t currentLevel, uint32_t levelCount) const
+    {
+        if(!enabled || levelCount <= 1)
+            return 0;
+
+        uint32_t maxLevel = std::min(levelCount - 1, static_cast<uint32_t>(screenSizes.size()));
+        uint32_t level = std::min(currentLevel, maxLevel);
+
+        while(level < maxLevel && screenCoverage < screenSizes[level] * (1.0f - hysteresis))
+            level++;
+
+        while(level > 0 && screenCoverage > screenSizes[level - 1] * (1.0f + hysteresis))
+            level--;
+
+        return level;
+    }
+
+    float LODGroup::CalculateScreenCoverage(const BoundingBox &worldBounds, const Vector3 &cameraPosition, float fieldOfView)
+    {
+        float radius = glm::length(worldBounds.GetExtents());
+        float distance = glm::length(worldBounds.GetCenter() - cameraPosition);
+
+        //Inside or touching the bounds, so it may cover the whole screen
+        if(distance <= radius)
+            return FLT_MAX;
+
+        float halfFov = std::tan(glm::radians(fieldOfView) * 0.5f);
+
+        if(halfFov <= 0.0f)
+            return FLT_MAX;
+
+        //Projected diameter of the bounding sphere relative to the viewport height
+        return radius / (distance * halfFov);
+    }
+}
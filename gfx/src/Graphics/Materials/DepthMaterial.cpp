@@ -10,11 +10,13 @@ namespace GFX
 		shader = Resources::FindShader(Constants::GetString(ConstantString::ShaderDepth));
 
 		hasInstanceData = false;
+		cascadeMask = -1;
 
 		if(shader != nullptr)
 		{
 			uModel = glGetUniformLocation(shader->GetId(), "uModel");
 			uHasInstanceData = glGetUniformLocation(shader->GetId(), "uHasInstanceData");			
+			uCascadeMask = glGetUniformLocation(shader->GetId(), "uCascadeMask");
 		}
 	}
 
@@ -28,6 +30,16 @@ namespace GFX
 		this->hasInstanceData = hasInstanceData;
 	}
 
+	uint32_t DepthMaterial::GetCascadeMask() const
+	{
+		return static_cast<uint32_t>(cascadeMask);
+	}
+
+	void DepthMaterial::SetCascadeMask(uint32_t mask)
+	{
+		this->cascadeMask = static_cast<int32_t>(mask);
+	}
+
 	void DepthMaterial::Use(Transform *transform, Camera *camera)
 	{
 		if(shader == nullptr || camera == nullptr || transform == nullptr)
@@ -39,5 +51,6 @@ namespace GFX
 
 		shader->SetMat4(uModel, glm::value_ptr(model));
 		shader->SetInt(uHasInstanceData, hasInstanceData ? 1 : 0);
+		shader->SetInt(uCascadeMask, cascadeMask);
 	}
 }
\ No newline at end of file
@@ -73,6 +73,11 @@ namespace GFX
 		shader->SetInt(uReceiveShadows, receiveShadows ? 1 : 0);
 	}
 
+	Texture2D *DiffuseMaterial::GetMainTexture() const
+	{
+		return diffuseTexture;
+	}
+
 	Texture2D *DiffuseMaterial::GetDiffuseTexture() const 
 	{
 		return diffuseTexture;
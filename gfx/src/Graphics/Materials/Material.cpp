@@ -12,6 +12,11 @@ namespace GFX
 		return shader;
 	}
 
+	Texture2D *Material::GetMainTexture() const
+	{
+		return nullptr;
+	}
+
 	void Material::SetName(const std::string &name)
 	{
 		this->name = name;
@@ -1,14 +1,67 @@
 #include "Mesh.hpp"
+#include "Shader.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "../System/FrameArena.hpp"
+#include "../System/Hash.hpp"
 #include "../External/glad/glad.h"
 #include "../External/glm/glm.hpp"
+#include <algorithm>
 #include <functional>
+#include <utility>
 
 namespace GFX
 {
+    //Bounds are kept per chunk of vertices so a partial update only rescans the chunks it touches
+    static constexpr size_t MESH_BOUNDS_CHUNK_SIZE = 256;
+
+    std::unordered_map<uint32_t,MeshShaderUniforms> Mesh::shaderUniforms;
+
+    MeshDirtyRange::MeshDirtyRange()
+    {
+        offset = 0;
+        count = 0;
+    }
+
+    MeshDirtyRange::MeshDirtyRange(size_t offset, size_t count)
+    {
+        this->offset = offset;
+        this->count = count;
+    }
+
+    bool MeshDirtyRange::IsEmpty() const
+    {
+        return count == 0;
+    }
+
+    void MeshDirtyRange::Merge(const MeshDirtyRange &other)
+    {
+        if(other.IsEmpty())
+            return;
+
+        if(IsEmpty())
+        {
+            *this = other;
+            return;
+        }
+
+        size_t end = std::max(offset + count, other.offset + other.count);
+        offset = std::min(offset, other.offset);
+        count = end - offset;
+    }
+
     Mesh::Mesh()
     {
         sizeOfVertices = 0;
         sizeOfIndices = 0;
+        layoutChanged = false;
+        indexType = GL_UNSIGNED_INT;
+        isDynamic = false;
+        vertexBufferCapacity = 0;
+        indexBufferCapacity = 0;
+        adjacencyChanged = true;
+        contentHash = 0;
+        contentHashChanged = true;
     }
 
     Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, bool calculateNormals)
@@ -18,9 +71,19 @@ namespace GFX
 
         sizeOfVertices = this->vertices.size();
         sizeOfIndices = this->indices.size();
+        layoutChanged = false;
+        indexType = GL_UNSIGNED_INT;
+        isDynamic = false;
+        vertexBufferCapacity = 0;
+        indexBufferCapacity = 0;
+        adjacencyChanged = true;
+        contentHash = 0;
+        contentHashChanged = true;
 
         if(calculateNormals)
             RecalculateNormals();
+
+        UpdateMemoryUsage();
     }
 
     Mesh::Mesh(const Mesh &other)
@@ -34,6 +97,25 @@ namespace GFX
         EBO = other.EBO;
         bounds = other.bounds;
         name = other.name;
+        layout = other.layout;
+        positionTransform = other.positionTransform;
+        streams = other.streams;
+        streamBuffers = other.streamBuffers;
+        layoutChanged = other.layoutChanged;
+        indexType = other.indexType;
+        lods = other.lods;
+        isDynamic = other.isDynamic;
+        vertexBufferCapacity = other.vertexBufferCapacity;
+        indexBufferCapacity = other.indexBufferCapacity;
+        dirtyVertices = other.dirtyVertices;
+        dirtyIndices = other.dirtyIndices;
+        boundsChunks = other.boundsChunks;
+        adjacencyOffsets = other.adjacencyOffsets;
+        adjacencyTriangles = other.adjacencyTriangles;
+        adjacencyChanged = other.adjacencyChanged;
+        contentHash = other.contentHash;
+        contentHashChanged = other.contentHashChanged;
+        UpdateMemoryUsage();
     }
 
     Mesh::Mesh(Mesh &&other) noexcept
@@ -47,6 +129,26 @@ namespace GFX
         EBO = std::move(other.EBO);
         bounds = std::move(other.bounds);
         name = std::move(other.name);
+        layout = other.layout;
+        positionTransform = other.positionTransform;
+        streams = std::move(other.streams);
+        streamBuffers = std::move(other.streamBuffers);
+        layoutChanged = std::exchange(other.layoutChanged, false);
+        indexType = other.indexType;
+        lods = std::move(other.lods);
+        isDynamic = other.isDynamic;
+        vertexBufferCapacity = std::exchange(other.vertexBufferCapacity, 0);
+        indexBufferCapacity = std::exchange(other.indexBufferCapacity, 0);
+        dirtyVertices = std::exchange(other.dirtyVertices, MeshDirtyRange());
+        dirtyIndices = std::exchange(other.dirtyIndices, MeshDirtyRange());
+        boundsChunks = std::move(other.boundsChunks);
+        adjacencyOffsets = std::move(other.adjacencyOffsets);
+        adjacencyTriangles = std::move(other.adjacencyTriangles);
+        adjacencyChanged = std::exchange(other.adjacencyChanged, true);
+        contentHash = std::exchange(other.contentHash, 0);
+        contentHashChanged = std::exchange(other.contentHashChanged, true);
+        UpdateMemoryUsage();
+        other.UpdateMemoryUsage();
     }
 
     Mesh& Mesh::operator=(const Mesh &other)
@@ -62,6 +164,25 @@ namespace GFX
             EBO = other.EBO;
             bounds = other.bounds;
             name = other.name;
+            layout = other.layout;
+            positionTransform = other.positionTransform;
+            streams = other.streams;
+            streamBuffers = other.streamBuffers;
+            layoutChanged = other.layoutChanged;
+            indexType = other.indexType;
+            lods = other.lods;
+            isDynamic = other.isDynamic;
+            vertexBufferCapacity = other.vertexBufferCapacity;
+            indexBufferCapacity = other.indexBufferCapacity;
+            dirtyVertices = other.dirtyVertices;
+            dirtyIndices = other.dirtyIndices;
+            boundsChunks = other.boundsChunks;
+            adjacencyOffsets = other.adjacencyOffsets;
+            adjacencyTriangles = other.adjacencyTriangles;
+            adjacencyChanged = other.adjacencyChanged;
+            contentHash = other.contentHash;
+            contentHashChanged = other.contentHashChanged;
+            UpdateMemoryUsage();
         }
         return *this;
     }
@@ -79,6 +200,26 @@ namespace GFX
             EBO = std::move(other.EBO);
             bounds = std::move(other.bounds);
             name = std::move(other.name);
+            layout = other.layout;
+            positionTransform = other.positionTransform;
+            streams = std::move(other.streams);
+            streamBuffers = std::move(other.streamBuffers);
+            layoutChanged = std::exchange(other.layoutChanged, false);
+            indexType = other.indexType;
+            lods = std::move(other.lods);
+            isDynamic = other.isDynamic;
+            vertexBufferCapacity = std::exchange(other.vertexBufferCapacity, 0);
+            indexBufferCapacity = std::exchange(other.indexBufferCapacity, 0);
+            dirtyVertices = std::exchange(other.dirtyVertices, MeshDirtyRange());
+            dirtyIndices = std::exchange(other.dirtyIndices, MeshDirtyRange());
+            boundsChunks = std::move(other.boundsChunks);
+            adjacencyOffsets = std::move(other.adjacencyOffsets);
+            adjacencyTriangles = std::move(other.adjacencyTriangles);
+            adjacencyChanged = std::exchange(other.adjacencyChanged, true);
+            contentHash = std::exchange(other.contentHash, 0);
+            contentHashChanged = std::exchange(other.contentHashChanged, true);
+            UpdateMemoryUsage();
+            other.UpdateMemoryUsage();
         }
         return *this;
     }
@@ -108,16 +249,56 @@ namespace GFX
         return &EBO;
     }
 
+    uint32_t Mesh::GetIndexType() const
+    {
+        return indexType;
+    }
+
     BoundingBox Mesh::GetBounds() const
     {
         return bounds;
     }
 
+    //Hash of the positions and indices, only recalculated after the data was marked as changed through Generate, Update or MarkVerticesDirty/MarkIndicesDirty
+    uint64_t Mesh::GetContentHash()
+    {
+        if(!contentHashChanged)
+            return contentHash;
+
+        uint64_t hash = Hash::FNV_OFFSET_BASIS_64;
+
+        for(size_t i = 0; i < vertices.size(); i++)
+            hash = Hash::FNV1a64(&vertices[i].position, sizeof(Vector3), hash);
+
+        if(indices.size() > 0)
+            hash = Hash::FNV1a64(indices.data(), indices.size() * sizeof(uint32_t), hash);
+
+        contentHash = hash;
+        contentHashChanged = false;
+        return contentHash;
+    }
+
     void Mesh::Generate()
     {
         auto &vertices = GetVertices();
         auto &indices = GetIndices();
 
+        UpdateBounds(0, vertices.size());
+
+        //Compact layouts are encoded into a temporary buffer, the default layout is uploaded as is
+        const void *vertexData = vertices.data();
+        size_t vertexDataSize = vertices.size() * sizeof(Vertex);
+        std::vector<uint8_t> encodedVertices;
+
+        positionTransform = VertexQuantization::CalculatePositionTransform(bounds, layout.position);
+
+        if(!layout.IsDefault())
+        {
+            VertexQuantization::Encode(vertices, layout, positionTransform, encodedVertices);
+            vertexData = encodedVertices.data();
+            vertexDataSize = encodedVertices.size();
+        }
+
         if(VAO.GetId() == 0 && VBO.GetId() == 0 && EBO.GetId() == 0)
         {
             VAO.Generate();
@@ -125,73 +306,560 @@ namespace GFX
 
             VBO.Generate();
             VBO.Bind();
-            VBO.BufferData(vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-            VAO.EnableVertexAttribArray(0);
-            VAO.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, position));
+            UploadVertexData(vertexData, vertexDataSize);
 
-            VAO.EnableVertexAttribArray(1);
-            VAO.VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
-
-            VAO.EnableVertexAttribArray(2);
-            VAO.VertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, uv));
+            SetVertexAttributes();
 
             if(indices.size() > 0)
             {
                 EBO.Generate();
                 EBO.Bind();                
-                EBO.BufferData(indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+                UploadIndices();
             }
 
             VAO.Unbind();
         }
         else
         {
-            VBO.Bind();
-
-            VBO.BufferData(vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+            if(layoutChanged)
+            {
+                VAO.Bind();
+                VBO.Bind();
+                SetVertexAttributes();
+                VAO.Unbind();
+            }
 
-            // if(sizeOfVertices == vertices.size())
-            //     VBO.BufferSubData(0, vertices.size() * sizeof(Vertex), vertices.data());
-            // else
-            //     VBO.BufferData(vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+            VBO.Bind();
 
-            sizeOfVertices = vertices.size();
+            UploadVertexData(vertexData, vertexDataSize);
 
             if(indices.size() > 0)
             {
                 EBO.Bind();
 
-                // if(sizeOfIndices == indices.size())
-                //     EBO.BufferSubData(0, indices.size() * sizeof(GLuint), indices.data());
-                // else
-                //     EBO.BufferData(indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+                UploadIndices();
 
-                EBO.BufferData(indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+                EBO.Unbind();
+            }
 
-                sizeOfIndices = indices.size();
+            VBO.Unbind();
+        }
 
-                EBO.Unbind();
+        sizeOfVertices = vertices.size();
+        sizeOfIndices = indices.size();
+        dirtyVertices = MeshDirtyRange();
+        dirtyIndices = MeshDirtyRange();
+        adjacencyChanged = true;
+        contentHashChanged = true;
+        layoutChanged = false;
+
+        UploadVertexStreams();
+        UpdateMemoryUsage();
+    }
+
+    void Mesh::Update(bool recalculateNormals)
+    {
+        contentHashChanged = true;
+
+        //Appended vertices and indices are uploaded like any other change
+        if(vertices.size() > sizeOfVertices)
+            dirtyVertices.Merge(MeshDirtyRange(sizeOfVertices, vertices.size() - sizeOfVertices));
+
+        if(indices.size() > sizeOfIndices)
+            dirtyIndices.Merge(MeshDirtyRange(sizeOfIndices, indices.size() - sizeOfIndices));
+
+        bool indicesChanged = !dirtyIndices.IsEmpty() || indices.size() != sizeOfIndices;
+
+        if(indicesChanged)
+            adjacencyChanged = true;
+
+        if(recalculateNormals)
+        {
+            //Faces that were replaced are unknown, so index changes need a full pass
+            if(indicesChanged)
+                RecalculateNormals();
+            else
+                RecalculateNormals(dirtyVertices.offset, dirtyVertices.count);
+        }
+
+        bool useShortIndices = MeshOptimizer::CanUseShortIndices(vertices.size());
+        size_t indexSize = useShortIndices ? sizeof(uint16_t) : sizeof(GLuint);
+        size_t vertexSize = layout.IsDefault() ? sizeof(Vertex) : layout.GetStride();
+        size_t indexCount = indices.size();
+
+        for(size_t i = 0; i < lods.size(); i++)
+            indexCount += lods[i].indices.size();
+
+        bool needsGenerate = VAO.GetId() == 0 || layoutChanged;
+        needsGenerate = needsGenerate || vertices.size() * vertexSize > vertexBufferCapacity;
+        needsGenerate = needsGenerate || (indices.size() > 0 && EBO.GetId() == 0);
+        needsGenerate = needsGenerate || indexCount * indexSize > indexBufferCapacity;
+        needsGenerate = needsGenerate || (indexCount > 0 && useShortIndices != (indexType == GL_UNSIGNED_SHORT));
+        needsGenerate = needsGenerate || (lods.size() > 0 && indices.size() != sizeOfIndices);
+
+        if(needsGenerate)
+        {
+            Generate();
+            return;
+        }
+
+        if(!dirtyVertices.IsEmpty() || vertices.size() != sizeOfVertices)
+        {
+            UpdateBounds(dirtyVertices.offset, dirtyVertices.count);
+
+            //Quantized positions are relative to the bounds, so moving them means encoding everything again
+            VertexPositionTransform transform = VertexQuantization::CalculatePositionTransform(bounds, layout.position);
+
+            if(transform.scale != positionTransform.scale || transform.offset != positionTransform.offset)
+            {
+                Generate();
+                return;
+            }
+        }
+
+        size_t vertexEnd = std::min(dirtyVertices.offset + dirtyVertices.count, vertices.size());
+
+        if(dirtyVertices.offset < vertexEnd)
+        {
+            size_t offset = dirtyVertices.offset;
+            size_t count = vertexEnd - offset;
+
+            VBO.Bind();
+
+            if(layout.IsDefault())
+            {
+                VBO.BufferSubData(offset * sizeof(Vertex), count * sizeof(Vertex), &vertices[offset]);
+            }
+            else
+            {
+                std::vector<uint8_t> encodedVertices;
+                VertexQuantization::Encode(&vertices[offset], count, layout, positionTransform, encodedVertices);
+                VBO.BufferSubData(offset * vertexSize, encodedVertices.size(), encodedVertices.data());
             }
 
             VBO.Unbind();
         }
 
+        size_t indexEnd = std::min(dirtyIndices.offset + dirtyIndices.count, indices.size());
+
+        if(dirtyIndices.offset < indexEnd)
+        {
+            size_t offset = dirtyIndices.offset;
+            size_t count = indexEnd - offset;
+
+            //The element buffer binding belongs to the vertex array
+            VAO.Bind();
+            EBO.Bind();
+
+            if(useShortIndices)
+            {
+                std::vector<uint16_t> shortIndices(indices.begin() + offset, indices.begin() + indexEnd);
+                EBO.BufferSubData(offset * sizeof(uint16_t), count * sizeof(uint16_t), shortIndices.data());
+            }
+            else
+            {
+                EBO.BufferSubData(offset * sizeof(GLuint), count * sizeof(GLuint), &indices[offset]);
+            }
+
+            VAO.Unbind();
+        }
+
+        sizeOfVertices = vertices.size();
+        sizeOfIndices = indices.size();
+        dirtyVertices = MeshDirtyRange();
+        dirtyIndices = MeshDirtyRange();
+        UpdateMemoryUsage();
+    }
+
+    void Mesh::UploadVertexData(const void *data, size_t size)
+    {
+        if(!isDynamic)
+        {
+            VBO.BufferData(size, data, GL_STATIC_DRAW);
+            vertexBufferCapacity = size;
+            return;
+        }
+
+        //Dynamic storage grows with some headroom and is reused for as long as the data fits
+        if(size > vertexBufferCapacity || vertexBufferCapacity == 0)
+        {
+            vertexBufferCapacity = size + size / 2;
+            VBO.BufferData(vertexBufferCapacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        if(size > 0)
+            VBO.BufferSubData(0, size, data);
+    }
+
+    void Mesh::UploadIndexData(const void *data, size_t size)
+    {
+        if(!isDynamic)
+        {
+            EBO.BufferData(size, data, GL_STATIC_DRAW);
+            indexBufferCapacity = size;
+            return;
+        }
+
+        if(size > indexBufferCapacity || indexBufferCapacity == 0)
+        {
+            indexBufferCapacity = size + size / 2;
+            EBO.BufferData(indexBufferCapacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        if(size > 0)
+            EBO.BufferSubData(0, size, data);
+    }
+
+    void Mesh::UpdateBounds(size_t offset, size_t count)
+    {
+        size_t chunkCount = (vertices.size() + MESH_BOUNDS_CHUNK_SIZE - 1) / MESH_BOUNDS_CHUNK_SIZE;
+        size_t previousChunkCount = boundsChunks.size();
+        size_t firstChunk = offset / MESH_BOUNDS_CHUNK_SIZE;
+        size_t lastChunk = count > 0 ? (offset + count - 1) / MESH_BOUNDS_CHUNK_SIZE : 0;
+
+        boundsChunks.resize(chunkCount);
+
+        //The last chunk is always rescanned since it may have gained or lost vertices
+        size_t tailChunk = std::min(previousChunkCount, chunkCount);
+
+        for(size_t i = 0; i < chunkCount; i++)
+        {
+            bool isChanged = (count > 0 && i >= firstChunk && i <= lastChunk) || i + 1 >= tailChunk;
+
+            if(!isChanged)
+                continue;
+
+            size_t start = i * MESH_BOUNDS_CHUNK_SIZE;
+            size_t end = std::min(start + MESH_BOUNDS_CHUNK_SIZE, vertices.size());
+
+            boundsChunks[i].Clear();
+
+            for(size_t j = start; j < end; j++)
+                boundsChunks[i].Grow(vertices[j].position);
+        }
+
         bounds.Clear();
 
-        for(size_t i = 0; i < vertices.size(); i++)
+        if(chunkCount == 0)
+            return;
+
+        Vector3 boundsMin = boundsChunks[0].GetMin();
+        Vector3 boundsMax = boundsChunks[0].GetMax();
+
+        for(size_t i = 1; i < chunkCount; i++)
         {
-            bounds.Grow(vertices[i].position);
+            boundsMin = Vector3f::Min(boundsMin, boundsChunks[i].GetMin());
+            boundsMax = Vector3f::Max(boundsMax, boundsChunks[i].GetMax());
+        }
+
+        bounds = BoundingBox(boundsMin, boundsMax);
+    }
+
+    void Mesh::UploadIndices()
+    {
+        //Every LOD lives in the same element buffer right after the full detail indices
+        size_t indexCount = indices.size();
+
+        for(size_t i = 0; i < lods.size(); i++)
+        {
+            lods[i].indexOffset = indexCount;
+            indexCount += lods[i].indices.size();
+        }
+
+        //16 bit indices halve the index buffer whenever every vertex can be addressed
+        if(MeshOptimizer::CanUseShortIndices(vertices.size()))
+        {
+            std::vector<uint16_t> shortIndices;
+            shortIndices.reserve(indexCount);
+            shortIndices.insert(shortIndices.end(), indices.begin(), indices.end());
+            for(size_t i = 0; i < lods.size(); i++)
+                shortIndices.insert(shortIndices.end(), lods[i].indices.begin(), lods[i].indices.end());
+            UploadIndexData(shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+            indexType = GL_UNSIGNED_SHORT;
+        }
+        else if(lods.size() > 0)
+        {
+            std::vector<uint32_t> allIndices;
+            allIndices.reserve(indexCount);
+            allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+            for(size_t i = 0; i < lods.size(); i++)
+                allIndices.insert(allIndices.end(), lods[i].indices.begin(), lods[i].indices.end());
+            UploadIndexData(allIndices.data(), allIndices.size() * sizeof(GLuint));
+            indexType = GL_UNSIGNED_INT;
+        }
+        else
+        {
+            UploadIndexData(indices.data(), indices.size() * sizeof(GLuint));
+            indexType = GL_UNSIGNED_INT;
+        }
+    }
+
+    void Mesh::SetVertexAttributes()
+    {
+        if(layout.IsDefault())
+        {
+            VAO.EnableVertexAttribArray(VERTEX_POSITION_LOCATION);
+            VAO.VertexAttribPointer(VERTEX_POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, position));
+
+            VAO.EnableVertexAttribArray(VERTEX_NORMAL_LOCATION);
+            VAO.VertexAttribPointer(VERTEX_NORMAL_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+
+            VAO.EnableVertexAttribArray(VERTEX_UV_LOCATION);
+            VAO.VertexAttribPointer(VERTEX_UV_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, uv));
+            return;
+        }
+
+        GLsizei stride = static_cast<GLsizei>(layout.GetStride());
+        const GLvoid *normalOffset = (const GLvoid*)static_cast<uintptr_t>(layout.GetNormalOffset());
+        const GLvoid *uvOffset = (const GLvoid*)static_cast<uintptr_t>(layout.GetUVOffset());
+
+        VAO.EnableVertexAttribArray(VERTEX_POSITION_LOCATION);
+
+        if(layout.position == VertexAttributeFormat::UNorm16)
+            VAO.VertexAttribPointer(VERTEX_POSITION_LOCATION, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (const GLvoid*)0);
+        else if(layout.position == VertexAttributeFormat::Float16)
+            VAO.VertexAttribPointer(VERTEX_POSITION_LOCATION, 3, GL_HALF_FLOAT, GL_FALSE, stride, (const GLvoid*)0);
+        else
+            VAO.VertexAttribPointer(VERTEX_POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)0);
+
+        //Octahedral normals only have 2 components, the shader decodes them with decode_normal
+        VAO.EnableVertexAttribArray(VERTEX_NORMAL_LOCATION);
+
+        if(layout.normal == VertexAttributeFormat::Octahedral16)
+            VAO.VertexAttribPointer(VERTEX_NORMAL_LOCATION, 2, GL_SHORT, GL_TRUE, stride, normalOffset);
+        else if(layout.normal == VertexAttributeFormat::Octahedral8)
+            VAO.VertexAttribPointer(VERTEX_NORMAL_LOCATION, 2, GL_BYTE, GL_TRUE, stride, normalOffset);
+        else if(layout.normal == VertexAttributeFormat::Float16)
+            VAO.VertexAttribPointer(VERTEX_NORMAL_LOCATION, 3, GL_HALF_FLOAT, GL_FALSE, stride, normalOffset);
+        else
+            VAO.VertexAttribPointer(VERTEX_NORMAL_LOCATION, 3, GL_FLOAT, GL_FALSE, stride, normalOffset);
+
+        VAO.EnableVertexAttribArray(VERTEX_UV_LOCATION);
+
+        if(layout.uv == VertexAttributeFormat::Float16)
+            VAO.VertexAttribPointer(VERTEX_UV_LOCATION, 2, GL_HALF_FLOAT, GL_FALSE, stride, uvOffset);
+        else
+            VAO.VertexAttribPointer(VERTEX_UV_LOCATION, 2, GL_FLOAT, GL_FALSE, stride, uvOffset);
+    }
+
+    void Mesh::UploadVertexStreams()
+    {
+        for(size_t i = 0; i < streams.size(); i++)
+        {
+            const VertexStream &stream = streams[i];
+
+            if(i >= streamBuffers.size())
+            {
+                VertexBufferObject buffer;
+                buffer.Generate();
+
+                VAO.Bind();
+                buffer.Bind();
+                buffer.BufferData(stream.data.size(), stream.data.data(), GL_STATIC_DRAW);
+                VAO.EnableVertexAttribArray(stream.location);
+                VAO.VertexAttribPointer(stream.location, stream.components, stream.type, stream.normalized ? GL_TRUE : GL_FALSE, stream.stride, (const GLvoid*)0);
+                VAO.Unbind();
+                buffer.Unbind();
+
+                streamBuffers.push_back(buffer);
+            }
+            else
+            {
+                streamBuffers[i].Bind();
+                streamBuffers[i].BufferData(stream.data.size(), stream.data.data(), GL_STATIC_DRAW);
+                streamBuffers[i].Unbind();
+            }
         }
     }
 
     void Mesh::Delete()
     {
+        for(size_t i = 0; i < streamBuffers.size(); i++)
+            streamBuffers[i].Delete();
+        streamBuffers.clear();
         EBO.Delete();
         VBO.Delete();
         VAO.Delete();
     }
 
+    void Mesh::SetVertexLayout(const VertexLayout &layout)
+    {
+        if(!layout.IsValid())
+            return;
+        this->layout = layout;
+        layoutChanged = true;
+    }
+
+    VertexLayout Mesh::GetVertexLayout() const
+    {
+        return layout;
+    }
+
+    VertexPositionTransform Mesh::GetPositionTransform() const
+    {
+        return positionTransform;
+    }
+
+    void Mesh::AddVertexStream(const VertexStream &stream)
+    {
+        streams.push_back(stream);
+    }
+
+    void Mesh::ClearVertexStreams()
+    {
+        //Attributes stay enabled on the VAO, so buffers can only be dropped together with it
+        streams.clear();
+    }
+
+    std::vector<VertexStream> &Mesh::GetVertexStreams()
+    {
+        return streams;
+    }
+
+    void Mesh::GenerateLODs(uint32_t maxLevels, float reduction, float maxError)
+    {
+        lods.clear();
+
+        if(indices.size() == 0 || reduction <= 0.0f || reduction >= 1.0f)
+            return;
+
+        //Each level is simplified from the previous one, so its error is bounded by the sum of the steps
+        const std::vector<uint32_t> *source = &indices;
+        float error = 0.0f;
+
+        for(uint32_t level = 0; level < maxLevels; level++)
+        {
+            size_t targetIndexCount = static_cast<size_t>(source->size() * reduction);
+            MeshLOD lod;
+            lod.indexOffset = 0;
+            float levelError = MeshSimplifier::Simplify(vertices, *source, targetIndexCount, maxError - error, lod.indices);
+
+            //Stop when the error budget no longer allows a meaningful reduction
+            if(lod.indices.size() == 0 || lod.indices.size() > source->size() * 0.9f)
+                break;
+
+            MeshOptimizer::OptimizeVertexCache(lod.indices, vertices.size());
+            error += levelError;
+            lod.error = error;
+            lods.push_back(std::move(lod));
+            source = &lods.back().indices;
+        }
+
+        UpdateMemoryUsage();
+    }
+
+    void Mesh::ClearLODs()
+    {
+        lods.clear();
+        UpdateMemoryUsage();
+    }
+
+    void Mesh::SetLODs(const std::vector<MeshLOD> &lods)
+    {
+        this->lods = lods;
+        UpdateMemoryUsage();
+    }
+
+    const std::vector<MeshLOD> &Mesh::GetLODs() const
+    {
+        return lods;
+    }
+
+    size_t Mesh::GetLODCount() const
+    {
+        return lods.size() + 1;
+    }
+
+    size_t Mesh::GetLODIndexOffset(size_t level) const
+    {
+        if(level == 0 || level > lods.size())
+            return 0;
+        return lods[level - 1].indexOffset;
+    }
+
+    size_t Mesh::GetLODIndicesCount(size_t level) const
+    {
+        if(level == 0 || level > lods.size())
+            return indices.size();
+        return lods[level - 1].indices.size();
+    }
+
+    float Mesh::GetLODError(size_t level) const
+    {
+        if(level == 0 || level > lods.size())
+            return 0.0f;
+        return lods[level - 1].error;
+    }
+
+    MeshShaderUniforms &Mesh::GetShaderUniforms(uint32_t shaderId)
+    {
+        auto it = shaderUniforms.find(shaderId);
+
+        if(it == shaderUniforms.end())
+        {
+            MeshShaderUniforms uniforms;
+            uniforms.positionScale = glGetUniformLocation(shaderId, "uVertexPositionScale");
+            uniforms.positionOffset = glGetUniformLocation(shaderId, "uVertexPositionOffset");
+            uniforms.flags = glGetUniformLocation(shaderId, "uVertexFlags");
+            uniforms.lodFade = glGetUniformLocation(shaderId, "uLODFade");
+            uniforms.positionScaleValue = Vector3(1, 1, 1);
+            uniforms.positionOffsetValue = Vector3(0, 0, 0);
+            uniforms.flagsValue = 0;
+            uniforms.lodFadeValue = 0.0f;
+            it = shaderUniforms.emplace(shaderId, uniforms).first;
+        }
+
+        return it->second;
+    }
+
+    void Mesh::SetVertexUniforms(Shader *shader)
+    {
+        if(shader == nullptr)
+            return;
+
+        //Uniforms belong to the program, so they only need to be set when they differ from the previous mesh
+        MeshShaderUniforms &uniforms = GetShaderUniforms(shader->GetId());
+        bool isOctahedral = layout.normal == VertexAttributeFormat::Octahedral16 || layout.normal == VertexAttributeFormat::Octahedral8;
+        int32_t flags = isOctahedral ? VERTEX_FLAG_OCTAHEDRAL_NORMALS : 0;
+
+        if(uniforms.positionScale >= 0 && uniforms.positionScaleValue != positionTransform.scale)
+        {
+            glUniform3fv(uniforms.positionScale, 1, &positionTransform.scale.x);
+            uniforms.positionScaleValue = positionTransform.scale;
+        }
+
+        if(uniforms.positionOffset >= 0 && uniforms.positionOffsetValue != positionTransform.offset)
+        {
+            glUniform3fv(uniforms.positionOffset, 1, &positionTransform.offset.x);
+            uniforms.positionOffsetValue = positionTransform.offset;
+        }
+
+        if(uniforms.flags >= 0 && uniforms.flagsValue != flags)
+        {
+            glUniform1i(uniforms.flags, flags);
+            uniforms.flagsValue = flags;
+        }
+    }
+
+    void Mesh::SetLODFadeUniform(Shader *shader, float fade)
+    {
+        if(shader == nullptr)
+            return;
+
+        MeshShaderUniforms &uniforms = GetShaderUniforms(shader->GetId());
+
+        if(uniforms.lodFade >= 0 && uniforms.lodFadeValue != fade)
+        {
+            glUniform1f(uniforms.lodFade, fade);
+            uniforms.lodFadeValue = fade;
+        }
+    }
+
+    void Mesh::ClearShaderUniforms(uint32_t shaderId)
+    {
+        shaderUniforms.erase(shaderId);
+    }
+
     size_t Mesh::GetVerticesCount() const
     {
         return vertices.size();
@@ -214,29 +882,175 @@ namespace GFX
 
     void Mesh::RecalculateNormals()
     {
+        //Face normals are summed per vertex in triangle order and normalized once
+        std::vector<Vector3> normals(vertices.size(), Vector3(0, 0, 0));
+        std::vector<uint8_t> isReferenced(vertices.size(), 0);
         size_t triangleCount = indices.size() / 3;
 
         for (size_t i = 0; i < triangleCount; i++)
         {
-            int normalTriangleIndex = i * 3;
-            int vertexIndexA = (int)indices[normalTriangleIndex];
-            int vertexIndexB = (int)indices[normalTriangleIndex + 1];
-            int vertexIndexC = (int)indices[normalTriangleIndex + 2];
-            
-            Vector3 triangleNormal = SurfaceNormalFromIndices(vertexIndexA, vertexIndexB, vertexIndexC);
+            const uint32_t *pTriangle = &indices[i * 3];
+
+            if(pTriangle[0] >= vertices.size() || pTriangle[1] >= vertices.size() || pTriangle[2] >= vertices.size())
+                continue;
 
-            Vertex &v1 = vertices[vertexIndexA];
-            Vertex &v2 = vertices[vertexIndexB];
-            Vertex &v3 = vertices[vertexIndexC];
+            Vector3 triangleNormal = SurfaceNormalFromIndices(pTriangle[0], pTriangle[1], pTriangle[2]);
 
-            v1.normal += triangleNormal;
-            v2.normal += triangleNormal;
-            v3.normal += triangleNormal;
+            for(size_t j = 0; j < 3; j++)
+            {
+                normals[pTriangle[j]] += triangleNormal;
+                isReferenced[pTriangle[j]] = 1;
+            }
+        }
+
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            if(isReferenced[i] && glm::dot(normals[i], normals[i]) > 0.0f)
+                vertices[i].normal = Vector3f::Normalize(normals[i]);
+        }
+
+        MarkVerticesDirty(0, vertices.size());
+    }
+
+    void Mesh::RecalculateNormals(size_t vertexOffset, size_t vertexCount)
+    {
+        if(vertexOffset >= vertices.size() || vertexCount == 0)
+            return;
+
+        vertexCount = std::min(vertexCount, vertices.size() - vertexOffset);
+
+        UpdateAdjacency();
+
+        //Moving a vertex changes every face around it, so all corners of those faces get a new normal
+        FrameVector<uint32_t> affectedVertices;
+
+        for(size_t i = vertexOffset; i < vertexOffset + vertexCount; i++)
+        {
+            for(uint32_t j = adjacencyOffsets[i]; j < adjacencyOffsets[i + 1]; j++)
+            {
+                const uint32_t *pTriangle = &indices[adjacencyTriangles[j] * 3];
+                affectedVertices.insert(affectedVertices.end(), pTriangle, pTriangle + 3);
+            }
+        }
+
+        if(affectedVertices.size() == 0)
+            return;
+
+        std::sort(affectedVertices.begin(), affectedVertices.end());
+        affectedVertices.erase(std::unique(affectedVertices.begin(), affectedVertices.end()), affectedVertices.end());
 
-            v1.normal = Vector3f::Normalize(v1.normal);
-            v2.normal = Vector3f::Normalize(v2.normal);
-            v3.normal = Vector3f::Normalize(v3.normal);
+        for(size_t i = 0; i < affectedVertices.size(); i++)
+        {
+            Vector3 normal;
+
+            if(CalculateVertexNormal(affectedVertices[i], normal))
+                vertices[affectedVertices[i]].normal = normal;
         }
+
+        MarkVerticesDirty(affectedVertices.front(), affectedVertices.back() - affectedVertices.front() + 1);
+    }
+
+    bool Mesh::CalculateVertexNormal(uint32_t index, Vector3 &normal)
+    {
+        //Same summation order as RecalculateNormals so both give identical results
+        Vector3 sum(0, 0, 0);
+
+        for(uint32_t i = adjacencyOffsets[index]; i < adjacencyOffsets[index + 1]; i++)
+        {
+            const uint32_t *pTriangle = &indices[adjacencyTriangles[i] * 3];
+            sum += SurfaceNormalFromIndices(pTriangle[0], pTriangle[1], pTriangle[2]);
+        }
+
+        if(glm::dot(sum, sum) <= 0.0f)
+            return false;
+
+        normal = Vector3f::Normalize(sum);
+        return true;
+    }
+
+    void Mesh::UpdateAdjacency()
+    {
+        if(!adjacencyChanged && adjacencyOffsets.size() == vertices.size() + 1)
+            return;
+
+        //Triangles around each vertex, one entry per corner in triangle order
+        adjacencyOffsets.assign(vertices.size() + 1, 0);
+        size_t triangleCount = indices.size() / 3;
+
+        for(size_t i = 0; i < triangleCount; i++)
+        {
+            const uint32_t *pTriangle = &indices[i * 3];
+
+            if(pTriangle[0] >= vertices.size() || pTriangle[1] >= vertices.size() || pTriangle[2] >= vertices.size())
+                continue;
+
+            for(size_t j = 0; j < 3; j++)
+                adjacencyOffsets[pTriangle[j] + 1]++;
+        }
+
+        for(size_t i = 0; i < vertices.size(); i++)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+        adjacencyTriangles.resize(adjacencyOffsets.back());
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+        for(size_t i = 0; i < triangleCount; i++)
+        {
+            const uint32_t *pTriangle = &indices[i * 3];
+
+            if(pTriangle[0] >= vertices.size() || pTriangle[1] >= vertices.size() || pTriangle[2] >= vertices.size())
+                continue;
+
+            for(size_t j = 0; j < 3; j++)
+                adjacencyTriangles[cursor[pTriangle[j]]++] = static_cast<uint32_t>(i);
+        }
+
+        adjacencyChanged = false;
+        UpdateMemoryUsage();
+    }
+
+    //The CPU side copies stay resident after upload, so they count as mesh memory until they are released
+    void Mesh::UpdateMemoryUsage()
+    {
+        size_t bytes = vertices.capacity() * sizeof(Vertex);
+        bytes += indices.capacity() * sizeof(uint32_t);
+        bytes += boundsChunks.capacity() * sizeof(BoundingBox);
+        bytes += (adjacencyOffsets.capacity() + adjacencyTriangles.capacity()) * sizeof(uint32_t);
+
+        for(size_t i = 0; i < lods.size(); i++)
+            bytes += lods[i].indices.capacity() * sizeof(uint32_t);
+
+        memoryUsage.Set(bytes);
+    }
+
+    void Mesh::SetDynamic(bool dynamic)
+    {
+        if(isDynamic == dynamic)
+            return;
+
+        isDynamic = dynamic;
+
+        //Storage is created again on the next upload with the matching usage
+        vertexBufferCapacity = 0;
+        indexBufferCapacity = 0;
+    }
+
+    bool Mesh::IsDynamic() const
+    {
+        return isDynamic;
+    }
+
+    void Mesh::MarkVerticesDirty(size_t offset, size_t count)
+    {
+        dirtyVertices.Merge(MeshDirtyRange(offset, count));
+        contentHashChanged = true;
+    }
+
+    void Mesh::MarkIndicesDirty(size_t offset, size_t count)
+    {
+        dirtyIndices.Merge(MeshDirtyRange(offset, count));
+        adjacencyChanged = true;
+        contentHashChanged = true;
     }
 
     Vector3 Mesh::SurfaceNormalFromIndices(int indexA, int indexB, int indexC)
@@ -247,7 +1061,13 @@ namespace GFX
 
         Vector3 sideAB = pB - pA;
         Vector3 sideAC = pC - pA;
-        return Vector3f::Normalize(Vector3f::Cross(sideAB, sideAC));
+        Vector3 normal = Vector3f::Cross(sideAB, sideAC);
+
+        //Degenerate triangles do not contribute
+        if(glm::dot(normal, normal) <= 0.0f)
+            return Vector3(0, 0, 0);
+
+        return Vector3f::Normalize(normal);
     }
 
     static Vector3 PointOnSpheroid(float radius, float height, float horizontalAngle, float verticalAngle)
@@ -277,25 +1097,28 @@ namespace GFX
     {
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
-        uint32_t indiceOffset = 0;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
 
         for(size_t i = 0; i < meshes.size(); i++)
         {
-            auto &mVertices = meshes[i]->GetVertices();
+            vertexCount += meshes[i]->GetVerticesCount();
+            indexCount += meshes[i]->GetIndicesCount();
+        }
 
-            for(size_t j = 0; j < mVertices.size(); j++)
-            {
-                vertices.push_back(mVertices[j]);
-            }
+        vertices.reserve(vertexCount);
+        indices.reserve(indexCount);
 
+        for(size_t i = 0; i < meshes.size(); i++)
+        {
+            uint32_t indiceOffset = static_cast<uint32_t>(vertices.size());
+            auto &mVertices = meshes[i]->GetVertices();
             auto &mIndices = meshes[i]->GetIndices();
 
+            vertices.insert(vertices.end(), mVertices.begin(), mVertices.end());
+
             for(size_t j = 0; j < mIndices.size(); j++)
-            {
                 indices.push_back(mIndices[j] + indiceOffset);
-            }
-            
-            indiceOffset += (uint32_t)meshes[i]->GetVerticesCount();
         }
 
         Mesh mesh(vertices, indices, true);
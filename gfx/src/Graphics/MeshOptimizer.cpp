@@ -0,0 +1,511 @@
+#include "MeshOptimizer.hpp"
+#include "Mesh.hpp"
+#include "../System/Hash.hpp"
+#include "../External/glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace GFX
+{
+    static constexpr int32_t FORSYTH_CACHE_SIZE = 32;
+    static constexpr uint32_t OVERDRAW_CACHE_SIZE = 16;
+    static constexpr size_t FETCH_CACHE_LINE_SIZE = 64;
+    static constexpr size_t FETCH_CACHE_LINES = 64;
+
+    static bool HasValidIndices(const std::vector<uint32_t> &indices, size_t vertexCount)
+    {
+        if(indices.size() % 3 != 0)
+            return false;
+
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            if(indices[i] >= vertexCount)
+                return false;
+        }
+
+        return true;
+    }
+
+    void MeshOptimizer::Optimize(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, MeshOptimizeFlags flags)
+    {
+        if(vertices.size() == 0)
+            return;
+
+        //Non indexed triangle lists get an index buffer so duplicates can be shared
+        if(indices.size() == 0 && (flags & MeshOptimizeFlags_WeldVertices))
+        {
+            if(vertices.size() % 3 != 0)
+                return;
+            indices.resize(vertices.size());
+            std::iota(indices.begin(), indices.end(), 0);
+        }
+
+        if(!HasValidIndices(indices, vertices.size()))
+            return;
+
+        if(flags & MeshOptimizeFlags_WeldVertices)
+            WeldVertices(vertices, indices);
+
+        if(flags & MeshOptimizeFlags_VertexCache)
+            OptimizeVertexCache(indices, vertices.size());
+
+        if(flags & MeshOptimizeFlags_Overdraw)
+            OptimizeOverdraw(indices, vertices);
+
+        //Must come last since it follows the final triangle order
+        if(flags & MeshOptimizeFlags_VertexFetch)
+            OptimizeVertexFetch(vertices, indices);
+    }
+
+    void MeshOptimizer::Optimize(Mesh &mesh, MeshOptimizeFlags flags)
+    {
+        Optimize(mesh.GetVertices(), mesh.GetIndices(), flags);
+
+        //Everything may have been reordered, which also invalidates the cached content hash
+        mesh.MarkVerticesDirty(0, mesh.GetVertices().size());
+        mesh.MarkIndicesDirty(0, mesh.GetIndices().size());
+    }
+
+    static void GetCanonicalVertex(const Vertex &vertex, float *values)
+    {
+        values[0] = vertex.position.x;
+        values[1] = vertex.position.y;
+        values[2] = vertex.position.z;
+        values[3] = vertex.normal.x;
+        values[4] = vertex.normal.y;
+        values[5] = vertex.normal.z;
+        values[6] = vertex.uv.x;
+        values[7] = vertex.uv.y;
+
+        //Adding zero turns -0 into +0 so both hash the same
+        for(size_t i = 0; i < 8; i++)
+            values[i] += 0.0f;
+    }
+
+    size_t MeshOptimizer::WeldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+    {
+        if(vertices.size() == 0)
+            return 0;
+
+        size_t tableSize = 1;
+        while(tableSize < vertices.size() * 2)
+            tableSize *= 2;
+
+        //Open addressing table of unique vertex indices
+        std::vector<uint32_t> table(tableSize, UINT32_MAX);
+        std::vector<uint32_t> remap(vertices.size());
+        std::vector<Vertex> uniqueVertices;
+        uniqueVertices.reserve(vertices.size());
+
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            float values[8];
+            GetCanonicalVertex(vertices[i], values);
+            size_t slot = Hash::FNV1a64(values, sizeof(values)) & (tableSize - 1);
+
+            while(true)
+            {
+                uint32_t unique = table[slot];
+
+                if(unique == UINT32_MAX)
+                {
+                    unique = static_cast<uint32_t>(uniqueVertices.size());
+                    table[slot] = unique;
+                    uniqueVertices.push_back(vertices[i]);
+                    remap[i] = unique;
+                    break;
+                }
+
+                float other[8];
+                GetCanonicalVertex(uniqueVertices[unique], other);
+
+                if(memcmp(values, other, sizeof(values)) == 0)
+                {
+                    remap[i] = unique;
+                    break;
+                }
+
+                slot = (slot + 1) & (tableSize - 1);
+            }
+        }
+
+        size_t removed = vertices.size() - uniqueVertices.size();
+
+        if(removed == 0)
+            return 0;
+
+        for(size_t i = 0; i < indices.size(); i++)
+            indices[i] = remap[indices[i]];
+
+        vertices.swap(uniqueVertices);
+        return removed;
+    }
+
+    static float CalculateVertexScore(int32_t cachePosition, uint32_t activeTriangles)
+    {
+        if(activeTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+
+        if(cachePosition >= 0)
+        {
+            //The last triangle's vertices get a fixed score so the next triangle doesn't simply reuse them all
+            if(cachePosition < 3)
+                score = 0.75f;
+            else
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+        }
+
+        //Vertices with few remaining triangles are finished off first
+        score += 2.0f * std::pow(static_cast<float>(activeTriangles), -0.5f);
+        return score;
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+    {
+        size_t triangleCount = indices.size() / 3;
+
+        if(triangleCount < 2 || !HasValidIndices(indices, vertexCount))
+            return;
+
+        std::vector<uint32_t> activeCount(vertexCount, 0);
+
+        for(size_t i = 0; i < indices.size(); i++)
+            activeCount[indices[i]]++;
+
+        //Triangles adjacent to each vertex, emitted triangles are swapped to the end of each range
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+
+        for(size_t i = 0; i < vertexCount; i++)
+            offsets[i + 1] = offsets[i] + activeCount[i];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+        for(size_t i = 0; i < indices.size(); i++)
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+
+        for(size_t i = 0; i < vertexCount; i++)
+            vertexScore[i] = CalculateVertexScore(-1, activeCount[i]);
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        int64_t best = 0;
+
+        for(size_t i = 0; i < triangleCount; i++)
+        {
+            triangleScore[i] = vertexScore[indices[i*3+0]] + vertexScore[indices[i*3+1]] + vertexScore[indices[i*3+2]];
+
+            if(triangleScore[i] > triangleScore[best])
+                best = static_cast<int64_t>(i);
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+        uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+        size_t cacheCount = 0;
+        size_t cursor = 0;
+
+        while(result.size() < indices.size())
+        {
+            //Dead end, continue with the next triangle in the input order
+            if(best < 0)
+            {
+                while(cursor < triangleCount && emitted[cursor])
+                    cursor++;
+
+                if(cursor == triangleCount)
+                    break;
+
+                best = static_cast<int64_t>(cursor);
+            }
+
+            size_t triangle = static_cast<size_t>(best);
+            const uint32_t *pTriangle = &indices[triangle * 3];
+            emitted[triangle] = 1;
+
+            result.push_back(pTriangle[0]);
+            result.push_back(pTriangle[1]);
+            result.push_back(pTriangle[2]);
+
+            for(size_t i = 0; i < 3; i++)
+            {
+                uint32_t vertex = pTriangle[i];
+                uint32_t begin = offsets[vertex];
+                uint32_t end = begin + activeCount[vertex];
+
+                for(uint32_t j = begin; j < end; j++)
+                {
+                    if(adjacency[j] == triangle)
+                    {
+                        std::swap(adjacency[j], adjacency[end - 1]);
+                        activeCount[vertex]--;
+                        break;
+                    }
+                }
+            }
+
+            //Move the triangle's vertices to the front of the simulated LRU cache
+            size_t newCacheCount = 0;
+
+            for(size_t i = 0; i < 3; i++)
+            {
+                uint32_t vertex = pTriangle[i];
+                if(std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount)
+                    newCache[newCacheCount++] = vertex;
+            }
+
+            for(size_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t vertex = cache[i];
+                if(vertex != pTriangle[0] && vertex != pTriangle[1] && vertex != pTriangle[2])
+                    newCache[newCacheCount++] = vertex;
+            }
+
+            for(size_t i = 0; i < newCacheCount; i++)
+            {
+                uint32_t vertex = newCache[i];
+                cachePosition[vertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+                vertexScore[vertex] = CalculateVertexScore(cachePosition[vertex], activeCount[vertex]);
+            }
+
+            cacheCount = std::min(newCacheCount, static_cast<size_t>(FORSYTH_CACHE_SIZE));
+            memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+            //Only triangles touching the cache changed score, the best of them is emitted next
+            best = -1;
+            float bestScore = -1.0f;
+
+            for(size_t i = 0; i < newCacheCount; i++)
+            {
+                uint32_t vertex = newCache[i];
+                uint32_t begin = offsets[vertex];
+                uint32_t end = begin + activeCount[vertex];
+
+                for(uint32_t j = begin; j < end; j++)
+                {
+                    uint32_t t = adjacency[j];
+                    float score = vertexScore[indices[t*3+0]] + vertexScore[indices[t*3+1]] + vertexScore[indices[t*3+2]];
+                    triangleScore[t] = score;
+
+                    if(score > bestScore)
+                    {
+                        bestScore = score;
+                        best = static_cast<int64_t>(t);
+                    }
+                }
+            }
+        }
+
+        indices.swap(result);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold)
+    {
+        size_t triangleCount = indices.size() / 3;
+
+        if(triangleCount < 2 || !HasValidIndices(indices, vertices.size()))
+            return;
+
+        //Split into clusters wherever the cache order restarts (a triangle with three misses)
+        std::vector<size_t> clusters;
+        std::vector<uint64_t> cachedAt(vertices.size(), 0);
+        uint64_t time = OVERDRAW_CACHE_SIZE + 1;
+
+        for(size_t i = 0; i < triangleCount; i++)
+        {
+            uint32_t misses = 0;
+
+            for(size_t j = 0; j < 3; j++)
+            {
+                uint32_t vertex = indices[i*3+j];
+
+                if(time - cachedAt[vertex] > OVERDRAW_CACHE_SIZE)
+                {
+                    cachedAt[vertex] = time++;
+                    misses++;
+                }
+            }
+
+            if(i == 0 || misses == 3)
+                clusters.push_back(i);
+        }
+
+        if(clusters.size() < 2)
+            return;
+
+        clusters.push_back(triangleCount);
+
+        Vector3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+
+        std::vector<Vector3> clusterCenters(clusters.size() - 1, Vector3(0.0f));
+        std::vector<Vector3> clusterNormals(clusters.size() - 1, Vector3(0.0f));
+        std::vector<float> clusterAreas(clusters.size() - 1, 0.0f);
+
+        for(size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            for(size_t i = clusters[c]; i < clusters[c+1]; i++)
+            {
+                const Vector3 &a = vertices[indices[i*3+0]].position;
+                const Vector3 &b = vertices[indices[i*3+1]].position;
+                const Vector3 &d = vertices[indices[i*3+2]].position;
+                Vector3 normal = glm::cross(b - a, d - a);
+                float area = glm::length(normal);
+                Vector3 center = (a + b + d) / 3.0f;
+
+                clusterCenters[c] += center * area;
+                clusterNormals[c] += normal;
+                clusterAreas[c] += area;
+            }
+
+            meshCenter += clusterCenters[c];
+            meshArea += clusterAreas[c];
+
+            if(clusterAreas[c] > 0.0f)
+                clusterCenters[c] /= clusterAreas[c];
+        }
+
+        if(meshArea > 0.0f)
+            meshCenter /= meshArea;
+
+        //Clusters facing away from the center are the most likely to occlude others, so they go first
+        std::vector<float> sortKeys(clusters.size() - 1, 0.0f);
+        std::vector<size_t> order(clusters.size() - 1);
+
+        for(size_t c = 0; c < order.size(); c++)
+        {
+            float length = glm::length(clusterNormals[c]);
+
+            if(length > 0.0f)
+                sortKeys[c] = glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c] / length);
+
+            order[c] = c;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&sortKeys] (size_t a, size_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        for(size_t c = 0; c < order.size(); c++)
+        {
+            size_t cluster = order[c];
+            result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+        }
+
+        //Keep the cache friendly order if sorting costs too much vertex reuse
+        float acmrBefore = AnalyzeVertexCache(indices, vertices.size()).acmr;
+        float acmrAfter = AnalyzeVertexCache(result, vertices.size()).acmr;
+
+        if(acmrAfter <= acmrBefore * threshold)
+            indices.swap(result);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+    {
+        if(indices.size() == 0 || !HasValidIndices(indices, vertices.size()))
+            return;
+
+        //Vertices are stored in the order they are first used, unused ones are dropped
+        std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+        std::vector<Vertex> result;
+        result.reserve(vertices.size());
+
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            uint32_t &index = remap[indices[i]];
+
+            if(index == UINT32_MAX)
+            {
+                index = static_cast<uint32_t>(result.size());
+                result.push_back(vertices[indices[i]]);
+            }
+
+            indices[i] = index;
+        }
+
+        vertices.swap(result);
+    }
+
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize)
+    {
+        VertexCacheStatistics statistics = { 0, 0.0f, 0.0f };
+        size_t triangleCount = indices.size() / 3;
+
+        if(triangleCount == 0 || vertexCount == 0)
+            return statistics;
+
+        //FIFO cache, as found on most GPUs
+        std::vector<uint64_t> cachedAt(vertexCount, 0);
+        uint64_t time = static_cast<uint64_t>(cacheSize) + 1;
+
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            uint32_t vertex = indices[i];
+
+            if(vertex >= vertexCount)
+                continue;
+
+            if(time - cachedAt[vertex] > cacheSize)
+            {
+                cachedAt[vertex] = time++;
+                statistics.verticesTransformed++;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(statistics.verticesTransformed) / triangleCount;
+        statistics.atvr = static_cast<float>(statistics.verticesTransformed) / vertexCount;
+        return statistics;
+    }
+
+    VertexFetchStatistics MeshOptimizer::AnalyzeVertexFetch(const std::vector<uint32_t> &indices, size_t vertexCount, size_t vertexSize)
+    {
+        VertexFetchStatistics statistics = { 0, 0.0f };
+
+        if(indices.size() == 0 || vertexCount == 0 || vertexSize == 0)
+            return statistics;
+
+        //FIFO cache of memory lines
+        size_t lineCount = (vertexCount * vertexSize + FETCH_CACHE_LINE_SIZE - 1) / FETCH_CACHE_LINE_SIZE;
+        std::vector<uint64_t> cachedAt(lineCount, 0);
+        uint64_t time = FETCH_CACHE_LINES + 1;
+
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            if(indices[i] >= vertexCount)
+                continue;
+
+            size_t start = indices[i] * vertexSize;
+            size_t firstLine = start / FETCH_CACHE_LINE_SIZE;
+            size_t lastLine = (start + vertexSize - 1) / FETCH_CACHE_LINE_SIZE;
+
+            for(size_t line = firstLine; line <= lastLine; line++)
+            {
+                if(time - cachedAt[line] > FETCH_CACHE_LINES)
+                {
+                    cachedAt[line] = time++;
+                    statistics.bytesFetched += FETCH_CACHE_LINE_SIZE;
+                }
+            }
+        }
+
+        statistics.overfetch = static_cast<float>(statistics.bytesFetched) / (vertexCount * vertexSize);
+        return statistics;
+    }
+
+    bool MeshOptimizer::CanUseShortIndices(size_t vertexCount)
+    {
+        return vertexCount > 0 && vertexCount <= 65536;
+    }
+}
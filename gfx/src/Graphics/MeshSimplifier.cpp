@@ -0,0 +1,354 @@
+#include "MeshSimplifier.hpp"
+#include "../System/Hash.hpp"
+#include "../External/glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace GFX
+{
+    struct Quadric
+    {
+        //Symmetric 4x4 matrix of the plane equations plus the accumulated weight
+        double a00, a01, a02, a11, a12, a22;
+        double b0, b1, b2;
+        double c;
+        double weight;
+
+        Quadric()
+        {
+            a00 = a01 = a02 = a11 = a12 = a22 = 0.0;
+            b0 = b1 = b2 = 0.0;
+            c = 0.0;
+            weight = 0.0;
+        }
+
+        void AddPlane(const glm::dvec3 &n, double d, double w)
+        {
+            a00 += w * n.x * n.x;
+            a01 += w * n.x * n.y;
+            a02 += w * n.x * n.z;
+            a11 += w * n.y * n.y;
+            a12 += w * n.y * n.z;
+            a22 += w * n.z * n.z;
+            b0 += w * n.x * d;
+            b1 += w * n.y * d;
+            b2 += w * n.z * d;
+            c += w * d * d;
+            weight += w;
+        }
+
+        void Add(const Quadric &other)
+        {
+            a00 += other.a00;
+            a01 += other.a01;
+            a02 += other.a02;
+            a11 += other.a11;
+            a12 += other.a12;
+            a22 += other.a22;
+            b0 += other.b0;
+            b1 += other.b1;
+            b2 += other.b2;
+            c += other.c;
+            weight += other.weight;
+        }
+
+        //Weighted mean of the squared distances to all planes
+        double Evaluate(const glm::dvec3 &p) const
+        {
+            double error = a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z +
+                           a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + a22 * p.z * p.z +
+                           2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+            return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct CollapseCandidate
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+
+        bool operator<(const CollapseCandidate &other) const
+        {
+            if(cost != other.cost)
+                return cost < other.cost;
+            if(from != other.from)
+                return from < other.from;
+            return to < other.to;
+        }
+    };
+
+    static uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+    {
+        if(a > b)
+            std::swap(a, b);
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    static glm::dvec3 GetPosition(const std::vector<Vertex> &vertices, uint32_t index)
+    {
+        return glm::dvec3(vertices[index].position);
+    }
+
+    float MeshSimplifier::Simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, size_t targetIndexCount, float targetError, std::vector<uint32_t> &result)
+    {
+        result = indices;
+
+        if(indices.size() % 3 != 0 || vertices.size() == 0)
+            return 0.0f;
+
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            if(indices[i] >= vertices.size())
+                return 0.0f;
+        }
+
+        size_t vertexCount = vertices.size();
+
+        //Vertices that share a position are wedges of the same point
+        std::vector<uint32_t> positionRemap(vertexCount);
+        std::vector<uint32_t> wedgeCount(vertexCount, 0);
+        std::unordered_map<uint64_t,std::vector<uint32_t>> positionTable;
+
+        for(size_t i = 0; i < vertexCount; i++)
+        {
+            const Vector3 &p = vertices[i].position;
+            float position[3] = { p.x + 0.0f, p.y + 0.0f, p.z + 0.0f };
+            uint64_t hash = Hash::FNV1a64(position, sizeof(position));
+            auto &bucket = positionTable[hash];
+            uint32_t canonical = static_cast<uint32_t>(i);
+
+            for(size_t j = 0; j < bucket.size(); j++)
+            {
+                if(vertices[bucket[j]].position == p)
+                {
+                    canonical = bucket[j];
+                    break;
+                }
+            }
+
+            if(canonical == i)
+                bucket.push_back(canonical);
+
+            positionRemap[i] = canonical;
+            wedgeCount[canonical]++;
+        }
+
+        Vector3 boundsMin = vertices[0].position;
+        Vector3 boundsMax = vertices[0].position;
+
+        for(size_t i = 1; i < vertexCount; i++)
+        {
+            boundsMin = glm::min(boundsMin, vertices[i].position);
+            boundsMax = glm::max(boundsMax, vertices[i].position);
+        }
+
+        Vector3 size = boundsMax - boundsMin;
+        double extent = std::max(std::max(size.x, size.y), size.z);
+
+        if(extent <= 0.0)
+            return 0.0f;
+
+        //Lock open borders, non-manifold edges and seams
+        std::vector<uint8_t> locked(vertexCount, 0);
+        std::unordered_map<uint64_t,uint32_t> edgeCount;
+        edgeCount.reserve(indices.size());
+
+        for(size_t i = 0; i < indices.size(); i += 3)
+        {
+            for(size_t j = 0; j < 3; j++)
+            {
+                uint32_t a = positionRemap[indices[i + j]];
+                uint32_t b = positionRemap[indices[i + (j + 1) % 3]];
+                edgeCount[GetEdgeKey(a, b)]++;
+            }
+        }
+
+        for(const auto &edge : edgeCount)
+        {
+            if(edge.second != 2)
+            {
+                locked[static_cast<uint32_t>(edge.first >> 32)] = 1;
+                locked[static_cast<uint32_t>(edge.first & 0xFFFFFFFF)] = 1;
+            }
+        }
+
+        for(size_t i = 0; i < vertexCount; i++)
+        {
+            if(wedgeCount[positionRemap[i]] > 1)
+                locked[i] = 1;
+        }
+
+        std::vector<Quadric> quadrics(vertexCount);
+
+        for(size_t i = 0; i < indices.size(); i += 3)
+        {
+            glm::dvec3 p0 = GetPosition(vertices, indices[i+0]);
+            glm::dvec3 p1 = GetPosition(vertices, indices[i+1]);
+            glm::dvec3 p2 = GetPosition(vertices, indices[i+2]);
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            double area = glm::length(normal);
+
+            if(area == 0.0)
+                continue;
+
+            normal /= area;
+            double d = -glm::dot(normal, p0);
+
+            for(size_t j = 0; j < 3; j++)
+                quadrics[positionRemap[indices[i+j]]].AddPlane(normal, d, area);
+        }
+
+        double errorLimit = static_cast<double>(targetError) * extent;
+        errorLimit *= errorLimit;
+        double maxError = 0.0;
+
+        targetIndexCount -= targetIndexCount % 3;
+
+        std::vector<uint32_t> collapseRemap(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<CollapseCandidate> candidates;
+
+        while(result.size() > targetIndexCount)
+        {
+            //Triangles around each vertex for the flip test
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+            for(size_t i = 0; i < result.size(); i++)
+                adjacencyOffsets[result[i] + 1]++;
+
+            for(size_t i = 0; i < vertexCount; i++)
+                adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+            adjacency.resize(result.size());
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for(size_t i = 0; i < result.size(); i++)
+                adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+
+            candidates.clear();
+
+            for(size_t i = 0; i < result.size(); i += 3)
+            {
+                for(size_t j = 0; j < 3; j++)
+                {
+                    uint32_t a = result[i + j];
+                    uint32_t b = result[i + (j + 1) % 3];
+
+                    for(size_t k = 0; k < 2; k++)
+                    {
+                        uint32_t from = k == 0 ? a : b;
+                        uint32_t to = k == 0 ? b : a;
+
+                        //The target keeps its attributes, so it must not be a seam
+                        if(locked[from] || wedgeCount[positionRemap[to]] > 1)
+                            continue;
+
+                        Quadric quadric = quadrics[from];
+                        quadric.Add(quadrics[positionRemap[to]]);
+                        double cost = quadric.Evaluate(GetPosition(vertices, to));
+
+                        if(cost <= errorLimit)
+                            candidates.push_back({ cost, from, to });
+                    }
+                }
+            }
+
+            if(candidates.size() == 0)
+                break;
+
+            std::sort(candidates.begin(), candidates.end());
+
+            for(size_t i = 0; i < vertexCount; i++)
+                collapseRemap[i] = static_cast<uint32_t>(i);
+
+            std::fill(touched.begin(), touched.end(), 0);
+
+            //Interior collapses remove two triangles each
+            size_t collapseLimit = (result.size() - targetIndexCount) / 6 + 1;
+            size_t collapses = 0;
+
+            for(size_t c = 0; c < candidates.size() && collapses < collapseLimit; c++)
+            {
+                const CollapseCandidate &candidate = candidates[c];
+                uint32_t from = candidate.from;
+                uint32_t to = candidate.to;
+
+                if(touched[from] || touched[to])
+                    continue;
+
+                //Reject collapses that flip or degenerate a remaining triangle
+                bool isValid = true;
+                glm::dvec3 target = GetPosition(vertices, to);
+
+                for(uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1] && isValid; j++)
+                {
+                    const uint32_t *pTriangle = &result[adjacency[j] * 3];
+
+                    if(pTriangle[0] == to || pTriangle[1] == to || pTriangle[2] == to)
+                        continue;
+
+                    glm::dvec3 p[3];
+                    glm::dvec3 q[3];
+
+                    for(size_t k = 0; k < 3; k++)
+                    {
+                        p[k] = GetPosition(vertices, pTriangle[k]);
+                        q[k] = pTriangle[k] == from ? target : p[k];
+                    }
+
+                    glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                    double afterLength = glm::length(after);
+
+                    if(afterLength == 0.0 || glm::dot(before, after) <= 0.25 * glm::length(before) * afterLength)
+                        isValid = false;
+                }
+
+                if(!isValid)
+                    continue;
+
+                collapseRemap[from] = to;
+                quadrics[positionRemap[to]].Add(quadrics[from]);
+                maxError = std::max(maxError, candidate.cost);
+                collapses++;
+
+                //Everything around the collapse is stale until the next pass
+                for(uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++)
+                {
+                    const uint32_t *pTriangle = &result[adjacency[j] * 3];
+                    touched[pTriangle[0]] = 1;
+                    touched[pTriangle[1]] = 1;
+                    touched[pTriangle[2]] = 1;
+                }
+            }
+
+            if(collapses == 0)
+                break;
+
+            size_t writeIndex = 0;
+
+            for(size_t i = 0; i < result.size(); i += 3)
+            {
+                uint32_t a = collapseRemap[result[i+0]];
+                uint32_t b = collapseRemap[result[i+1]];
+                uint32_t d = collapseRemap[result[i+2]];
+
+                if(a == b || b == d || a == d)
+                    continue;
+
+                result[writeIndex++] = a;
+                result[writeIndex++] = b;
+                result[writeIndex++] = d;
+            }
+
+            result.resize(writeIndex);
+        }
+
+        return static_cast<float>(std::sqrt(maxError) / extent);
+    }
+}
@@ -0,0 +1,419 @@
+#include "ModelCache.hpp"
+#include "../System/Hash.hpp"
+#include "../System/IO/File.hpp"
+#include "../System/IO/MemoryMappedFile.hpp"
+#include <cstring>
+#include <filesystem>
+
+namespace GFX
+{
+    static constexpr uint8_t MODEL_CACHE_IDENTIFIER[8] = { 'G', 'F', 'X', 'M', 'O', 'D', 'E', 'L' };
+    static constexpr uint32_t MODEL_CACHE_ENDIANNESS = 0x04030201;
+    static constexpr size_t MODEL_CACHE_ALIGNMENT = 16;
+
+    class ModelCacheReader
+    {
+    private:
+        const uint8_t *data;
+        size_t size;
+        size_t offset;
+        bool isValid;
+    public:
+        ModelCacheReader(const uint8_t *data, size_t size, size_t offset)
+        {
+            this->data = data;
+            this->size = size;
+            this->offset = offset;
+            this->isValid = true;
+        }
+
+        bool IsValid() const
+        {
+            return isValid;
+        }
+
+        void Read(void *destination, size_t length)
+        {
+            if(!isValid || length > size - offset)
+            {
+                isValid = false;
+                return;
+            }
+
+            if(length > 0)
+                memcpy(destination, data + offset, length);
+            offset += length;
+        }
+
+        uint32_t ReadUInt32()
+        {
+            uint32_t value = 0;
+            Read(&value, sizeof(value));
+            return value;
+        }
+
+        int32_t ReadInt32()
+        {
+            int32_t value = 0;
+            Read(&value, sizeof(value));
+            return value;
+        }
+
+        uint64_t ReadUInt64()
+        {
+            uint64_t value = 0;
+            Read(&value, sizeof(value));
+            return value;
+        }
+
+        float ReadFloat()
+        {
+            float value = 0.0f;
+            Read(&value, sizeof(value));
+            return value;
+        }
+
+        Vector3 ReadVector3()
+        {
+            Vector3 value;
+            value.x = ReadFloat();
+            value.y = ReadFloat();
+            value.z = ReadFloat();
+            return value;
+        }
+
+        std::string ReadString()
+        {
+            uint32_t length = ReadUInt32();
+
+            if(!isValid || length > size - offset)
+            {
+                isValid = false;
+                return "";
+            }
+
+            std::string value(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return value;
+        }
+
+        //Element counts are checked against the remaining bytes before anything is allocated
+        template<typename T>
+        void ReadArray(std::vector<T> &values, uint32_t count)
+        {
+            Align();
+
+            if(!isValid || count > (size - offset) / sizeof(T))
+            {
+                isValid = false;
+                return;
+            }
+
+            values.resize(count);
+            Read(values.data(), count * sizeof(T));
+        }
+
+        void Align()
+        {
+            size_t aligned = (offset + MODEL_CACHE_ALIGNMENT - 1) & ~(MODEL_CACHE_ALIGNMENT - 1);
+
+            if(aligned > size)
+                isValid = false;
+            else
+                offset = aligned;
+        }
+    };
+
+    static void WriteBytes(std::vector<uint8_t> &data, const void *bytes, size_t length)
+    {
+        const uint8_t *pBytes = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), pBytes, pBytes + length);
+    }
+
+    static void WriteUInt32(std::vector<uint8_t> &data, uint32_t value)
+    {
+        WriteBytes(data, &value, sizeof(value));
+    }
+
+    static void WriteInt32(std::vector<uint8_t> &data, int32_t value)
+    {
+        WriteBytes(data, &value, sizeof(value));
+    }
+
+    static void WriteUInt64(std::vector<uint8_t> &data, uint64_t value)
+    {
+        WriteBytes(data, &value, sizeof(value));
+    }
+
+    static void WriteFloat(std::vector<uint8_t> &data, float value)
+    {
+        WriteBytes(data, &value, sizeof(value));
+    }
+
+    static void WriteVector3(std::vector<uint8_t> &data, const Vector3 &value)
+    {
+        WriteFloat(data, value.x);
+        WriteFloat(data, value.y);
+        WriteFloat(data, value.z);
+    }
+
+    static void WriteString(std::vector<uint8_t> &data, const std::string &value)
+    {
+        WriteUInt32(data, static_cast<uint32_t>(value.size()));
+        WriteBytes(data, value.data(), value.size());
+    }
+
+    //Bulk arrays start on an aligned offset, the reader copies each one out of the mapping with a single memcpy
+    static void WriteAlignment(std::vector<uint8_t> &data)
+    {
+        while(data.size() % MODEL_CACHE_ALIGNMENT != 0)
+            data.push_back(0);
+    }
+
+    std::string ModelCache::GetCachePath(const std::string &filepath)
+    {
+        return filepath + ".gfxmodel";
+    }
+
+    uint64_t ModelCache::CalculateSourceHash(const void *data, size_t size, uint32_t modelFlags, const Vector3 &scale, bool flipYZ)
+    {
+        uint64_t hash = Hash::FNV1a64(data, size);
+        hash = Hash::Combine(hash, VERSION);
+        hash = Hash::Combine(hash, modelFlags);
+        hash = Hash::Combine(hash, Hash::FNV1a64(&scale, sizeof(Vector3)));
+        hash = Hash::Combine(hash, flipYZ ? 1 : 0);
+        return hash;
+    }
+
+    bool ModelCache::CalculateSourceHash(const std::string &filepath, uint32_t modelFlags, const Vector3 &scale, bool flipYZ, uint64_t &hash)
+    {
+        MemoryMappedFile file;
+
+        if(!file.Open(filepath))
+            return false;
+
+        hash = CalculateSourceHash(file.GetData(), file.GetSize(), modelFlags, scale, flipYZ);
+        return true;
+    }
+
+    bool ModelCache::Read(const uint8_t *data, size_t size, uint64_t sourceHash, CookedModel &model)
+    {
+        if(data == nullptr || size < sizeof(MODEL_CACHE_IDENTIFIER))
+            return false;
+
+        if(memcmp(data, MODEL_CACHE_IDENTIFIER, sizeof(MODEL_CACHE_IDENTIFIER)) != 0)
+            return false;
+
+        ModelCacheReader reader(data, size, sizeof(MODEL_CACHE_IDENTIFIER));
+
+        //Files from another byte order, version or vertex layout are treated as stale
+        if(reader.ReadUInt32() != MODEL_CACHE_ENDIANNESS)
+            return false;
+        if(reader.ReadUInt32() != VERSION)
+            return false;
+        if(reader.ReadUInt32() != sizeof(Vertex))
+            return false;
+        if(reader.ReadUInt64() != sourceHash || !reader.IsValid())
+            return false;
+
+        uint32_t textureCount = reader.ReadUInt32();
+        uint32_t meshCount = reader.ReadUInt32();
+        uint32_t nodeCount = reader.ReadUInt32();
+
+        if(!reader.IsValid())
+            return false;
+
+        CookedModel result;
+        result.sourceHash = sourceHash;
+
+        for(uint32_t i = 0; i < textureCount && reader.IsValid(); i++)
+        {
+            CookedTexture texture;
+            texture.name = reader.ReadString();
+            texture.isEmbedded = reader.ReadUInt32() != 0;
+            uint32_t dataSize = reader.ReadUInt32();
+            reader.ReadArray(texture.data, dataSize);
+            result.textures.push_back(std::move(texture));
+        }
+
+        for(uint32_t i = 0; i < meshCount && reader.IsValid(); i++)
+        {
+            CookedMesh mesh;
+            mesh.name = reader.ReadString();
+            mesh.textureIndex = reader.ReadInt32();
+            mesh.boundsMin = reader.ReadVector3();
+            mesh.boundsMax = reader.ReadVector3();
+
+            uint32_t vertexCount = reader.ReadUInt32();
+            uint32_t indexCount = reader.ReadUInt32();
+            uint32_t lodCount = reader.ReadUInt32();
+
+            if(!reader.IsValid() || (mesh.textureIndex >= static_cast<int32_t>(textureCount)))
+                return false;
+
+            reader.ReadArray(mesh.vertices, vertexCount);
+            reader.ReadArray(mesh.indices, indexCount);
+
+            for(uint32_t j = 0; j < lodCount && reader.IsValid(); j++)
+            {
+                MeshLOD lod;
+                lod.indexOffset = 0;
+                lod.error = reader.ReadFloat();
+                uint32_t lodIndexCount = reader.ReadUInt32();
+                reader.ReadArray(lod.indices, lodIndexCount);
+                mesh.lods.push_back(std::move(lod));
+            }
+
+            if(!reader.IsValid())
+                return false;
+
+            for(size_t j = 0; j < mesh.indices.size(); j++)
+            {
+                if(mesh.indices[j] >= vertexCount)
+                    return false;
+            }
+
+            for(size_t j = 0; j < mesh.lods.size(); j++)
+            {
+                for(size_t k = 0; k < mesh.lods[j].indices.size(); k++)
+                {
+                    if(mesh.lods[j].indices[k] >= vertexCount)
+                        return false;
+                }
+            }
+
+            result.meshes.push_back(std::move(mesh));
+        }
+
+        for(uint32_t i = 0; i < nodeCount && reader.IsValid(); i++)
+        {
+            CookedNode node;
+            node.name = reader.ReadString();
+            node.parent = reader.ReadInt32();
+            node.position = reader.ReadVector3();
+            node.rotation.x = reader.ReadFloat();
+            node.rotation.y = reader.ReadFloat();
+            node.rotation.z = reader.ReadFloat();
+            node.rotation.w = reader.ReadFloat();
+            node.scale = reader.ReadVector3();
+
+            uint32_t nodeMeshCount = reader.ReadUInt32();
+            reader.ReadArray(node.meshes, nodeMeshCount);
+
+            if(!reader.IsValid())
+                return false;
+
+            if(node.parent >= static_cast<int32_t>(i) || (i > 0 && node.parent < 0))
+                return false;
+
+            for(size_t j = 0; j < node.meshes.size(); j++)
+            {
+                if(node.meshes[j] >= meshCount)
+                    return false;
+            }
+
+            result.nodes.push_back(std::move(node));
+        }
+
+        if(!reader.IsValid())
+            return false;
+
+        model = std::move(result);
+        return true;
+    }
+
+    void ModelCache::Write(const CookedModel &model, std::vector<uint8_t> &data)
+    {
+        data.clear();
+
+        WriteBytes(data, MODEL_CACHE_IDENTIFIER, sizeof(MODEL_CACHE_IDENTIFIER));
+        WriteUInt32(data, MODEL_CACHE_ENDIANNESS);
+        WriteUInt32(data, VERSION);
+        WriteUInt32(data, sizeof(Vertex));
+        WriteUInt64(data, model.sourceHash);
+        WriteUInt32(data, static_cast<uint32_t>(model.textures.size()));
+        WriteUInt32(data, static_cast<uint32_t>(model.meshes.size()));
+        WriteUInt32(data, static_cast<uint32_t>(model.nodes.size()));
+
+        for(size_t i = 0; i < model.textures.size(); i++)
+        {
+            const CookedTexture &texture = model.textures[i];
+            WriteString(data, texture.name);
+            WriteUInt32(data, texture.isEmbedded ? 1 : 0);
+            WriteUInt32(data, static_cast<uint32_t>(texture.data.size()));
+            WriteAlignment(data);
+            WriteBytes(data, texture.data.data(), texture.data.size());
+        }
+
+        for(size_t i = 0; i < model.meshes.size(); i++)
+        {
+            const CookedMesh &mesh = model.meshes[i];
+            WriteString(data, mesh.name);
+            WriteInt32(data, mesh.textureIndex);
+            WriteVector3(data, mesh.boundsMin);
+            WriteVector3(data, mesh.boundsMax);
+            WriteUInt32(data, static_cast<uint32_t>(mesh.vertices.size()));
+            WriteUInt32(data, static_cast<uint32_t>(mesh.indices.size()));
+            WriteUInt32(data, static_cast<uint32_t>(mesh.lods.size()));
+            WriteAlignment(data);
+            WriteBytes(data, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            WriteAlignment(data);
+            WriteBytes(data, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+
+            for(size_t j = 0; j < mesh.lods.size(); j++)
+            {
+                WriteFloat(data, mesh.lods[j].error);
+                WriteUInt32(data, static_cast<uint32_t>(mesh.lods[j].indices.size()));
+                WriteAlignment(data);
+                WriteBytes(data, mesh.lods[j].indices.data(), mesh.lods[j].indices.size() * sizeof(uint32_t));
+            }
+        }
+
+        for(size_t i = 0; i < model.nodes.size(); i++)
+        {
+            const CookedNode &node = model.nodes[i];
+            WriteString(data, node.name);
+            WriteInt32(data, node.parent);
+            WriteVector3(data, node.position);
+            WriteFloat(data, node.rotation.x);
+            WriteFloat(data, node.rotation.y);
+            WriteFloat(data, node.rotation.z);
+            WriteFloat(data, node.rotation.w);
+            WriteVector3(data, node.scale);
+            WriteUInt32(data, static_cast<uint32_t>(node.meshes.size()));
+            WriteAlignment(data);
+            WriteBytes(data, node.meshes.data(), node.meshes.size() * sizeof(uint32_t));
+        }
+    }
+
+    bool ModelCache::Load(const std::string &filepath, uint64_t sourceHash, CookedModel &model)
+    {
+        MemoryMappedFile file;
+
+        if(!file.Open(filepath))
+            return false;
+
+        return Read(file.GetData(), file.GetSize(), sourceHash, model);
+    }
+
+    bool ModelCache::Save(const std::string &filepath, const CookedModel &model)
+    {
+        std::vector<uint8_t> data;
+        Write(model, data);
+
+        //Write to a temporary file first so a crash never leaves a truncated cache behind
+        std::string temporaryPath = filepath + ".tmp";
+        File::WriteAllBytes(temporaryPath, data.data(), data.size());
+
+        std::error_code error;
+
+        if(std::filesystem::file_size(temporaryPath, error) != data.size() || error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        std::filesystem::rename(temporaryPath, filepath, error);
+        return !error;
+    }
+}
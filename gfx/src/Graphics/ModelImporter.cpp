@@ -1,20 +1,26 @@
 #include "ModelImporter.hpp"
 #include "Vertex.hpp"
 #include "Mesh.hpp"
+#include "ModelCache.hpp"
 #include "MeshRenderer.hpp"
 #include "Texture2D.hpp"
+#include "TextureCompressor.hpp"
+#include "TextureStreamer.hpp"
 #include "Image.hpp"
 #include "Materials/DiffuseMaterial.hpp"
 #include "../Core/Resources.hpp"
 #include "../Core/Debug.hpp"
 #include "../Core/Constants.hpp"
 #include "../System/IO/File.hpp"
+#include "../System/JobSystem.hpp"
 #include "../../libs/assimp/include/assimp/Importer.hpp"
 #include "../../libs/assimp/include/assimp/scene.h"
 #include "../../libs/assimp/include/assimp/postprocess.h"
 #include "../../libs/assimp/include/assimp/material.h"
 #include "../../libs/assimp/include/assimp/texture.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 
 namespace GFX
@@ -87,68 +93,152 @@ namespace GFX
         }
     }
 
-    static Texture2D *LoadDiffuseTexture(aiMaterial *aMaterial, const std::string modelBaseDirectory)
+    //Returns the texture path relative to the model directory, or an empty string if the file can't be found
+    static std::string FindDiffuseTexturePath(const aiMaterial *aMaterial, const std::string &modelBaseDirectory)
     {
         uint32_t count = aMaterial->GetTextureCount(aiTextureType_DIFFUSE);
         
         if(count == 0)
-            return nullptr;
+            return "";
         
         aiString path;
 
         if (aMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &path) != AI_SUCCESS) 
-            return nullptr;
-        
-        std::string filepath = modelBaseDirectory + "/" + std::string(path.C_Str());
+            return "";
+
+        std::string relativePath = std::string(path.C_Str());
 
         //Try to load file from path
-        if(!std::filesystem::exists(filepath))
+        if(!std::filesystem::exists(modelBaseDirectory + "/" + relativePath))
         {
             //If path doesn't exist, fall back to relative folder in model directory
-            filepath = modelBaseDirectory + "/Textures/" + File::GetName( std::string(path.C_Str()));
+            relativePath = "Textures/" + File::GetName(std::string(path.C_Str()));
 
-            if(!std::filesystem::exists(filepath))
-                return nullptr;
+            if(!std::filesystem::exists(modelBaseDirectory + "/" + relativePath))
+                return "";
         }
 
-        //Check if texture already exists
-        Texture2D *texture = Resources::FindTexture2D(filepath);
-        
-        if(texture)
-            return texture;
+        return relativePath;
+    }
 
-        Image image(filepath);
-        
-        if(!image.IsLoaded())
-            return nullptr;
-        
-        return Resources::AddTexture2D(filepath, Texture2D(&image));
+    bool ModelImporter::useCache = true;
+    bool ModelImporter::compressTextures = false;
+    VertexLayout ModelImporter::vertexLayout;
+    uint32_t ModelImporter::workerCount = ModelProcessor::GetDefaultWorkerCount();
+    float ModelImporter::uploadTimeBudget = 2.0f;
+    size_t ModelImporter::uploadByteBudget = 32 * 1024 * 1024;
+    ConcurrentQueue<std::shared_ptr<ModelImportHandle>> ModelImporter::loadedModels;
+    std::vector<std::shared_ptr<ModelImportHandle>> ModelImporter::uploadingModels;
+
+    ModelImportHandle::ModelImportHandle()
+    {
+        state = ModelImportState::Loading;
+        result = nullptr;
+        model.sourceHash = 0;
+        uploadIndex = 0;
     }
 
-    GameObject *ModelImporter::LoadFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ)
+    ModelImportState ModelImportHandle::GetState() const
     {
-		if(!std::filesystem::exists(filepath))
-        {
-            Debug::WriteLog("Error loading model: file does not exist: %s", filepath.c_str());
-            return nullptr;
-        }
+        return state;
+    }
 
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(filepath, modelFlags);
+    bool ModelImportHandle::IsDone() const
+    {
+        ModelImportState currentState = state;
+        return currentState == ModelImportState::Done || currentState == ModelImportState::Failed;
+    }
 
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-        {
-            Debug::WriteLog("Error loading model: %s", importer.GetErrorString());
-            return nullptr;
-        }
+    GameObject *ModelImportHandle::GetResult() const
+    {
+        return state == ModelImportState::Done ? result : nullptr;
+    }
+
+    float ModelImportHandle::GetUploadProgress() const
+    {
+        if(state != ModelImportState::Uploading)
+            return IsDone() ? 1.0f : 0.0f;
 
-        GameObject *model = GameObject::Create();
+        size_t count = textures.size() + model.meshes.size();
+        return count > 0 ? static_cast<float>(uploadIndex) / count : 1.0f;
+    }
+
+    void ModelImporter::SetUseCache(bool use)
+    {
+        useCache = use;
+    }
+
+    bool ModelImporter::GetUseCache()
+    {
+        return useCache;
+    }
+
+    void ModelImporter::SetCompressTextures(bool compress)
+    {
+        compressTextures = compress;
+    }
+
+    bool ModelImporter::GetCompressTextures()
+    {
+        return compressTextures;
+    }
+
+    //Only the built-in diffuse and depth shaders decode compact layouts, keep the default for meshes drawn with custom shaders
+    void ModelImporter::SetVertexLayout(const VertexLayout &layout)
+    {
+        if(layout.IsValid())
+            vertexLayout = layout;
+    }
+
+    VertexLayout ModelImporter::GetVertexLayout()
+    {
+        return vertexLayout;
+    }
+
+    void ModelImporter::SetWorkerCount(uint32_t count)
+    {
+        workerCount = std::max(count, 1U);
+    }
+
+    uint32_t ModelImporter::GetWorkerCount()
+    {
+        return workerCount;
+    }
+
+    void ModelImporter::SetUploadTimeBudget(float milliseconds)
+    {
+        uploadTimeBudget = milliseconds;
+    }
+
+    float ModelImporter::GetUploadTimeBudget()
+    {
+        return uploadTimeBudget;
+    }
+
+    void ModelImporter::SetUploadByteBudget(size_t bytes)
+    {
+        uploadByteBudget = bytes;
+    }
+
+    size_t ModelImporter::GetUploadByteBudget()
+    {
+        return uploadByteBudget;
+    }
+
+    GameObject *ModelImporter::LoadFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ)
+    {
+        ModelImportHandle handle;
+
+        if(!LoadModel(filepath, modelFlags, scale, flipYZ, handle.model))
+            return nullptr;
 
         File file(filepath);
+        handle.directoryPath = file.GetDirectoryPath();
 
-        ProcessNode(model, scene->mRootNode, scene, scale, flipYZ, file.GetDirectoryPath());
+        ModelProcessor::DecodeTextures(handle.model, handle.directoryPath, compressTextures, handle.textures, workerCount);
+        UploadAll(handle);
 
-        return model;
+        return Instantiate(handle);
     }
 
     GameObject *ModelImporter::LoadFromMemory(const void *memory, size_t size, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ)
@@ -168,126 +258,217 @@ namespace GFX
             return nullptr;
         }
 
-        GameObject *model = GameObject::Create();
+        ModelImportHandle handle;
+        CookMeshes(handle.model, scene, scale, flipYZ, "");
+        CookNode(handle.model, scene->mRootNode, -1, scale);
 
-        ProcessNode(model, scene->mRootNode, scene, scale, flipYZ, "");
+        ModelProcessor::DecodeTextures(handle.model, handle.directoryPath, compressTextures, handle.textures, workerCount);
+        UploadAll(handle);
 
-        return model;
+        return Instantiate(handle);
+    }
+
+    std::shared_ptr<ModelImportHandle> ModelImporter::LoadAsyncFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ, const ModelImportCallback &callback)
+    {
+        auto handle = std::make_shared<ModelImportHandle>();
+        handle->callback = callback;
+
+        File file(filepath);
+        handle->directoryPath = file.GetDirectoryPath();
+
+        uint32_t workers = workerCount;
+        bool compress = compressTextures;
+
+        //The handle is only touched by the worker until it is queued, after that only by the main thread
+        JobSystem::Schedule([=] () {
+            if(LoadModel(filepath, modelFlags, scale, flipYZ, handle->model))
+            {
+                ModelProcessor::DecodeTextures(handle->model, handle->directoryPath, compress, handle->textures, workers);
+                handle->state = ModelImportState::Uploading;
+            }
+            else
+            {
+                handle->state = ModelImportState::Failed;
+            }
+
+            loadedModels.Enqueue(handle);
+        }, nullptr, JobPriority::Low);
+
+        return handle;
     }
 
     std::vector<std::shared_ptr<Mesh>> ModelImporter::LoadMeshesFromFile(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ)
     {
         std::vector<std::shared_ptr<Mesh>> meshes;
+        CookedModel model;
 
-        if(!std::filesystem::exists(filepath))
-        {
-            Debug::WriteLog("Error loading mesh: file does not exist: %s", filepath.c_str());
+        if(!LoadModel(filepath, modelFlags, scale, flipYZ, model))
             return meshes;
-        }
 
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(filepath, modelFlags);
-
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        for(size_t i = 0; i < model.meshes.size(); i++)
         {
-            Debug::WriteLog("Error loading mesh: %s", importer.GetErrorString());
-            return meshes;
+            const CookedMesh &cookedMesh = model.meshes[i];
+            auto mesh = std::make_shared<Mesh>(cookedMesh.vertices, cookedMesh.indices, false);
+            mesh->SetLODs(cookedMesh.lods);
+            mesh->SetVertexLayout(vertexLayout);
+            mesh->SetName(cookedMesh.name);
+            meshes.push_back(mesh);
         }
 
-        for(size_t i = 0; i < scene->mNumMeshes; i++)
-        {
-            aiMesh * aMesh = scene->mMeshes[i];
-            std::vector<Vertex> vertices;
-            vertices.resize(aMesh->mNumVertices);
+        return meshes;
+    }
 
-            if(aMesh->HasTextureCoords(0))
-            {
-                for(size_t j = 0; j < aMesh->mNumVertices; j++)
-                {
-                    auto pos = aMesh->mVertices[j];
-                    auto nrm = aMesh->mNormals[j];
-                    auto uv = aMesh->mTextureCoords[0][j];
+    void ModelImporter::NewFrame()
+    {
+        std::shared_ptr<ModelImportHandle> handle;
 
-                    if(flipYZ)
-                    {
-                        float y = pos.z;
-                        float z = pos.y;
-                        pos.y = y;
-                        pos.z = z;
-                    }
+        while(loadedModels.TryDequeue(handle))
+            uploadingModels.push_back(handle);
 
-                    vertices[j].position = Vector3(pos.x, pos.y, pos.z) * scale;
-                    vertices[j].normal = Vector3(nrm.x, nrm.y, nrm.z);
-                    vertices[j].uv = Vector2(uv.x, uv.y);
-                }
+        if(uploadingModels.size() == 0)
+            return;
+
+        //Uploads are spread over frames, at least one item is uploaded each frame so every model finishes
+        auto start = std::chrono::steady_clock::now();
+        size_t uploadedBytes = 0;
+        bool hasBudget = true;
+
+        while(uploadingModels.size() > 0 && hasBudget)
+        {
+            ModelImportHandle &current = *uploadingModels[0];
+
+            if(current.state == ModelImportState::Uploading && UploadNext(current, uploadedBytes))
+            {
+                std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                hasBudget = elapsed.count() < uploadTimeBudget && uploadedBytes < uploadByteBudget;
+                continue;
             }
-            else
+
+            if(current.state == ModelImportState::Uploading)
             {
-                for(size_t j = 0; j < aMesh->mNumVertices; j++)
-                {
-                    auto pos = aMesh->mVertices[j];
-                    auto nrm = aMesh->mNormals[j];
+                current.result = Instantiate(current);
+                current.state = current.result != nullptr ? ModelImportState::Done : ModelImportState::Failed;
+            }
 
-                    if(flipYZ)
-                    {
-                        float y = pos.z;
-                        float z = pos.y;
-                        pos.y = y;
-                        pos.z = z;
-                    }
+            auto finished = uploadingModels[0];
+            uploadingModels.erase(uploadingModels.begin());
 
-                    vertices[j].position = Vector3(pos.x, pos.y, pos.z) * scale;
-                    vertices[j].normal = Vector3(nrm.x, nrm.y, nrm.z);
-                    vertices[j].uv = Vector2(0.0f, 0.0f);
-                }
-            }
+            if(finished->callback)
+                finished->callback(finished->GetResult());
+        }
+    }
 
-            std::vector<GLuint> indices;
-            indices.resize(aMesh->mNumFaces * 3);
-            size_t index = 0;
+    bool ModelImporter::UploadNext(ModelImportHandle &handle, size_t &uploadedBytes)
+    {
+        size_t textureCount = handle.textures.size();
+        size_t meshCount = handle.model.meshes.size();
 
-            for(size_t j = 0; j < aMesh->mNumFaces; j++)
+        if(handle.uploadIndex >= textureCount + meshCount)
+            return false;
+
+        if(handle.uploadIndex < textureCount)
+        {
+            ModelTextureData &data = handle.textures[handle.uploadIndex];
+            Texture2D *texture = Resources::FindTexture2D(data.name);
+
+            //The mip chain was built on a worker, counted at its real size since all of it is handed to the streamer
+            if(texture == nullptr && data.isLoaded)
             {
-                indices[index+0] = aMesh->mFaces[j].mIndices[0];
-                indices[index+1] = aMesh->mFaces[j].mIndices[1];
-                indices[index+2] = aMesh->mFaces[j].mIndices[2];
-                index += 3;
+                uploadedBytes += data.compressed.GetDataSize();
+                texture = TextureStreamer::Add(data.name, std::move(data.compressed));
             }
 
-            auto mesh = std::make_shared<Mesh>(vertices, indices, false);
-            meshes.push_back(mesh);
+            //The streamer owns the chain now, a texture that was already loaded does not need it at all
+            data.compressed = CompressedTexture();
+
+            handle.uploadedTextures.push_back(texture);
+        }
+        else
+        {
+            CookedMesh &cookedMesh = handle.model.meshes[handle.uploadIndex - textureCount];
+            auto mesh = std::make_shared<Mesh>(cookedMesh.vertices, cookedMesh.indices, false);
+            mesh->SetLODs(cookedMesh.lods);
+            mesh->SetVertexLayout(vertexLayout);
+            mesh->Generate();
+            mesh->SetName(cookedMesh.name);
+
+            size_t vertexSize = vertexLayout.IsDefault() ? sizeof(Vertex) : vertexLayout.GetStride();
+            uploadedBytes += cookedMesh.vertices.size() * vertexSize + cookedMesh.indices.size() * sizeof(uint32_t);
+
+            cookedMesh.vertices = std::vector<Vertex>();
+            cookedMesh.indices = std::vector<uint32_t>();
+            cookedMesh.lods = std::vector<MeshLOD>();
+
+            handle.meshes.push_back(mesh);
         }
 
-        return meshes;
+        handle.uploadIndex++;
+        return true;
     }
 
-    void ModelImporter::ProcessNode(GameObject *parent, const aiNode* node, const aiScene* scene, const Vector3 &scale, bool flipYZ, const std::string directoryPath)
+    void ModelImporter::UploadAll(ModelImportHandle &handle)
     {
-        auto transformation = ToMatrix4(node->mTransformation);
-        parent->GetTransform()->SetPosition(Matrix4f::ExtractTranslation(transformation) * scale);
-        parent->GetTransform()->SetRotation(Matrix4f::ExtractRotation(transformation));
-        parent->GetTransform()->SetScale(Matrix4f::ExtractScale(transformation));
+        size_t uploadedBytes = 0;
+        handle.state = ModelImportState::Uploading;
 
-        MeshRenderer *renderer = nullptr;
-        
-        if(node->mNumMeshes > 0)
+        while(UploadNext(handle, uploadedBytes))
         {
-            std::string name(node->mName.C_Str());
-            parent->SetName(name);
-            renderer = parent->AddComponent<MeshRenderer>();
         }
+    }
 
-        auto texture = Resources::FindTexture2D(Constants::GetString(ConstantString::TextureDefault));
+    bool ModelImporter::LoadModel(const std::string &filepath, ModelFlags modelFlags, const Vector3 &scale, bool flipYZ, CookedModel &model)
+    {
+        if(!std::filesystem::exists(filepath))
+        {
+            Debug::WriteLog("Error loading model: file does not exist: %s", filepath.c_str());
+            return false;
+        }
+
+        uint64_t sourceHash = 0;
+        std::string cachePath = ModelCache::GetCachePath(filepath);
+
+        if(useCache)
+        {
+            if(!ModelCache::CalculateSourceHash(filepath, modelFlags, scale, flipYZ, sourceHash))
+            {
+                Debug::WriteLog("Error loading model: failed to read file: %s", filepath.c_str());
+                return false;
+            }
+
+            if(ModelCache::Load(cachePath, sourceHash, model))
+                return true;
+        }
+
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(filepath, modelFlags);
 
-        // Process all meshes in the current node
-        for (size_t i = 0; i < node->mNumMeshes; i++) 
+        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
-            aiMesh* aMesh = scene->mMeshes[node->mMeshes[i]];
+            Debug::WriteLog("Error loading model: %s", importer.GetErrorString());
+            return false;
+        }
+
+        File file(filepath);
+
+        model.sourceHash = sourceHash;
+        CookMeshes(model, scene, scale, flipYZ, file.GetDirectoryPath());
+        CookNode(model, scene->mRootNode, -1, scale);
+
+        if(useCache && !ModelCache::Save(cachePath, model))
+            Debug::WriteLog("Failed to write model cache: %s", cachePath.c_str());
+
+        return true;
+    }
+
+    void ModelImporter::CookMeshes(CookedModel &model, const aiScene *scene, const Vector3 &scale, bool flipYZ, const std::string &directoryPath)
+    {
+        model.meshes.resize(scene->mNumMeshes);
 
+        for(size_t i = 0; i < scene->mNumMeshes; i++)
+        {
+            aiMesh * aMesh = scene->mMeshes[i];
             std::vector<Vertex> vertices;
             vertices.resize(aMesh->mNumVertices);
-            
-            auto transformation = node->mTransformation * node->mParent->mTransformation;
 
             if(aMesh->HasTextureCoords(0))
             {
@@ -343,67 +524,134 @@ namespace GFX
                 index += 3;
             }
 
-            uint32_t materialIndex = aMesh->mMaterialIndex;
-            aiMaterial *aMaterial = scene->mMaterials[materialIndex];
+            aiMaterial *aMaterial = scene->mMaterials[aMesh->mMaterialIndex];
 
             //DumpTextureNames(aMaterial);
 
-            auto mesh = std::make_shared<Mesh>(vertices, indices, false);
-            mesh->Generate();
-            mesh->SetName(aMaterial->GetName().C_Str());
-
-            auto material = std::make_shared<DiffuseMaterial>();
-            material->SetName(aMaterial->GetName().C_Str());
+            CookedMesh &cookedMesh = model.meshes[i];
+            cookedMesh.name = aMaterial->GetName().C_Str();
+            cookedMesh.textureIndex = CookTexture(model, aMaterial, scene, directoryPath);
+            cookedMesh.vertices = std::move(vertices);
+            cookedMesh.indices = std::move(indices);
+        }
 
-            aiString texturePath;
+        //Optimizing, bounds and LODs only depend on the mesh itself
+        ModelProcessor::ProcessMeshes(model.meshes, workerCount);
+    }
 
-            if(aMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS)
-            {
-                auto embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
+    void ModelImporter::CookNode(CookedModel &model, const aiNode *node, int32_t parent, const Vector3 &scale)
+    {
+        auto transformation = ToMatrix4(node->mTransformation);
 
-                if(embeddedTexture)
-                {
-                    auto pTexture = LoadEmbeddedTexture(aMaterial, embeddedTexture);
+        CookedNode cookedNode;
+        cookedNode.name = node->mName.C_Str();
+        cookedNode.parent = parent;
+        cookedNode.position = Matrix4f::ExtractTranslation(transformation) * scale;
+        cookedNode.rotation = Matrix4f::ExtractRotation(transformation);
+        cookedNode.scale = Matrix4f::ExtractScale(transformation);
+        cookedNode.meshes.assign(node->mMeshes, node->mMeshes + node->mNumMeshes);
 
-                    if(pTexture != nullptr)
-                        material->SetDiffuseTexture(pTexture);
-                    else
-                        material->SetDiffuseTexture(texture);
-                }
-                else
-                {
-                    auto tex = LoadDiffuseTexture(aMaterial, directoryPath);
-                    material->SetDiffuseTexture(tex != nullptr ? tex : texture);
-                }
-            }
-            else
-            {
-                material->SetDiffuseTexture(texture);
-            }
-            
-            renderer->Add(mesh, material);
-        }
+        int32_t index = static_cast<int32_t>(model.nodes.size());
+        model.nodes.push_back(std::move(cookedNode));
 
         // Process all child nodes
         for (size_t i = 0; i < node->mNumChildren; i++) 
+            CookNode(model, node->mChildren[i], index, scale);
+    }
+
+    int32_t ModelImporter::CookTexture(CookedModel &model, const aiMaterial *pMaterial, const aiScene *scene, const std::string &directoryPath)
+    {
+        aiString texturePath;
+
+        if(pMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) != AI_SUCCESS)
+            return -1;
+
+        CookedTexture texture;
+        auto embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
+
+        if(embeddedTexture)
+        {
+            //Only compressed images (png, jpg, ...) are supported, those have a height of 0
+            if(embeddedTexture->mHeight != 0)
+                return -1;
+
+            const uint8_t *pData = reinterpret_cast<const uint8_t*>(embeddedTexture->pcData);
+            texture.name = embeddedTexture->mFilename.C_Str();
+            texture.isEmbedded = true;
+            texture.data.assign(pData, pData + embeddedTexture->mWidth);
+        }
+        else
         {
-            auto child = GameObject::Create();
-            child->SetName(std::string(node->mChildren[i]->mName.C_Str()));
-            child->GetTransform()->SetParent(parent->GetTransform());
-            ProcessNode(child, node->mChildren[i], scene, scale, flipYZ, directoryPath);
+            texture.name = FindDiffuseTexturePath(pMaterial, directoryPath);
+            texture.isEmbedded = false;
+
+            if(texture.name.size() == 0)
+                return -1;
+        }
+
+        for(size_t i = 0; i < model.textures.size(); i++)
+        {
+            if(model.textures[i].name == texture.name && model.textures[i].isEmbedded == texture.isEmbedded)
+                return static_cast<int32_t>(i);
         }
+
+        model.textures.push_back(std::move(texture));
+        return static_cast<int32_t>(model.textures.size() - 1);
     }
 
-    Texture2D *ModelImporter::LoadEmbeddedTexture(const aiMaterial *pMaterial, const aiTexture *pTexture)
+    GameObject *ModelImporter::Instantiate(ModelImportHandle &handle)
     {
-        unsigned int size = pTexture->mWidth;
-        Image image((uint8_t*)pTexture->pcData, size);
+        const CookedModel &model = handle.model;
+
+        if(model.nodes.size() == 0)
+            return nullptr;
+
+        auto defaultTexture = Resources::FindTexture2D(Constants::GetString(ConstantString::TextureDefault));
+        std::vector<GameObject*> objects(model.nodes.size(), nullptr);
 
-        if(image.IsLoaded())
+        for(size_t i = 0; i < model.nodes.size(); i++)
         {
-            return Resources::AddTexture2D(pTexture->mFilename.C_Str(), Texture2D(&image));
+            const CookedNode &node = model.nodes[i];
+            GameObject *object = GameObject::Create();
+
+            if(node.parent >= 0)
+            {
+                object->SetName(node.name);
+                object->GetTransform()->SetParent(objects[node.parent]->GetTransform());
+            }
+            else if(node.meshes.size() > 0)
+            {
+                object->SetName(node.name);
+            }
+
+            object->GetTransform()->SetPosition(node.position);
+            object->GetTransform()->SetRotation(node.rotation);
+            object->GetTransform()->SetScale(node.scale);
+            objects[i] = object;
+
+            if(node.meshes.size() == 0)
+                continue;
+
+            MeshRenderer *renderer = object->AddComponent<MeshRenderer>();
+
+            //Meshes referenced by several nodes share the same buffers
+            for(size_t j = 0; j < node.meshes.size(); j++)
+            {
+                uint32_t meshIndex = node.meshes[j];
+                const CookedMesh &cookedMesh = model.meshes[meshIndex];
+                Texture2D *texture = defaultTexture;
+
+                if(cookedMesh.textureIndex >= 0 && handle.uploadedTextures[cookedMesh.textureIndex] != nullptr)
+                    texture = handle.uploadedTextures[cookedMesh.textureIndex];
+
+                auto material = std::make_shared<DiffuseMaterial>();
+                material->SetName(cookedMesh.name);
+                material->SetDiffuseTexture(texture);
+
+                renderer->Add(handle.meshes[meshIndex], material);
+            }
         }
 
-        return nullptr;
+        return objects[0];
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,150 @@
+#include "ModelProcessor.hpp"
+#include "Mesh.hpp"
+#include "MeshOptimizer.hpp"
+#include "../Core/Debug.hpp"
+#include "../System/JobSystem.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+namespace GFX
+{
+    void ModelProcessor::ProcessMesh(CookedMesh &mesh)
+    {
+        MeshOptimizer::Optimize(mesh.vertices, mesh.indices);
+
+        mesh.boundsMin = Vector3(0, 0, 0);
+        mesh.boundsMax = Vector3(0, 0, 0);
+
+        if(mesh.vertices.size() > 0)
+        {
+            mesh.boundsMin = mesh.vertices[0].position;
+            mesh.boundsMax = mesh.vertices[0].position;
+
+            for(size_t i = 1; i < mesh.vertices.size(); i++)
+            {
+                mesh.boundsMin = glm::min(mesh.boundsMin, mesh.vertices[i].position);
+                mesh.boundsMax = glm::max(mesh.boundsMax, mesh.vertices[i].position);
+            }
+        }
+
+        //The mesh is only used to build the LOD chain, nothing is uploaded here
+        Mesh lodMesh(mesh.vertices, mesh.indices, false);
+        lodMesh.GenerateLODs();
+        mesh.lods = lodMesh.GetLODs();
+    }
+
+    void ModelProcessor::ProcessMeshes(std::vector<CookedMesh> &meshes, uint32_t workerCount)
+    {
+        ParallelFor(meshes.size(), workerCount, [&meshes] (size_t index) {
+            ProcessMesh(meshes[index]);
+        });
+    }
+
+    void ModelProcessor::DecodeTexture(const CookedTexture &texture, const std::string &directoryPath, bool compress, ModelTextureData &result)
+    {
+        result.isLoaded = false;
+        result.isCompressed = false;
+        result.compressed = CompressedTexture();
+
+        if(texture.isEmbedded)
+        {
+            result.name = texture.name;
+            result.isLoaded = GenerateMipChain(Image(texture.data.data(), texture.data.size()), result);
+            return;
+        }
+
+        result.name = directoryPath + "/" + texture.name;
+
+        //Prefer a texture that was compressed at import time, stored next to the source image.
+        //The full name is kept so that e.g. wood.png and wood.jpg don't share a file.
+        std::string compressedFilepath = result.name + ".ktx";
+
+        std::error_code error;
+        auto sourceTime = std::filesystem::last_write_time(result.name, error);
+        bool hasSource = !error;
+        auto compressedTime = std::filesystem::last_write_time(compressedFilepath, error);
+        bool isUpToDate = !error && (!hasSource || compressedTime >= sourceTime);
+
+        if(isUpToDate && TextureCompressor::LoadKTX(compressedFilepath, result.compressed))
+        {
+            result.isCompressed = true;
+            result.isLoaded = true;
+            return;
+        }
+
+        Image image(result.name);
+
+        if(!image.IsLoaded())
+            return;
+
+        if(compress && CompressTexture(image, result, compressedFilepath))
+            result.isLoaded = true;
+        else
+            result.isLoaded = GenerateMipChain(image, result);
+    }
+
+    void ModelProcessor::DecodeTextures(const CookedModel &model, const std::string &directoryPath, bool compress, std::vector<ModelTextureData> &textures, uint32_t workerCount)
+    {
+        textures.clear();
+        textures.resize(model.textures.size());
+
+        ParallelFor(model.textures.size(), workerCount, [&] (size_t index) {
+            DecodeTexture(model.textures[index], directoryPath, compress, textures[index]);
+        });
+    }
+
+    //Encodes the decoded image with a full mip chain and saves it, so the next import loads the .ktx instead
+    bool ModelProcessor::CompressTexture(const Image &image, ModelTextureData &texture, const std::string &filepath)
+    {
+        //Models only reference their diffuse texture
+        TextureCompressionFormat format = TextureCompressor::GetDefaultFormat(image, TextureUsage::Color);
+
+        if(format == TextureCompressionFormat::None)
+            return false;
+
+        if(!TextureCompressor::Compress(image, format, true, texture.compressed))
+            return false;
+
+        //Still used for this import if it can not be saved, e.g. for a read-only asset directory
+        if(!TextureCompressor::SaveKTX(filepath, texture.compressed))
+            Debug::WriteError("[MODELPROCESSOR] failed to save compressed texture %s", filepath.c_str());
+
+        texture.isCompressed = true;
+        return true;
+    }
+
+    //Uncompressed textures are streamed as an RGBA8 mip chain, the decoded image is released as soon as the chain is built
+    bool ModelProcessor::GenerateMipChain(const Image &image, ModelTextureData &texture)
+    {
+        if(!TextureCompressor::Compress(image, TextureCompressionFormat::None, true, texture.compressed))
+            return false;
+
+        texture.isCompressed = false;
+        return true;
+    }
+
+    void ModelProcessor::ParallelFor(size_t count, uint32_t workerCount, const std::function<void(size_t)> &job)
+    {
+        if(count == 0)
+            return;
+
+        if(workerCount <= 1 || count == 1)
+        {
+            for(size_t i = 0; i < count; i++)
+                job(i);
+            return;
+        }
+
+        //Items are handed out one at a time, large meshes don't hold up a whole range
+        JobSystem::ParallelForRange(count, 1, [&job] (size_t first, size_t last) {
+            for(size_t i = first; i < last; i++)
+                job(i);
+        }, JobPriority::Low);
+    }
+
+    uint32_t ModelProcessor::GetDefaultWorkerCount()
+    {
+        return std::max(std::thread::hardware_concurrency(), 1U);
+    }
+}
@@ -0,0 +1,473 @@
+#include "PostProcessingGraph.hpp"
+#include "Graphics.hpp"
+#include "Shaders/PostProcessingShader.hpp"
+#include "Shaders/PostProcessing/GrayscaleShader.hpp"
+#include "Shaders/PostProcessing/TonemapShader.hpp"
+#include "Shaders/PostProcessing/BlurComputeShader.hpp"
+#include "../Core/Constants.hpp"
+#include "../Core/Resources.hpp"
+#include "../Core/Debug.hpp"
+#include "../System/Hash.hpp"
+#include "../External/glad/glad.h"
+#include <algorithm>
+
+namespace GFX
+{
+	PostProcessingPass::PostProcessingPass()
+	{
+		type = PostProcessingPassType::Shader;
+		shader = nullptr;
+		downsample = 1;
+		iterations = 1;
+		threshold = 1.0f;
+		intensity = 0.5f;
+		enabled = true;
+	}
+
+	PostProcessingPass PostProcessingPass::CreateShader(Shader *shader)
+	{
+		PostProcessingPass pass;
+		pass.type = PostProcessingPassType::Shader;
+		pass.shader = shader;
+		return pass;
+	}
+
+	PostProcessingPass PostProcessingPass::CreatePerPixel(const std::string &functionName, const std::string &functionSource)
+	{
+		PostProcessingPass pass;
+		pass.type = PostProcessingPassType::PerPixel;
+		pass.functionName = functionName;
+		pass.functionSource = functionSource;
+		return pass;
+	}
+
+	PostProcessingPass PostProcessingPass::CreateBlur(uint32_t downsample, uint32_t iterations)
+	{
+		PostProcessingPass pass;
+		pass.type = PostProcessingPassType::Blur;
+		pass.downsample = downsample;
+		pass.iterations = iterations;
+		return pass;
+	}
+
+	PostProcessingPass PostProcessingPass::CreateBloom(float threshold, float intensity)
+	{
+		PostProcessingPass pass;
+		pass.type = PostProcessingPassType::Bloom;
+		pass.threshold = threshold;
+		pass.intensity = intensity;
+		return pass;
+	}
+
+	PostProcessingPass PostProcessingPass::CreateGrayscale()
+	{
+		return CreatePerPixel(GrayscaleShader::GetFunctionName(), GrayscaleShader::GetFunctionSource());
+	}
+
+	PostProcessingPass PostProcessingPass::CreateTonemap()
+	{
+		return CreatePerPixel(TonemapShader::GetFunctionName(), TonemapShader::GetFunctionSource());
+	}
+
+	PostProcessingGraph::PostProcessingGraph()
+	{
+		renderer = nullptr;
+		copyShader = nullptr;
+		blurShader = nullptr;
+		bloomThresholdShader = nullptr;
+		bloomCompositeShader = nullptr;
+		currentTarget = nullptr;
+		width = 0;
+		height = 0;
+	}
+
+	void PostProcessingGraph::Initialize(PostProcessingRenderer *renderer)
+	{
+		this->renderer = renderer;
+		copyShader = Resources::FindShader(Constants::GetString(ConstantString::ShaderPostProcessing));
+		blurShader = Resources::FindShader(Constants::GetString(ConstantString::ShaderBlurCompute));
+		bloomThresholdShader = Resources::FindShader(Constants::GetString(ConstantString::ShaderBloomThreshold));
+		bloomCompositeShader = Resources::FindShader(Constants::GetString(ConstantString::ShaderBloomComposite));
+	}
+
+	void PostProcessingGraph::Deinitialize()
+	{
+		pool.Delete();
+
+		for(auto &item : fusedShaders)
+			item.second.Delete();
+
+		fusedShaders.clear();
+		uniformLocations.clear();
+	}
+
+	void PostProcessingGraph::Render(const RenderTexture &source, uint32_t targetFbo, uint32_t targetWidth, uint32_t targetHeight)
+	{
+		if(renderer == nullptr || copyShader == nullptr)
+			return;
+
+		pool.NewFrame();
+
+		width = targetWidth;
+		height = targetHeight;
+		current = source;
+		currentTarget = nullptr;
+
+		Shader *finalShader = copyShader;
+
+		size_t index = 0;
+
+		while(index < passes.size())
+		{
+			const PostProcessingPass &pass = passes[index];
+
+			if(!pass.enabled)
+			{
+				index++;
+				continue;
+			}
+
+			if(pass.type == PostProcessingPassType::PerPixel)
+			{
+				size_t last = index;
+
+				while(last < passes.size() && (passes[last].type == PostProcessingPassType::PerPixel || !passes[last].enabled))
+					last++;
+
+				Shader *shader = GetFusedShader(index, last);
+
+				if(shader != nullptr && shader->IsReady())
+				{
+					// A trailing group is applied while writing to the target so it costs no extra pass
+					if(last == passes.size())
+					{
+						finalShader = shader;
+					}
+					else
+					{
+						RenderTexture *target = pool.Acquire(width, height);
+						DrawToTarget(target, shader, current);
+						SetCurrent(target);
+					}
+				}
+
+				index = last;
+				continue;
+			}
+
+			switch(pass.type)
+			{
+				case PostProcessingPassType::Shader:
+					RenderShaderPass(pass);
+					break;
+				case PostProcessingPassType::Blur:
+					RenderBlurPass(pass);
+					break;
+				case PostProcessingPassType::Bloom:
+					RenderBloomPass(pass);
+					break;
+				default:
+					break;
+			}
+
+			index++;
+		}
+
+		if(!finalShader->IsReady())
+			finalShader = copyShader;
+
+		glViewport(0, 0, targetWidth, targetHeight);
+		renderer->Render(targetFbo, finalShader->GetId(), current.textureId, Vector2(current.GetUVScaleX(), current.GetUVScaleY()));
+
+		if(currentTarget != nullptr)
+		{
+			pool.Release(currentTarget);
+			currentTarget = nullptr;
+		}
+	}
+
+	void PostProcessingGraph::Add(const PostProcessingPass &pass)
+	{
+		passes.push_back(pass);
+	}
+
+	void PostProcessingGraph::Remove(Shader *shader)
+	{
+		if(shader == nullptr)
+			return;
+
+		for(size_t i = passes.size(); i > 0; i--)
+		{
+			if(passes[i-1].type == PostProcessingPassType::Shader && passes[i-1].shader == shader)
+			{
+				passes.erase(passes.begin() + (i-1));
+				return;
+			}
+		}
+	}
+
+	void PostProcessingGraph::Clear()
+	{
+		passes.clear();
+	}
+
+	PostProcessingPass *PostProcessingGraph::GetPass(size_t index)
+	{
+		if(index >= passes.size())
+			return nullptr;
+		return &passes[index];
+	}
+
+	size_t PostProcessingGraph::GetPassCount() const
+	{
+		return passes.size();
+	}
+
+	RenderTexturePool *PostProcessingGraph::GetPool()
+	{
+		return &pool;
+	}
+
+	void PostProcessingGraph::SetCurrent(RenderTexture *target)
+	{
+		if(currentTarget != nullptr && currentTarget != target)
+			pool.Release(currentTarget);
+
+		currentTarget = target;
+		current = *target;
+	}
+
+	void PostProcessingGraph::DrawToTarget(RenderTexture *target, Shader *shader, const RenderTexture &source)
+	{
+		glViewport(0, 0, target->width, target->height);
+		renderer->Render(target->fbo, shader->GetId(), source.textureId, Vector2(source.GetUVScaleX(), source.GetUVScaleY()));
+	}
+
+	void PostProcessingGraph::Downsample(RenderTexture *target, Shader *shader, const RenderTexture &source)
+	{
+		// Internal passes don't go through the OnPostProcess callback
+		glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+		glViewport(0, 0, target->width, target->height);
+		renderer->Draw(shader->GetId(), source.textureId, Vector2(source.GetUVScaleX(), source.GetUVScaleY()));
+	}
+
+	void PostProcessingGraph::Blur(RenderTexture *texture, uint32_t iterations)
+	{
+		RenderTexture *temp = pool.Acquire(texture->width, texture->height);
+
+		for(uint32_t i = 0; i < iterations; i++)
+		{
+			Dispatch(*texture, temp, true);
+			Dispatch(*temp, texture, false);
+		}
+
+		pool.Release(temp);
+	}
+
+	void PostProcessingGraph::Dispatch(const RenderTexture &source, RenderTexture *target, bool horizontal)
+	{
+		uint32_t program = blurShader->GetId();
+
+		blurShader->Use();
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, source.textureId);
+		glUniform1i(GetUniformLocation(program, "uInput"), 0);
+		glUniform2i(GetUniformLocation(program, "uSize"), target->width, target->height);
+		glUniform2i(GetUniformLocation(program, "uDirection"), horizontal ? 1 : 0, horizontal ? 0 : 1);
+
+		glBindImageTexture(0, target->textureId, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+		uint32_t lineLength = horizontal ? target->width : target->height;
+		uint32_t lineCount = horizontal ? target->height : target->width;
+		uint32_t groups = (lineLength + BlurComputeShader::GROUP_SIZE - 1) / BlurComputeShader::GROUP_SIZE;
+
+		glDispatchCompute(groups, lineCount, 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+	}
+
+	void PostProcessingGraph::RenderShaderPass(const PostProcessingPass &pass)
+	{
+		if(pass.shader == nullptr || !pass.shader->IsReady())
+			return;
+
+		RenderTexture *target = pool.Acquire(width, height);
+		DrawToTarget(target, pass.shader, current);
+		SetCurrent(target);
+	}
+
+	void PostProcessingGraph::RenderBlurPass(const PostProcessingPass &pass)
+	{
+		if(blurShader == nullptr || !blurShader->IsReady())
+			return;
+
+		uint32_t downsample = std::clamp(pass.downsample, 1u, 8u);
+		uint32_t targetWidth = std::max(current.width / downsample, 1u);
+		uint32_t targetHeight = std::max(current.height / downsample, 1u);
+
+		RenderTexture *target = pool.Acquire(targetWidth, targetHeight);
+
+		if(downsample > 1)
+		{
+			// Halve repeatedly so bilinear filtering doesn't skip texels
+			RenderTexture source = current;
+			RenderTexture *intermediate = nullptr;
+
+			while(source.width / 2 > targetWidth && source.height / 2 > targetHeight)
+			{
+				RenderTexture *next = pool.Acquire(source.width / 2, source.height / 2);
+				Downsample(next, copyShader, source);
+				if(intermediate != nullptr)
+					pool.Release(intermediate);
+				intermediate = next;
+				source = *next;
+			}
+
+			Downsample(target, copyShader, source);
+
+			if(intermediate != nullptr)
+				pool.Release(intermediate);
+
+			Blur(target, pass.iterations);
+		}
+		else
+		{
+			RenderTexture *temp = pool.Acquire(targetWidth, targetHeight);
+			Dispatch(current, temp, true);
+			Dispatch(*temp, target, false);
+			pool.Release(temp);
+
+			if(pass.iterations > 1)
+				Blur(target, pass.iterations - 1);
+		}
+
+		// The next full resolution pass upsamples through bilinear filtering
+		SetCurrent(target);
+	}
+
+	void PostProcessingGraph::RenderBloomPass(const PostProcessingPass &pass)
+	{
+		if(blurShader == nullptr || !blurShader->IsReady())
+			return;
+		if(bloomThresholdShader == nullptr || !bloomThresholdShader->IsReady())
+			return;
+		if(bloomCompositeShader == nullptr || !bloomCompositeShader->IsReady())
+			return;
+
+		RenderTexture *half = pool.Acquire(std::max(current.width / 2, 1u), std::max(current.height / 2, 1u));
+		RenderTexture *quarter = pool.Acquire(std::max(current.width / 4, 1u), std::max(current.height / 4, 1u));
+
+		uint32_t thresholdProgram = bloomThresholdShader->GetId();
+		glUseProgram(thresholdProgram);
+		glUniform1f(GetUniformLocation(thresholdProgram, "uThreshold"), pass.threshold);
+		Downsample(half, bloomThresholdShader, current);
+		Downsample(quarter, copyShader, *half);
+		pool.Release(half);
+
+		Blur(quarter, pass.iterations);
+
+		uint32_t compositeProgram = bloomCompositeShader->GetId();
+		glUseProgram(compositeProgram);
+		glUniform1i(GetUniformLocation(compositeProgram, "colorBuffer"), 0);
+		glUniform1i(GetUniformLocation(compositeProgram, "bloomBuffer"), 1);
+		glUniform2f(GetUniformLocation(compositeProgram, "uBloomUVScale"), quarter->GetUVScaleX(), quarter->GetUVScaleY());
+		glUniform1f(GetUniformLocation(compositeProgram, "uIntensity"), pass.intensity);
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, quarter->textureId);
+
+		RenderTexture *target = pool.Acquire(width, height);
+		Downsample(target, bloomCompositeShader, current);
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glActiveTexture(GL_TEXTURE0);
+
+		pool.Release(quarter);
+		SetCurrent(target);
+	}
+
+	Shader *PostProcessingGraph::GetFusedShader(size_t first, size_t last)
+	{
+		uint64_t key = Hash::FNV_OFFSET_BASIS_64;
+
+		for(size_t i = first; i < last; i++)
+		{
+			if(!passes[i].enabled)
+				continue;
+			key = Hash::FNV1a64(passes[i].functionName, key);
+			key = Hash::FNV1a64(passes[i].functionSource, key);
+		}
+
+		auto it = fusedShaders.find(key);
+
+		if(it != fusedShaders.end())
+			return &it->second;
+
+		std::string functions;
+		std::string calls;
+		std::vector<std::string> declared;
+
+		for(size_t i = first; i < last; i++)
+		{
+			if(!passes[i].enabled)
+				continue;
+
+			// The same effect can appear more than once but may only be declared once
+			if(std::find(declared.begin(), declared.end(), passes[i].functionName) == declared.end())
+			{
+				functions += passes[i].functionSource + "\n\n";
+				declared.push_back(passes[i].functionName);
+			}
+
+			calls += "\tcolor = " + passes[i].functionName + "(color);\n";
+		}
+
+		std::string fragmentSource = "#version 330 core\n"
+			"#include <Core>\n"
+			"uniform sampler2D colorBuffer;\n\n"
+			"in vec2 oUV;\n"
+			"out vec4 FragColor;\n\n" +
+			functions +
+			"void main() {\n"
+			"\tvec4 color = texture(colorBuffer, oUV);\n" +
+			calls +
+			"\tFragColor = color;\n"
+			"}";
+
+		fusedShaders[key] = Shader(PostProcessingShader::GetVertexSource(), fragmentSource);
+
+		Shader *shader = &fusedShaders[key];
+
+		if(shader->GetId() == 0)
+		{
+			Debug::WriteError("[POSTPROCESSING] failed to create fused shader");
+			return nullptr;
+		}
+
+		Graphics::BindShaderToUniformBuffers(shader);
+
+		return shader;
+	}
+
+	int32_t PostProcessingGraph::GetUniformLocation(uint32_t program, const char *name)
+	{
+		uint64_t key = Hash::FNV1a64(name, std::char_traits<char>::length(name));
+
+		auto &locations = uniformLocations[program];
+		auto it = locations.find(key);
+
+		if(it != locations.end())
+			return it->second;
+
+		int32_t location = glGetUniformLocation(program, name);
+		locations[key] = location;
+		return location;
+	}
+
+	//Program ids are reused by the driver once deleted, so cached locations must not outlive the program
+	void PostProcessingGraph::ClearShaderUniforms(uint32_t program)
+	{
+		uniformLocations.erase(program);
+	}
+}
@@ -2,9 +2,12 @@
 #include "../../Core/Camera.hpp"
 #include "../../Core/GameObject.hpp"
 #include "../../Core/Transform.hpp"
+#include "../../Core/Time.hpp"
 #include "../../External/glad/glad.h"
 #include "../GL.hpp"
 #include "../Graphics.hpp"
+#include "../TextureStreamer.hpp"
+#include <algorithm>
 
 namespace GFX
 {
@@ -13,6 +16,9 @@ namespace GFX
         this->mesh = nullptr;
         this->pMesh = mesh;
         this->pMaterial = material;
+        this->lodLevel = 0;
+        this->previousLodLevel = 0;
+        this->lodFade = 1.0f;
     }
 
     MeshRendererData::MeshRendererData(const std::shared_ptr<Mesh> &mesh, const std::shared_ptr<Material> &material)
@@ -20,6 +26,9 @@ namespace GFX
         this->mesh = mesh;
         this->pMesh = this->mesh.get();
         this->pMaterial = material;
+        this->lodLevel = 0;
+        this->previousLodLevel = 0;
+        this->lodFade = 1.0f;
     }
 
     MeshRenderer::MeshRenderer() : Renderer()
@@ -30,12 +39,16 @@ namespace GFX
 
     void MeshRenderer::OnInitialize()
     {
+        MeshRendererState initialState;
+        initialState.isVisible = false;
+        state.Create(this, initialState);
         Graphics::Add(this);
     }
 
     void MeshRenderer::OnDestroy()
     {
         Graphics::Remove(this);
+        state.Destroy();
     }
 
     void MeshRenderer::Add(Mesh *mesh, const std::shared_ptr<Material> &material)
@@ -57,6 +70,11 @@ namespace GFX
         data.erase(data.begin() + index);
     }
 
+    size_t MeshRenderer::GetCount() const
+    {
+        return data.size();
+    }
+
     void MeshRenderer::SetMesh(Mesh *mesh, size_t index)
     {
         if(data.size() == 0)
@@ -103,8 +121,84 @@ namespace GFX
         data[index].pMaterial = material;
     }
 
+    LODGroup *MeshRenderer::GetLODGroup()
+    {
+        return &lodGroup;
+    }
+
+    uint32_t MeshRenderer::GetLODLevel(size_t index) const
+    {
+        if(data.size() == 0)
+            return 0;
+        if(index >= data.size())
+            return 0;
+        return data[index].lodLevel;
+    }
+
+    BoundingBox MeshRenderer::GetBounds() const
+    {
+        const MeshRendererState *current = state.Get();
+        return current ? current->bounds : BoundingBox();
+    }
+
+    bool MeshRenderer::GetIsVisible() const
+    {
+        const MeshRendererState *current = state.Get();
+        return current ? current->isVisible : false;
+    }
+
+    void MeshRenderer::UpdateLOD(MeshRendererData &entry, const BoundingBox &worldBounds, Camera *camera)
+    {
+        uint32_t levelCount = static_cast<uint32_t>(entry.pMesh->GetLODCount());
+
+        if(levelCount <= 1)
+        {
+            entry.lodLevel = 0;
+            entry.lodFade = 1.0f;
+            return;
+        }
+
+        Vector3 cameraPosition = camera->GetTransform()->GetPosition();
+        float coverage = LODGroup::CalculateScreenCoverage(worldBounds, cameraPosition, camera->GetFieldOfView());
+        uint32_t level = lodGroup.SelectLevel(coverage, entry.lodLevel, levelCount);
+
+        if(level != entry.lodLevel)
+        {
+            //Switching again mid fade starts from whatever level is currently dominant
+            entry.previousLodLevel = entry.lodFade >= 0.5f ? entry.lodLevel : entry.previousLodLevel;
+            entry.lodLevel = level;
+            entry.lodFade = lodGroup.crossfadeDuration > 0.0f ? 0.0f : 1.0f;
+        }
+        else if(entry.lodFade < 1.0f)
+        {
+            if(lodGroup.crossfadeDuration > 0.0f)
+                entry.lodFade = std::min(entry.lodFade + Time::GetDeltaTime() / lodGroup.crossfadeDuration, 1.0f);
+            else
+                entry.lodFade = 1.0f;
+        }
+    }
+
+    void MeshRenderer::Draw(Mesh *mesh, uint32_t lodLevel)
+    {
+        if(mesh->GetEBO()->GetId() > 0)
+        {
+            size_t indexSize = mesh->GetIndexType() == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+            const GLvoid *offset = (const GLvoid*)(mesh->GetLODIndexOffset(lodLevel) * indexSize);
+            glDrawElements(GL_TRIANGLES, mesh->GetLODIndicesCount(lodLevel), mesh->GetIndexType(), offset);
+        }
+        else
+        {
+            glDrawArrays(GL_TRIANGLES, 0, mesh->GetVerticesCount());
+        }
+    }
+
     void MeshRenderer::OnRender()
     {
+        MeshRendererState *current = state.Get();
+
+        if(current)
+            current->isVisible = false;
+
         if(!GetGameObject()->GetIsActive())
             return;
 
@@ -120,6 +214,8 @@ namespace GFX
         Frustum *frustum = camera->GetFrustum();
         uint32_t layer = static_cast<uint32_t>(transform->GetGameObject()->GetLayer());
         bool ignoreCulling = (layer & Layer_IgnoreCulling);
+        BoundingBox worldBounds;
+        bool isVisible = false;
 
         for(size_t i = 0; i < data.size(); i++)
         {
@@ -139,15 +235,27 @@ namespace GFX
             if(!pMaterial->GetShader())
                 continue;
 
-            if(!ignoreCulling)
+            // Draw with the fallback material until the program has finished compiling
+            if(!pMaterial->GetShader()->IsReady())
             {
-                auto bounds = pMesh->GetBounds();
-                bounds.Transform(transform->GetModelMatrix());
+                pMaterial = Graphics::GetFallbackMaterial();
 
-                if(!frustum->Contains(bounds))
+                if(!pMaterial || !pMaterial->GetShader()->IsReady())
                     continue;
             }
 
+            auto bounds = pMesh->GetBounds();
+            bounds.Transform(transform->GetModelMatrix());
+            worldBounds.Grow(bounds.GetMin(), bounds.GetMax());
+
+            if(!ignoreCulling && !frustum->Contains(bounds))
+                continue;
+
+            isVisible = true;
+
+            TextureStreamer::RequestMip(pMaterial->GetMainTexture(), bounds, camera);
+            UpdateLOD(data[i], bounds, camera);
+
             auto &settings = data[i].settings;
 			
 			GL::DepthTest(settings.depthTest);
@@ -156,16 +264,35 @@ namespace GFX
 			GL::SetDepthFunc(settings.depthFunc);
 
             pMaterial->Use(transform, camera);
+            pMesh->SetVertexUniforms(pMaterial->GetShader());
 
             pMesh->GetVAO()->Bind();
 
-            if(pMesh->GetEBO()->GetId() > 0)
-                glDrawElements(GL_TRIANGLES, pMesh->GetIndicesCount(), GL_UNSIGNED_INT, 0);
+            const MeshRendererData &entry = data[i];
+
+            //During a crossfade both levels are drawn with complementary dither patterns
+            if(entry.lodFade < 1.0f && entry.previousLodLevel != entry.lodLevel)
+            {
+                Mesh::SetLODFadeUniform(pMaterial->GetShader(), std::max(entry.lodFade, 0.001f));
+                Draw(pMesh, entry.lodLevel);
+                Mesh::SetLODFadeUniform(pMaterial->GetShader(), -std::max(entry.lodFade, 0.001f));
+                Draw(pMesh, entry.previousLodLevel);
+                Mesh::SetLODFadeUniform(pMaterial->GetShader(), 0.0f);
+            }
             else
-                glDrawArrays(GL_TRIANGLES, 0, pMesh->GetVerticesCount());
+            {
+                Draw(pMesh, entry.lodLevel);
+            }
 
             pMesh->GetVAO()->Unbind();
         }
+
+        //Drawing doesn't change the layout of the storage, the pointer from the start is still valid
+        if(current)
+        {
+            current->bounds = worldBounds;
+            current->isVisible = isVisible;
+        }
     }
 
     void MeshRenderer::OnRender(Material *material, Camera *camera)
@@ -202,13 +329,12 @@ namespace GFX
 			GL::SetDepthFunc(settings.depthFunc);
 
             material->Use(transform, camera);
+            pMesh->SetVertexUniforms(material->GetShader());
 
             pMesh->GetVAO()->Bind();
 
-            if(pMesh->GetEBO()->GetId() > 0)
-                glDrawElements(GL_TRIANGLES, pMesh->GetIndicesCount(), GL_UNSIGNED_INT, 0);
-            else
-                glDrawArrays(GL_TRIANGLES, 0, pMesh->GetVerticesCount());
+            //Shadows and other passes use the level picked by the main pass, without crossfading
+            Draw(pMesh, data[i].lodLevel);
 
             pMesh->GetVAO()->Unbind();
         }
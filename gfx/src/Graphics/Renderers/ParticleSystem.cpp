@@ -278,6 +278,9 @@ namespace GFX
 		if (!material->GetShader())
 			return;
 
+		if (!material->GetShader()->IsReady())
+			return;
+
 		Update();
 
 		if(activeParticles == 0)
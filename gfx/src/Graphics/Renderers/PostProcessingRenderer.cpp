@@ -39,24 +39,59 @@ namespace GFX
 	{
 		vao.Delete();
 		vbo.Delete();
+		uvScaleLocations.clear();
 	}
 
 	void PostProcessingRenderer::Render(uint32_t fbo, uint32_t shaderId, uint32_t textureId)
 	{
+		Render(fbo, shaderId, textureId, Vector2(1.0f, 1.0f));
+	}
+
+	void PostProcessingRenderer::Render(uint32_t fbo, uint32_t shaderId, uint32_t textureId, const Vector2 &uvScale)
+	{
+		// The caller owns framebuffer state, so there is no unbind after drawing.
+		// Every pass covers the full viewport which makes clearing unnecessary.
 		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+		glUseProgram(shaderId);
+
+		GameBehaviour::OnBehaviourPostProcess(shaderId);
+
+		Draw(shaderId, textureId, uvScale);
+	}
+
+	void PostProcessingRenderer::Draw(uint32_t shaderId, uint32_t textureId, const Vector2 &uvScale)
+	{
 		glDisable(GL_DEPTH_TEST);
-		glClear(GL_COLOR_BUFFER_BIT);
 
 		glUseProgram(shaderId);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, textureId);
 
-		GameBehaviour::OnBehaviourPostProcess(shaderId);
+		int32_t uUVScale = GetUVScaleLocation(shaderId);
+
+		if(uUVScale >= 0)
+			glUniform2f(uUVScale, uvScale.x, uvScale.y);
 
 		vao.Bind();
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 		vao.Unbind();
+	}
+
+	int32_t PostProcessingRenderer::GetUVScaleLocation(uint32_t shaderId)
+	{
+		auto it = uvScaleLocations.find(shaderId);
+
+		if(it != uvScaleLocations.end())
+			return it->second;
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		int32_t location = glGetUniformLocation(shaderId, "uUVScale");
+		uvScaleLocations[shaderId] = location;
+		return location;
+	}
+
+	void PostProcessingRenderer::ClearShaderUniforms(uint32_t shaderId)
+	{
+		uvScaleLocations.erase(shaderId);
 	}
 }
\ No newline at end of file
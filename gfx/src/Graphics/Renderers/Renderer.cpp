@@ -1,4 +1,6 @@
 #include "Renderer.hpp"
+#include "../Shadow.hpp"
+#include "../Graphics.hpp"
 
 namespace GFX
 {
@@ -14,7 +16,10 @@ namespace GFX
     Renderer::Renderer() : Component()
     {
         castShadows = true;
+        receiveShadows = true;
+        isStatic = false;
         renderOrder = 1000;
+        rendererIndex = INVALID_INDEX;
     }
 
     Mesh *Renderer::GetMesh(size_t index) const
@@ -24,6 +29,8 @@ namespace GFX
 
     void Renderer::SetCastShadows(bool castShadows)
     {
+        if(isStatic && this->castShadows != castShadows)
+            Shadow::InvalidateStaticCasters();
         this->castShadows = castShadows;
     }
 
@@ -42,8 +49,23 @@ namespace GFX
         return receiveShadows;
     }
 
+    //Static renderers are not expected to move, their shadows are cached until a static caster changes
+    void Renderer::SetStatic(bool isStatic)
+    {
+        if(castShadows && this->isStatic != isStatic)
+            Shadow::InvalidateStaticCasters();
+        this->isStatic = isStatic;
+    }
+
+    bool Renderer::GetStatic() const
+    {
+        return isStatic;
+    }
+
     void Renderer::SetRenderOrder(uint32_t order)
     {
+        if(rendererIndex != INVALID_INDEX && renderOrder != order)
+            Graphics::renderQueueDirty = true;
         this->renderOrder = order;
     }
 
@@ -62,6 +62,8 @@ namespace GFX
         material->SetTexture4(texture);
 
         mesh = MeshGenerator::CreateTerrain(width, depth, Vector3(scale, scale, scale));
+        mesh.SetDynamic(true);
+        mesh.SetVertexLayout(vertexLayout);
         mesh.Generate();
 
         Graphics::Add(this);
@@ -90,7 +92,16 @@ namespace GFX
         if(!material->GetShader())
             return;
 
-        material->Use(transform, camera);
+        Material *pMaterial = material.get();
+
+        if(!pMaterial->GetShader()->IsReady())
+            pMaterial = Graphics::GetFallbackMaterial();
+
+        if(!pMaterial || !pMaterial->GetShader()->IsReady())
+            return;
+
+        pMaterial->Use(transform, camera);
+        mesh.SetVertexUniforms(pMaterial->GetShader());
 
         mesh.GetVAO()->Bind();
 
@@ -99,7 +110,7 @@ namespace GFX
         GL::BlendMode(false);
 
         if(mesh.GetEBO()->GetId() > 0)
-            glDrawElements(GL_TRIANGLES, mesh.GetIndicesCount(), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, mesh.GetIndicesCount(), mesh.GetIndexType(), 0);
         else
             glDrawArrays(GL_TRIANGLES, 0, mesh.GetVerticesCount());
         
@@ -123,6 +134,7 @@ namespace GFX
             return;
 
         material->Use(transform, camera);
+        mesh.SetVertexUniforms(material->GetShader());
 
         mesh.GetVAO()->Bind();
 
@@ -131,7 +143,7 @@ namespace GFX
         GL::BlendMode(false);
 
         if(mesh.GetEBO()->GetId() > 0)
-            glDrawElements(GL_TRIANGLES, mesh.GetIndicesCount(), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, mesh.GetIndicesCount(), mesh.GetIndexType(), 0);
         else
             glDrawArrays(GL_TRIANGLES, 0, mesh.GetVerticesCount());
         
@@ -141,7 +153,8 @@ namespace GFX
 
     void Terrain::Update()
     {
-        mesh.Generate();
+        //Only the edited vertices and their neighbours are recalculated and uploaded
+        mesh.Update(true);
     }
 
     void Terrain::SetHeight(uint32_t x, uint32_t y, float height, TerrainHeightMode mode, bool update)
@@ -164,6 +177,7 @@ namespace GFX
                     newHeight = maxHeight;
                 vertices[index].position.y = newHeight;
             }
+            mesh.MarkVerticesDirty(index, 1);
             if(update)
                 Update();
         }
@@ -459,7 +473,7 @@ namespace GFX
         }
 
         mesh.RecalculateNormals();
-        mesh.Generate();
+        mesh.Update();
     }
 
     float Terrain::GetScale() const
@@ -477,6 +491,26 @@ namespace GFX
         return maxHeight;
     }
 
+    //Compact positions are relative to the bounds, edits that raise or lower the highest point upload the whole mesh again
+    void Terrain::SetVertexLayout(const VertexLayout &layout)
+    {
+        if(!layout.IsValid())
+            return;
+
+        vertexLayout = layout;
+
+        if(mesh.GetVAO()->GetId() > 0)
+        {
+            mesh.SetVertexLayout(layout);
+            mesh.Update();
+        }
+    }
+
+    VertexLayout Terrain::GetVertexLayout() const
+    {
+        return vertexLayout;
+    }
+
     TerrainMaterial *Terrain::GetMaterial() const
     {
         return material.get();
@@ -1,12 +1,43 @@
 #include "Shader.hpp"
+#include "Graphics.hpp"
+#include "Graphics2D.hpp"
+#include "Mesh.hpp"
 #include "Shaders/CoreShaderInclude.hpp"
 #include "../Core/Debug.hpp"
 #include "../System/String.hpp"
+#include "../System/Hash.hpp"
+#include "../System/FrameArena.hpp"
+#include "../System/IO/File.hpp"
 #include "../External/glad/glad.h"
+#include "../../libs/glfw/include/GLFW/glfw3.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace GFX
 {
+    typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+    static constexpr uint32_t PROGRAM_BINARY_MAGIC = 0x50584647; // 'GFXP'
+    static constexpr uint32_t PROGRAM_BINARY_VERSION = 1;
+
     std::unordered_map<std::string, std::string> Shader::includesMap;
+    std::unordered_map<uint32_t, PendingProgram> Shader::pendingPrograms;
+    std::unordered_set<uint32_t> Shader::failedPrograms;
+    std::string Shader::cacheDirectory = "shadercache";
+    std::string Shader::driverInfo;
+    bool Shader::compilerInitialized = false;
+    bool Shader::binaryCacheSupported = false;
+    bool Shader::parallelCompileSupported = false;
 
     static uint32_t Compile(const std::string &source, GLenum type)
     {
@@ -17,110 +48,193 @@ namespace GFX
         return shader;
     }
 
-    Shader::Shader()
+    static GLenum GetShaderType(ShaderType type)
     {
-        id = 0;
+        switch(type)
+        {
+            case ShaderType::Vertex:
+                return GL_VERTEX_SHADER;
+            case ShaderType::Geometry:
+                return GL_GEOMETRY_SHADER;
+            case ShaderType::Fragment:
+                return GL_FRAGMENT_SHADER;
+            case ShaderType::Compute:
+                return GL_COMPUTE_SHADER;
+            default:
+                return 0;
+        }
     }
 
-    Shader::Shader(const std::string &vertexSource, const std::string &fragmentSource)
+    //Drivers report "0(12)", "0:12(5)" or "ERROR: 0:12:" in front of each message, the first number is the source string
+    static bool GetInfoLogLineNumber(const std::string &message, size_t &lineNumber)
     {
-        id = 0;
+        size_t position = 0;
 
-        std::string sVertexSource = AddIncludes(vertexSource);
-        std::string sFragmentSource = AddIncludes(fragmentSource);    
+        while(position < message.size() && isspace(static_cast<unsigned char>(message[position])))
+            position++;
 
-        uint32_t vertexShader = Compile(sVertexSource, GL_VERTEX_SHADER);
-        
-        if(!CheckShader(vertexShader, ShaderType::Vertex, sVertexSource))
+        for(const char *prefix : { "ERROR:", "WARNING:" })
         {
-            glDeleteShader(vertexShader);
-            return;
+            if(message.compare(position, strlen(prefix), prefix) == 0)
+            {
+                position += strlen(prefix);
+                while(position < message.size() && message[position] == ' ')
+                    position++;
+                break;
+            }
         }
 
-        uint32_t fragmentShader = Compile(sFragmentSource, GL_FRAGMENT_SHADER);
-        
-        if(!CheckShader(fragmentShader, ShaderType::Fragment, sFragmentSource))
+        if(position >= message.size() || !isdigit(static_cast<unsigned char>(message[position])))
+            return false;
+
+        while(position < message.size() && isdigit(static_cast<unsigned char>(message[position])))
+            position++;
+
+        if(position >= message.size() || (message[position] != '(' && message[position] != ':'))
+            return false;
+
+        position++;
+
+        if(position >= message.size() || !isdigit(static_cast<unsigned char>(message[position])))
+            return false;
+
+        lineNumber = 0;
+
+        while(position < message.size() && isdigit(static_cast<unsigned char>(message[position])))
+            lineNumber = lineNumber * 10 + (message[position++] - '0');
+
+        return lineNumber > 0;
+    }
+
+    //Only the lines around the reported errors, the whole source with its includes is far too long to read in a log
+    static void WriteSourceContext(const std::string &source, const char *infoLog)
+    {
+        const size_t contextLineCount = 3;
+        auto lines = String::Split(source, '\n');
+        auto messages = String::Split(infoLog, '\n');
+        std::vector<bool> isVisible(lines.size(), false);
+        bool hasLines = false;
+
+        for(size_t i = 0; i < messages.size(); i++)
         {
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
-            return;
+            size_t lineNumber;
+
+            if(!GetInfoLogLineNumber(messages[i], lineNumber) || lineNumber > lines.size())
+                continue;
+
+            size_t first = lineNumber > contextLineCount ? lineNumber - 1 - contextLineCount : 0;
+            size_t last = std::min(lineNumber - 1 + contextLineCount, lines.size() - 1);
+
+            for(size_t j = first; j <= last; j++)
+                isVisible[j] = true;
+
+            hasLines = true;
         }
 
-        id = glCreateProgram();
+        if(!hasLines)
+            return;
 
-        glAttachShader(id, vertexShader);
-        glAttachShader(id, fragmentShader);
-        glLinkProgram(id);
-        
-        if(!CheckShader(id, ShaderType::Program, sFragmentSource))
+        for(size_t i = 0; i < lines.size(); i++)
         {
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
-            glDeleteProgram(id);
-            id = 0;
-            return;
+            if(!isVisible[i])
+                continue;
+
+            if(i > 0 && !isVisible[i - 1])
+                Debug::WriteError("  ...");
+
+            Debug::WriteError("%4d: %s", static_cast<int>(i + 1), lines[i].c_str());
         }
+    }
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+    Shader::Shader()
+    {
+        id = 0;
+    }
+
+    Shader::Shader(const std::string &computeSource)
+    {
+        id = 0;
+
+        std::vector<ShaderStage> stages = {
+            { ShaderType::Compute, AddIncludes(computeSource) }
+        };
+
+        Create(stages);
+    }
+
+    Shader::Shader(const std::string &vertexSource, const std::string &fragmentSource)
+    {
+        id = 0;
+
+        std::vector<ShaderStage> stages = {
+            { ShaderType::Vertex, AddIncludes(vertexSource) },
+            { ShaderType::Fragment, AddIncludes(fragmentSource) }
+        };
+
+        Create(stages);
     }
 
     Shader::Shader(const std::string &vertexSource, const std::string &fragmentSource, const std::string &geometrySource)
     {
         id = 0;
 
-        std::string sVertexSource = AddIncludes(vertexSource);
-        std::string sGeometrySource = AddIncludes(geometrySource);
-        std::string sFragmentSource = AddIncludes(fragmentSource);
+        std::vector<ShaderStage> stages = {
+            { ShaderType::Vertex, AddIncludes(vertexSource) },
+            { ShaderType::Geometry, AddIncludes(geometrySource) },
+            { ShaderType::Fragment, AddIncludes(fragmentSource) }
+        };
 
-        uint32_t vertexShader = Compile(sVertexSource, GL_VERTEX_SHADER);
-        
-        if(!CheckShader(vertexShader, ShaderType::Vertex, sVertexSource))
-        {
-            glDeleteShader(vertexShader);
-            return;
-        }
+        Create(stages);
+    }
 
-        uint32_t geometryShader = Compile(sGeometrySource, GL_GEOMETRY_SHADER);
-        
-        if(!CheckShader(geometryShader, ShaderType::Geometry, sGeometrySource))
-        {
-            glDeleteShader(vertexShader);
-            glDeleteShader(geometryShader);
+    void Shader::Create(const std::vector<ShaderStage> &stages)
+    {
+        InitializeCompiler();
+
+        uint64_t cacheKey = GetCacheKey(stages);
+
+        id = glCreateProgram();
+
+        if(LoadProgramBinary(id, cacheKey))
             return;
-        }
 
-        uint32_t fragmentShader = Compile(sFragmentSource, GL_FRAGMENT_SHADER);
-        
-        if(!CheckShader(fragmentShader, ShaderType::Fragment, sFragmentSource))
+        PendingProgram pending;
+        pending.cacheKey = cacheKey;
+
+        for(size_t i = 0; i < stages.size(); i++)
         {
-            glDeleteShader(vertexShader);
-            glDeleteShader(geometryShader);
-            glDeleteShader(fragmentShader);
-            return;
+            uint32_t shader = Compile(stages[i].source, GetShaderType(stages[i].type));
+            pending.shaders.push_back(shader);
+            pending.types.push_back(stages[i].type);
+            pending.sources.push_back(stages[i].source);
+
+            // Without parallel compilation the status can be checked right away, which avoids a pointless link
+            if(!parallelCompileSupported && !CheckShader(shader, stages[i].type, stages[i].source))
+            {
+                for(size_t j = 0; j < pending.shaders.size(); j++)
+                    glDeleteShader(pending.shaders[j]);
+                glDeleteProgram(id);
+                id = 0;
+                return;
+            }
         }
 
-        // Link shaders
-        id = glCreateProgram();
+        for(size_t i = 0; i < pending.shaders.size(); i++)
+            glAttachShader(id, pending.shaders[i]);
+
+        if(binaryCacheSupported)
+            glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-        glAttachShader(id, vertexShader);
-        glAttachShader(id, geometryShader);
-        glAttachShader(id, fragmentShader);
         glLinkProgram(id);
 
-        if(!CheckShader(id, ShaderType::Program, sFragmentSource))
-        {
-            glDeleteShader(vertexShader);
-            glDeleteShader(geometryShader);
-            glDeleteShader(fragmentShader);
-            glDeleteProgram(id);
-            id = 0;
+        pendingPrograms[id] = pending;
+
+        // The driver compiles and links in the background, the result is picked up by UpdatePendingPrograms
+        if(parallelCompileSupported)
             return;
-        }
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(geometryShader);
-        glDeleteShader(fragmentShader);
+        if(!FinalizeProgram(id))
+            id = 0;
     }
 
     uint32_t Shader::GetId() const
@@ -128,8 +242,37 @@ namespace GFX
         return id;
     }
 
+    bool Shader::IsReady() const
+    {
+        if(id == 0)
+            return false;
+
+        if(failedPrograms.contains(id))
+            return false;
+
+        if(!pendingPrograms.contains(id))
+            return true;
+
+        int32_t completed = GL_FALSE;
+        glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &completed);
+
+        if(completed == GL_FALSE)
+            return false;
+
+        return FinalizeProgram(id);
+    }
+
+    bool Shader::IsCompiling() const
+    {
+        return pendingPrograms.contains(id);
+    }
+
     void Shader::Use()
     {
+        // Blocks until the driver is done, same as the synchronous path
+        if(pendingPrograms.contains(id))
+            FinalizeProgram(id);
+
         glUseProgram(id);
     }
 
@@ -137,7 +280,21 @@ namespace GFX
     {
         if(id > 0)
         {
-            glDeleteShader(id);
+            if(pendingPrograms.contains(id))
+            {
+                auto &pending = pendingPrograms[id];
+                for(size_t i = 0; i < pending.shaders.size(); i++)
+                    glDeleteShader(pending.shaders[i]);
+                pendingPrograms.erase(id);
+            }
+
+            failedPrograms.erase(id);
+            Graphics::RemoveCompilingShader(this);
+            Graphics::postProcessingGraph.ClearShaderUniforms(id);
+            Graphics::postProcessingRenderer.ClearShaderUniforms(id);
+            Graphics2D::ClearShaderUniforms(id);
+            Mesh::ClearShaderUniforms(id);
+            glDeleteProgram(id);
             id = 0;
         }
     }
@@ -146,7 +303,7 @@ namespace GFX
     {
         int32_t success;
         GLchar infoLog[1024];
-        if (type == ShaderType::Vertex || type == ShaderType::Fragment || type == ShaderType::Geometry)
+        if (type == ShaderType::Vertex || type == ShaderType::Fragment || type == ShaderType::Geometry || type == ShaderType::Compute)
         {
             glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
             if (!success)
@@ -166,10 +323,19 @@ namespace GFX
                     case ShaderType::Fragment:
                         shaderType = "FRAGMENT";
                         break;
+                    case ShaderType::Compute:
+                        shaderType = "COMPUTE";
+                        break;
+                    default:
+                        break;
                 }
                 
                 Debug::WriteError("------------------------");
                 Debug::WriteError("ERROR: SHADER_COMPILATION_ERROR of type: %s%s", shaderType.c_str(), infoLog);
+
+                // The info log refers to line numbers, which are meaningless without the source after includes were added
+                if(source.size() > 0)
+                    WriteSourceContext(source, infoLog);
                 
                 return false;
             }
@@ -286,6 +452,222 @@ namespace GFX
         includesMap[name] = code;
     }
 
+    void Shader::SetCacheDirectory(const std::string &directory)
+    {
+        cacheDirectory = directory;
+    }
+
+    std::string Shader::GetCacheDirectory()
+    {
+        return cacheDirectory;
+    }
+
+    bool Shader::IsParallelCompileSupported()
+    {
+        return parallelCompileSupported;
+    }
+
+    void Shader::UpdatePendingPrograms()
+    {
+        if(pendingPrograms.size() == 0)
+            return;
+
+        FrameVector<uint32_t> completedPrograms;
+
+        for(const auto &item : pendingPrograms)
+        {
+            int32_t completed = GL_FALSE;
+            glGetProgramiv(item.first, GL_COMPLETION_STATUS_KHR, &completed);
+            if(completed == GL_TRUE)
+                completedPrograms.push_back(item.first);
+        }
+
+        for(size_t i = 0; i < completedPrograms.size(); i++)
+            FinalizeProgram(completedPrograms[i]);
+    }
+
+    bool Shader::FinalizeProgram(uint32_t program)
+    {
+        if(!pendingPrograms.contains(program))
+            return !failedPrograms.contains(program);
+
+        PendingProgram pending = std::move(pendingPrograms[program]);
+        pendingPrograms.erase(program);
+
+        bool success = true;
+
+        for(size_t i = 0; i < pending.shaders.size(); i++)
+        {
+            if(!CheckShader(pending.shaders[i], pending.types[i], pending.sources[i]))
+            {
+                success = false;
+                break;
+            }
+        }
+
+        if(success)
+            success = CheckShader(program, ShaderType::Program, "");
+
+        for(size_t i = 0; i < pending.shaders.size(); i++)
+        {
+            glDetachShader(program, pending.shaders[i]);
+            glDeleteShader(pending.shaders[i]);
+        }
+
+        if(!success)
+        {
+            // When compiled in parallel, copies of the Shader may already refer to this id so the program is kept around
+            if(parallelCompileSupported)
+                failedPrograms.insert(program);
+            else
+                glDeleteProgram(program);
+            return false;
+        }
+
+        SaveProgramBinary(program, pending.cacheKey);
+
+        return true;
+    }
+
+    void Shader::InitializeCompiler()
+    {
+        if(compilerInitialized)
+            return;
+
+        compilerInitialized = true;
+
+        const char *vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+        const char *renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        const char *version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+        driverInfo = std::string(vendor ? vendor : "") + "|" + std::string(renderer ? renderer : "") + "|" + std::string(version ? version : "");
+
+        int32_t numBinaryFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+        binaryCacheSupported = numBinaryFormats > 0;
+
+        int32_t numExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+        PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+
+        for(int32_t i = 0; i < numExtensions; i++)
+        {
+            const char *extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+            if(extension == nullptr)
+                continue;
+
+            if(std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0)
+            {
+                maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+                break;
+            }
+
+            if(std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+            {
+                maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+            }
+        }
+
+        if(maxShaderCompilerThreads != nullptr)
+        {
+            // Let the driver pick the number of threads
+            maxShaderCompilerThreads(0xFFFFFFFF);
+            parallelCompileSupported = true;
+        }
+    }
+
+    uint64_t Shader::GetCacheKey(const std::vector<ShaderStage> &stages)
+    {
+        uint64_t hash = Hash::FNV1a64(driverInfo);
+
+        for(size_t i = 0; i < stages.size(); i++)
+        {
+            uint32_t type = static_cast<uint32_t>(stages[i].type);
+            hash = Hash::FNV1a64(&type, sizeof(type), hash);
+            hash = Hash::FNV1a64(stages[i].source, hash);
+        }
+
+        return hash;
+    }
+
+    std::string Shader::GetCacheFilePath(uint64_t cacheKey)
+    {
+        return (std::filesystem::path(cacheDirectory) / (Hash::ToHexString(cacheKey) + ".bin")).string();
+    }
+
+    bool Shader::LoadProgramBinary(uint32_t program, uint64_t cacheKey)
+    {
+        if(!binaryCacheSupported || cacheDirectory.size() == 0)
+            return false;
+
+        std::string filepath = GetCacheFilePath(cacheKey);
+
+        if(!File::Exists(filepath))
+            return false;
+
+        auto data = File::ReadAllBytes(filepath);
+
+        const size_t headerSize = sizeof(uint32_t) * 3;
+
+        if(data.size() <= headerSize)
+            return false;
+
+        uint32_t header[3];
+        std::memcpy(header, data.data(), headerSize);
+
+        if(header[0] != PROGRAM_BINARY_MAGIC || header[1] != PROGRAM_BINARY_VERSION)
+            return false;
+
+        GLenum binaryFormat = static_cast<GLenum>(header[2]);
+
+        glProgramBinary(program, binaryFormat, data.data() + headerSize, static_cast<GLsizei>(data.size() - headerSize));
+
+        // Drivers reject binaries produced by a different driver version, in which case the program is compiled from source
+        int32_t success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+        return success == GL_TRUE;
+    }
+
+    void Shader::SaveProgramBinary(uint32_t program, uint64_t cacheKey)
+    {
+        if(!binaryCacheSupported || cacheDirectory.size() == 0)
+            return;
+
+        int32_t length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+        if(length <= 0)
+            return;
+
+        const size_t headerSize = sizeof(uint32_t) * 3;
+
+        std::vector<unsigned char> data(headerSize + length);
+
+        GLenum binaryFormat = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &binaryFormat, data.data() + headerSize);
+
+        if(written <= 0)
+            return;
+
+        uint32_t header[3] = { PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION, static_cast<uint32_t>(binaryFormat) };
+        std::memcpy(data.data(), header, headerSize);
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+
+        if(error)
+        {
+            Debug::WriteError("Failed to create shader cache directory %s", cacheDirectory.c_str());
+            return;
+        }
+
+        File::WriteAllBytes(GetCacheFilePath(cacheKey), data.data(), headerSize + written);
+    }
+
     void Shader::InitializeIncludes()
     {
         if(includesMap.size() > 0)
@@ -5,6 +5,16 @@ namespace GFX
 	static std::string source = R"(uniform sampler2DArray uDepthMap;
 uniform int uReceiveShadows;
 
+// Set per mesh for compact vertex layouts, see VertexLayout.hpp
+uniform vec3 uVertexPositionScale = vec3(1.0);
+uniform vec3 uVertexPositionOffset = vec3(0.0);
+uniform int uVertexFlags = 0;
+
+// Set during LOD crossfades, positive for the incoming level and negative for the outgoing one
+uniform float uLODFade = 0.0;
+
+#define VERTEX_FLAG_OCTAHEDRAL_NORMALS 1
+
 #define MAX_NUM_LIGHTS 32
 
 struct LightInfo {
@@ -193,6 +203,39 @@ float calculate_fog(float density, float gradient, vec3 camPosition, vec3 fragPo
     return fogVisibility;
 }
 
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 decode_position(vec3 position) {
+    return position * uVertexPositionScale + uVertexPositionOffset;
+}
+
+vec3 decode_normal(vec3 normal) {
+    if((uVertexFlags & VERTEX_FLAG_OCTAHEDRAL_NORMALS) != 0)
+        return decode_octahedral(normal.xy);
+    return normal;
+}
+
+// xy holds the octahedral direction, z the handedness
+vec4 decode_tangent(vec4 tangent) {
+    return vec4(decode_octahedral(tangent.xy), tangent.z < 0.0 ? -1.0 : 1.0);
+}
+
+// Ordered dither so both LOD levels together cover every pixel exactly once, call with gl_FragCoord.xy
+bool lod_crossfade_discard(vec2 fragCoord) {
+    if(uLODFade == 0.0)
+        return false;
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(mod(fragCoord, 4.0));
+    float threshold = (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+    return uLODFade > 0.0 ? threshold >= uLODFade : threshold < -uLODFade;
+}
+
 float saturate(float x) {
     return clamp(x, 0.0, 1.0);
 }
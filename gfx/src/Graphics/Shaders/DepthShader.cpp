@@ -3,6 +3,8 @@
 namespace GFX
 {
 	static std::string vertexSource = R"(#version 330 core
+#include <Core>
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 3) in mat4 aInstanceModel;
 
@@ -10,10 +12,11 @@ uniform mat4 uModel;
 uniform int uHasInstanceData;
 
 void main() {
+    vec3 position = decode_position(aPosition);
     if(uHasInstanceData > 0)
-        gl_Position = aInstanceModel * vec4(aPosition, 1.0);
+        gl_Position = aInstanceModel * vec4(position, 1.0);
     else
-        gl_Position = uModel * vec4(aPosition, 1.0);
+        gl_Position = uModel * vec4(position, 1.0);
 })";
 
 	static std::string geometrySource = R"(#version 420 core
@@ -22,7 +25,13 @@ layout(triangle_strip, max_vertices = 3) out;
 
 #include <Core>
 
+uniform int uCascadeMask = -1;
+
 void main() {          
+    //Cascades that are not refreshed this frame keep their previous contents
+    if((uCascadeMask & (1 << gl_InvocationID)) == 0)
+        return;
+
     gl_Position = uShadow.lightSpaceMatrices[gl_InvocationID] * gl_in[0].gl_Position;
     gl_Layer = gl_InvocationID;
     EmitVertex();
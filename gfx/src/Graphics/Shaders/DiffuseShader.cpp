@@ -3,6 +3,8 @@
 namespace GFX
 {
 	static std::string vertexSource = R"(#version 330 core
+#include <Core>
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
@@ -16,9 +18,10 @@ out vec3 oFragPosition;
 out vec2 oUV;
 
 void main() {
-    gl_Position = uMVP * vec4(aPosition, 1.0);
-    oNormal = normalize(uModelInverted * aNormal);
-    oFragPosition = vec3(uModel * vec4(aPosition, 1.0));
+    vec3 position = decode_position(aPosition);
+    gl_Position = uMVP * vec4(position, 1.0);
+    oNormal = normalize(uModelInverted * decode_normal(aNormal));
+    oFragPosition = vec3(uModel * vec4(position, 1.0));
     oUV = aUV;
 })";
 
@@ -39,6 +42,9 @@ in vec2 oUV;
 out vec4 FragColor;
 
 void main() {
+    if(lod_crossfade_discard(gl_FragCoord.xy))
+        discard;
+
     vec4 texColor = texture(uDiffuseTexture, (oUV + uUVOffset) * uUVScale);
     vec3 normal = normalize(oNormal);
     vec3 lighting = calculate_lighting(oFragPosition, uCamera.position.xyz, normal, texColor.rgb, uDiffuseColor.rgb, uAmbientStrength, uShininess);
@@ -0,0 +1,38 @@
+#include "BloomCompositeShader.hpp"
+#include "../PostProcessingShader.hpp"
+
+namespace GFX
+{
+	static std::string fragmentSource = R"(#version 330 core
+#include <Core>
+uniform sampler2D colorBuffer;
+uniform sampler2D bloomBuffer;
+uniform vec2 uUVScale;
+uniform vec2 uBloomUVScale;
+uniform float uIntensity;
+
+in vec2 oUV;
+out vec4 FragColor;
+
+void main() {
+	vec4 color = texture(colorBuffer, oUV);
+	vec2 bloomUV = (oUV / uUVScale) * uBloomUVScale;
+	vec3 bloom = texture(bloomBuffer, bloomUV).rgb;
+	FragColor = vec4(color.rgb + bloom * uIntensity, color.a);
+})";
+
+	Shader BloomCompositeShader::Create()
+	{
+		return Shader(GetVertexSource(), fragmentSource);
+	}
+
+	std::string BloomCompositeShader::GetVertexSource()
+	{
+		return PostProcessingShader::GetVertexSource();
+	}
+
+	std::string BloomCompositeShader::GetFragmentSource()
+	{
+		return fragmentSource;
+	}
+}
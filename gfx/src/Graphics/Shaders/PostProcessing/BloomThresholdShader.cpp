@@ -0,0 +1,35 @@
+#include "BloomThresholdShader.hpp"
+#include "../PostProcessingShader.hpp"
+
+namespace GFX
+{
+	static std::string fragmentSource = R"(#version 330 core
+#include <Core>
+uniform sampler2D colorBuffer;
+uniform float uThreshold;
+
+in vec2 oUV;
+out vec4 FragColor;
+
+void main() {
+	vec3 color = texture(colorBuffer, oUV).rgb;
+	float brightness = max(color.r, max(color.g, color.b));
+	float contribution = max(brightness - uThreshold, 0.0) / max(brightness, 0.0001);
+	FragColor = vec4(color * contribution, 1.0);
+})";
+
+	Shader BloomThresholdShader::Create()
+	{
+		return Shader(GetVertexSource(), fragmentSource);
+	}
+
+	std::string BloomThresholdShader::GetVertexSource()
+	{
+		return PostProcessingShader::GetVertexSource();
+	}
+
+	std::string BloomThresholdShader::GetFragmentSource()
+	{
+		return fragmentSource;
+	}
+}
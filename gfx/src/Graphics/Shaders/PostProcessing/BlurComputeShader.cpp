@@ -0,0 +1,65 @@
+#include "BlurComputeShader.hpp"
+
+namespace GFX
+{
+	// Separable gaussian blur. Each work group handles a run of 128 pixels along one row (uDirection = (1,0))
+	// or one column (uDirection = (0,1)) and caches the run plus its apron in shared memory.
+	static std::string computeSource = R"(#version 430 core
+#define GROUP_SIZE 128
+#define RADIUS 4
+
+layout (local_size_x = GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout (rgba16f, binding = 0) uniform writeonly image2D uOutput;
+uniform sampler2D uInput;
+uniform ivec2 uSize;
+uniform ivec2 uDirection;
+
+const float weight[RADIUS + 1] = float[] (
+	0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216
+);
+
+shared vec3 tile[GROUP_SIZE + 2 * RADIUS];
+
+ivec2 GetCoordinate(int position, int line) {
+	return uDirection.x == 1 ? ivec2(position, line) : ivec2(line, position);
+}
+
+void main() {
+	int lineLength = uDirection.x == 1 ? uSize.x : uSize.y;
+	int line = int(gl_WorkGroupID.y);
+	int start = int(gl_WorkGroupID.x) * GROUP_SIZE;
+	int local = int(gl_LocalInvocationID.x);
+
+	for (int i = local; i < GROUP_SIZE + 2 * RADIUS; i += GROUP_SIZE) {
+		int position = clamp(start + i - RADIUS, 0, lineLength - 1);
+		tile[i] = texelFetch(uInput, GetCoordinate(position, line), 0).rgb;
+	}
+
+	barrier();
+
+	int position = start + local;
+
+	if (position >= lineLength)
+		return;
+
+	vec3 result = tile[local + RADIUS] * weight[0];
+
+	for (int i = 1; i <= RADIUS; i++) {
+		result += tile[local + RADIUS + i] * weight[i];
+		result += tile[local + RADIUS - i] * weight[i];
+	}
+
+	imageStore(uOutput, GetCoordinate(position, line), vec4(result, 1.0));
+})";
+
+	Shader BlurComputeShader::Create()
+	{
+		return Shader(computeSource);
+	}
+
+	std::string BlurComputeShader::GetComputeSource()
+	{
+		return computeSource;
+	}
+}
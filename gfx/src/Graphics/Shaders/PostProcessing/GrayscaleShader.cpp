@@ -3,6 +3,11 @@
 
 namespace GFX
 {
+	static std::string functionSource = R"(vec4 Grayscale(vec4 color) {
+	float pixel = (color.r + color.g + color.b) / 3.0;
+	return vec4(pixel, pixel, pixel, color.a);
+})";
+
 	static std::string fragmentSource = R"(#version 330 core
 #include <Core>
 uniform sampler2D colorBuffer;
@@ -30,4 +35,14 @@ void main() {
 	{
 		return fragmentSource;
 	}
+
+	std::string GrayscaleShader::GetFunctionName()
+	{
+		return "Grayscale";
+	}
+
+	std::string GrayscaleShader::GetFunctionSource()
+	{
+		return functionSource;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "TonemapShader.hpp"
+#include "../PostProcessingShader.hpp"
+
+namespace GFX
+{
+	// ACES filmic curve (Narkowicz fit)
+	static std::string functionSource = R"(vec4 Tonemap(vec4 color) {
+	vec3 x = max(color.rgb, vec3(0.0));
+	vec3 mapped = clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+	return vec4(mapped, color.a);
+})";
+
+	static std::string fragmentSource = R"(#version 330 core
+#include <Core>
+uniform sampler2D colorBuffer;
+
+in vec2 oUV;
+out vec4 FragColor;
+
+)" + functionSource + R"(
+
+void main() {
+	FragColor = Tonemap(texture(colorBuffer, oUV));
+})";
+
+	Shader TonemapShader::Create()
+	{
+		return Shader(GetVertexSource(), fragmentSource);
+	}
+
+	std::string TonemapShader::GetVertexSource()
+	{
+		return PostProcessingShader::GetVertexSource();
+	}
+
+	std::string TonemapShader::GetFragmentSource()
+	{
+		return fragmentSource;
+	}
+
+	std::string TonemapShader::GetFunctionName()
+	{
+		return "Tonemap";
+	}
+
+	std::string TonemapShader::GetFunctionSource()
+	{
+		return functionSource;
+	}
+}
@@ -16,7 +16,7 @@ in vec2 oUV;
 out vec4 FragColor;
 
 vec4 vertical() {
-	vec2 tex_offset = 1.0 / uCamera.resolution.xy; // size of a single texel
+	vec2 tex_offset = 1.0 / vec2(textureSize(colorBuffer, 0)); // size of a single texel
 	vec3 result = texture(colorBuffer, oUV).rgb * weight[0];
 
 	for (int i = 1; i < 5; i++)
@@ -6,11 +6,14 @@ namespace GFX
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec2 aUV;
 
+// Source textures can be larger than the region that is rendered to
+uniform vec2 uUVScale;
+
 out vec2 oUV;
 
 void main() {
 	gl_Position = vec4(aPosition, 1.0);
-	oUV = aUV;
+	oUV = aUV * uUVScale;
 })";
 
 	static std::string fragmentSource = R"(#version 330 core
@@ -4,6 +4,7 @@
 namespace GFX
 {
 	static std::string vertexSource = R"(#version 330 core
+#include <Core>
 
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
@@ -18,9 +19,10 @@ out vec3 oFragPosition;
 out vec2 oUV;
 
 void main() {
-    gl_Position = uMVP * vec4(aPosition, 1.0);
-    oNormal = normalize(uModelInverted * aNormal);
-    oFragPosition = vec3(uModel * vec4(aPosition, 1.0));
+    vec3 position = decode_position(aPosition);
+    gl_Position = uMVP * vec4(position, 1.0);
+    oNormal = normalize(uModelInverted * decode_normal(aNormal));
+    oFragPosition = vec3(uModel * vec4(position, 1.0));
     oUV = aUV;
 })";
 
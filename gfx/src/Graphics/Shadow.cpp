@@ -1,6 +1,8 @@
 #include "Shadow.hpp"
 #include "Texture3D.hpp"
+#include "CascadedShadowMapper.hpp"
 #include "Buffers/ElementBufferObject.hpp"
+#include "Materials/DepthMaterial.hpp"
 #include "Graphics.hpp"
 #include "../Core/Resources.hpp"
 #include "../Core/Debug.hpp"
@@ -11,10 +13,22 @@
 namespace GFX
 {
 	bool Shadow::enabled = true;
+	bool Shadow::cacheStaticCasters = true;
+	uint32_t Shadow::staticCasterVersion = 0;
+	//Near cascades follow the camera every frame, far cascades cover more area per texel and can lag behind
+	uint32_t Shadow::updateIntervals[16] = { 1, 1, 2, 4, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 };
+	float Shadow::movementThreshold = 0.05f;
+	float Shadow::rotationThreshold = 0.5f;
 
 	Shadow::Shadow()
 	{
+        lightFBO = 0;
+        staticFBO = 0;
         depthMap = nullptr;
+        staticDepthMap = nullptr;
+        ubo = nullptr;
+        updateMask = 0;
+        staticUpdateMask = 0;
 		camera = nullptr;
 		light = nullptr;
 	}
@@ -24,6 +38,8 @@ namespace GFX
         size_t cascadeCount = 4;
         depthMap = Resources::AddTexture3D(Constants::GetString(ConstantString::TextureDepth), Texture3D(2048, 2048, cascadeCount + 1));
         depthMap->ObjectLabel("TextureDepth");
+        staticDepthMap = Resources::AddTexture3D(Constants::GetString(ConstantString::TextureDepthStatic), Texture3D(2048, 2048, cascadeCount + 1));
+        staticDepthMap->ObjectLabel("TextureDepthStatic");
 
 		camera = Camera::GetMain();
 		light = Light::GetMain();
@@ -53,33 +69,107 @@ namespace GFX
 		shadowData.shadowBias = 0.005f;
 		shadowData.enabled = enabled ? 1 : 0;
 
-		lightFBO = 0;
+        //One more cascade than split levels, the last one reaches the far plane
+        cascades.resize(cascadeCount + 1);
 
-        glGenFramebuffers(1, &lightFBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthMap->GetId(), 0);
-        glDrawBuffer(GL_NONE);
-        glReadBuffer(GL_NONE);
+        for(size_t i = 0; i < cascades.size(); i++)
+        {
+            cascades[i].lightSpaceMatrix = Matrix4(1.0f);
+            cascades[i].staticLightSpaceMatrix = Matrix4(1.0f);
+            cascades[i].center = Vector3(0, 0, 0);
+            cascades[i].lightDirection = Vector3(0, 0, 0);
+            cascades[i].radius = 0.0f;
+            cascades[i].framesSinceUpdate = 0;
+            cascades[i].staticVersion = 0;
+            cascades[i].hasRendered = false;
+            cascades[i].hasStaticCache = false;
+        }
 
-        int status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		uint32_t *framebuffers[2] = { &lightFBO, &staticFBO };
+		Texture3D *textures[2] = { depthMap, staticDepthMap };
 
-        if (status != GL_FRAMEBUFFER_COMPLETE)
+        for(size_t i = 0; i < 2; i++)
         {
-            Debug::WriteError("CascadedShadowMap framebuffer is not complete");
-            throw 0;
+            glGenFramebuffers(1, framebuffers[i]);
+            glBindFramebuffer(GL_FRAMEBUFFER, *framebuffers[i]);
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textures[i]->GetId(), 0);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+
+            int status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+            {
+                Debug::WriteError("CascadedShadowMap framebuffer is not complete");
+                throw 0;
+            }
         }
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
-	void Shadow::Bind()
+	bool Shadow::BindStatic(DepthMaterial *material)
+	{
+		if(staticUpdateMask == 0)
+			return false;
+
+		ClearLayers(staticDepthMap, staticUpdateMask);
+		BeginPass(staticFBO, staticDepthMap, material, staticUpdateMask);
+
+		for(size_t i = 0; i < cascades.size(); i++)
+		{
+			if((staticUpdateMask & (1u << i)) == 0)
+				continue;
+
+			cascades[i].staticLightSpaceMatrix = cascades[i].lightSpaceMatrix;
+			cascades[i].staticVersion = staticCasterVersion;
+			cascades[i].hasStaticCache = true;
+		}
+
+		return true;
+	}
+
+	bool Shadow::Bind(DepthMaterial *material)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-		glViewport(0, 0, depthMap->GetWidth(), depthMap->GetHeight());
-		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-        glClear(GL_DEPTH_BUFFER_BIT);
+		if(updateMask == 0)
+			return false;
+
+		//Cascades start from their cached static casters, dynamic casters are drawn on top
+		if(cacheStaticCasters)
+		{
+			for(size_t i = 0; i < cascades.size(); i++)
+			{
+				if(updateMask & (1u << i))
+					staticDepthMap->CopyToTexture3D(static_cast<uint32_t>(i), depthMap);
+			}
+		}
+		else
+		{
+			ClearLayers(depthMap, updateMask);
+		}
+
+		BeginPass(lightFBO, depthMap, material, updateMask);
+		return true;
+	}
+
+	void Shadow::BeginPass(uint32_t fbo, Texture3D *texture, DepthMaterial *material, uint32_t mask)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glViewport(0, 0, texture->GetWidth(), texture->GetHeight());
         glEnable(GL_DEPTH_CLAMP); //use depth clamping so that the shadow maps keep from moving through objects which causes shadows to disappear.
         glCullFace(GL_FRONT);  // peter panning
+		material->SetCascadeMask(mask);
+	}
+
+	void Shadow::ClearLayers(Texture3D *texture, uint32_t mask)
+	{
+		float depth = 1.0f;
+
+		for(uint32_t i = 0; i < texture->GetDepth(); i++)
+		{
+			if(mask & (1u << i))
+				glClearTexSubImage(texture->GetId(), 0, 0, 0, i, texture->GetWidth(), texture->GetHeight(), 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+		}
 	}
 
 	void Shadow::Unbind()
@@ -91,6 +181,11 @@ namespace GFX
 		glViewport(0, 0, (int)viewport.width, (int)viewport.height);
 	}
 
+	uint32_t Shadow::GetUpdateMask() const
+	{
+		return updateMask;
+	}
+
     bool Shadow::IsEnabled()
     {
         return enabled;
@@ -101,309 +196,92 @@ namespace GFX
         Shadow::enabled = enabled;
     }
 
-	std::vector<Vector4> Shadow::GetFrustumCornersWorldSpace(const Matrix4 &projview)
-	{
-        const auto inv = Matrix4f::Invert(projview);
-
-        std::vector<Vector4> frustumCorners;
-        for (unsigned int x = 0; x < 2; ++x)
-        {
-            for (unsigned int y = 0; y < 2; ++y)
-            {
-                for (unsigned int z = 0; z < 2; ++z)
-                {
-                    const Vector4 pt = inv * Vector4(2.0f * x - 1.0f, 2.0f * y - 1.0f, 2.0f * z - 1.0f, 1.0f);
-                    frustumCorners.push_back(pt / pt.w);
-                }
-            }
-        }
-
-        return frustumCorners;
-	}
-
-	std::vector<Vector4> Shadow::GetFrustumCornersWorldSpace(const Matrix4 &proj, const Matrix4 &view)
-	{
-		return GetFrustumCornersWorldSpace(proj * view);
-	}
-
-	// Matrix4 Shadow::GetLightSpaceMatrix(const float nearPlane, const float farPlane)
-	// {
-    //     auto viewportRect = Graphics::GetViewport();
-
-    //     const auto proj = glm::perspective(glm::radians(camera->GetFieldOfView()), viewportRect.width / viewportRect.height, nearPlane, farPlane);
-        
-    //     const auto corners = GetFrustumCornersWorldSpace(proj, camera->GetViewMatrix());
-
-    //     glm::vec3 center = glm::vec3(0, 0, 0);
-    //     for (const auto& v : corners)
-    //     {
-    //         center += glm::vec3(v);
-    //     }
-    //     center /= corners.size();
-
-    //     Vector3 lightDir = light->GetTransform()->GetForward();
-
-    //     const auto lightView = glm::lookAt(center + lightDir, center, Vector3(0.0f, 1.0f, 0.0f));
-
-    //     float minX = std::numeric_limits<float>::max();
-    //     float maxX = std::numeric_limits<float>::min();
-    //     float minY = std::numeric_limits<float>::max();
-    //     float maxY = std::numeric_limits<float>::min();
-    //     float minZ = std::numeric_limits<float>::max();
-    //     float maxZ = std::numeric_limits<float>::min();
-
-    //     for (const auto& v : corners)
-    //     {
-    //         const auto trf = lightView * v;
-    //         minX = std::min(minX, trf.x);
-    //         maxX = std::max(maxX, trf.x);
-    //         minY = std::min(minY, trf.y);
-    //         maxY = std::max(maxY, trf.y);
-    //         minZ = std::min(minZ, trf.z);
-    //         maxZ = std::max(maxZ, trf.z);
-    //     }
-
-    //     // Set a small buffer value to avoid clipping
-    //     constexpr float someBuffer = 0.1f; // Adjust this value based on your scene
-    //     float maxDistance = glm::length(lightDir) + someBuffer; // Calculate the maximum distance
-
-    //     // Tune this parameter according to the scene
-    //     float zMult = 1.0f;
-    //     if (maxZ > 0)
-    //     {
-    //         zMult = (maxDistance + someBuffer) / maxZ; // Scale based on the farthest point
-    //     }
-
-    //     // Adjust minZ and maxZ using zMult
-    //     if (minZ < 0)
-    //     {
-    //         minZ *= zMult;
-    //     }
-    //     else
-    //     {
-    //         minZ /= zMult;
-    //     }
-    //     if (maxZ < 0)
-    //     {
-    //         maxZ /= zMult;
-    //     }
-    //     else
-    //     {
-    //         maxZ *= zMult;
-    //     }
-
-
-    //     const Matrix4 lightProjection = glm::ortho(minX, maxX, minY, maxY, minZ, maxZ);
-    //     return lightProjection * lightView;
-	// }
-
-    Matrix4 Shadow::GetLightSpaceMatrix(const float nearPlane, const float farPlane)
+    void Shadow::SetCacheStaticCasters(bool cache)
     {
-        auto viewportRect = Graphics::GetViewport();
-
-        const auto proj = glm::perspective(
-            glm::radians(camera->GetFieldOfView()), viewportRect.width / viewportRect.height, nearPlane,
-            farPlane);
-        
-        const auto corners = GetFrustumCornersWorldSpace(proj, camera->GetViewMatrix());
-
-        glm::vec3 center = glm::vec3(0, 0, 0);
-        for (const auto& v : corners)
-        {
-            center += glm::vec3(v);
-        }
-        center /= static_cast<float>(corners.size());
-
-        Vector3 lightDir = light->GetTransform()->GetForward();
-
-        const auto lightView = glm::lookAt(center + lightDir, center, Vector3(0.0f, 1.0f, 0.0f));
-
-        float minX = std::numeric_limits<float>::max();
-        float maxX = std::numeric_limits<float>::lowest();
-        float minY = std::numeric_limits<float>::max();
-        float maxY = std::numeric_limits<float>::lowest();
-        float minZ = std::numeric_limits<float>::max();
-        float maxZ = std::numeric_limits<float>::lowest();
-        for (const auto& v : corners)
-        {
-            const auto trf = lightView * v;
-            minX = std::min(minX, trf.x);
-            maxX = std::max(maxX, trf.x);
-            minY = std::min(minY, trf.y);
-            maxY = std::max(maxY, trf.y);
-            minZ = std::min(minZ, trf.z);
-            maxZ = std::max(maxZ, trf.z);
-        }
-
-		minZ -= 50.0f;
-		maxZ += 50.0f;
-
-        // Tune this parameter according to the scene
-        // constexpr float zMult = 1.0f;
-        // if (minZ < 0)
-        // {
-        //     minZ *= zMult;
-        // }
-        // else
-        // {
-        //     minZ /= zMult;
-        // }
-        // if (maxZ < 0)
-        // {
-        //     maxZ /= zMult;
-        // }
-        // else
-        // {
-        //     maxZ *= zMult;
-        // }
-
-        const Matrix4 lightProjection = glm::ortho(minX, maxX, minY, maxY, minZ, maxZ);
-        return lightProjection * lightView;
+        cacheStaticCasters = cache;
+        staticCasterVersion++;
     }
 
-	std::vector<Matrix4> Shadow::GetLightSpaceMatrices()
-	{
-        std::vector<Matrix4> ret;
-
-        float cameraNearPlane = camera->GetNearClippingPlane();
-        float cameraFarPlane = camera->GetFarClippingPlane();
-
-        for (size_t i = 0; i < shadowCascadeLevels.size() + 1; ++i)
-        {
-            if (i == 0)
-            {
-                ret.push_back(GetLightSpaceMatrix(cameraNearPlane, shadowCascadeLevels[i]));
-            }
-            else if (i < shadowCascadeLevels.size())
-            {
-                ret.push_back(GetLightSpaceMatrix(shadowCascadeLevels[i - 1], shadowCascadeLevels[i]));
-            }
-            else
-            {
-                ret.push_back(GetLightSpaceMatrix(shadowCascadeLevels[i - 1], cameraFarPlane));
-            }
-        }
-        return ret;
-	}
-
-    std::vector<std::vector<Vector4>> Shadow::GetClipPointByNDC()
+    bool Shadow::GetCacheStaticCasters()
     {
-        std::vector<std::vector<Vector4>> ClipPointList;
-
-        float BoundingNearDistance = camera->GetNearClippingPlane();
-        float BoundingFarDistance = shadowCascadeLevels[0];
-        float fov = glm::radians(camera->GetFieldOfView());
-        auto viewport = Graphics::GetViewport();
-        float aspect = viewport.width / viewport.height;
-
-        for (size_t i = 1; i < shadowCascadeLevels.size(); i++)
-        {
-            glm::mat4 projectionMat = glm::perspective(fov, aspect, BoundingNearDistance, BoundingFarDistance);
+        return cacheStaticCasters;
+    }
 
-            const auto inverseMat = glm::inverse(projectionMat * camera->GetViewMatrix());
+    void Shadow::InvalidateStaticCasters()
+    {
+        staticCasterVersion++;
+    }
 
-            std::vector<glm::vec4> singleClipPointList;
-            //NDC (Reverse mapping from normalized device coordinates to world space)
-            for (unsigned int x = 0; x < 2; ++x)
-            {
-                for (unsigned int y = 0; y < 2; ++y)
-                {
-                    for (unsigned int z = 0; z < 2; ++z)
-                    {
-                        const glm::vec4 inverseNdcPoint = inverseMat * glm::vec4(2.0f * x - 1.0f, 2.0f * y - 1.0f, 2.0f * z - 1.0f, 1.0f);
-                        singleClipPointList.push_back(inverseNdcPoint / inverseNdcPoint.w);
-                    }
-                }
-            }
+    void Shadow::SetCascadeUpdateInterval(uint32_t cascade, uint32_t frames)
+    {
+        if(cascade < 16)
+            updateIntervals[cascade] = frames;
+    }
 
-            ClipPointList.push_back(singleClipPointList);
+    uint32_t Shadow::GetCascadeUpdateInterval(uint32_t cascade)
+    {
+        return cascade < 16 ? updateIntervals[cascade] : 0;
+    }
 
-            if (i < shadowCascadeLevels.size())
-            {
-                BoundingNearDistance = BoundingFarDistance;
-                BoundingFarDistance = shadowCascadeLevels[i];
-            }
-        }
-        
-        return ClipPointList;
+    void Shadow::SetUpdateThresholds(float movement, float rotation)
+    {
+        movementThreshold = glm::max(movement, 0.0f);
+        rotationThreshold = glm::max(rotation, 0.0f);
     }
 
-	std::vector<Matrix4> Shadow::GetLightSpaceMatrices2()
+	void Shadow::UpdateCascades()
 	{
-        std::vector<Matrix4> LightProViewMat4List;
-        auto ClipPointList = GetClipPointByNDC();
-
-        glm::vec3 lightDirectionVec3 = light->GetTransform()->GetForward();
-        glm::vec3 lightPosVec3 = light->GetTransform()->GetPosition();
-
-        glm::mat4 lightViewSpaceMat4 = glm::lookAt(lightPosVec3, lightPosVec3 + lightDirectionVec3, glm::vec3(0,1,0) );
-
-        for (size_t i = 0; i < ClipPointList.size(); i++)
-        {
-            glm::vec4 ClipPointViewSpace = lightViewSpaceMat4 * ClipPointList[i][0];
-            float minX = ClipPointViewSpace.x;
-            float maxX = ClipPointViewSpace.x;
-
-            float minY = ClipPointViewSpace.y;
-            float maxY = ClipPointViewSpace.y;
-
-            float minZ = ClipPointViewSpace.z;
-            float maxZ = ClipPointViewSpace.z;
-
-
-            glm::vec3 CurrentBoundingBoxCenter = glm::vec3(0.0f, 0.0f, 0.0f);
-            for (size_t j = 0; j < ClipPointList[i].size(); j++)
-            {
-                maxZ = glm::max(maxZ, (lightViewSpaceMat4 * ClipPointList[i][j]).z);
-                minZ = glm::max(minZ, (lightViewSpaceMat4 * ClipPointList[i][j]).z);
-                CurrentBoundingBoxCenter +=glm::vec3(ClipPointList[i][j]);
-            }
-            CurrentBoundingBoxCenter /= ClipPointList[i].size();
-            
-            glm::mat4 ShadowCameraViewMat4 = glm::lookAt(CurrentBoundingBoxCenter+lightDirectionVec3, CurrentBoundingBoxCenter, glm::vec3(0, 1, 0));
-            // glm::mat4 ShadowCameraViewMat4 = glm::lookAt(CurrentBoundingBoxCenter-glm::normalize(lightDirectionVec3)*(maxZ-minZ)/2.0f, CurrentBoundingBoxCenter, glm::vec3(0, 1, 0));
-            ClipPointViewSpace = ShadowCameraViewMat4 * ClipPointList[i][0];
-            minX = ClipPointViewSpace.x;
-            maxX = ClipPointViewSpace.x;
-
-            minY = ClipPointViewSpace.y;
-            maxY = ClipPointViewSpace.y;
-            minZ = ClipPointViewSpace.z;
-            maxZ = ClipPointViewSpace.z;
-            for (size_t j = 0; j < ClipPointList[i].size(); j++)
-            {
-                ClipPointViewSpace = ShadowCameraViewMat4 * ClipPointList[i][j];
-                minX = glm::min(minX, ClipPointViewSpace.x);
-                maxX = glm::max(maxX, ClipPointViewSpace.x);
-
-                minY = glm::min(minY, ClipPointViewSpace.y);
-                maxY = glm::max(maxY, ClipPointViewSpace.y);
-
-                minZ = glm::min(minZ, ClipPointViewSpace.z);
-                maxZ = glm::max(maxZ, ClipPointViewSpace.z);
-            }
-            constexpr float zMult = 2.0f;
-            if (minZ < 0)
-            {
-                minZ *= zMult;
-            }
-            else
-            {
-                minZ /= zMult;
-            }
-            if (maxZ < 0)
-            {
-                maxZ /= zMult;
-            }
-            else
-            {
-                maxZ *= zMult;
-            }
-            glm::mat4 ShadowCameraProjectionMat4 = glm::ortho(minX, maxX, minY, maxY, minZ, maxZ);
-            LightProViewMat4List.push_back(ShadowCameraProjectionMat4 * ShadowCameraViewMat4);
-        }
-
-        return LightProViewMat4List;
+		auto viewportRect = Graphics::GetViewport();
+		float fov = glm::radians(camera->GetFieldOfView());
+		float aspect = viewportRect.width / viewportRect.height;
+		float cameraNearPlane = camera->GetNearClippingPlane();
+		float cameraFarPlane = camera->GetFarClippingPlane();
+		Matrix4 view = camera->GetViewMatrix();
+
+		//The shadow camera sits on the forward side of the light and looks back along it
+		Vector3 lightDir = -light->GetTransform()->GetForward();
+		float rotationLimit = glm::cos(glm::radians(rotationThreshold));
+
+		updateMask = 0;
+		staticUpdateMask = 0;
+
+		for(size_t i = 0; i < cascades.size(); i++)
+		{
+			ShadowCascade &cascade = cascades[i];
+			float nearPlane = i == 0 ? cameraNearPlane : shadowCascadeLevels[i - 1];
+			float farPlane = i < shadowCascadeLevels.size() ? shadowCascadeLevels[i] : cameraFarPlane;
+
+			Matrix4 inverseViewProjection = glm::inverse(glm::perspective(fov, aspect, nearPlane, farPlane) * view);
+
+			Vector3 center;
+			float radius;
+			Matrix4 lightSpaceMatrix = CascadedShadowMapper::CalculateStableLightMatrix(inverseViewProjection, lightDir, depthMap->GetWidth(), 50.0f, center, radius);
+
+			cascade.framesSinceUpdate++;
+
+			uint32_t interval = updateIntervals[i];
+			bool isDue = interval > 0 && cascade.framesSinceUpdate >= interval;
+			bool hasMoved = radius != cascade.radius || glm::length(center - cascade.center) > movementThreshold * radius;
+			bool hasRotated = glm::dot(lightDir, cascade.lightDirection) < rotationLimit;
+
+			//A cascade that is not rendered keeps the matrix it was rendered with, so sampling stays consistent
+			if(cascade.hasRendered && !isDue && !hasMoved && !hasRotated)
+				continue;
+
+			cascade.lightSpaceMatrix = lightSpaceMatrix;
+			cascade.center = center;
+			cascade.radius = radius;
+			cascade.lightDirection = lightDir;
+			cascade.framesSinceUpdate = 0;
+			cascade.hasRendered = true;
+			updateMask |= (1u << i);
+
+			if(!cacheStaticCasters)
+				continue;
+
+			if(!cascade.hasStaticCache || cascade.staticVersion != staticCasterVersion || cascade.staticLightSpaceMatrix != lightSpaceMatrix)
+				staticUpdateMask |= (1u << i);
+		}
 	}
 
 	void Shadow::UpdateUniformBuffer()
@@ -414,16 +292,28 @@ namespace GFX
 		if(ubo == nullptr)
 			return;
 
-		auto lightMatrices = GetLightSpaceMatrices();
+		if(enabled)
+		{
+			UpdateCascades();
+		}
+		else
+		{
+			//Everything is rendered again once shadows are turned back on
+			updateMask = 0;
+			staticUpdateMask = 0;
+
+			for(size_t i = 0; i < cascades.size(); i++)
+				cascades[i].hasRendered = false;
+		}
 
 		shadowData.farPlane = camera->GetFarClippingPlane();
 		shadowData.shadowBias = 0.005f;
 		shadowData.cascadeCount = shadowCascadeLevels.size();
 		shadowData.enabled = enabled ? 1 : 0;
 
-        for(size_t i = 0; i < lightMatrices.size(); i++)
+        for(size_t i = 0; i < cascades.size(); i++)
         {
-            shadowData.lightSpaceMatrices[i] = lightMatrices[i];
+            shadowData.lightSpaceMatrices[i] = cascades[i].lightSpaceMatrix;
         }
 
         for(size_t i = 0; i < shadowCascadeLevels.size(); i++)
@@ -435,4 +325,4 @@ namespace GFX
         ubo->BufferSubData(0, sizeof(UniformShadowInfo), &shadowData);
         ubo->Unbind();
 	}
-}
\ No newline at end of file
+}
@@ -538,26 +538,14 @@ namespace GFX
         auto &mVertices = mesh.GetVertices();
         auto &mIndices = mesh.GetIndices();
 
-        mVertices.clear();
-        mIndices.clear();
+        mVertices = std::move(vertices);
+        mIndices = std::move(indices);
 
-        for(size_t i = 0; i < vertices.size(); i++)
-        {
-            // Vertex v;
-            // v.position = vertices[i];
-            // v.normal = Vector3f::Zero();
-            // v.uv = Vector2(0, 0);
-            // mVertices.push_back(v);
-            mVertices.push_back(vertices[i]);
-        }
-
-        for(size_t i = 0; i < indices.size(); i++)
-        {
-            mIndices.push_back(indices[i]);
-        }
-
-		mesh.Generate();
+        //The spline is rebuilt whenever it is edited, so its buffers are reused while they are large enough
+        mesh.SetDynamic(true);
         mesh.RecalculateNormals();
+        mesh.MarkIndicesDirty(0, mIndices.size());
+        mesh.Update();
     }
 
     float Spline::GetApproximateLengthOfCurve(int numSteps)
@@ -0,0 +1,305 @@
+#include "TextLayoutCache.hpp"
+#include "Graphics2D.hpp"
+#include "../System/Hash.hpp"
+#include "../System/String.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace GFX
+{
+    std::unordered_map<uint64_t,TextLayout> TextLayoutCache::layouts;
+    uint64_t TextLayoutCache::frame = 1;
+    uint32_t TextLayoutCache::maxUnusedFrames = 120;
+    size_t TextLayoutCache::maxMemorySize = 8 * 1024 * 1024;
+    size_t TextLayoutCache::memorySize = 0;
+    uint64_t TextLayoutCache::numHits = 0;
+    uint64_t TextLayoutCache::numMisses = 0;
+
+    size_t TextLayout::GetQuadCount() const
+    {
+        return quads.size();
+    }
+
+    size_t TextLayout::GetMemorySize() const
+    {
+        return sizeof(TextLayout) +
+               text.capacity() +
+               quads.capacity() * sizeof(TextQuad) +
+               usedPages.capacity() * sizeof(uint32_t) +
+               markupColors.capacity() * sizeof(Color);
+    }
+
+    static uint64_t GetAtlasEvictionCount(Font *font)
+    {
+        GlyphAtlas *atlas = font->GetAtlas();
+        return atlas ? atlas->GetEvictionCount() : 0;
+    }
+
+    uint64_t TextLayoutCache::GetKey(Font *font, const char *text, size_t textLength, float fontSize, bool richText)
+    {
+        uint64_t key = Hash::FNV1a64(text, textLength);
+        key = Hash::Combine(key, font->GetId());
+        uint32_t fontSizeBits = 0;
+        memcpy(&fontSizeBits, &fontSize, sizeof(float));
+        key = Hash::Combine(key, fontSizeBits);
+        key = Hash::Combine(key, richText ? 1 : 0);
+        return key;
+    }
+
+    //Returns the cached layout for the key if it was built from the same text and its glyphs are still in the atlas
+    TextLayout *TextLayoutCache::Find(uint64_t key, Font *font, const char *text, size_t textLength, float fontSize, bool richText)
+    {
+        auto it = layouts.find(key);
+
+        if(it == layouts.end())
+            return nullptr;
+
+        TextLayout &layout = it->second;
+
+        //Hash collisions and atlas evictions (which move glyphs) both require a rebuild
+        bool isSameText = layout.fontId == font->GetId() && layout.fontSize == fontSize && layout.richText == richText &&
+                          layout.text.size() == textLength && memcmp(layout.text.data(), text, textLength) == 0;
+
+        if(!isSameText || layout.atlasEvictionCount != GetAtlasEvictionCount(font))
+            return nullptr;
+
+        layout.lastUsedFrame = frame;
+        numHits++;
+        return &layout;
+    }
+
+    TextLayout *TextLayoutCache::Add(uint64_t key, Font *font, const char *text, size_t textLength, float fontSize, bool richText)
+    {
+        numMisses++;
+
+        auto it = layouts.find(key);
+
+        if(it != layouts.end())
+            memorySize -= it->second.GetMemorySize();
+
+        TextLayout &layout = layouts[key];
+        layout.text.assign(text, textLength);
+        layout.fontId = font->GetId();
+        layout.fontSize = fontSize;
+        layout.richText = richText;
+        layout.lastUsedFrame = frame;
+        Build(layout, font);
+        memorySize += layout.GetMemorySize();
+        return &layout;
+    }
+
+    const TextLayout *TextLayoutCache::GetLayout(Font *font, const char *text, size_t textLength, float fontSize, bool richText)
+    {
+        if(font == nullptr || font->GetAtlas() == nullptr || text == nullptr || textLength == 0)
+            return nullptr;
+
+        uint64_t key = GetKey(font, text, textLength, fontSize, richText);
+        TextLayout *layout = Find(key, font, text, textLength, fontSize, richText);
+
+        if(layout == nullptr)
+            return Add(key, font, text, textLength, fontSize, richText);
+
+        //Keep the atlas pages of this layout alive for the current frame
+        for(size_t i = 0; i < layout->usedPages.size(); i++)
+            font->MarkPageUsed(layout->usedPages[i]);
+
+        return layout;
+    }
+
+    //Bounds don't depend on where glyphs live in the atlas, so a hit doesn't have to touch the pages
+    Vector2 TextLayoutCache::GetBounds(Font *font, const std::string &text, float fontSize, bool richText)
+    {
+        if(font == nullptr || font->GetAtlas() == nullptr || text.size() == 0)
+            return Vector2(0, 0);
+
+        uint64_t key = GetKey(font, text.c_str(), text.size(), fontSize, richText);
+        const TextLayout *layout = Find(key, font, text.c_str(), text.size(), fontSize, richText);
+
+        if(layout == nullptr)
+            layout = Add(key, font, text.c_str(), text.size(), fontSize, richText);
+
+        return layout->bounds;
+    }
+
+    void TextLayoutCache::Build(TextLayout &layout, Font *font)
+    {
+        std::string currentText = layout.text;
+        size_t colorCount = 0;
+
+        layout.quads.clear();
+        layout.usedPages.clear();
+        layout.markupColors.clear();
+
+        auto containsBraces = [] (const std::string& text) -> bool {
+            return (text.find('{') != std::string::npos) && (text.find('}') != std::string::npos);
+        };
+
+        if(layout.richText && containsBraces(currentText))
+        {
+            Graphics2D::ParseColorsFromText(currentText, Graphics2D::textColorInfoTemp, colorCount);
+
+            for(size_t i = 0; i < colorCount; i++)
+                layout.markupColors.push_back(Graphics2D::textColorInfoTemp[i].color);
+        }
+
+        font->CalculateBounds(currentText.c_str(), currentText.size(), layout.fontSize, layout.bounds.x, layout.bounds.y);
+
+        layout.quads.reserve(currentText.size());
+
+        size_t colorIndex = 0;
+        int32_t currentColorIndex = -1;
+        float scale = font->GetPixelScale(layout.fontSize);
+        Vector2 pos(0.0f, font->CalculateYOffset(layout.fontSize));
+        float originX = pos.x;
+
+        for(size_t i = 0; i < currentText.size();)
+        {
+            size_t characterIndex = i;
+            uint32_t ch = String::DecodeUTF8(currentText.c_str(), currentText.size(), i);
+
+            if(ch == '\n')
+            {
+                pos.x = originX;
+                pos.y += font->GetMaxHeight() * scale;
+                continue;
+            }
+
+            const Glyph *glyph = font->FindGlyph(ch);
+
+            if(glyph == nullptr)
+                continue;
+
+            if(colorIndex < colorCount && Graphics2D::textColorInfoTemp[colorIndex].index == characterIndex)
+            {
+                currentColorIndex = static_cast<int32_t>(colorIndex);
+                colorIndex++;
+            }
+
+            //Nothing to draw for empty glyphs such as spaces
+            if(glyph->sizeX == 0 || glyph->sizeY == 0)
+            {
+                pos.x += glyph->advanceX * scale;
+                continue;
+            }
+
+            TextQuad quad;
+            quad.min = Vector2(pos.x + glyph->bearingX * scale, pos.y - glyph->bearingY * scale);
+            quad.max = quad.min + Vector2(glyph->sizeX * scale, glyph->sizeY * scale);
+            quad.uvMin = Vector2(glyph->u0, glyph->v0);
+            quad.uvMax = Vector2(glyph->u1, glyph->v1);
+            quad.page = glyph->page;
+            quad.colorIndex = currentColorIndex;
+            layout.quads.push_back(quad);
+
+            if(std::find(layout.usedPages.begin(), layout.usedPages.end(), glyph->page) == layout.usedPages.end())
+                layout.usedPages.push_back(glyph->page);
+
+            pos.x += glyph->advanceX * scale;
+        }
+
+        //Capture after building since rasterizing new glyphs may have evicted a page
+        layout.atlasEvictionCount = GetAtlasEvictionCount(font);
+    }
+
+    void TextLayoutCache::NewFrame()
+    {
+        frame++;
+
+        for(auto it = layouts.begin(); it != layouts.end();)
+        {
+            if(frame - it->second.lastUsedFrame > maxUnusedFrames)
+            {
+                memorySize -= it->second.GetMemorySize();
+                it = layouts.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if(memorySize > maxMemorySize)
+            Evict(maxMemorySize);
+    }
+
+    void TextLayoutCache::Evict(size_t targetMemorySize)
+    {
+        std::vector<std::pair<uint64_t,uint64_t>> entries; //lastUsedFrame, key
+        entries.reserve(layouts.size());
+
+        for(const auto &layout : layouts)
+            entries.emplace_back(layout.second.lastUsedFrame, layout.first);
+
+        std::sort(entries.begin(), entries.end());
+
+        for(size_t i = 0; i < entries.size() && memorySize > targetMemorySize; i++)
+        {
+            auto it = layouts.find(entries[i].second);
+            memorySize -= it->second.GetMemorySize();
+            layouts.erase(it);
+        }
+    }
+
+    //Called when a font is destroyed, its layouts can never be hit again
+    void TextLayoutCache::Remove(uint64_t fontId)
+    {
+        for(auto it = layouts.begin(); it != layouts.end();)
+        {
+            if(it->second.fontId == fontId)
+            {
+                memorySize -= it->second.GetMemorySize();
+                it = layouts.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void TextLayoutCache::Clear()
+    {
+        layouts.clear();
+        memorySize = 0;
+    }
+
+    void TextLayoutCache::SetMaxUnusedFrames(uint32_t frames)
+    {
+        maxUnusedFrames = frames;
+    }
+
+    uint32_t TextLayoutCache::GetMaxUnusedFrames()
+    {
+        return maxUnusedFrames;
+    }
+
+    void TextLayoutCache::SetMaxMemorySize(size_t bytes)
+    {
+        maxMemorySize = bytes;
+    }
+
+    size_t TextLayoutCache::GetMaxMemorySize()
+    {
+        return maxMemorySize;
+    }
+
+    size_t TextLayoutCache::GetMemorySize()
+    {
+        return memorySize;
+    }
+
+    size_t TextLayoutCache::GetCount()
+    {
+        return layouts.size();
+    }
+
+    uint64_t TextLayoutCache::GetNumHits()
+    {
+        return numHits;
+    }
+
+    uint64_t TextLayoutCache::GetNumMisses()
+    {
+        return numMisses;
+    }
+}
@@ -1,9 +1,11 @@
 #include "Texture2D.hpp"
+#include "TextureStreamer.hpp"
 #include "../External/glad/glad.h"
 #include "../External/glm/glm.hpp"
 #include <stdexcept>
 #include <utility>
 #include <string>
+#include <cstring>
 
 namespace GFX
 {
@@ -129,6 +131,71 @@ namespace GFX
 		}
 	}
 
+	Texture2D::Texture2D(const CompressedTexture *texture, uint32_t baseLevel) : Texture()
+	{
+		width = 0;
+		height = 0;
+
+		if(texture == nullptr || !texture->IsValid())
+			throw std::invalid_argument("Failed to load texture: Compressed texture is not valid");
+
+		if(baseLevel >= texture->levels.size())
+			throw std::invalid_argument("Failed to load texture: Base level is out of range");
+
+		//The size stays that of the full texture when the finest levels are left out
+		width = texture->width;
+		height = texture->height;
+
+		GLsizei levels = static_cast<GLsizei>(texture->levels.size() - baseLevel);
+		TextureCompressionFormat format = texture->format;
+
+		//Decode on the CPU when the driver can't sample the block format
+		std::vector<CompressedTextureLevel> decodedLevels;
+
+		if(format != TextureCompressionFormat::None && !IsCompressionFormatSupported(format))
+		{
+			decodedLevels.resize(texture->levels.size());
+
+			for(size_t i = baseLevel; i < texture->levels.size(); i++)
+			{
+				decodedLevels[i].width = texture->levels[i].width;
+				decodedLevels[i].height = texture->levels[i].height;
+
+				if(!TextureCompressor::Decompress(texture->levels[i], format, decodedLevels[i].data))
+					throw std::invalid_argument("Failed to load texture: Unable to decode compressed texture");
+			}
+
+			format = TextureCompressionFormat::None;
+		}
+
+		const std::vector<CompressedTextureLevel> &textureLevels = decodedLevels.size() > 0 ? decodedLevels : texture->levels;
+
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		//Mips come precomputed, so there is no glGenerateMipmap here
+		glTexStorage2D(GL_TEXTURE_2D, levels, TextureCompressor::GetGLInternalFormat(format), textureLevels[baseLevel].width, textureLevels[baseLevel].height);
+
+		for(GLsizei i = 0; i < levels; i++)
+		{
+			const CompressedTextureLevel &level = textureLevels[baseLevel + i];
+
+			if(format == TextureCompressionFormat::None)
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE, level.data.data());
+			else
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, TextureCompressor::GetGLInternalFormat(format), static_cast<GLsizei>(level.data.size()), level.data.data());
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
     Texture2D::Texture2D(uint32_t width, uint32_t height, const Color &color) : Texture()
     {
         this->id = 0;
@@ -231,6 +298,8 @@ namespace GFX
 
 	void Texture2D::Delete()
 	{
+		TextureStreamer::Remove(this);
+
 		if(id > 0)
 		{
 			glDeleteTextures(1, &id);
@@ -247,4 +316,43 @@ namespace GFX
 	{
 		return height;
 	}
+
+	bool Texture2D::IsCompressionFormatSupported(TextureCompressionFormat format)
+	{
+		static int32_t hasS3TC = -1;
+
+		switch(format)
+		{
+			case TextureCompressionFormat::None:
+			case TextureCompressionFormat::BC4:
+			case TextureCompressionFormat::BC5:
+			case TextureCompressionFormat::BC7:
+				//RGTC and BPTC are core since OpenGL 3.0 and 4.2
+				return true;
+			case TextureCompressionFormat::BC1:
+			case TextureCompressionFormat::BC3:
+			{
+				//S3TC is an extension, although every desktop driver exposes it
+				if(hasS3TC < 0)
+				{
+					hasS3TC = 0;
+					GLint numExtensions = 0;
+					glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+					for(GLint i = 0; i < numExtensions; i++)
+					{
+						const char *extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+						if(extension && strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+						{
+							hasS3TC = 1;
+							break;
+						}
+					}
+				}
+				return hasS3TC > 0;
+			}
+			default:
+				return false;
+		}
+	}
 }
\ No newline at end of file
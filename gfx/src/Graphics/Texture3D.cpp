@@ -125,4 +125,20 @@ namespace GFX
 		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 		glBindTexture(GL_TEXTURE_2D, 0);
 	}
+
+	void Texture3D::CopyToTexture3D(uint32_t layerIndex, const Texture3D *texture)
+	{
+		if(id == 0 || texture == nullptr || texture->GetId() == 0)
+			return;
+
+		if(layerIndex >= depth || layerIndex >= texture->GetDepth())
+			return;
+
+		if(width != texture->GetWidth() || height != texture->GetHeight())
+			return;
+
+		glCopyImageSubData(id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layerIndex,
+						texture->GetId(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, layerIndex,
+						width, height, 1);
+	}
 }
\ No newline at end of file
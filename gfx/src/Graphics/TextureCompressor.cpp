@@ -0,0 +1,1042 @@
+#include "TextureCompressor.hpp"
+#include "../System/IO/File.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+namespace GFX
+{
+    //OpenGL enums are repeated here so this file doesn't depend on a GL loader
+    static constexpr uint32_t KTX_GL_UNSIGNED_BYTE = 0x1401;
+    static constexpr uint32_t KTX_GL_RED = 0x1903;
+    static constexpr uint32_t KTX_GL_RGB = 0x1907;
+    static constexpr uint32_t KTX_GL_RGBA = 0x1908;
+    static constexpr uint32_t KTX_GL_RG = 0x8227;
+    static constexpr uint32_t KTX_GL_RGBA8 = 0x8058;
+    static constexpr uint32_t KTX_GL_COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+    static constexpr uint32_t KTX_GL_COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+    static constexpr uint32_t KTX_GL_COMPRESSED_RED_RGTC1 = 0x8DBB;
+    static constexpr uint32_t KTX_GL_COMPRESSED_RG_RGTC2 = 0x8DBD;
+    static constexpr uint32_t KTX_GL_COMPRESSED_RGBA_BPTC_UNORM = 0x8E8C;
+
+    static constexpr uint8_t KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    static constexpr uint32_t KTX_ENDIANNESS = 0x04030201;
+    static constexpr size_t KTX_HEADER_SIZE = 64;
+
+    static constexpr uint32_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    CompressedTexture::CompressedTexture()
+    {
+        format = TextureCompressionFormat::None;
+        width = 0;
+        height = 0;
+    }
+
+    bool CompressedTexture::IsValid() const
+    {
+        if(width == 0 || height == 0 || levels.size() == 0)
+            return false;
+
+        for(size_t i = 0; i < levels.size(); i++)
+        {
+            const CompressedTextureLevel &level = levels[i];
+            if(level.width != std::max(width >> i, 1U) || level.height != std::max(height >> i, 1U))
+                return false;
+            if(level.data.size() != TextureCompressor::GetLevelSize(format, level.width, level.height))
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t CompressedTexture::GetDataSize() const
+    {
+        size_t size = 0;
+        for(size_t i = 0; i < levels.size(); i++)
+            size += levels[i].data.size();
+        return size;
+    }
+
+    static uint16_t PackRGB565(const float *color)
+    {
+        uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+        uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+        uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void UnpackRGB565(uint16_t color, uint32_t *rgb)
+    {
+        uint32_t r = (color >> 11) & 31;
+        uint32_t g = (color >> 5) & 63;
+        uint32_t b = color & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    static uint32_t ReadUInt32(const uint8_t *data)
+    {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    static void WriteUInt32(std::vector<uint8_t> &data, uint32_t value)
+    {
+        data.push_back(value & 0xFF);
+        data.push_back((value >> 8) & 0xFF);
+        data.push_back((value >> 16) & 0xFF);
+        data.push_back((value >> 24) & 0xFF);
+    }
+
+    // Finds the line through the block's colors along their principal axis and returns the extremes on it
+    static void ComputeEndpoints(const uint8_t *rgba, uint32_t channels, float *endpoint0, float *endpoint1)
+    {
+        float mean[4] = { 0, 0, 0, 0 };
+        float minimum[4] = { 255, 255, 255, 255 };
+        float maximum[4] = { 0, 0, 0, 0 };
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            for(uint32_t c = 0; c < channels; c++)
+            {
+                float v = rgba[i * 4 + c];
+                mean[c] += v;
+                minimum[c] = std::min(minimum[c], v);
+                maximum[c] = std::max(maximum[c], v);
+            }
+        }
+
+        for(uint32_t c = 0; c < channels; c++)
+            mean[c] /= 16.0f;
+
+        float covariance[4][4] = {};
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            float d[4] = { 0, 0, 0, 0 };
+            for(uint32_t c = 0; c < channels; c++)
+                d[c] = rgba[i * 4 + c] - mean[c];
+            for(uint32_t a = 0; a < channels; a++)
+                for(uint32_t b = 0; b < channels; b++)
+                    covariance[a][b] += d[a] * d[b];
+        }
+
+        float axis[4] = { 0, 0, 0, 0 };
+        for(uint32_t c = 0; c < channels; c++)
+            axis[c] = maximum[c] - minimum[c];
+
+        //Power iteration
+        for(uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = { 0, 0, 0, 0 };
+            float length = 0.0f;
+
+            for(uint32_t a = 0; a < channels; a++)
+            {
+                for(uint32_t b = 0; b < channels; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::fabs(next[a]));
+            }
+
+            if(length < 1e-6f)
+                break;
+
+            for(uint32_t c = 0; c < channels; c++)
+                axis[c] = next[c] / length;
+        }
+
+        float lengthSquared = 0.0f;
+        for(uint32_t c = 0; c < channels; c++)
+            lengthSquared += axis[c] * axis[c];
+
+        if(lengthSquared < 1e-6f)
+        {
+            for(uint32_t c = 0; c < channels; c++)
+            {
+                endpoint0[c] = mean[c];
+                endpoint1[c] = mean[c];
+            }
+            return;
+        }
+
+        float minT = 0.0f;
+        float maxT = 0.0f;
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for(uint32_t c = 0; c < channels; c++)
+                t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+            t /= lengthSquared;
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        for(uint32_t c = 0; c < channels; c++)
+        {
+            endpoint0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            endpoint1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+    }
+
+    static void EncodeColorBlock(const uint8_t *rgba, uint8_t *block)
+    {
+        float endpoint0[4];
+        float endpoint1[4];
+        ComputeEndpoints(rgba, 3, endpoint0, endpoint1);
+
+        uint16_t color0 = PackRGB565(endpoint1);
+        uint16_t color1 = PackRGB565(endpoint0);
+
+        //color0 > color1 selects the four color mode
+        if(color0 < color1)
+            std::swap(color0, color1);
+
+        uint32_t indices = 0;
+
+        if(color0 != color1)
+        {
+            uint32_t palette[4][3];
+            UnpackRGB565(color0, palette[0]);
+            UnpackRGB565(color1, palette[1]);
+
+            for(uint32_t c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            for(uint32_t i = 0; i < 16; i++)
+            {
+                uint32_t bestIndex = 0;
+                int32_t bestError = INT32_MAX;
+
+                for(uint32_t p = 0; p < 4; p++)
+                {
+                    int32_t error = 0;
+                    for(uint32_t c = 0; c < 3; c++)
+                    {
+                        int32_t d = static_cast<int32_t>(rgba[i * 4 + c]) - static_cast<int32_t>(palette[p][c]);
+                        error += d * d;
+                    }
+                    if(error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+
+                indices |= bestIndex << (i * 2);
+            }
+        }
+
+        block[0] = color0 & 0xFF;
+        block[1] = color0 >> 8;
+        block[2] = color1 & 0xFF;
+        block[3] = color1 >> 8;
+        block[4] = indices & 0xFF;
+        block[5] = (indices >> 8) & 0xFF;
+        block[6] = (indices >> 16) & 0xFF;
+        block[7] = (indices >> 24) & 0xFF;
+    }
+
+    static void DecodeColorBlock(const uint8_t *block, uint8_t *rgba, bool allowThreeColorMode)
+    {
+        uint16_t color0 = block[0] | (block[1] << 8);
+        uint16_t color1 = block[2] | (block[3] << 8);
+        uint32_t indices = ReadUInt32(block + 4);
+
+        uint32_t palette[4][4];
+        UnpackRGB565(color0, palette[0]);
+        UnpackRGB565(color1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+        for(uint32_t c = 0; c < 3; c++)
+        {
+            if(color0 > color1 || !allowThreeColorMode)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t index = (indices >> (i * 2)) & 3;
+            for(uint32_t c = 0; c < 4; c++)
+                rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+
+    void TextureCompressor::EncodeBC1Block(const uint8_t *rgba, uint8_t *block)
+    {
+        EncodeColorBlock(rgba, block);
+    }
+
+    void TextureCompressor::DecodeBC1Block(const uint8_t *block, uint8_t *rgba)
+    {
+        DecodeColorBlock(block, rgba, true);
+    }
+
+    void TextureCompressor::EncodeBC4Block(const uint8_t *rgba, uint32_t channel, uint8_t *block)
+    {
+        uint32_t minimum = 255;
+        uint32_t maximum = 0;
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            minimum = std::min<uint32_t>(minimum, rgba[i * 4 + channel]);
+            maximum = std::max<uint32_t>(maximum, rgba[i * 4 + channel]);
+        }
+
+        block[0] = static_cast<uint8_t>(maximum);
+        block[1] = static_cast<uint8_t>(minimum);
+
+        uint64_t indices = 0;
+
+        if(maximum != minimum)
+        {
+            //maximum > minimum selects the eight value mode
+            uint32_t palette[8];
+            palette[0] = maximum;
+            palette[1] = minimum;
+            for(uint32_t k = 1; k < 7; k++)
+                palette[k + 1] = ((7 - k) * maximum + k * minimum) / 7;
+
+            for(uint32_t i = 0; i < 16; i++)
+            {
+                int32_t value = rgba[i * 4 + channel];
+                uint32_t bestIndex = 0;
+                int32_t bestError = INT32_MAX;
+
+                for(uint32_t p = 0; p < 8; p++)
+                {
+                    int32_t error = std::abs(value - static_cast<int32_t>(palette[p]));
+                    if(error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+
+                indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+            }
+        }
+
+        for(uint32_t i = 0; i < 6; i++)
+            block[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+
+    void TextureCompressor::DecodeBC4Block(const uint8_t *block, uint32_t channel, uint8_t *rgba)
+    {
+        uint32_t value0 = block[0];
+        uint32_t value1 = block[1];
+        uint32_t palette[8];
+        palette[0] = value0;
+        palette[1] = value1;
+
+        if(value0 > value1)
+        {
+            for(uint32_t k = 1; k < 7; k++)
+                palette[k + 1] = ((7 - k) * value0 + k * value1) / 7;
+        }
+        else
+        {
+            for(uint32_t k = 1; k < 5; k++)
+                palette[k + 1] = ((5 - k) * value0 + k * value1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for(uint32_t i = 0; i < 6; i++)
+            indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+
+        for(uint32_t i = 0; i < 16; i++)
+            rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+    }
+
+    void TextureCompressor::EncodeBC3Block(const uint8_t *rgba, uint8_t *block)
+    {
+        EncodeBC4Block(rgba, 3, block);
+        EncodeColorBlock(rgba, block + 8);
+    }
+
+    void TextureCompressor::DecodeBC3Block(const uint8_t *block, uint8_t *rgba)
+    {
+        DecodeColorBlock(block + 8, rgba, false);
+        DecodeBC4Block(block, 3, rgba);
+    }
+
+    void TextureCompressor::EncodeBC5Block(const uint8_t *rgba, uint8_t *block)
+    {
+        EncodeBC4Block(rgba, 0, block);
+        EncodeBC4Block(rgba, 1, block + 8);
+    }
+
+    void TextureCompressor::DecodeBC5Block(const uint8_t *block, uint8_t *rgba)
+    {
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+        DecodeBC4Block(block, 0, rgba);
+        DecodeBC4Block(block + 8, 1, rgba);
+    }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t *data) : data(data), position(0)
+        {
+            memset(data, 0, 16);
+        }
+
+        void Write(uint32_t value, uint32_t bits)
+        {
+            for(uint32_t i = 0; i < bits; i++, position++)
+            {
+                if(value & (1u << i))
+                    data[position >> 3] |= 1 << (position & 7);
+            }
+        }
+    private:
+        uint8_t *data;
+        uint32_t position;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data) : data(data), position(0)
+        {
+        }
+
+        uint32_t Read(uint32_t bits)
+        {
+            uint32_t value = 0;
+            for(uint32_t i = 0; i < bits; i++, position++)
+            {
+                if(data[position >> 3] & (1 << (position & 7)))
+                    value |= 1u << i;
+            }
+            return value;
+        }
+    private:
+        const uint8_t *data;
+        uint32_t position;
+    };
+
+    // Only mode 6 is emitted: one subset, RGBA 7.7.7.7 endpoints with a unique p-bit each and 4 bit indices
+    void TextureCompressor::EncodeBC7Block(const uint8_t *rgba, uint8_t *block)
+    {
+        float endpoints[2][4];
+        ComputeEndpoints(rgba, 4, endpoints[0], endpoints[1]);
+
+        uint32_t quantized[2][4];
+        uint32_t pbits[2];
+        uint32_t colors[2][4];
+
+        for(uint32_t e = 0; e < 2; e++)
+        {
+            float bestError = 1e30f;
+
+            for(uint32_t p = 0; p < 2; p++)
+            {
+                float error = 0.0f;
+                uint32_t q[4];
+
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    int32_t value = static_cast<int32_t>((endpoints[e][c] - p) * 0.5f + 0.5f);
+                    q[c] = static_cast<uint32_t>(std::clamp(value, 0, 127));
+                    float d = static_cast<float>((q[c] << 1) | p) - endpoints[e][c];
+                    error += d * d;
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    pbits[e] = p;
+                    for(uint32_t c = 0; c < 4; c++)
+                        quantized[e][c] = q[c];
+                }
+            }
+
+            for(uint32_t c = 0; c < 4; c++)
+                colors[e][c] = (quantized[e][c] << 1) | pbits[e];
+        }
+
+        uint32_t indices[16];
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t bestIndex = 0;
+            int32_t bestError = INT32_MAX;
+
+            for(uint32_t w = 0; w < 16; w++)
+            {
+                int32_t error = 0;
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    int32_t value = ((64 - BC7_WEIGHTS_4[w]) * colors[0][c] + BC7_WEIGHTS_4[w] * colors[1][c] + 32) >> 6;
+                    int32_t d = static_cast<int32_t>(rgba[i * 4 + c]) - value;
+                    error += d * d;
+                }
+                if(error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = w;
+                }
+            }
+
+            indices[i] = bestIndex;
+        }
+
+        //The most significant index bit of the first pixel is implicitly zero
+        if(indices[0] & 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pbits[0], pbits[1]);
+            for(uint32_t i = 0; i < 16; i++)
+                indices[i] = 15 - indices[i];
+        }
+
+        BitWriter writer(block);
+        writer.Write(1 << 6, 7);
+
+        for(uint32_t c = 0; c < 4; c++)
+        {
+            writer.Write(quantized[0][c], 7);
+            writer.Write(quantized[1][c], 7);
+        }
+
+        writer.Write(pbits[0], 1);
+        writer.Write(pbits[1], 1);
+        writer.Write(indices[0], 3);
+
+        for(uint32_t i = 1; i < 16; i++)
+            writer.Write(indices[i], 4);
+    }
+
+    bool TextureCompressor::DecodeBC7Block(const uint8_t *block, uint8_t *rgba)
+    {
+        //Only mode 6 is understood, which is all EncodeBC7Block produces
+        if((block[0] & 0x7F) != (1 << 6))
+            return false;
+
+        BitReader reader(block);
+        reader.Read(7);
+
+        uint32_t colors[2][4];
+
+        for(uint32_t c = 0; c < 4; c++)
+        {
+            colors[0][c] = reader.Read(7);
+            colors[1][c] = reader.Read(7);
+        }
+
+        uint32_t pbit0 = reader.Read(1);
+        uint32_t pbit1 = reader.Read(1);
+
+        for(uint32_t c = 0; c < 4; c++)
+        {
+            colors[0][c] = (colors[0][c] << 1) | pbit0;
+            colors[1][c] = (colors[1][c] << 1) | pbit1;
+        }
+
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t index = reader.Read(i == 0 ? 3 : 4);
+            uint32_t weight = BC7_WEIGHTS_4[index];
+            for(uint32_t c = 0; c < 4; c++)
+                rgba[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * colors[0][c] + weight * colors[1][c] + 32) >> 6);
+        }
+
+        return true;
+    }
+
+    uint32_t TextureCompressor::GetMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        uint32_t size = std::max(width, height);
+        while(size > 1)
+        {
+            size >>= 1;
+            levels++;
+        }
+        return levels;
+    }
+
+    uint32_t TextureCompressor::GetBlockSize(TextureCompressionFormat format)
+    {
+        switch(format)
+        {
+            case TextureCompressionFormat::BC1:
+            case TextureCompressionFormat::BC4:
+                return 8;
+            case TextureCompressionFormat::BC3:
+            case TextureCompressionFormat::BC5:
+            case TextureCompressionFormat::BC7:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    size_t TextureCompressor::GetLevelSize(TextureCompressionFormat format, uint32_t width, uint32_t height)
+    {
+        if(format == TextureCompressionFormat::None)
+            return static_cast<size_t>(width) * height * 4;
+
+        size_t blocksX = std::max((width + 3) / 4, 1U);
+        size_t blocksY = std::max((height + 3) / 4, 1U);
+        return blocksX * blocksY * GetBlockSize(format);
+    }
+
+    uint32_t TextureCompressor::GetGLInternalFormat(TextureCompressionFormat format)
+    {
+        switch(format)
+        {
+            case TextureCompressionFormat::BC1:
+                return KTX_GL_COMPRESSED_RGB_S3TC_DXT1;
+            case TextureCompressionFormat::BC3:
+                return KTX_GL_COMPRESSED_RGBA_S3TC_DXT5;
+            case TextureCompressionFormat::BC4:
+                return KTX_GL_COMPRESSED_RED_RGTC1;
+            case TextureCompressionFormat::BC5:
+                return KTX_GL_COMPRESSED_RG_RGTC2;
+            case TextureCompressionFormat::BC7:
+                return KTX_GL_COMPRESSED_RGBA_BPTC_UNORM;
+            default:
+                return KTX_GL_RGBA8;
+        }
+    }
+
+    static uint32_t GetGLBaseInternalFormat(TextureCompressionFormat format)
+    {
+        switch(format)
+        {
+            case TextureCompressionFormat::BC1:
+                return KTX_GL_RGB;
+            case TextureCompressionFormat::BC4:
+                return KTX_GL_RED;
+            case TextureCompressionFormat::BC5:
+                return KTX_GL_RG;
+            default:
+                return KTX_GL_RGBA;
+        }
+    }
+
+    void TextureCompressor::GenerateMipChain(const uint8_t *rgba, uint32_t width, uint32_t height, std::vector<CompressedTextureLevel> &levels)
+    {
+        levels.clear();
+        levels.resize(GetMipLevelCount(width, height));
+
+        levels[0].width = width;
+        levels[0].height = height;
+        levels[0].data.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+
+        for(size_t i = 1; i < levels.size(); i++)
+        {
+            const CompressedTextureLevel &source = levels[i - 1];
+            CompressedTextureLevel &target = levels[i];
+            target.width = std::max(source.width / 2, 1U);
+            target.height = std::max(source.height / 2, 1U);
+            target.data.resize(static_cast<size_t>(target.width) * target.height * 4);
+
+            //2x2 box filter, clamped at the edges of odd sized levels
+            for(uint32_t y = 0; y < target.height; y++)
+            {
+                uint32_t y0 = std::min(y * 2, source.height - 1);
+                uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+                for(uint32_t x = 0; x < target.width; x++)
+                {
+                    uint32_t x0 = std::min(x * 2, source.width - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+
+                    for(uint32_t c = 0; c < 4; c++)
+                    {
+                        uint32_t sum = source.data[(y0 * source.width + x0) * 4 + c] +
+                                       source.data[(y0 * source.width + x1) * 4 + c] +
+                                       source.data[(y1 * source.width + x0) * 4 + c] +
+                                       source.data[(y1 * source.width + x1) * 4 + c];
+                        target.data[(y * target.width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+    }
+
+    //Color images use BC1 unless they have alpha that is not fully opaque, both can be decoded on the CPU when the driver lacks S3TC.
+    //Normal maps only keep X and Y in BC5, anything of unknown use stays uncompressed rather than risk visible artifacts.
+    TextureCompressionFormat TextureCompressor::GetDefaultFormat(const Image &image, TextureUsage usage)
+    {
+        if(usage == TextureUsage::Normal)
+            return TextureCompressionFormat::BC5;
+
+        if(usage != TextureUsage::Color)
+            return TextureCompressionFormat::None;
+
+        switch(image.GetChannels())
+        {
+            case 1:
+                return TextureCompressionFormat::BC4;
+            case 2:
+                return TextureCompressionFormat::BC5;
+            case 3:
+                return TextureCompressionFormat::BC1;
+            case 4:
+                break;
+            default:
+                return TextureCompressionFormat::None;
+        }
+
+        const uint8_t *data = image.GetData();
+        const size_t pixelCount = static_cast<size_t>(image.GetWidth()) * image.GetHeight();
+
+        for(size_t i = 0; i < pixelCount; i++)
+        {
+            if(data[i * 4 + 3] != 255)
+                return TextureCompressionFormat::BC3;
+        }
+
+        return TextureCompressionFormat::BC1;
+    }
+
+    bool TextureCompressor::Compress(const Image &image, TextureCompressionFormat format, bool generateMipmaps, CompressedTexture &texture)
+    {
+        if(!image.IsLoaded())
+            return false;
+        return Compress(image.GetData(), image.GetWidth(), image.GetHeight(), image.GetChannels(), format, generateMipmaps, texture);
+    }
+
+    bool TextureCompressor::Compress(const uint8_t *data, uint32_t width, uint32_t height, uint32_t channels, TextureCompressionFormat format, bool generateMipmaps, CompressedTexture &texture)
+    {
+        if(data == nullptr || width == 0 || height == 0 || channels == 0 || channels > 4)
+            return false;
+
+        //Expand to RGBA the same way Texture2D uploads fewer channels
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+
+        for(size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+        {
+            rgba[i * 4 + 0] = data[i * channels + 0];
+            rgba[i * 4 + 1] = channels > 1 ? data[i * channels + 1] : 0;
+            rgba[i * 4 + 2] = channels > 2 ? data[i * channels + 2] : 0;
+            rgba[i * 4 + 3] = channels > 3 ? data[i * channels + 3] : 255;
+        }
+
+        texture.format = format;
+        texture.width = width;
+        texture.height = height;
+
+        std::vector<CompressedTextureLevel> levels;
+
+        if(generateMipmaps)
+        {
+            GenerateMipChain(rgba.data(), width, height, levels);
+        }
+        else
+        {
+            levels.resize(1);
+            levels[0].width = width;
+            levels[0].height = height;
+            levels[0].data = std::move(rgba);
+        }
+
+        if(format == TextureCompressionFormat::None)
+        {
+            texture.levels = std::move(levels);
+            return true;
+        }
+
+        uint32_t blockSize = GetBlockSize(format);
+        texture.levels.resize(levels.size());
+
+        for(size_t i = 0; i < levels.size(); i++)
+        {
+            const CompressedTextureLevel &source = levels[i];
+            CompressedTextureLevel &target = texture.levels[i];
+            target.width = source.width;
+            target.height = source.height;
+            target.data.resize(GetLevelSize(format, source.width, source.height));
+
+            uint32_t blocksX = std::max((source.width + 3) / 4, 1U);
+            uint32_t blocksY = std::max((source.height + 3) / 4, 1U);
+            uint8_t pixels[64];
+
+            for(uint32_t by = 0; by < blocksY; by++)
+            {
+                for(uint32_t bx = 0; bx < blocksX; bx++)
+                {
+                    //Edge blocks repeat the last row/column
+                    for(uint32_t y = 0; y < 4; y++)
+                    {
+                        uint32_t sy = std::min(by * 4 + y, source.height - 1);
+                        for(uint32_t x = 0; x < 4; x++)
+                        {
+                            uint32_t sx = std::min(bx * 4 + x, source.width - 1);
+                            memcpy(&pixels[(y * 4 + x) * 4], &source.data[(sy * source.width + sx) * 4], 4);
+                        }
+                    }
+
+                    uint8_t *block = &target.data[(by * blocksX + bx) * blockSize];
+
+                    switch(format)
+                    {
+                        case TextureCompressionFormat::BC1:
+                            EncodeBC1Block(pixels, block);
+                            break;
+                        case TextureCompressionFormat::BC3:
+                            EncodeBC3Block(pixels, block);
+                            break;
+                        case TextureCompressionFormat::BC4:
+                            EncodeBC4Block(pixels, 0, block);
+                            break;
+                        case TextureCompressionFormat::BC5:
+                            EncodeBC5Block(pixels, block);
+                            break;
+                        case TextureCompressionFormat::BC7:
+                            EncodeBC7Block(pixels, block);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool TextureCompressor::Decompress(const CompressedTextureLevel &level, TextureCompressionFormat format, std::vector<uint8_t> &rgba)
+    {
+        if(level.data.size() != GetLevelSize(format, level.width, level.height))
+            return false;
+
+        if(format == TextureCompressionFormat::None)
+        {
+            rgba = level.data;
+            return true;
+        }
+
+        rgba.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+        uint32_t blockSize = GetBlockSize(format);
+        uint32_t blocksX = std::max((level.width + 3) / 4, 1U);
+        uint32_t blocksY = std::max((level.height + 3) / 4, 1U);
+        uint8_t pixels[64];
+
+        for(uint32_t by = 0; by < blocksY; by++)
+        {
+            for(uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                const uint8_t *block = &level.data[(by * blocksX + bx) * blockSize];
+
+                switch(format)
+                {
+                    case TextureCompressionFormat::BC1:
+                        DecodeBC1Block(block, pixels);
+                        break;
+                    case TextureCompressionFormat::BC3:
+                        DecodeBC3Block(block, pixels);
+                        break;
+                    case TextureCompressionFormat::BC4:
+                        memset(pixels, 0, sizeof(pixels));
+                        for(uint32_t i = 0; i < 16; i++)
+                            pixels[i * 4 + 3] = 255;
+                        DecodeBC4Block(block, 0, pixels);
+                        break;
+                    case TextureCompressionFormat::BC5:
+                        DecodeBC5Block(block, pixels);
+                        break;
+                    case TextureCompressionFormat::BC7:
+                        if(!DecodeBC7Block(block, pixels))
+                            return false;
+                        break;
+                    default:
+                        return false;
+                }
+
+                for(uint32_t y = 0; y < 4 && by * 4 + y < level.height; y++)
+                {
+                    for(uint32_t x = 0; x < 4 && bx * 4 + x < level.width; x++)
+                    {
+                        size_t index = ((by * 4 + y) * level.width + (bx * 4 + x)) * 4;
+                        memcpy(&rgba[index], &pixels[(y * 4 + x) * 4], 4);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool TextureCompressor::ReadKTX(const uint8_t *data, size_t size, CompressedTexture &texture)
+    {
+        if(data == nullptr || size < KTX_HEADER_SIZE)
+            return false;
+
+        if(memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0)
+            return false;
+
+        //Files written with the opposite byte order are not supported
+        if(ReadUInt32(data + 12) != KTX_ENDIANNESS)
+            return false;
+
+        uint32_t glType = ReadUInt32(data + 16);
+        uint32_t glFormat = ReadUInt32(data + 24);
+        uint32_t glInternalFormat = ReadUInt32(data + 28);
+        uint32_t pixelWidth = ReadUInt32(data + 36);
+        uint32_t pixelHeight = ReadUInt32(data + 40);
+        uint32_t pixelDepth = ReadUInt32(data + 44);
+        uint32_t numberOfArrayElements = ReadUInt32(data + 48);
+        uint32_t numberOfFaces = ReadUInt32(data + 52);
+        uint32_t numberOfMipmapLevels = std::max(ReadUInt32(data + 56), 1U);
+        uint32_t bytesOfKeyValueData = ReadUInt32(data + 60);
+
+        if(pixelWidth == 0 || pixelHeight == 0 || pixelDepth > 1 || numberOfArrayElements > 0 || numberOfFaces != 1)
+            return false;
+
+        if(numberOfMipmapLevels > GetMipLevelCount(pixelWidth, pixelHeight))
+            return false;
+
+        TextureCompressionFormat format;
+
+        switch(glInternalFormat)
+        {
+            case KTX_GL_COMPRESSED_RGB_S3TC_DXT1:
+                format = TextureCompressionFormat::BC1;
+                break;
+            case KTX_GL_COMPRESSED_RGBA_S3TC_DXT5:
+                format = TextureCompressionFormat::BC3;
+                break;
+            case KTX_GL_COMPRESSED_RED_RGTC1:
+                format = TextureCompressionFormat::BC4;
+                break;
+            case KTX_GL_COMPRESSED_RG_RGTC2:
+                format = TextureCompressionFormat::BC5;
+                break;
+            case KTX_GL_COMPRESSED_RGBA_BPTC_UNORM:
+                format = TextureCompressionFormat::BC7;
+                break;
+            case KTX_GL_RGBA8:
+                if(glType != KTX_GL_UNSIGNED_BYTE || glFormat != KTX_GL_RGBA)
+                    return false;
+                format = TextureCompressionFormat::None;
+                break;
+            default:
+                return false;
+        }
+
+        size_t offset = KTX_HEADER_SIZE + bytesOfKeyValueData;
+
+        texture.format = format;
+        texture.width = pixelWidth;
+        texture.height = pixelHeight;
+        texture.levels.clear();
+        texture.levels.resize(numberOfMipmapLevels);
+
+        for(uint32_t i = 0; i < numberOfMipmapLevels; i++)
+        {
+            if(offset + 4 > size)
+                return false;
+
+            uint32_t imageSize = ReadUInt32(data + offset);
+            offset += 4;
+
+            CompressedTextureLevel &level = texture.levels[i];
+            level.width = std::max(pixelWidth >> i, 1U);
+            level.height = std::max(pixelHeight >> i, 1U);
+
+            if(imageSize != GetLevelSize(format, level.width, level.height) || offset + imageSize > size)
+                return false;
+
+            level.data.assign(data + offset, data + offset + imageSize);
+            offset += (imageSize + 3) & ~3u;
+        }
+
+        return true;
+    }
+
+    bool TextureCompressor::WriteKTX(const CompressedTexture &texture, std::vector<uint8_t> &data)
+    {
+        if(!texture.IsValid())
+            return false;
+
+        bool isCompressed = texture.format != TextureCompressionFormat::None;
+
+        data.clear();
+        data.reserve(KTX_HEADER_SIZE + texture.GetDataSize() + texture.levels.size() * 8);
+        data.insert(data.end(), KTX_IDENTIFIER, KTX_IDENTIFIER + sizeof(KTX_IDENTIFIER));
+        WriteUInt32(data, KTX_ENDIANNESS);
+        WriteUInt32(data, isCompressed ? 0 : KTX_GL_UNSIGNED_BYTE);
+        WriteUInt32(data, 1);
+        WriteUInt32(data, isCompressed ? 0 : KTX_GL_RGBA);
+        WriteUInt32(data, GetGLInternalFormat(texture.format));
+        WriteUInt32(data, GetGLBaseInternalFormat(texture.format));
+        WriteUInt32(data, texture.width);
+        WriteUInt32(data, texture.height);
+        WriteUInt32(data, 0);
+        WriteUInt32(data, 0);
+        WriteUInt32(data, 1);
+        WriteUInt32(data, static_cast<uint32_t>(texture.levels.size()));
+        WriteUInt32(data, 0);
+
+        for(size_t i = 0; i < texture.levels.size(); i++)
+        {
+            const CompressedTextureLevel &level = texture.levels[i];
+            WriteUInt32(data, static_cast<uint32_t>(level.data.size()));
+            data.insert(data.end(), level.data.begin(), level.data.end());
+            while(data.size() % 4 != 0)
+                data.push_back(0);
+        }
+
+        return true;
+    }
+
+    bool TextureCompressor::LoadKTX(const std::string &filepath, CompressedTexture &texture)
+    {
+        if(!File::Exists(filepath))
+            return false;
+
+        std::vector<uint8_t> data = File::ReadAllBytes(filepath);
+        return ReadKTX(data.data(), data.size(), texture);
+    }
+
+    bool TextureCompressor::SaveKTX(const std::string &filepath, const CompressedTexture &texture)
+    {
+        std::vector<uint8_t> data;
+
+        if(!WriteKTX(texture, data))
+            return false;
+
+        //Written under a temporary name first, so a reader never sees a partially written file.
+        //The name is unique so that concurrent imports saving the same texture don't write into each other's file.
+        static std::atomic<uint32_t> saveCount = 0;
+        std::string temporaryFilepath = filepath + "." + std::to_string(std::random_device()()) + "." + std::to_string(saveCount.fetch_add(1)) + ".tmp";
+        File::WriteAllBytes(temporaryFilepath, data.data(), data.size());
+
+        std::error_code error;
+        std::filesystem::rename(temporaryFilepath, filepath, error);
+
+        if(error)
+        {
+            std::filesystem::remove(temporaryFilepath, error);
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,380 @@
+#include "TextureStreamer.hpp"
+#include "Graphics.hpp"
+#include "LODGroup.hpp"
+#include "../Core/Camera.hpp"
+#include "../Core/Transform.hpp"
+#include "../Core/Resources.hpp"
+#include "../Core/Debug.hpp"
+#include "../System/FrameArena.hpp"
+#include "../External/glad/glad.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace GFX
+{
+    std::unordered_map<const Texture2D*,StreamedTexture> TextureStreamer::textures;
+    std::vector<TextureStreamingState> TextureStreamer::states;
+    std::vector<uint32_t> TextureStreamer::residentLevels;
+    size_t TextureStreamer::budget = 256 * 1024 * 1024;
+    size_t TextureStreamer::residentSize = 0;
+    uint32_t TextureStreamer::coarseSize = 64;
+    uint32_t TextureStreamer::maxUploadsPerFrame = 4;
+    uint32_t TextureStreamer::requestTimeout = 60;
+    uint64_t TextureStreamer::frame = 1;
+    uint32_t TextureStreamer::nextId = 1;
+
+    Texture2D *TextureStreamer::Add(const std::string &name, CompressedTexture &&texture)
+    {
+        if(!texture.IsValid())
+            return nullptr;
+
+        uint32_t coarseLevel = CalculateCoarseLevel(texture, coarseSize);
+        Texture2D *pTexture = nullptr;
+
+        try
+        {
+            Texture2D coarseTexture(&texture, coarseLevel);
+            pTexture = Resources::AddTexture2D(name, coarseTexture);
+
+            if(pTexture == nullptr)
+            {
+                coarseTexture.Delete();
+                return nullptr;
+            }
+        }
+        catch(const std::invalid_argument &ex)
+        {
+            Debug::WriteError(ex.what());
+            return nullptr;
+        }
+
+        StreamedTexture &streamedTexture = textures[pTexture];
+        streamedTexture.id = nextId++;
+        streamedTexture.texture = pTexture;
+        streamedTexture.data = std::move(texture);
+        streamedTexture.coarseLevel = coarseLevel;
+        streamedTexture.residentLevel = coarseLevel;
+        streamedTexture.requestedLevel = coarseLevel;
+        streamedTexture.priority = 0.0f;
+        streamedTexture.lastRequestFrame = 0;
+
+        residentSize += GetResidentSize(streamedTexture.data, coarseLevel);
+
+        return pTexture;
+    }
+
+    Texture2D *TextureStreamer::Add(const std::string &name, const Image &image)
+    {
+        CompressedTexture texture;
+
+        if(!TextureCompressor::Compress(image, TextureCompressionFormat::None, true, texture))
+            return nullptr;
+
+        return Add(name, std::move(texture));
+    }
+
+    void TextureStreamer::Remove(Texture2D *texture)
+    {
+        auto it = textures.find(texture);
+
+        if(it == textures.end())
+            return;
+
+        residentSize -= GetResidentSize(it->second.data, it->second.residentLevel);
+        textures.erase(it);
+    }
+
+    bool TextureStreamer::IsStreamed(const Texture2D *texture)
+    {
+        return textures.contains(texture);
+    }
+
+    void TextureStreamer::RequestMip(Texture2D *texture, const BoundingBox &worldBounds, Camera *camera)
+    {
+        if(textures.size() == 0 || texture == nullptr || camera == nullptr)
+            return;
+
+        auto it = textures.find(texture);
+
+        if(it == textures.end())
+            return;
+
+        const CompressedTexture &data = it->second.data;
+        Vector3 cameraPosition = camera->GetTransform()->GetPosition();
+        float screenSize = CalculateScreenSize(worldBounds, cameraPosition, camera->GetFieldOfView(), Graphics::GetViewport().height);
+        uint32_t level = CalculateRequestedLevel(screenSize, data.width, data.height, static_cast<uint32_t>(data.levels.size()));
+        RequestLevel(texture, level, screenSize);
+    }
+
+    void TextureStreamer::RequestLevel(Texture2D *texture, uint32_t level, float priority)
+    {
+        auto it = textures.find(texture);
+
+        if(it == textures.end())
+            return;
+
+        StreamedTexture &streamedTexture = it->second;
+
+        //Several renderers can use the same texture, the largest one wins
+        if(streamedTexture.lastRequestFrame != frame)
+        {
+            streamedTexture.requestedLevel = level;
+            streamedTexture.priority = priority;
+            streamedTexture.lastRequestFrame = frame;
+        }
+        else
+        {
+            streamedTexture.requestedLevel = std::min(streamedTexture.requestedLevel, level);
+            streamedTexture.priority = std::max(streamedTexture.priority, priority);
+        }
+    }
+
+    void TextureStreamer::NewFrame()
+    {
+        if(textures.size() == 0)
+        {
+            frame++;
+            return;
+        }
+
+        FrameVector<StreamedTexture*> entries;
+        entries.reserve(textures.size());
+        states.resize(textures.size());
+
+        for(auto &texture : textures)
+        {
+            StreamedTexture &streamedTexture = texture.second;
+            TextureStreamingState &state = states[entries.size()];
+            bool isRequested = (frame - streamedTexture.lastRequestFrame) <= requestTimeout;
+
+            state.id = streamedTexture.id;
+            state.coarseLevel = streamedTexture.coarseLevel;
+            state.requestedLevel = isRequested ? streamedTexture.requestedLevel : streamedTexture.coarseLevel;
+            state.priority = isRequested ? streamedTexture.priority : 0.0f;
+            state.levelSizes.resize(streamedTexture.data.levels.size());
+
+            for(size_t i = 0; i < streamedTexture.data.levels.size(); i++)
+                state.levelSizes[i] = streamedTexture.data.levels[i].data.size();
+
+            entries.push_back(&streamedTexture);
+        }
+
+        CalculateResidency(states, budget, residentLevels);
+
+        //Drop levels first so the budget holds while the finer levels trickle in
+        FrameVector<size_t> upgrades;
+
+        for(size_t i = 0; i < entries.size(); i++)
+        {
+            if(residentLevels[i] > entries[i]->residentLevel)
+                Upload(*entries[i], residentLevels[i]);
+            else if(residentLevels[i] < entries[i]->residentLevel)
+                upgrades.push_back(i);
+        }
+
+        std::sort(upgrades.begin(), upgrades.end(), [] (size_t a, size_t b) {
+            if(states[a].priority != states[b].priority)
+                return states[a].priority > states[b].priority;
+            return states[a].id < states[b].id;
+        });
+
+        size_t uploadCount = std::min(upgrades.size(), static_cast<size_t>(maxUploadsPerFrame));
+
+        for(size_t i = 0; i < uploadCount; i++)
+            Upload(*entries[upgrades[i]], residentLevels[upgrades[i]]);
+
+        residentSize = 0;
+
+        for(size_t i = 0; i < entries.size(); i++)
+            residentSize += GetResidentSize(entries[i]->data, entries[i]->residentLevel);
+
+        frame++;
+    }
+
+    bool TextureStreamer::Upload(StreamedTexture &streamedTexture, uint32_t level)
+    {
+        //Immutable storage can't shrink or grow, so the texture is recreated with the new base level
+        try
+        {
+            Texture2D texture(&streamedTexture.data, level);
+            uint32_t previousId = streamedTexture.texture->id;
+            streamedTexture.texture->id = std::exchange(texture.id, 0);
+
+            if(previousId > 0)
+                glDeleteTextures(1, &previousId);
+
+            streamedTexture.residentLevel = level;
+            return true;
+        }
+        catch(const std::invalid_argument &ex)
+        {
+            Debug::WriteError(ex.what());
+            return false;
+        }
+    }
+
+    size_t TextureStreamer::GetResidentSize(const CompressedTexture &texture, uint32_t level)
+    {
+        size_t size = 0;
+        for(size_t i = level; i < texture.levels.size(); i++)
+            size += texture.levels[i].data.size();
+        return size;
+    }
+
+    float TextureStreamer::CalculateScreenSize(const BoundingBox &worldBounds, const Vector3 &cameraPosition, float fieldOfView, float viewportHeight)
+    {
+        float coverage = LODGroup::CalculateScreenCoverage(worldBounds, cameraPosition, fieldOfView);
+
+        if(coverage == FLT_MAX)
+            return FLT_MAX;
+
+        //Projected diameter of the bounding sphere in pixels
+        return coverage * viewportHeight;
+    }
+
+    uint32_t TextureStreamer::CalculateRequestedLevel(float screenSize, uint32_t width, uint32_t height, uint32_t levelCount)
+    {
+        if(levelCount == 0)
+            return 0;
+
+        uint32_t lastLevel = levelCount - 1;
+
+        if(screenSize <= 0.0f)
+            return lastLevel;
+
+        float texels = static_cast<float>(std::max(width, height));
+
+        if(screenSize >= texels)
+            return 0;
+
+        //Round down so the chosen level has at least as many texels as pixels
+        uint32_t level = static_cast<uint32_t>(std::floor(std::log2(texels / screenSize)));
+        return std::min(level, lastLevel);
+    }
+
+    uint32_t TextureStreamer::CalculateCoarseLevel(const CompressedTexture &texture, uint32_t coarseSize)
+    {
+        for(size_t i = 0; i < texture.levels.size(); i++)
+        {
+            if(std::max(texture.levels[i].width, texture.levels[i].height) <= coarseSize)
+                return static_cast<uint32_t>(i);
+        }
+
+        return texture.levels.size() > 0 ? static_cast<uint32_t>(texture.levels.size() - 1) : 0;
+    }
+
+    size_t TextureStreamer::CalculateResidency(const std::vector<TextureStreamingState> &states, size_t budget, std::vector<uint32_t> &residentLevels)
+    {
+        FrameVector<size_t> order(states.size());
+        size_t totalSize = 0;
+
+        residentLevels.resize(states.size());
+
+        //Coarse levels are always resident, even when they alone exceed the budget
+        for(size_t i = 0; i < states.size(); i++)
+        {
+            const TextureStreamingState &state = states[i];
+            uint32_t levelCount = static_cast<uint32_t>(state.levelSizes.size());
+            uint32_t coarseLevel = levelCount > 0 ? std::min(state.coarseLevel, levelCount - 1) : 0;
+
+            residentLevels[i] = coarseLevel;
+
+            for(uint32_t j = coarseLevel; j < levelCount; j++)
+                totalSize += state.levelSizes[j];
+
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&states] (size_t a, size_t b) {
+            if(states[a].priority != states[b].priority)
+                return states[a].priority > states[b].priority;
+            return states[a].id < states[b].id;
+        });
+
+        //Hand out one level at a time in priority order, so a single large texture can't starve the others
+        bool changed = true;
+
+        while(changed)
+        {
+            changed = false;
+
+            for(size_t i = 0; i < order.size(); i++)
+            {
+                size_t index = order[i];
+                uint32_t level = residentLevels[index];
+
+                if(level == 0 || level <= states[index].requestedLevel)
+                    continue;
+
+                size_t levelSize = states[index].levelSizes[level - 1];
+
+                if(totalSize + levelSize > budget)
+                    continue;
+
+                residentLevels[index] = level - 1;
+                totalSize += levelSize;
+                changed = true;
+            }
+        }
+
+        return totalSize;
+    }
+
+    void TextureStreamer::SetBudget(size_t bytes)
+    {
+        budget = bytes;
+    }
+
+    size_t TextureStreamer::GetBudget()
+    {
+        return budget;
+    }
+
+    size_t TextureStreamer::GetResidentSize()
+    {
+        return residentSize;
+    }
+
+    void TextureStreamer::SetCoarseSize(uint32_t size)
+    {
+        coarseSize = std::max(size, 1U);
+    }
+
+    uint32_t TextureStreamer::GetCoarseSize()
+    {
+        return coarseSize;
+    }
+
+    void TextureStreamer::SetMaxUploadsPerFrame(uint32_t count)
+    {
+        maxUploadsPerFrame = std::max(count, 1U);
+    }
+
+    uint32_t TextureStreamer::GetMaxUploadsPerFrame()
+    {
+        return maxUploadsPerFrame;
+    }
+
+    void TextureStreamer::SetRequestTimeout(uint32_t frames)
+    {
+        requestTimeout = frames;
+    }
+
+    uint32_t TextureStreamer::GetRequestTimeout()
+    {
+        return requestTimeout;
+    }
+
+    size_t TextureStreamer::GetCount()
+    {
+        return textures.size();
+    }
+
+    uint32_t TextureStreamer::GetResidentLevel(const Texture2D *texture)
+    {
+        auto it = textures.find(texture);
+        return it != textures.end() ? it->second.residentLevel : 0;
+    }
+}
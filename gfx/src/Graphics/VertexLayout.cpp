@@ -0,0 +1,573 @@
+#include "VertexLayout.hpp"
+#include "../External/glad/glad.h"
+#include "../External/glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace GFX
+{
+    static uint32_t GetPositionSize(VertexAttributeFormat format)
+    {
+        switch(format)
+        {
+            case VertexAttributeFormat::Float32:
+                return 12;
+            case VertexAttributeFormat::Float16:
+            case VertexAttributeFormat::UNorm16:
+                return 8; //3 components padded to 4 bytes
+            default:
+                return 0;
+        }
+    }
+
+    static uint32_t GetNormalSize(VertexAttributeFormat format)
+    {
+        switch(format)
+        {
+            case VertexAttributeFormat::Float32:
+                return 12;
+            case VertexAttributeFormat::Float16:
+                return 8;
+            case VertexAttributeFormat::Octahedral16:
+            case VertexAttributeFormat::Octahedral8:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    static uint32_t GetUVSize(VertexAttributeFormat format)
+    {
+        switch(format)
+        {
+            case VertexAttributeFormat::Float32:
+                return 8;
+            case VertexAttributeFormat::Float16:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    VertexLayout::VertexLayout()
+    {
+        position = VertexAttributeFormat::Float32;
+        normal = VertexAttributeFormat::Float32;
+        uv = VertexAttributeFormat::Float32;
+    }
+
+    VertexLayout::VertexLayout(VertexAttributeFormat position, VertexAttributeFormat normal, VertexAttributeFormat uv)
+    {
+        this->position = position;
+        this->normal = normal;
+        this->uv = uv;
+    }
+
+    bool VertexLayout::IsDefault() const
+    {
+        return position == VertexAttributeFormat::Float32 && normal == VertexAttributeFormat::Float32 && uv == VertexAttributeFormat::Float32;
+    }
+
+    bool VertexLayout::IsValid() const
+    {
+        return GetPositionSize(position) > 0 && GetNormalSize(normal) > 0 && GetUVSize(uv) > 0;
+    }
+
+    uint32_t VertexLayout::GetStride() const
+    {
+        return GetPositionSize(position) + GetNormalSize(normal) + GetUVSize(uv);
+    }
+
+    uint32_t VertexLayout::GetNormalOffset() const
+    {
+        return GetPositionSize(position);
+    }
+
+    uint32_t VertexLayout::GetUVOffset() const
+    {
+        return GetPositionSize(position) + GetNormalSize(normal);
+    }
+
+    VertexLayout VertexLayout::Compact()
+    {
+        return VertexLayout(VertexAttributeFormat::UNorm16, VertexAttributeFormat::Octahedral16, VertexAttributeFormat::Float16);
+    }
+
+    VertexStream::VertexStream()
+    {
+        location = 0;
+        components = 0;
+        type = GL_FLOAT;
+        normalized = false;
+        stride = 0;
+    }
+
+    size_t VertexStream::GetCount() const
+    {
+        return stride > 0 ? data.size() / stride : 0;
+    }
+
+    VertexPositionTransform::VertexPositionTransform()
+    {
+        scale = Vector3(1, 1, 1);
+        offset = Vector3(0, 0, 0);
+    }
+
+    bool VertexPositionTransform::IsIdentity() const
+    {
+        return scale == Vector3(1, 1, 1) && offset == Vector3(0, 0, 0);
+    }
+
+    uint16_t VertexQuantization::FloatToHalf(float value)
+    {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(float));
+
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t exponentBits = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        //Infinity and NaN
+        if(exponentBits == 0xFF)
+            return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+        int32_t exponent = static_cast<int32_t>(exponentBits) - 127 + 15;
+
+        if(exponent >= 31)
+            return static_cast<uint16_t>(sign | 0x7C00);
+
+        //Subnormal half, rounded to nearest even
+        if(exponent <= 0)
+        {
+            if(exponent < -10)
+                return static_cast<uint16_t>(sign);
+
+            mantissa |= 0x800000;
+            uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1U << shift) - 1);
+            uint32_t halfway = 1U << (shift - 1);
+
+            if(remainder > halfway || (remainder == halfway && (half & 1)))
+                half++;
+
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFF;
+
+        //A carry into the exponent is correct, it rounds up to the next power of two (or infinity)
+        if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+            half++;
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    float VertexQuantization::HalfToFloat(uint16_t value)
+    {
+        uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x3FF;
+        uint32_t bits = 0;
+
+        if(exponent == 0)
+        {
+            float result = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -result : result;
+        }
+        else if(exponent == 31)
+        {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float result = 0;
+        memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    uint16_t VertexQuantization::QuantizeUNorm16(float value)
+    {
+        value = std::clamp(value, 0.0f, 1.0f);
+        return static_cast<uint16_t>(std::lround(value * 65535.0f));
+    }
+
+    float VertexQuantization::DequantizeUNorm16(uint16_t value)
+    {
+        return static_cast<float>(value) / 65535.0f;
+    }
+
+    int16_t VertexQuantization::QuantizeSNorm16(float value)
+    {
+        value = std::clamp(value, -1.0f, 1.0f);
+        return static_cast<int16_t>(std::lround(value * 32767.0f));
+    }
+
+    float VertexQuantization::DequantizeSNorm16(int16_t value)
+    {
+        return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+
+    int8_t VertexQuantization::QuantizeSNorm8(float value)
+    {
+        value = std::clamp(value, -1.0f, 1.0f);
+        return static_cast<int8_t>(std::lround(value * 127.0f));
+    }
+
+    float VertexQuantization::DequantizeSNorm8(int8_t value)
+    {
+        return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+    }
+
+    Vector2 VertexQuantization::EncodeOctahedral(const Vector3 &normal)
+    {
+        float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+        if(length == 0.0f)
+            return Vector2(0, 0);
+
+        Vector3 n = normal / length;
+
+        //Fold the lower hemisphere over the diagonals
+        if(n.z < 0.0f)
+        {
+            float x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            float y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+            return Vector2(x, y);
+        }
+
+        return Vector2(n.x, n.y);
+    }
+
+    Vector3 VertexQuantization::DecodeOctahedral(const Vector2 &value)
+    {
+        Vector3 n(value.x, value.y, 1.0f - std::abs(value.x) - std::abs(value.y));
+        float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+
+    // Picks the best of the four surrounding grid points instead of plain rounding
+    template<typename T>
+    static void EncodeOctahedralPrecise(const Vector3 &normal, float range, T *value)
+    {
+        Vector3 n = glm::normalize(normal);
+        Vector2 encoded = VertexQuantization::EncodeOctahedral(n);
+        float bestDot = -2.0f;
+
+        for(int32_t i = 0; i < 4; i++)
+        {
+            float x = (i & 1) ? std::ceil(encoded.x * range) : std::floor(encoded.x * range);
+            float y = (i & 2) ? std::ceil(encoded.y * range) : std::floor(encoded.y * range);
+            x = std::clamp(x, -range, range);
+            y = std::clamp(y, -range, range);
+
+            Vector3 decoded = VertexQuantization::DecodeOctahedral(Vector2(x / range, y / range));
+            float dot = glm::dot(decoded, n);
+
+            if(dot > bestDot)
+            {
+                bestDot = dot;
+                value[0] = static_cast<T>(x);
+                value[1] = static_cast<T>(y);
+            }
+        }
+    }
+
+    void VertexQuantization::EncodeOctahedral16(const Vector3 &normal, int16_t *value)
+    {
+        value[0] = 0;
+        value[1] = 0;
+
+        if(glm::dot(normal, normal) == 0.0f)
+            return;
+
+        EncodeOctahedralPrecise<int16_t>(normal, 32767.0f, value);
+    }
+
+    void VertexQuantization::EncodeOctahedral8(const Vector3 &normal, int8_t *value)
+    {
+        value[0] = 0;
+        value[1] = 0;
+
+        if(glm::dot(normal, normal) == 0.0f)
+            return;
+
+        EncodeOctahedralPrecise<int8_t>(normal, 127.0f, value);
+    }
+
+    VertexPositionTransform VertexQuantization::CalculatePositionTransform(const BoundingBox &bounds, VertexAttributeFormat format)
+    {
+        VertexPositionTransform transform;
+
+        if(format == VertexAttributeFormat::Float16)
+        {
+            //Half floats are most precise near zero
+            transform.offset = bounds.GetCenter();
+        }
+        else if(format == VertexAttributeFormat::UNorm16)
+        {
+            transform.offset = bounds.GetMin();
+            transform.scale = bounds.GetSize();
+        }
+
+        return transform;
+    }
+
+    bool VertexQuantization::Encode(const std::vector<Vertex> &vertices, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<uint8_t> &data)
+    {
+        return Encode(vertices.data(), vertices.size(), layout, transform, data);
+    }
+
+    bool VertexQuantization::Encode(const Vertex *vertices, size_t count, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<uint8_t> &data)
+    {
+        if(!layout.IsValid() || (vertices == nullptr && count > 0))
+            return false;
+
+        uint32_t stride = layout.GetStride();
+        uint32_t normalOffset = layout.GetNormalOffset();
+        uint32_t uvOffset = layout.GetUVOffset();
+
+        data.assign(count * stride, 0);
+
+        for(size_t i = 0; i < count; i++)
+        {
+            const Vertex &vertex = vertices[i];
+            uint8_t *pVertex = &data[i * stride];
+
+            switch(layout.position)
+            {
+                case VertexAttributeFormat::Float16:
+                {
+                    uint16_t position[3];
+                    for(int32_t j = 0; j < 3; j++)
+                        position[j] = FloatToHalf(vertex.position[j] - transform.offset[j]);
+                    memcpy(pVertex, position, sizeof(position));
+                    break;
+                }
+                case VertexAttributeFormat::UNorm16:
+                {
+                    uint16_t position[3];
+                    for(int32_t j = 0; j < 3; j++)
+                    {
+                        float value = transform.scale[j] != 0.0f ? (vertex.position[j] - transform.offset[j]) / transform.scale[j] : 0.0f;
+                        position[j] = QuantizeUNorm16(value);
+                    }
+                    memcpy(pVertex, position, sizeof(position));
+                    break;
+                }
+                default:
+                    memcpy(pVertex, &vertex.position, sizeof(float) * 3);
+                    break;
+            }
+
+            switch(layout.normal)
+            {
+                case VertexAttributeFormat::Float16:
+                {
+                    uint16_t normal[3];
+                    for(int32_t j = 0; j < 3; j++)
+                        normal[j] = FloatToHalf(vertex.normal[j]);
+                    memcpy(pVertex + normalOffset, normal, sizeof(normal));
+                    break;
+                }
+                case VertexAttributeFormat::Octahedral16:
+                {
+                    int16_t normal[2];
+                    EncodeOctahedral16(vertex.normal, normal);
+                    memcpy(pVertex + normalOffset, normal, sizeof(normal));
+                    break;
+                }
+                case VertexAttributeFormat::Octahedral8:
+                {
+                    int8_t normal[2];
+                    EncodeOctahedral8(vertex.normal, normal);
+                    memcpy(pVertex + normalOffset, normal, sizeof(normal));
+                    break;
+                }
+                default:
+                    memcpy(pVertex + normalOffset, &vertex.normal, sizeof(float) * 3);
+                    break;
+            }
+
+            if(layout.uv == VertexAttributeFormat::Float16)
+            {
+                uint16_t uv[2] = { FloatToHalf(vertex.uv.x), FloatToHalf(vertex.uv.y) };
+                memcpy(pVertex + uvOffset, uv, sizeof(uv));
+            }
+            else
+            {
+                memcpy(pVertex + uvOffset, &vertex.uv, sizeof(float) * 2);
+            }
+        }
+
+        return true;
+    }
+
+    bool VertexQuantization::Decode(const uint8_t *data, size_t count, const VertexLayout &layout, const VertexPositionTransform &transform, std::vector<Vertex> &vertices)
+    {
+        if(!layout.IsValid() || (data == nullptr && count > 0))
+            return false;
+
+        uint32_t stride = layout.GetStride();
+        uint32_t normalOffset = layout.GetNormalOffset();
+        uint32_t uvOffset = layout.GetUVOffset();
+
+        vertices.resize(count);
+
+        for(size_t i = 0; i < count; i++)
+        {
+            Vertex &vertex = vertices[i];
+            const uint8_t *pVertex = &data[i * stride];
+
+            switch(layout.position)
+            {
+                case VertexAttributeFormat::Float16:
+                {
+                    uint16_t position[3];
+                    memcpy(position, pVertex, sizeof(position));
+                    for(int32_t j = 0; j < 3; j++)
+                        vertex.position[j] = HalfToFloat(position[j]) * transform.scale[j] + transform.offset[j];
+                    break;
+                }
+                case VertexAttributeFormat::UNorm16:
+                {
+                    uint16_t position[3];
+                    memcpy(position, pVertex, sizeof(position));
+                    for(int32_t j = 0; j < 3; j++)
+                        vertex.position[j] = DequantizeUNorm16(position[j]) * transform.scale[j] + transform.offset[j];
+                    break;
+                }
+                default:
+                    memcpy(&vertex.position, pVertex, sizeof(float) * 3);
+                    break;
+            }
+
+            switch(layout.normal)
+            {
+                case VertexAttributeFormat::Float16:
+                {
+                    uint16_t normal[3];
+                    memcpy(normal, pVertex + normalOffset, sizeof(normal));
+                    for(int32_t j = 0; j < 3; j++)
+                        vertex.normal[j] = HalfToFloat(normal[j]);
+                    break;
+                }
+                case VertexAttributeFormat::Octahedral16:
+                {
+                    int16_t normal[2];
+                    memcpy(normal, pVertex + normalOffset, sizeof(normal));
+                    vertex.normal = DecodeOctahedral(Vector2(DequantizeSNorm16(normal[0]), DequantizeSNorm16(normal[1])));
+                    break;
+                }
+                case VertexAttributeFormat::Octahedral8:
+                {
+                    int8_t normal[2];
+                    memcpy(normal, pVertex + normalOffset, sizeof(normal));
+                    vertex.normal = DecodeOctahedral(Vector2(DequantizeSNorm8(normal[0]), DequantizeSNorm8(normal[1])));
+                    break;
+                }
+                default:
+                    memcpy(&vertex.normal, pVertex + normalOffset, sizeof(float) * 3);
+                    break;
+            }
+
+            if(layout.uv == VertexAttributeFormat::Float16)
+            {
+                uint16_t uv[2];
+                memcpy(uv, pVertex + uvOffset, sizeof(uv));
+                vertex.uv = Vector2(HalfToFloat(uv[0]), HalfToFloat(uv[1]));
+            }
+            else
+            {
+                memcpy(&vertex.uv, pVertex + uvOffset, sizeof(float) * 2);
+            }
+        }
+
+        return true;
+    }
+
+    VertexStream VertexQuantization::CreateTangentStream(const std::vector<Vector4> &tangents)
+    {
+        //Octahedral direction in xy, handedness in z
+        VertexStream stream;
+        stream.location = VERTEX_TANGENT_LOCATION;
+        stream.components = 4;
+        stream.type = GL_SHORT;
+        stream.normalized = true;
+        stream.stride = sizeof(int16_t) * 4;
+        stream.data.resize(tangents.size() * stream.stride);
+
+        for(size_t i = 0; i < tangents.size(); i++)
+        {
+            int16_t tangent[4] = { 0, 0, 0, 0 };
+            EncodeOctahedral16(Vector3(tangents[i]), tangent);
+            tangent[2] = tangents[i].w < 0.0f ? -32767 : 32767;
+            memcpy(&stream.data[i * stream.stride], tangent, sizeof(tangent));
+        }
+
+        return stream;
+    }
+
+    VertexStream VertexQuantization::CreateColorStream(const std::vector<Color> &colors)
+    {
+        VertexStream stream;
+        stream.location = VERTEX_COLOR_LOCATION;
+        stream.components = 4;
+        stream.type = GL_UNSIGNED_BYTE;
+        stream.normalized = true;
+        stream.stride = 4;
+        stream.data.resize(colors.size() * stream.stride);
+
+        for(size_t i = 0; i < colors.size(); i++)
+        {
+            uint8_t *pColor = &stream.data[i * stream.stride];
+            pColor[0] = static_cast<uint8_t>(std::lround(std::clamp(colors[i].r, 0.0f, 1.0f) * 255.0f));
+            pColor[1] = static_cast<uint8_t>(std::lround(std::clamp(colors[i].g, 0.0f, 1.0f) * 255.0f));
+            pColor[2] = static_cast<uint8_t>(std::lround(std::clamp(colors[i].b, 0.0f, 1.0f) * 255.0f));
+            pColor[3] = static_cast<uint8_t>(std::lround(std::clamp(colors[i].a, 0.0f, 1.0f) * 255.0f));
+        }
+
+        return stream;
+    }
+
+    VertexStream VertexQuantization::CreateWeightStream(const std::vector<Vector4> &weights)
+    {
+        VertexStream stream;
+        stream.location = VERTEX_WEIGHTS_LOCATION;
+        stream.components = 4;
+        stream.type = GL_UNSIGNED_SHORT;
+        stream.normalized = true;
+        stream.stride = sizeof(uint16_t) * 4;
+        stream.data.resize(weights.size() * stream.stride);
+
+        for(size_t i = 0; i < weights.size(); i++)
+        {
+            uint16_t weight[4];
+            for(int32_t j = 0; j < 4; j++)
+                weight[j] = QuantizeUNorm16(weights[i][j]);
+            memcpy(&stream.data[i * stream.stride], weight, sizeof(weight));
+        }
+
+        return stream;
+    }
+
+    VertexStream VertexQuantization::CreateJointStream(const std::vector<uint8_t> &joints)
+    {
+        //Not normalized, so the shader receives the indices as whole numbers
+        VertexStream stream;
+        stream.location = VERTEX_JOINTS_LOCATION;
+        stream.components = 4;
+        stream.type = GL_UNSIGNED_BYTE;
+        stream.normalized = false;
+        stream.stride = 4;
+        stream.data.assign(joints.begin(), joints.begin() + (joints.size() / 4) * 4);
+        return stream;
+    }
+}
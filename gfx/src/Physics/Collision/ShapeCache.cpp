@@ -0,0 +1,402 @@
+#include "ShapeCache.hpp"
+#include "Collider.hpp"
+#include "BoxCollider.hpp"
+#include "CapsuleCollider.hpp"
+#include "CylinderCollider.hpp"
+#include "MeshCollider.hpp"
+#include "SphereCollider.hpp"
+#include "../../Graphics/Mesh.hpp"
+#include "../../System/Hash.hpp"
+#include "../../System/IO/File.hpp"
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/StreamWrapper.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/CylinderShape.h>
+#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace GFX
+{
+    static constexpr uint8_t SHAPE_CACHE_IDENTIFIER[8] = { 'G', 'F', 'X', 'S', 'H', 'A', 'P', 'E' };
+    static constexpr uint32_t SHAPE_CACHE_VERSION = 2;
+    static constexpr uint32_t SHAPE_CACHE_ENDIANNESS = 0x04030201;
+
+    struct ShapeKey
+    {
+        ColliderType type;
+        float values[6]; //Dimensions followed by the center
+        uint64_t meshHash;
+        uint64_t vertexCount;
+        uint64_t indexCount;
+
+        bool operator==(const ShapeKey &other) const
+        {
+            if(type != other.type || meshHash != other.meshHash || vertexCount != other.vertexCount || indexCount != other.indexCount)
+                return false;
+            for(size_t i = 0; i < 6; i++)
+            {
+                if(values[i] != other.values[i])
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    struct ShapeKeyHasher
+    {
+        size_t operator()(const ShapeKey &key) const
+        {
+            uint64_t hash = Hash::FNV1a64(&key.values, sizeof(key.values));
+            hash = Hash::Combine(hash, static_cast<uint64_t>(key.type));
+            hash = Hash::Combine(hash, key.meshHash);
+            hash = Hash::Combine(hash, key.vertexCount);
+            hash = Hash::Combine(hash, key.indexCount);
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct ShapeFileHeader
+    {
+        uint8_t identifier[8];
+        uint32_t version;
+        uint32_t endianness;
+        uint32_t joltVersionMajor; //The binary shape format is only guaranteed to match within the same Jolt version
+        uint32_t joltVersionMinor;
+        uint32_t joltVersionPatch;
+        uint32_t padding;
+        uint64_t meshHash;
+        uint64_t vertexCount;
+        uint64_t indexCount;
+    };
+
+    static std::unordered_map<ShapeKey, JPH::ShapeRefC, ShapeKeyHasher> shapes;
+
+    std::string ShapeCache::cacheDirectory;
+    bool ShapeCache::purgeRequested = false;
+
+    static bool CreateKey(Collider *collider, ShapeKey &key)
+    {
+        key.type = collider->GetType();
+        key.meshHash = 0;
+        key.vertexCount = 0;
+        key.indexCount = 0;
+
+        float dimensions[3] = { 0.0f, 0.0f, 0.0f };
+        Vector3 center = collider->GetCenter();
+
+        switch(key.type)
+        {
+            case ColliderType::Box:
+            {
+                Vector3 halfExtent = static_cast<BoxCollider*>(collider)->GetSize() * 0.5f;
+                dimensions[0] = halfExtent.x;
+                dimensions[1] = halfExtent.y;
+                dimensions[2] = halfExtent.z;
+                break;
+            }
+            case ColliderType::Capsule:
+            {
+                CapsuleCollider *capsule = static_cast<CapsuleCollider*>(collider);
+                dimensions[0] = capsule->GetHeight() * 0.5f;
+                dimensions[1] = capsule->GetRadius();
+                break;
+            }
+            case ColliderType::Cylinder:
+            {
+                CylinderCollider *cylinder = static_cast<CylinderCollider*>(collider);
+                dimensions[0] = cylinder->GetHeight() * 0.5f;
+                dimensions[1] = cylinder->GetRadius();
+                break;
+            }
+            case ColliderType::Sphere:
+            {
+                dimensions[0] = static_cast<SphereCollider*>(collider)->GetRadius();
+                break;
+            }
+            case ColliderType::Mesh:
+            {
+                Mesh *mesh = static_cast<MeshCollider*>(collider)->GetMesh();
+
+                if(!mesh)
+                    return false;
+
+                //Hash the content rather than the pointer so edited meshes never reuse a stale shape, the mesh caches it until its data changes
+                key.meshHash = mesh->GetContentHash();
+                key.vertexCount = mesh->GetVertices().size();
+                key.indexCount = mesh->GetIndices().size();
+
+                //Mesh shapes are created without an offset
+                center = Vector3(0, 0, 0);
+                break;
+            }
+            default:
+                return false;
+        }
+
+        //Adding zero turns -0.0 into 0.0 so equal keys also hash equally
+        key.values[0] = dimensions[0] + 0.0f;
+        key.values[1] = dimensions[1] + 0.0f;
+        key.values[2] = dimensions[2] + 0.0f;
+        key.values[3] = center.x + 0.0f;
+        key.values[4] = center.y + 0.0f;
+        key.values[5] = center.z + 0.0f;
+        return true;
+    }
+
+    static bool CreatePrimitiveShape(const ShapeKey &key, JPH::ShapeRefC &outShape)
+    {
+        JPH::ShapeSettings::ShapeResult result;
+
+        switch(key.type)
+        {
+            case ColliderType::Box:
+                result = JPH::BoxShapeSettings(JPH::Vec3(key.values[0], key.values[1], key.values[2])).Create();
+                break;
+            case ColliderType::Capsule:
+                result = JPH::CapsuleShapeSettings(key.values[0], key.values[1]).Create();
+                break;
+            case ColliderType::Cylinder:
+                result = JPH::CylinderShapeSettings(key.values[0], key.values[1]).Create();
+                break;
+            case ColliderType::Sphere:
+                result = JPH::SphereShapeSettings(key.values[0]).Create();
+                break;
+            default:
+                return false;
+        }
+
+        if(!result.IsValid())
+            return false;
+
+        JPH::Vec3 center(key.values[3], key.values[4], key.values[5]);
+        JPH::RotatedTranslatedShapeSettings offsetShape(center, JPH::Quat::sIdentity(), result.Get());
+        auto r = offsetShape.Create();
+
+        if(!r.IsValid())
+            return false;
+
+        outShape = r.Get();
+        return true;
+    }
+
+    static bool CreateMeshShape(Mesh *mesh, JPH::ShapeRefC &outShape)
+    {
+        auto &mVertices = mesh->GetVertices();
+        JPH::VertexList vertices;
+        vertices.resize(mVertices.size());
+
+        for(size_t i = 0; i < mVertices.size(); i++)
+        {
+            auto pos = mVertices[i].position;
+            vertices[i] = JPH::Float3(pos.x, pos.y, pos.z);
+        }
+
+        auto &mIndices = mesh->GetIndices();
+        JPH::IndexedTriangleList indices;
+        indices.resize(mIndices.size() / 3);
+        size_t index = 0;
+
+        for(size_t i = 0; i + 2 < mIndices.size(); i+=3)
+        {
+            uint32_t i1 = mIndices[i+0];
+            uint32_t i2 = mIndices[i+1];
+            uint32_t i3 = mIndices[i+2];
+            indices[index++] = JPH::IndexedTriangle(i1, i2, i3);
+        }
+
+        JPH::MeshShapeSettings settings(std::move(vertices), std::move(indices));
+        JPH::ShapeSettings::ShapeResult result = settings.Create();
+
+        if(!result.IsValid())
+            return false;
+
+        outShape = result.Get();
+        return true;
+    }
+
+    static std::string GetShapePath(const std::string &directory, const ShapeKey &key)
+    {
+        uint64_t hash = Hash::Combine(key.meshHash, key.vertexCount);
+        hash = Hash::Combine(hash, key.indexCount);
+        return (std::filesystem::path(directory) / (Hash::ToHexString(hash) + ".shape")).string();
+    }
+
+    static bool LoadShape(const std::string &filepath, const ShapeKey &key, JPH::ShapeRefC &outShape)
+    {
+        std::ifstream stream(filepath, std::ios::binary);
+
+        if(!stream.is_open())
+            return false;
+
+        ShapeFileHeader header;
+
+        if(!stream.read(reinterpret_cast<char*>(&header), sizeof(ShapeFileHeader)))
+            return false;
+
+        if(memcmp(header.identifier, SHAPE_CACHE_IDENTIFIER, sizeof(SHAPE_CACHE_IDENTIFIER)) != 0)
+            return false;
+
+        if(header.version != SHAPE_CACHE_VERSION || header.endianness != SHAPE_CACHE_ENDIANNESS)
+            return false;
+
+        if(header.joltVersionMajor != JPH_VERSION_MAJOR || header.joltVersionMinor != JPH_VERSION_MINOR || header.joltVersionPatch != JPH_VERSION_PATCH)
+            return false;
+
+        if(header.meshHash != key.meshHash || header.vertexCount != key.vertexCount || header.indexCount != key.indexCount)
+            return false;
+
+        JPH::StreamInWrapper input(stream);
+        JPH::Shape::ShapeResult result = JPH::Shape::sRestoreFromBinaryState(input);
+
+        if(!result.IsValid() || input.IsFailed())
+            return false;
+
+        outShape = result.Get();
+        return true;
+    }
+
+    static bool SaveShape(const std::string &filepath, const ShapeKey &key, const JPH::ShapeRefC &shape)
+    {
+        ShapeFileHeader header;
+        memcpy(header.identifier, SHAPE_CACHE_IDENTIFIER, sizeof(SHAPE_CACHE_IDENTIFIER));
+        header.version = SHAPE_CACHE_VERSION;
+        header.endianness = SHAPE_CACHE_ENDIANNESS;
+        header.joltVersionMajor = JPH_VERSION_MAJOR;
+        header.joltVersionMinor = JPH_VERSION_MINOR;
+        header.joltVersionPatch = JPH_VERSION_PATCH;
+        header.padding = 0;
+        header.meshHash = key.meshHash;
+        header.vertexCount = key.vertexCount;
+        header.indexCount = key.indexCount;
+
+        std::ostringstream stream(std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(ShapeFileHeader));
+
+        JPH::StreamOutWrapper output(stream);
+        shape->SaveBinaryState(output);
+
+        if(output.IsFailed())
+            return false;
+
+        std::string data = stream.str();
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), error);
+
+        //Write to a temporary file first so a crash never leaves a truncated cache behind
+        std::string temporaryPath = filepath + ".tmp";
+        File::WriteAllBytes(temporaryPath, reinterpret_cast<unsigned char*>(data.data()), data.size());
+
+        if(std::filesystem::file_size(temporaryPath, error) != data.size() || error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        std::filesystem::rename(temporaryPath, filepath, error);
+        return !error;
+    }
+
+    bool ShapeCache::GetShape(Collider *collider, JPH::RefConst<JPH::Shape> &outShape)
+    {
+        ShapeKey key;
+
+        if(!CreateKey(collider, key))
+            return false;
+
+        auto it = shapes.find(key);
+
+        if(it != shapes.end())
+        {
+            outShape = it->second;
+            return true;
+        }
+
+        JPH::ShapeRefC shape;
+
+        if(key.type == ColliderType::Mesh)
+        {
+            Mesh *mesh = static_cast<MeshCollider*>(collider)->GetMesh();
+            std::string filepath = cacheDirectory.size() > 0 ? GetShapePath(cacheDirectory, key) : "";
+
+            if(filepath.size() == 0 || !LoadShape(filepath, key, shape))
+            {
+                if(!CreateMeshShape(mesh, shape))
+                    return false;
+
+                if(filepath.size() > 0)
+                    SaveShape(filepath, key, shape);
+            }
+        }
+        else
+        {
+            if(!CreatePrimitiveShape(key, shape))
+                return false;
+        }
+
+        shapes[key] = shape;
+        outShape = shape;
+        return true;
+    }
+
+    void ShapeCache::RequestPurge()
+    {
+        purgeRequested = true;
+    }
+
+    void ShapeCache::NewFrame()
+    {
+        if(!purgeRequested)
+            return;
+        purgeRequested = false;
+        Purge();
+    }
+
+    void ShapeCache::SetCacheDirectory(const std::string &directory)
+    {
+        cacheDirectory = directory;
+    }
+
+    std::string ShapeCache::GetCacheDirectory()
+    {
+        return cacheDirectory;
+    }
+
+    size_t ShapeCache::GetCount()
+    {
+        return shapes.size();
+    }
+
+    size_t ShapeCache::Purge()
+    {
+        size_t count = 0;
+
+        //A reference count of 1 means only the cache still holds on to the shape
+        for(auto it = shapes.begin(); it != shapes.end();)
+        {
+            if(it->second->GetRefCount() <= 1)
+            {
+                it = shapes.erase(it);
+                count++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return count;
+    }
+
+    void ShapeCache::Clear()
+    {
+        shapes.clear();
+        purgeRequested = false;
+    }
+}
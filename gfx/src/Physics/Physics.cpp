@@ -10,6 +10,9 @@
 #include "../Graphics/Renderers/Renderer.hpp"
 #include "../External/glm/glm.hpp"
 #include "Rigidbody.hpp"
+#include "Collision/ShapeCache.hpp"
+#include "../System/JobSystem.hpp"
+#include "../System/MemoryTracker.hpp"
 
 #include <Jolt/Jolt.h>
 #include <Jolt/RegisterTypes.h>
@@ -22,11 +25,10 @@
 #include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 
 #include <cstdint>
-#include <thread>
 #include <vector>
 
 namespace GFX
@@ -185,9 +187,68 @@ namespace GFX
         }
     };
 
+    // Runs the physics jobs on the engine job system instead of a thread pool of its own
+    class PhysicsJobSystem : public JPH::JobSystemWithBarrier
+    {
+    public:
+        PhysicsJobSystem() : JPH::JobSystemWithBarrier(JPH::cMaxPhysicsBarriers)
+        {
+        }
+
+        ~PhysicsJobSystem() override
+        {
+            WaitForQueuedJobs();
+        }
+
+        //Queued wrappers hold a reference to their job, which is freed through this object
+        void WaitForQueuedJobs()
+        {
+            GFX::JobSystem::Wait(queuedJobs);
+        }
+
+        int GetMaxConcurrency() const override
+        {
+            return static_cast<int>(GFX::JobSystem::GetWorkerCount()) + 1;
+        }
+
+        JobHandle CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction, JPH::uint32 inNumDependencies = 0) override
+        {
+            Job *job = new Job(inName, inColor, this, inJobFunction, inNumDependencies);
+            JobHandle handle(job);
+
+            if(inNumDependencies == 0)
+                QueueJob(job);
+
+            return handle;
+        }
+    protected:
+        void QueueJob(Job *inJob) override
+        {
+            //A barrier may already have executed the job by the time it is picked up, Execute does nothing then
+            inJob->AddRef();
+            GFX::JobSystem::Schedule([inJob] () {
+                inJob->Execute();
+                inJob->Release();
+            }, &queuedJobs, JobPriority::High);
+        }
+
+        void QueueJobs(Job **inJobs, JPH::uint inNumJobs) override
+        {
+            for(JPH::uint i = 0; i < inNumJobs; i++)
+                QueueJob(inJobs[i]);
+        }
+
+        void FreeJob(Job *inJob) override
+        {
+            delete inJob;
+        }
+    private:
+        GFX::JobCounter queuedJobs;
+    };
+
     struct PhysicsManager
     {
-        JPH::JobSystemThreadPool jobSystem = JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, std::thread::hardware_concurrency() - 1);
+        PhysicsJobSystem jobSystem;
         JPH::PhysicsSystem physicsSystem;
         JPH::TempAllocatorMalloc allocator;
         BPLayerInterfaceImpl broadphaseLayer;
@@ -196,7 +257,6 @@ namespace GFX
         MyBodyActivationListener bodyActivationListener;
         MyContactListener contactListener;
         ExcludeBodiesFilter excludeBodiesFilter;
-        std::vector<Rigidbody*> bodies;
     };
 
     static bool JoltAssertFailed(const char *inExpression, const char *inMessage, const char *inFile, JPH::uint inLine)
@@ -205,6 +265,33 @@ namespace GFX
         return true; //Trigger breakpoint
     }
 
+    static void *JoltAllocate(size_t inSize)
+    {
+        return MemoryTracker::Allocate(MemoryTag::Physics, inSize);
+    }
+
+#if JPH_VERSION_MAJOR >= 5
+    static void *JoltReallocate(void *inBlock, size_t inOldSize, size_t inNewSize)
+    {
+        return MemoryTracker::Reallocate(MemoryTag::Physics, inBlock, inNewSize);
+    }
+#endif
+
+    static void JoltFree(void *inBlock)
+    {
+        MemoryTracker::Free(inBlock);
+    }
+
+    static void *JoltAlignedAllocate(size_t inSize, size_t inAlignment)
+    {
+        return MemoryTracker::Allocate(MemoryTag::Physics, inSize, inAlignment);
+    }
+
+    static void JoltAlignedFree(void *inBlock)
+    {
+        MemoryTracker::Free(inBlock);
+    }
+
     std::unique_ptr<PhysicsManager> Physics::physicsManager = nullptr;
     float Physics::fixedTimeStep = 1.0f / 60;
 
@@ -221,7 +308,14 @@ namespace GFX
 
     void Physics::Initialize()
     {
-        JPH::RegisterDefaultAllocator();
+        //Everything Jolt allocates, the temp allocator included, is counted as physics memory
+        JPH::Allocate = JoltAllocate;
+    #if JPH_VERSION_MAJOR >= 5
+        JPH::Reallocate = JoltReallocate;
+    #endif
+        JPH::Free = JoltFree;
+        JPH::AlignedAllocate = JoltAlignedAllocate;
+        JPH::AlignedFree = JoltAlignedFree;
 
         // Create a factory, this class is responsible for creating instances of classes based on their name or hash and is mainly used for deserialization of saved data.
         // It is not directly used in this example but still required.
@@ -247,6 +341,8 @@ namespace GFX
 
     void Physics::Deinitialize()
     {
+        ShapeCache::Clear();
+        physicsManager.reset();
         JPH::UnregisterTypes();
         delete JPH::Factory::sInstance;
         JPH::Factory::sInstance = nullptr;
@@ -259,40 +355,41 @@ namespace GFX
     {
         const int cCollisionSteps = 1;
 
+        ShapeCache::NewFrame();
+
         physicsManager->physicsSystem.Update(fixedTimeStep, cCollisionSteps, &physicsManager->allocator, &physicsManager->jobSystem);
 
+        //Jobs that a barrier already ran can still be queued, don't let them pile up across frames
+        physicsManager->jobSystem.WaitForQueuedJobs();
+
         auto interface = GetBodyInterface();
 
         currentTime = Time::GetTimeAsDouble();
 
         float t = (currentTime - lastPhysicsUpdateTime) / Time::GetDeltaTime();
 
-        for(size_t i = 0; i < physicsManager->bodies.size(); i++)
-        {
-            auto b = physicsManager->bodies[i]->GetBody();
-            
-            if(b == nullptr)
-                continue;
-            
-            auto id = b->GetID();
+        //Body ids are packed together, only bodies that moved touch their Transform
+        ArchetypeStorage::GetDefault().ForEach<ArchetypeOwner, RigidbodyState>([interface, t] (ArchetypeOwner &owner, RigidbodyState &state) {
+            JPH::BodyID id(state.bodyId);
 
             if(!interface->IsActive(id))
-                continue;
+                return;
             
             auto pos = interface->GetPosition(id);
             auto rot = interface->GetRotation(id);
             Vector3 position(pos.GetX(), pos.GetY(), pos.GetZ());
             Quaternion rotation(rot.GetW(), rot.GetX(), rot.GetY(), rot.GetZ());
+            Transform *transform = owner.component->GetTransform();
 
             if(t < 1.0f)
             {
-                rotation = Quaternionf::Slerp(physicsManager->bodies[i]->GetTransform()->GetRotation(), rotation, t);
-                position = Vector3f::Lerp(physicsManager->bodies[i]->GetTransform()->GetPosition(), position, t);
+                rotation = Quaternionf::Slerp(transform->GetRotation(), rotation, t);
+                position = Vector3f::Lerp(transform->GetPosition(), position, t);
             }
 
-            physicsManager->bodies[i]->GetTransform()->SetPosition(position);
-            physicsManager->bodies[i]->GetTransform()->SetRotation(rotation);
-        }
+            transform->SetPosition(position);
+            transform->SetRotation(rotation);
+        });
 
         if (t >= 1.0f) 
         {
@@ -302,33 +399,19 @@ namespace GFX
 
     void Physics::Add(Rigidbody *rb)
     {
-        for(size_t i = 0; i < physicsManager->bodies.size(); i++)
-        {
-            if(physicsManager->bodies[i] == rb)
-                return;
-        }
-        
-        physicsManager->bodies.push_back(rb);
+        JPH::Body *body = rb->GetBody();
 
-        printf("Added a rigidbody\n");
+        if(body == nullptr)
+            return;
+
+        RigidbodyState state;
+        state.bodyId = body->GetID().GetIndexAndSequenceNumber();
+        rb->state.Create(rb, state);
     }
 
     void Physics::Remove(Rigidbody *rb)
     {
-        size_t index = 0;
-        bool found = false;
-        for(size_t i = 0; i < physicsManager->bodies.size(); i++)
-        {
-            if(physicsManager->bodies[i] == rb)
-            {
-                index = i;
-                found = true;
-                break;
-            }
-        }
-
-        if(found)
-            physicsManager->bodies.erase(physicsManager->bodies.begin() + index);
+        rb->state.Destroy();
     }
 
 	static constexpr float FloatMinValue = -3.4028235E38F;
@@ -1,26 +1,16 @@
 #include "Rigidbody.hpp"
 #include "Physics.hpp"
 #include "Collision/Collider.hpp"
-#include "Collision/BoxCollider.hpp"
-#include "Collision/CapsuleCollider.hpp"
-#include "Collision/CylinderCollider.hpp"
 #include "Collision/TerrainCollider.hpp"
-#include "Collision/MeshCollider.hpp"
-#include "Collision/SphereCollider.hpp"
+#include "Collision/ShapeCache.hpp"
 #include "../Core/GameObject.hpp"
 #include "../Graphics/Renderers/Terrain.hpp"
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Body/Body.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Body/BodyInterface.h>
-#include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
-#include <Jolt/Physics/Collision/Shape/MeshShape.h>
-#include <Jolt/Physics/Collision/Shape/SphereShape.h>
-#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
-#include <Jolt/Physics/Collision/Shape/CylinderShape.h>
 #include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
-#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
 #include <Jolt/Physics/Constraints/Constraint.h>
 #include <Jolt/Physics/Constraints/HingeConstraint.h>
 #include <vector>
@@ -109,6 +99,8 @@ namespace GFX
 		body->interface = nullptr;
 		body.reset();
 		body = nullptr;
+
+		ShapeCache::RequestPurge();
 	}
 
 	bool Rigidbody::Initialize()
@@ -474,7 +466,7 @@ namespace GFX
 
 	bool Rigidbody::CreateShape()
 	{
-		auto colliders = GetGameObject()->GetComponentsOfTypeInChildren<Collider>();
+		auto colliders = GetGameObject()->GetComponentsOfTypeInChildren<Collider, FrameAllocator<Collider*>>();
 		//auto colliders = GetGameObject()->GetComponentsOfType<Collider>();
 
 		if(colliders.size() == 0)
@@ -531,153 +523,12 @@ namespace GFX
 		switch(c->GetType())
 		{
 			case ColliderType::Box:
-			{
-				BoxCollider *collider = static_cast<BoxCollider*>(c);
-				Vector3 h = collider->GetSize() * 0.5f;
-				Vector3 c = collider->GetCenter();
-				JPH::Vec3 halfExtent(h.x, h.y, h.z);
-				JPH::RVec3 center(c.x, c.y, c.z);
-				JPH::BoxShapeSettings settings(halfExtent);
-				JPH::ShapeSettings::ShapeResult result = settings.Create();
-
-				if(result.IsValid())
-				{
-					JPH::RotatedTranslatedShapeSettings offsetShape(center, JPH::Quat::sIdentity(), result.Get());
-
-					auto r = offsetShape.Create();
-
-					if(r.IsValid())
-					{
-						outShape = r.Get();
-						return true;
-					}
-					
-					return false;
-				}
-
-				break;
-			}
 			case ColliderType::Capsule:
-			{
-				CylinderCollider *collider = static_cast<CylinderCollider*>(c);
-				float halfHeight = collider->GetHeight() * 0.5f;
-				float radius = collider->GetRadius();
-				Vector3 c = collider->GetCenter();
-				JPH::RVec3 center(c.x, c.y, c.z);
-				JPH::CapsuleShapeSettings settings(halfHeight, radius);
-				JPH::ShapeSettings::ShapeResult result = settings.Create();
-
-				if(result.IsValid())
-				{
-					JPH::RotatedTranslatedShapeSettings offsetShape(center, JPH::Quat::sIdentity(), result.Get());
-
-					auto r = offsetShape.Create();
-
-					if(r.IsValid())
-					{
-						outShape = r.Get();
-						return true;
-					}
-					
-					return false;
-				}
-
-				break;
-			}
 			case ColliderType::Cylinder:
-			{
-				CylinderCollider *collider = static_cast<CylinderCollider*>(c);
-				float halfHeight = collider->GetHeight() * 0.5f;
-				float radius = collider->GetRadius();
-				Vector3 c = collider->GetCenter();
-				JPH::RVec3 center(c.x, c.y, c.z);
-				JPH::CylinderShapeSettings settings(halfHeight, radius);
-				JPH::ShapeSettings::ShapeResult result = settings.Create();
-
-				if(result.IsValid())
-				{
-					JPH::RotatedTranslatedShapeSettings offsetShape(center, JPH::Quat::sIdentity(), result.Get());
-
-					auto r = offsetShape.Create();
-
-					if(r.IsValid())
-					{
-						outShape = r.Get();
-						return true;
-					}
-					
-					return false;
-				}
-
-				break;
-			}
 			case ColliderType::Mesh:
-			{
-				MeshCollider *collider = static_cast<MeshCollider*>(c);
-
-				Mesh *mesh = collider->GetMesh();
-
-				if(!mesh)
-					return false;
-				
-				auto &mVertices = mesh->GetVertices();
-				JPH::VertexList vertices;
-				vertices.resize(mVertices.size());
-
-				for(size_t i = 0; i < mVertices.size(); i++)
-				{
-					auto pos = mVertices[i].position;
-					vertices[i] = JPH::Float3(pos.x, pos.y, pos.z);
-				}
-
-				auto &mIndices = mesh->GetIndices();
-				JPH::IndexedTriangleList indices;
-				indices.resize(mIndices.size() / 3);
-				size_t index = 0;
-
-				for(size_t i = 0; i < mIndices.size(); i+=3)
-				{
-					uint32_t i1 = mIndices[i+0];
-					uint32_t i2 = mIndices[i+1];
-					uint32_t i3 = mIndices[i+2];
-					indices[index++] = JPH::IndexedTriangle(i1, i2, i3);
-				}
-
-				JPH::MeshShapeSettings settings(std::move(vertices), std::move(indices));
-				JPH::ShapeSettings::ShapeResult result = settings.Create();
-
-				if(result.IsValid())
-				{
-					outShape = result.Get();
-					return true;
-				}
-
-				break;
-			}
 			case ColliderType::Sphere:
 			{
-				SphereCollider *collider = static_cast<SphereCollider*>(c);
-				Vector3 c = collider->GetCenter();
-				JPH::RVec3 center(c.x, c.y, c.z);
-				JPH::SphereShapeSettings settings(collider->GetRadius());
-				JPH::ShapeSettings::ShapeResult result = settings.Create();
-
-				if(result.IsValid())
-				{
-					JPH::RotatedTranslatedShapeSettings offsetShape(center, JPH::Quat::sIdentity(), result.Get());
-
-					auto r = offsetShape.Create();
-
-					if(r.IsValid())
-					{
-						outShape = r.Get();
-						return true;
-					}
-					
-					return false;
-				}
-
-				break;
+				return ShapeCache::GetShape(c, outShape);
 			}
 			case ColliderType::Terrain:
 			{
@@ -0,0 +1,245 @@
+#include "FrameArena.hpp"
+#include "MemoryTracker.hpp"
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define GFX_FRAME_ARENA_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define GFX_FRAME_ARENA_ASAN
+#endif
+#endif
+
+#ifdef GFX_FRAME_ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#define GFX_POISON_MEMORY(address, size) ASAN_POISON_MEMORY_REGION(address, size)
+#define GFX_UNPOISON_MEMORY(address, size) ASAN_UNPOISON_MEMORY_REGION(address, size)
+#else
+#define GFX_POISON_MEMORY(address, size) ((void)(address), (void)(size))
+#define GFX_UNPOISON_MEMORY(address, size) ((void)(address), (void)(size))
+#endif
+
+namespace GFX
+{
+    struct FrameArenaPage
+    {
+        uint8_t *data;
+        size_t size;
+        size_t offset;
+    };
+
+    //The pages are only touched by the owning thread, the statistics read the counters instead
+    struct FrameArenaBuffer
+    {
+        std::vector<FrameArenaPage> pages;
+        size_t current = 0;
+        std::atomic<size_t> usedBytes{0};
+    };
+
+    //Pages are kept when a thread exits, the next thread that starts allocating takes the arena over
+    struct FrameThreadArena
+    {
+        FrameArenaBuffer buffers[2];
+        std::atomic<size_t> capacity{0};
+        bool isUsed = false;
+    };
+
+    struct FrameThreadArenaOwner
+    {
+        FrameThreadArena *arena = nullptr;
+        ~FrameThreadArenaOwner();
+    };
+
+    static std::atomic<uint64_t> currentFrame(0);
+    static std::atomic<uint64_t> pageAllocationCount(0);
+    static uint64_t frameStartHeapAllocationCount = 0;
+    static uint64_t lastFrameHeapAllocationCount = 0;
+    static size_t lastFrameUsedBytes = 0;
+    static thread_local FrameThreadArenaOwner threadArena;
+
+    //Leaked on purpose, thread local owners may still release their arena during static destruction
+    static std::mutex &GetArenasMutex()
+    {
+        static std::mutex *mutex = new std::mutex();
+        return *mutex;
+    }
+
+    static std::vector<std::unique_ptr<FrameThreadArena>> &GetArenas()
+    {
+        static std::vector<std::unique_ptr<FrameThreadArena>> *arenas = new std::vector<std::unique_ptr<FrameThreadArena>>();
+        return *arenas;
+    }
+
+    FrameThreadArenaOwner::~FrameThreadArenaOwner()
+    {
+        if(!arena)
+            return;
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        arena->isUsed = false;
+    }
+
+    static FrameThreadArena *GetThreadArena()
+    {
+        if(threadArena.arena)
+            return threadArena.arena;
+
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        auto &arenas = GetArenas();
+
+        for(size_t i = 0; i < arenas.size(); i++)
+        {
+            if(!arenas[i]->isUsed)
+            {
+                threadArena.arena = arenas[i].get();
+                break;
+            }
+        }
+
+        if(!threadArena.arena)
+        {
+            arenas.push_back(std::make_unique<FrameThreadArena>());
+            threadArena.arena = arenas.back().get();
+        }
+
+        threadArena.arena->isUsed = true;
+        return threadArena.arena;
+    }
+
+    static void ResetBuffer(FrameArenaBuffer &buffer)
+    {
+        for(size_t i = 0; i < buffer.pages.size(); i++)
+        {
+            FrameArenaPage &page = buffer.pages[i];
+#ifndef NDEBUG
+            //Stale reads of released memory show up as a recognizable pattern
+            GFX_UNPOISON_MEMORY(page.data, page.offset);
+            std::memset(page.data, 0xCD, page.offset);
+#endif
+            GFX_POISON_MEMORY(page.data, page.size);
+            page.offset = 0;
+        }
+        buffer.current = 0;
+        buffer.usedBytes.store(0, std::memory_order_relaxed);
+    }
+
+    void FrameArena::NewFrame()
+    {
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        auto &arenas = GetArenas();
+
+        const uint64_t frame = currentFrame.load(std::memory_order_relaxed);
+        const size_t finished = frame & 1;
+        const size_t next = (frame + 1) & 1;
+
+        lastFrameUsedBytes = 0;
+
+        for(size_t i = 0; i < arenas.size(); i++)
+        {
+            lastFrameUsedBytes += arenas[i]->buffers[finished].usedBytes.load(std::memory_order_relaxed);
+            ResetBuffer(arenas[i]->buffers[next]);
+        }
+
+        const uint64_t allocationCount = GetHeapAllocationCount();
+        lastFrameHeapAllocationCount = allocationCount - frameStartHeapAllocationCount;
+        frameStartHeapAllocationCount = allocationCount;
+
+        currentFrame.store(frame + 1, std::memory_order_release);
+    }
+
+    void *FrameArena::Allocate(size_t size, size_t alignment)
+    {
+        if(size == 0)
+            size = 1;
+
+        FrameThreadArena *arena = GetThreadArena();
+        FrameArenaBuffer &buffer = arena->buffers[currentFrame.load(std::memory_order_acquire) & 1];
+
+        while(buffer.current < buffer.pages.size())
+        {
+            FrameArenaPage &page = buffer.pages[buffer.current];
+            const uintptr_t address = reinterpret_cast<uintptr_t>(page.data) + page.offset;
+            const size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+            if(page.offset + padding + size <= page.size)
+            {
+                uint8_t *pointer = page.data + page.offset + padding;
+                page.offset += padding + size;
+                buffer.usedBytes.store(buffer.usedBytes.load(std::memory_order_relaxed) + padding + size, std::memory_order_relaxed);
+                GFX_UNPOISON_MEMORY(pointer, size);
+                return pointer;
+            }
+
+            buffer.current++;
+        }
+
+        //Only happens until the arena has grown to what the busiest frame needs
+        FrameArenaPage page;
+        page.size = size + alignment > PAGE_SIZE ? size + alignment : PAGE_SIZE;
+        page.data = reinterpret_cast<uint8_t*>(::operator new(page.size));
+        page.offset = 0;
+
+        pageAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        MemoryTracker::Add(MemoryTag::Frame, page.size);
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(page.data);
+        const size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+        uint8_t *pointer = page.data + padding;
+        page.offset = padding + size;
+
+        GFX_POISON_MEMORY(page.data, page.size);
+        GFX_UNPOISON_MEMORY(pointer, size);
+
+        buffer.pages.push_back(page);
+        buffer.current = buffer.pages.size() - 1;
+        buffer.usedBytes.store(buffer.usedBytes.load(std::memory_order_relaxed) + page.offset, std::memory_order_relaxed);
+        arena->capacity.store(arena->capacity.load(std::memory_order_relaxed) + page.size, std::memory_order_relaxed);
+        return pointer;
+    }
+
+    uint64_t FrameArena::GetFrame()
+    {
+        return currentFrame.load(std::memory_order_acquire);
+    }
+
+    bool FrameArena::IsValid(uint64_t frame)
+    {
+        return GetFrame() - frame <= 1;
+    }
+
+    size_t FrameArena::GetLastFrameUsedBytes()
+    {
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        return lastFrameUsedBytes;
+    }
+
+    size_t FrameArena::GetCapacity()
+    {
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        auto &arenas = GetArenas();
+        size_t capacity = 0;
+
+        for(size_t i = 0; i < arenas.size(); i++)
+            capacity += arenas[i]->capacity.load(std::memory_order_relaxed);
+
+        return capacity;
+    }
+
+    //With GFX_COUNT_HEAP_ALLOCATIONS this counts every operator new in the process, otherwise only the pages of the arena itself
+    uint64_t FrameArena::GetHeapAllocationCount()
+    {
+#ifdef GFX_COUNT_HEAP_ALLOCATIONS
+        return MemoryTracker::GetHeapAllocationCount();
+#else
+        return pageAllocationCount.load(std::memory_order_relaxed);
+#endif
+    }
+
+    uint64_t FrameArena::GetLastFrameHeapAllocationCount()
+    {
+        std::lock_guard<std::mutex> lock(GetArenasMutex());
+        return lastFrameHeapAllocationCount;
+    }
+}
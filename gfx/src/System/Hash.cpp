@@ -0,0 +1,62 @@
+#include "Hash.hpp"
+
+namespace GFX
+{
+    uint32_t Hash::FNV1a32(const void *data, size_t size, uint32_t seed)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+        uint32_t hash = seed;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    uint32_t Hash::FNV1a32(const std::string &str, uint32_t seed)
+    {
+        return FNV1a32(str.data(), str.size(), seed);
+    }
+
+    uint64_t Hash::FNV1a64(const void *data, size_t size, uint64_t seed)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+        uint64_t hash = seed;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    uint64_t Hash::FNV1a64(const std::string &str, uint64_t seed)
+    {
+        return FNV1a64(str.data(), str.size(), seed);
+    }
+
+    uint64_t Hash::Combine(uint64_t seed, uint64_t value)
+    {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4);
+        return seed;
+    }
+
+    std::string Hash::ToHexString(uint64_t hash)
+    {
+        const char *digits = "0123456789abcdef";
+        std::string str(16, '0');
+
+        for(int i = 15; i >= 0; i--)
+        {
+            str[i] = digits[hash & 0xF];
+            hash >>= 4;
+        }
+
+        return str;
+    }
+}
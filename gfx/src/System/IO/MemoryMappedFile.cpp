@@ -0,0 +1,174 @@
+#include "MemoryMappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GFX
+{
+    MemoryMappedFile::MemoryMappedFile()
+    {
+        data = nullptr;
+        size = 0;
+#ifdef _WIN32
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#else
+        fileDescriptor = -1;
+#endif
+    }
+
+    MemoryMappedFile::MemoryMappedFile(const std::string &filepath) : MemoryMappedFile()
+    {
+        Open(filepath);
+    }
+
+    MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&other) noexcept
+    {
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#else
+        fileDescriptor = std::exchange(other.fileDescriptor, -1);
+#endif
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        Close();
+    }
+
+    MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile &&other) noexcept
+    {
+        if(this != &other)
+        {
+            Close();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+#ifdef _WIN32
+            fileHandle = std::exchange(other.fileHandle, nullptr);
+            mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#else
+            fileDescriptor = std::exchange(other.fileDescriptor, -1);
+#endif
+        }
+        return *this;
+    }
+
+    bool MemoryMappedFile::Open(const std::string &filepath)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if(file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+
+        if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if(mapping == nullptr)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        if(view == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        data = static_cast<const uint8_t*>(view);
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = open(filepath.c_str(), O_RDONLY);
+
+        if(fd < 0)
+            return false;
+
+        struct stat info;
+
+        //Empty files can't be mapped
+        if(fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if(view == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+
+        fileDescriptor = fd;
+        data = static_cast<const uint8_t*>(view);
+        size = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void MemoryMappedFile::Close()
+    {
+#ifdef _WIN32
+        if(data)
+            UnmapViewOfFile(data);
+        if(mappingHandle)
+            CloseHandle(mappingHandle);
+        if(fileHandle)
+            CloseHandle(fileHandle);
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#else
+        if(data)
+            munmap(const_cast<uint8_t*>(data), size);
+        if(fileDescriptor >= 0)
+            close(fileDescriptor);
+        fileDescriptor = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    bool MemoryMappedFile::IsOpen() const
+    {
+        return data != nullptr;
+    }
+
+    const uint8_t *MemoryMappedFile::GetData() const
+    {
+        return data;
+    }
+
+    size_t MemoryMappedFile::GetSize() const
+    {
+        return size;
+    }
+}
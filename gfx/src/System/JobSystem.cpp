@@ -0,0 +1,371 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace GFX
+{
+    struct JobWorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<JobEntry> jobs[static_cast<size_t>(JobPriority::Count)];
+    };
+
+    //Queue 0 belongs to the main thread, the workers own the others
+    static std::vector<std::unique_ptr<JobWorkerQueue>> queues;
+    static std::vector<std::thread> workers;
+    static std::deque<JobEntry> mainThreadJobs;
+    static std::mutex mainThreadMutex;
+    static std::mutex sleepMutex;
+    static std::condition_variable sleepCondition;
+    static std::atomic<size_t> pendingJobs(0);
+    static std::atomic<uint32_t> nextQueue(0);
+    static std::atomic<bool> quit(false);
+    static std::atomic<bool> initialized(false);
+    static std::thread::id mainThreadId;
+    static thread_local int32_t currentWorker = -1;
+
+    JobCounter::JobCounter()
+    {
+        count = 0;
+    }
+
+    int32_t JobCounter::GetCount() const
+    {
+        return count.load();
+    }
+
+    bool JobCounter::IsDone() const
+    {
+        return count.load() == 0;
+    }
+
+    void JobSystem::Initialize(uint32_t workerCount)
+    {
+        if(initialized)
+            return;
+
+        if(workerCount == DEFAULT_WORKER_COUNT)
+            workerCount = std::max(std::thread::hardware_concurrency(), 1U) - 1;
+
+        mainThreadId = std::this_thread::get_id();
+        currentWorker = 0;
+        quit = false;
+        pendingJobs = 0;
+
+        for(uint32_t i = 0; i < workerCount + 1; i++)
+            queues.push_back(std::make_unique<JobWorkerQueue>());
+
+        initialized = true;
+
+        for(uint32_t i = 0; i < workerCount; i++)
+            workers.emplace_back(&JobSystem::WorkerLoop, static_cast<int32_t>(i + 1));
+    }
+
+    void JobSystem::Deinitialize()
+    {
+        if(!initialized)
+            return;
+
+        //Finish everything that is still queued so nobody is left waiting on a counter
+        while(pendingJobs > 0 || TryExecuteMainThread())
+        {
+            if(!TryExecute(currentWorker))
+                std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            quit = true;
+        }
+
+        sleepCondition.notify_all();
+
+        for(size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+
+        while(TryExecute(currentWorker) || TryExecuteMainThread()) {}
+
+        workers.clear();
+        queues.clear();
+        initialized = false;
+        currentWorker = -1;
+    }
+
+    bool JobSystem::IsInitialized()
+    {
+        return initialized;
+    }
+
+    uint32_t JobSystem::GetWorkerCount()
+    {
+        return static_cast<uint32_t>(workers.size());
+    }
+
+    bool JobSystem::IsMainThread()
+    {
+        if(!initialized)
+            return true;
+        return std::this_thread::get_id() == mainThreadId;
+    }
+
+    void JobSystem::Schedule(const JobFunction &job, JobCounter *counter, JobPriority priority)
+    {
+        if(counter)
+            counter->count++;
+
+        JobEntry entry = { job, counter, priority, false };
+        Enqueue(std::move(entry));
+    }
+
+    void JobSystem::ScheduleAfter(JobCounter &dependency, const JobFunction &job, JobCounter *counter, JobPriority priority)
+    {
+        if(counter)
+            counter->count++;
+
+        JobEntry entry = { job, counter, priority, false };
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.mutex);
+
+            if(dependency.count > 0)
+            {
+                dependency.continuations.push_back(std::move(entry));
+                return;
+            }
+        }
+
+        Enqueue(std::move(entry));
+    }
+
+    void JobSystem::ScheduleOnMainThread(const JobFunction &job, JobCounter *counter)
+    {
+        if(counter)
+            counter->count++;
+
+        JobEntry entry = { job, counter, JobPriority::Normal, true };
+        Enqueue(std::move(entry));
+    }
+
+    void JobSystem::Wait(JobCounter &counter)
+    {
+        while(counter.count.load() > 0)
+        {
+            bool executed = IsMainThread() && TryExecuteMainThread();
+
+            //The main thread leaves long running background work to the workers so the frame is not held up
+            if(!executed)
+                executed = TryExecute(currentWorker, IsMainThread() && workers.size() > 0 ? JobPriority::Normal : JobPriority::Low);
+
+            if(!executed)
+                std::this_thread::yield();
+        }
+
+        //The last job may still be inside Finish, wait until it lets go of the counter
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    void JobSystem::ParallelFor(size_t count, const std::function<void(size_t)> &job, JobPriority priority)
+    {
+        ParallelForRange(count, 0, [&job] (size_t first, size_t last) {
+            for(size_t i = first; i < last; i++)
+                job(i);
+        }, priority);
+    }
+
+    void JobSystem::ParallelForRange(size_t count, size_t batchSize, const std::function<void(size_t,size_t)> &job, JobPriority priority)
+    {
+        if(count == 0)
+            return;
+
+        if(batchSize == 0)
+            batchSize = std::max<size_t>(1, count / ((GetWorkerCount() + 1) * 4));
+
+        if(!initialized || batchSize >= count)
+        {
+            job(0, count);
+            return;
+        }
+
+        JobCounter counter;
+
+        for(size_t first = batchSize; first < count; first += batchSize)
+        {
+            size_t last = std::min(first + batchSize, count);
+            Schedule([&job, first, last] () { job(first, last); }, &counter, priority);
+        }
+
+        //The calling thread takes the first batch instead of idling
+        job(0, batchSize);
+        Wait(counter);
+    }
+
+    void JobSystem::NewFrame()
+    {
+        if(!initialized)
+            return;
+
+        //Jobs that queue more main thread work get to run next frame
+        size_t count;
+
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            count = mainThreadJobs.size();
+        }
+
+        for(size_t i = 0; i < count; i++)
+            TryExecuteMainThread();
+
+        //Without workers background jobs only make progress here
+        if(workers.size() == 0)
+        {
+            while(TryExecute(0)) {}
+        }
+    }
+
+    bool JobSystem::TryExecute(int32_t workerIndex, JobPriority lowestPriority)
+    {
+        if(!initialized)
+            return false;
+
+        const size_t queueCount = queues.size();
+
+        for(size_t priority = 0; priority <= static_cast<size_t>(lowestPriority); priority++)
+        {
+            JobEntry job;
+            bool found = false;
+
+            if(workerIndex >= 0)
+            {
+                JobWorkerQueue &queue = *queues[workerIndex];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+
+                if(queue.jobs[priority].size() > 0)
+                {
+                    job = std::move(queue.jobs[priority].back());
+                    queue.jobs[priority].pop_back();
+                    found = true;
+                }
+            }
+
+            for(size_t i = 1; i <= queueCount && !found; i++)
+            {
+                size_t victim = (static_cast<size_t>(std::max(workerIndex, 0)) + i) % queueCount;
+
+                if(static_cast<int32_t>(victim) == workerIndex)
+                    continue;
+
+                JobWorkerQueue &queue = *queues[victim];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+
+                if(queue.jobs[priority].size() > 0)
+                {
+                    job = std::move(queue.jobs[priority].front());
+                    queue.jobs[priority].pop_front();
+                    found = true;
+                }
+            }
+
+            if(found)
+            {
+                pendingJobs--;
+                Execute(job);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool JobSystem::TryExecuteMainThread()
+    {
+        JobEntry job;
+
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+
+            if(mainThreadJobs.size() == 0)
+                return false;
+
+            job = std::move(mainThreadJobs.front());
+            mainThreadJobs.pop_front();
+        }
+
+        Execute(job);
+        return true;
+    }
+
+    void JobSystem::Execute(JobEntry &job)
+    {
+        job.function();
+        Finish(job.counter);
+    }
+
+    void JobSystem::Enqueue(JobEntry &&job)
+    {
+        //Before Initialize or after Deinitialize there is nobody to hand the job to
+        if(!initialized)
+        {
+            Execute(job);
+            return;
+        }
+
+        if(job.mainThreadOnly)
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            mainThreadJobs.push_back(std::move(job));
+            return;
+        }
+
+        size_t index = currentWorker >= 0 ? static_cast<size_t>(currentWorker) : nextQueue++ % queues.size();
+        JobWorkerQueue &queue = *queues[index];
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs[static_cast<size_t>(job.priority)].push_back(std::move(job));
+            pendingJobs++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+
+        sleepCondition.notify_one();
+    }
+
+    void JobSystem::Finish(JobCounter *counter)
+    {
+        if(!counter)
+            return;
+
+        std::vector<JobEntry> ready;
+
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if(--counter->count == 0)
+                ready.swap(counter->continuations);
+        }
+
+        for(size_t i = 0; i < ready.size(); i++)
+            Enqueue(std::move(ready[i]));
+    }
+
+    void JobSystem::WorkerLoop(int32_t workerIndex)
+    {
+        currentWorker = workerIndex;
+
+        while(true)
+        {
+            if(TryExecute(workerIndex))
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [] () { return quit || pendingJobs > 0; });
+
+            if(quit)
+                return;
+        }
+    }
+}
@@ -0,0 +1,429 @@
+#include "MemoryTracker.hpp"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace GFX
+{
+    //Sits right in front of every block from Allocate, so Free knows the size and tag without a lookup
+    struct AllocationHeader
+    {
+        size_t size;
+        uint16_t tag;
+        uint16_t isAligned;
+        uint32_t offset;
+    };
+
+    static constexpr size_t TAG_COUNT = static_cast<size_t>(MemoryTag::Count);
+    static constexpr uint16_t NO_TAG = 0xFFFF;
+
+    //Only constant initialized state, operator new can run before any dynamic initializer
+    static std::atomic<size_t> currentBytes[TAG_COUNT];
+    static std::atomic<size_t> peakBytes[TAG_COUNT];
+    static std::atomic<size_t> budgets[TAG_COUNT];
+    static std::atomic<uint64_t> allocationCounts[TAG_COUNT];
+    static std::atomic<uint64_t> freeCounts[TAG_COUNT];
+    static std::atomic<size_t> heapBytes(0);
+    static std::atomic<size_t> heapPeakBytes(0);
+    static std::atomic<uint64_t> heapAllocationCount(0);
+    static std::mutex callbackMutex;
+    static MemoryBudgetCallback callbacks[TAG_COUNT];
+
+    static void UpdatePeak(std::atomic<size_t> &peak, size_t value)
+    {
+        size_t previous = peak.load(std::memory_order_relaxed);
+        while(value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed));
+    }
+
+    static void RecordAllocation(uint16_t tag, size_t size)
+    {
+#ifdef GFX_COUNT_HEAP_ALLOCATIONS
+        heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        UpdatePeak(heapPeakBytes, heapBytes.fetch_add(size, std::memory_order_relaxed) + size);
+#endif
+        if(tag != NO_TAG)
+            MemoryTracker::Add(static_cast<MemoryTag>(tag), size);
+    }
+
+    static void RecordFree(uint16_t tag, size_t size)
+    {
+#ifdef GFX_COUNT_HEAP_ALLOCATIONS
+        heapBytes.fetch_sub(size, std::memory_order_relaxed);
+#endif
+        if(tag != NO_TAG)
+            MemoryTracker::Remove(static_cast<MemoryTag>(tag), size);
+    }
+
+    static void *AllocateBlock(size_t size, size_t alignment, uint16_t tag)
+    {
+        if(alignment < sizeof(AllocationHeader))
+            alignment = sizeof(AllocationHeader);
+
+        const bool isAligned = alignment > alignof(std::max_align_t);
+        const size_t totalSize = alignment + size;
+        uint8_t *base = nullptr;
+
+        if(isAligned)
+        {
+#ifdef _WIN32
+            base = reinterpret_cast<uint8_t*>(_aligned_malloc(totalSize, alignment));
+#else
+            base = reinterpret_cast<uint8_t*>(std::aligned_alloc(alignment, (totalSize + alignment - 1) & ~(alignment - 1)));
+#endif
+        }
+        else
+        {
+            base = reinterpret_cast<uint8_t*>(std::malloc(totalSize));
+        }
+
+        if(!base)
+            return nullptr;
+
+        uint8_t *pointer = base + alignment;
+        AllocationHeader *header = reinterpret_cast<AllocationHeader*>(pointer) - 1;
+        header->size = size;
+        header->tag = tag;
+        header->isAligned = isAligned ? 1 : 0;
+        header->offset = static_cast<uint32_t>(alignment);
+
+        RecordAllocation(tag, size);
+        return pointer;
+    }
+
+    static void FreeBlock(void *pointer)
+    {
+        if(!pointer)
+            return;
+
+        AllocationHeader *header = reinterpret_cast<AllocationHeader*>(pointer) - 1;
+        uint8_t *base = reinterpret_cast<uint8_t*>(pointer) - header->offset;
+
+        RecordFree(header->tag, header->size);
+
+        if(header->isAligned)
+        {
+#ifdef _WIN32
+            _aligned_free(base);
+#else
+            std::free(base);
+#endif
+        }
+        else
+        {
+            std::free(base);
+        }
+    }
+
+    const MemoryTagStats &MemorySnapshot::Get(MemoryTag tag) const
+    {
+        return tags[static_cast<size_t>(tag)];
+    }
+
+    void MemoryTracker::Add(MemoryTag tag, size_t bytes)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        if(index >= TAG_COUNT)
+            return;
+        allocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+        UpdatePeak(peakBytes[index], currentBytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    }
+
+    void MemoryTracker::Remove(MemoryTag tag, size_t bytes)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        if(index >= TAG_COUNT)
+            return;
+        freeCounts[index].fetch_add(1, std::memory_order_relaxed);
+        currentBytes[index].fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void *MemoryTracker::Allocate(MemoryTag tag, size_t size, size_t alignment)
+    {
+        return AllocateBlock(size, alignment, static_cast<uint16_t>(tag));
+    }
+
+    void *MemoryTracker::Reallocate(MemoryTag tag, void *pointer, size_t size)
+    {
+        if(!pointer)
+            return Allocate(tag, size);
+
+        AllocationHeader *header = reinterpret_cast<AllocationHeader*>(pointer) - 1;
+        void *block = AllocateBlock(size, header->offset, static_cast<uint16_t>(tag));
+
+        if(!block)
+            return nullptr;
+
+        std::memcpy(block, pointer, header->size < size ? header->size : size);
+        FreeBlock(pointer);
+        return block;
+    }
+
+    void MemoryTracker::Free(void *pointer)
+    {
+        FreeBlock(pointer);
+    }
+
+    void MemoryTracker::SetBudget(MemoryTag tag, size_t bytes)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        if(index < TAG_COUNT)
+            budgets[index].store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t MemoryTracker::GetBudget(MemoryTag tag)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        return index < TAG_COUNT ? budgets[index].load(std::memory_order_relaxed) : 0;
+    }
+
+    void MemoryTracker::SetBudgetCallback(MemoryTag tag, const MemoryBudgetCallback &callback)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        if(index >= TAG_COUNT)
+            return;
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callbacks[index] = callback;
+    }
+
+    void MemoryTracker::CheckBudgets()
+    {
+        for(size_t i = 0; i < TAG_COUNT; i++)
+        {
+            const size_t budget = budgets[i].load(std::memory_order_relaxed);
+            const size_t current = currentBytes[i].load(std::memory_order_relaxed);
+
+            //A budget of zero means unlimited
+            if(budget == 0 || current <= budget)
+                continue;
+
+            //Copied so a callback can replace itself or set another one
+            MemoryBudgetCallback callback;
+
+            {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                callback = callbacks[i];
+            }
+
+            if(callback)
+                callback(static_cast<MemoryTag>(i), current, budget);
+        }
+    }
+
+    size_t MemoryTracker::GetCurrentBytes(MemoryTag tag)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        return index < TAG_COUNT ? currentBytes[index].load(std::memory_order_relaxed) : 0;
+    }
+
+    size_t MemoryTracker::GetPeakBytes(MemoryTag tag)
+    {
+        const size_t index = static_cast<size_t>(tag);
+        return index < TAG_COUNT ? peakBytes[index].load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t MemoryTracker::GetHeapAllocationCount()
+    {
+        return heapAllocationCount.load(std::memory_order_relaxed);
+    }
+
+    void MemoryTracker::ResetPeaks()
+    {
+        for(size_t i = 0; i < TAG_COUNT; i++)
+            peakBytes[i].store(currentBytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        heapPeakBytes.store(heapBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    MemorySnapshot MemoryTracker::GetSnapshot()
+    {
+        MemorySnapshot snapshot;
+        snapshot.trackedBytes = 0;
+
+        for(size_t i = 0; i < TAG_COUNT; i++)
+        {
+            MemoryTagStats &stats = snapshot.tags[i];
+            stats.currentBytes = currentBytes[i].load(std::memory_order_relaxed);
+            stats.peakBytes = peakBytes[i].load(std::memory_order_relaxed);
+            stats.budget = budgets[i].load(std::memory_order_relaxed);
+            stats.allocationCount = allocationCounts[i].load(std::memory_order_relaxed);
+            stats.freeCount = freeCounts[i].load(std::memory_order_relaxed);
+            snapshot.trackedBytes += stats.currentBytes;
+        }
+
+        snapshot.heapBytes = heapBytes.load(std::memory_order_relaxed);
+        snapshot.heapPeakBytes = heapPeakBytes.load(std::memory_order_relaxed);
+        snapshot.heapAllocationCount = heapAllocationCount.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    const char *MemoryTracker::GetTagName(MemoryTag tag)
+    {
+        switch(tag)
+        {
+            case MemoryTag::General:
+                return "General";
+            case MemoryTag::Resources:
+                return "Resources";
+            case MemoryTag::Mesh:
+                return "Mesh";
+            case MemoryTag::Image:
+                return "Image";
+            case MemoryTag::Audio:
+                return "Audio";
+            case MemoryTag::Physics:
+                return "Physics";
+            case MemoryTag::AssetPack:
+                return "AssetPack";
+            case MemoryTag::Frame:
+                return "Frame";
+            default:
+                return "Unknown";
+        }
+    }
+
+    MemoryUsage::MemoryUsage(MemoryTag tag)
+    {
+        this->tag = tag;
+        this->bytes = 0;
+    }
+
+    MemoryUsage::MemoryUsage(const MemoryUsage &other)
+    {
+        tag = other.tag;
+        bytes = 0;
+        Set(other.bytes);
+    }
+
+    MemoryUsage::MemoryUsage(MemoryUsage &&other) noexcept
+    {
+        tag = other.tag;
+        bytes = other.bytes;
+        other.bytes = 0;
+    }
+
+    MemoryUsage &MemoryUsage::operator=(const MemoryUsage &other)
+    {
+        if(this != &other)
+            Set(other.bytes);
+        return *this;
+    }
+
+    MemoryUsage &MemoryUsage::operator=(MemoryUsage &&other) noexcept
+    {
+        if(this == &other)
+            return *this;
+
+        if(tag == other.tag)
+        {
+            Set(0);
+            bytes = other.bytes;
+            other.bytes = 0;
+        }
+        else
+        {
+            Set(other.bytes);
+            other.Set(0);
+        }
+
+        return *this;
+    }
+
+    MemoryUsage::~MemoryUsage()
+    {
+        Set(0);
+    }
+
+    void MemoryUsage::Set(size_t bytes)
+    {
+        if(bytes == this->bytes)
+            return;
+
+        if(this->bytes > 0)
+            MemoryTracker::Remove(tag, this->bytes);
+        if(bytes > 0)
+            MemoryTracker::Add(tag, bytes);
+
+        this->bytes = bytes;
+    }
+
+    size_t MemoryUsage::Get() const
+    {
+        return bytes;
+    }
+
+    MemoryTag MemoryUsage::GetTag() const
+    {
+        return tag;
+    }
+}
+
+//With GFX_COUNT_HEAP_ALLOCATIONS every operator new in the process goes through here and shows up in the heap totals
+#ifdef GFX_COUNT_HEAP_ALLOCATIONS
+
+void *operator new(size_t size)
+{
+    void *pointer = GFX::AllocateBlock(size, alignof(std::max_align_t), GFX::NO_TAG);
+    if(!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    void *pointer = GFX::AllocateBlock(size, static_cast<size_t>(alignment), GFX::NO_TAG);
+    if(!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete(void *pointer, size_t size) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete[](void *pointer, size_t size) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete(void *pointer, size_t size, std::align_val_t alignment) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+void operator delete[](void *pointer, size_t size, std::align_val_t alignment) noexcept
+{
+    GFX::FreeBlock(pointer);
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "SlabAllocator.hpp"
+#include <cstddef>
+#include <new>
+
+namespace GFX
+{
+    SlabAllocator::SlabAllocator(size_t blockSize, size_t blocksPerSlab)
+    {
+        //Every block has to be able to hold the free list link and keep the default new alignment
+        const size_t alignment = alignof(std::max_align_t);
+
+        if(blockSize < sizeof(FreeBlock))
+            blockSize = sizeof(FreeBlock);
+
+        this->blockSize = (blockSize + alignment - 1) & ~(alignment - 1);
+        this->blocksPerSlab = blocksPerSlab > 0 ? blocksPerSlab : 1;
+        this->allocatedCount = 0;
+        this->freeList = nullptr;
+    }
+
+    SlabAllocator::~SlabAllocator()
+    {
+        for(size_t i = 0; i < slabs.size(); i++)
+            ::operator delete(slabs[i]);
+        slabs.clear();
+        freeList = nullptr;
+    }
+
+    void *SlabAllocator::Allocate()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(!freeList)
+            AddSlab();
+
+        FreeBlock *block = freeList;
+        freeList = block->next;
+        allocatedCount++;
+        return block;
+    }
+
+    void SlabAllocator::Deallocate(void *block)
+    {
+        if(!block)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        FreeBlock *freeBlock = reinterpret_cast<FreeBlock*>(block);
+        freeBlock->next = freeList;
+        freeList = freeBlock;
+        allocatedCount--;
+    }
+
+    size_t SlabAllocator::GetBlockSize() const
+    {
+        return blockSize;
+    }
+
+    size_t SlabAllocator::GetAllocatedCount() const
+    {
+        return allocatedCount;
+    }
+
+    size_t SlabAllocator::GetCapacity() const
+    {
+        return slabs.size() * blocksPerSlab;
+    }
+
+    void SlabAllocator::AddSlab()
+    {
+        uint8_t *slab = reinterpret_cast<uint8_t*>(::operator new(blockSize * blocksPerSlab));
+        slabs.push_back(slab);
+
+        //Link back to front so blocks are handed out in address order
+        for(size_t i = blocksPerSlab; i > 0; i--)
+        {
+            FreeBlock *block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+}
@@ -120,6 +120,52 @@ namespace GFX
         return -1; // Indicates substring not found
     }
 
+    uint32_t String::DecodeUTF8(const char *text, size_t length, size_t &index)
+    {
+        // Decodes the codepoint at index and advances index past it. Invalid sequences yield U+FFFD.
+        const uint32_t replacement = 0xFFFD;
+        const uint8_t *p = reinterpret_cast<const uint8_t*>(text);
+        uint8_t lead = p[index++];
+
+        if(lead < 0x80)
+            return lead;
+
+        uint32_t codepoint = 0;
+        size_t continuationBytes = 0;
+
+        if((lead & 0xE0) == 0xC0)
+        {
+            codepoint = lead & 0x1F;
+            continuationBytes = 1;
+        }
+        else if((lead & 0xF0) == 0xE0)
+        {
+            codepoint = lead & 0x0F;
+            continuationBytes = 2;
+        }
+        else if((lead & 0xF8) == 0xF0)
+        {
+            codepoint = lead & 0x07;
+            continuationBytes = 3;
+        }
+        else
+        {
+            return replacement;
+        }
+
+        for(size_t i = 0; i < continuationBytes; i++)
+        {
+            if(index >= length || (p[index] & 0xC0) != 0x80)
+                return replacement;
+            codepoint = (codepoint << 6) | (p[index++] & 0x3F);
+        }
+
+        if(codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+            return replacement;
+
+        return codepoint;
+    }
+
     bool String::TryParseInt8(const std::string &str, int8_t &value)
     {
         std::stringstream stream(str);
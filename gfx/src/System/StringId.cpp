@@ -0,0 +1,170 @@
+#include "StringId.hpp"
+#include "Hash.hpp"
+#include "../Core/Debug.hpp"
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace GFX
+{
+    struct StringIdentity
+    {
+        size_t operator()(uint64_t id) const
+        {
+            return static_cast<size_t>(id);
+        }
+    };
+
+    //Node based, so references to the strings stay valid while the table grows
+    static std::unordered_map<uint64_t, std::string, StringIdentity> &GetTable()
+    {
+        static std::unordered_map<uint64_t, std::string, StringIdentity> table;
+        return table;
+    }
+
+    static std::shared_mutex &GetTableMutex()
+    {
+        static std::shared_mutex mutex;
+        return mutex;
+    }
+
+    static bool IsSameText(const std::string &stored, const char *text, size_t length)
+    {
+        return stored.size() == length && memcmp(stored.data(), text, length) == 0;
+    }
+
+    //Two different strings with the same id would silently compare as equal
+    static void ReportCollision(const std::string &stored, const char *text, size_t length)
+    {
+        Debug::WriteError("[STRINGID] hash collision between '" + stored + "' and '" + std::string(text, length) + "'");
+        assert(false && "StringId hash collision");
+    }
+
+    StringId::StringId()
+    {
+        id = 0;
+    }
+
+    StringId::StringId(const std::string &text)
+    {
+        id = Intern(text.data(), text.size());
+    }
+
+    StringId::StringId(const char *text, size_t length)
+    {
+        id = Intern(text, length);
+    }
+
+    uint64_t StringId::GetId() const
+    {
+        return id;
+    }
+
+    const std::string &StringId::GetString() const
+    {
+        static const std::string empty;
+
+        if(id == 0)
+            return empty;
+
+        std::shared_lock<std::shared_mutex> lock(GetTableMutex());
+        auto &table = GetTable();
+        auto it = table.find(id);
+        return it != table.end() ? it->second : empty;
+    }
+
+    bool StringId::IsEmpty() const
+    {
+        return id == 0;
+    }
+
+    bool StringId::operator==(const StringId &other) const
+    {
+        return id == other.id;
+    }
+
+    bool StringId::operator!=(const StringId &other) const
+    {
+        return id != other.id;
+    }
+
+    bool StringId::operator<(const StringId &other) const
+    {
+        return id < other.id;
+    }
+
+    //Lookups with text that was never interned can not match anything, so they do not grow the table
+    bool StringId::TryGet(const std::string &text, StringId &value)
+    {
+        value.id = 0;
+
+        if(text.size() == 0)
+            return true;
+
+        const uint64_t hash = Hash::FNV1a64(text.data(), text.size());
+
+        const std::string *stored = nullptr;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(GetTableMutex());
+            auto &table = GetTable();
+            auto it = table.find(hash);
+
+            if(it == table.end())
+                return false;
+
+            stored = &it->second;
+        }
+
+        if(!IsSameText(*stored, text.data(), text.size()))
+        {
+            ReportCollision(*stored, text.data(), text.size());
+            return false;
+        }
+
+        value.id = hash;
+        return true;
+    }
+
+    size_t StringId::GetCount()
+    {
+        std::shared_lock<std::shared_mutex> lock(GetTableMutex());
+        return GetTable().size();
+    }
+
+    uint64_t StringId::Intern(const char *text, size_t length)
+    {
+        if(!text || length == 0)
+            return 0;
+
+        const uint64_t hash = Hash::FNV1a64(text, length);
+        auto &table = GetTable();
+
+        const std::string *stored = nullptr;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(GetTableMutex());
+            auto it = table.find(hash);
+            if(it != table.end())
+                stored = &it->second;
+        }
+
+        //Another thread may add the same text in between, the emplace then finds it
+        if(!stored)
+        {
+            std::unique_lock<std::shared_mutex> lock(GetTableMutex());
+            auto result = table.emplace(hash, std::string(text, length));
+            if(result.second)
+                return hash;
+            stored = &result.first->second;
+        }
+
+        //On a collision the first string keeps the id
+        if(!IsSameText(*stored, text, length))
+            ReportCollision(*stored, text, length);
+
+        return hash;
+    }
+}
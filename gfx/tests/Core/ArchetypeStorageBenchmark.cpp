@@ -0,0 +1,230 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+#include "Core/ArchetypeComponent.hpp"
+#include "Graphics/Renderers/MeshRenderer.hpp"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace GFX;
+
+//Transform as it was before its data moved into archetype storage: the data inline in the component, same accessors
+class InlineTransform : public Component
+{
+private:
+    Vector3 localPosition;
+    Quaternion localRotation;
+    Vector3 localScale;
+    Vector3 velocity;
+    Vector3 previousPosition;
+    Vector3 newRotation;
+    InlineTransform *parent;
+    InlineTransform *root;
+    std::vector<InlineTransform*> children;
+    mutable Matrix4 cachedWorldMatrix;
+    mutable bool isDirty;
+
+    void RecalculateModelMatrix() const
+    {
+        Matrix4 localMatrix = glm::translate(glm::mat4(1.0f), localPosition) * glm::toMat4(localRotation) * glm::scale(glm::mat4(1.0f), localScale);
+
+        if(parent)
+            cachedWorldMatrix = parent->GetModelMatrix() * localMatrix;
+        else
+            cachedWorldMatrix = localMatrix;
+
+        isDirty = false;
+    }
+
+    void MarkDirty()
+    {
+        if(!isDirty)
+        {
+            isDirty = true;
+            for(InlineTransform *child : children)
+                child->MarkDirty();
+        }
+    }
+public:
+    InlineTransform() : localPosition(0, 0, 0), localRotation(1, 0, 0, 0), localScale(1, 1, 1), parent(nullptr), root(nullptr), isDirty(true)
+    {
+    }
+
+    Matrix4 GetModelMatrix() const
+    {
+        if(isDirty)
+            RecalculateModelMatrix();
+        return cachedWorldMatrix;
+    }
+
+    void SetLocalPosition(const Vector3 &value)
+    {
+        localPosition = value;
+        MarkDirty();
+    }
+
+    Vector3 GetLocalPosition() const
+    {
+        return localPosition;
+    }
+};
+
+//MeshRenderer as it was before, the per frame bounds inline in the component
+struct InlineMeshRenderer : Component
+{
+    BoundingBox bounds;
+    bool isVisible;
+};
+
+//Only the archetype state of a MeshRenderer, the real one registers with Graphics
+struct PackedMeshRenderer : Component
+{
+    ArchetypeState<MeshRendererState> state;
+};
+
+//GameObject::GetTransform() used to return a member, keep the baseline pointers next to their objects the same way
+struct Entry
+{
+    std::unique_ptr<GameObject> object;
+    InlineTransform *inlineTransform;
+    InlineMeshRenderer *inlineRenderer;
+    PackedMeshRenderer *packedRenderer;
+};
+
+static Matrix4 GetLocalMatrix(const Vector3 &position, const Quaternion &rotation, const Vector3 &scale)
+{
+    return glm::translate(Matrix4(1.0f), position) * glm::toMat4(rotation) * glm::scale(Matrix4(1.0f), scale);
+}
+
+//Moves every object a little and rebuilds its matrix, the per frame work of physics or animation.
+//Then transforms the mesh bounds of every object, the per frame work of MeshRenderer::OnRender.
+int main(int argc, char **argv)
+{
+    const size_t objectCount = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t frameCount = 10;
+    const Vector3 offset(0.01f, 0.0f, 0.0f);
+    const BoundingBox meshBounds(Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, 0.5f));
+
+    std::vector<Entry> entries;
+    entries.reserve(objectCount);
+
+    for(size_t i = 0; i < objectCount; i++)
+    {
+        Entry entry;
+        entry.object = std::make_unique<GameObject>();
+        entry.object->GetTransform()->SetLocalPosition(Vector3(static_cast<float>(i), 0, 0));
+
+        entry.inlineTransform = entry.object->AddComponent<InlineTransform>();
+        entry.inlineTransform->SetLocalPosition(Vector3(static_cast<float>(i), 0, 0));
+
+        entry.inlineRenderer = entry.object->AddComponent<InlineMeshRenderer>();
+        entry.inlineRenderer->isVisible = false;
+
+        entry.packedRenderer = entry.object->AddComponent<PackedMeshRenderer>();
+        entry.packedRenderer->state.Create(entry.packedRenderer, MeshRendererState{ BoundingBox(), false });
+
+        entries.push_back(std::move(entry));
+    }
+
+    //Objects of a long running scene were created at different times, walking them no longer follows memory
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(1));
+
+    double checksum = 0.0;
+    Stopwatch stopwatch;
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        for(const Entry &entry : entries)
+        {
+            InlineTransform *transform = entry.inlineTransform;
+            transform->SetLocalPosition(transform->GetLocalPosition() + offset);
+            checksum += transform->GetModelMatrix()[3].x;
+        }
+    }
+
+    const double inlineTransforms = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        for(const Entry &entry : entries)
+        {
+            Transform *transform = entry.object->GetTransform();
+            transform->SetLocalPosition(transform->GetLocalPosition() + offset);
+            checksum -= transform->GetModelMatrix()[3].x;
+        }
+    }
+
+    const double transforms = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    //All objects here are roots, so the world matrix is the local one
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        ArchetypeStorage::GetDefault().ForEach<TransformState>([&checksum, offset] (TransformState &state) {
+            state.localPosition += offset;
+            state.worldMatrix = GetLocalMatrix(state.localPosition, state.localRotation, state.localScale);
+            state.isDirty = false;
+            checksum += state.worldMatrix[3].x;
+        });
+    }
+
+    const double packedTransforms = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        for(const Entry &entry : entries)
+        {
+            BoundingBox bounds = meshBounds;
+            bounds.Transform(entry.inlineTransform->GetModelMatrix());
+            entry.inlineRenderer->bounds = bounds;
+            entry.inlineRenderer->isVisible = bounds.GetMin().x < 1e9f;
+            checksum += entry.inlineRenderer->isVisible ? 1.0 : 0.0;
+        }
+    }
+
+    const double inlineRenderers = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        for(const Entry &entry : entries)
+        {
+            BoundingBox bounds = meshBounds;
+            bounds.Transform(entry.object->GetTransform()->GetModelMatrix());
+            MeshRendererState *state = entry.packedRenderer->state.Get();
+            state->bounds = bounds;
+            state->isVisible = bounds.GetMin().x < 1e9f;
+            checksum -= state->isVisible ? 1.0 : 0.0;
+        }
+    }
+
+    const double renderers = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        ArchetypeStorage::GetDefault().ForEach<ArchetypeOwner, MeshRendererState>([&checksum, &meshBounds] (ArchetypeOwner &owner, MeshRendererState &state) {
+            BoundingBox bounds = meshBounds;
+            bounds.Transform(owner.component->GetTransform()->GetModelMatrix());
+            state.bounds = bounds;
+            state.isVisible = bounds.GetMin().x < 1e9f;
+            checksum += state.isVisible ? 1.0 : 0.0;
+        });
+    }
+
+    const double packedRenderers = stopwatch.GetElapsedMilliseconds() / frameCount;
+
+    printf("%zu objects, %zu frames\n", objectCount, frameCount);
+    printf("inline Transform (before):          %.2f ms per frame\n", inlineTransforms);
+    printf("Transform through ArchetypeState:   %.2f ms per frame\n", transforms);
+    printf("packed TransformState:              %.2f ms per frame\n", packedTransforms);
+    printf("inline MeshRenderer bounds:         %.2f ms per frame\n", inlineRenderers);
+    printf("MeshRendererState through object:   %.2f ms per frame\n", renderers);
+    printf("packed MeshRendererState:           %.2f ms per frame\n", packedRenderers);
+    printf("speedup:                            %.1fx transforms, %.1fx renderers over inline (checksum %.0f)\n",
+        inlineTransforms / packedTransforms, inlineRenderers / packedRenderers, checksum);
+    return 0;
+}
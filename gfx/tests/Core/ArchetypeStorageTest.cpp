@@ -0,0 +1,244 @@
+#include "Testing.hpp"
+#include "Core/ArchetypeComponent.hpp"
+#include "Core/GameObject.hpp"
+#include <map>
+#include <random>
+
+using namespace GFX;
+
+struct Position { float x, y, z; };
+struct Velocity { double value; };
+struct Large { char data[3000]; };
+struct alignas(32) Aligned { float values[8]; };
+
+//What an entity should contain, next to the storage
+struct Expected
+{
+    EntityHandle entity;
+    bool hasPosition = false;
+    bool hasVelocity = false;
+    bool hasLarge = false;
+    bool hasAligned = false;
+    Position position;
+    Velocity velocity;
+    char large = 0;
+    float aligned = 0.0f;
+};
+
+static uint64_t GetKey(EntityHandle entity)
+{
+    return (static_cast<uint64_t>(entity.index) << 32) | entity.generation;
+}
+
+//Random creates, destroys, adds and removes, checked against a plain model of every entity
+static void TestRandomOperations()
+{
+    ArchetypeStorage storage;
+    std::mt19937 random(1);
+    std::map<uint64_t, Expected> alive;
+    std::vector<EntityHandle> destroyed;
+
+    for(uint32_t i = 0; i < 200000; i++)
+    {
+        uint32_t operation = random() % 10;
+
+        if(operation < 3 || alive.empty())
+        {
+            Expected expected;
+            expected.entity = storage.CreateEntity();
+            alive[GetKey(expected.entity)] = expected;
+            continue;
+        }
+
+        auto it = alive.begin();
+        std::advance(it, random() % alive.size());
+        Expected &expected = it->second;
+        EntityHandle entity = expected.entity;
+
+        switch(operation)
+        {
+            case 3:
+                storage.DestroyEntity(entity);
+                destroyed.push_back(entity);
+                alive.erase(it);
+                break;
+            case 4:
+                if(!expected.hasPosition)
+                {
+                    expected.position = { static_cast<float>(random() % 100), 1, 2 };
+                    GFX_CHECK(storage.AddComponent<Position>(entity, expected.position) != nullptr);
+                }
+                else
+                {
+                    GFX_CHECK(storage.RemoveComponent<Position>(entity));
+                }
+                expected.hasPosition = !expected.hasPosition;
+                break;
+            case 5:
+                if(!expected.hasVelocity)
+                {
+                    expected.velocity = { static_cast<double>(random() % 100) };
+                    storage.AddComponent<Velocity>(entity, expected.velocity);
+                }
+                else
+                {
+                    storage.RemoveComponent<Velocity>(entity);
+                }
+                expected.hasVelocity = !expected.hasVelocity;
+                break;
+            case 6:
+                if(!expected.hasLarge)
+                {
+                    Large large;
+                    expected.large = static_cast<char>(random());
+                    memset(large.data, expected.large, sizeof(large.data));
+                    storage.AddComponent<Large>(entity, large);
+                }
+                else
+                {
+                    storage.RemoveComponent<Large>(entity);
+                }
+                expected.hasLarge = !expected.hasLarge;
+                break;
+            case 7:
+                if(!expected.hasAligned)
+                {
+                    Aligned aligned;
+                    expected.aligned = static_cast<float>(random() % 7);
+                    for(float &value : aligned.values)
+                        value = expected.aligned;
+                    Aligned *result = storage.AddComponent<Aligned>(entity, aligned);
+                    GFX_CHECK((reinterpret_cast<uintptr_t>(result) & 31) == 0);
+                }
+                else
+                {
+                    storage.RemoveComponent<Aligned>(entity);
+                }
+                expected.hasAligned = !expected.hasAligned;
+                break;
+            default:
+                break;
+        }
+    }
+
+    GFX_CHECK(storage.GetEntityCount() == alive.size());
+
+    size_t positionCount = 0;
+
+    for(const auto &[key, expected] : alive)
+    {
+        EntityHandle entity = expected.entity;
+        GFX_CHECK(storage.IsAlive(entity));
+        GFX_CHECK(storage.HasComponent<Position>(entity) == expected.hasPosition);
+        GFX_CHECK(storage.HasComponent<Velocity>(entity) == expected.hasVelocity);
+        GFX_CHECK(storage.HasComponent<Large>(entity) == expected.hasLarge);
+        GFX_CHECK(storage.HasComponent<Aligned>(entity) == expected.hasAligned);
+
+        if(expected.hasPosition)
+            GFX_CHECK(storage.GetComponent<Position>(entity)->x == expected.position.x);
+        if(expected.hasVelocity)
+            GFX_CHECK(storage.GetComponent<Velocity>(entity)->value == expected.velocity.value);
+        if(expected.hasLarge)
+            GFX_CHECK(storage.GetComponent<Large>(entity)->data[2999] == expected.large);
+        if(expected.hasAligned)
+            GFX_CHECK(storage.GetComponent<Aligned>(entity)->values[7] == expected.aligned);
+
+        positionCount += expected.hasPosition ? 1 : 0;
+    }
+
+    //Stale handles never reach whatever reused their slot
+    for(EntityHandle entity : destroyed)
+        GFX_CHECK(!storage.IsAlive(entity) && storage.GetComponent<Position>(entity) == nullptr);
+
+    size_t visited = 0;
+    size_t mismatches = 0;
+
+    storage.ForEachChunk<Position>([&] (uint32_t count, const EntityHandle *entities, Position *positions) {
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(alive.at(GetKey(entities[i])).position.x != positions[i].x)
+                mismatches++;
+        }
+        visited += count;
+    });
+
+    GFX_CHECK(visited == positionCount && mismatches == 0);
+    printf("random operations: %zu entities alive in %zu archetypes\n", alive.size(), storage.GetArchetypeCount());
+}
+
+static void TestCreateWithValues()
+{
+    ArchetypeStorage storage;
+    EntityHandle entity = storage.CreateEntity(Position{ 1, 2, 3 }, Velocity{ 4 });
+
+    GFX_CHECK(storage.GetArchetypeCount() == 1);
+    GFX_CHECK(storage.GetComponent<Position>(entity)->z == 3);
+    GFX_CHECK(storage.GetComponent<Velocity>(entity)->value == 4);
+}
+
+//Transform keeps its data in the default storage, the owner column leads back to it
+static void TestTransformState()
+{
+    ArchetypeStorage &storage = ArchetypeStorage::GetDefault();
+    size_t entityCount = storage.GetEntityCount();
+    EntityHandle entity;
+
+    {
+        GameObject parent;
+        GameObject child;
+        child.GetTransform()->SetParent(parent.GetTransform());
+        parent.GetTransform()->SetPosition(Vector3(1, 2, 3));
+        child.GetTransform()->SetLocalPosition(Vector3(0, 1, 0));
+
+        entity = child.GetTransform()->GetEntity();
+        GFX_CHECK(storage.GetEntityCount() == entityCount + 2);
+        GFX_CHECK(storage.GetComponent<TransformState>(entity)->localPosition == Vector3(0, 1, 0));
+        GFX_CHECK(child.GetTransform()->GetPosition() == Vector3(1, 3, 3));
+
+        //Moving the parent marks the packed state of the child
+        parent.GetTransform()->SetPosition(Vector3(0, 0, 0));
+        GFX_CHECK(storage.GetComponent<TransformState>(entity)->isDirty);
+        GFX_CHECK(child.GetTransform()->GetPosition() == Vector3(0, 1, 0));
+
+        size_t owners = 0;
+        storage.ForEach<ArchetypeOwner, TransformState>([&] (ArchetypeOwner &owner, TransformState &) {
+            if(owner.component == parent.GetTransform() || owner.component == child.GetTransform())
+                owners++;
+        });
+        GFX_CHECK(owners == 2);
+
+        child.GetTransform()->SetParent(nullptr);
+    }
+
+    GFX_CHECK(!storage.IsAlive(entity));
+    GFX_CHECK(storage.GetEntityCount() == entityCount);
+}
+
+static void TestArchetypeComponent()
+{
+    ArchetypeStorage storage;
+    GameObject object;
+    ArchetypeComponent *component = object.AddComponent<ArchetypeComponent>(&storage);
+
+    GFX_CHECK(component->Add<Position>(Position{ 1, 2, 3 }) != nullptr);
+    GFX_CHECK(object.GetComponent<ArchetypeComponent>()->Get<Position>()->z == 3);
+    GFX_CHECK(component->Get<ArchetypeOwner>()->component == component);
+
+    size_t count = 0;
+    storage.ForEach<ArchetypeOwner, Position>([&] (ArchetypeOwner &owner, Position &) {
+        count += owner.component == component ? 1 : 100;
+    });
+    GFX_CHECK(count == 1);
+
+    ArchetypeComponent *shared = object.AddComponent<ArchetypeComponent>();
+    GFX_CHECK(shared->GetStorage() == &ArchetypeStorage::GetDefault());
+}
+
+int main()
+{
+    TestRandomOperations();
+    TestCreateWithValues();
+    TestTransformState();
+    TestArchetypeComponent();
+    return Testing::GetResult();
+}
@@ -0,0 +1,84 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+#include <memory>
+#include <string>
+
+using namespace GFX;
+
+struct ComponentA : Component {};
+struct ComponentB : Component {};
+struct ComponentC : Component {};
+struct ComponentD : Component {};
+struct Base : Component {};
+struct Derived : Base {};
+struct Target : Component {};
+
+//The scan GetComponent did before components had a type id
+template <typename T>
+static T *FindWithDynamicCast(const std::vector<Component*> &components)
+{
+    for(Component *component : components)
+    {
+        if(T *result = dynamic_cast<T*>(component))
+            return result;
+    }
+    return nullptr;
+}
+
+//Two lookups per object on objects with six components, one exact match at the back and one through inheritance
+int main(int argc, char **argv)
+{
+    const size_t objectCount = 4000;
+    const size_t iterationCount = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    std::vector<std::unique_ptr<GameObject>> objects;
+    std::vector<std::vector<Component*>> components;
+
+    for(size_t i = 0; i < objectCount; i++)
+    {
+        auto object = std::make_unique<GameObject>();
+        components.push_back({
+            object->AddComponent<ComponentA>(),
+            object->AddComponent<ComponentB>(),
+            object->AddComponent<ComponentC>(),
+            object->AddComponent<ComponentD>(),
+            object->AddComponent<Derived>(),
+            object->AddComponent<Target>()
+        });
+        objects.push_back(std::move(object));
+    }
+
+    uintptr_t checksum = 0;
+    Stopwatch stopwatch;
+
+    for(size_t iteration = 0; iteration < iterationCount; iteration++)
+    {
+        for(const auto &list : components)
+        {
+            checksum += reinterpret_cast<uintptr_t>(FindWithDynamicCast<Target>(list));
+            checksum += reinterpret_cast<uintptr_t>(FindWithDynamicCast<Base>(list));
+        }
+    }
+
+    const double dynamicCast = stopwatch.GetElapsedMilliseconds();
+    stopwatch.Restart();
+
+    for(size_t iteration = 0; iteration < iterationCount; iteration++)
+    {
+        for(const auto &object : objects)
+        {
+            checksum -= reinterpret_cast<uintptr_t>(object->GetComponent<Target>());
+            checksum -= reinterpret_cast<uintptr_t>(object->GetComponent<Base>());
+        }
+    }
+
+    const double typeId = stopwatch.GetElapsedMilliseconds();
+
+    printf("%zu objects, %zu iterations\n", objectCount, iterationCount);
+    printf("dynamic_cast: %.2f ms\n", dynamicCast);
+    printf("type id:      %.2f ms\n", typeId);
+    printf("speedup:      %.1fx\n", dynamicCast / typeId);
+
+    //Both paths found the same components
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+
+using namespace GFX;
+
+struct First : Component {};
+struct Second : Component {};
+struct Base : Component {};
+struct Derived : Base {};
+struct MoreDerived : Derived {};
+struct Missing : Component {};
+
+//Lookups by type id have to return the same component the old dynamic_cast scan did, which is the first match
+static void TestGetComponent()
+{
+    GameObject object;
+    First *first = object.AddComponent<First>();
+    Derived *derived = object.AddComponent<Derived>();
+    Base *base = object.AddComponent<Base>();
+    Second *second = object.AddComponent<Second>();
+    MoreDerived *moreDerived = object.AddComponent<MoreDerived>();
+
+    GFX_CHECK(object.GetComponent<First>() == first);
+    GFX_CHECK(object.GetComponent<Second>() == second);
+    GFX_CHECK(object.GetComponent<Derived>() == derived);
+    GFX_CHECK(object.GetComponent<MoreDerived>() == moreDerived);
+    GFX_CHECK(object.GetComponent<Missing>() == nullptr);
+
+    //A subclass in front of the exact type wins
+    GFX_CHECK(object.GetComponent<Base>() == derived);
+    GFX_CHECK(object.GetComponent<Component>() == first);
+
+    auto bases = object.GetComponentsOfType<Base>();
+    GFX_CHECK(bases.size() == 3 && bases[0] == derived && bases[1] == base && bases[2] == moreDerived);
+    GFX_CHECK(object.GetComponentsOfType<Missing>().empty());
+}
+
+static void TestChildren()
+{
+    GameObject parent;
+    GameObject child;
+    GameObject grandchild;
+    child.GetTransform()->SetParent(parent.GetTransform());
+    grandchild.GetTransform()->SetParent(child.GetTransform());
+
+    Derived *derived = parent.AddComponent<Derived>();
+    Base *base = child.AddComponent<Base>();
+    MoreDerived *moreDerived = grandchild.AddComponent<MoreDerived>();
+
+    auto bases = parent.GetComponentsOfTypeInChildren<Base>();
+    GFX_CHECK(bases.size() == 3 && bases[0] == derived && bases[1] == base && bases[2] == moreDerived);
+
+    size_t count = 0;
+    parent.ForEachComponentOfTypeInChildren<Derived>([&count] (Derived *) { count++; });
+    GFX_CHECK(count == 2);
+
+    child.GetTransform()->SetParent(nullptr);
+    grandchild.GetTransform()->SetParent(nullptr);
+}
+
+int main()
+{
+    TestGetComponent();
+    TestChildren();
+    return Testing::GetResult();
+}
@@ -0,0 +1,60 @@
+#include "Testing.hpp"
+#include "Core/Debug.hpp"
+#include <string>
+
+using namespace GFX;
+
+static std::string lastMessage;
+static size_t messageCount = 0;
+
+static void OnMessage(const std::string &message, ConsoleMessageType type)
+{
+    lastMessage = message;
+    messageCount++;
+}
+
+//Logging happens before the first frame and in tools that never step frames, it must not grow the FrameArena
+static void TestLoggingWithoutFrames()
+{
+    const std::string large(Debug::FORMAT_STACK_BUFFER_SIZE * 2, 'x');
+    const size_t capacity = FrameArena::GetCapacity();
+
+    for(int i = 0; i < 100; i++)
+    {
+        Debug::WriteLog("[TEST] message %d", i);
+        Debug::WriteError("[TEST] %s %d", large.c_str(), i);
+    }
+
+    printf("frame arena capacity %zu before, %zu after\n", capacity, FrameArena::GetCapacity());
+    GFX_CHECK(FrameArena::GetCapacity() == capacity);
+}
+
+//Messages that fit on the stack and those that don't must come out the same
+static void TestMessageText()
+{
+    Debug::WriteLog("[TEST] %s %d", "short", 42);
+    GFX_CHECK(lastMessage == "[TEST] short 42");
+
+    const std::string exact(Debug::FORMAT_STACK_BUFFER_SIZE - 1, 'a');
+    Debug::WriteLog("%s", exact.c_str());
+    GFX_CHECK(lastMessage == exact);
+
+    const std::string large(Debug::FORMAT_STACK_BUFFER_SIZE, 'b');
+    Debug::WriteError("%s!", large.c_str());
+    GFX_CHECK(lastMessage == large + "!");
+}
+
+int main()
+{
+    if(!Debug::IsLoggingEnabled())
+    {
+        printf("logging is disabled, skipping\n");
+        return 0;
+    }
+
+    Debug::SetCallback(OnMessage);
+    TestLoggingWithoutFrames();
+    TestMessageText();
+    GFX_CHECK(messageCount == 203);
+    return Testing::GetResult();
+}
@@ -0,0 +1,192 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+#include <cmath>
+
+using namespace GFX;
+
+struct Score : Component
+{
+    double total = 0.0;
+    uint32_t frames = 0;
+};
+
+//Independent instances, split across threads
+struct Mover : GameBehaviour
+{
+    double x = 0.0;
+    double speed = 0.0;
+protected:
+    BehaviourAccess GetAccess() const override
+    {
+        return BehaviourAccess::Parallel().Write<Mover>();
+    }
+
+    void OnUpdate() override
+    {
+        for(uint32_t i = 0; i < 200; i++)
+            x = std::fmod(x * 1.0001 + speed + std::sin(x), 1000.0);
+    }
+};
+
+struct Spinner : GameBehaviour
+{
+    double angle = 1.0;
+protected:
+    BehaviourAccess GetAccess() const override
+    {
+        return BehaviourAccess::Parallel();
+    }
+
+    void OnUpdate() override
+    {
+        for(uint32_t i = 0; i < 100; i++)
+            angle = std::cos(angle) + 0.5 * angle;
+    }
+};
+
+//Reads every Mover, so it has to run after them
+struct Summer : GameBehaviour
+{
+    std::vector<Mover*> *movers = nullptr;
+    Score *score = nullptr;
+protected:
+    BehaviourAccess GetAccess() const override
+    {
+        return BehaviourAccess::Declared().Read<Mover>().Write<Score>();
+    }
+
+    void OnUpdate() override
+    {
+        for(Mover *mover : *movers)
+            score->total = score->total * 0.5 + mover->x;
+        score->frames++;
+    }
+};
+
+//Exclusive by default
+struct Logger : GameBehaviour
+{
+    Score *score = nullptr;
+    std::vector<double> *log = nullptr;
+protected:
+    void OnLateUpdate() override
+    {
+        log->push_back(score->total);
+    }
+};
+
+struct Spawner : GameBehaviour
+{
+    std::vector<GameObject*> *spawned = nullptr;
+protected:
+    void OnUpdate() override
+    {
+        if(spawned->empty())
+        {
+            GameObject *object = new GameObject();
+            object->AddComponent<Spinner>();
+            spawned->push_back(object);
+        }
+    }
+};
+
+//A scene with parallel, declared and exclusive behaviours, spawning and deleting objects halfway through
+static double RunScene(bool parallel, uint32_t workerCount)
+{
+    GameBehaviour::SetParallelUpdate(parallel);
+    JobSystem::Initialize(workerCount);
+
+    std::vector<double> log;
+    std::vector<GameObject*> objects;
+    std::vector<GameObject*> spawned;
+    std::vector<Mover*> movers;
+
+    GameObject *manager = new GameObject();
+    Score *score = manager->AddComponent<Score>();
+
+    for(uint32_t i = 0; i < 2000; i++)
+    {
+        GameObject *object = new GameObject();
+        Mover *mover = object->AddComponent<Mover>();
+        mover->x = i;
+        mover->speed = i * 0.001;
+
+        if(i % 3 == 0)
+            object->AddComponent<Spinner>();
+
+        objects.push_back(object);
+        movers.push_back(mover);
+    }
+
+    Summer *summer = manager->AddComponent<Summer>();
+    summer->movers = &movers;
+    summer->score = score;
+    Logger *logger = manager->AddComponent<Logger>();
+    logger->score = score;
+    logger->log = &log;
+    manager->AddComponent<Spawner>()->spawned = &spawned;
+
+    for(uint32_t frame = 0; frame < 30; frame++)
+    {
+        Testing::Update();
+
+        if(frame != 10)
+            continue;
+
+        std::vector<Mover*> remaining;
+
+        for(size_t i = 0; i < objects.size(); i++)
+        {
+            if(i % 7 == 0)
+            {
+                delete objects[i];
+                objects[i] = nullptr;
+            }
+            else
+            {
+                remaining.push_back(movers[i]);
+            }
+        }
+
+        movers.swap(remaining);
+    }
+
+    GFX_CHECK(score->frames == 30);
+    GFX_CHECK(log.size() == 30);
+
+    double result = score->total;
+    for(double value : log)
+        result = result * 1.000001 + value;
+    for(Mover *mover : movers)
+        result += mover->x;
+
+    for(GameObject *object : objects)
+        delete object;
+    for(GameObject *object : spawned)
+        delete object;
+    delete manager;
+
+    JobSystem::Deinitialize();
+    return result;
+}
+
+//The schedule may only change where behaviours run, never the result
+static void TestDeterminism()
+{
+    double serial = RunScene(false, 0);
+
+    for(uint32_t workerCount : { 0u, 2u, 7u })
+    {
+        double parallel = RunScene(true, workerCount);
+        printf("%u workers: %.17g, serial %.17g\n", workerCount, parallel, serial);
+        GFX_CHECK(parallel == serial);
+    }
+
+    GameBehaviour::SetParallelUpdate(false);
+}
+
+int main()
+{
+    TestDeterminism();
+    return Testing::GetResult();
+}
@@ -0,0 +1,81 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+#include <random>
+#include <string>
+
+using namespace GFX;
+
+struct Spin : Component
+{
+    float speed = 1;
+    float angle = 0;
+
+    void OnDestroy() override
+    {
+        angle = -1;
+    }
+};
+
+struct Payload : Component
+{
+    int32_t values[8] = {};
+};
+
+static GameObject *Spawn()
+{
+    GameObject *object = GameObject::Create();
+    object->AddComponent<Spin>();
+    object->AddComponent<Payload>();
+
+    GameObject *child = GameObject::Create();
+    child->AddComponent<Spin>();
+    child->GetTransform()->SetParent(object->GetTransform());
+    return object;
+}
+
+//40k live objects, every frame 4k random object and child pairs are destroyed and spawned again
+int main(int argc, char **argv)
+{
+    const size_t liveCount = 20000;
+    const size_t churnCount = 4000;
+    const size_t frameCount = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    std::mt19937 random(1);
+    std::vector<GameObjectHandle> live;
+
+    for(size_t i = 0; i < liveCount; i++)
+        live.push_back(Spawn()->GetHandle());
+
+    Stopwatch stopwatch;
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        Testing::NewFrame();
+
+        for(size_t i = 0; i < churnCount; i++)
+        {
+            size_t index = random() % live.size();
+            GameObject::Destroy(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        Testing::EndFrame();
+
+        for(size_t i = 0; i < churnCount; i++)
+            live.push_back(Spawn()->GetHandle());
+    }
+
+    double elapsed = stopwatch.GetElapsedMilliseconds();
+    size_t valid = 0;
+
+    for(const GameObjectHandle &handle : live)
+    {
+        if(GameObject::Get(handle))
+            valid++;
+    }
+
+    printf("%zu frames, %zu pairs destroyed and spawned per frame: %.3f ms/frame\n", frameCount, churnCount, elapsed / frameCount);
+
+    return valid == live.size() ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+
+using namespace GFX;
+
+static uint32_t destroyCount = 0;
+
+struct Counted : Component
+{
+    void OnDestroy() override
+    {
+        destroyCount++;
+    }
+};
+
+//Larger than the biggest slab size class
+struct Large : Component
+{
+    char data[5000];
+
+    void OnDestroy() override
+    {
+        destroyCount++;
+    }
+};
+
+//Queues its own object and another one while the batch is being released
+struct Requeue : Component
+{
+    GameObject *other = nullptr;
+
+    void OnDestroy() override
+    {
+        destroyCount++;
+        GameObject::Destroy(GetGameObject());
+        GameObject::Destroy(other);
+    }
+};
+
+static void TestHierarchy()
+{
+    destroyCount = 0;
+
+    GameObject *a = GameObject::Create();
+    GameObject *b = GameObject::Create();
+    GameObject *c = GameObject::Create();
+    GameObject *keep = GameObject::Create();
+    a->AddComponent<Counted>();
+    a->AddComponent<Large>();
+    b->AddComponent<Counted>();
+    c->AddComponent<Counted>();
+    b->GetTransform()->SetParent(a->GetTransform());
+    c->GetTransform()->SetParent(b->GetTransform());
+    a->GetTransform()->SetParent(keep->GetTransform());
+
+    //Not made with Create, it is cut loose but neither destroyed nor released
+    GameObject stackObject;
+    stackObject.AddComponent<Counted>();
+    stackObject.GetTransform()->SetParent(b->GetTransform());
+
+    GameObjectHandle handleA = a->GetHandle();
+    GameObjectHandle handleC = c->GetHandle();
+    GameObjectHandle handleKeep = keep->GetHandle();
+    GFX_CHECK(GameObject::Get(handleA) == a && GameObject::Get(handleC) == c);
+
+    //A child next to its parent and the same object more than once are released once
+    GameObject::Destroy(c);
+    GameObject::Destroy(a);
+    GameObject::Destroy(a);
+    GameObject::Destroy(handleA);
+    Testing::EndFrame();
+
+    GFX_CHECK(destroyCount == 4);
+    GFX_CHECK(GameObject::Get(handleA) == nullptr && GameObject::Get(handleC) == nullptr);
+    GFX_CHECK(GameObject::Get(handleKeep) == keep);
+    GFX_CHECK(keep->GetTransform()->GetChildren().size() == 0);
+    GFX_CHECK(stackObject.GetTransform()->GetParent() == nullptr);
+    GFX_CHECK(stackObject.GetComponent<Counted>() != nullptr);
+
+    //Destroying it directly is refused, its owner releases it
+    GameObject::Destroy(&stackObject);
+    Testing::EndFrame();
+    GFX_CHECK(destroyCount == 4);
+
+    //Stale handles stay invalid when the slot is used again
+    GameObject *d = GameObject::Create();
+    GFX_CHECK(d->GetHandle() != handleA && d->GetHandle() != handleC);
+    GFX_CHECK(GameObject::Get(handleA) == nullptr);
+
+    GameObject::Destroy(d);
+    GameObject::Destroy(keep);
+    Testing::EndFrame();
+    GFX_CHECK(GameObject::Get(handleKeep) == nullptr);
+}
+
+static void TestRequeue()
+{
+    destroyCount = 0;
+
+    GameObject *a = GameObject::Create();
+    GameObject *b = GameObject::Create();
+    a->AddComponent<Requeue>()->other = b;
+    b->AddComponent<Counted>();
+    GameObject::Destroy(a);
+    GameObject::Destroy(b);
+    Testing::EndFrame();
+    GFX_CHECK(destroyCount == 2);
+
+    //New objects may get the memory and the slots of the released ones, the requeued handles must not release them
+    GameObject *c = GameObject::Create();
+    GameObject *d = GameObject::Create();
+    GameObjectHandle handleC = c->GetHandle();
+    GameObjectHandle handleD = d->GetHandle();
+    Testing::EndFrame();
+
+    GFX_CHECK(destroyCount == 2);
+    GFX_CHECK(GameObject::Get(handleC) == c && GameObject::Get(handleD) == d);
+
+    GameObject::Destroy(c);
+    GameObject::Destroy(d);
+    Testing::EndFrame();
+    GFX_CHECK(GameObject::Get(handleC) == nullptr && GameObject::Get(handleD) == nullptr);
+}
+
+int main()
+{
+    TestHierarchy();
+    TestRequeue();
+    return Testing::GetResult();
+}
@@ -0,0 +1,83 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+#include <string>
+
+using namespace GFX;
+
+//Finds objects by name among 4000 objects and a child by name among 64 children, with the text and with an interned id
+int main(int argc, char **argv)
+{
+    const size_t objectCount = 4000;
+    const size_t queryCount = argc > 1 ? std::stoul(argv[1]) : 20000;
+
+    std::vector<std::string> names;
+    std::vector<StringId> ids;
+    std::vector<GameObject*> objects;
+
+    for(size_t i = 0; i < objectCount; i++)
+    {
+        names.push_back("Enemy_" + std::to_string(i));
+        ids.push_back(StringId(names.back()));
+        objects.push_back(GameObject::Create());
+        objects.back()->SetName(names.back());
+    }
+
+    GameObject *root = GameObject::Create();
+
+    for(size_t i = 0; i < 64; i++)
+    {
+        GameObject *child = GameObject::Create();
+        child->SetName("Bone_" + std::to_string(i));
+        child->GetTransform()->SetParent(root->GetTransform());
+    }
+
+    size_t hits = 0;
+    const size_t scanCount = queryCount / 100;
+    Stopwatch stopwatch;
+
+    //What Find did before names were interned
+    for(size_t i = 0; i < scanCount; i++)
+    {
+        const std::string &name = names[(i * 7919) % objectCount];
+
+        for(GameObject *object : objects)
+        {
+            if(object->GetName() == name)
+            {
+                hits++;
+                break;
+            }
+        }
+    }
+
+    double scanTime = stopwatch.GetElapsedMilliseconds() / scanCount;
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < queryCount; i++)
+        hits += GameObject::Find(names[(i * 7919) % objectCount]) != nullptr;
+    double findStringTime = stopwatch.GetElapsedMilliseconds() / queryCount;
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < queryCount; i++)
+        hits += GameObject::Find(ids[(i * 7919) % objectCount]) != nullptr;
+    double findIdTime = stopwatch.GetElapsedMilliseconds() / queryCount;
+
+    const std::string bone = "Bone_63";
+    const StringId boneId(bone);
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < queryCount; i++)
+        hits += root->GetTransform()->FindChild(bone) != nullptr;
+    double childStringTime = stopwatch.GetElapsedMilliseconds() / queryCount;
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < queryCount; i++)
+        hits += root->GetTransform()->FindChild(boneId) != nullptr;
+    double childIdTime = stopwatch.GetElapsedMilliseconds() / queryCount;
+
+    printf("name scan: %.1f ns\n", scanTime * 1e6);
+    printf("Find(string): %.1f ns, Find(StringId): %.1f ns, speedup over the scan: %.1fx\n", findStringTime * 1e6, findIdTime * 1e6, scanTime / findStringTime);
+    printf("FindChild(string): %.1f ns, FindChild(StringId): %.1f ns\n", childStringTime * 1e6, childIdTime * 1e6);
+
+    return hits == scanCount + queryCount * 4 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include "Testing.hpp"
+#include "Core/GameObject.hpp"
+
+using namespace GFX;
+
+static void TestStringId()
+{
+    StringId a("Player", 6);
+    StringId b(std::string("Player"));
+    GFX_CHECK(a == b && a.GetString() == "Player");
+    GFX_CHECK(StringId().IsEmpty() && StringId(std::string()).IsEmpty());
+
+    //Text that was never interned is not added by a lookup
+    size_t count = StringId::GetCount();
+    StringId value;
+    GFX_CHECK(!StringId::TryGet("NeverInterned", value) && value.IsEmpty());
+    GFX_CHECK(StringId::GetCount() == count);
+    GFX_CHECK(StringId::TryGet("Player", value) && value == a);
+}
+
+static void TestFind()
+{
+    GameObject *a = GameObject::Create();
+    GameObject *b = GameObject::Create();
+    a->SetName("Enemy");
+    b->SetName("Enemy");
+    b->SetTag("Boss");
+
+    GFX_CHECK(GameObject::Find("Enemy") != nullptr);
+    GFX_CHECK(GameObject::FindWithTag("Boss") == b);
+    GFX_CHECK(GameObject::Find("Unknown") == nullptr);
+
+    //Renamed objects move to their new name
+    a->SetName("Renamed");
+    GFX_CHECK(GameObject::Find("Enemy") == b);
+    GFX_CHECK(GameObject::Find(StringId(std::string("Renamed"))) == a);
+
+    //Destroyed objects are not found, also before the end of the frame
+    GameObject::Destroy(b);
+    Testing::EndFrame();
+    GFX_CHECK(GameObject::Find("Enemy") == nullptr);
+    GFX_CHECK(GameObject::FindWithTag("Boss") == nullptr);
+
+    GameObject *parent = GameObject::Create();
+    GameObject *child = GameObject::Create();
+    child->SetName("Bone");
+    child->GetTransform()->SetParent(parent->GetTransform());
+    GFX_CHECK(parent->GetTransform()->FindChild("Bone") == child->GetTransform());
+    GFX_CHECK(parent->GetTransform()->FindChild(StringId(std::string("Bone"))) == child->GetTransform());
+
+    GameObject::Destroy(a);
+    GameObject::Destroy(parent);
+    Testing::EndFrame();
+}
+
+int main()
+{
+    TestStringId();
+    TestFind();
+    return Testing::GetResult();
+}
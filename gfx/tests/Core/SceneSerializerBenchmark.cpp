@@ -0,0 +1,64 @@
+#include "Testing.hpp"
+#include "Core/SceneSerializer.hpp"
+#include <string>
+
+using namespace GFX;
+
+struct Health : Component
+{
+    float value = 100;
+};
+
+//Roots with nine children each, every object with a transform and a small component
+int main(int argc, char **argv)
+{
+    const size_t rootCount = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const size_t childCount = 9;
+
+    SceneSerializer::RegisterComponent<Health>("Health", [] (const Health *health, SceneWriter &writer) {
+        writer.Write(health->value);
+        return true;
+    }, [] (Health *health, SceneReader &reader) {
+        reader.Read(health->value);
+    });
+
+    Stopwatch stopwatch;
+    std::vector<GameObject*> roots;
+
+    for(size_t i = 0; i < rootCount; i++)
+    {
+        GameObject *root = GameObject::Create();
+        root->SetName("root" + std::to_string(i));
+        root->GetTransform()->SetLocalPosition(Vector3(i, 0, 0));
+        root->AddComponent<Health>()->value = static_cast<float>(i);
+
+        for(size_t j = 0; j < childCount; j++)
+        {
+            GameObject *child = GameObject::Create();
+            child->SetName("child");
+            child->GetTransform()->SetParent(root->GetTransform());
+            child->GetTransform()->SetLocalRotation(Quaternionf::Euler(0.1f * j, 0.2f, 0.3f));
+            child->AddComponent<Health>();
+        }
+
+        roots.push_back(root);
+    }
+
+    double createTime = stopwatch.GetElapsedMilliseconds();
+    std::vector<uint8_t> data;
+
+    stopwatch.Restart();
+    SceneSerializer::Write(roots, data);
+    double writeTime = stopwatch.GetElapsedMilliseconds();
+
+    std::vector<GameObject*> objects;
+
+    stopwatch.Restart();
+    bool result = SceneSerializer::Read(data.data(), data.size(), objects);
+    double readTime = stopwatch.GetElapsedMilliseconds();
+
+    printf("objects: %zu, bytes: %zu\n", objects.size(), data.size());
+    printf("create: %.1f ms, write: %.1f ms, load: %.1f ms\n", createTime, writeTime, readTime);
+
+    return result ? 0 : 1;
+}
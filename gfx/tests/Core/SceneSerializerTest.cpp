@@ -0,0 +1,224 @@
+#include "Testing.hpp"
+#include "Core/SceneSerializer.hpp"
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+using namespace GFX;
+
+struct Health : Component
+{
+    float value = 100;
+    int32_t armor = 0;
+};
+
+struct Spin : Component
+{
+    float speed = 0;
+};
+
+//Has no serializer, so it is skipped when saving
+struct Unsaved : Component
+{
+    int32_t value = 5;
+};
+
+struct HealthData
+{
+    float value;
+    int32_t armor;
+};
+
+static void RegisterComponents()
+{
+    SceneSerializer::RegisterComponent<Health>("Health", [] (const Health *health, SceneWriter &writer) {
+        HealthData data = { health->value, health->armor };
+        writer.Write(data);
+        return true;
+    }, [] (Health *health, SceneReader &reader) {
+        HealthData data;
+        if(reader.Read(data))
+        {
+            health->value = data.value;
+            health->armor = data.armor;
+        }
+    });
+
+    SceneSerializer::RegisterComponent<Spin>("Spin", [] (const Spin *spin, SceneWriter &writer) {
+        writer.Write(spin->speed);
+        return true;
+    }, [] (Spin *spin, SceneReader &reader) {
+        reader.Read(spin->speed);
+    });
+}
+
+//Every root has its children, the second child has a child of its own
+static std::vector<GameObject*> CreateScene(size_t rootCount, size_t childCount)
+{
+    std::vector<GameObject*> roots;
+
+    for(size_t i = 0; i < rootCount; i++)
+    {
+        GameObject *root = GameObject::Create();
+        root->SetName("root" + std::to_string(i));
+        root->GetTransform()->SetLocalPosition(Vector3(i, i * 2.0f, -1.0f * i));
+        root->AddComponent<Health>()->armor = static_cast<int32_t>(i);
+
+        if(i % 3 == 0)
+            root->AddComponent<Unsaved>();
+
+        for(size_t j = 0; j < childCount; j++)
+        {
+            GameObject *child = GameObject::Create();
+            child->SetName("child");
+            child->GetTransform()->SetParent(root->GetTransform());
+            child->GetTransform()->SetLocalRotation(Quaternionf::Euler(0.1f * j, 0.2f, 0.3f));
+            child->GetTransform()->SetScale(Vector3(1, 2, 3));
+            child->SetLayer(Layer_IgnoreRaycast, false);
+            child->AddComponent<Spin>()->speed = j * 0.5f;
+
+            if(j == 1)
+            {
+                GameObject *grandChild = GameObject::Create();
+                grandChild->GetTransform()->SetParent(child->GetTransform());
+                grandChild->AddComponent<Health>()->value = 3;
+            }
+        }
+
+        if(i == 1)
+        {
+            root->SetIsActive(false);
+            root->GetTransform()->GetChild(0)->GetGameObject()->SetIsActive(true);
+        }
+
+        roots.push_back(root);
+    }
+
+    return roots;
+}
+
+static std::vector<GameObject*> GetRoots(const std::vector<GameObject*> &objects)
+{
+    std::vector<GameObject*> roots;
+
+    for(GameObject *object : objects)
+    {
+        if(!object->GetTransform()->GetParent())
+            roots.push_back(object);
+    }
+
+    return roots;
+}
+
+static void DestroyRoots(const std::vector<GameObject*> &objects)
+{
+    for(GameObject *root : GetRoots(objects))
+        GameObject::Destroy(root);
+}
+
+static void TestRoundTrip()
+{
+    std::vector<GameObject*> roots = CreateScene(5, 4);
+    std::vector<uint8_t> data;
+    SceneSerializer::Write(roots, data);
+
+    std::vector<GameObject*> objects;
+    GFX_CHECK(SceneSerializer::Read(data.data(), data.size(), objects));
+    GFX_CHECK(objects.size() == 5 * (1 + 4 + 1));
+
+    std::vector<GameObject*> loadedRoots = GetRoots(objects);
+
+    if(!GFX_CHECK(loadedRoots.size() == 5))
+        return;
+
+    //Saving what was loaded gives the same bytes
+    std::vector<uint8_t> resaved;
+    SceneSerializer::Write(loadedRoots, resaved);
+    GFX_CHECK(data == resaved);
+
+    GFX_CHECK(!loadedRoots[1]->GetIsActive());
+    GFX_CHECK(loadedRoots[1]->GetTransform()->GetChild(0)->GetGameObject()->GetIsActive());
+    GFX_CHECK(!loadedRoots[1]->GetTransform()->GetChild(1)->GetGameObject()->GetIsActive());
+    GFX_CHECK(loadedRoots[2]->GetName() == "root2");
+    GFX_CHECK(loadedRoots[2]->GetTransform()->GetChild(3)->GetGameObject()->GetComponent<Spin>()->speed == 1.5f);
+    GFX_CHECK(loadedRoots[2]->GetTransform()->GetChild(1)->GetGameObject()->GetLayer() == Layer_IgnoreRaycast);
+    GFX_CHECK(loadedRoots[3]->GetComponent<Health>()->armor == 3);
+    GFX_CHECK(loadedRoots[3]->GetComponent<Unsaved>() == nullptr);
+    GFX_CHECK(roots[4]->GetTransform()->GetChild(2)->GetRotation() == loadedRoots[4]->GetTransform()->GetChild(2)->GetRotation());
+
+    //The data doesn't have to be aligned
+    std::vector<uint8_t> shifted(data.size() + 1);
+    memcpy(shifted.data() + 1, data.data(), data.size());
+    std::vector<GameObject*> shiftedObjects;
+    GFX_CHECK(SceneSerializer::Read(shifted.data() + 1, data.size(), shiftedObjects));
+    GFX_CHECK(shiftedObjects.size() == objects.size());
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gfx_scene_serializer_test";
+    std::filesystem::create_directories(directory);
+    std::string filepath = (directory / "test.gfxscene").string();
+
+    std::vector<GameObject*> fileObjects;
+    GFX_CHECK(SceneSerializer::Save(filepath, roots));
+    GFX_CHECK(SceneSerializer::Load(filepath, fileObjects));
+    GFX_CHECK(fileObjects.size() == objects.size());
+    std::filesystem::remove_all(directory);
+
+    std::vector<uint8_t> empty;
+    std::vector<GameObject*> emptyObjects;
+    SceneSerializer::Write({}, empty);
+    GFX_CHECK(SceneSerializer::Read(empty.data(), empty.size(), emptyObjects));
+    GFX_CHECK(emptyObjects.empty());
+
+    DestroyRoots(roots);
+    DestroyRoots(objects);
+    DestroyRoots(shiftedObjects);
+    DestroyRoots(fileObjects);
+}
+
+static void TestDamagedData()
+{
+    std::vector<GameObject*> roots = CreateScene(5, 4);
+    std::vector<uint8_t> data;
+    SceneSerializer::Write(roots, data);
+    DestroyRoots(roots);
+
+    //A file cut off while it was written is rejected without leaving objects behind
+    for(size_t size = 0; size < data.size(); size += 7)
+    {
+        std::vector<GameObject*> objects;
+        GFX_CHECK(!SceneSerializer::Read(data.data(), size, objects));
+        GFX_CHECK(objects.empty());
+    }
+
+    //Flipped bits may go unnoticed in the payload, but must never read out of bounds
+    std::mt19937 random(1);
+    uint32_t rejected = 0;
+
+    for(uint32_t i = 0; i < 3000; i++)
+    {
+        std::vector<uint8_t> corrupted = data;
+
+        for(uint32_t j = 0; j < 4; j++)
+            corrupted[random() % corrupted.size()] ^= static_cast<uint8_t>(1u << (random() % 8));
+
+        std::vector<GameObject*> objects;
+
+        if(!SceneSerializer::Read(corrupted.data(), corrupted.size(), objects))
+        {
+            GFX_CHECK(objects.empty());
+            rejected++;
+        }
+
+        DestroyRoots(objects);
+    }
+
+    printf("corrupted scenes rejected: %u of 3000\n", rejected);
+}
+
+int main()
+{
+    RegisterComponents();
+    TestRoundTrip();
+    TestDamagedData();
+    return Testing::GetResult();
+}
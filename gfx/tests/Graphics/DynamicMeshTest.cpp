@@ -0,0 +1,243 @@
+#include "Testing.hpp"
+#include "Graphics/Mesh.hpp"
+#include "External/glad/glad.h"
+#include <cstring>
+#include <map>
+#include <random>
+
+using namespace GFX;
+
+//Buffer objects are emulated in memory through the glad function pointers, so uploads can be compared without a context
+namespace GLStub
+{
+    static std::map<GLuint,std::vector<uint8_t>> buffers;
+    static std::map<GLuint,GLuint> elementBuffers; //Per vertex array, like the real binding
+    static GLuint arrayBuffer = 0;
+    static GLuint vertexArray = 0;
+    static GLuint nextId = 1;
+    static uint32_t bufferDataCount = 0;
+    static size_t bufferSubDataBytes = 0;
+    static bool outOfRange = false;
+
+    static std::vector<uint8_t> &GetBuffer(GLenum target)
+    {
+        return buffers[target == GL_ARRAY_BUFFER ? arrayBuffer : elementBuffers[vertexArray]];
+    }
+
+    static void APIENTRY Generate(GLsizei count, GLuint *ids)
+    {
+        for(GLsizei i = 0; i < count; i++)
+            ids[i] = nextId++;
+    }
+
+    static void APIENTRY Delete(GLsizei, const GLuint *)
+    {
+    }
+
+    static void APIENTRY BindVertexArray(GLuint id)
+    {
+        vertexArray = id;
+    }
+
+    static void APIENTRY BindBuffer(GLenum target, GLuint id)
+    {
+        if(target == GL_ARRAY_BUFFER)
+            arrayBuffer = id;
+        else
+            elementBuffers[vertexArray] = id;
+    }
+
+    static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum)
+    {
+        std::vector<uint8_t> &buffer = GetBuffer(target);
+        buffer.assign(size, 0xCD);
+        if(data)
+            memcpy(buffer.data(), data, size);
+        bufferDataCount++;
+    }
+
+    static void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+    {
+        std::vector<uint8_t> &buffer = GetBuffer(target);
+
+        if(offset + size > static_cast<GLintptr>(buffer.size()))
+        {
+            outOfRange = true;
+            return;
+        }
+
+        memcpy(buffer.data() + offset, data, size);
+        bufferSubDataBytes += size;
+    }
+
+    static void APIENTRY EnableVertexAttribArray(GLuint)
+    {
+    }
+
+    static void APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *)
+    {
+    }
+
+    static void Install()
+    {
+        glad_glGenVertexArrays = Generate;
+        glad_glGenBuffers = Generate;
+        glad_glDeleteBuffers = Delete;
+        glad_glDeleteVertexArrays = Delete;
+        glad_glBindVertexArray = BindVertexArray;
+        glad_glBindBuffer = BindBuffer;
+        glad_glBufferData = BufferData;
+        glad_glBufferSubData = BufferSubData;
+        glad_glEnableVertexAttribArray = EnableVertexAttribArray;
+        glad_glVertexAttribPointer = VertexAttribPointer;
+    }
+}
+
+//A partially updated mesh has to end up exactly like one that is generated from scratch
+static void CheckSameAsGenerated(Mesh &mesh)
+{
+    Mesh reference(mesh.GetVertices(), mesh.GetIndices(), false);
+    reference.SetVertexLayout(mesh.GetVertexLayout());
+    reference.RecalculateNormals();
+    reference.Generate();
+
+    auto &vertices = mesh.GetVertices();
+    auto &referenceVertices = reference.GetVertices();
+    GFX_CHECK(vertices.size() == referenceVertices.size() && memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(Vertex)) == 0);
+
+    BoundingBox bounds = mesh.GetBounds();
+    BoundingBox referenceBounds = reference.GetBounds();
+    GFX_CHECK(bounds.GetMin() == referenceBounds.GetMin() && bounds.GetMax() == referenceBounds.GetMax());
+
+    //Buffers may be larger than needed, the used part must match
+    auto &vertexBuffer = GLStub::buffers[mesh.GetVBO()->GetId()];
+    auto &referenceVertexBuffer = GLStub::buffers[reference.GetVBO()->GetId()];
+    GFX_CHECK(vertexBuffer.size() >= referenceVertexBuffer.size() && memcmp(vertexBuffer.data(), referenceVertexBuffer.data(), referenceVertexBuffer.size()) == 0);
+
+    auto &indexBuffer = GLStub::buffers[mesh.GetEBO()->GetId()];
+    auto &referenceIndexBuffer = GLStub::buffers[reference.GetEBO()->GetId()];
+    GFX_CHECK(mesh.GetIndexType() == reference.GetIndexType());
+    GFX_CHECK(indexBuffer.size() >= referenceIndexBuffer.size() && memcmp(indexBuffer.data(), referenceIndexBuffer.data(), referenceIndexBuffer.size()) == 0);
+
+    GFX_CHECK(!GLStub::outOfRange);
+}
+
+//Brush strokes on a terrain, each one touching a small square of vertices
+static void TestTerrainBrush(const VertexLayout &layout)
+{
+    const uint32_t size = 257;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> heightDistribution(-3.0f, 3.0f);
+
+    Mesh terrain = MeshGenerator::CreateTerrain(size - 1, size - 1, Vector3(1, 1, 1));
+    terrain.SetDynamic(true);
+    terrain.SetVertexLayout(layout);
+    terrain.Generate();
+
+    uint32_t fullUploads = 0;
+    size_t vertexSize = layout.IsDefault() ? sizeof(Vertex) : layout.GetStride();
+    size_t vertexBufferSize = terrain.GetVerticesCount() * vertexSize;
+
+    for(uint32_t stroke = 0; stroke < 50; stroke++)
+    {
+        int32_t centerX = random() % size;
+        int32_t centerY = random() % size;
+        int32_t radius = 1 + random() % 6;
+        float height = heightDistribution(random);
+
+        //Compact positions are relative to the bounds, only every tenth stroke is allowed to move them
+        if(!layout.IsDefault() && stroke % 10 != 0)
+            height = (random() % 2) ? 0.01f : -0.01f;
+
+        for(int32_t y = centerY - radius; y <= centerY + radius; y++)
+        {
+            for(int32_t x = centerX - radius; x <= centerX + radius; x++)
+            {
+                if(x < 0 || y < 0 || x >= static_cast<int32_t>(size) || y >= static_cast<int32_t>(size))
+                    continue;
+
+                size_t index = y * size + x;
+                terrain.GetVertices()[index].position.y += height;
+                terrain.MarkVerticesDirty(index, 1);
+            }
+        }
+
+        uint32_t bufferDataCount = GLStub::bufferDataCount;
+        GLStub::bufferSubDataBytes = 0;
+        terrain.Update(true);
+
+        //The buffers are sized for the terrain once, strokes never allocate them again
+        GFX_CHECK(GLStub::bufferDataCount == bufferDataCount);
+
+        if(GLStub::bufferSubDataBytes >= vertexBufferSize)
+            fullUploads++;
+        else
+            GFX_CHECK(GLStub::bufferSubDataBytes < vertexBufferSize / 10);
+    }
+
+    printf("terrain brush, stride %zu: %u of 50 strokes uploaded everything\n", vertexSize, fullUploads);
+    GFX_CHECK(fullUploads <= (layout.IsDefault() ? 0u : 5u));
+    CheckSameAsGenerated(terrain);
+}
+
+static void TestResize()
+{
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> heightDistribution(-3.0f, 3.0f);
+
+    Mesh mesh = MeshGenerator::CreateTerrain(64, 64, Vector3(1, 1, 1));
+    mesh.SetDynamic(true);
+    mesh.Generate();
+
+    //The content hash is cached until the data is marked as changed
+    uint64_t contentHash = mesh.GetContentHash();
+    GFX_CHECK(mesh.GetContentHash() == contentHash);
+
+    //Flipped triangles change the normals of every vertex they touch
+    for(auto &vertex : mesh.GetVertices())
+        vertex.position.y = heightDistribution(random);
+
+    mesh.MarkVerticesDirty(0, mesh.GetVerticesCount());
+    GFX_CHECK(mesh.GetContentHash() != contentHash);
+    contentHash = mesh.GetContentHash();
+
+    auto &indices = mesh.GetIndices();
+    for(size_t i = 300; i < 600; i += 3)
+        std::swap(indices[i + 1], indices[i + 2]);
+    mesh.MarkIndicesDirty(300, 300);
+
+    mesh.Update(true);
+    CheckSameAsGenerated(mesh);
+
+    //Appending within the capacity of the buffers, like a growing spline
+    uint32_t bufferDataCount = GLStub::bufferDataCount;
+    mesh.GetVertices().resize(mesh.GetVerticesCount() + 100, mesh.GetVertices().back());
+
+    for(uint32_t i = 0; i < 30; i++)
+        mesh.GetIndices().insert(mesh.GetIndices().end(), { i, i + 1, i + 65 });
+
+    mesh.Update(true);
+    GFX_CHECK(GLStub::bufferDataCount == bufferDataCount);
+    GFX_CHECK(mesh.GetContentHash() != contentHash);
+    CheckSameAsGenerated(mesh);
+
+    mesh.GetIndices().resize(mesh.GetIndicesCount() - 90);
+    mesh.GetVertices().resize(mesh.GetVerticesCount() - 100);
+    mesh.Update(true);
+    CheckSameAsGenerated(mesh);
+
+    //Beyond the capacity the buffers are allocated again
+    mesh.GetVertices().resize(mesh.GetVerticesCount() * 3, mesh.GetVertices()[0]);
+    mesh.Update(true);
+    GFX_CHECK(GLStub::bufferDataCount > bufferDataCount);
+    CheckSameAsGenerated(mesh);
+}
+
+int main()
+{
+    GLStub::Install();
+    TestTerrainBrush(VertexLayout());
+    TestTerrainBrush(VertexLayout::Compact());
+    TestResize();
+    return Testing::GetResult();
+}
@@ -0,0 +1,180 @@
+#include "Testing.hpp"
+#include "Graphics/GlyphAtlas.hpp"
+#include <cstring>
+#include <random>
+
+using namespace GFX;
+
+static void TestPacker()
+{
+    const uint32_t size = 256;
+    SkylinePacker packer(size, size);
+    std::vector<uint8_t> occupied(size * size, 0);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<uint32_t> distribution(4, 24);
+    uint64_t packedArea = 0;
+    uint32_t failures = 0;
+
+    //Glyph sized rectangles until the packer gives up a number of times in a row
+    while(failures < 32)
+    {
+        uint32_t width = distribution(random);
+        uint32_t height = distribution(random);
+        uint32_t x = 0;
+        uint32_t y = 0;
+
+        if(!packer.Pack(width, height, x, y))
+        {
+            failures++;
+            continue;
+        }
+
+        failures = 0;
+        packedArea += width * height;
+
+        if(!GFX_CHECK(x + width <= size && y + height <= size))
+            return;
+
+        for(uint32_t row = y; row < y + height; row++)
+        {
+            for(uint32_t column = x; column < x + width; column++)
+            {
+                GFX_CHECK(occupied[row * size + column] == 0);
+                occupied[row * size + column] = 1;
+            }
+        }
+    }
+
+    GFX_CHECK(packer.GetUsedArea() == packedArea);
+
+    //Skyline packing of mixed sizes should still fill most of the page
+    GFX_CHECK(packedArea > size * size * 3 / 4);
+
+    uint32_t x = 0;
+    uint32_t y = 0;
+    GFX_CHECK(!packer.Pack(size + 1, 1, x, y));
+    GFX_CHECK(!packer.Pack(0, 1, x, y));
+
+    packer.Reset(size, size);
+    GFX_CHECK(packer.GetUsedArea() == 0);
+    GFX_CHECK(packer.Pack(size, size, x, y) && x == 0 && y == 0);
+}
+
+static Glyph CreateMetrics(uint32_t width, uint32_t height)
+{
+    Glyph glyph = {};
+    glyph.sizeX = static_cast<int32_t>(width);
+    glyph.sizeY = static_cast<int32_t>(height);
+    glyph.advanceX = static_cast<int32_t>(width) + 1;
+    return glyph;
+}
+
+static void TestInsert()
+{
+    GlyphAtlas atlas;
+    atlas.Initialize(64, 64, 2, 1);
+
+    const uint32_t glyphSize = 15;
+    std::vector<uint8_t> bitmap(glyphSize * glyphSize);
+
+    for(size_t i = 0; i < bitmap.size(); i++)
+        bitmap[i] = static_cast<uint8_t>(i + 1);
+
+    //Codepoints below 256 use the direct lookup, the others go through the map
+    const uint32_t codepoints[] = { 'A', 0xE9, 0x4E2D, 0x1F600 };
+
+    for(uint32_t codepoint : codepoints)
+    {
+        Glyph *glyph = atlas.Insert(codepoint, CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 1);
+
+        if(!GFX_CHECK(glyph != nullptr))
+            return;
+
+        GFX_CHECK(atlas.Contains(codepoint));
+        GFX_CHECK(atlas.Find(codepoint, 1) == glyph);
+        GFX_CHECK(glyph->advanceX == static_cast<int32_t>(glyphSize) + 1);
+        GFX_CHECK(glyph->page == 0);
+
+        //The bitmap has to end up where the texture coordinates point
+        GlyphAtlasPage *page = atlas.GetPage(glyph->page);
+        uint32_t x = static_cast<uint32_t>(glyph->u0 * atlas.GetPageWidth() + 0.5f);
+        uint32_t y = static_cast<uint32_t>(glyph->v0 * atlas.GetPageHeight() + 0.5f);
+        GFX_CHECK(static_cast<uint32_t>((glyph->u1 - glyph->u0) * atlas.GetPageWidth() + 0.5f) == glyphSize);
+
+        for(uint32_t row = 0; row < glyphSize; row++)
+            GFX_CHECK(memcmp(&page->pixels[(y + row) * atlas.GetPageWidth() + x], &bitmap[row * glyphSize], glyphSize) == 0);
+
+        GFX_CHECK(page->dirtyRect.x <= x && page->dirtyRect.x + page->dirtyRect.width >= x + glyphSize);
+    }
+
+    //Inserting again returns the cached glyph
+    GFX_CHECK(atlas.Insert('A', CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 1) == atlas.Find('A', 1));
+    GFX_CHECK(atlas.GetGlyphCount() == 4);
+
+    //Empty glyphs keep their metrics but take no atlas space
+    Glyph *space = atlas.Insert(' ', CreateMetrics(0, 0), nullptr, 0, 0, 1);
+    GFX_CHECK(space != nullptr && space->page == UINT32_MAX && space->advanceX == 1);
+    GFX_CHECK(atlas.GetPage(0)->glyphCount == 4);
+
+    //Larger than a page
+    GFX_CHECK(atlas.Insert('B', CreateMetrics(65, 10), bitmap.data(), 65, 10, 1) == nullptr);
+}
+
+static void TestEviction()
+{
+    GlyphAtlas atlas;
+    atlas.Initialize(64, 64, 2, 1);
+
+    //15 pixels plus padding fill a page with exactly 16 glyphs
+    const uint32_t glyphSize = 15;
+    const uint32_t glyphsPerPage = 16;
+    std::vector<uint8_t> bitmap(glyphSize * glyphSize, 255);
+
+    for(uint32_t i = 0; i < glyphsPerPage * 2; i++)
+    {
+        Glyph *glyph = atlas.Insert(0x1000 + i, CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 1 + i / glyphsPerPage);
+        if(!GFX_CHECK(glyph != nullptr))
+            return;
+        GFX_CHECK(glyph->page == i / glyphsPerPage);
+    }
+
+    GFX_CHECK(atlas.GetPageCount() == 2);
+    GFX_CHECK(atlas.GetEvictionCount() == 0);
+
+    //Both pages were used in frame 3, nothing may be evicted while that frame is drawn
+    atlas.Find(0x1000, 3);
+    atlas.Find(0x1000 + glyphsPerPage, 3);
+    GFX_CHECK(atlas.Insert(0x2000, CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 3) == nullptr);
+
+    //Only the second page is used in frame 4, so the first one is the least recently used
+    atlas.Find(0x1000 + glyphsPerPage, 4);
+    Glyph *glyph = atlas.Insert(0x2000, CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 4);
+
+    if(!GFX_CHECK(glyph != nullptr))
+        return;
+
+    GFX_CHECK(glyph->page == 0);
+    GFX_CHECK(atlas.GetEvictionCount() == 1);
+    GFX_CHECK(atlas.GetPageCount() == 2);
+    GFX_CHECK(atlas.GetGlyphCount() == glyphsPerPage + 1);
+    GFX_CHECK(atlas.GetPage(0)->glyphCount == 1);
+    GFX_CHECK(atlas.GetPage(0)->dirtyRect.width == atlas.GetPageWidth());
+
+    for(uint32_t i = 0; i < glyphsPerPage; i++)
+    {
+        GFX_CHECK(!atlas.Contains(0x1000 + i));
+        GFX_CHECK(atlas.Contains(0x1000 + glyphsPerPage + i));
+    }
+
+    //An evicted glyph is rasterized again on demand
+    GFX_CHECK(atlas.Find(0x1000, 5) == nullptr);
+    GFX_CHECK(atlas.Insert(0x1000, CreateMetrics(glyphSize, glyphSize), bitmap.data(), glyphSize, glyphSize, 5) != nullptr);
+}
+
+int main()
+{
+    TestPacker();
+    TestInsert();
+    TestEviction();
+    return Testing::GetResult();
+}
@@ -0,0 +1,126 @@
+#include "Testing.hpp"
+#include "Graphics/Graphics2D.hpp"
+
+using namespace GFX;
+
+static const uint32_t DEFAULT_SHADER = 1;
+static const uint32_t CUSTOM_SHADER = 2;
+
+//Quads are appended like Graphics2D::AddVertices does, so indices of consecutive items are contiguous
+static void AddQuad(std::vector<DrawListItem> &items, uint32_t shaderId, uint32_t textureId, const Rectangle &clippingRect = Rectangle(0, 0, 0, 0), void *userData = nullptr)
+{
+    DrawListItem item;
+    item.shaderId = shaderId;
+    item.textureId = textureId;
+    item.vertexOffset = static_cast<uint32_t>(items.size() * 4);
+    item.vertexCount = 4;
+    item.indiceOffset = static_cast<uint32_t>(items.size() * 6);
+    item.indiceCount = 6;
+    item.textureSlot = UINT32_MAX;
+    item.textureIsFont = false;
+    item.fontHasSDF = false;
+    item.clippingRect = clippingRect;
+    item.userData = userData;
+    items.push_back(item);
+}
+
+static void TestSameTexture()
+{
+    std::vector<DrawListItem> items;
+    std::vector<DrawBatch> batches;
+
+    for(uint32_t i = 0; i < 300; i++)
+        AddQuad(items, DEFAULT_SHADER, 10);
+
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 8, batches) == 1);
+    GFX_CHECK(batches[0].itemCount == 300);
+    GFX_CHECK(batches[0].indiceOffset == 0);
+    GFX_CHECK(batches[0].indiceCount == 300 * 6);
+    GFX_CHECK(batches[0].textureCount == 1);
+}
+
+static void TestTextureSlots()
+{
+    std::vector<DrawListItem> items;
+    std::vector<DrawBatch> batches;
+
+    //Text and images interleaved, as a HUD with labels next to icons would submit them
+    for(uint32_t i = 0; i < 10; i++)
+    {
+        AddQuad(items, DEFAULT_SHADER, 100 + i);
+        AddQuad(items, DEFAULT_SHADER, 1);
+        items.back().textureIsFont = true;
+    }
+
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 8, batches) == 2);
+    GFX_CHECK(batches[0].textureCount == 8);
+    GFX_CHECK(batches[0].itemCount + batches[1].itemCount == items.size());
+    GFX_CHECK(batches[0].textureIsFont);
+
+    //Every item has to point at the slot its texture was bound to
+    for(size_t i = 0; i < batches.size(); i++)
+    {
+        const DrawBatch &batch = batches[i];
+        for(uint32_t j = batch.firstItem; j < batch.firstItem + batch.itemCount; j++)
+        {
+            GFX_CHECK(items[j].textureSlot < batch.textureCount);
+            GFX_CHECK(batch.textures[items[j].textureSlot] == items[j].textureId);
+        }
+    }
+
+    //With a single slot only equal textures merge
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 1, batches) == items.size());
+}
+
+static void TestStateChanges()
+{
+    std::vector<DrawListItem> items;
+    std::vector<DrawBatch> batches;
+
+    AddQuad(items, DEFAULT_SHADER, 10);
+    AddQuad(items, DEFAULT_SHADER, 10);
+    AddQuad(items, DEFAULT_SHADER, 10, Rectangle(0, 0, 100, 100));
+    AddQuad(items, DEFAULT_SHADER, 10, Rectangle(0, 0, 100, 100));
+    AddQuad(items, CUSTOM_SHADER, 10);
+    AddQuad(items, DEFAULT_SHADER, 10);
+
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 8, batches) == 4);
+
+    //A gap in the index buffer can not be covered by one draw
+    items[4].shaderId = DEFAULT_SHADER;
+    items[4].clippingRect = Rectangle(0, 0, 100, 100);
+    items[5].indiceOffset += 6;
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 8, batches) == 3);
+}
+
+static void TestCustomShader()
+{
+    std::vector<DrawListItem> items;
+    std::vector<DrawBatch> batches;
+    int userDataA = 0;
+    int userDataB = 0;
+
+    AddQuad(items, CUSTOM_SHADER, 10, Rectangle(0, 0, 0, 0), &userDataA);
+    AddQuad(items, CUSTOM_SHADER, 10, Rectangle(0, 0, 0, 0), &userDataA);
+    AddQuad(items, CUSTOM_SHADER, 11, Rectangle(0, 0, 0, 0), &userDataA);
+    AddQuad(items, CUSTOM_SHADER, 11, Rectangle(0, 0, 0, 0), &userDataB);
+    AddQuad(items, CUSTOM_SHADER, 11, Rectangle(0, 0, 0, 0), &userDataB);
+
+    GFX_CHECK(Graphics2D::BuildDrawBatches(items.data(), items.size(), DEFAULT_SHADER, 8, batches) == 3);
+    GFX_CHECK(batches[0].itemCount == 2);
+    GFX_CHECK(batches[1].itemCount == 1);
+    GFX_CHECK(batches[2].itemCount == 2);
+    GFX_CHECK(batches[2].userData == &userDataB);
+
+    for(size_t i = 0; i < items.size(); i++)
+        GFX_CHECK(items[i].textureSlot == 0);
+}
+
+int main()
+{
+    TestSameTexture();
+    TestTextureSlots();
+    TestStateChanges();
+    TestCustomShader();
+    return Testing::GetResult();
+}
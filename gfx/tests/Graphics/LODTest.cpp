@@ -0,0 +1,212 @@
+#include "Testing.hpp"
+#include "Graphics/MeshSimplifier.hpp"
+#include "Graphics/LODGroup.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_set>
+
+using namespace GFX;
+
+//Unit diameter sphere, the poles are fans and the seam at the first sector duplicates positions
+static void CreateSphere(uint32_t sectors, uint32_t stacks, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    const float pi = 3.14159265f;
+
+    for(uint32_t i = 0; i <= stacks; i++)
+    {
+        float stackAngle = pi / 2 - i * pi / stacks;
+        float xy = 0.5f * std::cos(stackAngle);
+        float z = 0.5f * std::sin(stackAngle);
+
+        for(uint32_t j = 0; j <= sectors; j++)
+        {
+            float sectorAngle = j * 2 * pi / sectors;
+            Vector3 position(xy * std::cos(sectorAngle), xy * std::sin(sectorAngle), z);
+            vertices.push_back(Vertex(position, glm::normalize(position), Vector2(static_cast<float>(j) / sectors, static_cast<float>(i) / stacks)));
+        }
+    }
+
+    for(uint32_t i = 0; i < stacks; i++)
+    {
+        uint32_t k1 = i * (sectors + 1);
+        uint32_t k2 = k1 + sectors + 1;
+
+        for(uint32_t j = 0; j < sectors; j++, k1++, k2++)
+        {
+            if(i != 0)
+                indices.insert(indices.end(), { k1, k2, k1 + 1 });
+            if(i != stacks - 1)
+                indices.insert(indices.end(), { k1 + 1, k2, k2 + 1 });
+        }
+    }
+}
+
+static void CreateTerrain(uint32_t size, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    for(uint32_t z = 0; z < size; z++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            Vector3 position(static_cast<float>(x), 2.0f * std::sin(x * 0.2f) * std::cos(z * 0.15f), static_cast<float>(z));
+            vertices.push_back(Vertex(position, Vector3(0, 1, 0), Vector2(0, 0)));
+        }
+    }
+
+    for(uint32_t z = 0; z < size - 1; z++)
+    {
+        for(uint32_t x = 0; x < size - 1; x++)
+        {
+            uint32_t a = z * size + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+}
+
+//Largest distance of a triangle center below the surface of the unit diameter sphere
+static double GetDeviation(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    double deviation = 0.0;
+
+    for(size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        Vector3 center = (vertices[indices[i]].position + vertices[indices[i + 1]].position + vertices[indices[i + 2]].position) / 3.0f;
+        deviation = std::max(deviation, static_cast<double>(0.5f - glm::length(center)));
+    }
+
+    return deviation;
+}
+
+static void TestSphere()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateSphere(72, 24, vertices, indices);
+
+    //Levels are simplified from the previous one within a shared error budget, like Mesh::GenerateLODs does
+    const float maxError = 0.05f;
+    std::vector<uint32_t> source = indices;
+    float totalError = 0.0f;
+    double baseDeviation = GetDeviation(vertices, indices);
+
+    for(uint32_t level = 0; level < 4; level++)
+    {
+        std::vector<uint32_t> result;
+        std::vector<uint32_t> repeated;
+        size_t targetIndexCount = source.size() / 2;
+        float error = MeshSimplifier::Simplify(vertices, source, targetIndexCount, maxError - totalError, result);
+        MeshSimplifier::Simplify(vertices, source, targetIndexCount, maxError - totalError, repeated);
+        totalError += error;
+
+        GFX_CHECK(result == repeated);
+        GFX_CHECK(result.size() % 3 == 0);
+        GFX_CHECK(result.size() <= source.size());
+        GFX_CHECK(totalError <= maxError + 0.0001f);
+
+        double deviation = GetDeviation(vertices, result);
+        uint32_t flipped = 0;
+
+        for(size_t i = 0; i + 2 < result.size(); i += 3)
+        {
+            const Vector3 &a = vertices[result[i + 0]].position;
+            const Vector3 &b = vertices[result[i + 1]].position;
+            const Vector3 &c = vertices[result[i + 2]].position;
+
+            if(glm::dot(glm::cross(b - a, c - a), a + b + c) < 0.0f)
+                flipped++;
+        }
+
+        printf("sphere level %u: %zu -> %zu triangles, error %.4f, deviation %.4f\n", level + 1, source.size() / 3, result.size() / 3, totalError, deviation);
+        //Triangles still face outwards and don't cut deep into the sphere, the error is a quadric estimate so it gets some slack
+        GFX_CHECK(flipped == 0);
+        GFX_CHECK(deviation <= baseDeviation + totalError * 1.5);
+
+        if(level == 0)
+            GFX_CHECK(result.size() <= targetIndexCount + 6);
+
+        if(result.size() > source.size() * 9 / 10)
+            break;
+
+        source = result;
+    }
+}
+
+static void TestTerrainBorder()
+{
+    const uint32_t size = 64;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateTerrain(size, vertices, indices);
+
+    std::vector<uint32_t> result;
+    float error = MeshSimplifier::Simplify(vertices, indices, indices.size() / 4, 0.05f, result);
+
+    GFX_CHECK(error <= 0.05f);
+    GFX_CHECK(result.size() <= indices.size() / 4 + 6);
+
+    //Open borders are kept, so neighbouring tiles still line up without cracks
+    std::unordered_set<uint32_t> used(result.begin(), result.end());
+
+    for(uint32_t i = 0; i < size; i++)
+    {
+        GFX_CHECK(used.contains(i));
+        GFX_CHECK(used.contains((size - 1) * size + i));
+        GFX_CHECK(used.contains(i * size));
+        GFX_CHECK(used.contains(i * size + size - 1));
+    }
+
+    //Nothing to do when the target is already met
+    std::vector<uint32_t> unchanged;
+    GFX_CHECK(MeshSimplifier::Simplify(vertices, indices, indices.size(), 0.05f, unchanged) == 0.0f);
+    GFX_CHECK(unchanged.size() == indices.size());
+}
+
+static void TestSelectLevel()
+{
+    LODGroup group;
+    group.screenSizes = { 0.25f, 0.12f, 0.06f };
+    group.hysteresis = 0.1f;
+
+    GFX_CHECK(group.SelectLevel(0.5f, 0, 4) == 0);
+    GFX_CHECK(group.SelectLevel(0.05f, 0, 4) == 3);
+    GFX_CHECK(group.SelectLevel(0.0f, 0, 4) == 3);
+    GFX_CHECK(group.SelectLevel(0.2f, 0, 4) == 1);
+
+    //Inside the hysteresis band the current level is kept in both directions
+    GFX_CHECK(group.SelectLevel(0.24f, 0, 4) == 0);
+    GFX_CHECK(group.SelectLevel(0.26f, 1, 4) == 1);
+    GFX_CHECK(group.SelectLevel(0.28f, 1, 4) == 0);
+
+    //Never a level the mesh doesn't have
+    GFX_CHECK(group.SelectLevel(0.0f, 0, 2) == 1);
+    GFX_CHECK(group.SelectLevel(0.0f, 5, 3) == 2);
+    GFX_CHECK(group.SelectLevel(0.0f, 0, 1) == 0);
+
+    group.enabled = false;
+    GFX_CHECK(group.SelectLevel(0.0f, 2, 4) == 0);
+}
+
+static void TestScreenCoverage()
+{
+    BoundingBox bounds(Vector3(-1, -1, -1), Vector3(1, 1, 1));
+
+    //The bounding sphere of a 2x2x2 box has a radius of sqrt(3)
+    float coverage = LODGroup::CalculateScreenCoverage(bounds, Vector3(0, 0, 10), 60.0f);
+    float expected = std::sqrt(3.0f) / (10.0f * std::tan(glm::radians(30.0f)));
+    GFX_CHECK(std::abs(coverage - expected) < 0.0001f);
+
+    GFX_CHECK(LODGroup::CalculateScreenCoverage(bounds, Vector3(0, 0, 1), 60.0f) == FLT_MAX);
+    GFX_CHECK(LODGroup::CalculateScreenCoverage(bounds, Vector3(0, 0, 20), 60.0f) < coverage);
+}
+
+int main()
+{
+    TestSphere();
+    TestTerrainBorder();
+    TestSelectLevel();
+    TestScreenCoverage();
+    return Testing::GetResult();
+}
@@ -0,0 +1,209 @@
+#include "Testing.hpp"
+#include "Graphics/MeshOptimizer.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+using namespace GFX;
+
+//A wavy grid with its triangles in random order, the worst case for the vertex cache
+static void CreateGrid(uint32_t size, uint32_t seed, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    vertices.clear();
+    indices.clear();
+
+    for(uint32_t z = 0; z < size; z++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            Vector3 position(static_cast<float>(x), std::sin(x * 0.3f) * std::cos(z * 0.2f), static_cast<float>(z));
+            Vector2 uv(x / static_cast<float>(size), z / static_cast<float>(size));
+            vertices.push_back(Vertex(position, Vector3(0, 1, 0), uv));
+        }
+    }
+
+    std::vector<std::array<uint32_t,3>> triangles;
+
+    for(uint32_t z = 0; z < size - 1; z++)
+    {
+        for(uint32_t x = 0; x < size - 1; x++)
+        {
+            uint32_t a = z * size + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size;
+            uint32_t d = c + 1;
+            triangles.push_back({ a, c, b });
+            triangles.push_back({ b, c, d });
+        }
+    }
+
+    std::mt19937 random(seed);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+
+    for(const auto &triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+//Triangles by position, rotated to a fixed first corner so the winding is part of the comparison
+static std::vector<std::array<float,9>> GetTriangles(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    std::vector<std::array<float,9>> triangles;
+
+    for(size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        std::array<float,9> rotations[3];
+
+        for(size_t r = 0; r < 3; r++)
+        {
+            for(size_t j = 0; j < 3; j++)
+            {
+                const Vector3 &position = vertices[indices[i + (r + j) % 3]].position;
+                rotations[r][j * 3 + 0] = position.x;
+                rotations[r][j * 3 + 1] = position.y;
+                rotations[r][j * 3 + 2] = position.z;
+            }
+        }
+
+        triangles.push_back(*std::min_element(rotations, rotations + 3));
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void TestVertexCache()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(64, 1, vertices, indices);
+
+    auto triangles = GetTriangles(vertices, indices);
+    VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+    MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+
+    VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+    printf("vertex cache: acmr %.3f -> %.3f, atvr %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+
+    GFX_CHECK(GetTriangles(vertices, indices) == triangles);
+    GFX_CHECK(before.acmr > 2.0f);
+    GFX_CHECK(after.acmr < 0.8f);
+    GFX_CHECK(after.atvr < 1.6f);
+}
+
+static void TestOverdraw()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(48, 2, vertices, indices);
+
+    MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+    auto triangles = GetTriangles(vertices, indices);
+    VertexCacheStatistics optimized = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+    //Clusters are reordered as a whole, the cache efficiency may only get a little worse
+    MeshOptimizer::OptimizeOverdraw(indices, vertices, 1.05f);
+    VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+    GFX_CHECK(GetTriangles(vertices, indices) == triangles);
+    GFX_CHECK(after.acmr <= optimized.acmr * 1.05f + 0.001f);
+}
+
+static void TestVertexFetch()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(64, 3, vertices, indices);
+
+    //Vertices in random order, as some exporters write them
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> shuffled(vertices.size());
+    for(uint32_t i = 0; i < remap.size(); i++)
+        remap[i] = i;
+    std::shuffle(remap.begin(), remap.end(), std::mt19937(4));
+    for(size_t i = 0; i < vertices.size(); i++)
+        shuffled[remap[i]] = vertices[i];
+    for(size_t i = 0; i < indices.size(); i++)
+        indices[i] = remap[indices[i]];
+    vertices = shuffled;
+
+    MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+    auto triangles = GetTriangles(vertices, indices);
+    VertexFetchStatistics before = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex));
+
+    MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+    VertexFetchStatistics after = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex));
+    printf("vertex fetch: overfetch %.3f -> %.3f\n", before.overfetch, after.overfetch);
+
+    GFX_CHECK(GetTriangles(vertices, indices) == triangles);
+    GFX_CHECK(after.overfetch < before.overfetch);
+    GFX_CHECK(after.overfetch < 1.6f);
+
+    //Vertices are stored in the order they are first used
+    uint32_t next = 0;
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        if(indices[i] == next)
+            next++;
+        GFX_CHECK(indices[i] < next);
+    }
+}
+
+static void TestWeldVertices()
+{
+    //Every triangle with its own vertices, like an unindexed export
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(16, 5, vertices, indices);
+
+    std::vector<Vertex> unindexed;
+    std::vector<uint32_t> sequential;
+
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        unindexed.push_back(vertices[indices[i]]);
+        sequential.push_back(static_cast<uint32_t>(i));
+    }
+
+    auto triangles = GetTriangles(unindexed, sequential);
+    size_t removed = MeshOptimizer::WeldVertices(unindexed, sequential);
+
+    GFX_CHECK(removed == indices.size() - vertices.size());
+    GFX_CHECK(unindexed.size() == vertices.size());
+    GFX_CHECK(GetTriangles(unindexed, sequential) == triangles);
+
+    //Vertices with a different normal or uv are a seam and must stay apart
+    std::vector<Vertex> seam = { vertices[0], vertices[0], vertices[1], vertices[0] };
+    std::vector<uint32_t> seamIndices = { 0, 1, 2, 3, 2, 1 };
+    seam[1].uv = Vector2(0.5f, 0.5f);
+    GFX_CHECK(MeshOptimizer::WeldVertices(seam, seamIndices) == 1);
+    GFX_CHECK(seam.size() == 3 && seamIndices[3] == 0 && seamIndices[5] == 1);
+}
+
+static void TestOptimize()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(32, 6, vertices, indices);
+    auto triangles = GetTriangles(vertices, indices);
+
+    MeshOptimizer::Optimize(vertices, indices, MeshOptimizeFlags_All);
+
+    GFX_CHECK(GetTriangles(vertices, indices) == triangles);
+    GFX_CHECK(MeshOptimizer::AnalyzeVertexCache(indices, vertices.size()).acmr < 0.9f);
+
+    GFX_CHECK(MeshOptimizer::CanUseShortIndices(65535));
+    GFX_CHECK(!MeshOptimizer::CanUseShortIndices(65537));
+}
+
+int main()
+{
+    TestVertexCache();
+    TestOverdraw();
+    TestVertexFetch();
+    TestWeldVertices();
+    TestOptimize();
+    return Testing::GetResult();
+}
@@ -0,0 +1,149 @@
+#include "Testing.hpp"
+#include "Graphics/ModelCache.hpp"
+#include <cstring>
+#include <filesystem>
+
+using namespace GFX;
+
+static CookedModel CreateModel()
+{
+    CookedModel model;
+    model.sourceHash = 0x1234;
+
+    CookedTexture external;
+    external.name = "Textures/diffuse.png";
+    external.isEmbedded = false;
+    model.textures.push_back(external);
+
+    CookedTexture embedded;
+    embedded.name = "*0";
+    embedded.isEmbedded = true;
+    embedded.data = { 1, 2, 3, 4, 5 };
+    model.textures.push_back(embedded);
+
+    CookedMesh mesh;
+    mesh.name = "material";
+    mesh.textureIndex = 1;
+    mesh.boundsMin = Vector3(-1, -1, -1);
+    mesh.boundsMax = Vector3(1, 1, 1);
+
+    for(int i = 0; i < 10; i++)
+        mesh.vertices.push_back(Vertex(Vector3(i, i * 2, i * 3), Vector3(0, 1, 0), Vector2(i, 0)));
+
+    mesh.indices = { 0, 1, 2, 2, 3, 4, 5, 6, 7 };
+
+    MeshLOD lod;
+    lod.indices = { 0, 1, 2 };
+    lod.indexOffset = 0;
+    lod.error = 0.01f;
+    mesh.lods.push_back(lod);
+    model.meshes.push_back(mesh);
+
+    CookedNode root;
+    root.name = "root";
+    root.parent = -1;
+    root.position = Vector3(1, 2, 3);
+    root.rotation = Quaternion(1, 0, 0, 0);
+    root.scale = Vector3(1, 1, 1);
+    root.meshes = { 0 };
+    model.nodes.push_back(root);
+
+    CookedNode child = root;
+    child.name = "child";
+    child.parent = 0;
+    model.nodes.push_back(child);
+
+    return model;
+}
+
+static void TestRoundTrip()
+{
+    CookedModel model = CreateModel();
+    std::vector<uint8_t> data;
+    ModelCache::Write(model, data);
+
+    CookedModel result;
+
+    if(!GFX_CHECK(ModelCache::Read(data.data(), data.size(), model.sourceHash, result)))
+        return;
+
+    GFX_CHECK(result.textures.size() == 2);
+    GFX_CHECK(result.textures[0].name == model.textures[0].name && !result.textures[0].isEmbedded);
+    GFX_CHECK(result.textures[1].data == model.textures[1].data && result.textures[1].isEmbedded);
+
+    const CookedMesh &mesh = result.meshes[0];
+    GFX_CHECK(mesh.name == "material" && mesh.textureIndex == 1);
+    GFX_CHECK(mesh.indices == model.meshes[0].indices);
+    GFX_CHECK(mesh.vertices.size() == 10 && memcmp(mesh.vertices.data(), model.meshes[0].vertices.data(), sizeof(Vertex) * 10) == 0);
+    GFX_CHECK(mesh.lods.size() == 1 && mesh.lods[0].indices == model.meshes[0].lods[0].indices && mesh.lods[0].error == 0.01f);
+
+    GFX_CHECK(result.nodes.size() == 2);
+    GFX_CHECK(result.nodes[0].position == Vector3(1, 2, 3) && result.nodes[0].meshes == model.nodes[0].meshes);
+    GFX_CHECK(result.nodes[1].name == "child" && result.nodes[1].parent == 0);
+
+    //A different hash means the source or the import settings changed
+    GFX_CHECK(!ModelCache::Read(data.data(), data.size(), model.sourceHash + 1, result));
+}
+
+static void TestDamagedData()
+{
+    CookedModel model = CreateModel();
+    std::vector<uint8_t> data;
+    ModelCache::Write(model, data);
+
+    //A cache cut off while it was written is rejected at every length
+    uint32_t truncatedAccepted = 0;
+
+    for(size_t size = 0; size < data.size(); size++)
+    {
+        CookedModel result;
+        std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+        if(ModelCache::Read(truncated.data(), truncated.size(), model.sourceHash, result))
+            truncatedAccepted++;
+    }
+
+    GFX_CHECK(truncatedAccepted == 0);
+
+    //Corrupted bytes may go unnoticed in the payload, but must never read out of bounds
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        std::vector<uint8_t> corrupted = data;
+        corrupted[i] ^= 0xFF;
+        CookedModel result;
+        ModelCache::Read(corrupted.data(), corrupted.size(), model.sourceHash, result);
+    }
+}
+
+static void TestFile()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gfx_model_cache_test";
+    std::filesystem::create_directories(directory);
+    std::string filepath = ModelCache::GetCachePath((directory / "model.obj").string());
+
+    CookedModel model = CreateModel();
+    CookedModel result;
+
+    GFX_CHECK(ModelCache::Save(filepath, model));
+    GFX_CHECK(ModelCache::Load(filepath, model.sourceHash, result));
+    GFX_CHECK(result.meshes.size() == 1 && result.meshes[0].indices == model.meshes[0].indices);
+
+    //Import settings are part of the hash
+    uint64_t hash = 0;
+    uint64_t flippedHash = 0;
+    uint64_t scaledHash = 0;
+    GFX_CHECK(ModelCache::CalculateSourceHash(filepath, 8, Vector3(1, 1, 1), false, hash));
+    ModelCache::CalculateSourceHash(filepath, 8, Vector3(1, 1, 1), true, flippedHash);
+    ModelCache::CalculateSourceHash(filepath, 8, Vector3(2, 2, 2), false, scaledHash);
+    GFX_CHECK(hash != flippedHash && hash != scaledHash);
+    GFX_CHECK(!ModelCache::CalculateSourceHash((directory / "missing.obj").string(), 8, Vector3(1, 1, 1), false, hash));
+
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestDamagedData();
+    TestFile();
+    return Testing::GetResult();
+}
@@ -0,0 +1,161 @@
+#include "Testing.hpp"
+#include "Graphics/ModelProcessor.hpp"
+#include "System/IO/File.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+using namespace GFX;
+
+//A wavy grid with shuffled triangles, so processing has some work to do
+static CookedMesh CreateMesh(uint32_t seed, uint32_t size)
+{
+    CookedMesh mesh;
+    mesh.name = "mesh" + std::to_string(seed);
+    mesh.textureIndex = -1;
+
+    for(uint32_t z = 0; z < size; z++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            Vector3 position(static_cast<float>(x), std::sin(x * 0.3f + seed) * std::cos(z * 0.2f), static_cast<float>(z));
+            mesh.vertices.push_back(Vertex(position, Vector3(0, 1, 0), Vector2(x / static_cast<float>(size), z / static_cast<float>(size))));
+        }
+    }
+
+    std::vector<uint32_t> triangles;
+
+    for(uint32_t z = 0; z < size - 1; z++)
+    {
+        for(uint32_t x = 0; x < size - 1; x++)
+        {
+            uint32_t a = z * size + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size;
+            uint32_t d = c + 1;
+            triangles.insert(triangles.end(), { a, c, b, b, c, d });
+        }
+    }
+
+    std::vector<size_t> order(triangles.size() / 3);
+    for(size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+    for(size_t i : order)
+        mesh.indices.insert(mesh.indices.end(), { triangles[i * 3], triangles[i * 3 + 1], triangles[i * 3 + 2] });
+
+    return mesh;
+}
+
+static bool IsEqual(const CookedMesh &a, const CookedMesh &b)
+{
+    if(a.indices != b.indices || a.vertices.size() != b.vertices.size())
+        return false;
+    if(memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) != 0)
+        return false;
+    if(a.boundsMin != b.boundsMin || a.boundsMax != b.boundsMax || a.lods.size() != b.lods.size())
+        return false;
+
+    for(size_t i = 0; i < a.lods.size(); i++)
+    {
+        if(a.lods[i].indices != b.lods[i].indices || a.lods[i].error != b.lods[i].error)
+            return false;
+    }
+
+    return true;
+}
+
+//Every item writes only to its own slot, so the worker count must not change the result
+static void TestProcessMeshes()
+{
+    std::vector<CookedMesh> meshes;
+
+    for(uint32_t i = 0; i < 12; i++)
+        meshes.push_back(CreateMesh(i, 24 + i * 3));
+
+    std::vector<CookedMesh> serial = meshes;
+    ModelProcessor::ProcessMeshes(serial, 1);
+
+    GFX_CHECK(serial[0].lods.size() > 0);
+    GFX_CHECK(serial[0].indices.size() == meshes[0].indices.size());
+
+    for(uint32_t workerCount : { 2u, 4u, 16u })
+    {
+        std::vector<CookedMesh> parallel = meshes;
+        ModelProcessor::ProcessMeshes(parallel, workerCount);
+
+        if(!GFX_CHECK(parallel.size() == serial.size()))
+            continue;
+
+        for(size_t i = 0; i < serial.size(); i++)
+            GFX_CHECK(IsEqual(serial[i], parallel[i]));
+    }
+}
+
+static void TestDecodeTextures()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gfx_model_processor_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    CookedModel model;
+
+    //Even ones are embedded, odd ones are next to the model
+    for(uint32_t i = 0; i < 6; i++)
+    {
+        std::vector<uint8_t> pixels(16 * 16 * 4);
+        for(size_t k = 0; k < pixels.size(); k++)
+            pixels[k] = static_cast<uint8_t>(k * 7 + i * 13);
+
+        CookedTexture texture;
+        texture.name = "texture" + std::to_string(i) + ".png";
+        texture.isEmbedded = (i % 2) == 0;
+
+        std::string filepath = (directory / texture.name).string();
+        Image::SaveAsPNG(filepath, pixels.data(), pixels.size(), 16, 16, 4);
+
+        if(texture.isEmbedded)
+            texture.data = File::ReadAllBytes(filepath);
+
+        model.textures.push_back(texture);
+    }
+
+    CookedTexture missing;
+    missing.name = "missing.png";
+    missing.isEmbedded = false;
+    model.textures.push_back(missing);
+
+    std::vector<ModelTextureData> serial;
+    std::vector<ModelTextureData> parallel;
+    ModelProcessor::DecodeTextures(model, directory.string(), false, serial, 1);
+    ModelProcessor::DecodeTextures(model, directory.string(), false, parallel, 8);
+
+    if(GFX_CHECK(serial.size() == 7 && parallel.size() == 7))
+    {
+        for(size_t i = 0; i < serial.size(); i++)
+        {
+            GFX_CHECK(serial[i].isLoaded == (i < 6));
+            GFX_CHECK(serial[i].isLoaded == parallel[i].isLoaded);
+            GFX_CHECK(serial[i].name == parallel[i].name);
+            GFX_CHECK(serial[i].compressed.levels.size() == parallel[i].compressed.levels.size());
+            GFX_CHECK(serial[i].compressed.levels.size() == (serial[i].isLoaded ? TextureCompressor::GetMipLevelCount(16, 16) : 0));
+
+            if(serial[i].compressed.levels.size() > 0 && serial[i].compressed.levels.size() == parallel[i].compressed.levels.size())
+                GFX_CHECK(serial[i].compressed.levels[0].data == parallel[i].compressed.levels[0].data);
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    JobSystem::Initialize(4);
+    TestProcessMeshes();
+    TestDecodeTextures();
+    JobSystem::Deinitialize();
+    return Testing::GetResult();
+}
@@ -0,0 +1,129 @@
+#include "Testing.hpp"
+#include "Graphics/CascadedShadowMapper.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace GFX;
+
+static const int shadowMapSize = 2048;
+static const float depthPadding = 100.0f;
+
+//Slice of a camera frustum between near and far, looking along yaw/pitch (radians) from position
+static glm::mat4 CreateSlice(const glm::vec3 &position, float yaw, float pitch, float near, float far)
+{
+    glm::vec3 forward(std::cos(pitch) * std::sin(yaw), std::sin(pitch), -std::cos(pitch) * std::cos(yaw));
+    glm::mat4 view = glm::lookAt(position, position + forward, glm::vec3(0, 1, 0));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, near, far);
+    return glm::inverse(projection * view);
+}
+
+static glm::vec3 Project(const glm::mat4 &lightMatrix, const glm::vec3 &point)
+{
+    glm::vec4 clip = lightMatrix * glm::vec4(point, 1.0f);
+    return glm::vec3(clip) / clip.w;
+}
+
+//Rotating the camera in place must not change the size of the projection, or shadow edges swim
+static void TestRadiusUnderRotation()
+{
+    const glm::vec3 lightDir(-0.3f, -1.0f, 0.4f);
+    const glm::vec3 position(12.5f, 3.0f, -7.25f);
+    float firstRadius = 0.0f;
+    float maxDifference = 0.0f;
+
+    for(int i = 0; i < 360; i++)
+    {
+        float yaw = glm::radians(static_cast<float>(i));
+        float pitch = glm::radians(30.0f * std::sin(i * 0.1f));
+        glm::vec3 center;
+        float radius = 0.0f;
+        CascadedShadowMapper::CalculateStableLightMatrix(CreateSlice(position, yaw, pitch, 5.0f, 40.0f), lightDir, shadowMapSize, depthPadding, center, radius);
+
+        if(i == 0)
+            firstRadius = radius;
+
+        maxDifference = std::max(maxDifference, std::abs(radius - firstRadius));
+    }
+
+    printf("radius %.4f, largest change under rotation %.6f\n", firstRadius, maxDifference);
+    GFX_CHECK(firstRadius > 0.0f);
+    GFX_CHECK(maxDifference == 0.0f);
+}
+
+//When the camera moves, the rasterized position of a fixed world point may only shift by whole texels
+static void TestTexelSnapping()
+{
+    const glm::vec3 lightDir(0.5f, -1.0f, -0.25f);
+    const glm::vec3 point(3.0f, 0.5f, -20.0f);
+    glm::vec2 firstTexel(0.0f);
+    float maxFraction = 0.0f;
+    float maxShift = 0.0f;
+
+    for(int i = 0; i < 200; i++)
+    {
+        //Sub-texel steps, so most frames don't cross a texel at all
+        glm::vec3 position(i * 0.0137f, 2.0f, -i * 0.0091f);
+        glm::vec3 center;
+        float radius = 0.0f;
+        glm::mat4 lightMatrix = CascadedShadowMapper::CalculateStableLightMatrix(CreateSlice(position, 0.3f, -0.1f, 1.0f, 30.0f), lightDir, shadowMapSize, depthPadding, center, radius);
+
+        glm::vec3 ndc = Project(lightMatrix, point);
+        glm::vec2 texel = (glm::vec2(ndc) * 0.5f + 0.5f) * static_cast<float>(shadowMapSize);
+
+        if(i == 0)
+            firstTexel = texel;
+
+        glm::vec2 shift = texel - firstTexel;
+        glm::vec2 fraction = glm::abs(shift - glm::round(shift));
+        maxFraction = std::max(maxFraction, std::max(fraction.x, fraction.y));
+        maxShift = std::max(maxShift, std::max(std::abs(shift.x), std::abs(shift.y)));
+    }
+
+    printf("largest shift %.3f texels, largest fraction of a texel %.5f\n", maxShift, maxFraction);
+    GFX_CHECK(maxShift >= 1.0f);
+    GFX_CHECK(maxFraction < 0.01f);
+}
+
+//Snapping moves the box, the whole slice must still be covered in x, y and depth
+static void TestSliceIsCovered()
+{
+    const glm::vec3 lightDirs[] = { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-0.3f, -1.0f, 0.4f), glm::vec3(1.0f, -0.2f, 0.0f) };
+    const float splits[] = { 0.1f, 8.0f, 25.0f, 70.0f, 200.0f };
+    float maxExtent = 0.0f;
+
+    for(const glm::vec3 &lightDir : lightDirs)
+    {
+        for(int i = 0; i < 100; i++)
+        {
+            glm::vec3 position(i * 0.731f, 1.5f + i * 0.05f, -i * 0.417f);
+            float yaw = i * 0.37f;
+            float pitch = glm::radians(-20.0f + (i % 40));
+
+            for(int s = 0; s < 4; s++)
+            {
+                glm::mat4 inverseViewProj = CreateSlice(position, yaw, pitch, splits[s], splits[s + 1]);
+                glm::vec3 center;
+                float radius = 0.0f;
+                glm::mat4 lightMatrix = CascadedShadowMapper::CalculateStableLightMatrix(inverseViewProj, lightDir, shadowMapSize, depthPadding, center, radius);
+
+                for(int c = 0; c < 8; c++)
+                {
+                    glm::vec4 corner = inverseViewProj * glm::vec4((c & 1) ? 1 : -1, (c & 2) ? 1 : -1, (c & 4) ? 1 : -1, 1.0f);
+                    glm::vec3 ndc = Project(lightMatrix, glm::vec3(corner) / corner.w);
+                    maxExtent = std::max(maxExtent, std::max(std::abs(ndc.x), std::max(std::abs(ndc.y), std::abs(ndc.z))));
+                }
+            }
+        }
+    }
+
+    printf("largest corner extent %.5f\n", maxExtent);
+    GFX_CHECK(maxExtent <= 1.0f);
+}
+
+int main()
+{
+    TestRadiusUnderRotation();
+    TestTexelSnapping();
+    TestSliceIsCovered();
+    return Testing::GetResult();
+}
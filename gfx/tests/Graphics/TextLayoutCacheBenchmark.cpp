@@ -0,0 +1,67 @@
+#include "Testing.hpp"
+#include "Graphics/TextLayoutCache.hpp"
+#include "Embedded/DejaVuSansMono.hpp"
+#include <string>
+
+using namespace GFX;
+
+//Measures the labels of a static HUD every frame, once like Graphics2D did before the cache and once through the cache
+int main(int argc, char **argv)
+{
+    const size_t labelCount = 5000;
+    const size_t frameCount = argc > 1 ? std::stoul(argv[1]) : 100;
+    const float fontSize = 16.0f;
+
+    Font font;
+
+    if(!font.LoadFromMemory(DejaVuSansMono::GetData(), DejaVuSansMono::GetSize(), 32, FontRenderMethod::Normal))
+    {
+        printf("Failed to load font\n");
+        return 1;
+    }
+
+    std::vector<std::string> labels(labelCount);
+
+    for(size_t i = 0; i < labelCount; i++)
+        labels[i] = "Label " + std::to_string(i) + ": {#FFAA00}value{#FFFFFF} " + std::to_string(i * 7);
+
+    double checksum = 0.0;
+    Stopwatch stopwatch;
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        for(size_t i = 0; i < labelCount; i++)
+        {
+            std::string text = labels[i];
+            size_t colorCount = 0;
+            Vector2 bounds;
+            Testing::ParseColorsFromText(text, colorCount);
+            font.CalculateBounds(text.c_str(), text.size(), fontSize, bounds.x, bounds.y);
+            checksum += bounds.x;
+        }
+    }
+
+    const double uncached = stopwatch.GetElapsedMilliseconds() / frameCount;
+    stopwatch.Restart();
+
+    for(size_t frame = 0; frame < frameCount; frame++)
+    {
+        Testing::NewTextFrame();
+
+        for(size_t i = 0; i < labelCount; i++)
+            checksum += TextLayoutCache::GetBounds(&font, labels[i], fontSize, true).x;
+    }
+
+    const double cached = stopwatch.GetElapsedMilliseconds() / frameCount;
+    const uint64_t hits = TextLayoutCache::GetNumHits();
+    const uint64_t misses = TextLayoutCache::GetNumMisses();
+    const size_t memorySize = TextLayoutCache::GetMemorySize();
+
+    printf("%zu labels, %zu frames\n", labelCount, frameCount);
+    printf("measured every frame: %.3f ms per frame\n", uncached);
+    printf("cached:               %.3f ms per frame (%.1f%% hits, %zu layouts, %.2f of %.2f MB)\n", cached, 100.0 * hits / (hits + misses), TextLayoutCache::GetCount(), memorySize / (1024.0 * 1024.0), TextLayoutCache::GetMaxMemorySize() / (1024.0 * 1024.0));
+    printf("speedup:              %.1fx (checksum %.0f)\n", uncached / cached, checksum);
+
+    font.Destroy();
+    return memorySize <= TextLayoutCache::GetMaxMemorySize() ? 0 : 1;
+}
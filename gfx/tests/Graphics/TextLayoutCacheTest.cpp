@@ -0,0 +1,65 @@
+#include "Testing.hpp"
+#include "Graphics/TextLayoutCache.hpp"
+#include "Embedded/DejaVuSansMono.hpp"
+#include "Embedded/JetBrainsMonoRegular.hpp"
+#include <cstring>
+
+using namespace GFX;
+
+static bool Load(Font &font, const uint8_t *data, size_t size)
+{
+    return font.LoadFromMemory(data, size, 32, FontRenderMethod::Normal);
+}
+
+int main()
+{
+    Font font;
+
+    if(!GFX_CHECK(Load(font, DejaVuSansMono::GetData(), DejaVuSansMono::GetSize())))
+        return Testing::GetResult();
+
+    const char *text = "Health 100";
+    const size_t length = strlen(text);
+
+    const TextLayout *layout = TextLayoutCache::GetLayout(&font, text, length, 16.0f, false);
+    GFX_CHECK(layout != nullptr);
+    GFX_CHECK(TextLayoutCache::GetNumMisses() == 1);
+    GFX_CHECK(layout->GetQuadCount() == 9);
+    GFX_CHECK(layout->bounds.x > 0.0f && layout->bounds.y > 0.0f);
+
+    GFX_CHECK(TextLayoutCache::GetLayout(&font, text, length, 16.0f, false) == layout);
+    GFX_CHECK(TextLayoutCache::GetNumHits() == 1);
+
+    //Copies share the glyph cache and with that the layouts
+    Font copy = font;
+    GFX_CHECK(copy.GetId() == font.GetId());
+    GFX_CHECK(TextLayoutCache::GetLayout(&copy, text, length, 16.0f, false) == layout);
+    GFX_CHECK(TextLayoutCache::GetNumHits() == 2);
+
+    //A different size is a different layout
+    TextLayoutCache::GetLayout(&font, text, length, 32.0f, false);
+    GFX_CHECK(TextLayoutCache::GetCount() == 2);
+    GFX_CHECK(TextLayoutCache::GetMemorySize() > 0);
+
+    //Destroying the font drops its layouts right away
+    const uint64_t firstId = font.GetId();
+    font.Destroy();
+    copy.Destroy();
+    GFX_CHECK(font.GetId() == 0);
+    GFX_CHECK(TextLayoutCache::GetCount() == 0);
+    GFX_CHECK(TextLayoutCache::GetMemorySize() == 0);
+    GFX_CHECK(TextLayoutCache::GetLayout(&font, text, length, 16.0f, false) == nullptr);
+
+    //A font loaded into the same object must not be served the layouts of the previous one
+    if(!GFX_CHECK(Load(font, JetBrainsMonoRegular::GetData(), JetBrainsMonoRegular::GetSize())))
+        return Testing::GetResult();
+
+    GFX_CHECK(font.GetId() != firstId);
+    const uint64_t misses = TextLayoutCache::GetNumMisses();
+    layout = TextLayoutCache::GetLayout(&font, text, length, 16.0f, false);
+    GFX_CHECK(layout != nullptr && layout->fontId == font.GetId());
+    GFX_CHECK(TextLayoutCache::GetNumMisses() == misses + 1);
+
+    font.Destroy();
+    return Testing::GetResult();
+}
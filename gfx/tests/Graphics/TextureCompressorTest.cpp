@@ -0,0 +1,202 @@
+#include "Testing.hpp"
+#include "Graphics/TextureCompressor.hpp"
+#include "Graphics/ModelProcessor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+using namespace GFX;
+
+struct CompressionError
+{
+    double rmse;
+    int maximum;
+};
+
+//Gradients with a little noise, the size is not a multiple of the block size on purpose
+static std::vector<uint8_t> CreateImage(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> pixels(width * height * 4);
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> noise(-4, 4);
+
+    for(uint32_t y = 0; y < height; y++)
+    {
+        for(uint32_t x = 0; x < width; x++)
+        {
+            uint8_t *pixel = &pixels[(y * width + x) * 4];
+            pixel[0] = static_cast<uint8_t>(std::clamp(static_cast<int>(x * 255 / width) + noise(random), 0, 255));
+            pixel[1] = static_cast<uint8_t>(std::clamp(static_cast<int>(y * 255 / height) + noise(random), 0, 255));
+            pixel[2] = static_cast<uint8_t>(128 + 100 * std::sin(x * 0.2f) * std::cos(y * 0.3f));
+            pixel[3] = static_cast<uint8_t>(255 - x * 3 % 256);
+        }
+    }
+
+    return pixels;
+}
+
+static CompressionError Measure(const std::vector<uint8_t> &source, const std::vector<uint8_t> &decoded, uint32_t channels)
+{
+    CompressionError error = { 0.0, 0 };
+    size_t pixelCount = source.size() / 4;
+
+    for(size_t i = 0; i < pixelCount; i++)
+    {
+        for(uint32_t c = 0; c < channels; c++)
+        {
+            int difference = std::abs(static_cast<int>(source[i * 4 + c]) - static_cast<int>(decoded[i * 4 + c]));
+            error.rmse += difference * difference;
+            error.maximum = std::max(error.maximum, difference);
+        }
+    }
+
+    error.rmse = std::sqrt(error.rmse / (pixelCount * channels));
+    return error;
+}
+
+static void TestRoundTrip()
+{
+    const uint32_t width = 37;
+    const uint32_t height = 19;
+    std::vector<uint8_t> pixels = CreateImage(width, height);
+
+    struct FormatInfo
+    {
+        TextureCompressionFormat format;
+        uint32_t channels;  //Channels the format stores
+        double maxRmse;
+        int maxError;
+    };
+
+    const FormatInfo formats[] = {
+        { TextureCompressionFormat::None, 4, 0.0, 0 },
+        { TextureCompressionFormat::BC1, 3, 10.0, 48 },
+        { TextureCompressionFormat::BC3, 4, 10.0, 48 },
+        { TextureCompressionFormat::BC4, 1, 2.0, 4 },
+        { TextureCompressionFormat::BC5, 2, 2.0, 4 },
+        { TextureCompressionFormat::BC7, 4, 10.0, 48 }
+    };
+
+    for(const FormatInfo &info : formats)
+    {
+        CompressedTexture texture;
+
+        if(!GFX_CHECK(TextureCompressor::Compress(pixels.data(), width, height, 4, info.format, true, texture)))
+            continue;
+
+        GFX_CHECK(texture.IsValid());
+        GFX_CHECK(texture.levels.size() == TextureCompressor::GetMipLevelCount(width, height));
+        GFX_CHECK(texture.levels.size() == 6);
+        GFX_CHECK(texture.levels.back().width == 1 && texture.levels.back().height == 1);
+
+        for(size_t i = 0; i < texture.levels.size(); i++)
+            GFX_CHECK(texture.levels[i].data.size() == TextureCompressor::GetLevelSize(info.format, texture.levels[i].width, texture.levels[i].height));
+
+        //The container has to give back exactly what was written
+        std::vector<uint8_t> ktx;
+        CompressedTexture loaded;
+        GFX_CHECK(TextureCompressor::WriteKTX(texture, ktx));
+        GFX_CHECK(TextureCompressor::ReadKTX(ktx.data(), ktx.size(), loaded));
+        GFX_CHECK(loaded.format == texture.format && loaded.width == width && loaded.height == height);
+        GFX_CHECK(loaded.levels.size() == texture.levels.size());
+
+        for(size_t i = 0; i < loaded.levels.size() && i < texture.levels.size(); i++)
+            GFX_CHECK(loaded.levels[i].data == texture.levels[i].data);
+
+        std::vector<uint8_t> decoded;
+        if(!GFX_CHECK(TextureCompressor::Decompress(loaded.levels[0], loaded.format, decoded)))
+            continue;
+
+        CompressionError error = Measure(pixels, decoded, info.channels);
+        printf("format %u: rmse %.2f, max error %d, %zu bytes\n", static_cast<uint32_t>(info.format), error.rmse, error.maximum, texture.GetDataSize());
+        GFX_CHECK(error.rmse <= info.maxRmse);
+        GFX_CHECK(error.maximum <= info.maxError);
+    }
+
+    //Truncated files are rejected instead of read past the end
+    CompressedTexture texture;
+    std::vector<uint8_t> ktx;
+    TextureCompressor::Compress(pixels.data(), width, height, 4, TextureCompressionFormat::BC1, true, texture);
+    TextureCompressor::WriteKTX(texture, ktx);
+    GFX_CHECK(!TextureCompressor::ReadKTX(ktx.data(), ktx.size() - 1, texture));
+    GFX_CHECK(!TextureCompressor::ReadKTX(ktx.data(), 16, texture));
+}
+
+static void TestDefaultFormat()
+{
+    std::vector<uint8_t> pixels(16 * 16 * 4, 255);
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), pixels.size(), 16, 16, 4), TextureUsage::Color) == TextureCompressionFormat::BC1);
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), 16 * 16 * 3, 16, 16, 3), TextureUsage::Color) == TextureCompressionFormat::BC1);
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), 16 * 16 * 2, 16, 16, 2), TextureUsage::Color) == TextureCompressionFormat::BC5);
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), 16 * 16, 16, 16, 1), TextureUsage::Color) == TextureCompressionFormat::BC4);
+    pixels[7 * 4 + 3] = 0;
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), pixels.size(), 16, 16, 4), TextureUsage::Color) == TextureCompressionFormat::BC3);
+
+    //Normal maps keep X and Y only, an image of unknown use is not compressed at all
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), pixels.size(), 16, 16, 4), TextureUsage::Normal) == TextureCompressionFormat::BC5);
+    GFX_CHECK(TextureCompressor::GetDefaultFormat(Image(pixels.data(), pixels.size(), 16, 16, 4), TextureUsage::Unknown) == TextureCompressionFormat::None);
+}
+
+//The import path encodes a texture once, saves it next to the source and reuses it until the source changes
+static void TestImportCache()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "gfx_texture_compressor_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    const uint32_t size = 64;
+    std::vector<uint8_t> pixels = CreateImage(size, size);
+    std::string sourcePath = (directory / "diffuse.png").string();
+    std::string compressedPath = (directory / "diffuse.png.ktx").string();
+
+    if(!GFX_CHECK(Image::SaveAsPNG(sourcePath, pixels.data(), pixels.size(), size, size, 4)))
+        return;
+
+    CookedTexture cooked;
+    cooked.name = "diffuse.png";
+    cooked.isEmbedded = false;
+
+    ModelTextureData first;
+    ModelProcessor::DecodeTexture(cooked, directory.string(), true, first);
+    GFX_CHECK(first.isLoaded && first.isCompressed);
+    GFX_CHECK(first.compressed.format == TextureCompressionFormat::BC3);
+    GFX_CHECK(first.compressed.levels.size() == TextureCompressor::GetMipLevelCount(size, size));
+    GFX_CHECK(std::filesystem::exists(compressedPath));
+
+    //Only the source and the .ktx, no temporary file is left behind
+    size_t fileCount = 0;
+
+    for(const auto &entry : std::filesystem::directory_iterator(directory))
+        fileCount += entry.is_regular_file() ? 1 : 0;
+
+    GFX_CHECK(fileCount == 2);
+
+    //Reused even when compression is off, it is only about producing the file
+    ModelTextureData second;
+    ModelProcessor::DecodeTexture(cooked, directory.string(), false, second);
+    GFX_CHECK(second.isLoaded && second.isCompressed);
+    GFX_CHECK(second.compressed.levels.size() == first.compressed.levels.size());
+    GFX_CHECK(second.compressed.levels.size() > 0 && second.compressed.levels[0].data == first.compressed.levels[0].data);
+
+    //An edited source is newer than its .ktx and decoded again
+    std::filesystem::last_write_time(sourcePath, std::filesystem::last_write_time(compressedPath) + std::chrono::hours(1));
+    ModelTextureData third;
+    ModelProcessor::DecodeTexture(cooked, directory.string(), false, third);
+    GFX_CHECK(third.isLoaded && !third.isCompressed);
+    GFX_CHECK(third.compressed.format == TextureCompressionFormat::None && third.compressed.width == size);
+
+    //Uncompressed textures get their mip chain on the decoding thread as well
+    GFX_CHECK(third.compressed.levels.size() == TextureCompressor::GetMipLevelCount(size, size));
+    GFX_CHECK(third.compressed.GetDataSize() > static_cast<size_t>(size) * size * 4);
+
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestDefaultFormat();
+    TestImportCache();
+    return Testing::GetResult();
+}
@@ -0,0 +1,176 @@
+#include "Testing.hpp"
+#include "Graphics/TextureStreamer.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+using namespace GFX;
+
+//Level sizes of an uncompressed square texture, finest first
+static std::vector<size_t> GetLevelSizes(uint32_t size)
+{
+    std::vector<size_t> levelSizes;
+
+    while(true)
+    {
+        levelSizes.push_back(static_cast<size_t>(size) * size * 4);
+        if(size == 1)
+            break;
+        size /= 2;
+    }
+
+    return levelSizes;
+}
+
+static TextureStreamingState CreateState(uint32_t id, uint32_t size, uint32_t coarseLevel, uint32_t requestedLevel, float priority)
+{
+    TextureStreamingState state;
+    state.id = id;
+    state.levelSizes = GetLevelSizes(size);
+    state.coarseLevel = coarseLevel;
+    state.requestedLevel = requestedLevel;
+    state.priority = priority;
+    return state;
+}
+
+static size_t GetResidentSize(const TextureStreamingState &state, uint32_t level)
+{
+    return std::accumulate(state.levelSizes.begin() + level, state.levelSizes.end(), static_cast<size_t>(0));
+}
+
+static void TestRequestedLevel()
+{
+    //1024 texels on 1024 pixels or more need the full texture
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(1024.0f, 1024, 1024, 11) == 0);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(FLT_MAX, 1024, 1024, 11) == 0);
+
+    //The chosen level never has fewer texels than pixels on screen
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(512.0f, 1024, 1024, 11) == 1);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(300.0f, 1024, 1024, 11) == 1);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(256.0f, 1024, 512, 11) == 2);
+
+    //Far away or off screen ends at the last level
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(0.0f, 1024, 1024, 11) == 10);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(0.01f, 1024, 1024, 11) == 10);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(0.01f, 1024, 1024, 4) == 3);
+    GFX_CHECK(TextureStreamer::CalculateRequestedLevel(100.0f, 1024, 1024, 0) == 0);
+}
+
+static void TestScreenSize()
+{
+    BoundingBox bounds(Vector3(-1, -1, -1), Vector3(1, 1, 1));
+
+    //Inside the bounds the texture may cover the whole screen
+    GFX_CHECK(TextureStreamer::CalculateScreenSize(bounds, Vector3(0, 0, 0), 60.0f, 1080.0f) == FLT_MAX);
+
+    float nearSize = TextureStreamer::CalculateScreenSize(bounds, Vector3(0, 0, 10), 60.0f, 1080.0f);
+    float farSize = TextureStreamer::CalculateScreenSize(bounds, Vector3(0, 0, 20), 60.0f, 1080.0f);
+    GFX_CHECK(nearSize > 0.0f && nearSize < 1080.0f);
+    GFX_CHECK(std::abs(nearSize / farSize - 2.0f) < 0.001f);
+}
+
+static void TestCoarseLevel()
+{
+    CompressedTexture texture;
+    std::vector<uint8_t> pixels(256 * 128 * 4, 127);
+
+    if(!GFX_CHECK(TextureCompressor::Compress(pixels.data(), 256, 128, 4, TextureCompressionFormat::None, true, texture)))
+        return;
+
+    GFX_CHECK(TextureStreamer::CalculateCoarseLevel(texture, 64) == 2);
+    GFX_CHECK(TextureStreamer::CalculateCoarseLevel(texture, 256) == 0);
+    GFX_CHECK(TextureStreamer::CalculateCoarseLevel(texture, 100) == 2);
+    GFX_CHECK(TextureStreamer::CalculateCoarseLevel(texture, 1) == texture.levels.size() - 1);
+}
+
+static void TestResidency()
+{
+    std::vector<uint32_t> levels;
+
+    //Without a budget only the coarse levels are resident, even when they alone exceed it
+    std::vector<TextureStreamingState> states = {
+        CreateState(1, 1024, 4, 0, 100.0f),
+        CreateState(2, 1024, 4, 0, 50.0f)
+    };
+
+    size_t coarseSize = GetResidentSize(states[0], 4) + GetResidentSize(states[1], 4);
+    GFX_CHECK(TextureStreamer::CalculateResidency(states, 0, levels) == coarseSize);
+    GFX_CHECK(levels[0] == 4 && levels[1] == 4);
+
+    //An unlimited budget gives every texture the level it asked for and nothing finer
+    states[1].requestedLevel = 2;
+    size_t fullSize = TextureStreamer::CalculateResidency(states, SIZE_MAX, levels);
+    GFX_CHECK(levels[0] == 0 && levels[1] == 2);
+    GFX_CHECK(fullSize == GetResidentSize(states[0], 0) + GetResidentSize(states[1], 2));
+
+    //A budget that fits both at level 1 is not spent on one texture at level 0
+    states[1].requestedLevel = 0;
+    size_t budget = GetResidentSize(states[0], 1) + GetResidentSize(states[1], 1) + states[0].levelSizes[0] / 2;
+    size_t usedSize = TextureStreamer::CalculateResidency(states, budget, levels);
+    GFX_CHECK(usedSize <= budget);
+    GFX_CHECK(levels[0] == 1 && levels[1] == 1);
+
+    //Levels that don't fit go to the higher priority texture first
+    budget = GetResidentSize(states[0], 1) + GetResidentSize(states[1], 2);
+    usedSize = TextureStreamer::CalculateResidency(states, budget, levels);
+    GFX_CHECK(usedSize <= budget);
+    GFX_CHECK(levels[0] == 1 && levels[1] == 2);
+
+    //Equal priorities are ordered by id, so the outcome does not depend on the order of the input
+    states[0].priority = states[1].priority = 10.0f;
+    TextureStreamer::CalculateResidency(states, budget, levels);
+    std::vector<uint32_t> swappedLevels;
+    std::vector<TextureStreamingState> swapped = { states[1], states[0] };
+    TextureStreamer::CalculateResidency(swapped, budget, swappedLevels);
+    GFX_CHECK(levels[0] == swappedLevels[1] && levels[1] == swappedLevels[0]);
+}
+
+static void TestResidencyBudget()
+{
+    //Many textures of different sizes and priorities, the budget must hold for every split
+    std::vector<TextureStreamingState> states;
+    const uint32_t sizes[] = { 64, 128, 256, 512, 1024, 2048 };
+
+    for(uint32_t i = 0; i < 60; i++)
+    {
+        uint32_t size = sizes[i % 6];
+        uint32_t levelCount = static_cast<uint32_t>(GetLevelSizes(size).size());
+        uint32_t coarseLevel = levelCount > 7 ? levelCount - 7 : 0;
+        states.push_back(CreateState(i, size, coarseLevel, (i / 6) % 3, static_cast<float>((i * 37) % 101)));
+    }
+
+    std::vector<uint32_t> levels;
+    size_t coarseSize = TextureStreamer::CalculateResidency(states, 0, levels);
+    size_t previousSize = 0;
+
+    for(size_t budget = coarseSize; budget < coarseSize + 64 * 1024 * 1024; budget += 3 * 1024 * 1024 + 12345)
+    {
+        size_t usedSize = TextureStreamer::CalculateResidency(states, budget, levels);
+        size_t residentSize = 0;
+
+        for(size_t i = 0; i < states.size(); i++)
+        {
+            //Small textures are resident completely, even when a coarser level was requested
+            GFX_CHECK(levels[i] <= states[i].coarseLevel);
+            GFX_CHECK(levels[i] >= std::min(states[i].requestedLevel, states[i].coarseLevel));
+            residentSize += GetResidentSize(states[i], levels[i]);
+        }
+
+        GFX_CHECK(usedSize == residentSize);
+        GFX_CHECK(usedSize <= budget);
+
+        //More budget never makes less resident
+        GFX_CHECK(usedSize >= previousSize);
+        previousSize = usedSize;
+    }
+}
+
+int main()
+{
+    TestRequestedLevel();
+    TestScreenSize();
+    TestCoarseLevel();
+    TestResidency();
+    TestResidencyBudget();
+    return Testing::GetResult();
+}
@@ -0,0 +1,171 @@
+#include "Testing.hpp"
+#include "Graphics/VertexLayout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace GFX;
+
+static double GetAngle(const Vector3 &a, const Vector3 &b)
+{
+    glm::dvec3 da(a);
+    glm::dvec3 db(b);
+    return glm::degrees(std::atan2(glm::length(glm::cross(da, db)), glm::dot(da, db)));
+}
+
+//The bounds documented in VertexLayout.hpp
+static void TestErrorBounds()
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    double maxAngle16 = 0.0;
+    double maxAngle8 = 0.0;
+    double maxHalfError = 0.0;
+    double maxUNormError = 0.0;
+
+    for(int i = 0; i < 200000; i++)
+    {
+        Vector3 normal(distribution(random), distribution(random), distribution(random));
+
+        if(glm::length(normal) < 0.001f)
+            continue;
+
+        normal = glm::normalize(normal);
+
+        int16_t octahedral16[2];
+        VertexQuantization::EncodeOctahedral16(normal, octahedral16);
+        Vector2 encoded16(VertexQuantization::DequantizeSNorm16(octahedral16[0]), VertexQuantization::DequantizeSNorm16(octahedral16[1]));
+        maxAngle16 = std::max(maxAngle16, GetAngle(normal, VertexQuantization::DecodeOctahedral(encoded16)));
+
+        int8_t octahedral8[2];
+        VertexQuantization::EncodeOctahedral8(normal, octahedral8);
+        Vector2 encoded8(VertexQuantization::DequantizeSNorm8(octahedral8[0]), VertexQuantization::DequantizeSNorm8(octahedral8[1]));
+        maxAngle8 = std::max(maxAngle8, GetAngle(normal, VertexQuantization::DecodeOctahedral(encoded8)));
+
+        float value = distribution(random) * 1000.0f;
+        float half = VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(value));
+
+        //Below the normal range of half floats the error is absolute instead of relative
+        if(std::abs(value) > 0.0001f)
+            maxHalfError = std::max(maxHalfError, static_cast<double>(std::abs(half - value) / std::abs(value)));
+
+        float unorm = (distribution(random) + 1.0f) * 0.5f;
+        float dequantized = VertexQuantization::DequantizeUNorm16(VertexQuantization::QuantizeUNorm16(unorm));
+        maxUNormError = std::max(maxUNormError, static_cast<double>(std::abs(dequantized - unorm)));
+    }
+
+    printf("octahedral16 %.4f deg, octahedral8 %.4f deg, half %.3g, unorm16 %.3g\n", maxAngle16, maxAngle8, maxHalfError, maxUNormError);
+    GFX_CHECK(maxAngle16 <= 0.01);
+    GFX_CHECK(maxAngle8 <= 0.7);
+    GFX_CHECK(maxHalfError <= std::ldexp(1.0, -11));
+    GFX_CHECK(maxUNormError <= 1.0 / 130000.0);
+}
+
+static void TestHalfSpecialValues()
+{
+    GFX_CHECK(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(0.0f)) == 0.0f);
+    GFX_CHECK(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(-2.5f)) == -2.5f);
+    GFX_CHECK(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(65504.0f)) == 65504.0f);
+    GFX_CHECK(std::isinf(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(70000.0f))));
+    GFX_CHECK(std::isnan(VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(NAN))));
+
+    //Subnormal halves keep small values instead of flushing them to zero
+    float tiny = VertexQuantization::HalfToFloat(VertexQuantization::FloatToHalf(0.000001f));
+    GFX_CHECK(tiny > 0.0f && std::abs(tiny - 0.000001f) < 0.0000001f);
+}
+
+static void TestLayouts()
+{
+    GFX_CHECK(VertexLayout().IsDefault());
+    GFX_CHECK(VertexLayout().GetStride() == sizeof(Vertex));
+    GFX_CHECK(VertexLayout::Compact().GetStride() == 16);
+    GFX_CHECK(!VertexLayout::Compact().IsDefault());
+
+    //Positions can't be octahedral and normals can't be UNorm16
+    GFX_CHECK(!VertexLayout(VertexAttributeFormat::Octahedral16, VertexAttributeFormat::Float32, VertexAttributeFormat::Float32).IsValid());
+    GFX_CHECK(!VertexLayout(VertexAttributeFormat::Float32, VertexAttributeFormat::UNorm16, VertexAttributeFormat::Float32).IsValid());
+}
+
+//A mesh far away from the origin, like the tiles of a large terrain or a model with a baked offset
+static void TestMeshRoundTrip()
+{
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<Vertex> vertices;
+    BoundingBox bounds;
+
+    for(int i = 0; i < 1000; i++)
+    {
+        Vector3 position(distribution(random) * 50.0f + 100.0f, distribution(random) * 3.0f, distribution(random) * 7.0f);
+        Vector3 normal = glm::normalize(Vector3(distribution(random), distribution(random), distribution(random) + 2.0f));
+        Vector2 uv(distribution(random) * 4.0f, distribution(random));
+        vertices.push_back(Vertex(position, normal, uv));
+        bounds.Grow(position);
+    }
+
+    struct LayoutInfo
+    {
+        VertexLayout layout;
+        double maxPositionError; //Relative to the size of the bounds
+        double maxNormalAngle;
+        double maxUVError;
+    };
+
+    const LayoutInfo layouts[] = {
+        { VertexLayout(), 0.0, 0.0, 0.0 },
+        { VertexLayout::Compact(), 1.0 / 130000.0, 0.01, 4.0 * std::ldexp(1.0, -11) },
+        { VertexLayout(VertexAttributeFormat::Float16, VertexAttributeFormat::Octahedral8, VertexAttributeFormat::Float16), 0.001, 0.7, 4.0 * std::ldexp(1.0, -11) }
+    };
+
+    for(const LayoutInfo &info : layouts)
+    {
+        VertexPositionTransform transform = VertexQuantization::CalculatePositionTransform(bounds, info.layout.position);
+        std::vector<uint8_t> data;
+        std::vector<Vertex> decoded;
+
+        if(!GFX_CHECK(VertexQuantization::Encode(vertices, info.layout, transform, data)))
+            continue;
+
+        GFX_CHECK(data.size() == vertices.size() * info.layout.GetStride());
+
+        if(!GFX_CHECK(VertexQuantization::Decode(data.data(), vertices.size(), info.layout, transform, decoded)))
+            continue;
+
+        double positionError = 0.0;
+        double normalAngle = 0.0;
+        double uvError = 0.0;
+        Vector3 size = bounds.GetSize();
+
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            for(int j = 0; j < 3; j++)
+                positionError = std::max(positionError, static_cast<double>(std::abs(decoded[i].position[j] - vertices[i].position[j]) / size[j]));
+
+            normalAngle = std::max(normalAngle, GetAngle(vertices[i].normal, decoded[i].normal));
+            uvError = std::max(uvError, static_cast<double>(glm::length(decoded[i].uv - vertices[i].uv)));
+        }
+
+        printf("stride %u: position %.3g, normal %.4f deg, uv %.3g\n", info.layout.GetStride(), positionError, normalAngle, uvError);
+        GFX_CHECK(positionError <= info.maxPositionError);
+        GFX_CHECK(normalAngle <= info.maxNormalAngle + 0.0001);
+        GFX_CHECK(uvError <= info.maxUVError);
+    }
+
+    //Partial updates encode a range, which has to match the same range of a full encode
+    VertexLayout layout = VertexLayout::Compact();
+    VertexPositionTransform transform = VertexQuantization::CalculatePositionTransform(bounds, layout.position);
+    std::vector<uint8_t> full;
+    std::vector<uint8_t> range;
+    VertexQuantization::Encode(vertices, layout, transform, full);
+    VertexQuantization::Encode(&vertices[100], 50, layout, transform, range);
+    GFX_CHECK(std::equal(range.begin(), range.end(), full.begin() + 100 * layout.GetStride()));
+}
+
+int main()
+{
+    TestErrorBounds();
+    TestHalfSpecialValues();
+    TestLayouts();
+    TestMeshRoundTrip();
+    return Testing::GetResult();
+}
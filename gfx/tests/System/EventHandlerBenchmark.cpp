@@ -0,0 +1,88 @@
+#include "Testing.hpp"
+#include "System/EventHandler.hpp"
+#include <string>
+
+using namespace GFX;
+
+//The EventHandler from before Delegate, a vector of std::function
+template<typename T>
+class StdFunctionEventHandler
+{
+private:
+    std::vector<T> callbacks;
+public:
+    template<typename ... Param>
+    void operator () (Param ... param)
+    {
+        for(size_t i = 0; i < callbacks.size(); i++)
+        {
+            if(callbacks[i])
+                callbacks[i](param...);
+        }
+    }
+
+    void operator += (T callback)
+    {
+        callbacks.push_back(callback);
+    }
+};
+
+using IntEvent = std::function<void(int)>;
+using StringEvent = std::function<void(const std::string&)>;
+
+//Raises events with 8 callbacks each, the argument is an int and a 64 character string
+int main(int argc, char **argv)
+{
+    const size_t raiseCount = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    volatile size_t sink = 0;
+    StdFunctionEventHandler<IntEvent> oldIntEvent;
+    EventHandler<IntEvent> newIntEvent;
+    StdFunctionEventHandler<StringEvent> oldStringEvent;
+    EventHandler<StringEvent> newStringEvent;
+
+    for(int i = 0; i < 8; i++)
+    {
+        oldIntEvent += [&sink] (int value) { sink = sink + value; };
+        newIntEvent += [&sink] (int value) { sink = sink + value; };
+        oldStringEvent += [&sink] (const std::string &text) { sink = sink + text.size(); };
+        newStringEvent += [&sink] (const std::string &text) { sink = sink + text.size(); };
+    }
+
+    const std::string text(64, 'a');
+    Stopwatch stopwatch;
+
+    for(size_t i = 0; i < raiseCount; i++)
+        oldIntEvent(static_cast<int>(i));
+    double oldIntTime = stopwatch.GetElapsedMilliseconds();
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < raiseCount; i++)
+        newIntEvent(static_cast<int>(i));
+    double newIntTime = stopwatch.GetElapsedMilliseconds();
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < raiseCount / 4; i++)
+        oldStringEvent(text);
+    double oldStringTime = stopwatch.GetElapsedMilliseconds();
+
+    stopwatch.Restart();
+    for(size_t i = 0; i < raiseCount / 4; i++)
+        newStringEvent(text);
+    double newStringTime = stopwatch.GetElapsedMilliseconds();
+
+    //Subscribing and unsubscribing again, like a behaviour that is enabled and disabled
+    stopwatch.Restart();
+    for(size_t i = 0; i < raiseCount; i++)
+    {
+        EventToken token = newIntEvent += [&sink] (int value) { sink = sink + value; };
+        newIntEvent -= token;
+    }
+    double churnTime = stopwatch.GetElapsedMilliseconds();
+
+    printf("raise int: old %.1f ns, new %.1f ns, speedup: %.2fx\n", oldIntTime * 1e6 / raiseCount, newIntTime * 1e6 / raiseCount, oldIntTime / newIntTime);
+    printf("raise string: old %.1f ns, new %.1f ns, speedup: %.2fx\n", oldStringTime * 4e6 / raiseCount, newStringTime * 4e6 / raiseCount, oldStringTime / newStringTime);
+    printf("subscribe and unsubscribe: %.1f ns\n", churnTime * 1e6 / raiseCount);
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "Testing.hpp"
+#include "System/EventHandler.hpp"
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace GFX;
+
+static std::atomic<size_t> allocationCount(0);
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    void *pointer = malloc(size);
+    if(!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+using KeyEvent = std::function<void(int)>;
+
+static int freeFunctionSum = 0;
+
+static void OnKey(int value)
+{
+    freeFunctionSum += value;
+}
+
+static void TestSubscriptions()
+{
+    EventHandler<KeyEvent> event;
+    int sum = 0;
+    EventToken self;
+    EventToken other;
+
+    EventToken first = event += [&sum] (int value) { sum += value; };
+
+    //Removes itself and adds another callback while the event is raised
+    self = event += [&] (int value) {
+        sum += 100 * value;
+        event -= self;
+        event += [&sum] (int) { sum += 10000; };
+    };
+
+    other = event += [&sum] (int value) { sum += 10 * value; };
+
+    //Empty callbacks are not stored, functions are
+    void (*none)(int) = nullptr;
+    event += KeyEvent();
+    event += none;
+    event += OnKey;
+    GFX_CHECK(event.GetCount() == 4);
+
+    event(1);
+    GFX_CHECK(sum == 111 && freeFunctionSum == 1);
+    GFX_CHECK(event.GetCount() == 4);
+
+    sum = 0;
+    event(1);
+    GFX_CHECK(sum == 10011);
+    GFX_CHECK(!event.Remove(self));
+    GFX_CHECK(event.Remove(other));
+
+    EventHandler<KeyEvent> copy = event;
+    sum = 0;
+    copy(2);
+    GFX_CHECK(sum == 10002);
+
+    //Too large for the inline buffer
+    struct Large
+    {
+        char data[128];
+        int *target;
+
+        void operator () (int value)
+        {
+            *target += value + data[0];
+        }
+    };
+
+    Large large = {};
+    large.target = &sum;
+    sum = 0;
+    EventToken largeToken = event += large;
+    event(1);
+    GFX_CHECK(sum == 10002);
+    event -= largeToken;
+    event -= first;
+
+    event.Clear();
+    GFX_CHECK(event.GetCount() == 0);
+    sum = 0;
+    event(1);
+    GFX_CHECK(sum == 0);
+}
+
+static void TestAllocations()
+{
+    int x = 0;
+    int y = 0;
+    int z = 0;
+    EventHandler<KeyEvent> event;
+
+    for(int i = 0; i < 8; i++)
+        event += [&x, &y, &z] (int value) { x += value; y += value; z += value; };
+
+    //Lambdas that capture a few pointers are stored inline, once a slot is free nothing allocates anymore
+    event -= (event += [&x] (int value) { x += value; });
+    size_t count = allocationCount;
+
+    for(int i = 0; i < 1000; i++)
+        event(i);
+
+    EventToken token = event += [&x] (int value) { x += value; };
+    event -= token;
+
+    GFX_CHECK(allocationCount == count);
+}
+
+//Raised from another thread while this one adds and removes callbacks
+static void TestConcurrent()
+{
+    ConcurrentEventHandler<std::function<void(float*,int)>, 4> event;
+    std::atomic<bool> quit(false);
+    std::atomic<long> callCount(0);
+
+    std::thread audioThread([&] {
+        float buffer[64] = {};
+        while(!quit)
+            event(buffer, 64);
+    });
+
+    for(int i = 0; i < 20000; i++)
+    {
+        int *counter = static_cast<int*>(calloc(1, sizeof(int)));
+        EventToken token = event += [counter, &callCount] (float *, int frameCount) {
+            *counter += frameCount;
+            callCount++;
+        };
+
+        GFX_CHECK(token.IsValid());
+
+        if(i % 7 == 0)
+            std::this_thread::yield();
+
+        GFX_CHECK(event.Remove(token));
+        GFX_CHECK(!event.Remove(token));
+
+        //Remove waited for the callback in case it was running
+        free(counter);
+    }
+
+    quit = true;
+    audioThread.join();
+
+    EventToken first = event += [] (float *, int) {};
+    event += [] (float *, int) {};
+    event += [] (float *, int) {};
+    event += [] (float *, int) {};
+    GFX_CHECK(!(event += [] (float *, int) {}).IsValid());
+
+    event -= first;
+    GFX_CHECK((event += [] (float *, int) {}).IsValid());
+    printf("concurrent calls: %ld\n", callCount.load());
+}
+
+int main()
+{
+    TestSubscriptions();
+    TestAllocations();
+    TestConcurrent();
+    return Testing::GetResult();
+}
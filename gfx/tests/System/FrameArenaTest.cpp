@@ -0,0 +1,117 @@
+#include "Testing.hpp"
+#include <cstring>
+#include <thread>
+
+using namespace GFX;
+
+static void AllocateFrame(size_t count)
+{
+    FrameVector<int> values;
+
+    for(size_t i = 0; i < count; i++)
+        values.push_back(static_cast<int>(i));
+
+    FrameVector<double> doubles(1000, 1.0);
+    FrameString text("some text that is too long for the small string buffer");
+    text += std::to_string(count);
+}
+
+static void TestSteadyState()
+{
+    for(uint32_t i = 0; i < 5; i++)
+    {
+        AllocateFrame(5000);
+        Testing::NewFrame();
+    }
+
+    //Once the arena has grown to what a frame needs it doesn't allocate pages anymore
+    size_t capacity = FrameArena::GetCapacity();
+    uint64_t allocationCount = 0;
+
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        AllocateFrame(5000);
+        Testing::NewFrame();
+        allocationCount += FrameArena::GetLastFrameHeapAllocationCount();
+    }
+
+    GFX_CHECK(FrameArena::GetCapacity() == capacity);
+#ifndef GFX_COUNT_HEAP_ALLOCATIONS
+    GFX_CHECK(allocationCount == 0);
+#endif
+}
+
+static void TestUsedBytes()
+{
+    Testing::NewFrame();
+
+    for(uint32_t i = 0; i < 1000; i++)
+        FrameArena::Allocate(48, 16);
+
+    //Larger than a page
+    uint8_t *large = FrameArena::Allocate<uint8_t>(FrameArena::PAGE_SIZE * 2);
+    memset(large, 1, FrameArena::PAGE_SIZE * 2);
+
+    Testing::NewFrame();
+    size_t usedBytes = FrameArena::GetLastFrameUsedBytes();
+    GFX_CHECK(usedBytes >= 48000 + FrameArena::PAGE_SIZE * 2);
+    GFX_CHECK(usedBytes < 48000 + FrameArena::PAGE_SIZE * 2 + 4096);
+
+    Testing::NewFrame();
+    GFX_CHECK(FrameArena::GetLastFrameUsedBytes() == 0);
+
+    //Memory stays valid for one more frame
+    int *value = FrameArena::Allocate<int>(4);
+    value[0] = 42;
+    uint64_t frame = FrameArena::GetFrame();
+    Testing::NewFrame();
+    GFX_CHECK(value[0] == 42);
+    GFX_CHECK(FrameArena::IsValid(frame));
+    Testing::NewFrame();
+    GFX_CHECK(!FrameArena::IsValid(frame));
+}
+
+//The statistics are read while other threads allocate, they must not look at pages those threads write
+static void TestThreads()
+{
+    for(uint32_t i = 0; i < 20; i++)
+    {
+        std::atomic<uint32_t> runningCount(4);
+        std::vector<std::thread> threads;
+
+        for(uint32_t j = 0; j < 4; j++)
+        {
+            threads.emplace_back([&runningCount] {
+                for(uint32_t k = 0; k < 50; k++)
+                    AllocateFrame(3000);
+                runningCount--;
+            });
+        }
+
+        size_t capacity = 0;
+
+        while(runningCount > 0)
+        {
+            size_t current = FrameArena::GetCapacity();
+            GFX_CHECK(current >= capacity);
+            capacity = current;
+            FrameArena::GetLastFrameUsedBytes();
+        }
+
+        for(auto &thread : threads)
+            thread.join();
+
+        Testing::NewFrame();
+        GFX_CHECK(FrameArena::GetLastFrameUsedBytes() > 4 * 3000 * sizeof(int));
+    }
+
+    printf("capacity after threads: %zu\n", FrameArena::GetCapacity());
+}
+
+int main()
+{
+    TestSteadyState();
+    TestUsedBytes();
+    TestThreads();
+    return Testing::GetResult();
+}
@@ -0,0 +1,161 @@
+#include "Testing.hpp"
+#include <thread>
+
+using namespace GFX;
+
+//Without Initialize jobs run inline, like before the job system existed
+static void TestNotInitialized()
+{
+    int value = 0;
+    JobCounter counter;
+    JobSystem::Schedule([&value] { value = 1; }, &counter);
+    GFX_CHECK(value == 1);
+    GFX_CHECK(counter.IsDone());
+}
+
+//With zero workers every job runs on the main thread in a fixed order
+static uint64_t RunWithoutWorkers()
+{
+    JobSystem::Initialize(0);
+
+    std::vector<int> order;
+    JobCounter first;
+    JobCounter second;
+
+    for(int i = 0; i < 50; i++)
+        JobSystem::Schedule([&order, i] { order.push_back(i); }, &first, static_cast<JobPriority>(i % 3));
+
+    JobSystem::ScheduleAfter(first, [&order] { order.push_back(1000); }, &second);
+    JobSystem::ParallelFor(100, [&order] (size_t i) { order.push_back(2000 + static_cast<int>(i)); });
+    JobSystem::Wait(second);
+    JobSystem::Deinitialize();
+
+    GFX_CHECK(order.size() == 151);
+
+    uint64_t hash = 1469598103934665603ULL;
+
+    for(int value : order)
+    {
+        hash ^= static_cast<uint64_t>(value);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static void TestDependencies()
+{
+    std::atomic<int> sum(0);
+    std::atomic<int> valueAfter(-1);
+    JobCounter stage1;
+    JobCounter stage2;
+    JobCounter stage3;
+
+    //Jobs that schedule more jobs on the same counter
+    for(int i = 0; i < 500; i++)
+    {
+        JobSystem::Schedule([&sum, &stage1] {
+            sum++;
+            JobSystem::Schedule([&sum] { sum += 2; }, &stage1, JobPriority::Low);
+        }, &stage1, static_cast<JobPriority>(i % 3));
+    }
+
+    for(int i = 0; i < 10; i++)
+        JobSystem::ScheduleAfter(stage1, [&sum, &valueAfter] { valueAfter = sum.load(); }, &stage2, JobPriority::High);
+
+    JobSystem::ScheduleAfter(stage2, [&sum] { sum += 100000; }, &stage3);
+    JobSystem::Wait(stage3);
+
+    GFX_CHECK(valueAfter == 1500);
+    GFX_CHECK(sum == 101500);
+    GFX_CHECK(stage1.IsDone() && stage2.IsDone());
+}
+
+static void TestParallelFor()
+{
+    std::vector<int> data(10000, 0);
+    JobSystem::ParallelFor(data.size(), [&data] (size_t i) { data[i] = static_cast<int>(i) * 2; });
+
+    long long total = 0;
+    for(int value : data)
+        total += value;
+    GFX_CHECK(total == 99990000LL);
+
+    //Nested inside jobs, the waiting worker helps instead of blocking
+    std::atomic<long long> nested(0);
+    JobSystem::ParallelFor(16, [&nested] (size_t) {
+        JobSystem::ParallelForRange(1000, 7, [&nested] (size_t first, size_t last) { nested += static_cast<long long>(last - first); });
+    });
+    GFX_CHECK(nested == 16000);
+}
+
+static void TestMainThread()
+{
+    std::thread::id mainThreadId = std::this_thread::get_id();
+    std::atomic<int> onMainThread(0);
+    JobCounter mainCounter;
+    JobCounter counter;
+
+    for(int i = 0; i < 50; i++)
+    {
+        JobSystem::Schedule([&] {
+            JobSystem::ScheduleOnMainThread([&] {
+                if(std::this_thread::get_id() == mainThreadId)
+                    onMainThread++;
+            }, &mainCounter);
+        }, &counter);
+    }
+
+    JobSystem::Wait(counter);
+    JobSystem::Wait(mainCounter);
+    GFX_CHECK(onMainThread == 50);
+}
+
+//Threads that are not workers can schedule too
+static void TestForeignThread()
+{
+    JobCounter counter;
+    std::atomic<int> sum(0);
+
+    std::thread thread([&] {
+        for(int i = 0; i < 100; i++)
+            JobSystem::Schedule([&sum] { sum++; }, &counter);
+    });
+
+    thread.join();
+    JobSystem::Wait(counter);
+    GFX_CHECK(sum == 100);
+}
+
+int main()
+{
+    TestNotInitialized();
+
+    uint64_t hash = RunWithoutWorkers();
+    GFX_CHECK(RunWithoutWorkers() == hash);
+
+    for(uint32_t workerCount : { 1u, 3u, 8u })
+    {
+        JobSystem::Initialize(workerCount);
+        GFX_CHECK(JobSystem::GetWorkerCount() == workerCount);
+
+        for(uint32_t round = 0; round < 20; round++)
+        {
+            TestDependencies();
+            TestParallelFor();
+            TestMainThread();
+            TestForeignThread();
+        }
+
+        //Work that is still pending is finished on shutdown
+        std::atomic<int> pending(0);
+        for(int i = 0; i < 100; i++)
+            JobSystem::Schedule([&pending] { pending++; }, nullptr, JobPriority::Low);
+
+        JobSystem::Deinitialize();
+        GFX_CHECK(pending == 100);
+        GFX_CHECK(!JobSystem::IsInitialized());
+    }
+
+    return Testing::GetResult();
+}
@@ -0,0 +1,137 @@
+#include "Testing.hpp"
+#include "System/MemoryTracker.hpp"
+#include "Graphics/Image.hpp"
+#include <cstring>
+#include <thread>
+
+using namespace GFX;
+
+//Owns a payload the way Image and AudioClip do
+struct Payload
+{
+    std::vector<uint8_t> data;
+    MemoryUsage usage;
+
+    Payload(size_t size) : data(size), usage(MemoryTag::Audio)
+    {
+        usage.Set(size);
+    }
+};
+
+static void TestAllocate()
+{
+    void *a = MemoryTracker::Allocate(MemoryTag::Physics, 100);
+    void *b = MemoryTracker::Allocate(MemoryTag::Physics, 1000, 64);
+    GFX_CHECK(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t) == 0);
+    GFX_CHECK(reinterpret_cast<uintptr_t>(b) % 64 == 0);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Physics) == 1100);
+
+    memset(a, 1, 100);
+    memset(b, 2, 1000);
+    a = MemoryTracker::Reallocate(MemoryTag::Physics, a, 300);
+    GFX_CHECK(reinterpret_cast<uint8_t*>(a)[99] == 1);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Physics) == 1300);
+
+    MemoryTracker::Free(a);
+    MemoryTracker::Free(b);
+    MemoryTracker::Free(nullptr);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Physics) == 0);
+    GFX_CHECK(MemoryTracker::GetPeakBytes(MemoryTag::Physics) == 1400);
+}
+
+//Copies count again, moves hand the bytes over
+static void TestMemoryUsage()
+{
+    {
+        Image image(4, 4, 4, 1, 0, 0, 1);
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 64);
+        Image copy(image);
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 128);
+        Image moved(std::move(copy));
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 128);
+        image = moved;
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 128);
+        image = Image();
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 64);
+
+        Payload payload(500);
+        Payload payloadCopy = payload;
+        std::vector<Payload> payloads;
+        payloads.push_back(payload);
+        payloads.push_back(std::move(payloadCopy));
+        GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Audio) == 1500);
+    }
+
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Image) == 0);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Audio) == 0);
+}
+
+static void TestBudget()
+{
+    uint32_t callCount = 0;
+
+    //The callback frees memory until the tag is within its budget again
+    MemoryTracker::SetBudget(MemoryTag::Mesh, 1000);
+    MemoryTracker::SetBudgetCallback(MemoryTag::Mesh, [&callCount] (MemoryTag tag, size_t currentBytes, size_t budget) {
+        callCount++;
+        MemoryTracker::Remove(tag, currentBytes - budget);
+    });
+
+    MemoryTracker::Add(MemoryTag::Mesh, 1500);
+    MemoryTracker::CheckBudgets();
+    MemoryTracker::CheckBudgets();
+    GFX_CHECK(callCount == 1);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Mesh) == 1000);
+
+    MemorySnapshot snapshot = MemoryTracker::GetSnapshot();
+    GFX_CHECK(snapshot.Get(MemoryTag::Mesh).peakBytes == 1500);
+    GFX_CHECK(snapshot.Get(MemoryTag::Mesh).budget == 1000);
+
+    MemoryTracker::ResetPeaks();
+    GFX_CHECK(MemoryTracker::GetPeakBytes(MemoryTag::Mesh) == 1000);
+
+    MemoryTracker::SetBudgetCallback(MemoryTag::Mesh, nullptr);
+    MemoryTracker::SetBudget(MemoryTag::Mesh, 0);
+    MemoryTracker::Remove(MemoryTag::Mesh, 1000);
+}
+
+static void TestThreads()
+{
+    std::vector<std::thread> threads;
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        threads.emplace_back([] {
+            for(uint32_t j = 0; j < 2000; j++)
+            {
+                void *pointer = MemoryTracker::Allocate(MemoryTag::General, 64, 32);
+                MemoryTracker::Free(pointer);
+            }
+        });
+    }
+
+    for(auto &thread : threads)
+        thread.join();
+
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::General) == 0);
+    GFX_CHECK(MemoryTracker::GetSnapshot().Get(MemoryTag::General).allocationCount >= 8000);
+}
+
+int main()
+{
+    TestAllocate();
+    TestMemoryUsage();
+    TestBudget();
+    TestThreads();
+
+    //Pages of the frame arena are tagged too
+    FrameArena::Allocate(100);
+    GFX_CHECK(MemoryTracker::GetCurrentBytes(MemoryTag::Frame) >= FrameArena::PAGE_SIZE);
+
+    MemorySnapshot snapshot = MemoryTracker::GetSnapshot();
+
+    for(size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); i++)
+        printf("%-10s %8zu %8zu\n", MemoryTracker::GetTagName(static_cast<MemoryTag>(i)), snapshot.tags[i].currentBytes, snapshot.tags[i].peakBytes);
+
+    return Testing::GetResult();
+}
@@ -0,0 +1,93 @@
+#ifndef GFX_TESTING_HPP
+#define GFX_TESTING_HPP
+
+#include "System/FrameArena.hpp"
+#include "System/JobSystem.hpp"
+#include "Core/GameBehaviour.hpp"
+#include "Graphics/Graphics2D.hpp"
+#include "Graphics/TextLayoutCache.hpp"
+#include <chrono>
+#include <cstdio>
+
+//Reports the failed condition and keeps going, a test returns Testing::GetResult() from main
+#define GFX_CHECK(condition) GFX::Testing::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace GFX
+{
+    // Helpers shared by the headless tests and benchmarks.
+    // Steps the parts of a frame that do not need a window, in the same order as Application does.
+    class Testing
+    {
+    private:
+        static inline int failures = 0;
+    public:
+        static bool Check(bool condition, const char *text, const char *file, int line)
+        {
+            if(!condition)
+            {
+                printf("FAILED %s:%d: %s\n", file, line, text);
+                failures++;
+            }
+            return condition;
+        }
+
+        static int GetResult()
+        {
+            if(failures > 0)
+                printf("%d check(s) failed\n", failures);
+            return failures > 0 ? 1 : 0;
+        }
+
+        static void NewFrame()
+        {
+            FrameArena::NewFrame();
+            JobSystem::NewFrame();
+        }
+
+        static void Update()
+        {
+            GameBehaviour::OnBehaviourUpdate();
+            GameBehaviour::OnBehaviourLateUpdate();
+        }
+
+        static void EndFrame()
+        {
+            GameBehaviour::EndFrame();
+        }
+
+        //Expires and evicts text layouts, Graphics2D does this at the start of every frame
+        static void NewTextFrame()
+        {
+            TextLayoutCache::NewFrame();
+        }
+
+        //Markup parsing as Graphics2D did for every label before layouts were cached
+        static void ParseColorsFromText(std::string &text, size_t &colorCount)
+        {
+            Graphics2D::ParseColorsFromText(text, Graphics2D::textColorInfoTemp, colorCount);
+        }
+    };
+
+    class Stopwatch
+    {
+    private:
+        std::chrono::steady_clock::time_point start;
+    public:
+        Stopwatch()
+        {
+            Restart();
+        }
+
+        void Restart()
+        {
+            start = std::chrono::steady_clock::now();
+        }
+
+        double GetElapsedMilliseconds() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+}
+
+#endif